@@ -0,0 +1,129 @@
+// async_consume_coro.cpp
+//
+// This is a Paho MQTT C++ client, sample application.
+//
+// It's an example of consuming messages from C++20 coroutines, where a
+// number of consumers share the messages from a single client. Rather than
+// blocking a thread in consume_message() for each consumer, every consumer
+// is a coroutine that suspends on `co_await` until the next message
+// arrives. The consumers are resumed right from the library's callback
+// thread, as the messages come in, so no thread is tied up waiting.
+//
+// The sample demonstrates:
+//  - Connecting to an MQTT server/broker
+//  - Subscribing to a topic
+//  - Consuming messages from coroutines with `co_await`
+//
+// This requires a compiler with C++20 coroutine support.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "mqtt/async_client.h"
+#include "mqtt/awaitable.h"
+
+using namespace std;
+
+const string DFLT_SERVER_URI{"mqtt://localhost:1883"};
+const string CLIENT_ID{"paho_cpp_async_consume_coro"};
+
+const string TOPIC{"hello/#"};
+const int QOS = 1;
+
+const int DFLT_N_CONSUMERS = 100;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// A minimal, "fire and forget" coroutine type. It starts running
+// immediately, and cleans itself up when it finishes.
+
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() { return {}; }
+        suspend_never initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// --------------------------------------------------------------------------
+// A consumer handles messages until the stream ends, when the client
+// stops consuming or loses its connection.
+
+task consumer(mqtt::async_client& cli, int id, atomic<int>& nActive)
+{
+    int n = 0;
+    auto stream = mqtt::messages(cli);
+
+    while (auto msg = co_await stream.next()) {
+        ++n;
+        cout << "[" << id << "] " << msg->get_topic() << ": " << msg->to_string() << endl;
+    }
+
+    cout << "Consumer " << id << " done after " << n << " messages" << endl;
+    --nActive;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    string serverURI = (argc > 1) ? string{argv[1]} : DFLT_SERVER_URI;
+    int nCons = (argc > 2) ? atoi(argv[2]) : DFLT_N_CONSUMERS;
+
+    mqtt::async_client cli(serverURI, CLIENT_ID);
+
+    try {
+        cli.start_consuming();
+
+        cout << "Connecting to " << serverURI << "..." << flush;
+        cli.connect()->wait();
+        cout << "OK" << endl;
+
+        cli.subscribe(TOPIC, QOS)->wait();
+
+        atomic<int> nActive{nCons};
+        for (int i = 0; i < nCons; ++i) consumer(cli, i, nActive);
+
+        cout << "Started " << nCons << " consumers. Press Enter to quit." << endl;
+        cin.get();
+
+        // Stopping wakes all the consumers with an empty message
+        cli.stop_consuming();
+
+        cout << "Disconnecting..." << flush;
+        cli.disconnect()->wait();
+        cout << "OK" << endl;
+    }
+    catch (const mqtt::exception& exc) {
+        cerr << exc.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
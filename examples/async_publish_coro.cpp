@@ -0,0 +1,161 @@
+// async_publish_coro.cpp
+//
+// This is a Paho MQTT C++ client, sample application.
+//
+// It's an example of publishing from C++20 coroutines, where a number of
+// publishers each send a stream of messages, waiting for each one to be
+// acknowledged before sending the next. Rather than tying up a thread to
+// wait on each publisher's tokens, every publisher is a coroutine that
+// suspends on `co_await` until the server acknowledges the message. When
+// it does, the coroutine is handed to an executor that queues it for the
+// main thread to resume. So a single thread drives all of the publishers.
+//
+// The sample demonstrates:
+//  - Connecting to an MQTT server/broker
+//  - Publishing messages from coroutines with `co_await`
+//  - Resuming the coroutines on an application thread with an executor
+//
+// This requires a compiler with C++20 coroutine support.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "mqtt/async_client.h"
+#include "mqtt/awaitable.h"
+
+using namespace std;
+
+const string DFLT_SERVER_URI{"mqtt://localhost:1883"};
+const string CLIENT_ID{"paho_cpp_async_publish_coro"};
+
+const string TOPIC{"hello"};
+const int QOS = 1;
+
+const int DFLT_N_PUBLISHERS = 100;
+const int DFLT_N_MSG = 100;
+
+const auto TIMEOUT = std::chrono::seconds(10);
+
+// The coroutines that are ready to be resumed by the main thread.
+// A null handle tells the main thread that all the publishers are done.
+using ready_queue = mqtt::thread_queue<coroutine_handle<>>;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// A minimal, "fire and forget" coroutine type. It starts running
+// immediately, and cleans itself up when it finishes.
+
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() { return {}; }
+        suspend_never initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// --------------------------------------------------------------------------
+// A publisher sends its messages one at a time, suspending until each is
+// acknowledged by the server.
+
+task publisher(
+    mqtt::async_client& cli, const mqtt::resume_executor& exec, int id, int nMsg,
+    atomic<int>& nActive, ready_queue& que
+)
+{
+    try {
+        for (int i = 0; i < nMsg; ++i) {
+            auto msg = mqtt::make_message(
+                TOPIC, "Publisher " + to_string(id) + ", message " + to_string(i), QOS, false
+            );
+            co_await mqtt::resume_on(cli.publish(msg), exec);
+        }
+    }
+    catch (const mqtt::exception& exc) {
+        cerr << "Publisher " << id << ": " << exc.what() << endl;
+    }
+
+    if (--nActive == 0)
+        que.put(coroutine_handle<>{});
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    string serverURI = (argc > 1) ? string{argv[1]} : DFLT_SERVER_URI;
+    int nPub = (argc > 2) ? atoi(argv[2]) : DFLT_N_PUBLISHERS;
+    int nMsg = (argc > 3) ? atoi(argv[3]) : DFLT_N_MSG;
+
+    mqtt::async_client cli(serverURI, CLIENT_ID);
+
+    // The executor just queues the coroutines for the main thread
+    ready_queue que;
+    mqtt::resume_executor exec = [&que](coroutine_handle<> h) { que.put(h); };
+
+    try {
+        cout << "Connecting to " << serverURI << "..." << flush;
+        cli.connect()->wait();
+        cout << "OK" << endl;
+
+        cout << "Starting " << nPub << " publishers, with " << nMsg << " messages each..."
+             << flush;
+
+        auto start = chrono::steady_clock::now();
+
+        atomic<int> nActive{nPub};
+        for (int i = 0; i < nPub; ++i) publisher(cli, exec, i, nMsg, nActive, que);
+
+        // Run the coroutines as their messages are acknowledged, until
+        // they're all done.
+        while (nPub > 0) {
+            coroutine_handle<> h;
+            if (!que.try_get_for(&h, TIMEOUT)) {
+                cerr << "\nTimed out waiting for the publishers" << endl;
+                break;
+            }
+            if (!h)
+                break;
+            h.resume();
+        }
+
+        auto dur = chrono::steady_clock::now() - start;
+        cout << "OK\nPublished " << (nPub * nMsg) << " messages in "
+             << chrono::duration_cast<chrono::milliseconds>(dur).count() << "ms" << endl;
+
+        cout << "Disconnecting..." << flush;
+        cli.disconnect()->wait();
+        cout << "OK" << endl;
+    }
+    catch (const mqtt::exception& exc) {
+        cerr << exc.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file ack_tracker.h
+/// Declaration of MQTT ack_tracker class, which releases the acks of
+/// incoming messages in the order they arrived.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_ack_tracker_h
+#define __mqtt_ack_tracker_h
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "mqtt/message.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Tracks the incoming messages that the app acknowledges itself, and
+ * releases the acks in the order that the messages arrived.
+ *
+ * Each tracked message gets a place in the arrival order, and carries a
+ * handle back to the tracker, so the app acks it with `message::ack()`
+ * when it's done with it. Messages can be processed in parallel and
+ * acked in any order. The tracker releases an ack only once every
+ * message before it was acked, too, so the released acks are always a
+ * contiguous prefix of the arrivals. That's the point up to which all the
+ * work is done, which is what an at-least-once pipeline needs to commit.
+ * @par
+ * Only QoS 1 and 2 messages are tracked, since there's nothing to ack for
+ * QoS 0.
+ * @par
+ * The tracker is normally used by the async_client, through
+ * `async_client::start_manual_ack()`, which also holds back new messages
+ * while too many are waiting to be acked.
+ */
+class ack_tracker : public std::enable_shared_from_this<ack_tracker>
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<ack_tracker>;
+    /**
+     * Handler for a released ack.
+     * This is called once for each message, in the order they arrived.
+     */
+    using release_handler = std::function<void(const const_message_ptr&)>;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** A tracked message */
+    struct slot
+    {
+        /** The message */
+        const_message_ptr msg;
+        /** Whether the app acked it */
+        bool acked;
+    };
+
+    /** The most messages to have in flight, or zero for no limit */
+    const std::size_t maxInFlight_;
+
+    /** Lock for everything below */
+    mutable std::mutex lock_;
+    /** The messages that weren't released yet, in arrival order */
+    std::deque<slot> slots_;
+    /** The sequence number of the first message in the slots */
+    uint64_t baseSeq_{0};
+    /** The handler for the released acks */
+    release_handler releaseHandler_;
+
+    /**
+     * Serializes the releases, so the handler sees them in order even
+     * when several threads ack at once.
+     */
+    std::mutex releaseLock_;
+
+public:
+    /**
+     * Creates a tracker.
+     * @param maxInFlight The most messages to have in flight, or zero for
+     *  				  no limit.
+     * @param cb The handler for the released acks, if any.
+     */
+    explicit ack_tracker(std::size_t maxInFlight = 0, release_handler cb = release_handler{})
+        : maxInFlight_{maxInFlight}, releaseHandler_{std::move(cb)} {}
+    /**
+     * Creates a tracker.
+     * @param maxInFlight The most messages to have in flight, or zero for
+     *  				  no limit.
+     * @param cb The handler for the released acks, if any.
+     * @return A shared pointer to the tracker.
+     */
+    static ptr_t create(std::size_t maxInFlight = 0, release_handler cb = release_handler{}) {
+        return std::make_shared<ack_tracker>(maxInFlight, std::move(cb));
+    }
+
+    ack_tracker(const ack_tracker&) = delete;
+    ack_tracker& operator=(const ack_tracker&) = delete;
+
+    /**
+     * Gets the most messages that can be in flight.
+     * @return The most messages in flight, or zero for no limit.
+     */
+    std::size_t get_max_in_flight() const { return maxInFlight_; }
+    /**
+     * Sets the handler for the released acks.
+     * The handler must not ack messages itself.
+     * @param cb The handler.
+     */
+    void set_release_handler(release_handler cb) {
+        guard g{lock_};
+        releaseHandler_ = std::move(cb);
+    }
+    /**
+     * Starts tracking a message, giving it the next place in the arrival
+     * order and a handle to ack it.
+     * QoS 0 messages are not tracked.
+     * @param msg The message.
+     * @return @em true if the message is tracked, @em false if it's
+     *  	   QoS 0.
+     */
+    bool track(const message_ptr& msg);
+    /**
+     * Acks the message with a sequence number.
+     * This releases the acks for this message and any after it that were
+     * already acked, if every one before it was released. Acking a
+     * message more than once does nothing.
+     * @param seq The sequence number of the message.
+     * @return The number of acks that were released.
+     */
+    std::size_t ack(uint64_t seq);
+    /**
+     * Gets the number of tracked messages that weren't released yet.
+     * This includes those that were acked, but are waiting for one that
+     * arrived before them.
+     * @return The number of messages in flight.
+     */
+    std::size_t num_in_flight() const {
+        guard g{lock_};
+        return slots_.size();
+    }
+    /**
+     * Determines if the most messages are in flight, so that new ones
+     * should be held back until some are released.
+     * @return @em true if the tracker is full.
+     */
+    bool full() const {
+        guard g{lock_};
+        return maxInFlight_ != 0 && slots_.size() >= maxInFlight_;
+    }
+    /**
+     * Gets the number of acks that were released.
+     * @return The number of acks released.
+     */
+    uint64_t num_released() const {
+        guard g{lock_};
+        return baseSeq_;
+    }
+    /**
+     * Gets the number of messages that were tracked.
+     * @return The number of messages tracked.
+     */
+    uint64_t num_tracked() const {
+        guard g{lock_};
+        return baseSeq_ + slots_.size();
+    }
+};
+
+/** Smart/shared pointer to an ack_tracker */
+using ack_tracker_ptr = ack_tracker::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_ack_tracker_h
@@ -0,0 +1,406 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file asio.h
+/// Adapters to use the Paho MQTT C++ library with Asio, by way of
+/// completion tokens, executors, and batched message delivery.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_asio_h
+#define __mqtt_asio_h
+
+// The library itself doesn't use Asio. This header is only usable by
+// applications that have Boost.Asio, or standalone Asio if
+// PAHO_MQTTPP_STANDALONE_ASIO is defined.
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(PAHO_MQTTPP_STANDALONE_ASIO)
+    #include <asio.hpp>
+#else
+    #include <boost/asio.hpp>
+#endif
+
+#include "mqtt/async_client.h"
+#include "mqtt/executor.h"
+
+namespace mqtt {
+
+namespace asio_detail {
+
+#if defined(PAHO_MQTTPP_STANDALONE_ASIO)
+namespace net = ::asio;
+#else
+namespace net = ::boost::asio;
+#endif
+
+// The state of an operation, shared by copies of the C++ library's
+// completion handler, since Asio handlers are often move-only.
+template <typename Handler, typename T>
+struct wait_op
+{
+    using executor_type = net::associated_executor_t<Handler>;
+
+    Handler handler;
+    net::executor_work_guard<executor_type> work;
+
+    explicit wait_op(Handler&& h)
+        : handler{std::move(h)}, work{net::get_associated_executor(handler)} {}
+
+    // Hands the result to the handler, through its executor.
+    void complete(std::exception_ptr eptr, std::shared_ptr<T> tok) {
+        auto ex = work.get_executor();
+        net::dispatch(ex, [h = std::move(handler), eptr, tok = std::move(tok)]() mutable {
+            std::move(h)(eptr, std::move(tok));
+        });
+        work.reset();
+    }
+};
+
+// Starts the operation made by a factory, and completes the handler when
+// its token does. An exception that the factory throws completes the
+// handler, too, rather than escaping from the initiating call.
+template <typename T, typename Factory, typename CompletionToken>
+auto async_start(Factory&& make_tok, CompletionToken&& token) {
+    return net::async_initiate<CompletionToken, void(std::exception_ptr, std::shared_ptr<T>)>(
+        [](auto handler, std::decay_t<Factory> make_tok) {
+            using op_type = wait_op<decltype(handler), T>;
+            auto op = std::make_shared<op_type>(std::move(handler));
+
+            std::shared_ptr<T> tok;
+            try {
+                tok = make_tok();
+            }
+            catch (...) {
+                op->complete(std::current_exception(), nullptr);
+                return;
+            }
+
+            auto done = [op, tok] {
+                std::exception_ptr eptr;
+                try {
+                    tok->wait();
+                }
+                catch (...) {
+                    eptr = std::current_exception();
+                }
+                op->complete(eptr, tok);
+            };
+
+            if (!tok || !tok->set_complete_handler(done))
+                done();
+        },
+        token, std::forward<Factory>(make_tok)
+    );
+}
+
+}  // namespace asio_detail
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An @ref executor that posts the tasks to an Asio executor, like the
+ * one for an @em io_context or a strand.
+ *
+ * Set on a client with `async_client::set_completion_executor()`, this
+ * runs its completion callbacks on the app's event loop.
+ *
+ * @tparam Executor The type of Asio executor.
+ */
+template <typename Executor>
+class asio_executor : public executor
+{
+    /** The Asio executor */
+    Executor ex_;
+
+public:
+    /**
+     * Creates an executor that posts to the Asio executor.
+     * @param ex The Asio executor.
+     */
+    explicit asio_executor(Executor ex) : ex_{std::move(ex)} {}
+    /**
+     * Gets the Asio executor.
+     * @return The Asio executor.
+     */
+    const Executor& get_executor() const { return ex_; }
+    /**
+     * Posts the task to the Asio executor.
+     * @param task The task to run.
+     * @return Always @em true.
+     */
+    bool execute(task_type task) override {
+        asio_detail::net::post(ex_, std::move(task));
+        return true;
+    }
+};
+
+/**
+ * Creates an @ref executor that posts tasks to an Asio executor.
+ * @param ex The Asio executor.
+ * @return A shared pointer to the executor.
+ */
+template <typename Executor>
+executor_ptr make_asio_executor(Executor ex) {
+    return std::make_shared<asio_executor<Executor>>(std::move(ex));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Waits for a token to complete, with an Asio completion token.
+ *
+ * This works with any completion token, like a callback, @em use_future,
+ * or @em use_awaitable. The completion signature is:
+ * @code
+ * void(std::exception_ptr, std::shared_ptr<T>)
+ * @endcode
+ * where the exception is the one that `token::wait()` throws if the
+ * operation failed. The handler is run through its associated executor,
+ * so a callback bound to a strand runs on the strand. A handler without
+ * one runs on the library's callback thread.
+ *
+ * @param tok The token for the operation.
+ * @param token The Asio completion token.
+ */
+template <typename T, typename CompletionToken>
+auto async_wait(std::shared_ptr<T> tok, CompletionToken&& token) {
+    return asio_detail::async_start<T>(
+        [tok = std::move(tok)] { return tok; }, std::forward<CompletionToken>(token)
+    );
+}
+
+/**
+ * Connects a client, with an Asio completion token.
+ * @param cli The client.
+ * @param opts The connect options.
+ * @param token The Asio completion token.
+ */
+template <typename CompletionToken>
+auto async_connect(async_client& cli, connect_options opts, CompletionToken&& token) {
+    return asio_detail::async_start<mqtt::token>(
+        [&cli, opts = std::move(opts)] { return cli.connect(opts); },
+        std::forward<CompletionToken>(token)
+    );
+}
+
+/**
+ * Disconnects a client, with an Asio completion token.
+ * @param cli The client.
+ * @param token The Asio completion token.
+ */
+template <typename CompletionToken>
+auto async_disconnect(async_client& cli, CompletionToken&& token) {
+    return asio_detail::async_start<mqtt::token>(
+        [&cli] { return cli.disconnect(); }, std::forward<CompletionToken>(token)
+    );
+}
+
+/**
+ * Publishes a message, with an Asio completion token.
+ * @param cli The client.
+ * @param msg The message.
+ * @param token The Asio completion token.
+ */
+template <typename CompletionToken>
+auto async_publish(async_client& cli, const_message_ptr msg, CompletionToken&& token) {
+    return asio_detail::async_start<delivery_token>(
+        [&cli, msg = std::move(msg)] { return cli.publish(msg); },
+        std::forward<CompletionToken>(token)
+    );
+}
+
+/**
+ * Subscribes to a topic filter, with an Asio completion token.
+ * @param cli The client.
+ * @param topicFilter The topic filter.
+ * @param qos The QoS for the subscription.
+ * @param token The Asio completion token.
+ */
+template <typename CompletionToken>
+auto async_subscribe(
+    async_client& cli, string topicFilter, int qos, CompletionToken&& token
+) {
+    return asio_detail::async_start<mqtt::token>(
+        [&cli, topicFilter = std::move(topicFilter), qos] {
+            return cli.subscribe(topicFilter, qos);
+        },
+        std::forward<CompletionToken>(token)
+    );
+}
+
+/**
+ * Unsubscribes from a topic filter, with an Asio completion token.
+ * @param cli The client.
+ * @param topicFilter The topic filter.
+ * @param token The Asio completion token.
+ */
+template <typename CompletionToken>
+auto async_unsubscribe(async_client& cli, string topicFilter, CompletionToken&& token) {
+    return asio_detail::async_start<mqtt::token>(
+        [&cli, topicFilter = std::move(topicFilter)] { return cli.unsubscribe(topicFilter); },
+        std::forward<CompletionToken>(token)
+    );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Delivers incoming messages to an Asio executor, like a strand, in
+ * batches.
+ *
+ * Rather than a post for each message, the messages that arrive while a
+ * delivery is waiting to run are added to it, so a burst of messages
+ * becomes a single post, and the handler gets them all at once, in the
+ * order they arrived. The batches are cut at @em maxBatch messages, if
+ * set, so the handler doesn't hold the executor for too long.
+ *
+ * @tparam Executor The type of Asio executor.
+ */
+template <typename Executor>
+class asio_message_poster : public std::enable_shared_from_this<asio_message_poster<Executor>>
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<asio_message_poster>;
+    /** The handler for a batch of messages */
+    using batch_handler = std::function<void(const std::vector<const_message_ptr>&)>;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** The Asio executor */
+    Executor ex_;
+    /** The handler for the batches */
+    batch_handler handler_;
+    /** The most messages in a batch, or zero for no limit */
+    std::size_t maxBatch_;
+
+    /** Lock for the fields below */
+    std::mutex lock_;
+    /** The messages waiting to be delivered */
+    std::vector<const_message_ptr> pending_;
+    /** Whether a delivery was posted, and hasn't run yet */
+    bool posted_{false};
+    /** The number of deliveries that were posted */
+    std::size_t nPosts_{0};
+
+    /** Posts a delivery to the executor. Called with the lock held. */
+    void schedule() {
+        posted_ = true;
+        ++nPosts_;
+        asio_detail::net::post(ex_, [self = this->shared_from_this()] { self->deliver(); });
+    }
+    /** Runs on the executor, to hand a batch to the handler. */
+    void deliver() {
+        std::vector<const_message_ptr> batch;
+        {
+            guard g{lock_};
+            if (maxBatch_ == 0 || pending_.size() <= maxBatch_) {
+                batch.swap(pending_);
+                posted_ = false;
+            }
+            else {
+                auto first = pending_.begin(), last = first + maxBatch_;
+                batch.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+                pending_.erase(first, last);
+                schedule();
+            }
+        }
+        if (handler_ && !batch.empty())
+            handler_(batch);
+    }
+
+public:
+    /**
+     * Creates a poster.
+     * @param ex The Asio executor to deliver the messages on.
+     * @param handler The handler for each batch of messages.
+     * @param maxBatch The most messages in a batch, or zero for no limit.
+     */
+    asio_message_poster(Executor ex, batch_handler handler, std::size_t maxBatch = 0)
+        : ex_{std::move(ex)}, handler_{std::move(handler)}, maxBatch_{maxBatch} {}
+    /**
+     * Creates a poster.
+     * @param ex The Asio executor to deliver the messages on.
+     * @param handler The handler for each batch of messages.
+     * @param maxBatch The most messages in a batch, or zero for no limit.
+     * @return A shared pointer to the poster.
+     */
+    static ptr_t create(Executor ex, batch_handler handler, std::size_t maxBatch = 0) {
+        return std::make_shared<asio_message_poster>(
+            std::move(ex), std::move(handler), maxBatch
+        );
+    }
+    /**
+     * Queues a message for delivery.
+     * This can be called from any thread.
+     * @param msg The message.
+     */
+    void post(const_message_ptr msg) {
+        guard g{lock_};
+        pending_.push_back(std::move(msg));
+        if (!posted_)
+            schedule();
+    }
+    /**
+     * Sets this as the message callback of a client.
+     * The client keeps a reference to the poster.
+     * @param cli The client.
+     */
+    void attach(async_client& cli) {
+        cli.set_message_callback([self = this->shared_from_this()](const_message_ptr msg) {
+            self->post(std::move(msg));
+        });
+    }
+    /**
+     * Gets the number of deliveries that were posted to the executor.
+     * @return The number of posts.
+     */
+    std::size_t num_posts() {
+        guard g{lock_};
+        return nPosts_;
+    }
+};
+
+/**
+ * Creates a poster to deliver messages to an Asio executor in batches.
+ * @param ex The Asio executor to deliver the messages on.
+ * @param handler The handler for each batch of messages.
+ * @param maxBatch The most messages in a batch, or zero for no limit.
+ * @return A shared pointer to the poster.
+ */
+template <typename Executor>
+typename asio_message_poster<Executor>::ptr_t make_asio_message_poster(
+    Executor ex, typename asio_message_poster<Executor>::batch_handler handler,
+    std::size_t maxBatch = 0
+) {
+    return asio_message_poster<Executor>::create(std::move(ex), std::move(handler), maxBatch);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_asio_h
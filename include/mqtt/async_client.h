@@ -34,27 +34,66 @@
 #ifndef __mqtt_async_client_h
 #define __mqtt_async_client_h
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <functional>
-#include <list>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "MQTTAsync.h"
+#include "mqtt/ack_tracker.h"
+#include "mqtt/batch_token.h"
+#include "mqtt/buffer_view.h"
 #include "mqtt/callback.h"
+#include "mqtt/client_metrics.h"
 #include "mqtt/create_options.h"
 #include "mqtt/delivery_token.h"
+#include "mqtt/dispatcher.h"
+#include "mqtt/duplicate_filter.h"
 #include "mqtt/event.h"
 #include "mqtt/exception.h"
+#include "mqtt/group_commit_persistence.h"
 #include "mqtt/iaction_listener.h"
 #include "mqtt/iasync_client.h"
 #include "mqtt/iclient_persistence.h"
+#include "mqtt/inflight_window.h"
+#include "mqtt/last_value_cache.h"
+#include "mqtt/conflating_queue.h"
+#include "mqtt/delta_codec.h"
+#include "mqtt/lock_free_queue.h"
+#include "mqtt/memory_usage.h"
 #include "mqtt/message.h"
+#include "mqtt/message_batcher.h"
+#include "mqtt/message_tracer.h"
+#include "mqtt/offline_buffer.h"
+#include "mqtt/payload_codec.h"
 #include "mqtt/properties.h"
+#include "mqtt/publish_coalescer.h"
+#include "mqtt/publish_retrier.h"
+#include "mqtt/rate_limiter.h"
+#include "mqtt/receive_filter.h"
+#include "mqtt/serializer.h"
 #include "mqtt/string_collection.h"
 #include "mqtt/thread_queue.h"
+#include "mqtt/timer_wheel.h"
 #include "mqtt/token.h"
+#include "mqtt/topic_alias_manager.h"
+#include "mqtt/topic_matcher.h"
+#include "mqtt/topic_stats.h"
+#include "mqtt/try_result.h"
 #include "mqtt/types.h"
 
 namespace mqtt {
@@ -122,17 +161,186 @@ class async_client : public virtual iasync_client
 public:
     /** Smart/shared pointer for an object of this class */
     using ptr_t = std::shared_ptr<async_client>;
+
+    /**
+     * The default maximum number of topic filters sent in a single
+     * request by subscribe_batch() and unsubscribe_batch().
+     */
+    static constexpr std::size_t DFLT_SUBSCRIBE_CHUNK_SIZE = 100;
+
+    /**
+     * The result of flushing the client's deliveries before disconnecting.
+     * @sa flush_and_disconnect()
+     */
+    struct flush_result
+    {
+        /** The delivery tokens that didn't complete before the deadline */
+        std::vector<delivery_token_ptr> undelivered;
+        /** The token for the disconnect */
+        token_ptr disconnectTok;
+    };
+
+    /**
+     * Interface to the thread-safe queue used to consume events
+     * synchronously.
+     * This allows the application to choose the type of queue used by the
+     * consumer, such as the default, locking, @ref thread_queue, or a
+     * @ref lock_free_queue.
+     */
+    class consumer_queue
+    {
+    public:
+        /** The type of clock used for timed operations */
+        using clock = std::chrono::steady_clock;
+
+        virtual ~consumer_queue() {}
+        /** Gets the number of events in the queue. */
+        virtual std::size_t size() const = 0;
+        /** Determines if the queue is closed. */
+        virtual bool closed() const = 0;
+        /** Determines if the queue is closed and empty */
+        virtual bool done() const = 0;
+        /** Discards all the events in the queue. */
+        virtual void clear() = 0;
+        /** Closes the queue. */
+        virtual void close() = 0;
+        /** Puts an event into the queue, blocking if it is full. */
+        virtual void put(event evt) = 0;
+        /** Removes the next event, blocking until one is available. */
+        virtual event get() = 0;
+        /** Removes the next event if one is available, without blocking */
+        virtual bool try_get(event* evt) = 0;
+        /** Removes the next event, waiting up to the specified time. */
+        virtual bool try_get_until(event* evt, const clock::time_point& absTime) = 0;
+        /** Removes up to 'n' events without blocking. */
+        virtual std::size_t try_get_n(std::vector<event>* evts, std::size_t n) = 0;
+        /** Removes up to 'n' events, waiting up to the specified time. */
+        virtual std::size_t try_get_n_until(
+            std::vector<event>* evts, std::size_t n, const clock::time_point& absTime
+        ) = 0;
+        /** Gets the maximum number of events the queue can hold. */
+        virtual std::size_t capacity() const { return std::numeric_limits<std::size_t>::max(); }
+        /**
+         * Gets the number of events that the queue dropped, or replaced
+         * with newer ones, because it was full.
+         */
+        virtual uint64_t num_dropped() const { return 0; }
+        /**
+         * Sets how a consumer waits on an empty queue, if the queue lets
+         * it be set.
+         */
+        virtual void set_wait_strategy(const wait_strategy&) {}
+        /**
+         * Gets the bytes of the events in the queue, and their high-water
+         * mark, if the queue keeps them.
+         */
+        virtual std::size_t bytes() const { return 0; }
+        /** Gets the most bytes there have been in the queue */
+        virtual std::size_t peak_bytes() const { return 0; }
+    };
+
+    /**
+     * Adapter to use a queue class as the consumer queue.
+     * @tparam Queue A thread-safe queue of @ref event objects with the same
+     *  			 interface as @ref thread_queue.
+     */
+    template <class Queue>
+    class consumer_queue_adapter : public consumer_queue
+    {
+        /** The actual queue */
+        Queue que_;
+
+        /** Gets a count from the queue, if it keeps one */
+        template <class Q>
+        static auto dropped(const Q& q, int) -> decltype(uint64_t(q.num_dropped())) {
+            return q.num_dropped();
+        }
+        template <class Q>
+        static uint64_t dropped(const Q&, long) { return 0; }
+        /** Gets a count from the queue, if it keeps one */
+        template <class Q>
+        static auto conflated(const Q& q, int) -> decltype(uint64_t(q.num_conflated())) {
+            return q.num_conflated();
+        }
+        template <class Q>
+        static uint64_t conflated(const Q&, long) { return 0; }
+        /** Sets the wait strategy of the queue, if it has one */
+        template <class Q>
+        static auto set_strategy(Q& q, const wait_strategy& ws, int)
+            -> decltype(q.set_wait_strategy(ws)) {
+            return q.set_wait_strategy(ws);
+        }
+        template <class Q>
+        static void set_strategy(Q&, const wait_strategy&, long) {}
+        /** Gets the bytes in the queue, if it keeps them */
+        template <class Q>
+        static auto num_bytes(const Q& q, int) -> decltype(std::size_t(q.bytes())) {
+            return q.bytes();
+        }
+        template <class Q>
+        static std::size_t num_bytes(const Q&, long) { return 0; }
+        /** Gets the peak bytes in the queue, if it keeps them */
+        template <class Q>
+        static auto peak(const Q& q, int) -> decltype(std::size_t(q.peak_bytes())) {
+            return q.peak_bytes();
+        }
+        template <class Q>
+        static std::size_t peak(const Q&, long) { return 0; }
+
+    public:
+        /**
+         * Creates the queue.
+         * @param args The arguments to pass to the queue constructor.
+         */
+        template <typename... Args>
+        explicit consumer_queue_adapter(Args&&... args) : que_(std::forward<Args>(args)...) {}
+
+        std::size_t size() const override { return que_.size(); }
+        bool closed() const override { return que_.closed(); }
+        bool done() const override { return que_.done(); }
+        void clear() override { que_.clear(); }
+        void close() override { que_.close(); }
+        void put(event evt) override { que_.put(std::move(evt)); }
+        event get() override { return que_.get(); }
+        bool try_get(event* evt) override { return que_.try_get(evt); }
+        bool try_get_until(event* evt, const clock::time_point& absTime) override {
+            return que_.try_get_until(evt, absTime);
+        }
+        std::size_t try_get_n(std::vector<event>* evts, std::size_t n) override {
+            return que_.try_get_n(evts, n);
+        }
+        std::size_t try_get_n_until(
+            std::vector<event>* evts, std::size_t n, const clock::time_point& absTime
+        ) override {
+            return que_.try_get_n_until(evts, n, absTime);
+        }
+        std::size_t capacity() const override { return que_.capacity(); }
+        uint64_t num_dropped() const override { return dropped(que_, 0) + conflated(que_, 0); }
+        void set_wait_strategy(const wait_strategy& ws) override { set_strategy(que_, ws, 0); }
+        std::size_t bytes() const override { return num_bytes(que_, 0); }
+        std::size_t peak_bytes() const override { return peak(que_, 0); }
+    };
+
     /** Type for a thread-safe queue to consume events synchronously */
-    using consumer_queue_type = std::unique_ptr<thread_queue<event>>;
+    using consumer_queue_type = std::unique_ptr<consumer_queue>;
 
     /** Handler type for registering an individual message callback */
     using message_handler = std::function<void(const_message_ptr)>;
+    /** Handler for a consumer waiting on the next message */
+    using message_waiter = std::function<void(const_message_ptr)>;
     /** Handler type for when a connection is made or lost */
     using connection_handler = std::function<void(const string& cause)>;
     /** Handler type for when a disconnect packet is received */
     using disconnected_handler = std::function<void(const properties&, ReasonCode)>;
     /** Handler for updating connection data before an auto-reconnect. */
     using update_connection_handler = std::function<bool(connect_data&)>;
+    /** Handler type for a batch of completed deliveries */
+    using delivery_batch_handler = std::function<void(const std::vector<delivery_token_ptr>&)>;
+
+    /** The default maximum number of completed deliveries in a batch */
+    static constexpr std::size_t DFLT_DELIVERY_BATCH_SIZE = 256;
+    /** The default longest time a completed delivery is held in a batch */
+    static constexpr std::chrono::milliseconds DFLT_DELIVERY_BATCH_DELAY{100};
 
 private:
     /** Lock guard type for this class */
@@ -140,6 +348,139 @@ private:
     /** Unique lock type for this class */
     using unique_lock = std::unique_lock<std::mutex>;
 
+    /**
+     * A table of the tokens that are in play.
+     *
+     * Tokens are uniquely identified by the address of the object, since
+     * the message ID is not unique. Once a delivery token has been
+     * assigned a message ID by the C library, it is also indexed by that
+     * ID so that in-flight QoS 1 & 2 messages can be found quickly.
+     *
+     * The table is split into a number of shards, each with its own lock,
+     * so that adding and removing tokens are O(1) operations and the
+     * completion callbacks from the C library rarely contend with the
+     * application threads creating new requests. The number of shards
+     * is set by the create options, since a process with many clients
+     * that are each lightly loaded is better off with just one.
+     */
+    class token_table
+    {
+
+        /** A single, independently-locked, section of the table */
+        struct shard
+        {
+            /** Lock for this shard */
+            mutable std::mutex lock;
+            /** The non-delivery tokens, by address */
+            std::unordered_map<const token*, token_ptr> toks;
+            /** The delivery tokens, by address */
+            std::unordered_map<const token*, delivery_token_ptr> dtoks;
+            /** The delivery tokens, by message ID */
+            std::unordered_map<int, delivery_token_ptr> ids;
+        };
+
+        /** The shards */
+        std::unique_ptr<shard[]> shards_;
+        /** The number of shards less one, as a mask (power of two less one) */
+        size_t mask_;
+        /** The number of tokens in the table, including delivery tokens */
+        std::atomic<size_t> nToks_{0};
+        /** The number of delivery tokens in the table */
+        std::atomic<size_t> nDtoks_{0};
+        /** The memory of the non-delivery tokens */
+        memory_gauge tokBytes_;
+        /** The memory of the delivery tokens, with their messages */
+        memory_gauge dtokBytes_;
+        /** Lock for waiting on the delivery tokens to drain */
+        mutable std::mutex drainLock_;
+        /** Signaled when the last delivery token is removed */
+        mutable std::condition_variable drainCond_;
+
+        /** Wakes the threads waiting for the delivery tokens to drain */
+        void notify_drained();
+        /** Gets the estimated memory of a token and its topics */
+        static size_t memory_size(const token& tok);
+        /** Gets the estimated memory of a delivery token and its message */
+        static size_t memory_size(const delivery_token& tok);
+
+        /** Gets the index of the shard for the token with the address */
+        size_t addr_shard_index(const token* tok) const {
+            // Skip the low bits which are always zero due to alignment
+            auto n = reinterpret_cast<std::uintptr_t>(tok) >> 4;
+            return size_t(n ^ (n >> 8)) & mask_;
+        }
+        /** Gets the shard holding the token with the specified address */
+        shard& addr_shard(const token* tok) { return shards_[addr_shard_index(tok)]; }
+        /** Gets the shard holding the token with the specified address */
+        const shard& addr_shard(const token* tok) const {
+            return shards_[addr_shard_index(tok)];
+        }
+        /** Gets the shard holding the token with the specified message ID */
+        shard& id_shard(int msgID) { return shards_[size_t(msgID) & mask_]; }
+        /** Gets the shard holding the token with the specified message ID */
+        const shard& id_shard(int msgID) const {
+            return shards_[size_t(msgID) & mask_];
+        }
+
+    public:
+        /**
+         * Creates a table.
+         * @param nShards The number of shards, rounded up to a power of
+         *  			  two.
+         */
+        explicit token_table(size_t nShards);
+        /** Adds a token to the table */
+        void add(token_ptr tok);
+        /** Adds a delivery token to the table */
+        void add(delivery_token_ptr tok);
+        /**
+         * Indexes a delivery token by its message ID.
+         * This should be called after the message ID is assigned to the
+         * token. It is ignored if the token has already been removed.
+         */
+        void index(const delivery_token_ptr& tok);
+        /**
+         * Drops the message ID index of a delivery token, if it still
+         * refers to the token, so that it can be sent again with a new ID.
+         */
+        void unindex(const delivery_token_ptr& tok);
+        /**
+         * Removes the token from the table.
+         * @return The token, if it was a delivery token, otherwise null.
+         */
+        delivery_token_ptr remove(const token* tok);
+        /**
+         * Removes a number of delivery tokens from the table, locking each
+         * shard once.
+         * @return The tokens that were removed, in the same order.
+         */
+        std::vector<delivery_token_ptr> remove(std::vector<delivery_token_ptr> toks);
+        /** Gets a delivery token in the table by its address, if it's there */
+        delivery_token_ptr find_delivery_token(const token* tok) const;
+        /** Gets the delivery token with the specified message ID, if any */
+        delivery_token_ptr get_delivery_token(int msgID) const;
+        /** Gets the delivery tokens for all the in-flight messages */
+        std::vector<delivery_token_ptr> get_delivery_tokens() const;
+        /**
+         * Gets all the delivery tokens that haven't completed, including
+         * the ones that haven't been given a message ID yet.
+         */
+        std::vector<delivery_token_ptr> get_incomplete_delivery_tokens() const;
+        /**
+         * Waits for the table to run out of delivery tokens.
+         * @return @em true if it did, @em false if the time ran out.
+         */
+        bool wait_drained(const std::chrono::steady_clock::time_point& deadline) const;
+        /** Gets the number of tokens, including delivery tokens */
+        size_t size() const { return nToks_.load(std::memory_order_relaxed); }
+        /** Gets the number of delivery tokens */
+        size_t num_delivery_tokens() const { return nDtoks_.load(std::memory_order_relaxed); }
+        /** Gets the memory of the non-delivery tokens */
+        const memory_gauge& token_bytes() const { return tokBytes_; }
+        /** Gets the memory of the delivery tokens */
+        const memory_gauge& delivery_token_bytes() const { return dtokBytes_; }
+    };
+
     /** Object monitor mutex */
     mutable std::mutex lock_;
     /** The underlying C-lib client. */
@@ -150,6 +491,8 @@ private:
     int mqttVersion_;
     /** A user persistence wrapper (if any) */
     std::unique_ptr<MQTTClient_persistence> persist_{};
+    /** A group commit adapter for the user persistence (if any) */
+    std::unique_ptr<group_commit_persistence> groupCommit_{};
     /** Callback supplied by the user (if any) */
     callback* userCallback_{};
     /** Connection handler */
@@ -162,16 +505,395 @@ private:
     update_connection_handler updateConnectionHandler_;
     /** Message handler */
     message_handler msgHandler_;
+    /** The pool of threads dispatching messages to the handler (if any) */
+    dispatcher_ptr dispatcher_;
+    /** The limiter for outgoing messages (if any) */
+    rate_limiter_ptr limiter_;
+    /** Whether there is a rate limiter, to skip the lock when there's not */
+    std::atomic<bool> rateLimited_{false};
+    /** The buffer for messages published while disconnected (if any) */
+    offline_buffer_ptr offlineBuf_;
+    /** Whether there is an offline buffer, to skip the lock when there's not */
+    std::atomic<bool> offlineBuffered_{false};
+    /** The wheel for the timers of the client, made when first needed */
+    mutable timer_wheel_ptr timerWheel_;
+    /** The wheel, once it's made, to get at it without the lock */
+    mutable std::atomic<timer_wheel*> wheel_{nullptr};
+    /** The default timeout for operations, in clock ticks, or zero for none */
+    std::atomic<std::chrono::steady_clock::rep> opTimeout_{0};
+    /** The adaptive window for QoS 1 and 2 messages in flight (if any) */
+    inflight_window_ptr window_;
+    /** Whether there is an in-flight window, to skip the lock when not */
+    std::atomic<bool> windowed_{false};
+    /** The retrier for failed publishes (if any) */
+    publish_retrier_ptr retrier_;
+    /** Whether failed publishes are retried, to skip the lock when not */
+    std::atomic<bool> retrying_{false};
+    /** The coalescer for outgoing QoS 0 messages (if any) */
+    std::unique_ptr<publish_coalescer> coalescer_;
+    /** The topic aliases for outgoing QoS 0 messages (if any) */
+    std::unique_ptr<topic_alias_manager> aliases_;
+    /** The executor for the completion callbacks (if any) */
+    executor_ptr completionExec_;
+    /** How threads wait on the consumer queue and tokens */
+    wait_strategy waitStrategy_;
     /** Cached options from the last connect */
     connect_options connOpts_;
     /** Copy of connect token (for re-connects) */
     token_ptr connTok_;
-    /** A list of tokens that are in play */
-    std::list<token_ptr> pendingTokens_;
-    /** A list of delivery tokens that are in play */
-    std::list<delivery_token_ptr> pendingDeliveryTokens_;
+    /** The tokens that are in play */
+    token_table pendingTokens_{createOpts_.get_token_table_shards()};
+    /** The counters for the client's activity */
+    client_metrics metrics_;
+    /** The soft limit on the memory held by the client, or zero for none */
+    std::atomic<std::size_t> memLimit_{0};
+    /** Whether incoming messages are held back while over the limit */
+    std::atomic<bool> memLimitHolds_{false};
+    /** Whether the client was over its memory limit, when last checked */
+    std::atomic<bool> overMemLimit_{false};
+    /** The handler for going over the memory limit */
+    memory_limit_handler memLimitHandler_;
+    /** The handler for batches of completed deliveries (if any) */
+    delivery_batch_handler deliveryBatchHandler_;
+    /** The maximum number of completed deliveries in a batch */
+    std::size_t maxDeliveryBatch_{DFLT_DELIVERY_BATCH_SIZE};
+    /** The longest a completed delivery is held, or zero for no limit */
+    std::chrono::steady_clock::duration maxDeliveryDelay_{DFLT_DELIVERY_BATCH_DELAY};
+    /** The timer that hands off the current batch when it's held too long */
+    timer_wheel::timer_id deliveryTimer_{0};
+    /** Whether completed deliveries are batched, to skip the lock when not */
+    std::atomic<bool> batchedDelivery_{false};
+    /** Lock for the current batch of completed deliveries */
+    std::mutex deliveryBatchLock_;
+    /** The completed deliveries that haven't been handed off yet */
+    std::vector<delivery_token_ptr> deliveryBatch_;
+    /** The hooks for tracing messages (if any) */
+    std::atomic<message_tracer*> tracer_{nullptr};
+    /** The codec for message payloads (if any) */
+    payload_codec_ptr codec_;
+    /** The smallest payload to encode with the codec */
+    std::size_t codecMinSize_{0};
+    /** Whether there is a payload codec, to skip the lock when there's not */
+    std::atomic<bool> hasCodec_{false};
+    /** The codec that sends payloads as deltas (if any) */
+    delta_codec_ptr deltaCodec_;
+    /** Whether there is a delta codec, to skip the lock when there's not */
+    std::atomic<bool> hasDeltaCodec_{false};
+    /** The tracker for the messages that the app acks itself (if any) */
+    ack_tracker_ptr ackTracker_;
+    /** Whether the app acks messages itself, to skip the lock when not */
+    std::atomic<bool> hasAckTracker_{false};
+#if defined(PAHO_MQTTPP_HAS_PMR)
+    /** The memory resource for the incoming messages (if any) */
+    std::atomic<std::pmr::memory_resource*> msgResource_{nullptr};
+#endif
+    /** Lock for the coroutines waiting on the consumer queue */
+    std::mutex awaitLock_;
+    /** The handlers for those waiting on the consumer queue, in order */
+    std::deque<message_waiter> awaiters_;
+    /** Whether anyone ever waited on the queue, to skip the lock when not */
+    std::atomic<bool> hasAwaiters_{false};
+    /** The cache of the latest message on each topic (if any) */
+    last_value_cache_ptr lvCache_;
+    /** Whether there is a last-value cache, to skip the lock when there's not */
+    std::atomic<bool> hasLvCache_{false};
+    /** The filter for incoming duplicates (if any) */
+    duplicate_filter_ptr dupFilter_;
+    /** Whether there is a duplicate filter, to skip the lock when there's not */
+    std::atomic<bool> hasDupFilter_{false};
+    /** The filter that thins out the incoming messages (if any) */
+    receive_filter_ptr recvFilter_;
+    /** Whether there is a receive filter, to skip the lock when there's not */
+    std::atomic<bool> hasRecvFilter_{false};
+    /** The traffic counts by topic (if any) */
+    topic_stats_ptr topicStats_;
+    /** Whether there are topic stats, to skip the lock when there's not */
+    std::atomic<bool> hasTopicStats_{false};
+    /** Whether incoming batches are unpacked into their records */
+    std::atomic<bool> unpackBatches_{false};
     /** A queue of messages for consumer API */
     consumer_queue_type que_;
+    /**
+     * The number of messages the consumer queue can hold before incoming
+     * messages are held back, or zero if they're never held back.
+     */
+    std::size_t flowCapacity_{0};
+    /** Lock for the interned topics */
+    mutable std::mutex internLock_;
+    /** The interned topics, keyed by a view of their own data */
+    std::unordered_map<std::string_view, string_ref> internedTopics_;
+    /** Lock for the subscription handlers */
+    mutable std::mutex subLock_;
+    /** The message handlers for individual subscriptions, by filter */
+    topic_matcher<std::shared_ptr<message_handler>> subHandlers_;
+    /** Whether there are any subscription handlers */
+    std::atomic<bool> hasSubHandlers_{false};
+    /**
+     * The handlers for the subscriptions tagged with an identifier by the
+     * client, indexed by the identifier. Slot zero is not used.
+     */
+    std::vector<std::shared_ptr<message_handler>> subIdHandlers_;
+    /** The freed identifiers, reused in the order they were released */
+    std::deque<uint32_t> freeSubIds_;
+    /** The identifier of each subscription with a handler, or zero if none */
+    std::map<string, uint32_t> handlerSubIds_;
+    /** The number of subscription handlers without an identifier */
+    size_t nUntaggedHandlers_{0};
+    /** Whether the application has set its own subscription identifiers */
+    bool userSubIds_{false};
+    /** Whether the server accepts subscription identifiers */
+    std::atomic<bool> subIdsAvailable_{false};
+    /** The subscriptions made through the client, to restore, by filter */
+    std::map<string, int> subs_;
+    /** The maximum number of filters in each request of a batch */
+    std::atomic<std::size_t> subChunkSize_{DFLT_SUBSCRIBE_CHUNK_SIZE};
+    /** The reconnect policy from the last connect (if any) */
+    const_reconnect_policy_ptr reconnPolicy_;
+    /** Lock for the managed reconnects */
+    std::mutex reconnLock_;
+    /** Signaled to cancel the managed reconnects */
+    std::condition_variable reconnCond_;
+    /** The thread that runs the managed reconnects, while it's needed */
+    std::thread reconnThr_;
+    /** Whether the reconnect thread is trying to connect */
+    bool reconnActive_{false};
+    /** Whether the current managed reconnects should be given up */
+    bool reconnCancel_{false};
+    /** Whether managed reconnects are stopped for good */
+    bool reconnClosed_{false};
+
+    /** Converts a time point to the clock used by the consumer queue */
+    template <class Clock, class Duration>
+    static consumer_queue::clock::time_point to_queue_time(
+        const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        using qclock = consumer_queue::clock;
+        if constexpr (std::is_same_v<Clock, qclock>)
+            return std::chrono::time_point_cast<qclock::duration>(absTime);
+        else
+            return qclock::now() + std::chrono::duration_cast<qclock::duration>(
+                absTime - Clock::now()
+            );
+    }
+
+    /**
+     * Gets the shared, interned, reference for a topic name.
+     * @return The interned topic, or a null reference if the table is
+     *  	   full and the topic is not in it.
+     */
+    string_ref intern_topic(const char* topicName, size_t len);
+    /** Gets the filter that a subscription's handler is matched against */
+    static string handler_filter(const string& topicFilter);
+    /**
+     * Adds a message handler for a subscription.
+     * @param topicFilter The topic filter.
+     * @param cb The handler.
+     * @param tagged Whether to tag the subscription with an identifier.
+     * @return The identifier for the subscription, or zero if it isn't
+     *  	   tagged.
+     */
+    uint32_t add_sub_handler(const string& topicFilter, message_handler cb, bool tagged);
+    /** Removes the message handler for a subscription, if any */
+    void remove_sub_handler(const string& topicFilter);
+    /**
+     * Subscribes to a single topic filter, without checking the properties
+     * for a subscription identifier.
+     */
+    token_ptr subscribe_filter(
+        const string& topicFilter, int qos, const subscribe_options& opts,
+        const properties& props
+    );
+    /** Subscribes to a single topic filter, reporting an error, not throwing */
+    token_result try_subscribe_filter(
+        const string& topicFilter, int qos, const subscribe_options& opts,
+        const properties& props
+    );
+    /** Releases a subscription identifier. Call with the lock held. */
+    void release_sub_id(uint32_t id);
+    /** Notes if the properties have a subscription identifier set by the app */
+    void check_user_sub_id(const properties& props);
+    /**
+     * Sends an incoming message to the handlers for any subscriptions that
+     * match its topic.
+     * @return @em true if any handlers matched, @em false otherwise.
+     */
+    bool dispatch_to_sub_handlers(const const_message_ptr& msg);
+    /**
+     * Checks the memory held by the client against the soft limit, if
+     * there is one, calling the handler when it goes over.
+     * @return @em true if the client is over the limit.
+     */
+    bool check_memory_limit();
+    /**
+     * Hands a message to the C library to send.
+     * On success, the token is indexed by its message ID.
+     * @return The return code from the library.
+     */
+    int send_message(const delivery_token_ptr& tok);
+    /**
+     * Hands a message, once it's encoded, to the C library to send for a
+     * token.
+     * @return The return code from the library.
+     */
+    int send_encoded(const delivery_token_ptr& tok, const_message_ptr msg);
+    /** Records a subscription, to restore after a reconnect */
+    void remember_subscription(const string& topicFilter, int qos);
+    /** Forgets a subscription, so it isn't restored after a reconnect */
+    void forget_subscription(const string& topicFilter);
+    /**
+     * Restores the subscriptions made through the client, as a
+     * subscription batch.
+     */
+    void resubscribe();
+    /**
+     * Starts the managed reconnects for a lost connection, if there's a
+     * reconnect policy.
+     */
+    void start_reconnect();
+    /**
+     * Stops any managed reconnects that are in progress.
+     * @param close Whether to stop them for good, when the client is
+     *  			being destroyed.
+     */
+    void stop_reconnect(bool close = false);
+    /** The function run by the reconnect thread */
+    void reconnect_loop(const_reconnect_policy_ptr policy);
+    /**
+     * Applies the thread options to the C library thread that runs the
+     * callbacks, the first time a client with options runs on it.
+     */
+    void check_callback_thread() const;
+    /**
+     * Starts tracing a message that's being published, adding the trace
+     * context to the message.
+     */
+    void begin_trace(message_tracer& tr, const delivery_token_ptr& tok);
+    /**
+     * Encodes the payload of an outgoing message with the codec, if it's
+     * worth it.
+     * @return The encoded message, or the original one if it wasn't
+     *  	   encoded.
+     */
+    const_message_ptr encode_payload(
+        const payload_codec& codec, std::size_t minSize, const_message_ptr msg
+    ) const;
+    /**
+     * Encodes the payload of an outgoing message with the client's codec,
+     * if there is one, and it's worth it.
+     * @return The encoded message, or the original one if it wasn't
+     *  	   encoded.
+     */
+    const_message_ptr encode_payload(const_message_ptr msg) const;
+    /**
+     * Hands a message to the C library, with a topic alias if possible.
+     * @return The return code from the library.
+     */
+    int send_message(
+        const string& topic, const MQTTAsync_message& cmsg, MQTTAsync_responseOptions& opts
+    );
+    /**
+     * Hands a message to the C library through the topic alias manager.
+     * @return The return code from the library.
+     */
+    int send_aliased(
+        const string& topic, const MQTTAsync_message& cmsg, MQTTAsync_responseOptions& opts
+    );
+    /**
+     * Sends a message that was held back by the client, failing the token
+     * if the library won't take it.
+     */
+    void send_held_message(const delivery_token_ptr& tok);
+    /** Fails a token for a message that was never sent */
+    static void fail_token(const delivery_token_ptr& tok, int rc);
+    /** Sets the deadline of a new operation, if there's a timeout */
+    void arm_operation_timeout(const token_ptr& tok);
+    /**
+     * Puts a message in the offline buffer, to be sent when the client
+     * connects.
+     * @return @em true if the message was buffered, @em false if the
+     *  	   buffer is full.
+     */
+    bool buffer_message(offline_buffer& buf, const delivery_token_ptr& tok);
+    /**
+     * Publishes the message in a new delivery token, through the rate
+     * limiter, if any.
+     */
+    delivery_token_ptr publish_token(delivery_token_ptr tok);
+    /**
+     * Publishes the message in a new delivery token, reporting an error
+     * rather than throwing it.
+     */
+    publish_result try_publish_token(delivery_token_ptr tok);
+    /**
+     * Starts the consumer with the queue, and the capacity at which
+     * incoming messages are held back (zero for never).
+     */
+    void start_consuming(consumer_queue_type que, std::size_t flowCapacity);
+    /**
+     * Adds the Receive Maximum property for flow control to the connect
+     * options, if needed.
+     */
+    void add_flow_control(connect_options& opts) const;
+    /**
+     * Handles an event just taken from the consumer queue. An incoming
+     * message is stamped with the time it was taken, then this determines
+     * if it expired while it waited in the queue, counting it if so. An
+     * expired message is acked, so it doesn't hold up the ones behind it
+     * in manual-ack mode.
+     * @return @em true if the event should be dropped.
+     */
+    bool on_dequeued(event& evt, message::time_point now) {
+        auto pmsg = evt.get_message_if();
+        if (!pmsg || !*pmsg)
+            return false;
+
+        (*pmsg)->dequeueTime_ = now;
+        if ((*pmsg)->is_expired(now)) {
+            (*pmsg)->ack();
+            metrics_.on_expired_received();
+            return true;
+        }
+        return false;
+    }
+    /**
+     * Handles an event just taken from the consumer queue, reading the
+     * clock only if it's a message.
+     * @return @em true if the event should be dropped.
+     */
+    bool on_dequeued(event& evt) {
+        return evt.get_message_if() && on_dequeued(evt, message::clock::now());
+    }
+    /**
+     * Handles the events that were added to the end of the vector,
+     * starting at 'first', with a single read of the clock, and removes
+     * the expired messages.
+     * @return The number of events removed.
+     */
+    std::size_t on_dequeued(std::vector<event>& evts, std::size_t first);
+    /**
+     * Takes the next message for a waiter from the consumer queue,
+     * skipping connect events and expired messages. This must be called
+     * with the await lock held.
+     * @param msg Gets the message, or a null pointer if the connection was
+     *  		  lost or consuming stopped.
+     * @return @em true if there was something for the waiter.
+     */
+    bool next_awaited(const_message_ptr* msg);
+    /**
+     * Hands the events in the consumer queue to the waiters, if there are
+     * any. This is called after each event is put into the queue. The
+     * fence pairs with the one in await_message(), so that either the
+     * waiter sees the event, or this sees the waiter.
+     */
+    void notify_awaiters() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (hasAwaiters_.load(std::memory_order_relaxed))
+            do_notify_awaiters();
+    }
+    /**
+     * Hands the events in the consumer queue to the waiters.
+     */
+    void do_notify_awaiters();
 
     /** Callbacks from the C library */
     static void on_connected(void* context, char* cause);
@@ -192,6 +914,42 @@ private:
     virtual void remove_token(token* tok) override;
     virtual void remove_token(token_ptr tok) { remove_token(tok.get()); }
     void remove_token(delivery_token_ptr tok) { remove_token(tok.get()); }
+    /**
+     * Schedules a failed publish to be sent again, if the retrier says so,
+     * or makes it a dead letter if it ran out of retries.
+     */
+    bool retry_delivery(token& tok, int rc, ReasonCode reason) override;
+    /**
+     * Holds a completed delivery for the batched delivery handler.
+     * @return @em false if the token isn't one that gets batched.
+     */
+    bool hold_delivery(const token* tok);
+    /**
+     * Removes a batch of completed deliveries from the pending table and
+     * hands them to the batched delivery handler, once the timer for the
+     * batch is cancelled.
+     */
+    void deliver_batch(
+        std::vector<delivery_token_ptr> toks, const delivery_batch_handler& cb,
+        timer_wheel::timer_id timer
+    );
+    /**
+     * Updates the metrics and tracer for a completed delivery, and gives
+     * back its slot in the in-flight window, if it has one.
+     */
+    void on_delivery_done(delivery_token& dtok);
+    /**
+     * Makes the operation that sends a message once it has a slot in an
+     * in-flight window.
+     */
+    inflight_window::task_type window_task(
+        const inflight_window_ptr& win, const delivery_token_ptr& tok
+    );
+    /**
+     * Sends a held message, through the in-flight window if there is one
+     * and the message takes a slot.
+     */
+    void send_in_window(const delivery_token_ptr& tok);
 
     /** Non-copyable */
     async_client() = delete;
@@ -317,20 +1075,748 @@ public:
      * Callback for when a connection is lost.
      * @param cb Callback functor for when the connection is lost.
      */
-    void set_connection_lost_handler(connection_handler cb) /*override*/;
+    void set_connection_lost_handler(connection_handler cb) /*override*/;
+    /**
+     * Callback for when a disconnect packet is received from the server.
+     * @param cb Callback for when the disconnect packet is received.
+     */
+    void set_disconnected_handler(disconnected_handler cb) /*override*/;
+    /**
+     * Sets the callback for when a message arrives from the broker.
+     * Note that the application can only have one message handler which can
+     * be installed individually using this method, or installled as a
+     * listener object.
+     * @param cb The callback functor to register with the library.
+     */
+    void set_message_callback(message_handler cb) /*override*/;
+    /**
+     * Sets a handler that gets the completed deliveries in batches, rather
+     * than one at a time.
+     *
+     * When set, the deliveries of QoS 1 and 2 messages that complete are
+     * held, still in the client's table of pending tokens, and handed to
+     * the handler all at once, in the order they completed. They're then
+     * removed from the table together, with one lock of each part of the
+     * table, rather than one lock per token. The tokens themselves still
+     * complete when their acknowledgment arrives; only the callback is
+     * deferred. The user callback's @em delivery_complete() is not called
+     * for them.
+     *
+     * A batch is handed off when it's full, when every delivery still
+     * pending is in the batch (i.e. the burst of acknowledgments is over),
+     * when the connection is lost or closed, when flushed by the
+     * application, or when its first delivery was held for the longest
+     * delay, so a trickle of messages isn't held indefinitely. The handler
+     * is called on whichever thread completed the last delivery in the
+     * batch, which is normally the library's callback thread, or for a
+     * delay, on the client's timer wheel.
+     *
+     * @param cb The handler, or an empty function to go back to calling
+     *  		 @em delivery_complete() for each delivery. Any held
+     *  		 deliveries are first handed to the previous handler.
+     * @param maxBatch The maximum number of deliveries in a batch.
+     * @param maxDelay The longest time a delivery is held, or zero for no
+     *  			   limit.
+     */
+    void set_delivery_batch_handler(
+        delivery_batch_handler cb, std::size_t maxBatch = DFLT_DELIVERY_BATCH_SIZE,
+        std::chrono::steady_clock::duration maxDelay = DFLT_DELIVERY_BATCH_DELAY
+    );
+    /**
+     * Hands off any completed deliveries that are being held for the
+     * batched delivery handler now.
+     * This does nothing if there is no batched delivery handler.
+     * @sa set_delivery_batch_handler()
+     */
+    void flush_delivery_batch();
+    /**
+     * Sets a message callback that is run by a pool of worker threads.
+     *
+     * Rather than calling the handler on the library's callback thread,
+     * incoming messages are handed off to a @ref dispatcher, which keeps
+     * the messages with the same key (by default, the topic) in order, on
+     * the same worker thread. This keeps a slow handler from stalling the
+     * receipt and acknowledgment of messages.
+     *
+     * This replaces any message callback set with
+     * @ref set_message_callback(), and any previous dispatcher, which is
+     * stopped.
+     *
+     * @param nThreads The number of worker threads.
+     * @param cb The callback called by the worker threads for each message.
+     * @param keyFunc The function to get the key used to assign a message
+     *  			  to a worker. If empty, the topic is used.
+     * @param queCap The capacity of each worker's queue. When a queue is
+     *  			 full, the library's callback thread will block until
+     *  			 there is room in it.
+     */
+    void start_dispatching(
+        std::size_t nThreads, message_handler cb,
+        dispatcher::key_function keyFunc = dispatcher::key_function{},
+        std::size_t queCap = dispatcher::queue_type::MAX_CAPACITY
+    );
+    /**
+     * Stops dispatching messages to the worker threads.
+     * This removes the message callback, then waits for the workers to
+     * finish handling any messages that were already queued. This must not
+     * be called from one of the worker threads.
+     */
+    void stop_dispatching();
+    /**
+     * Gets the dispatcher for incoming messages, if any.
+     * @return The dispatcher for incoming messages, or a null pointer if
+     *  	   the client is not dispatching messages.
+     */
+    dispatcher_ptr get_dispatcher() const {
+        guard g{lock_};
+        return dispatcher_;
+    }
+    /**
+     * Starts limiting the rate of outgoing messages.
+     *
+     * Each message published with one of the publish() calls that return
+     * a delivery token must first get past a @ref rate_limiter, which
+     * keeps to an average number of messages and/or bytes of payload per
+     * second, while allowing short bursts. The policy decides what happens
+     * to a message that arrives too soon:
+     *
+     * @li @em BLOCK: The publish() call waits until the message can go.
+     * @li @em FAIL: The publish() call throws an exception with the reason
+     * code @em QUOTA_EXCEEDED.
+     * @li @em QUEUE: The publish() call returns right away, and the message
+     * is sent from the limiter's thread when its turn comes. The queue has
+     * a lane for each message priority, served by weight, so messages of
+     * the same priority go in order, but a high priority one doesn't wait
+     * behind a backlog of low priority ones. If the library then rejects
+     * it, or the limiter is stopped first, the delivery token fails.
+     *
+     * The QoS 0 fast path, publish_qos0(), and publish_batch() are not
+     * limited. This replaces any previous limiter, which is stopped.
+     *
+     * @param msgRate The maximum average number of messages per second.
+     *  			  Zero for no limit.
+     * @param byteRate The maximum average number of payload bytes per
+     *  			   second. Zero for no limit.
+     * @param policy What to do with a message that would exceed the rate.
+     * @param burstSecs The size of the largest burst, in seconds' worth of
+     *  				messages.
+     */
+    void start_rate_limiting(
+        double msgRate, double byteRate = 0.0,
+        rate_limiter::Policy policy = rate_limiter::BLOCK, double burstSecs = 1.0
+    );
+    /**
+     * Stops limiting the rate of outgoing messages.
+     * Any publish() calls that are blocked are released with an
+     * exception, and any queued messages are failed.
+     */
+    void stop_rate_limiting();
+    /**
+     * Gets the limiter for outgoing messages, if any.
+     * This can be used to read the current rates and the depth of the
+     * queue.
+     * @return The limiter for outgoing messages, or a null pointer if the
+     *  	   rate is not limited.
+     */
+    rate_limiter_ptr get_rate_limiter() const {
+        guard g{lock_};
+        return limiter_;
+    }
+    /**
+     * Starts retrying the publishes that fail, with a capped, exponential
+     * backoff, through a @ref publish_retrier.
+     *
+     * A failure that the policy says is transient, like a lost connection
+     * or a busy server, whether it's reported by the publish() call itself
+     * or later, through the delivery token, doesn't complete the token.
+     * Instead, the message is sent again after the backoff, from the
+     * retrier's timer thread, which is shared by all the messages. The
+     * token completes when the message is delivered, when the failure is
+     * not one to retry, or when the message runs out of retries, in which
+     * case it is also added to the retrier's dead letters.
+     *
+     * The retrier can be read through get_publish_retrier(), for its
+     * metrics and dead letters. This replaces any previous retrier, whose
+     * waiting retries move to the new one.
+     *
+     * @param policy The policy for the retries.
+     * @param maxDeadLetters The most dead letters to keep.
+     */
+    void start_publish_retry(
+        retry_policy policy = retry_policy{},
+        std::size_t maxDeadLetters = publish_retrier::DFLT_MAX_DEAD_LETTERS
+    );
+    /**
+     * Stops retrying failed publishes.
+     * The delivery tokens of any messages waiting to be retried are
+     * failed, and the dead letters are dropped with the retrier.
+     */
+    void stop_publish_retry();
+    /**
+     * Gets the retrier for failed publishes, if any.
+     * @return The retrier, or a null pointer if failed publishes are not
+     *  	   retried.
+     */
+    publish_retrier_ptr get_publish_retrier() const {
+        guard g{lock_};
+        return retrier_;
+    }
+    /**
+     * Starts limiting the QoS 1 and 2 messages in flight with an adaptive
+     * window, through an @ref inflight_window.
+     *
+     * Rather than a fixed limit, the window grows while the messages are
+     * acknowledged quickly, and is cut in half when one fails or the round
+     * trip time climbs, AIMD-style, like TCP congestion control. So it
+     * opens up on a link with a long delay, and backs off from a server
+     * that can't keep up. A message that doesn't fit in the window is
+     * held by the client, in order, and sent as the ones ahead of it are
+     * acknowledged. Its publish() call returns right away. If the
+     * library then rejects it because the connection was lost, it goes to
+     * the offline buffer, if there is one, and any other failure goes
+     * through the delivery token, which may retry it, as a publish sent
+     * right away would. Either way it gives back its slot. If the window
+     * is stopped first, the delivery token fails. A publish fails right
+     * away if too many messages are already waiting for the window.
+     *
+     * The window applies after any rate limiter, and to the retries, but
+     * doesn't hold back QoS 0 messages, or the ones sent from the offline
+     * buffer. This replaces any previous window, which is stopped.
+     *
+     * @param maxWindow The most messages in flight. This should be no more
+     *  				than the `max_inflight` of the connect options.
+     * @param minWindow The fewest messages the window allows in flight.
+     * @param initWindow The starting size of the window.
+     * @param maxQueue The most messages that can wait for the window.
+     */
+    void start_adaptive_inflight(
+        std::size_t maxWindow, std::size_t minWindow = 1,
+        std::size_t initWindow = inflight_window::DFLT_INIT_WINDOW,
+        std::size_t maxQueue = inflight_window::DFLT_MAX_QUEUE
+    );
+    /**
+     * Stops limiting the messages in flight.
+     * Any messages waiting for the window are failed.
+     */
+    void stop_adaptive_inflight();
+    /**
+     * Gets the adaptive in-flight window, if any.
+     * This can be used to read the current window, the round-trip times,
+     * and the depth of the queue.
+     * @return The in-flight window, or a null pointer if the messages in
+     *  	   flight are not limited by the client.
+     */
+    inflight_window_ptr get_inflight_window() const {
+        guard g{lock_};
+        return window_;
+    }
+    /**
+     * Gets the timer wheel of the client, making it if need be.
+     *
+     * The wheel runs the timers for the operation deadlines, the timeouts
+     * of an rpc_client, the publish retries, and the queue of the rate
+     * limiter, on a single thread, so any number of them cost a timer
+     * each, set and cancelled in constant time. The app can put timers of
+     * its own on it too, as long as they're quick. The wheel is stopped
+     * when the client is destroyed.
+     *
+     * @return The timer wheel of the client.
+     */
+    timer_wheel_ptr get_timer_wheel() const;
+    /**
+     * Sets a deadline for each publish, subscribe, and unsubscribe.
+     *
+     * An operation that hasn't completed by its deadline is failed with
+     * @em MQTTASYNC_FAILURE and a "Timeout" message, and its waiters are
+     * woken, from the client's timer wheel. See `token::is_timed_out()`.
+     * The library may still be working on it, and the result it gets is
+     * dropped, though a message may yet be delivered. The timer is
+     * cancelled when the operation completes in time, so the cost is a
+     * timer for each outstanding operation.
+     *
+     * @param timeout How long each operation has to complete, from when
+     *  			  it's started, or zero for no deadline.
+     */
+    template <class Rep, class Period>
+    void set_operation_timeout(const std::chrono::duration<Rep, Period>& timeout) {
+        using std::chrono::steady_clock;
+        opTimeout_ = std::chrono::duration_cast<steady_clock::duration>(timeout).count();
+    }
+    /**
+     * Gets the deadline for each publish, subscribe, and unsubscribe.
+     * @return How long each operation has to complete, or zero for no
+     *  	   deadline.
+     */
+    std::chrono::steady_clock::duration get_operation_timeout() const {
+        return std::chrono::steady_clock::duration{opTimeout_.load()};
+    }
+    /**
+     * Sets the deadline for an outstanding operation.
+     * This replaces the one from the operation timeout, if any, in the
+     * same way.
+     * @param tok The token for the operation.
+     * @param deadline When the operation times out.
+     * @return @em true if the deadline was set, @em false if the operation
+     *  	   already completed.
+     */
+    bool set_deadline(
+        const token_ptr& tok, const std::chrono::steady_clock::time_point& deadline
+    );
+    /**
+     * Starts holding the messages that are published while the client is
+     * disconnected, in an @ref offline_buffer.
+     *
+     * Each message published with one of the publish() calls that return
+     * a delivery token, while the client is not connected, is held by the
+     * buffer, and its token is returned right away. When the client
+     * connects, the buffer sends the backlog, in order, from its own
+     * thread, at no more than @a drainRate messages per second. Messages
+     * published while the backlog drains go out right away. If the buffer
+     * is full, the publish() call throws an exception with the return code
+     * MQTTASYNC_MAX_BUFFERED_MESSAGES.
+     *
+     * The buffer can be read and managed through get_offline_buffer(),
+     * to see how much it holds, drop messages, change the pace, or be told
+     * when the backlog has been sent. This replaces any previous buffer,
+     * whose messages are failed.
+     *
+     * @param maxMsgs The most messages to hold, or zero for no limit.
+     * @param maxBytes The most payload bytes to hold, or zero for no
+     *  			   limit.
+     * @param drainRate The most messages per second to send when draining
+     *  				the backlog, or zero for no limit.
+     */
+    void start_offline_buffering(
+        std::size_t maxMsgs = 0, std::size_t maxBytes = 0, double drainRate = 0.0
+    );
+    /**
+     * Stops holding the messages that are published while disconnected.
+     * The delivery tokens of any buffered messages are failed.
+     */
+    void stop_offline_buffering();
+    /**
+     * Gets the buffer for the messages published while disconnected, if
+     * any.
+     * @return The offline buffer, or a null pointer if messages are not
+     *  	   buffered by the client.
+     */
+    offline_buffer_ptr get_offline_buffer() const {
+        guard g{lock_};
+        return offlineBuf_;
+    }
+    /**
+     * Sends any QoS 0 messages that are being held for coalescing now.
+     * This does nothing if coalescing is off.
+     * @sa create_options::set_publish_coalescing()
+     */
+    void flush_publishes() {
+        if (coalescer_)
+            coalescer_->flush();
+    }
+    /**
+     * Gets the coalescer for outgoing QoS 0 messages, if any.
+     * @return A pointer to the coalescer, or null if coalescing is off.
+     */
+    const publish_coalescer* get_publish_coalescer() const { return coalescer_.get(); }
+    /**
+     * Gets the manager for the topic aliases of outgoing messages, if any.
+     * @return A pointer to the manager, or null if automatic topic
+     *  	   aliasing is off.
+     * @sa create_options::set_max_topic_aliases()
+     */
+    const topic_alias_manager* get_topic_alias_manager() const { return aliases_.get(); }
+    /**
+     * Gets a snapshot of the metrics for the client's activity.
+     * The counters are kept all the time, at the cost of a few relaxed
+     * atomic operations per message. The gauges, like the number of
+     * pending tokens, are sampled when this is called.
+     * @return A snapshot of the client's metrics.
+     */
+    client_metrics get_metrics() const;
+    /**
+     * Gets a snapshot of the memory held by the client, by what it's
+     * holding it for: the pending tokens, the delivery tokens with their
+     * messages, the consumer queue, the offline buffer, and the last value
+     * cache. The sizes are estimates, as described for @ref memory_usage.
+     * @return A snapshot of the client's memory usage.
+     */
+    memory_usage get_memory_usage() const;
+    /**
+     * Sets a soft limit on the memory held by the client.
+     * The total memory is checked against the limit when a message is
+     * published, and when one arrives. When it goes over, the handler is
+     * called once, with the usage, and isn't called again until it has
+     * come back under the limit. The application can use it to shed load,
+     * like slowing down its publishing, or to log where the memory went.
+     * @par
+     * With @em holdIncoming, incoming messages are also left with the
+     * C library while the client is over the limit and there are messages
+     * in the consumer queue, much like with flow control. The library
+     * holds off the acknowledgments and offers them again later, so the
+     * server slows down, rather than the client queueing without bound.
+     * @par
+     * Each check takes a snapshot of the usage, which briefly locks each
+     * of the queues, so it's only done while a limit is set.
+     * @param bytes The limit, in bytes, or zero for no limit.
+     * @param cb The handler for when the client goes over the limit. This
+     *  		 is called from the thread that published or received the
+     *  		 message, so it shouldn't block.
+     * @param holdIncoming Whether to hold back incoming messages while the
+     *  				   client is over the limit.
+     */
+    void set_memory_limit(
+        std::size_t bytes, memory_limit_handler cb = memory_limit_handler{},
+        bool holdIncoming = false
+    );
+    /**
+     * Gets the soft limit on the memory held by the client.
+     * @return The limit, in bytes, or zero if there is none.
+     */
+    std::size_t get_memory_limit() const noexcept { return memLimit_; }
+    /**
+     * Determines if the client was over its soft memory limit the last time
+     * it was checked.
+     * @return @em true if the client is over its memory limit.
+     */
+    bool over_memory_limit() const noexcept { return overMemLimit_; }
+    /**
+     * Installs hooks to trace messages through the client.
+     * @param tr The tracer. It must outlive the client, or be cleared
+     *  		 first, once nothing is in flight.
+     * @sa message_tracer
+     */
+    void set_message_tracer(message_tracer& tr) { tracer_ = &tr; }
+    /**
+     * Removes the hooks to trace messages through the client.
+     */
+    void clear_message_tracer() { tracer_ = nullptr; }
+    /**
+     * Gets the hooks that trace messages through the client, if any.
+     * @return A pointer to the tracer, or null if there isn't one.
+     */
+    message_tracer* get_message_tracer() const {
+        return tracer_.load(std::memory_order_relaxed);
+    }
+    /**
+     * Sets a codec to compress message payloads.
+     *
+     * The payload of each outgoing MQTT v5 message is encoded with the
+     * codec as it's handed to the library, and the codec is named in the
+     * message's @ref payload_codec::ENCODING_PROPERTY user property. A
+     * payload that's smaller than @a minSize, or that the codec doesn't
+     * shrink, is sent as it is, as is a message that already names an
+     * encoding.
+     * @par
+     * An incoming message that names the codec is decoded lazily, the
+     * first time its payload is read, so a consumer that only routes by
+     * topic never pays for it. Other incoming messages are left alone.
+     * @par
+     * Only the publishes that return a token are encoded, not
+     * `publish_qos0()`, and nothing is encoded or decoded for MQTT v3,
+     * which has no properties to name the codec.
+     *
+     * @param codec The codec, which must be thread-safe.
+     * @param minSize The smallest payload to encode, in bytes.
+     */
+    void set_payload_codec(payload_codec_ptr codec, std::size_t minSize = 0);
+    /**
+     * Removes the codec for message payloads.
+     */
+    void clear_payload_codec() { set_payload_codec(payload_codec_ptr{}); }
+    /**
+     * Gets the codec for message payloads, if any.
+     * @return The codec, or a null pointer if there isn't one.
+     */
+    payload_codec_ptr get_payload_codec() const {
+        guard g{lock_};
+        return codec_;
+    }
+    /**
+     * Sets a codec to send the payloads of each topic as deltas from the
+     * previous one, with periodic keyframes.
+     *
+     * Each outgoing MQTT v5 message is encoded as it's handed to the
+     * library, before the payload codec, if there is one, compresses it.
+     * So a message that's held back by the offline buffer, a rate
+     * limiter, or the in-flight window is encoded when it's finally sent,
+     * and one that's dropped or refused before then doesn't break the
+     * chain of deltas on its topic. Each incoming message that's marked
+     * as a keyframe or delta is rebuilt as it arrives, and a delta that
+     * can't be rebuilt, because the one before it was lost, is dropped.
+     * @par
+     * As with the payload codec, only the publishes that return a token
+     * are encoded, and nothing is done for MQTT v3.
+     *
+     * @param codec The codec, or a null pointer to remove it.
+     */
+    void set_delta_codec(delta_codec_ptr codec) {
+        guard g{lock_};
+        hasDeltaCodec_ = bool(codec);
+        deltaCodec_ = std::move(codec);
+    }
+    /**
+     * Gets the codec that sends payloads as deltas, if any.
+     * @return The codec, or a null pointer if there isn't one.
+     */
+    delta_codec_ptr get_delta_codec() const {
+        guard g{lock_};
+        return deltaCodec_;
+    }
+    /**
+     * Sets a cache to hold the latest message on each topic.
+     *
+     * Every incoming message is put in the cache, before it's dispatched,
+     * so that the app can read the current state of a topic, or of all the
+     * topics that match a filter, without a round trip to the broker. The
+     * cache can be shared by several clients.
+     *
+     * @param cache The cache, or a null pointer to remove it.
+     */
+    void set_last_value_cache(last_value_cache_ptr cache) {
+        guard g{lock_};
+        hasLvCache_ = bool(cache);
+        lvCache_ = std::move(cache);
+    }
+    /**
+     * Gets the cache of the latest message on each topic, if any.
+     * @return The cache, or a null pointer if there isn't one.
+     */
+    last_value_cache_ptr get_last_value_cache() const {
+        guard g{lock_};
+        return lvCache_;
+    }
+    /**
+     * Starts manual-ack mode, in which the app acknowledges each incoming
+     * QoS 1 and 2 message itself.
+     *
+     * Each of those messages carries a handle to an @ref ack_tracker, and
+     * the app calls `message::ack()` once it's done with it. Messages can
+     * be processed in parallel and acked in any order. The tracker
+     * releases the acks in the order that the messages arrived, once each
+     * contiguous run of them is done, and calls the handler for each one,
+     * which is the point at which the app can commit its progress.
+     *
+     * While @a maxInFlight messages are waiting to be released, new ones
+     * are held back in the library, the same as with a full consumer
+     * queue, so a stalled message limits how far the others get ahead of
+     * it.
+     *
+     * Note that the C library sends the PUBACK for a QoS 1 message, and
+     * completes the QoS 2 handshake, when the message is taken from the
+     * network, so the acks released here are those of the app, and not
+     * the ones on the wire.
+     *
+     * @param maxInFlight The most messages waiting to be released, or zero
+     *  				  for no limit.
+     * @param cb The handler for each released ack, if any.
+     * @return The ack tracker.
+     */
+    ack_tracker_ptr start_manual_ack(
+        std::size_t maxInFlight = 0, ack_tracker::release_handler cb = ack_tracker::release_handler{}
+    ) {
+        auto tracker = ack_tracker::create(maxInFlight, std::move(cb));
+        guard g{lock_};
+        ackTracker_ = tracker;
+        hasAckTracker_ = true;
+        return tracker;
+    }
+    /**
+     * Stops manual-ack mode.
+     * Messages that arrive from now on don't need to be acked. Those
+     * already in flight can still be acked through the old tracker.
+     */
+    void stop_manual_ack() {
+        guard g{lock_};
+        hasAckTracker_ = false;
+        ackTracker_.reset();
+    }
+    /**
+     * Gets the tracker for the messages that the app acks itself, if the
+     * client is in manual-ack mode.
+     * @return The ack tracker, or a null pointer if the client isn't in
+     *  	   manual-ack mode.
+     */
+    ack_tracker_ptr get_ack_tracker() const {
+        guard g{lock_};
+        return ackTracker_;
+    }
+#if defined(PAHO_MQTTPP_HAS_PMR)
+    /**
+     * Sets a memory resource for the incoming messages.
+     *
+     * Each incoming message, its control block, and copies of its topic
+     * and payload, come from the resource, rather than the heap. This
+     * lets an app use something like a per-batch arena that's released
+     * all at once after the batch is processed. The resource can be
+     * switched at any time, and applies to the messages that arrive after
+     * that.
+     * @par
+     * The resource is used from the library's callback thread, and
+     * released into from whichever thread drops the last reference to a
+     * message, so it must be safe for that, and must outlive all of the
+     * messages that came from it. The properties are still allocated by
+     * the C library. This doesn't apply to zero-copy messages, which keep
+     * the C library's buffers, or to interned topics.
+     * @param mr The memory resource, or null to use the heap.
+     */
+    void set_message_resource(std::pmr::memory_resource* mr) { msgResource_ = mr; }
+    /**
+     * Gets the memory resource for the incoming messages.
+     * @return The memory resource, or null if they come from the heap.
+     */
+    std::pmr::memory_resource* get_message_resource() const { return msgResource_; }
+#endif
+    /**
+     * Sets a filter to drop incoming duplicates.
+     *
+     * Each incoming message is checked by the filter before it's cached,
+     * queued, or dispatched, and the ones that were already received, like
+     * QoS 1 messages that the server sends again after a reconnect, are
+     * acknowledged and dropped. The drops are counted in the client's
+     * metrics, and by the filter.
+     *
+     * @param filt The filter, or a null pointer to remove it.
+     */
+    void set_duplicate_filter(duplicate_filter_ptr filt) {
+        guard g{lock_};
+        hasDupFilter_ = bool(filt);
+        dupFilter_ = std::move(filt);
+    }
+    /**
+     * Gets the filter for incoming duplicates, if any.
+     * @return The filter, or a null pointer if there isn't one.
+     */
+    duplicate_filter_ptr get_duplicate_filter() const {
+        guard g{lock_};
+        return dupFilter_;
+    }
+    /**
+     * Sets a filter to drop some of the incoming messages.
+     *
+     * Each incoming message is checked by the filter as it comes from the
+     * C library, after the duplicate filter, and before it's made into a
+     * message object. The ones that the filter rejects are acknowledged
+     * and dropped. The drops are counted in the client's metrics, and by
+     * the filter.
+     *
+     * @param filt The filter, or a null pointer to remove it.
+     */
+    void set_receive_filter(receive_filter_ptr filt) {
+        guard g{lock_};
+        hasRecvFilter_ = bool(filt);
+        recvFilter_ = std::move(filt);
+    }
+    /**
+     * Gets the filter for the incoming messages, if any.
+     * @return The filter, or a null pointer if there isn't one.
+     */
+    receive_filter_ptr get_receive_filter() const {
+        guard g{lock_};
+        return recvFilter_;
+    }
+    /**
+     * Sets the stats that count the traffic of the client by topic.
+     *
+     * The incoming messages are counted as they come from the C library,
+     * before the duplicate and receive filters, and the outgoing ones as
+     * the library takes them to be sent.
+     *
+     * @param stats The stats, or a null pointer to remove them.
+     */
+    void set_topic_stats(topic_stats_ptr stats) {
+        guard g{lock_};
+        hasTopicStats_ = bool(stats);
+        topicStats_ = std::move(stats);
+    }
+    /**
+     * Gets the stats that count the traffic of the client by topic, if
+     * any.
+     * @return The stats, or a null pointer if there aren't any.
+     */
+    topic_stats_ptr get_topic_stats() const {
+        guard g{lock_};
+        return topicStats_;
+    }
+    /**
+     * Sets whether incoming batches are unpacked into their records.
+     *
+     * When on, each incoming MQTT v5 message that's marked as a batch by a
+     * message_batcher is split into a message for each of its records,
+     * which are then delivered, in order, as if each had arrived on its
+     * own: to the cache, the subscription handlers, the message handler,
+     * the callback, and the consumer queue. The records point into the
+     * payload of the batch, rather than copying it. See
+     * `message_batcher::unpack()`.
+     * @par
+     * The batch is counted by the metrics, filters, and tracer as a single
+     * message, and it isn't unpacked when the app acks the messages
+     * itself, since it's acked as a whole. A batch that's damaged is
+     * delivered as it arrived.
+     *
+     * @param on Whether to unpack the incoming batches.
+     */
+    void set_batch_unpacking(bool on) { unpackBatches_ = on; }
+    /**
+     * Determines whether incoming batches are unpacked into their records.
+     * @return @em true if incoming batches are unpacked.
+     */
+    bool get_batch_unpacking() const { return unpackBatches_; }
+    /**
+     * Sets the executor that runs the completion callbacks.
+     *
+     * These are the callbacks that are made when an operation completes:
+     * the action listeners, the token completion handlers, and the user
+     * callback's @em delivery_complete(). By default they run on the
+     * library's callback thread, where any lengthy processing holds up
+     * the network I/O for the client. With an executor, threads waiting
+     * on a token are still woken right away, but the callbacks are handed
+     * to the executor. This could be a @ref thread_executor to give them
+     * their own thread, or an application-defined executor.
+     *
+     * The executor must not be stopped while the client still has
+     * operations in flight; any task that it refuses is run in-line.
+     *
+     * @param exec The executor for the completion callbacks, or null to
+     *  		   run them on the library's callback thread.
+     */
+    void set_completion_executor(executor_ptr exec) {
+        guard g{lock_};
+        completionExec_ = std::move(exec);
+    }
     /**
-     * Callback for when a disconnect packet is received from the server.
-     * @param cb Callback for when the disconnect packet is received.
+     * Gets the executor that runs the completion callbacks.
+     * @return The executor, or null if the callbacks are run on the
+     *  	   library's callback thread.
      */
-    void set_disconnected_handler(disconnected_handler cb) /*override*/;
+    executor_ptr get_completion_executor() const override {
+        guard g{lock_};
+        return completionExec_;
+    }
     /**
-     * Sets the callback for when a message arrives from the broker.
-     * Note that the application can only have one message handler which can
-     * be installed individually using this method, or installled as a
-     * listener object.
-     * @param cb The callback functor to register with the library.
+     * Sets how threads wait on the consumer queue, and on the client's
+     * tokens.
+     * By default, a waiting thread blocks right away. For the lowest
+     * latency, a consumer thread that's pinned to a core of its own can
+     * spin instead, for a budget or for good. This also applies to a
+     * consumer queue that's started later. A queue type that doesn't have
+     * a wait strategy, like the @ref lock_free_queue, which does its own
+     * brief spinning, keeps waiting the way it does.
+     * @param ws The wait strategy.
+     */
+    void set_wait_strategy(const wait_strategy& ws) {
+        guard g{lock_};
+        waitStrategy_ = ws;
+        if (que_)
+            que_->set_wait_strategy(ws);
+    }
+    /**
+     * Gets how threads wait on the consumer queue and the client's tokens.
+     * @return The wait strategy.
      */
-    void set_message_callback(message_handler cb) /*override*/;
+    wait_strategy get_wait_strategy() const override {
+        guard g{lock_};
+        return waitStrategy_;
+    }
     /**
      * Sets a callback to allow the application to update the connection
      * data on automatic reconnects.
@@ -494,6 +1980,64 @@ public:
      * @return delivery_token[]
      */
     std::vector<delivery_token_ptr> get_pending_delivery_tokens() const override;
+    /**
+     * Waits, up to a deadline, for all of the messages that were published
+     * to be delivered.
+     *
+     * This covers every message that has a delivery token in the client,
+     * including the ones still held by an offline buffer, a rate limiter,
+     * or the QoS 0 coalescer, which is flushed first. It waits on the count
+     * of pending deliveries to reach zero, without polling or copying the
+     * table of tokens. Messages published while it waits are also waited
+     * on, so, for an orderly shutdown, the app should stop publishing
+     * first.
+     *
+     * @param deadline The time to give up waiting.
+     * @return The delivery tokens that didn't complete in time. This is
+     *  	   empty if everything was delivered.
+     */
+    std::vector<delivery_token_ptr> flush(const std::chrono::steady_clock::time_point& deadline);
+    /**
+     * Waits, up to a timeout, for all of the messages that were published
+     * to be delivered.
+     * @param timeout The longest time to wait.
+     * @return The delivery tokens that didn't complete in time. This is
+     *  	   empty if everything was delivered.
+     * @sa flush(const std::chrono::steady_clock::time_point&)
+     */
+    template <class Rep, class Period>
+    std::vector<delivery_token_ptr> flush(const std::chrono::duration<Rep, Period>& timeout) {
+        return flush(std::chrono::steady_clock::now() + timeout);
+    }
+    /**
+     * Waits, up to a deadline, for all of the published messages to be
+     * delivered, then disconnects from the server.
+     *
+     * The disconnect starts when everything is delivered, or at the
+     * deadline, whichever comes first. It's up to the app to wait on the
+     * disconnect token, if needed.
+     *
+     * @param deadline The time to give up waiting for the deliveries.
+     * @param opts The options for the disconnect.
+     * @return The tokens that didn't complete, and the disconnect token.
+     */
+    flush_result flush_and_disconnect(
+        const std::chrono::steady_clock::time_point& deadline,
+        disconnect_options opts = disconnect_options{}
+    );
+    /**
+     * Gets the number of topics that have been interned for incoming
+     * messages.
+     * @return The number of topics that have been interned.
+     * @sa create_options::set_max_interned_topics()
+     */
+    std::size_t num_interned_topics() const;
+    /**
+     * Clears the table of interned topics.
+     * Messages already received keep their topics, but subsequent messages
+     * will intern their topics anew.
+     */
+    void clear_interned_topics();
     /**
      * Returns the client ID used by this client.
      * @return The client ID used by this client.
@@ -504,6 +2048,11 @@ public:
      * @return The server's address, as a URI String.
      */
     string get_server_uri() const override { return createOpts_.get_server_uri(); }
+    /**
+     * Gets the options that the client was created with.
+     * @return The create options.
+     */
+    const create_options& get_create_options() const { return createOpts_; }
     /**
      * Gets the MQTT version used by the client.
      * @return The MQTT version used by the client
@@ -584,6 +2133,56 @@ public:
             std::move(topic), std::move(payload), message::DFLT_QOS, message::DFLT_RETAINED
         );
     }
+    /**
+     * Publishes a message with a payload gathered from several buffers.
+     *
+     * This is for payloads made of separate pieces, like a header and a
+     * body, that would otherwise need to be joined by the application
+     * before publishing. The pieces are copied, in order, directly into the
+     * message's payload, which is allocated once at its full size.
+     *
+     * @param topic The topic to deliver the message to
+     * @param bufs The pieces of the payload, in order.
+     * @param qos the Quality of Service to deliver the message at. Valid
+     *  		  values are 0, 1 or 2.
+     * @param retained whether or not this message should be retained by the
+     *  			   server.
+     * @param props The MQTT v5 properties.
+     * @return token used to track and wait for the publish to complete. The
+     *  	   token will be passed to callback methods if set.
+     */
+    delivery_token_ptr publish(
+        string_ref topic, const std::vector<binary_view>& bufs,
+        int qos = message::DFLT_QOS, bool retained = message::DFLT_RETAINED,
+        const properties& props = properties()
+    );
+    /**
+     * Publishes a typed value to a topic on the server.
+     *
+     * The value is encoded by its @ref serializer, directly into the
+     * payload of the message. This is only for the types that have a
+     * serializer and can't already be taken as a payload, so strings and
+     * byte buffers still go through the other overloads.
+     *
+     * @param topic The topic to deliver the message to
+     * @param val The value to encode as the payload.
+     * @param qos the Quality of Service to deliver the message at. Valid
+     *  		  values are 0, 1 or 2.
+     * @param retained whether or not this message should be retained by the
+     *  			   server.
+     * @param props The MQTT v5 properties.
+     * @return token used to track and wait for the publish to complete. The
+     *  	   token will be passed to callback methods if set.
+     */
+    template <
+        typename T, typename = std::enable_if_t<
+                        is_serializable_v<T> && !std::is_convertible_v<const T&, binary_ref>>>
+    delivery_token_ptr publish(
+        string_ref topic, const T& val, int qos = message::DFLT_QOS,
+        bool retained = message::DFLT_RETAINED, const properties& props = properties()
+    ) {
+        return publish(std::move(topic), to_payload(val), qos, retained, props);
+    }
     /**
      * Publishes a message to a topic on the server
      * @param topic The topic to deliver the message to
@@ -625,6 +2224,158 @@ public:
      */
     delivery_token_ptr publish(const_message_ptr msg, void* userContext, iaction_listener& cb)
         override;
+    /**
+     * Publishes a message, reporting an error in the result, rather than
+     * throwing an exception.
+     *
+     * This is for the hot path of an application that can be turned away
+     * often, like when the offline buffer is full, or the rate limit is
+     * reached, under load. The error that publish() would throw, from the
+     * library or from the client's own buffers and limits, is returned
+     * instead, without allocating anything. An invalid message, like one
+     * with a bad QoS, still throws, since that's a bug in the caller.
+     * @param msg the message to deliver to the server
+     * @return The token used to track and wait for the publish to
+     *  	   complete, or the error.
+     */
+    publish_result try_publish(const_message_ptr msg);
+    /**
+     * Publishes a message to a topic on the server, reporting an error in
+     * the result, rather than throwing an exception.
+     * @param topic The topic to deliver the message to
+     * @param payload the bytes to use as the message payload
+     * @param n the number of bytes in the payload
+     * @param qos the Quality of Service to deliver the message at. Valid
+     *  		  values are 0, 1 or 2.
+     * @param retained whether or not this message should be retained by the
+     *  			   server.
+     * @param props The MQTT v5 properties.
+     * @return The token used to track and wait for the publish to
+     *  	   complete, or the error.
+     * @sa try_publish(const_message_ptr)
+     */
+    publish_result try_publish(
+        string_ref topic, const void* payload, size_t n, int qos = message::DFLT_QOS,
+        bool retained = message::DFLT_RETAINED, const properties& props = properties()
+    );
+    /**
+     * Publishes a message to a topic on the server, reporting an error in
+     * the result, rather than throwing an exception.
+     * @param topic The topic to deliver the message to
+     * @param payload the bytes to use as the message payload
+     * @param qos the Quality of Service to deliver the message at. Valid
+     *  		  values are 0, 1 or 2.
+     * @param retained whether or not this message should be retained by the
+     *  			   server.
+     * @param props The MQTT v5 properties.
+     * @return The token used to track and wait for the publish to
+     *  	   complete, or the error.
+     * @sa try_publish(const_message_ptr)
+     */
+    publish_result try_publish(
+        string_ref topic, binary_ref payload, int qos, bool retained,
+        const properties& props = properties()
+    );
+    /**
+     * Publishes a message to a topic on the server, reporting an error in
+     * the result, rather than throwing an exception.
+     * @param topic The topic to deliver the message to
+     * @param payload the bytes to use as the message payload
+     * @return The token used to track and wait for the publish to
+     *  	   complete, or the error.
+     * @sa try_publish(const_message_ptr)
+     */
+    publish_result try_publish(string_ref topic, binary_ref payload) {
+        return try_publish(
+            std::move(topic), std::move(payload), message::DFLT_QOS, message::DFLT_RETAINED
+        );
+    }
+    /**
+     * Publishes a batch of messages, tracked by a single token.
+     *
+     * The messages are handed to the library one after another, but share
+     * a single entry in the client's table of pending tokens, rather than
+     * each getting a delivery token of its own. The returned token
+     * completes when every message in the batch has been acknowledged or
+     * has failed. The result for each message can be read from the token
+     * by its index in the batch.
+     *
+     * Note that the user callback's @em delivery_complete() is not called
+     * for the messages in a batch.
+     *
+     * The messages are sent right away, and so skip the parts of the
+     * publish path that would hold them back or track them one at a time:
+     * the rate limiter, the offline buffer, the in-flight window, the
+     * publish retries, the coalescer, and the message tracer. A batch
+     * published while disconnected, or over the window, fails rather than
+     * being held. The payload and delta codecs, topic aliases, metrics,
+     * and topic statistics apply as for a single publish. If the library
+     * refuses a message, the token keeps the original message, not the
+     * encoded one.
+     *
+     * @param msgs The messages to publish.
+     * @return A token used to track and wait for the whole batch to
+     *  	   complete.
+     * @throw exception if the library could not accept any of the
+     *  	  messages.
+     */
+    batch_token_ptr publish_batch(std::vector<const_message_ptr> msgs);
+    /**
+     * Publishes a QoS 0 message straight from the caller's memory.
+     *
+     * This is a fast path for "fire and forget" messages, like high-rate
+     * telemetry. It skips creating a message object and a delivery token,
+     * and hands the topic and payload directly to the C library, which
+     * makes its own copy before this returns. There is no way to track the
+     * completion of the publish; use one of the regular publish() calls if
+     * that's needed.
+     *
+     * When publish coalescing is on, the message is copied and held to be
+     * sent with others, and an error from the library is not reported.
+     *
+     * @param topic The topic to deliver the message to
+     * @param payload the bytes to use as the message payload
+     * @param n the number of bytes in the payload
+     * @param retained whether or not this message should be retained by the
+     *  			   server.
+     * @param props The MQTT v5 properties.
+     * @throw exception if the library could not accept the message.
+     */
+    void publish_qos0(
+        const string& topic, const void* payload, size_t n,
+        bool retained = message::DFLT_RETAINED, const properties& props = properties()
+    );
+    /**
+     * Publishes a QoS 0 message straight from the caller's memory.
+     * @param topic The topic to deliver the message to
+     * @param payload the bytes to use as the message payload
+     * @param retained whether or not this message should be retained by the
+     *  			   server.
+     * @throw exception if the library could not accept the message.
+     * @sa publish_qos0(const string&, const void*, size_t, bool, const properties&)
+     */
+    void publish_qos0(
+        const string& topic, binary_view payload, bool retained = message::DFLT_RETAINED
+    ) {
+        publish_qos0(topic, payload.data(), payload.size(), retained);
+    }
+    /**
+     * Publishes a QoS 0 message straight from the caller's memory,
+     * returning an error rather than throwing it.
+     * @param topic The topic to deliver the message to
+     * @param payload the bytes to use as the message payload
+     * @param n the number of bytes in the payload
+     * @param retained whether or not this message should be retained by the
+     *  			   server.
+     * @param props The MQTT v5 properties.
+     * @return The return code from the library, which is
+     *  	   @em MQTTASYNC_SUCCESS if it accepted the message.
+     * @sa publish_qos0(const string&, const void*, size_t, bool, const properties&)
+     */
+    int try_publish_qos0(
+        const string& topic, const void* payload, size_t n,
+        bool retained = message::DFLT_RETAINED, const properties& props = properties()
+    );
     /**
      * Subscribe to a topic, which may include wildcards.
      * @param topicFilter the topic to subscribe to, which can include
@@ -640,6 +2391,22 @@ public:
         const subscribe_options& opts = subscribe_options(),
         const properties& props = properties()
     ) override;
+    /**
+     * Subscribe to a topic, reporting an error in the result, rather than
+     * throwing an exception.
+     * @param topicFilter the topic to subscribe to, which can include
+     *  				  wildcards.
+     * @param qos The quality of service for the subscription
+     * @param opts The MQTT v5 subscribe options for the topic
+     * @param props The MQTT v5 properties.
+     * @return The token used to track and wait for the subscribe to
+     *  	   complete, or the error.
+     */
+    token_result try_subscribe(
+        const string& topicFilter, int qos,
+        const subscribe_options& opts = subscribe_options(),
+        const properties& props = properties()
+    );
     /**
      * Subscribe to a topic, which may include wildcards.
      * @param topicFilter the topic to subscribe to, which can include
@@ -662,6 +2429,39 @@ public:
         const subscribe_options& opts = subscribe_options(),
         const properties& props = properties()
     ) override;
+    /**
+     * Subscribe to a topic, which may include wildcards, with a handler
+     * for the messages that match it.
+     *
+     * The handler is called directly from the library's callback thread
+     * for each incoming message with a topic that matches the filter.
+     * Messages that match any subscription handler are only delivered to
+     * those handlers, and not to the general message callback or the
+     * consumer queue. The handler is removed when the topic filter is
+     * unsubscribed, or replaced by another subscribe to the same filter.
+     *
+     * With MQTT v5, if the server supports them, the client tags the
+     * subscription with a Subscription Identifier, which the server
+     * returns with each message it delivers for it. Incoming messages then
+     * go straight to their handlers by identifier, without matching the
+     * topic against the filters. If the application sets its own
+     * identifiers in the properties of any subscription, the client can't
+     * trust the ones it gets back, and always matches the topics instead.
+     *
+     * @param topicFilter the topic to subscribe to, which can include
+     *  				  wildcards.
+     * @param qos The quality of service for the subscription
+     * @param cb The handler for messages that match the filter.
+     * @param opts The MQTT v5 subscribe options for the topic
+     * @param props The MQTT v5 properties.
+     * @return token used to track and wait for the subscribe to complete.
+     *  	   The token will be passed to callback methods if set.
+     */
+    token_ptr subscribe(
+        const string& topicFilter, int qos, message_handler cb,
+        const subscribe_options& opts = subscribe_options(),
+        const properties& props = properties()
+    );
     /**
      * Subscribe to multiple topics, each of which may include wildcards.
      * @param topicFilters The collection of topic filters to subscribe to,
@@ -714,6 +2514,18 @@ public:
      */
     token_ptr unsubscribe(const string& topicFilter, const properties& props = properties())
         override;
+    /**
+     * Requests the server unsubscribe the client from a topic, reporting
+     * an error in the result, rather than throwing an exception.
+     * @param topicFilter The topic to unsubscribe from. It must match a
+     *  				  topicFilter specified on an earlier subscribe.
+     * @param props The MQTT v5 properties.
+     * @return The token used to track and wait for the unsubscribe to
+     *  	   complete, or the error.
+     */
+    token_result try_unsubscribe(
+        const string& topicFilter, const properties& props = properties()
+    );
     /**
      * Requests the server unsubscribe the client from one or more topics.
      * @param topicFilters One or more topics to unsubscribe from. Each
@@ -759,6 +2571,128 @@ public:
         const string& topicFilter, void* userContext, iaction_listener& cb,
         const properties& props = properties()
     ) override;
+    /**
+     * Subscribes to a large number of topic filters, tracked by a single
+     * token.
+     *
+     * The filters are split into chunks of up to the subscribe chunk size,
+     * and each chunk is sent as a single SUBSCRIBE request, pointing into
+     * the arrays of the collection, so nothing is copied per chunk. All
+     * the chunks are handed to the library at once, without waiting for
+     * the previous one to be acknowledged, so they go out back-to-back.
+     * The returned token completes when every chunk has been acknowledged
+     * or has failed, and the result for each filter can be read from it by
+     * its index in the collection.
+     *
+     * @param topicFilters The collection of topic filters to subscribe to.
+     * @param qos The maximum quality of service for each filter.
+     * @param opts The MQTT v5 subscribe options, either none, or one for
+     *  		   each filter.
+     * @param props The MQTT v5 properties, sent with every chunk.
+     * @return A token used to track and wait for the whole batch to
+     *  	   complete.
+     * @throw std::invalid_argument if the collection sizes don't match.
+     * @throw exception if the library could not accept any of the chunks.
+     */
+    batch_token_ptr subscribe_batch(
+        const_string_collection_ptr topicFilters, const qos_collection& qos,
+        const std::vector<subscribe_options>& opts = std::vector<subscribe_options>(),
+        const properties& props = properties()
+    );
+    /**
+     * Unsubscribes from a large number of topic filters, tracked by a
+     * single token.
+     *
+     * Like subscribe_batch(), the filters are sent in chunks, all at once,
+     * and the result for each filter can be read from the token by its
+     * index in the collection.
+     *
+     * @param topicFilters The collection of topic filters to unsubscribe
+     *  				   from.
+     * @param props The MQTT v5 properties, sent with every chunk.
+     * @return A token used to track and wait for the whole batch to
+     *  	   complete.
+     * @throw exception if the library could not accept any of the chunks.
+     */
+    batch_token_ptr unsubscribe_batch(
+        const_string_collection_ptr topicFilters, const properties& props = properties()
+    );
+    /**
+     * Sets the maximum number of topic filters sent in a single request by
+     * subscribe_batch() and unsubscribe_batch(), and when the
+     * subscriptions are restored after a reconnect.
+     *
+     * Some servers limit the number of filters in a request, or the size
+     * of the packet, so this defaults to a modest
+     * @ref DFLT_SUBSCRIBE_CHUNK_SIZE.
+     *
+     * @param n The maximum number of filters in each request.
+     * @throw std::invalid_argument if the size is zero.
+     */
+    void set_subscribe_chunk_size(std::size_t n) {
+        if (n == 0)
+            throw std::invalid_argument("Chunk size must be non-zero");
+        subChunkSize_ = n;
+    }
+    /**
+     * Gets the maximum number of topic filters sent in a single request by
+     * the subscription batches.
+     * @return The maximum number of filters in each request.
+     */
+    std::size_t get_subscribe_chunk_size() const { return subChunkSize_; }
+/**
+ * Expose the subscription handlers for the unit tests.
+ */
+#if defined(UNIT_TESTS)
+    uint32_t test_add_sub_handler(const string& topicFilter, message_handler cb, bool tagged) {
+        return add_sub_handler(topicFilter, std::move(cb), tagged);
+    }
+    bool test_dispatch(const const_message_ptr& msg) { return dispatch_to_sub_handlers(msg); }
+    int test_message_arrived(const string& topic, const void* payload, size_t n) {
+        MQTTAsync_message init = MQTTAsync_message_initializer;
+        auto cmsg = static_cast<MQTTAsync_message*>(MQTTAsync_malloc(sizeof(MQTTAsync_message)));
+        *cmsg = init;
+        cmsg->payload = MQTTAsync_malloc(n);
+        std::memcpy(cmsg->payload, payload, n);
+        cmsg->payloadlen = int(n);
+
+        auto topicName = static_cast<char*>(MQTTAsync_malloc(topic.size() + 1));
+        std::memcpy(topicName, topic.c_str(), topic.size() + 1);
+        return on_message_arrived(this, topicName, int(topic.size()), cmsg);
+    }
+    int test_message_arrived(const message& msg) {
+        const auto& payload = msg.get_payload_ref();
+        MQTTAsync_message init = MQTTAsync_message_initializer;
+        auto cmsg = static_cast<MQTTAsync_message*>(MQTTAsync_malloc(sizeof(MQTTAsync_message)));
+        *cmsg = init;
+        cmsg->payload = MQTTAsync_malloc(payload.size());
+        std::memcpy(cmsg->payload, payload.data(), payload.size());
+        cmsg->payloadlen = int(payload.size());
+        cmsg->qos = msg.get_qos();
+        cmsg->retained = to_int(msg.is_retained());
+        cmsg->properties = ::MQTTProperties_copy(&msg.get_properties().c_struct());
+
+        const auto& topic = msg.get_topic();
+        auto topicName = static_cast<char*>(MQTTAsync_malloc(topic.size() + 1));
+        std::memcpy(topicName, topic.c_str(), topic.size() + 1);
+        return on_message_arrived(this, topicName, int(topic.size()), cmsg);
+    }
+    void test_add_token(delivery_token_ptr tok) { add_token(std::move(tok)); }
+    void test_index_token(const delivery_token_ptr& tok, int msgID) {
+        tok->set_message_id(msgID);
+        pendingTokens_.index(tok);
+    }
+    delivery_token_ptr test_get_delivery_token(int msgID) const {
+        return pendingTokens_.get_delivery_token(msgID);
+    }
+    delivery_token_ptr test_remove_token(const delivery_token_ptr& tok) {
+        return pendingTokens_.remove(tok.get());
+    }
+    void test_put_event(event evt) {
+        que_->put(std::move(evt));
+        notify_awaiters();
+    }
+#endif
     /**
      * Start consuming messages.
      *
@@ -776,9 +2710,77 @@ public:
      *
      * Internally, this just creates a thread-safe queue for `mqtt::event`
      * objects, then hooks into the message and state-change callback to
-     * push events into the queue in the order received.
+     * push events into the queue in the order received. The default queue
+     * is an unbounded @ref thread_queue.
+     */
+    void start_consuming() override { start_consuming<thread_queue<event>>(); }
+    /**
+     * Start consuming messages using a specific type of queue.
+     *
+     * This is the same as @ref start_consuming(), but allows the
+     * application to select the type of queue, such as a bounded
+     * @ref lock_free_queue for high-throughput consumers:
+     *
+     * @code
+     * cli.start_consuming<mqtt::lock_free_queue<mqtt::event>>(4096);
+     * @endcode
+     *
+     * @tparam Queue A thread-safe queue of @ref event objects with the
+     *  			 same interface as @ref thread_queue.
+     * @param args The arguments to pass to the queue constructor.
+     */
+    template <class Queue, typename... Args>
+    void start_consuming(Args&&... args) {
+        start_consuming(consumer_queue_type{
+            new consumer_queue_adapter<Queue>(std::forward<Args>(args)...)
+        });
+    }
+    /**
+     * Start consuming messages using the specified queue.
+     * @param que The queue to receive the events.
+     */
+    void start_consuming(consumer_queue_type que) { start_consuming(std::move(que), 0); }
+    /**
+     * Start consuming messages through a bounded queue, with flow control.
+     *
+     * This is the same as @ref start_consuming(), except that the queue
+     * holds no more than @a capacity events, and incoming messages are held
+     * back, rather than blocking the library's callback thread, when the
+     * queue is full. A held-back message stays with the C library, which
+     * offers it again later, and which doesn't acknowledge a QoS 1 or 2
+     * message to the server until it's accepted into the queue.
+     *
+     * For MQTT v5 connections, the client also asks the server to limit
+     * the number of unacknowledged QoS 1 and 2 messages it sends to the
+     * capacity of the queue, by adding a Receive Maximum property to the
+     * connect options, unless the options already have one. So a slow
+     * consumer makes the server stop sending, rather than growing memory.
+     * Note that this doesn't limit QoS 0 messages, which the server
+     * doesn't wait to have acknowledged.
+     *
+     * This must be called before connecting for the Receive Maximum to be
+     * set.
+     *
+     * @param capacity The maximum number of events in the queue.
+     */
+    void start_consuming_bounded(std::size_t capacity);
+    /**
+     * Start consuming messages through a queue that keeps only the latest
+     * message for each topic.
+     *
+     * This is the same as @ref start_consuming(), except that when a
+     * message arrives for a topic that already has one waiting in the
+     * queue, it replaces the older one, which is dropped. So a consumer
+     * that falls behind only sees the newest value for each topic, and the
+     * queue is bounded by the number of topics. See @ref conflating_queue.
+     */
+    void start_consuming_conflated() { start_consuming<conflating_queue>(); }
+    /**
+     * Gets the capacity of the consumer queue, if flow control is on.
+     * @return The capacity of the bounded consumer queue, or zero if
+     *  	   incoming messages are never held back.
      */
-    void start_consuming() override;
+    std::size_t get_flow_control_capacity() const noexcept { return flowCapacity_; }
     /**
      * Stop consuming messages.
      *
@@ -825,6 +2827,20 @@ public:
     std::size_t consumer_queue_size() const override {
         return (que_) ? que_->size() : 0;
     }
+    /**
+     * Gets the number of events that the consumer queue dropped, or
+     * replaced with newer ones, because it was full.
+     * This is only counted by queues with an overflow policy other than
+     * blocking, like a @ref thread_queue set to drop the oldest events,
+     * or a @ref conflating_queue.
+     * @code
+     * cli.start_consuming<mqtt::thread_queue<mqtt::event>>(
+     *     10000, 64 * 1024 * 1024, mqtt::thread_queue<mqtt::event>::DROP_OLDEST
+     * );
+     * @endcode
+     * @return The number of events dropped by the consumer queue.
+     */
+    uint64_t consumer_queue_dropped() const { return (que_) ? que_->num_dropped() : 0; }
     /**
      * Read the next client event from the queue.
      * This blocks until a new message arrives.
@@ -853,13 +2869,7 @@ public:
         if (!que_)
             throw mqtt::exception(-1, "Consumer not started");
 
-        try {
-            return que_->try_get_for(evt, relTime);
-        }
-        catch (queue_closed&) {
-            *evt = event{shutdown_event{}};
-            return true;
-        }
+        return try_consume_event_until(evt, consumer_queue::clock::now() + relTime);
     }
     /**
      * Waits a limited time for a client event to arrive.
@@ -869,14 +2879,7 @@ public:
      */
     template <typename Rep, class Period>
     event try_consume_event_for(const std::chrono::duration<Rep, Period>& relTime) {
-        event evt;
-        try {
-            que_->try_get_for(&evt, relTime);
-        }
-        catch (queue_closed&) {
-            evt = event{shutdown_event{}};
-        }
-        return evt;
+        return try_consume_event_until(consumer_queue::clock::now() + relTime);
     }
     /**
      * Waits until a specific time for a client event to appear.
@@ -892,8 +2895,13 @@ public:
         if (!que_)
             throw mqtt::exception(-1, "Consumer not started");
 
+        auto until = to_queue_time(absTime);
         try {
-            return que_->try_get_until(evt, absTime);
+            while (que_->try_get_until(evt, until)) {
+                if (!on_dequeued(*evt))
+                    return true;
+            }
+            return false;
         }
         catch (queue_closed&) {
             *evt = event{shutdown_event{}};
@@ -910,14 +2918,74 @@ public:
     event try_consume_event_until(const std::chrono::time_point<Clock, Duration>& absTime
     ) {
         event evt;
-        try {
-            que_->try_get_until(&evt, absTime);
-        }
-        catch (queue_closed&) {
-            evt = event{shutdown_event{}};
-        }
+        if (!try_consume_event_until(&evt, absTime))
+            evt = event{};
         return evt;
     }
+    /**
+     * Reads any client events that are available, without blocking.
+     * This moves up to 'maxN' events out of the consumer queue in a single
+     * operation, which is more efficient than reading them one at a time.
+     * @param evts The vector to receive the events. They are added to the
+     *  		   end, after any items already in it.
+     * @param maxN The maximum number of events to read.
+     * @return The number of events read.
+     */
+    std::size_t try_consume_events(std::vector<event>& evts, std::size_t maxN);
+    /**
+     * Reads a batch of client events, waiting a limited time for the first
+     * one to arrive.
+     * This moves up to 'maxN' events out of the consumer queue in a single
+     * operation, which is more efficient than reading them one at a time.
+     * If the consumer queue is closed and empty, this adds a single
+     * shutdown event.
+     * @param evts The vector to receive the events. They are added to the
+     *  		   end, after any items already in it.
+     * @param maxN The maximum number of events to read.
+     * @param relTime The maximum amount of time to wait for an event.
+     * @return The number of events read, which is zero on a timeout.
+     */
+    template <typename Rep, class Period>
+    std::size_t consume_events(
+        std::vector<event>& evts, std::size_t maxN,
+        const std::chrono::duration<Rep, Period>& relTime
+    ) {
+        return consume_events_until(evts, maxN, consumer_queue::clock::now() + relTime);
+    }
+    /**
+     * Reads a batch of client events, waiting until a specific time for the
+     * first one to arrive.
+     * If the consumer queue is closed and empty, this adds a single
+     * shutdown event.
+     * @param evts The vector to receive the events. They are added to the
+     *  		   end, after any items already in it.
+     * @param maxN The maximum number of events to read.
+     * @param absTime The time point to wait until, before timing out.
+     * @return The number of events read, which is zero on a timeout.
+     */
+    template <class Clock, class Duration>
+    std::size_t consume_events_until(
+        std::vector<event>& evts, std::size_t maxN,
+        const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        if (!que_)
+            throw mqtt::exception(-1, "Consumer not started");
+
+        auto until = to_queue_time(absTime);
+        std::size_t n = 0;
+        do {
+            auto first = evts.size();
+            n = que_->try_get_n_until(&evts, maxN, until);
+            if (n > 0)
+                n -= on_dequeued(evts, first);
+        } while (n == 0 && maxN > 0 && !que_->done() && consumer_queue::clock::now() < until);
+
+        if (n == 0 && maxN > 0 && que_->done()) {
+            evts.emplace_back(shutdown_event{});
+            n = 1;
+        }
+        return n;
+    }
     /**
      * Read the next message from the queue.
      * This blocks until a new message arrives or until a disconnect or
@@ -925,6 +2993,28 @@ public:
      * @return The message and topic.
      */
     const_message_ptr consume_message() override;
+    /**
+     * Waits for the next message from the queue without blocking the
+     * thread.
+     *
+     * If there is something in the queue, it's handed back right away.
+     * Otherwise the handler is kept, and called with the next message as
+     * soon as it's put into the queue, from the thread that put it, which
+     * is normally the library's callback thread. Waiters are served in
+     * the order that they called. This is what the coroutine awaiters in
+     * awaitable.h are built on, so that any number of consumers can wait
+     * without holding a thread each.
+     * @par
+     * As with consume_message(), a null message means that the connection
+     * was lost or closed, or that consuming stopped. All waiters are
+     * handed a null message when consuming stops.
+     * @param msg Gets the message if one was ready.
+     * @param cb The handler to call with the message, if one wasn't
+     *  		 ready. It must not throw.
+     * @return @em true if the handler was kept, @em false if the message
+     *  	   was ready.
+     */
+    bool await_message(const_message_ptr* msg, message_waiter cb);
     /**
      * Try to read the next message from the queue without blocking.
      * @param msg Pointer to the value to receive the message
@@ -952,7 +3042,7 @@ public:
 			if (!try_consume_event_for(&evt, relTime))
 				return false;
 
-			if (const auto* pval = evt.get_message_if()) {
+			if (auto* pval = evt.get_message_if()) {
 				*msg = std::move(*pval);
 				break;
 			}
@@ -998,12 +3088,12 @@ public:
 			if (!try_consume_event_until(&evt, absTime))
 				return false;
 
-			if (const auto* pval = evt.get_message_if()) {
+			if (auto* pval = evt.get_message_if()) {
 				*msg = std::move(*pval);
 				break;
 			}
 
-			if (!evt.is_any_disconnect()) {
+			if (evt.is_any_disconnect()) {
 				*msg = const_message_ptr{};
 				break;
 			}
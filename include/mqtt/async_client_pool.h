@@ -0,0 +1,190 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file async_client_pool.h
+/// Declaration of MQTT async_client_pool class, a set of connections that
+/// share the load of publishing.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_async_client_pool_h
+#define __mqtt_async_client_pool_h
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "mqtt/async_client.h"
+#include "mqtt/client_metrics.h"
+#include "mqtt/connect_options.h"
+#include "mqtt/create_options.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A set of clients in one process that share the load of publishing.
+ *
+ * A single connection has a single socket, and the C library sends on it
+ * from a single thread, so a busy publisher can saturate one core while
+ * the others sit idle. The pool opens a number of connections to the
+ * same server and spreads the publishes across them.
+ * @par
+ * Each message is sent by the client picked by a hash of its topic, so
+ * all the messages for a topic go out on the same connection, and the
+ * server sees them in the order that they were published. There is no
+ * ordering between different topics.
+ * @par
+ * The pool only publishes. Any subscriptions should be made on the
+ * individual clients, or through a @ref consumer_group.
+ */
+class async_client_pool
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<async_client_pool>;
+
+private:
+    /** The clients */
+    std::vector<std::unique_ptr<async_client>> clients_;
+
+    async_client_pool(const async_client_pool&) = delete;
+    async_client_pool& operator=(const async_client_pool&) = delete;
+
+public:
+    /**
+     * Creates a pool of clients.
+     *
+     * The clients use the server and options in @a opts, each with a
+     * client ID made from the one in the options, with a suffix of a dash
+     * and the index of the client, like "myapp-0", "myapp-1", etc.
+     *
+     * @param opts The options for creating the clients.
+     * @param nClients The number of clients. If zero, a client is created
+     *  			   for each hardware core.
+     */
+    async_client_pool(const create_options& opts, std::size_t nClients);
+    /**
+     * Gets the number of clients in the pool.
+     * @return The number of clients in the pool.
+     */
+    std::size_t size() const { return clients_.size(); }
+    /**
+     * Gets one of the clients.
+     * @param i The index of the client.
+     * @return A reference to the client.
+     */
+    async_client& get_client(std::size_t i) { return *clients_.at(i); }
+    /**
+     * Gets the index of the client that sends the messages for a topic.
+     * @param topic The topic.
+     * @return The index of the client for the topic.
+     */
+    std::size_t shard(const string& topic) const {
+        return std::hash<string>{}(topic) % clients_.size();
+    }
+    /**
+     * Gets the client that sends the messages for a topic.
+     * @param topic The topic.
+     * @return A reference to the client for the topic.
+     */
+    async_client& client_for(const string& topic) { return *clients_[shard(topic)]; }
+    /**
+     * Connects all of the clients, and waits for them to connect.
+     * @param opts The options for connecting the clients.
+     * @throw exception if any of the clients fails to connect.
+     */
+    void connect(const connect_options& opts);
+    /**
+     * Disconnects all of the clients, and waits for them to disconnect.
+     * @throw exception if any of the clients fails to disconnect.
+     */
+    void disconnect();
+    /**
+     * Determines if all of the clients are connected.
+     * @return @em true if every client is connected, @em false if not.
+     */
+    bool is_connected() const;
+    /**
+     * Publishes a message on the client for its topic.
+     * @param msg The message to deliver to the server.
+     * @return The token used to track and wait for the publish to
+     *  	   complete.
+     */
+    delivery_token_ptr publish(const_message_ptr msg) {
+        return client_for(msg->get_topic()).publish(std::move(msg));
+    }
+    /**
+     * Publishes a message on the client for its topic.
+     * @param topic The topic to deliver the message to.
+     * @param payload The bytes of the payload.
+     * @param n The size of the payload, in bytes.
+     * @param qos The QoS to deliver the message.
+     * @param retained Whether the server should hold on to the message.
+     * @return The token used to track and wait for the publish to
+     *  	   complete.
+     */
+    delivery_token_ptr publish(
+        const string& topic, const void* payload, size_t n, int qos = message::DFLT_QOS,
+        bool retained = message::DFLT_RETAINED
+    ) {
+        return client_for(topic).publish(topic, payload, n, qos, retained);
+    }
+    /**
+     * Publishes a message on the client for its topic.
+     * @param topic The topic to deliver the message to.
+     * @param payload The payload.
+     * @param qos The QoS to deliver the message.
+     * @param retained Whether the server should hold on to the message.
+     * @return The token used to track and wait for the publish to
+     *  	   complete.
+     */
+    delivery_token_ptr publish(
+        const string& topic, binary_ref payload, int qos = message::DFLT_QOS,
+        bool retained = message::DFLT_RETAINED
+    ) {
+        return client_for(topic).publish(topic, std::move(payload), qos, retained);
+    }
+    /**
+     * Gets the delivery tokens for the messages that are in flight on all
+     * of the clients.
+     * @return The pending delivery tokens of all the clients.
+     */
+    std::vector<delivery_token_ptr> get_pending_delivery_tokens() const;
+    /**
+     * Waits for all of the messages in flight on all of the clients to
+     * complete.
+     * @return @em true if all the messages were delivered, @em false if
+     *  	   any of them failed.
+     */
+    bool flush();
+    /**
+     * Gets the metrics of all the clients, added together.
+     * @return The total metrics of the pool.
+     */
+    client_metrics get_metrics() const;
+};
+
+/** Smart/shared pointer to an async_client_pool */
+using async_client_pool_ptr = async_client_pool::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_async_client_pool_h
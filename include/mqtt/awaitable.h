@@ -0,0 +1,282 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file awaitable.h
+/// Support for awaiting MQTT tokens from C++20 coroutines.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_awaitable_h
+#define __mqtt_awaitable_h
+
+// The library itself only requires C++17. This header is only usable by
+// applications that are compiled for C++20 with coroutine support.
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "mqtt/async_client.h"
+#include "mqtt/token.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A function that schedules a suspended coroutine to be resumed.
+ *
+ * This is called from the library's callback thread when an awaited
+ * operation completes. It would typically post the handle to a queue that
+ * is serviced by the application's own thread(s), which then call @em
+ * resume() on it.
+ */
+using resume_executor = std::function<void(std::coroutine_handle<>)>;
+
+/**
+ * An awaiter for a token, allowing a coroutine to suspend until the
+ * operation that the token tracks has completed.
+ *
+ * When the operation completes, the coroutine is resumed directly from
+ * the library's callback thread, unless an executor is supplied, in which
+ * case the executor is handed the coroutine to resume wherever it likes.
+ *
+ * The result of the @em co_await is the token itself. If the operation
+ * failed, the @em co_await throws the same exception as @ref
+ * token::wait().
+ *
+ * @tparam T The type of token, like @ref token or @ref delivery_token.
+ */
+template <typename T>
+class token_awaiter
+{
+    static_assert(std::is_base_of_v<token, T>, "token_awaiter requires a token type");
+
+    /** The token being awaited */
+    std::shared_ptr<T> tok_;
+    /** Where to resume the coroutine, if not inline */
+    const resume_executor* exec_;
+
+public:
+    /**
+     * Creates an awaiter for the token.
+     * @param tok The token to await.
+     * @param exec Schedules the coroutine to resume. If null, the
+     *  		   coroutine is resumed from the library's callback thread.
+     *  		   It must outlive the operation.
+     */
+    explicit token_awaiter(std::shared_ptr<T> tok, const resume_executor* exec = nullptr)
+        : tok_{std::move(tok)}, exec_{exec} {}
+    /**
+     * Determines if the operation has already completed, in which case
+     * the coroutine isn't suspended.
+     */
+    bool await_ready() const noexcept { return !tok_ || tok_->is_complete(); }
+    /**
+     * Arranges for the coroutine to be resumed when the operation
+     * completes.
+     * @return @em false if the operation completed in the meantime, and
+     *  	   the coroutine should just continue.
+     */
+    bool await_suspend(std::coroutine_handle<> h) {
+        // Only capture what fits the handler's small-object buffer, so
+        // that awaiting doesn't allocate.
+        if (exec_)
+            return tok_->set_complete_handler([exec = exec_, h] { (*exec)(h); });
+        return tok_->set_complete_handler([h] { h.resume(); });
+    }
+    /**
+     * Gets the completed token.
+     * @return The token.
+     * @throw exception if the operation failed.
+     */
+    std::shared_ptr<T> await_resume() {
+        if (tok_)
+            tok_->wait();
+        return std::move(tok_);
+    }
+};
+
+/**
+ * Lets a coroutine @em co_await a token directly, such as:
+ * @code
+ * co_await cli.publish(msg);
+ * @endcode
+ * The coroutine is resumed from the library's callback thread.
+ * @param tok The token to await.
+ * @return An awaiter for the token.
+ */
+template <typename T, typename = std::enable_if_t<std::is_base_of_v<token, T>>>
+token_awaiter<T> operator co_await(std::shared_ptr<T> tok) {
+    return token_awaiter<T>{std::move(tok)};
+}
+
+/**
+ * Awaits a token, resuming the coroutine through an executor, such as:
+ * @code
+ * co_await mqtt::resume_on(cli.publish(msg), exec);
+ * @endcode
+ * @param tok The token to await.
+ * @param exec Schedules the coroutine to be resumed when the operation
+ *  		   completes. This is kept by reference, and must outlive
+ *  		   the operation.
+ * @return An awaiter for the token.
+ */
+template <typename T>
+token_awaiter<T> resume_on(std::shared_ptr<T> tok, const resume_executor& exec) {
+    return token_awaiter<T>{std::move(tok), &exec};
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An awaiter for the next message in a client's consumer queue, allowing
+ * a coroutine to suspend until a message arrives, rather than block a
+ * thread in @ref async_client::consume_message().
+ *
+ * The coroutine is resumed directly from the thread that put the message
+ * into the queue, which is normally the library's callback thread, unless
+ * an executor is supplied. Any number of coroutines can wait at once,
+ * and they get the messages in the order that they started waiting.
+ *
+ * The result of the @em co_await is the message, or a null pointer if the
+ * connection was lost or closed, or if the client stopped consuming.
+ */
+class message_awaiter
+{
+    /** The client */
+    async_client& cli_;
+    /** Where to resume the coroutine, if not inline */
+    const resume_executor* exec_;
+    /** The message */
+    const_message_ptr msg_;
+
+public:
+    /**
+     * Creates an awaiter for the next message.
+     * @param cli The client, which must be consuming.
+     * @param exec Schedules the coroutine to resume. If null, the
+     *  		   coroutine is resumed from the library's callback thread.
+     *  		   It must outlive the wait.
+     */
+    explicit message_awaiter(async_client& cli, const resume_executor* exec = nullptr)
+        : cli_{cli}, exec_{exec} {}
+    /**
+     * The coroutine is always suspended, since checking the queue and
+     * waiting on it is done in one step.
+     */
+    bool await_ready() const noexcept { return false; }
+    /**
+     * Takes the next message, or arranges for the coroutine to be resumed
+     * when one arrives.
+     * @return @em false if a message was ready, and the coroutine should
+     *  	   just continue.
+     */
+    bool await_suspend(std::coroutine_handle<> h) {
+        return cli_.await_message(&msg_, [this, h](const_message_ptr msg) {
+            // The awaiter lives in the suspended coroutine, so it mustn't
+            // be touched after the coroutine is resumed.
+            msg_ = std::move(msg);
+            if (exec_)
+                (*exec_)(h);
+            else
+                h.resume();
+        });
+    }
+    /**
+     * Gets the message.
+     * @return The message, or a null pointer if the connection was lost or
+     *  	   consuming stopped.
+     */
+    const_message_ptr await_resume() noexcept { return std::move(msg_); }
+};
+
+/**
+ * Awaits the next message from a client's consumer queue, such as:
+ * @code
+ * while (auto msg = co_await mqtt::next_message(cli)) {
+ *     ...
+ * }
+ * @endcode
+ * @param cli The client, which must be consuming.
+ * @param exec Schedules the coroutine to be resumed, if not null. This
+ *  		   is kept by reference, and must outlive the wait.
+ * @return An awaiter for the message.
+ */
+inline message_awaiter next_message(async_client& cli, const resume_executor* exec = nullptr) {
+    return message_awaiter{cli, exec};
+}
+
+/**
+ * A stream of the messages from a client's consumer queue, for a
+ * coroutine that handles them in a loop.
+ *
+ * C++20 has no asynchronous range-for, so the stream is read by awaiting
+ * next() until it gives a null message:
+ * @code
+ * auto stream = mqtt::messages(cli);
+ * while (auto msg = co_await stream.next()) {
+ *     ...
+ * }
+ * @endcode
+ * The stream ends when the connection is lost or closed, or the client
+ * stops consuming. After a reconnect, a new stream can pick up again.
+ */
+class message_stream
+{
+    /** The client */
+    async_client* cli_;
+    /** Where to resume the coroutine, if not inline */
+    const resume_executor* exec_;
+
+public:
+    /**
+     * Creates a stream of the messages from a client.
+     * @param cli The client, which must be consuming.
+     * @param exec Schedules the coroutine to be resumed, if not null. This
+     *  		   is kept by reference, and must outlive the stream.
+     */
+    explicit message_stream(async_client& cli, const resume_executor* exec = nullptr)
+        : cli_{&cli}, exec_{exec} {}
+    /**
+     * Awaits the next message.
+     * @return An awaiter for the message.
+     */
+    message_awaiter next() const { return message_awaiter{*cli_, exec_}; }
+};
+
+/**
+ * Gets a stream of the messages from a client's consumer queue.
+ * @param cli The client, which must be consuming.
+ * @param exec Schedules the coroutine to be resumed, if not null. This
+ *  		   is kept by reference, and must outlive the stream.
+ * @return A stream of the messages.
+ */
+inline message_stream messages(async_client& cli, const resume_executor* exec = nullptr) {
+    return message_stream{cli, exec};
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __cpp_impl_coroutine
+
+#endif  // __mqtt_awaitable_h
@@ -0,0 +1,265 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file batch_token.h
+/// Declaration of MQTT batch_token class, a single token that tracks the
+/// delivery of a batch of messages, or a batch of subscription requests.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_batch_token_h
+#define __mqtt_batch_token_h
+
+#include <memory>
+#include <vector>
+
+#include "MQTTAsync.h"
+#include "mqtt/message.h"
+#include "mqtt/string_collection.h"
+#include "mqtt/token.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A token that tracks the delivery of a batch of messages.
+ *
+ * This is returned by @ref async_client::publish_batch(). It completes
+ * once every message in the batch has been acknowledged by the server, or
+ * has failed. The token as a whole reports the error for the first
+ * message that failed, if any, while the result of each message can be
+ * read individually by its index in the batch.
+ *
+ * It is also returned by @ref async_client::subscribe_batch() and
+ * @ref async_client::unsubscribe_batch(), in which case the items in the
+ * batch are the topic filters. These are sent to the server in chunks,
+ * each a single request, but the results are still read by the index of
+ * the filter.
+ */
+class batch_token : public token
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<batch_token>;
+    /** Smart/shared pointer to a const object of this class */
+    using const_ptr_t = std::shared_ptr<const batch_token>;
+    /** Weak pointer to an object of this class */
+    using weak_ptr_t = std::weak_ptr<batch_token>;
+
+private:
+    /**
+     * The context passed to the C library for a single request, which
+     * covers one message, or a chunk of topic filters.
+     */
+    struct item
+    {
+        /** The batch that the request belongs to */
+        batch_token* batch;
+        /** The index of the first entry of the request in the batch */
+        size_t first;
+        /** The number of entries in the request */
+        size_t count;
+    };
+
+    /** The messages in a publish batch */
+    std::vector<const_message_ptr> msgs_;
+    /** The topic filters in a subscribe or unsubscribe batch */
+    const_string_collection_ptr topics_;
+    /** The C callback contexts for the requests */
+    std::vector<item> items_;
+    /** The return code for each entry */
+    std::vector<int> rcs_;
+    /** The MQTT v5 reason code for each entry */
+    std::vector<ReasonCode> reasonCodes_;
+    /** The number of requests that haven't completed */
+    size_t nPending_;
+    /** The number of entries that failed */
+    size_t nFailed_{0};
+
+    /** The client has special access */
+    friend class async_client;
+
+    /** C-style callbacks for a single message in the batch */
+    static void on_item_success(void* itemObj, MQTTAsync_successData* rsp);
+    static void on_item_success5(void* itemObj, MQTTAsync_successData5* rsp);
+    static void on_item_failure(void* itemObj, MQTTAsync_failureData* rsp);
+    static void on_item_failure5(void* itemObj, MQTTAsync_failureData5* rsp);
+    /**
+     * Records the result for one entry.
+     * This must be called with the lock held.
+     * @param idx The index of the entry in the batch.
+     * @param rc The return code for the entry.
+     * @param reasonCode The MQTT v5 reason code for the entry.
+     */
+    void set_result(size_t idx, int rc, ReasonCode reasonCode);
+    /**
+     * Records the same result for every entry of a request, completing the
+     * token if it was the last one outstanding.
+     * @param itm The request.
+     * @param rc The return code for the request.
+     * @param reasonCode The MQTT v5 reason code for the request.
+     */
+    void on_item_complete(
+        const item& itm, int rc, ReasonCode reasonCode = ReasonCode::SUCCESS
+    );
+    /**
+     * Records the result of a request from a list of codes, one for each
+     * entry, completing the token if it was the last one outstanding.
+     * @param itm The request.
+     * @param codes The codes for the entries.
+     * @param n The number of codes.
+     */
+    template <typename T>
+    void on_item_complete(const item& itm, const T* codes, size_t n);
+    /**
+     * Records the result for the request at the index.
+     * @param idx The index of the request.
+     * @param rc The return code for the request.
+     */
+    void on_item_complete(size_t idx, int rc) { on_item_complete(items_[idx], rc); }
+    /**
+     * Gets the C library response options for the request at the index.
+     * @param idx The index of the request.
+     * @param mqttVersion The MQTT version used by the client.
+     */
+    MQTTAsync_responseOptions response_options(size_t idx, int mqttVersion);
+
+public:
+    /** The batch as a whole reports the error of the first failure */
+    using token::get_reason_code;
+    using token::get_return_code;
+
+    /**
+     * Creates a token for a batch of messages.
+     * @param cli The asynchronous client object.
+     * @param msgs The messages in the batch.
+     */
+    batch_token(iasync_client& cli, std::vector<const_message_ptr> msgs);
+    /**
+     * Creates a token for a batch of messages.
+     * @param cli The asynchronous client object.
+     * @param msgs The messages in the batch.
+     */
+    static ptr_t create(iasync_client& cli, std::vector<const_message_ptr> msgs) {
+        return make_pooled<batch_token>(cli, std::move(msgs));
+    }
+    /**
+     * Creates a token for a batch of subscribe or unsubscribe requests.
+     * @param cli The asynchronous client object.
+     * @param typ The type of request, @em SUBSCRIBE or @em UNSUBSCRIBE.
+     * @param topics The topic filters in the batch.
+     * @param chunkSize The maximum number of filters in each request.
+     * @throw std::invalid_argument if the type is not a subscription
+     *  	  request, or the chunk size is zero.
+     */
+    batch_token(
+        iasync_client& cli, Type typ, const_string_collection_ptr topics, size_t chunkSize
+    );
+    /**
+     * Creates a token for a batch of subscribe or unsubscribe requests.
+     * @param cli The asynchronous client object.
+     * @param typ The type of request, @em SUBSCRIBE or @em UNSUBSCRIBE.
+     * @param topics The topic filters in the batch.
+     * @param chunkSize The maximum number of filters in each request.
+     * @throw std::invalid_argument if the type is not a subscription
+     *  	  request, or the chunk size is zero.
+     */
+    static ptr_t create(
+        iasync_client& cli, Type typ, const_string_collection_ptr topics, size_t chunkSize
+    ) {
+        return make_pooled<batch_token>(cli, typ, std::move(topics), chunkSize);
+    }
+/**
+ * Expose the C library response options for the unit tests.
+ */
+#if defined(UNIT_TESTS)
+    MQTTAsync_responseOptions c_struct(size_t idx, int mqttVersion) {
+        return response_options(idx, mqttVersion);
+    }
+#endif
+    /**
+     * Gets the number of entries in the batch.
+     * @return The number of messages or topic filters in the batch.
+     */
+    size_t size() const { return rcs_.size(); }
+    /**
+     * Gets the number of requests that the batch was sent as.
+     * For a publish batch, this is the number of messages. For a
+     * subscription batch, it is the number of chunks.
+     * @return The number of requests in the batch.
+     */
+    size_t num_requests() const { return items_.size(); }
+    /**
+     * Gets a message in a publish batch.
+     * @param i The index of the message in the batch.
+     * @return The message.
+     */
+    const_message_ptr get_message(size_t i) const { return msgs_.at(i); }
+    /**
+     * Gets the topic filters in a subscribe or unsubscribe batch.
+     * @return The topic filters, or a null pointer for a publish batch.
+     */
+    const_string_collection_ptr get_topic_filters() const { return topics_; }
+    /**
+     * Gets the number of entries in the batch that failed.
+     * This is only final once the token is complete.
+     * @return The number of messages or filters that failed.
+     */
+    size_t num_failed() const {
+        guard g(lock_);
+        return nFailed_;
+    }
+    /**
+     * Gets the return code for an entry in the batch.
+     * @param i The index of the message or filter in the batch.
+     * @return The return code for the entry, which is
+     *  	   MQTTASYNC_SUCCESS if it succeeded, or hasn't completed.
+     */
+    int get_return_code(size_t i) const {
+        guard g(lock_);
+        return rcs_.at(i);
+    }
+    /**
+     * Gets the reason code for an entry in the batch.
+     * For a subscribe batch, this is the code from the server's SUBACK
+     * for the filter, which is the granted QoS on success.
+     * @param i The index of the message or filter in the batch.
+     * @return The reason code for the entry.
+     */
+    ReasonCode get_reason_code(size_t i) const {
+        guard g(lock_);
+        return reasonCodes_.at(i);
+    }
+    /**
+     * Gets the indexes of the entries that failed.
+     * @return The indexes of the messages or filters that failed, in
+     *  	   order.
+     */
+    std::vector<size_t> failed_items() const;
+};
+
+/** Smart/shared pointer to a batch_token */
+using batch_token_ptr = batch_token::ptr_t;
+
+/** Smart/shared pointer to a const batch_token */
+using const_batch_token_ptr = batch_token::const_ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_batch_token_h
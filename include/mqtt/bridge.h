@@ -0,0 +1,288 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file bridge.h
+/// Declaration of MQTT bridge class, which forwards messages from one
+/// server to another.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_bridge_h
+#define __mqtt_bridge_h
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mqtt/async_client.h"
+#include "mqtt/message.h"
+#include "mqtt/topic_matcher.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Forwards messages from a client on one server to a client on another.
+ *
+ * Each rule subscribes to a filter on the source, and can rewrite the
+ * topic of the messages it forwards by swapping a prefix for another. When
+ * the filters of more than one rule match a topic, the first rule that was
+ * added wins, and the message is forwarded once.
+ * @par
+ * The inbound message is published to the destination as it is, sharing
+ * its payload and properties, and a zero-copy source client (see
+ * @ref create_options::set_zero_copy_messages) means that the bytes that
+ * arrived are the bytes that are sent. A message is only copied when its
+ * topic is rewritten, or when it carries the @em TOPIC_ALIAS or
+ * @em SUBSCRIPTION_IDENTIFIER properties, which belong to the source
+ * connection, and then only the message header is copied; the payload is
+ * still shared.
+ * @par
+ * The bridge puts the source client into manual-ack mode, and acks each
+ * QoS 1 and 2 message when its delivery to the destination completes. So
+ * the source server doesn't get its acks until the destination has the
+ * messages, and no more than the in-flight limit are taken from it while
+ * the destination catches up.
+ * @par
+ * A message that can't be delivered is still acked, so that the flow from
+ * the source doesn't stop. To keep those, turn on publish retries or
+ * offline buffering on the destination client, and/or set a failure
+ * handler.
+ * @par
+ * The rules must be added before the bridge is started. The bridge must
+ * not be destroyed from within the failure handler.
+ */
+class bridge
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<bridge>;
+    /**
+     * The handler for a message that could not be forwarded.
+     * This gets the message as it was sent to the destination, and the
+     * error code of the failure.
+     */
+    using failure_handler = std::function<void(const const_message_ptr& msg, int rc)>;
+
+    /** The default number of source messages that can be in flight */
+    static constexpr std::size_t DFLT_MAX_IN_FLIGHT = 1000;
+
+    /** A rule for the messages to forward */
+    struct rule
+    {
+        /** The filter to subscribe to on the source */
+        string filter;
+        /** The QoS of the subscription on the source */
+        int qos;
+        /** The topic prefix to remove, if any */
+        string srcPrefix;
+        /** The prefix to put in its place, if any */
+        string dstPrefix;
+    };
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /**
+     * The counts and the failure handler, which are shared with the
+     * delivery tokens, since they can complete after the bridge is gone.
+     */
+    struct state
+    {
+        /** The number of messages forwarded */
+        std::atomic<size_t> nForwarded{0};
+        /** The number of messages that had to be copied to forward */
+        std::atomic<size_t> nCopied{0};
+        /** The number of messages delivered to the destination */
+        std::atomic<size_t> nDelivered{0};
+        /** The number of messages that failed to be delivered */
+        std::atomic<size_t> nFailed{0};
+        /** The number of messages awaiting delivery */
+        std::atomic<size_t> nInFlight{0};
+        /** Lock for the handler */
+        std::mutex lock;
+        /** The handler for failed messages */
+        failure_handler onFailure;
+
+        /** Handles the completion of a delivery */
+        void on_complete(const delivery_token& tok);
+        /** Handles a message that failed to be delivered */
+        void on_failure(const const_message_ptr& msg, int rc);
+    };
+
+    /**
+     * The link from the subscriptions back to this object, which is cut
+     * when it's destroyed, since the async_client may still be calling
+     * the subscription handlers.
+     */
+    struct link
+    {
+        /** Held while a message is being forwarded */
+        std::mutex lock;
+        /** The bridge, or null once it's gone */
+        bridge* br;
+    };
+
+    /** The client for the source server */
+    async_client& src_;
+    /** The client for the destination server */
+    async_client& dst_;
+    /** The forwarding rules, in the order they were added */
+    std::vector<rule> rules_;
+    /** The index of the rule for each filter */
+    topic_matcher<size_t> matcher_;
+    /** The number of messages that matched no rule */
+    std::atomic<size_t> nUnmatched_{0};
+    /** The counts shared with the delivery tokens */
+    std::shared_ptr<state> state_;
+    /** The link from the subscriptions */
+    std::shared_ptr<link> link_;
+
+    /**
+     * Finds the rule for a topic.
+     * @return The index of the first matching rule, or the number of
+     *  	   rules if none match.
+     */
+    size_t find_rule(const string& topic) const;
+    /** Forwards the message for the rule at the index. */
+    bool forward(size_t idx, const const_message_ptr& msg);
+
+public:
+    /**
+     * Creates a bridge between two clients.
+     * This puts the source client into manual-ack mode.
+     * @param src The client for the source server.
+     * @param dst The client for the destination server.
+     * @param maxInFlight The most source messages to have in flight,
+     *  				  awaiting delivery to the destination, or zero for
+     *  				  no limit.
+     */
+    bridge(async_client& src, async_client& dst, std::size_t maxInFlight = DFLT_MAX_IN_FLIGHT);
+    /**
+     * Destroys the bridge, stopping it.
+     */
+    ~bridge();
+
+    bridge(const bridge&) = delete;
+    bridge& operator=(const bridge&) = delete;
+
+    /**
+     * Adds a rule to forward the messages that match a filter.
+     * A topic starting with the source prefix has it replaced with the
+     * destination prefix. Other topics are forwarded as they are.
+     * @param filter The filter to subscribe to on the source.
+     * @param qos The QoS of the subscription on the source. The messages
+     *  		  are forwarded at the QoS that they arrive with.
+     * @param srcPrefix The topic prefix to remove, if any.
+     * @param dstPrefix The prefix to put in its place, if any.
+     * @throw std::invalid_argument if there is already a rule for the
+     *  	  filter.
+     */
+    void add_rule(
+        const string& filter, int qos = 1, const string& srcPrefix = string{},
+        const string& dstPrefix = string{}
+    );
+    /**
+     * Gets the rules, in the order they were added.
+     * @return The rules.
+     */
+    const std::vector<rule>& get_rules() const { return rules_; }
+    /**
+     * Sets a handler for the messages that could not be forwarded.
+     * This is called from the client callback threads.
+     * @param cb The handler.
+     */
+    void set_failure_handler(failure_handler cb);
+    /**
+     * Gets the topic that a message would be forwarded to.
+     * @param topic The topic of a source message.
+     * @return The destination topic, or an empty string if no rule
+     *  	   matches the topic.
+     */
+    string map_topic(const string& topic) const;
+    /**
+     * Forwards a message from the source to the destination.
+     * This is what the subscriptions do with each message. It can also be
+     * used for messages that the app got from the source client itself.
+     * A message that matches no rule is acked and dropped.
+     * @param msg The source message.
+     * @return @em true if the message was handed to the destination
+     *  	   client, @em false if it was dropped, or the publish failed.
+     */
+    bool forward(const const_message_ptr& msg);
+    /**
+     * Subscribes to the filters of the rules on the source.
+     * This should be done once the source client is connected. With a
+     * clean session, it must be done again on each connection.
+     * @return The tokens to track the subscriptions, one per rule.
+     */
+    std::vector<token_ptr> start();
+    /**
+     * Stops the bridge.
+     * This unsubscribes from the filters on the source, and takes the
+     * source client out of manual-ack mode. Messages already forwarded are
+     * still acked when their delivery completes. It's safe to call this
+     * more than once.
+     */
+    void stop();
+    /**
+     * Gets the number of messages that were forwarded.
+     * @return The number of messages forwarded.
+     */
+    std::size_t num_forwarded() const { return state_->nForwarded; }
+    /**
+     * Gets the number of forwarded messages that had to be copied,
+     * because the topic was rewritten, or the properties had to be
+     * trimmed.
+     * @return The number of messages copied.
+     */
+    std::size_t num_copied() const { return state_->nCopied; }
+    /**
+     * Gets the number of messages that were delivered to the destination.
+     * @return The number of messages delivered.
+     */
+    std::size_t num_delivered() const { return state_->nDelivered; }
+    /**
+     * Gets the number of messages that could not be forwarded.
+     * @return The number of messages that failed.
+     */
+    std::size_t num_failed() const { return state_->nFailed; }
+    /**
+     * Gets the number of forwarded messages that are awaiting delivery.
+     * @return The number of messages in flight.
+     */
+    std::size_t num_in_flight() const { return state_->nInFlight; }
+    /**
+     * Gets the number of messages that matched no rule.
+     * @return The number of messages dropped.
+     */
+    std::size_t num_unmatched() const { return nUnmatched_; }
+};
+
+/** Smart/shared pointer to a bridge */
+using bridge_ptr = bridge::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_bridge_h
@@ -26,7 +26,14 @@
 
 #include <cstring>
 #include <iostream>
+#include <memory>
 
+#include "mqtt/platform.h"
+#include "mqtt/pool_allocator.h"
+
+#if defined(PAHO_MQTTPP_HAS_PMR)
+    #include <memory_resource>
+#endif
 #include "mqtt/types.h"
 
 namespace mqtt {
@@ -45,6 +52,29 @@ namespace mqtt {
  * The buffer is immutable but the reference itself acts like a normal
  * variable. It can be reassigned to point to a different buffer.
  *
+ * A reference can also adopt an external buffer that was allocated
+ * elsewhere, such as by the C library, without copying it. The buffer is
+ * released by the owner's deleter when the last reference goes away. The
+ * data() and size() of such a reference do not copy, but the first call
+ * to one of the string accessors, like str() or c_str(), makes a copy of
+ * the data in a new string which is then kept for the life of the buffer.
+ *
+ * Short data, up to @ref INLINE_SIZE elements, is kept inline, in the
+ * reference itself, rather than in a shared buffer. Creating and copying
+ * a short reference then just copies the bytes, with no allocation and no
+ * atomic reference count. As with an external buffer, a string is only
+ * made for a short reference on the first call to str() or ptr(), but
+ * not for data() or c_str(). Since each copy has its own inline bytes,
+ * the data of a short reference is only valid while that particular
+ * reference is alive and unchanged. Unlike a shared buffer, this holds
+ * for a move, too: moving a short reference copies its bytes, so a
+ * pointer from data() or c_str() of the reference that was moved from
+ * does not carry over to the one that it was moved to.
+ * @par
+ * The inline bytes are sized so that, with a 64-bit shared pointer, a
+ * reference takes 64 bytes, a single cache line, which is 24 more than
+ * it would without them.
+ *
  * If no value has been assigned to a reference, then it is in a default
  * "null" state. It is not safe to call any member functions on a null
  * reference, other than to check if the object is null or empty.
@@ -75,10 +105,127 @@ public:
      *  Note that it is a pointer to a _const_ blob.
      */
     using pointer_type = std::shared_ptr<const blob>;
+    /**
+     * The pointer to an external buffer.
+     * This owns the memory through whatever deleter it was given.
+     */
+    using external_pointer_type = std::shared_ptr<const value_type>;
+    /**
+     * The longest data that's kept inline, in the reference itself.
+     * This covers many topics, and small payloads, and leaves room for
+     * the NUL terminator and the inline flag in 24 bytes.
+     */
+    static constexpr size_t INLINE_SIZE = (24 - sizeof(bool)) / sizeof(value_type) - 1;
 
 private:
-    /** Our data is a shared pointer to a const buffer */
-    pointer_type data_;
+    /**
+     * Our data is a shared pointer to a const buffer.
+     * For an external or inline buffer, this is only created on demand,
+     * and must be accessed atomically, since other references may be
+     * reading it.
+     */
+    mutable pointer_type data_;
+    /** An external buffer (if any) */
+    external_pointer_type ext_;
+    /** The size of the external or inline buffer */
+    size_t extLen_{0};
+    /** Whether the data is kept inline */
+    bool inline_{false};
+    /** The inline data, with a NUL terminator */
+    value_type buf_[INLINE_SIZE + 1];
+
+    /**
+     * Creates a new blob.
+     * The blob and its shared pointer control block are allocated together
+     * from a pool, so they are recycled when the last reference goes away.
+     */
+    template <typename... Args>
+    static pointer_type make_blob(Args&&... args) {
+        return std::allocate_shared<blob>(pool_allocator<blob>{}, std::forward<Args>(args)...);
+    }
+    /**
+     * Gets the pointer to the blob, creating it from the external buffer,
+     * if needed.
+     */
+    const pointer_type& blob_ptr() const {
+        if ((ext_ || inline_) && !std::atomic_load(&data_)) {
+            pointer_type expected, p = make_blob(data(), extLen_);
+            std::atomic_compare_exchange_strong(&data_, &expected, p);
+        }
+        return data_;
+    }
+    /**
+     * Keeps the data inline.
+     * The data can be from this object's own buffer.
+     */
+    void set_inline(const value_type* buf, size_t n) {
+        data_.reset();
+        ext_.reset();
+        if (n > 0)
+            std::memmove(buf_, buf, n * sizeof(value_type));
+        buf_[n] = value_type{};
+        extLen_ = n;
+        inline_ = true;
+    }
+    /**
+     * Copies the data into a new shared buffer, or inline if it's short.
+     */
+    void assign(const value_type* buf, size_t n) {
+        if (n <= INLINE_SIZE)
+            set_inline(buf, n);
+        else {
+            data_ = make_blob(buf, n);
+            ext_.reset();
+            extLen_ = 0;
+            inline_ = false;
+        }
+    }
+    /**
+     * Moves a string into a new shared buffer, or copies it inline if it's
+     * short. Either way, the string is left empty.
+     */
+    void assign(blob&& b) {
+        if (b.size() <= INLINE_SIZE) {
+            set_inline(b.data(), b.size());
+            b.clear();
+        }
+        else {
+            data_ = make_blob(std::move(b));
+            ext_.reset();
+            extLen_ = 0;
+            inline_ = false;
+        }
+    }
+    /**
+     * Copies another reference. Inline data is copied, as is. Otherwise
+     * this just shares the buffer.
+     */
+    void copy(const buffer_ref& rhs) {
+        if (rhs.inline_)
+            set_inline(rhs.buf_, rhs.extLen_);
+        else {
+            data_ = rhs.ext_ ? std::atomic_load(&rhs.data_) : rhs.data_;
+            ext_ = rhs.ext_;
+            extLen_ = rhs.extLen_;
+            inline_ = false;
+        }
+    }
+    /**
+     * Moves another reference, leaving it null.
+     */
+    void move(buffer_ref&& rhs) {
+        if (rhs.inline_) {
+            set_inline(rhs.buf_, rhs.extLen_);
+            data_ = std::move(rhs.data_);
+        }
+        else {
+            data_ = std::move(rhs.data_);
+            ext_ = std::move(rhs.ext_);
+            extLen_ = rhs.extLen_;
+            inline_ = false;
+        }
+        rhs.reset();
+    }
 
 public:
     /**
@@ -89,23 +236,25 @@ public:
      * Copy constructor only copies a shared pointer.
      * @param buf Another buffer reference.
      */
-    buffer_ref(const buffer_ref& buf) = default;
+    buffer_ref(const buffer_ref& buf) { copy(buf); }
     /**
-     * Move constructor only moves a shared pointer.
+     * Move constructor only moves a shared pointer, or copies inline data.
+     * For inline data, the new reference has its own copy of the bytes,
+     * so data() differs from what it was for the other reference.
      * @param buf Another buffer reference.
      */
-    buffer_ref(buffer_ref&& buf) = default;
+    buffer_ref(buffer_ref&& buf) noexcept { move(std::move(buf)); }
     /**
      * Creates a reference to a new buffer by copying data.
      * @param b A string from which to create a new buffer.
      */
-    buffer_ref(const blob& b) : data_{std::make_shared<blob>(b)} {}
+    buffer_ref(const blob& b) { assign(b.data(), b.size()); }
     /**
      * Creates a reference to a new buffer by moving a string into the
      * buffer.
      * @param b A string from which to create a new buffer.
      */
-    buffer_ref(blob&& b) : data_{std::make_shared<blob>(std::move(b))} {}
+    buffer_ref(blob&& b) { assign(std::move(b)); }
     /**
      * Creates a reference to an existing buffer by copying the shared
      * pointer.
@@ -127,7 +276,83 @@ public:
      * @param buf The memory to copy
      * @param n The number of bytes to copy.
      */
-    buffer_ref(const value_type* buf, size_t n) : data_{std::make_shared<blob>(buf, n)} {}
+    buffer_ref(const value_type* buf, size_t n) { assign(buf, n); }
+    /**
+     * Creates a reference that adopts an external buffer, without copying
+     * the data.
+     * The buffer is released through the pointer's deleter when the last
+     * reference to it is destroyed. Note that it is up to the caller to
+     * insure that there are no mutable references to the buffer.
+     * @param p A shared pointer to the external buffer.
+     * @param n The number of elements in the buffer.
+     */
+    buffer_ref(external_pointer_type p, size_t n) : ext_{std::move(p)}, extLen_{n} {
+        if (!ext_)
+            extLen_ = 0;
+    }
+    /**
+     * Creates a reference that adopts any contiguous memory, like a
+     * memory-mapped file or a slot from an app's buffer pool, without
+     * copying it.
+     * The deleter is called with the pointer when the last reference to
+     * the buffer is destroyed. Note that it is up to the caller to insure
+     * that the memory isn't changed while it's referenced.
+     * @param buf The memory.
+     * @param n The number of elements in the buffer.
+     * @param deleter Releases the memory, like @em munmap() or a return to
+     *  			  the pool.
+     */
+    template <typename Deleter>
+    buffer_ref(const value_type* buf, size_t n, Deleter deleter)
+        : buffer_ref(external_pointer_type{buf, std::move(deleter)}, n) {}
+    /**
+     * Creates a reference to memory that is kept alive by another object,
+     * without copying it.
+     * This uses the aliasing constructor of @em std::shared_ptr, so the
+     * buffer holds a share of the owner, like a camera frame whose data is
+     * part of a larger object, and no new control block is allocated.
+     * @param owner The object that owns the memory.
+     * @param buf The memory, which must stay valid as long as the owner.
+     * @param n The number of elements in the buffer.
+     */
+    template <typename U>
+    buffer_ref(std::shared_ptr<U> owner, const value_type* buf, size_t n)
+        : buffer_ref(external_pointer_type{std::move(owner), buf}, n) {}
+#if defined(PAHO_MQTTPP_HAS_PMR)
+    /**
+     * Creates a reference to a new buffer containing a copy of the data,
+     * allocated from a memory resource.
+     * The buffer and its shared pointer control block both come from the
+     * resource, and are returned to it when the last reference to the
+     * buffer is destroyed, so the resource must outlive all the references.
+     * Short data is kept inline, as usual, and doesn't touch the resource.
+     * A string made by str() or ptr() still comes from the heap.
+     * @param mr The memory resource. If null, the buffer comes from the
+     *  		 heap.
+     * @param buf The memory to copy.
+     * @param n The number of elements to copy.
+     */
+    buffer_ref(std::pmr::memory_resource* mr, const value_type* buf, size_t n) {
+        if (!mr || n <= INLINE_SIZE) {
+            assign(buf, n);
+            return;
+        }
+
+        auto p = static_cast<value_type*>(mr->allocate(n * sizeof(value_type), alignof(value_type)));
+        std::memcpy(p, buf, n * sizeof(value_type));
+
+        ext_ = external_pointer_type{
+            p,
+            [mr, n](const value_type* q) {
+                mr->deallocate(
+                    const_cast<value_type*>(q), n * sizeof(value_type), alignof(value_type)
+                );
+            },
+            std::pmr::polymorphic_allocator<value_type>{mr}
+        };
+        extLen_ = n;
+    }
+#endif
     /**
      * Creates a reference to a new buffer containing a copy of the
      * NUL-terminated char array.
@@ -145,13 +370,23 @@ public:
      * @param rhs Another buffer
      * @return A reference to this object
      */
-    buffer_ref& operator=(const buffer_ref& rhs) = default;
+    buffer_ref& operator=(const buffer_ref& rhs) {
+        if (&rhs != this)
+            copy(rhs);
+        return *this;
+    }
     /**
      * Move a reference to a buffer.
+     * Inline data is copied, so data() differs from what it was for the
+     * other reference.
      * @param rhs The other reference to move.
      * @return A reference to this object.
      */
-    buffer_ref& operator=(buffer_ref&& rhs) = default;
+    buffer_ref& operator=(buffer_ref&& rhs) noexcept {
+        if (&rhs != this)
+            move(std::move(rhs));
+        return *this;
+    }
     /**
      * Copy a string into this object, creating a new buffer.
      * Modifies the reference for this object, pointing it to a
@@ -161,7 +396,7 @@ public:
      * @return A reference to this object.
      */
     buffer_ref& operator=(const blob& b) {
-        data_.reset(new blob(b));
+        assign(b.data(), b.size());
         return *this;
     }
     /**
@@ -173,7 +408,7 @@ public:
      * @return A reference to this object.
      */
     buffer_ref& operator=(blob&& b) {
-        data_.reset(new blob(std::move(b)));
+        assign(std::move(b));
         return *this;
     }
     /**
@@ -185,7 +420,7 @@ public:
         static_assert(
             sizeof(char) == sizeof(T), "can only use C arr with char or byte buffers"
         );
-        data_.reset(new blob(reinterpret_cast<const value_type*>(cstr), strlen(cstr)));
+        assign(reinterpret_cast<const value_type*>(cstr), strlen(cstr));
         return *this;
     }
     /**
@@ -202,13 +437,40 @@ public:
         static_assert(
             sizeof(OT) == sizeof(T), "Can only assign buffers if values the same size"
         );
-        data_.reset(new blob(reinterpret_cast<const value_type*>(rhs.data()), rhs.size()));
+        assign(reinterpret_cast<const value_type*>(rhs.data()), rhs.size());
         return *this;
     }
     /**
      * Clears the reference to nil.
      */
-    void reset() { data_.reset(); }
+    void reset() {
+        data_.reset();
+        ext_.reset();
+        extLen_ = 0;
+        inline_ = false;
+    }
+    /**
+     * Drops any reference to an external buffer.
+     */
+    void reset_external() {
+        if (ext_) {
+            ext_.reset();
+            extLen_ = 0;
+        }
+    }
+    /**
+     * Determines if the reference is to an external buffer that was
+     * adopted without copying.
+     * @return @em true if this refers to an external buffer, @em false
+     *  	   otherwise.
+     */
+    bool is_external() const { return bool(ext_); }
+    /**
+     * Determines if the data is short enough to be kept inline, in the
+     * reference itself.
+     * @return @em true if the data is kept inline, @em false otherwise.
+     */
+    bool is_inline() const { return inline_; }
     /**
      * Determines if the reference is valid.
      * If the reference is invalid then it is not safe to call @em any
@@ -216,7 +478,7 @@ public:
      * @return @em true if referring to a valid buffer, @em false if the
      *  	   reference (pointer) is null.
      */
-    explicit operator bool() const { return bool(data_); }
+    explicit operator bool() const { return inline_ || ext_ || data_; }
     /**
      * Determines if the reference is invalid.
      * If the reference is invalid then it is not safe to call @em any
@@ -224,33 +486,37 @@ public:
      * @return @em true if the reference is null, @em false if it is
      *  	   referring to a valid buffer,
      */
-    bool is_null() const { return !data_; }
+    bool is_null() const { return !inline_ && !ext_ && !data_; }
     /**
      * Determines if the buffer is empty.
      * @return @em true if the buffer is empty or the reference is null,
      *  	   @em false if the buffer contains data.
      */
-    bool empty() const { return !data_ || data_->empty(); }
+    bool empty() const {
+        return (inline_ || ext_) ? (extLen_ == 0) : (!data_ || data_->empty());
+    }
     /**
      * Gets a const pointer to the data buffer.
      * @return A pointer to the data buffer.
      */
-    const value_type* data() const { return data_->data(); }
+    const value_type* data() const {
+        return inline_ ? buf_ : (ext_ ? ext_.get() : data_->data());
+    }
     /**
      * Gets the size of the data buffer.
      * @return The size of the data buffer.
      */
-    size_t size() const { return data_->size(); }
+    size_t size() const { return (inline_ || ext_) ? extLen_ : data_->size(); }
     /**
      * Gets the size of the data buffer.
      * @return The size of the data buffer.
      */
-    size_t length() const { return data_->length(); }
+    size_t length() const { return size(); }
     /**
      * Gets the data buffer as a string.
      * @return The data buffer as a string.
      */
-    const blob& str() const { return *data_; }
+    const blob& str() const { return *blob_ptr(); }
     /**
      * Gets the data buffer as a string.
      * @return The data buffer as a string.
@@ -261,18 +527,18 @@ public:
      * Note that the reference must be set to call this function.
      * @return The data buffer as a string.
      */
-    const char* c_str() const { return data_->c_str(); }
+    const char* c_str() const { return inline_ ? buf_ : blob_ptr()->c_str(); }
     /**
      * Gets a shared pointer to the (const) data buffer.
      * @return A shared pointer to the (const) data buffer.
      */
-    const pointer_type& ptr() const { return data_; }
+    const pointer_type& ptr() const { return blob_ptr(); }
     /**
      * Gets elemental access to the data buffer (read only)
      * @param i The index into the buffer.
      * @return The value at the specified index.
      */
-    const value_type& operator[](size_t i) const { return (*data_)[i]; }
+    const value_type& operator[](size_t i) const { return data()[i]; }
 };
 
 /**
@@ -0,0 +1,192 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file chunk_reassembler.h
+/// Declaration of MQTT chunk_reassembler class, which puts back together
+/// the payloads sent by a chunked_publisher.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_chunk_reassembler_h
+#define __mqtt_chunk_reassembler_h
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "mqtt/chunked_publisher.h"
+#include "mqtt/message.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Puts the payloads that were sent by a @ref chunked_publisher back
+ * together, writing them to a sink a chunk at a time.
+ *
+ * Incoming messages are passed to handle(), from a message callback or
+ * consumer loop. The chunks of each stream are written to the sink in
+ * order, as soon as they can be, so a payload is never held in memory as
+ * a whole. A chunk that arrives early is held until the ones before it
+ * get here, up to a limit for each stream, past which the stream is
+ * abandoned. Duplicates, such as QoS 1 redeliveries, are dropped.
+ * @par
+ * Any number of streams can be put together at once, each keyed by its
+ * stream ID. The handlers are called with the object locked, so they must
+ * not call back into it.
+ */
+class chunk_reassembler
+{
+public:
+    /**
+     * The sink for the data of a stream.
+     * This is called with each chunk, in order, and the offset of the
+     * chunk's data in the payload.
+     */
+    using sink_type =
+        std::function<void(const string& streamId, std::size_t offset, const binary_ref& data)>;
+    /**
+     * Handler for the progress of a stream.
+     * This is called with the number of bytes written so far, each time
+     * some are.
+     */
+    using progress_handler = std::function<void(const string& streamId, std::size_t nBytes)>;
+    /**
+     * Handler for the end of a stream.
+     * This is called with the number of bytes written, and @em true if the
+     * whole payload made it, or @em false if the stream was abandoned, or
+     * didn't add up to the size that the publisher said it would.
+     */
+    using complete_handler =
+        std::function<void(const string& streamId, std::size_t nBytes, bool ok)>;
+
+    /** The default number of early chunks held for a stream */
+    static constexpr std::size_t DFLT_MAX_PENDING = 16;
+    /** The number of finished streams that are remembered */
+    static constexpr std::size_t MAX_FINISHED = 64;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** A stream that's being put together */
+    struct stream
+    {
+        /** The number of the next chunk to write */
+        uint64_t nextSeq{0};
+        /** The number of bytes written */
+        std::size_t nBytes{0};
+        /** The chunks that arrived early, by number */
+        std::map<uint64_t, const_message_ptr> pending;
+        /** Whether the last chunk has arrived */
+        bool haveLast{false};
+        /** The number of the last chunk */
+        uint64_t lastSeq{0};
+        /** The size of the payload, from the last chunk */
+        std::size_t size{0};
+    };
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** The streams being put together, by ID */
+    std::unordered_map<string, stream> streams_;
+    /** The IDs of the streams that recently finished, to drop stragglers */
+    std::deque<string> finished_;
+    /** The most early chunks held for a stream */
+    std::size_t maxPending_;
+    /** The sink for the data */
+    sink_type sink_;
+    /** The handler for the progress of a stream */
+    progress_handler progressHandler_;
+    /** The handler for the end of a stream */
+    complete_handler completeHandler_;
+
+    /** Writes a chunk to the sink */
+    void write(const string& id, stream& st, const message& msg);
+    /** Ends a stream. The lock must be held. */
+    void finish(const string& id, bool ok);
+    /** Determines if a stream recently finished. The lock must be held */
+    bool is_finished(const string& id) const;
+
+public:
+    /**
+     * Creates a reassembler.
+     * @param sink The sink for the data.
+     * @param maxPending The most chunks that are held for a stream while
+     *  				 waiting for an earlier one.
+     */
+    explicit chunk_reassembler(sink_type sink, std::size_t maxPending = DFLT_MAX_PENDING);
+
+    chunk_reassembler(const chunk_reassembler&) = delete;
+    chunk_reassembler& operator=(const chunk_reassembler&) = delete;
+
+    /**
+     * Sets a handler for the progress of each stream.
+     * @param cb The handler.
+     */
+    void set_progress_handler(progress_handler cb) {
+        guard g{lock_};
+        progressHandler_ = std::move(cb);
+    }
+    /**
+     * Sets a handler for the end of each stream.
+     * @param cb The handler.
+     */
+    void set_complete_handler(complete_handler cb) {
+        guard g{lock_};
+        completeHandler_ = std::move(cb);
+    }
+    /**
+     * Determines if a message is a chunk of a stream.
+     * @param msg The message.
+     * @return @em true if the message has the properties of a chunk.
+     */
+    static bool is_chunk(const message& msg);
+    /**
+     * Handles an incoming message.
+     * @param msg The message.
+     * @return @em true if the message was a chunk, and was taken, @em false
+     *  	   if it's something else.
+     */
+    bool handle(const const_message_ptr& msg);
+    /**
+     * Gets the number of streams that are being put together.
+     * @return The number of unfinished streams.
+     */
+    std::size_t num_streams() const {
+        guard g{lock_};
+        return streams_.size();
+    }
+    /**
+     * Abandons a stream, such as one that has stalled.
+     * The complete handler is called for it, as failed.
+     * @param streamId The ID of the stream.
+     * @return @em true if the stream was being put together.
+     */
+    bool abandon(const string& streamId);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_chunk_reassembler_h
@@ -0,0 +1,179 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file chunked_publisher.h
+/// Declaration of MQTT chunked_publisher class, which streams a large
+/// payload as a sequence of MQTT v5 messages.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_chunked_publisher_h
+#define __mqtt_chunked_publisher_h
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+
+#include "mqtt/iasync_client.h"
+#include "mqtt/message.h"
+#include "mqtt/properties.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Publishes a payload that's too large to hold in memory as a stream of
+ * MQTT v5 messages, or chunks.
+ *
+ * The payload is read from a source, an input stream or a callback, a
+ * chunk at a time, and each chunk is published to the same topic with a
+ * few user properties that identify it:
+ *
+ * @li @ref STREAM_PROPERTY, an ID for the stream, shared by its chunks.
+ * @li @ref SEQ_PROPERTY, the number of the chunk in the stream, from 0.
+ * @li @ref SIZE_PROPERTY, the size of the whole payload, only on the
+ *  	last chunk.
+ *
+ * The receiver puts the payload back together with a
+ * @ref chunk_reassembler.
+ * @par
+ * Only a few of the chunks are in flight at once. When the window is
+ * full, the publisher waits for the oldest one to be acknowledged before
+ * reading the next. So memory use is bounded by the chunk size times the
+ * window, however large the payload, and it's the calling thread that
+ * waits, not the client's.
+ * @par
+ * The user properties need an MQTT v5 connection.
+ */
+class chunked_publisher
+{
+public:
+    /**
+     * A source of payload data.
+     * This fills a buffer with up to @em n bytes, and returns the number
+     * of bytes written to it, or zero at the end of the data.
+     */
+    using source_type = std::function<std::size_t(char* buf, std::size_t n)>;
+    /**
+     * Handler for the progress of a stream.
+     * This is called with the number of bytes that have been acknowledged
+     * so far, each time a chunk is.
+     */
+    using progress_handler = std::function<void(std::size_t nBytes)>;
+
+    /** The user property with the ID of the stream */
+    static constexpr const char* STREAM_PROPERTY = "stream-id";
+    /** The user property with the number of the chunk in the stream */
+    static constexpr const char* SEQ_PROPERTY = "stream-seq";
+    /** The user property with the size of the payload, on the last chunk */
+    static constexpr const char* SIZE_PROPERTY = "stream-size";
+
+    /** The default size of a chunk */
+    static constexpr std::size_t DFLT_CHUNK_SIZE = 256 * 1024;
+    /** The default number of chunks in flight */
+    static constexpr std::size_t DFLT_MAX_IN_FLIGHT = 4;
+    /** The default QoS for the chunks */
+    static constexpr int DFLT_QOS = 1;
+
+private:
+    /** The client that carries the chunks */
+    iasync_client& cli_;
+    /** The topic for the chunks */
+    string topic_;
+    /** The size of a chunk */
+    std::size_t chunkSize_;
+    /** The most chunks in flight */
+    std::size_t maxInFlight_;
+    /** The QoS for the chunks */
+    int qos_;
+    /** The handler for the progress of a stream */
+    progress_handler progressHandler_;
+
+    /** Creates a new stream ID */
+    static string make_stream_id();
+    /** Makes the message for a chunk */
+    const_message_ptr make_chunk(
+        const string& streamId, uint64_t seq, binary&& data, bool last, std::size_t nBytes
+    ) const;
+
+public:
+    /**
+     * Creates a publisher for a topic.
+     * @param cli The client that carries the chunks.
+     * @param topic The topic for the chunks.
+     * @param chunkSize The most bytes in a chunk.
+     * @param maxInFlight The most chunks in flight at once.
+     * @param qos The QoS for the chunks.
+     */
+    chunked_publisher(
+        iasync_client& cli, const string& topic, std::size_t chunkSize = DFLT_CHUNK_SIZE,
+        std::size_t maxInFlight = DFLT_MAX_IN_FLIGHT, int qos = DFLT_QOS
+    );
+
+    chunked_publisher(const chunked_publisher&) = delete;
+    chunked_publisher& operator=(const chunked_publisher&) = delete;
+
+    /**
+     * Gets the topic for the chunks.
+     * @return The topic for the chunks.
+     */
+    const string& get_topic() const { return topic_; }
+    /**
+     * Gets the most bytes in a chunk.
+     * @return The most bytes in a chunk.
+     */
+    std::size_t get_chunk_size() const { return chunkSize_; }
+    /**
+     * Gets the most chunks in flight at once.
+     * @return The most chunks in flight at once.
+     */
+    std::size_t get_max_in_flight() const { return maxInFlight_; }
+    /**
+     * Sets a handler for the progress of each stream.
+     * This is called from the publishing thread.
+     * @param cb The handler.
+     */
+    void set_progress_handler(progress_handler cb) { progressHandler_ = std::move(cb); }
+    /**
+     * Publishes the data from a source as a stream of chunks.
+     * This blocks until the last chunk is acknowledged.
+     * @param src The source of the data.
+     * @param streamId The ID for the stream. If it's empty, a random one
+     *  			   is made up.
+     * @return The number of bytes published.
+     * @throw exception if a chunk can't be published.
+     */
+    std::size_t publish(const source_type& src, const string& streamId = string());
+    /**
+     * Publishes the data from an input stream as a stream of chunks.
+     * This blocks until the last chunk is acknowledged.
+     * @param is The input stream.
+     * @param streamId The ID for the stream. If it's empty, a random one
+     *  			   is made up.
+     * @return The number of bytes published.
+     * @throw exception if a chunk can't be published.
+     */
+    std::size_t publish(std::istream& is, const string& streamId = string());
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_chunked_publisher_h
@@ -24,7 +24,12 @@
 #ifndef __mqtt_client_h
 #define __mqtt_client_h
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
+#include <mutex>
+#include <thread>
 
 #include "mqtt/async_client.h"
 
@@ -50,6 +55,50 @@ class client : private callback
     /** Callback supplied by the user (if any) */
     callback* userCallback_;
 
+    /** Lock for the callback thread */
+    std::mutex cbLock_;
+    /** Signaled when a user callback is submitted or completes */
+    std::condition_variable cbCond_;
+    /** The user callback waiting to be run, if any */
+    std::function<void()> cbTask_;
+    /** Whether a user callback was submitted and has not yet completed */
+    bool cbBusy_{false};
+    /** Whether the callback thread should exit */
+    bool cbStop_{false};
+    /** The thread that runs the user callbacks, started when first needed */
+    std::thread cbThr_;
+
+    /** Lock for the publish window */
+    mutable std::mutex winLock_;
+    /** The most publishes to keep in flight, or zero to wait for each one */
+    size_t pubWindow_{0};
+    /** The publishes in flight, oldest first */
+    std::deque<delivery_token_ptr> inFlight_;
+
+    /**
+     * Retires the completed publishes from the front of the window,
+     * waiting for the oldest ones while more than @a n are in flight.
+     * A publish stays in the window until it completes, so one that
+     * timed out is waited for again by the next call.
+     * This must be called with the window lock held.
+     * @throw exception for the first publish that failed.
+     * @throw timeout_error if a publish took too long to complete.
+     */
+    void drain_window(size_t n);
+
+    /**
+     * Runs a user callback on the callback thread, and waits for it to
+     * complete.
+     * If another callback is still running, such as when a user callback
+     * is itself waiting on the library, this falls back to a temporary
+     * thread so that neither one blocks the other.
+     */
+    void run_callback(std::function<void()> f);
+    /** The function run by the callback thread */
+    void callback_thread();
+    /** Applies the thread options to a thread that runs user callbacks */
+    void apply_thread_options() const;
+
     /**
      * Creates a shared pointer to an existing non-heap object.
      * The shared pointer is given a no-op deleter, so it will not try to
@@ -66,21 +115,19 @@ class client : private callback
     }
 
     // User callbacks
-    // Most are launched in a separate thread, for convenience, except
+    // Most are run on a separate thread, for convenience, except
     // message_arrived, for performance.
     void connected(const string& cause) override {
-        std::async(std::launch::async, &callback::connected, userCallback_, cause).wait();
+        run_callback([this, &cause] { userCallback_->connected(cause); });
     }
     void connection_lost(const string& cause) override {
-        std::async(std::launch::async, &callback::connection_lost, userCallback_, cause)
-            .wait();
+        run_callback([this, &cause] { userCallback_->connection_lost(cause); });
     }
     void message_arrived(const_message_ptr msg) override {
         userCallback_->message_arrived(msg);
     }
     void delivery_complete(delivery_token_ptr tok) override {
-        std::async(std::launch::async, &callback::delivery_complete, userCallback_, tok)
-            .wait();
+        run_callback([this, &tok] { userCallback_->delivery_complete(tok); });
     }
 
     /** Non-copyable */
@@ -175,9 +222,10 @@ public:
         iclient_persistence* persistence = nullptr
     );
     /**
-     * Virtual destructor
+     * Virtual destructor.
+     * This stops the callback thread, if it was started.
      */
-    virtual ~client() {}
+    virtual ~client();
     /**
      * Connects to an MQTT server using the default options.
      */
@@ -265,6 +313,7 @@ public:
     /**
      * Publishes a message to a topic on the server and return once it is
      * delivered.
+     * With a publish window, this returns once the message is in flight.
      * @param top The topic to publish
      * @param payload The data to publish
      * @param n The size in bytes of the data
@@ -274,36 +323,80 @@ public:
     virtual void publish(
         string_ref top, const void* payload, size_t n, int qos, bool retained
     ) {
-        if (!cli_.publish(std::move(top), payload, n, qos, retained)->wait_for(timeout_))
-            throw timeout_error();
+        publish(message::create(std::move(top), payload, n, qos, retained));
     }
     /**
      * Publishes a message to a topic on the server and return once it is
      * delivered.
+     * With a publish window, this returns once the message is in flight.
      * @param top The topic to publish
      * @param payload The data to publish
      * @param n The size in bytes of the data
      */
     virtual void publish(string_ref top, const void* payload, size_t n) {
-        if (!cli_.publish(std::move(top), payload, n)->wait_for(timeout_))
-            throw timeout_error();
+        publish(message::create(std::move(top), payload, n));
     }
     /**
      * Publishes a message to a topic on the server.
+     * With a publish window, this returns once the message is in flight,
+     * waiting first for the oldest one if the window is full.
      * @param msg The message
+     * @throw exception if this message, or an earlier one in the window,
+     *  	  failed.
      */
-    virtual void publish(const_message_ptr msg) {
-        if (!cli_.publish(msg)->wait_for(timeout_))
-            throw timeout_error();
-    }
+    virtual void publish(const_message_ptr msg);
     /**
      * Publishes a message to a topic on the server.
      * This version will not timeout since that could leave the library with
      * a reference to memory that could disappear while the library is still
-     * using it.
+     * using it. With a publish window, the message is copied, so that it
+     * can stay in flight after this returns.
      * @param msg The message
      */
-    virtual void publish(const message& msg) { cli_.publish(ptr(msg))->wait(); }
+    virtual void publish(const message& msg);
+    /**
+     * Sets how many publishes can be in flight at once.
+     *
+     * By default, each publish waits for the message to be delivered, so
+     * the rate is limited to one round trip to the server per message.
+     * With a window, a publish returns once the message is handed to the
+     * library, and only blocks when the window is full, to wait for the
+     * oldest message to complete. An error for a message is thrown from a
+     * later publish, or from flush().
+     * @par
+     * Shrinking the window waits for enough of the messages in flight to
+     * complete.
+     *
+     * @param n The most publishes to keep in flight. Zero turns off the
+     *  		window, waiting for each publish to complete.
+     * @throw exception if a message in flight failed.
+     */
+    void set_publish_window(size_t n);
+    /**
+     * Gets how many publishes can be in flight at once.
+     * @return The most publishes to keep in flight, or zero if each publish
+     *  	   waits to complete.
+     */
+    size_t get_publish_window() const {
+        std::lock_guard<std::mutex> g{winLock_};
+        return pubWindow_;
+    }
+    /**
+     * Gets the number of publishes in the window that have not yet been
+     * retired.
+     * @return The number of publishes in flight.
+     */
+    size_t num_in_flight() const {
+        std::lock_guard<std::mutex> g{winLock_};
+        return inFlight_.size();
+    }
+    /**
+     * Waits for all of the publishes in flight to complete.
+     * @throw exception for the first message in flight that failed. The
+     *  	  ones after it are still in flight.
+     * @throw timeout_error if a publish took too long to complete.
+     */
+    void flush();
     /**
      * Sets the callback listener to use for events that happen
      * asynchronously.
@@ -446,6 +539,10 @@ maked      * @param props The MQTT v5 properties.
     ) {
         return cli_.try_consume_message_until(msg, absTime);
     }
+
+#if defined(UNIT_TESTS)
+    async_client& test_async_client() { return cli_; }
+#endif
 };
 
 /** Smart/shared pointer to an MQTT synchronous client object */
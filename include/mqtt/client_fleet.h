@@ -0,0 +1,316 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file client_fleet.h
+/// Declaration of MQTT client_fleet class, which runs a large number of
+/// clients in a process.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_client_fleet_h
+#define __mqtt_client_fleet_h
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mqtt/async_client.h"
+#include "mqtt/connect_options.h"
+#include "mqtt/create_options.h"
+#include "mqtt/event.h"
+#include "mqtt/iaction_listener.h"
+#include "mqtt/rate_limiter.h"
+#include "mqtt/thread_queue.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A large number of clients that are run together, like the logical
+ * clients of a device simulator or a gateway.
+ *
+ * The clients are all created from one set of create options and connect
+ * with one set of connect options, which are kept once by the fleet. They
+ * share one set of handlers and one consumer queue, which are told which
+ * client each event came from, rather than each client having its own.
+ * Each client's own table of pending tokens is kept to a single part
+ * (unless the create options ask for more), which is what most of an idle
+ * client's memory would otherwise go to.
+ * @par
+ * The connects are paced by a rate limiter, so that a ramp-up of
+ * thousands of clients is spread out at a predictable rate, rather than
+ * slamming the server all at once.
+ * @code
+ * auto createOpts = mqtt::create_options_builder()
+ *                       .server_uri("mqtt://localhost:1883")
+ *                       .finalize();
+ * mqtt::client_fleet fleet{createOpts, connOpts, 500.0};
+ * fleet.set_message_handler([](size_t i, mqtt::const_message_ptr msg) {
+ *     ...
+ * });
+ *
+ * for (int i = 0; i < 10000; ++i)
+ *     fleet.add("sim-" + std::to_string(i));
+ *
+ * fleet.connect_all();
+ * @endcode
+ * @par
+ * The handlers must be set, and consuming started, before the clients
+ * are connected.
+ * @par
+ * Unlike an @ref async_client_pool, which spreads the publishes of one
+ * app over a few connections, each client in a fleet is a separate
+ * identity to the server.
+ */
+class client_fleet
+{
+public:
+    /** Handler type for a message that arrived for one of the clients */
+    using message_handler = std::function<void(size_t idx, const_message_ptr msg)>;
+    /** Handler type for when one of the clients connects or is disconnected */
+    using connection_handler = std::function<void(size_t idx, const string& cause)>;
+
+    /** An event from one of the clients */
+    struct client_event
+    {
+        /** The index of the client. This is @ref npos on shutdown. */
+        size_t client;
+        /** The event */
+        event evt;
+    };
+
+    /** The queue type for the events of all the clients */
+    using queue_type = thread_queue<client_event>;
+
+    /** The index for "no client" */
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+    /** The default maximum number of connects per second */
+    static constexpr double DFLT_CONNECT_RATE = 100.0;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Counts the connects that failed after they were sent */
+    class connect_listener : public iaction_listener
+    {
+        std::atomic<size_t>& nFailed_;
+
+        void on_failure(const token&) override { ++nFailed_; }
+        void on_success(const token&) override {}
+
+    public:
+        explicit connect_listener(std::atomic<size_t>& nFailed) : nFailed_{nFailed} {}
+    };
+
+    /** The template for the create options of the clients */
+    create_options createOpts_;
+    /** The options the clients connect with */
+    connect_options connOpts_;
+    /** The handler for incoming messages (if any) */
+    message_handler msgHandler_;
+    /** The handler for a connection (if any) */
+    connection_handler connHandler_;
+    /** The handler for a lost connection (if any) */
+    connection_handler connLostHandler_;
+    /** Whether events are put in the queue */
+    std::atomic<bool> consuming_{false};
+    /** The queue of events from all the clients */
+    queue_type que_;
+    /** The number of connects that failed */
+    std::atomic<size_t> nConnectFailed_{0};
+    /** The listener for the connect tokens */
+    connect_listener connListener_{nConnectFailed_};
+    /** Paces the connects */
+    rate_limiter limiter_;
+    /** Lock for the clients */
+    mutable std::mutex lock_;
+    /**
+     * The clients, by index.
+     * These are last, so they're destroyed before everything above, which
+     * their callbacks use.
+     */
+    std::vector<std::unique_ptr<async_client>> clis_;
+
+    /** Called by each client when it connects */
+    void on_connected(size_t idx, const string& cause);
+    /** Called by each client when its connection is lost */
+    void on_connection_lost(size_t idx, const string& cause);
+    /** Called by each client when a message arrives */
+    void on_message(size_t idx, const_message_ptr msg);
+    /** Connects a client, from the limiter's thread */
+    void do_connect(size_t idx);
+
+public:
+    /**
+     * Creates a fleet of clients.
+     * @param createOpts The template for the options that the clients are
+     *  				 created with, including the server URI. Each
+     *  				 client gets its own ID.
+     * @param connOpts The options that the clients connect with.
+     * @param connectRate The maximum number of connects per second.
+     */
+    client_fleet(
+        const create_options& createOpts, const connect_options& connOpts,
+        double connectRate = DFLT_CONNECT_RATE
+    );
+    /**
+     * Destroys the fleet, dropping any connects that are still waiting,
+     * and destroying the clients.
+     */
+    ~client_fleet();
+
+    client_fleet(const client_fleet&) = delete;
+    client_fleet& operator=(const client_fleet&) = delete;
+
+    /**
+     * Sets the handler for the messages that arrive for any of the
+     * clients.
+     * @param cb The handler, called with the index of the client.
+     */
+    void set_message_handler(message_handler cb) { msgHandler_ = std::move(cb); }
+    /**
+     * Sets the handler for when any of the clients connect.
+     * @param cb The handler, called with the index of the client.
+     */
+    void set_connected_handler(connection_handler cb) { connHandler_ = std::move(cb); }
+    /**
+     * Sets the handler for when any of the clients lose their connection.
+     * @param cb The handler, called with the index of the client.
+     */
+    void set_connection_lost_handler(connection_handler cb) {
+        connLostHandler_ = std::move(cb);
+    }
+    /**
+     * Starts putting the events of all the clients into the fleet's
+     * consumer queue.
+     */
+    void start_consuming() { consuming_ = true; }
+    /**
+     * Stops putting events into the consumer queue, and closes it, which
+     * releases any consumers waiting on it.
+     */
+    void stop_consuming();
+    /**
+     * Adds a client to the fleet.
+     * @param clientId The ID of the client.
+     * @return The index of the client in the fleet.
+     */
+    size_t add(const string& clientId);
+    /**
+     * Gets the number of clients in the fleet.
+     * @return The number of clients in the fleet.
+     */
+    size_t size() const;
+    /**
+     * Gets one of the clients.
+     * @param idx The index of the client.
+     * @return A reference to the client.
+     * @throw std::out_of_range if the index is not valid.
+     */
+    async_client& get_client(size_t idx);
+    /**
+     * Gets one of the clients.
+     * @param idx The index of the client.
+     * @return A reference to the client.
+     * @throw std::out_of_range if the index is not valid.
+     */
+    const async_client& get_client(size_t idx) const;
+    /**
+     * Queues a client to connect, when the rate limit allows.
+     * @param idx The index of the client.
+     * @throw std::out_of_range if the index is not valid.
+     */
+    void connect(size_t idx);
+    /**
+     * Queues all the clients that aren't connected to connect, in order,
+     * when the rate limit allows.
+     */
+    void connect_all();
+    /**
+     * Gets the number of connects still waiting for their turn.
+     * @return The number of connects still waiting for their turn.
+     */
+    size_t num_pending_connects() const { return limiter_.queue_size(); }
+    /**
+     * Gets the number of connects that failed.
+     * @return The number of connects that failed.
+     */
+    size_t num_connect_failures() const { return nConnectFailed_.load(); }
+    /**
+     * Gets the number of clients that are connected.
+     * This checks each of the clients.
+     * @return The number of clients that are connected.
+     */
+    size_t num_connected() const;
+    /**
+     * Disconnects all the connected clients, and waits for them to finish.
+     * @param timeout The longest time to wait.
+     * @return @em true if all the disconnects finished in time.
+     */
+    bool disconnect_all(std::chrono::milliseconds timeout = std::chrono::seconds(30));
+    /**
+     * Reads the next event from any of the clients, waiting for one if
+     * needed.
+     * @return The event. After the queue is closed, this is a shutdown
+     *  	   event, with a client index of @ref npos.
+     */
+    client_event consume_event();
+    /**
+     * Reads the next event from any of the clients, if there is one.
+     * @param evt Pointer to receive the event.
+     * @return @em true if there was an event, @em false if not.
+     */
+    bool try_consume_event(client_event* evt) { return que_.try_get(evt); }
+    /**
+     * Waits a limited time for an event from any of the clients.
+     * @param evt Pointer to receive the event.
+     * @param relTime The longest time to wait.
+     * @return @em true if there was an event, @em false on a timeout.
+     */
+    template <typename Rep, class Period>
+    bool try_consume_event_for(
+        client_event* evt, const std::chrono::duration<Rep, Period>& relTime
+    ) {
+        return que_.try_get_for(evt, relTime);
+    }
+    /**
+     * Reads up to a number of events, from any of the clients, without
+     * waiting, all under a single lock of the queue.
+     * @param evts The vector to receive the events, at the end.
+     * @param maxN The most events to read.
+     * @return The number of events read.
+     */
+    size_t try_consume_events(std::vector<client_event>& evts, size_t maxN) {
+        return que_.try_get_n(&evts, maxN);
+    }
+    /**
+     * Gets the number of events waiting in the consumer queue.
+     * @return The number of events waiting in the consumer queue.
+     */
+    size_t consumer_queue_size() const { return que_.size(); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_client_fleet_h
@@ -0,0 +1,478 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file client_metrics.h
+/// Declaration of MQTT client_metrics class, the counters and gauges that
+/// describe the activity of an async_client.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_client_metrics_h
+#define __mqtt_client_metrics_h
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A histogram of latencies, with buckets that double in size.
+ *
+ * Bucket @em i counts the latencies up to 2^i microseconds that didn't
+ * fit in the bucket before it, and the last bucket counts everything
+ * else. That covers from a microsecond to a few seconds with fixed
+ * memory, and the buckets map directly onto the cumulative buckets of a
+ * Prometheus-style histogram.
+ * @par
+ * Recording a value is lock-free. A copy takes a snapshot, which may be
+ * slightly out of step with values that are recorded during the copy.
+ */
+class latency_histogram
+{
+public:
+    /** The type for the latencies */
+    using duration = std::chrono::nanoseconds;
+
+    /** The number of buckets, the last of which has no upper bound */
+    static constexpr size_t N_BUCKETS = 24;
+
+private:
+    /** The number of values in each bucket */
+    std::atomic<uint64_t> counts_[N_BUCKETS];
+    /** The sum of all the values, in nanoseconds */
+    std::atomic<uint64_t> sum_{0};
+
+    /** Copies the values from another histogram */
+    void copy(const latency_histogram& other) {
+        for (size_t i = 0; i < N_BUCKETS; ++i)
+            counts_[i].store(other.counts_[i].load(std::memory_order_relaxed));
+        sum_.store(other.sum_.load(std::memory_order_relaxed));
+    }
+
+public:
+    /**
+     * Creates an empty histogram.
+     */
+    latency_histogram() {
+        for (auto& n : counts_) n.store(0);
+    }
+    /**
+     * Creates a snapshot of another histogram.
+     * @param other The histogram to copy.
+     */
+    latency_histogram(const latency_histogram& other) { copy(other); }
+    /**
+     * Copies a snapshot of another histogram.
+     * @param rhs The histogram to copy.
+     * @return A reference to this object.
+     */
+    latency_histogram& operator=(const latency_histogram& rhs) {
+        if (&rhs != this)
+            copy(rhs);
+        return *this;
+    }
+    /**
+     * Adds the values of another histogram to this one.
+     * @param rhs The histogram to add.
+     * @return A reference to this object.
+     */
+    latency_histogram& operator+=(const latency_histogram& rhs) {
+        for (size_t i = 0; i < N_BUCKETS; ++i)
+            counts_[i].fetch_add(rhs.bucket_count(i), std::memory_order_relaxed);
+        sum_.fetch_add(rhs.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+    /**
+     * Gets the upper bound of a bucket.
+     * @param i The index of the bucket.
+     * @return The largest latency counted by the bucket, or the maximum
+     *  	   duration for the last one.
+     */
+    static duration upper_bound(size_t i) {
+        if (i >= N_BUCKETS - 1)
+            return duration::max();
+        return std::chrono::microseconds(uint64_t(1) << i);
+    }
+    /**
+     * Records a latency.
+     * @param d The latency.
+     */
+    void record(duration d) {
+        auto ns = (d.count() > 0) ? uint64_t(d.count()) : uint64_t(0);
+        auto us = (ns + 999) / 1000;
+
+        size_t i = 0;
+        while (i < N_BUCKETS - 1 && (uint64_t(1) << i) < us) ++i;
+
+        counts_[i].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+    }
+    /**
+     * Gets the number of latencies in a bucket.
+     * @param i The index of the bucket.
+     * @return The number of latencies in the bucket.
+     */
+    uint64_t bucket_count(size_t i) const {
+        return counts_[i].load(std::memory_order_relaxed);
+    }
+    /**
+     * Gets the total number of latencies that were recorded.
+     * @return The total number of latencies.
+     */
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (const auto& c : counts_) n += c.load(std::memory_order_relaxed);
+        return n;
+    }
+    /**
+     * Gets the sum of all the latencies that were recorded.
+     * @return The sum of all the latencies.
+     */
+    duration sum() const { return duration(sum_.load(std::memory_order_relaxed)); }
+    /**
+     * Gets an estimate of a quantile of the latencies.
+     * @param q The quantile, from 0.0 to 1.0, like 0.99 for the 99th
+     *  		percentile.
+     * @return The upper bound of the bucket that holds the quantile, or
+     *  	   zero if nothing was recorded.
+     */
+    duration quantile(double q) const {
+        latency_histogram snap{*this};
+        auto total = snap.count();
+        if (total == 0)
+            return duration::zero();
+
+        auto target = uint64_t(q * double(total));
+        uint64_t n = 0;
+        for (size_t i = 0; i < N_BUCKETS; ++i) {
+            n += snap.counts_[i].load(std::memory_order_relaxed);
+            if (n > target || n == total)
+                return upper_bound(i);
+        }
+        return duration::max();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The counters and gauges that describe the activity of an async_client.
+ *
+ * The client updates the counters from its hot paths with relaxed atomic
+ * operations, so they cost next to nothing to keep. Get a copy with
+ * `async_client::get_metrics()`, which also samples the gauges: the
+ * numbers of pending tokens and the depth of the consumer queue. The
+ * counters only ever increase, so an exporter can report them directly,
+ * and take rates from the differences between snapshots.
+ * @par
+ * The ack latency is the time from when a QoS 1 or 2 message is handed
+ * to the library, until the server acknowledges it.
+ */
+class client_metrics
+{
+public:
+    /** The number of QoS levels */
+    static constexpr int N_QOS = 3;
+
+private:
+    /** The numbers of messages sent, by QoS */
+    std::atomic<uint64_t> msgsOut_[N_QOS];
+    /** The numbers of payload bytes sent, by QoS */
+    std::atomic<uint64_t> bytesOut_[N_QOS];
+    /** The numbers of messages received, by QoS */
+    std::atomic<uint64_t> msgsIn_[N_QOS];
+    /** The numbers of payload bytes received, by QoS */
+    std::atomic<uint64_t> bytesIn_[N_QOS];
+    /** The number of times the client connected */
+    std::atomic<uint64_t> nConnects_{0};
+    /** The number of times the connection was lost */
+    std::atomic<uint64_t> nConnLost_{0};
+    /** The number of QoS 1 or 2 publishes that failed */
+    std::atomic<uint64_t> nPubFailures_{0};
+    /** The number of incoming duplicates that were dropped */
+    std::atomic<uint64_t> nDupsDropped_{0};
+    /** The number of incoming messages dropped by the receive filter */
+    std::atomic<uint64_t> nFilteredDropped_{0};
+    /** The number of incoming messages that expired before being read */
+    std::atomic<uint64_t> nExpiredIn_{0};
+    /** The number of buffered publishes that expired before being sent */
+    std::atomic<uint64_t> nExpiredOut_{0};
+    /** The time to acknowledge QoS 1 and 2 publishes */
+    latency_histogram ackLatency_;
+
+    /** The number of pending tokens, sampled for a snapshot */
+    size_t nPendingTokens_{0};
+    /** The number of pending delivery tokens, sampled for a snapshot */
+    size_t nPendingDeliveryTokens_{0};
+    /** The depth of the consumer queue, sampled for a snapshot */
+    size_t queueSize_{0};
+
+    /** The client updates the metrics */
+    friend class async_client;
+
+    /** Increments a counter */
+    static void inc(std::atomic<uint64_t>& cnt, uint64_t n = 1) {
+        cnt.fetch_add(n, std::memory_order_relaxed);
+    }
+    /** Gets the value of a counter */
+    static uint64_t get(const std::atomic<uint64_t>& cnt) {
+        return cnt.load(std::memory_order_relaxed);
+    }
+    /** Gets a QoS as an index, clamped into range */
+    static int qos_index(int qos) { return (qos < 0) ? 0 : ((qos > 2) ? 2 : qos); }
+
+    /** Counts a message that was sent */
+    void on_sent(int qos, size_t n) {
+        inc(msgsOut_[qos_index(qos)]);
+        inc(bytesOut_[qos_index(qos)], n);
+    }
+    /** Counts a message that was received */
+    void on_received(int qos, size_t n) {
+        inc(msgsIn_[qos_index(qos)]);
+        inc(bytesIn_[qos_index(qos)], n);
+    }
+    /** Counts a connection */
+    void on_connected() { inc(nConnects_); }
+    /** Counts a lost connection */
+    void on_connection_lost() { inc(nConnLost_); }
+    /** Records the ack latency of a publish */
+    void on_delivered(latency_histogram::duration d) { ackLatency_.record(d); }
+    /** Counts a publish that failed */
+    void on_publish_failed() { inc(nPubFailures_); }
+    /** Counts an incoming duplicate that was dropped */
+    void on_duplicate_dropped() { inc(nDupsDropped_); }
+    /** Counts an incoming message that the receive filter dropped */
+    void on_filtered_dropped() { inc(nFilteredDropped_); }
+    /** Counts an incoming message that expired in the queue */
+    void on_expired_received() { inc(nExpiredIn_); }
+    /** Counts an outgoing message that expired in the offline buffer */
+    void on_expired_sent() { inc(nExpiredOut_); }
+
+    /** Copies the values from another object */
+    void copy(const client_metrics& other) {
+        for (int i = 0; i < N_QOS; ++i) {
+            msgsOut_[i].store(get(other.msgsOut_[i]));
+            bytesOut_[i].store(get(other.bytesOut_[i]));
+            msgsIn_[i].store(get(other.msgsIn_[i]));
+            bytesIn_[i].store(get(other.bytesIn_[i]));
+        }
+        nConnects_.store(get(other.nConnects_));
+        nConnLost_.store(get(other.nConnLost_));
+        nPubFailures_.store(get(other.nPubFailures_));
+        nDupsDropped_.store(get(other.nDupsDropped_));
+        nFilteredDropped_.store(get(other.nFilteredDropped_));
+        nExpiredIn_.store(get(other.nExpiredIn_));
+        nExpiredOut_.store(get(other.nExpiredOut_));
+        ackLatency_ = other.ackLatency_;
+        nPendingTokens_ = other.nPendingTokens_;
+        nPendingDeliveryTokens_ = other.nPendingDeliveryTokens_;
+        queueSize_ = other.queueSize_;
+    }
+
+public:
+    /**
+     * Creates a set of metrics, with everything zero.
+     */
+    client_metrics() {
+        for (int i = 0; i < N_QOS; ++i) {
+            msgsOut_[i].store(0);
+            bytesOut_[i].store(0);
+            msgsIn_[i].store(0);
+            bytesIn_[i].store(0);
+        }
+    }
+    /**
+     * Creates a snapshot of another set of metrics.
+     * @param other The metrics to copy.
+     */
+    client_metrics(const client_metrics& other) { copy(other); }
+    /**
+     * Copies a snapshot of another set of metrics.
+     * @param rhs The metrics to copy.
+     * @return A reference to this object.
+     */
+    client_metrics& operator=(const client_metrics& rhs) {
+        if (&rhs != this)
+            copy(rhs);
+        return *this;
+    }
+    /**
+     * Adds the values of another set of metrics to this one, to total the
+     * metrics of a number of clients.
+     * @param rhs The metrics to add.
+     * @return A reference to this object.
+     */
+    client_metrics& operator+=(const client_metrics& rhs) {
+        for (int i = 0; i < N_QOS; ++i) {
+            inc(msgsOut_[i], get(rhs.msgsOut_[i]));
+            inc(bytesOut_[i], get(rhs.bytesOut_[i]));
+            inc(msgsIn_[i], get(rhs.msgsIn_[i]));
+            inc(bytesIn_[i], get(rhs.bytesIn_[i]));
+        }
+        inc(nConnects_, get(rhs.nConnects_));
+        inc(nConnLost_, get(rhs.nConnLost_));
+        inc(nPubFailures_, get(rhs.nPubFailures_));
+        inc(nDupsDropped_, get(rhs.nDupsDropped_));
+        inc(nFilteredDropped_, get(rhs.nFilteredDropped_));
+        inc(nExpiredIn_, get(rhs.nExpiredIn_));
+        inc(nExpiredOut_, get(rhs.nExpiredOut_));
+        ackLatency_ += rhs.ackLatency_;
+        nPendingTokens_ += rhs.nPendingTokens_;
+        nPendingDeliveryTokens_ += rhs.nPendingDeliveryTokens_;
+        queueSize_ += rhs.queueSize_;
+        return *this;
+    }
+    /**
+     * Gets the number of messages sent at a QoS.
+     * @param qos The QoS.
+     * @return The number of messages sent at the QoS.
+     */
+    uint64_t messages_sent(int qos) const { return get(msgsOut_[qos_index(qos)]); }
+    /**
+     * Gets the number of messages sent at all QoS levels.
+     * @return The number of messages sent.
+     */
+    uint64_t messages_sent() const {
+        return messages_sent(0) + messages_sent(1) + messages_sent(2);
+    }
+    /**
+     * Gets the number of payload bytes sent at a QoS.
+     * @param qos The QoS.
+     * @return The number of payload bytes sent at the QoS.
+     */
+    uint64_t bytes_sent(int qos) const { return get(bytesOut_[qos_index(qos)]); }
+    /**
+     * Gets the number of payload bytes sent at all QoS levels.
+     * @return The number of payload bytes sent.
+     */
+    uint64_t bytes_sent() const { return bytes_sent(0) + bytes_sent(1) + bytes_sent(2); }
+    /**
+     * Gets the number of messages received at a QoS.
+     * @param qos The QoS.
+     * @return The number of messages received at the QoS.
+     */
+    uint64_t messages_received(int qos) const { return get(msgsIn_[qos_index(qos)]); }
+    /**
+     * Gets the number of messages received at all QoS levels.
+     * @return The number of messages received.
+     */
+    uint64_t messages_received() const {
+        return messages_received(0) + messages_received(1) + messages_received(2);
+    }
+    /**
+     * Gets the number of payload bytes received at a QoS.
+     * @param qos The QoS.
+     * @return The number of payload bytes received at the QoS.
+     */
+    uint64_t bytes_received(int qos) const { return get(bytesIn_[qos_index(qos)]); }
+    /**
+     * Gets the number of payload bytes received at all QoS levels.
+     * @return The number of payload bytes received.
+     */
+    uint64_t bytes_received() const {
+        return bytes_received(0) + bytes_received(1) + bytes_received(2);
+    }
+    /**
+     * Gets the number of times the client connected, including automatic
+     * reconnects.
+     * @return The number of connections.
+     */
+    uint64_t num_connects() const { return get(nConnects_); }
+    /**
+     * Gets the number of times the client connected again, after the first
+     * time.
+     * @return The number of reconnects.
+     */
+    uint64_t num_reconnects() const {
+        auto n = num_connects();
+        return (n > 0) ? n - 1 : 0;
+    }
+    /**
+     * Gets the number of times the connection was lost.
+     * @return The number of lost connections.
+     */
+    uint64_t num_connections_lost() const { return get(nConnLost_); }
+    /**
+     * Gets the number of QoS 1 or 2 publishes that failed after they were
+     * handed to the library.
+     * @return The number of failed publishes.
+     */
+    uint64_t num_publish_failures() const { return get(nPubFailures_); }
+    /**
+     * Gets the number of incoming messages that were dropped as
+     * duplicates, by the client's @ref duplicate_filter.
+     * These are counted as received, too.
+     * @return The number of duplicates dropped.
+     */
+    uint64_t num_duplicates_dropped() const { return get(nDupsDropped_); }
+    /**
+     * Gets the number of incoming messages that were dropped by the
+     * client's @ref receive_filter.
+     * These are counted as received, too.
+     * @return The number of messages filtered out.
+     */
+    uint64_t num_filtered_dropped() const { return get(nFilteredDropped_); }
+    /**
+     * Gets the number of incoming messages that were dropped because
+     * their Message Expiry Interval ran out before the application read
+     * them from the consumer queue.
+     * @return The number of expired incoming messages.
+     */
+    uint64_t num_expired_received() const { return get(nExpiredIn_); }
+    /**
+     * Gets the number of publishes that were dropped because their
+     * Message Expiry Interval ran out while they waited in the client's
+     * offline buffer.
+     * @return The number of expired outgoing messages.
+     */
+    uint64_t num_expired_sent() const { return get(nExpiredOut_); }
+    /**
+     * Gets the histogram of the time for the server to acknowledge QoS 1
+     * and 2 publishes.
+     * @return The histogram of ack latencies.
+     */
+    const latency_histogram& ack_latency() const { return ackLatency_; }
+    /**
+     * Gets the number of tokens for operations that have not completed,
+     * including the delivery tokens.
+     * This is sampled when the snapshot is taken.
+     * @return The number of pending tokens.
+     */
+    size_t num_pending_tokens() const { return nPendingTokens_; }
+    /**
+     * Gets the number of delivery tokens for messages that have not
+     * completed.
+     * This is sampled when the snapshot is taken.
+     * @return The number of pending delivery tokens.
+     */
+    size_t num_pending_delivery_tokens() const { return nPendingDeliveryTokens_; }
+    /**
+     * Gets the number of events in the consumer queue.
+     * This is sampled when the snapshot is taken.
+     * @return The depth of the consumer queue.
+     */
+    size_t consumer_queue_size() const { return queueSize_; }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_client_metrics_h
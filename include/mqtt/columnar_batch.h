@@ -0,0 +1,338 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file columnar_batch.h
+/// Declaration of MQTT columnar_batch and columnar_consumer classes, which
+/// collect consumed messages into columns in the Apache Arrow layout.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_columnar_batch_h
+#define __mqtt_columnar_batch_h
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mqtt/async_client.h"
+#include "mqtt/message.h"
+#include "mqtt/types.h"
+
+// The structs of the Arrow C data interface, which are a stable ABI, and
+// are declared the same way by anything that uses them.
+// See: https://arrow.apache.org/docs/format/CDataInterface.html
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema
+{
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray
+{
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+}  // extern "C"
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A batch of messages, held as columns in the memory layout of an Apache
+ * Arrow record batch, to hand to an analytics pipeline without building
+ * it up one message at a time.
+ *
+ * Each message that's appended is copied once, straight into the
+ * columns:
+ *
+ * @li "topic", dictionary-encoded, as an int32 index into the distinct
+ *     topics of the batch, which are interned as they show up,
+ * @li "payload", as a binary column,
+ * @li "qos", as uint8,
+ * @li "timestamp", the time the message arrived, as nanoseconds since the
+ *     Unix epoch, UTC,
+ * @li one nullable utf8 column for each of the user properties that were
+ *     named when the batch was created, in that order, which is null for
+ *     a message that doesn't have it.
+ *
+ * The batch is handed off with export_to_c(), as an Arrow C data
+ * interface struct array, which the Arrow libraries import without a
+ * copy, like with `arrow::ImportRecordBatch()` in C++ or
+ * `pyarrow.RecordBatch._import_from_c()` in Python. This library doesn't
+ * depend on Arrow itself. The columns can also be read in place, with the
+ * accessors here.
+ */
+class columnar_batch
+{
+public:
+    /** The clock for the timestamps in the batch */
+    using clock = std::chrono::system_clock;
+
+    /** The names of the fixed columns, in order */
+    static constexpr const char* TOPIC_COLUMN = "topic";
+    static constexpr const char* PAYLOAD_COLUMN = "payload";
+    static constexpr const char* QOS_COLUMN = "qos";
+    static constexpr const char* TIMESTAMP_COLUMN = "timestamp";
+
+private:
+    /** A nullable column of strings */
+    struct string_column
+    {
+        std::vector<uint8_t> validity;
+        std::vector<int32_t> offsets{0};
+        std::vector<char> data;
+        int64_t nullCount{0};
+    };
+
+    /** The columns, which are moved out together when the batch is exported */
+    struct columns
+    {
+        std::vector<int32_t> topicIdx;
+        std::vector<int32_t> dictOffsets{0};
+        std::vector<char> dictData;
+        std::vector<int32_t> payloadOffsets{0};
+        std::vector<char> payloadData;
+        std::vector<uint8_t> qos;
+        std::vector<int64_t> timestamp;
+        std::vector<string_column> props;
+    };
+
+    /** The names of the user properties to keep */
+    std::vector<string> propNames_;
+    /** The columns */
+    columns cols_;
+    /** The index of each topic in the dictionary */
+    std::unordered_map<string, int32_t> dict_;
+    /** The wall-clock time and steady time when the batch was started */
+    clock::time_point sysBase_;
+    message::time_point steadyBase_;
+
+    /** Starts the next batch */
+    void reset();
+
+public:
+    /**
+     * Creates an empty batch.
+     * @param propNames The names of the user properties to keep, each of
+     *  				which gets a column.
+     */
+    explicit columnar_batch(std::vector<string> propNames = {});
+    /**
+     * Adds a message to the end of the batch.
+     * @param msg The message.
+     * @throw std::length_error if the batch would go over the 2GB that
+     *  	  the 32-bit offsets of the Arrow binary columns can address.
+     */
+    void append(const message& msg);
+    /**
+     * Removes all the messages, keeping the memory for reuse.
+     */
+    void clear();
+    /**
+     * Gets the number of messages in the batch.
+     * @return The number of messages in the batch.
+     */
+    size_t size() const { return cols_.topicIdx.size(); }
+    /**
+     * Determines if the batch is empty.
+     * @return @em true if there are no messages in the batch.
+     */
+    bool empty() const { return cols_.topicIdx.empty(); }
+    /**
+     * Gets the number of bytes of payload in the batch.
+     * @return The number of payload bytes.
+     */
+    size_t payload_bytes() const { return cols_.payloadData.size(); }
+    /**
+     * Gets the names of the user properties that are kept.
+     * @return The names of the property columns, in order.
+     */
+    const std::vector<string>& property_names() const { return propNames_; }
+    /**
+     * Gets the number of distinct topics in the batch.
+     * @return The size of the topic dictionary.
+     */
+    size_t num_topics() const { return cols_.dictOffsets.size() - 1; }
+    /**
+     * Gets the index of the topic of a message in the topic dictionary.
+     * @param i The index of the message.
+     * @return The index of its topic.
+     */
+    int32_t topic_index(size_t i) const { return cols_.topicIdx[i]; }
+    /**
+     * Gets the topic of a message.
+     * @param i The index of the message.
+     * @return A view of the topic.
+     */
+    std::string_view topic(size_t i) const;
+    /**
+     * Gets the payload of a message.
+     * @param i The index of the message.
+     * @return A view of the payload.
+     */
+    std::string_view payload(size_t i) const;
+    /**
+     * Gets the QoS of a message.
+     * @param i The index of the message.
+     * @return The QoS.
+     */
+    int qos(size_t i) const { return cols_.qos[i]; }
+    /**
+     * Gets the time a message arrived.
+     * @param i The index of the message.
+     * @return The time the message arrived.
+     */
+    clock::time_point timestamp(size_t i) const {
+        return clock::time_point{std::chrono::duration_cast<clock::duration>(
+            std::chrono::nanoseconds{cols_.timestamp[i]}
+        )};
+    }
+    /**
+     * Gets a user property of a message.
+     * @param col The index of the property in the property names.
+     * @param i The index of the message.
+     * @return A view of the property value, if the message has it.
+     */
+    std::optional<std::string_view> property(size_t col, size_t i) const;
+    /**
+     * Moves the batch out as an Arrow C data interface record batch, which
+     * is a struct array with a child array for each column.
+     * The memory of the columns is handed over, and freed when the
+     * consumer releases the array. The batch is left empty.
+     * @param array Gets the array. The consumer must release it.
+     * @param schema Gets the schema of the array, if not null. The
+     *  			 consumer must release it.
+     */
+    void export_to_c(ArrowArray* array, ArrowSchema* schema = nullptr);
+    /**
+     * Gets the schema of the batches, as an Arrow C data interface struct.
+     * @param schema Gets the schema. The consumer must release it.
+     */
+    void export_schema(ArrowSchema* schema) const;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Reads the messages from the consumer queue of a client into columnar
+ * batches.
+ *
+ * Each call to fill() moves messages out of the queue in bulk, and appends
+ * them to a batch, until it reaches a number of messages or bytes of
+ * payload, or a time limit since its first message arrived. The other
+ * events in the queue are skipped.
+ * @code
+ * cli.start_consuming();
+ * mqtt::columnar_consumer cons{cli};
+ * mqtt::columnar_batch batch{{"device-id"}};
+ *
+ * while (cons.fill(batch)) {
+ *     ArrowArray arr;
+ *     ArrowSchema sch;
+ *     batch.export_to_c(&arr, &sch);
+ *     auto rb = arrow::ImportRecordBatch(&arr, &sch).ValueOrDie();
+ *     ...
+ * }
+ * @endcode
+ */
+class columnar_consumer
+{
+public:
+    /** The default most messages in a batch */
+    static constexpr size_t DFLT_MAX_ROWS = 64 * 1024;
+    /** The default most bytes of payload in a batch */
+    static constexpr size_t DFLT_MAX_BYTES = 16 * 1024 * 1024;
+    /** The default longest time to hold a batch for more messages */
+    static constexpr std::chrono::milliseconds DFLT_MAX_AGE{1000};
+
+private:
+    /** The client */
+    async_client& cli_;
+    /** The most messages in a batch */
+    size_t maxRows_;
+    /** The most bytes of payload in a batch */
+    size_t maxBytes_;
+    /** The longest time to hold a batch */
+    std::chrono::milliseconds maxAge_;
+    /** The events read from the queue, kept for its memory */
+    std::vector<event> evts_;
+
+public:
+    /**
+     * Creates a consumer for a client's queue.
+     * The client must have started consuming.
+     * @param cli The client.
+     * @param maxRows The most messages in a batch.
+     * @param maxBytes The most bytes of payload in a batch. A batch is
+     *  			   done as soon as it reaches this, so it can go over.
+     * @param maxAge The longest time to wait for more messages once a
+     *  			 batch has one.
+     */
+    explicit columnar_consumer(
+        async_client& cli, size_t maxRows = DFLT_MAX_ROWS, size_t maxBytes = DFLT_MAX_BYTES,
+        std::chrono::milliseconds maxAge = DFLT_MAX_AGE
+    )
+        : cli_{cli},
+          maxRows_{maxRows ? maxRows : 1},
+          maxBytes_{maxBytes},
+          maxAge_{maxAge} {}
+    /**
+     * Fills a batch with the next messages from the queue, waiting for
+     * the first one.
+     * @param batch The batch, which is cleared first.
+     * @return @em true if the batch has messages, @em false if the
+     *  	   consumer queue was shut down before any arrived.
+     */
+    bool fill(columnar_batch& batch);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_columnar_batch_h
@@ -0,0 +1,562 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file compiled_topic_matcher.h
+/// Declaration of MQTT compiled_topic_matcher class, an immutable topic
+/// matcher built once for a fixed set of filters.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_compiled_topic_matcher_h
+#define __mqtt_compiled_topic_matcher_h
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "mqtt/topic_levels.h"
+#include "mqtt/topic_matcher.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An immutable collection of MQTT topic filters mapped to values, built
+ * once, for routing tables that are fixed at startup.
+ *
+ * This has the same matching rules as @ref topic_matcher, and is normally
+ * made from one with @ref topic_matcher::freeze(), after it has been
+ * filled with the usual insert() calls. It can't be modified afterward.
+ * The whole collection is held in a few contiguous arrays:
+ *
+ * @li The nodes of the trie, in breadth-first order, so that the nodes
+ *     near the root, which are visited by every search, are together.
+ * @li The literal (non-wildcard) children of all the nodes, found by a
+ *     minimal perfect hash of the parent node and the text of the level.
+ *     So finding a child costs a single hash of the level, with no probing,
+ *     and one comparison to reject levels that aren't in the collection.
+ * @li The text of all the levels, in a single string.
+ * @li The values.
+ *
+ * Searching for matches doesn't allocate memory, unless the filters are
+ * nested more than @ref INLINE_DEPTH levels deep.
+ *
+ * @tparam T The type of the values mapped to the filters.
+ */
+template <typename T>
+class compiled_topic_matcher
+{
+public:
+    using key_type = string;
+    using mapped_type = T;
+    using value_type = std::pair<key_type, mapped_type>;
+    using reference = const value_type&;
+    using const_reference = const value_type&;
+
+    /** An iterator over all the items in the collection */
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+    /** All iterators are const */
+    using iterator = const_iterator;
+
+    /** The depth of filters that can be searched without allocating */
+    static constexpr size_t INLINE_DEPTH = 30;
+
+private:
+    /** The type for indexes */
+    using index_type = uint32_t;
+
+    /** Index value for an unused slot */
+    static constexpr index_type NONE = std::numeric_limits<index_type>::max();
+    /** The index of the root node */
+    static constexpr index_type ROOT = 0;
+
+    /** A node in the trie */
+    struct node
+    {
+        /** Index of the value for this node, if any */
+        index_type content{NONE};
+        /** Index of the single-level wildcard child, if any */
+        index_type plus{NONE};
+        /** Index of the multi-level wildcard child, if any */
+        index_type hash{NONE};
+    };
+
+    /** A literal child of a node */
+    struct edge
+    {
+        /** The parent node */
+        index_type parent;
+        /** The child node */
+        index_type child;
+        /** The offset of the level text in the string table */
+        index_type offset;
+        /** The length of the level text */
+        index_type len;
+    };
+
+    /** The nodes. The root is always first. */
+    std::vector<node> nodes_;
+    /** The literal children of the nodes */
+    std::vector<edge> edges_;
+    /** The text of the levels for the edges */
+    string levels_;
+    /** The hash table slots, each holding the index of an edge, or NONE */
+    std::vector<index_type> slots_;
+    /** The displacement for each bucket of the perfect hash */
+    std::vector<index_type> disps_;
+    /** The seed for the hash */
+    uint64_t seed_{0};
+    /** The values */
+    std::vector<value_type> values_;
+    /** The number of levels in the deepest filter */
+    size_t maxDepth_{0};
+
+    /** Hashes the key for an edge */
+    static uint64_t edge_hash(index_type parent, std::string_view level, uint64_t seed) {
+        // FNV-1a over the text, then mixed to spread the bits
+        uint64_t h = 0xCBF29CE484222325ull ^ seed ^ (uint64_t(parent) * 0x9E3779B97F4A7C15ull);
+        for (auto c : level) {
+            h ^= uint8_t(c);
+            h *= 0x100000001B3ull;
+        }
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        return h;
+    }
+    /** Gets the bucket for the hash */
+    size_t bucket(uint64_t h) const { return size_t(h >> 40) & (disps_.size() - 1); }
+    /** Gets the slot for the hash, with the displacement for its bucket */
+    size_t slot(uint64_t h, index_type disp) const {
+        auto step = ((h >> 20) | 1);
+        return size_t(h + disp * step) & (slots_.size() - 1);
+    }
+    /** Gets the text of an edge */
+    std::string_view edge_level(const edge& e) const {
+        return std::string_view{levels_}.substr(e.offset, e.len);
+    }
+    /** Gets the literal child of a node, or NONE */
+    index_type child(index_type parent, std::string_view level) const {
+        if (slots_.empty())
+            return NONE;
+
+        auto h = edge_hash(parent, level, seed_);
+        auto idx = slots_[slot(h, disps_[bucket(h)])];
+        if (idx == NONE)
+            return NONE;
+
+        const auto& e = edges_[idx];
+        return (e.parent == parent && edge_level(e) == level) ? e.child : NONE;
+    }
+    /** Gets the smallest power of two that is not less than n, minimum 1 */
+    static size_t pow2(size_t n) {
+        size_t sz = 1;
+        while (sz < n) sz <<= 1;
+        return sz;
+    }
+
+    /**
+     * Tries to build the perfect hash table for the edges with the current
+     * seed and table size.
+     * @return @em true on success, @em false if a displacement couldn't be
+     *  	   found for some bucket.
+     */
+    bool build_hash() {
+        const auto n = edges_.size();
+        std::vector<uint64_t> hashes(n);
+        std::vector<std::vector<index_type>> buckets(disps_.size());
+
+        for (size_t i = 0; i < n; ++i) {
+            const auto& e = edges_[i];
+            hashes[i] = edge_hash(e.parent, edge_level(e), seed_);
+            buckets[bucket(hashes[i])].push_back(index_type(i));
+        }
+
+        // Place the biggest buckets first, while the table is emptiest
+        std::vector<index_type> order(buckets.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = index_type(i);
+        std::stable_sort(order.begin(), order.end(), [&buckets](index_type a, index_type b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        std::fill(slots_.begin(), slots_.end(), NONE);
+        const index_type MAX_DISP = index_type(4 * slots_.size());
+        std::vector<size_t> placed;
+
+        for (auto b : order) {
+            const auto& bkt = buckets[b];
+            if (bkt.empty())
+                break;
+
+            index_type disp = 0;
+            for (; disp < MAX_DISP; ++disp) {
+                placed.clear();
+                bool ok = true;
+                for (auto i : bkt) {
+                    auto s = slot(hashes[i], disp);
+                    if (slots_[s] != NONE ||
+                        std::find(placed.begin(), placed.end(), s) != placed.end()) {
+                        ok = false;
+                        break;
+                    }
+                    placed.push_back(s);
+                }
+                if (ok)
+                    break;
+            }
+
+            if (disp == MAX_DISP)
+                return false;
+
+            disps_[b] = disp;
+            for (size_t j = 0; j < bkt.size(); ++j) slots_[placed[j]] = bkt[j];
+        }
+        return true;
+    }
+
+    /**
+     * Builds the collection from the values.
+     */
+    void build() {
+        // A temporary trie, with the children of each node by level text.
+        // The text refers to the keys of the values, which stay put.
+        struct tmp_node
+        {
+            index_type content{NONE};
+            std::map<std::string_view, index_type> children;
+        };
+        std::vector<tmp_node> tmp(1);
+
+        for (size_t i = 0; i < values_.size(); ++i) {
+            const auto& key = values_[i].first;
+            topic_levels fields{key};
+            maxDepth_ = std::max(maxDepth_, fields.size());
+
+            index_type nd = ROOT;
+            for (size_t j = 0; j < fields.size(); ++j) {
+                auto fld = fields.level(key, j);
+                auto it = tmp[nd].children.find(fld);
+                if (it == tmp[nd].children.end()) {
+                    it = tmp[nd].children.emplace(fld, index_type(tmp.size())).first;
+                    tmp.emplace_back();
+                }
+                nd = it->second;
+            }
+            tmp[nd].content = index_type(i);
+        }
+
+        // Lay out the nodes breadth-first. The queue holds the temporary
+        // index of each final node.
+        std::vector<index_type> order{ROOT};
+        nodes_.resize(tmp.size());
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            const auto& tnd = tmp[order[i]];
+            nodes_[i].content = tnd.content;
+
+            for (const auto& child : tnd.children) {
+                auto idx = index_type(order.size());
+                order.push_back(child.second);
+
+                if (child.first == "+")
+                    nodes_[i].plus = idx;
+                else if (child.first == "#")
+                    nodes_[i].hash = idx;
+                else {
+                    edges_.push_back(
+                        {index_type(i), idx, index_type(levels_.size()),
+                         index_type(child.first.size())}
+                    );
+                    levels_.append(child.first);
+                }
+            }
+        }
+
+        // Build the perfect hash, growing the table until it works.
+        if (edges_.empty())
+            return;
+
+        disps_.assign(pow2((edges_.size() + 3) / 4), 0);
+        slots_.resize(pow2(edges_.size() + edges_.size() / 4));
+
+        while (!build_hash()) {
+            ++seed_;
+            slots_.resize(2 * slots_.size());
+        }
+    }
+
+public:
+    /**
+     * Iterator that searches the collection for topic matches.
+     *
+     * The iterator refers to the topic that it's searching rather than
+     * keeping a copy of it, so the string must outlive the iterator.
+     */
+    class match_iterator
+    {
+        /** A node still to be searched */
+        struct search_node
+        {
+            /** The node to be searched */
+            index_type node;
+            /** The offset of the next level in the topic, or NONE if done */
+            index_type pos;
+        };
+
+        /** The collection being searched */
+        const compiled_topic_matcher* tm_;
+        /** The topic being matched */
+        std::string_view topic_;
+        /** The last-found value */
+        const value_type* pval_;
+        /** The number of nodes on the stack */
+        size_t n_;
+        /** The stack of nodes to search, for reasonable depths */
+        std::array<search_node, INLINE_DEPTH + 2> inline_;
+        /** The stack of nodes to search, for deeper collections */
+        std::vector<search_node> deep_;
+
+        /** Gets the stack of nodes to be searched */
+        search_node* stack() { return deep_.empty() ? inline_.data() : deep_.data(); }
+
+        /** Gets a pointer to the value for a node, if any */
+        const value_type* content(index_type nd) const {
+            auto idx = tm_->nodes_[nd].content;
+            return (idx == NONE) ? nullptr : &tm_->values_[idx];
+        }
+
+        /**
+         * Move the iterator to the next value, or to end(), if none left.
+         */
+        void next() {
+            pval_ = nullptr;
+            auto stk = stack();
+
+            while (n_ != 0) {
+                auto snode = stk[--n_];
+                const auto& nd = tm_->nodes_[snode.node];
+
+                // At the end of the topic, we either have a value, or
+                // need to move on to the next node to search.
+                if (snode.pos == NONE) {
+                    if ((pval_ = content(snode.node)) != nullptr)
+                        return;
+                    continue;
+                }
+
+                // Get the next level of the topic
+                auto end = topic_.find('/', snode.pos);
+                auto level = topic_.substr(snode.pos, end - snode.pos);
+                auto pos = (end == std::string_view::npos) ? NONE : index_type(end + 1);
+
+                // Look for an exact match
+                auto child = tm_->child(snode.node, level);
+                if (child != NONE)
+                    stk[n_++] = {child, pos};
+
+                // Topics starting with '$' don't match wildcards in the first field
+                // MQTT v5 Spec, Section 4.7.2:
+                // https://docs.oasis-open.org/mqtt/mqtt/v5.0/os/mqtt-v5.0-os.html#_Toc3901246
+
+                if (snode.pos != 0 || level.empty() || level[0] != '$') {
+                    // Look for a single-field wildcard match
+                    if (nd.plus != NONE)
+                        stk[n_++] = {nd.plus, pos};
+
+                    // Look for a terminating match
+                    if (nd.hash != NONE && (pval_ = content(nd.hash)) != nullptr)
+                        return;
+                }
+            }
+        }
+
+        friend class compiled_topic_matcher;
+
+        match_iterator() : tm_{nullptr}, pval_{nullptr}, n_{0} {}
+        match_iterator(const compiled_topic_matcher* tm, std::string_view topic)
+            : tm_{tm}, topic_{topic}, pval_{nullptr}, n_{0} {
+            // The stack never holds more than two nodes at the deepest
+            // level, plus one for each level above it.
+            if (tm_->maxDepth_ > INLINE_DEPTH)
+                deep_.resize(tm_->maxDepth_ + 2);
+
+            stack()[n_++] = {ROOT, topic.empty() ? NONE : 0};
+            next();
+        }
+
+    public:
+        /**
+         * Gets a reference to the current value.
+         * @return A reference to the current value.
+         */
+        const_reference operator*() const noexcept { return *pval_; }
+        /**
+         * Get a pointer to the current value.
+         * @return A pointer to the current value.
+         */
+        const value_type* operator->() const noexcept { return pval_; }
+        /**
+         * Postfix increment operator.
+         * @return An iterator pointing to the previous matching item.
+         */
+        match_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            this->next();
+            return tmp;
+        }
+        /**
+         * Prefix increment operator.
+         * @return An iterator pointing to the next matching item.
+         */
+        match_iterator& operator++() noexcept {
+            this->next();
+            return *this;
+        }
+        /**
+         * Compares two iterators to see if they don't refer to the same
+         * node.
+         *
+         * @param other The other iterator to compare against this one.
+         * @return @em true if they don't match, @em false if they do
+         */
+        bool operator!=(const match_iterator& other) const noexcept {
+            return pval_ != other.pval_;
+        }
+    };
+
+    /** All match iterators are const */
+    using const_match_iterator = match_iterator;
+
+    /**
+     * Creates a new, empty collection.
+     */
+    compiled_topic_matcher() : nodes_(1) {}
+    /**
+     * Creates a collection from the items in a topic matcher.
+     * @param tm The topic matcher to compile.
+     */
+    explicit compiled_topic_matcher(const topic_matcher<T>& tm) {
+        for (auto it = tm.cbegin(); it != tm.cend(); ++it) values_.push_back(*it);
+        build();
+    }
+    /**
+     * Creates a new collection from a list of key/value pairs.
+     * If a filter appears more than once, the last value is used.
+     * @param lst The list of key/value pairs to populate the collection.
+     */
+    compiled_topic_matcher(std::initializer_list<value_type> lst)
+        : compiled_topic_matcher(topic_matcher<T>{lst}) {}
+    /**
+     * Determines if the collection is empty.
+     * @return @em true if the collection is empty, @em false if it contains
+     *         any filters.
+     */
+    bool empty() const { return values_.empty(); }
+    /**
+     * Gets the number of filters in the collection.
+     * @return The number of filters in the collection.
+     */
+    size_t size() const { return values_.size(); }
+    /**
+     * Gets an iterator to the full collection of filters.
+     * @return An iterator to the full collection of filters.
+     */
+    const_iterator begin() const { return values_.cbegin(); }
+    /**
+     * Gets an iterator to the end of the collection of filters.
+     * @return An iterator to the end of collection of filters.
+     */
+    const_iterator end() const { return values_.cend(); }
+    /**
+     * Gets an iterator to the full collection of filters.
+     * @return An iterator to the full collection of filters.
+     */
+    const_iterator cbegin() const { return values_.cbegin(); }
+    /**
+     * Gets an iterator to the end of the collection of filters.
+     * @return An iterator to the end of collection of filters.
+     */
+    const_iterator cend() const { return values_.cend(); }
+    /**
+     * Gets an iterator to the value at the requested key.
+     * @param filter The topic filter entry to find.
+     * @return An iterator to the value if found, @em end() if not found.
+     */
+    const_iterator find(std::string_view filter) const {
+        auto nd = ROOT;
+        topic_levels fields{filter};
+
+        for (size_t i = 0; i < fields.size() && nd != NONE; ++i) {
+            auto fld = fields.level(filter, i);
+            if (fld == "+")
+                nd = nodes_[nd].plus;
+            else if (fld == "#")
+                nd = nodes_[nd].hash;
+            else
+                nd = child(nd, fld);
+        }
+
+        if (nd == NONE || nodes_[nd].content == NONE)
+            return end();
+        return values_.cbegin() + nodes_[nd].content;
+    }
+    /**
+     * Gets an iterator that finds the matches to the topic.
+     * @param topic The topic to search for matches. This must outlive the
+     *  			iterator.
+     * @return An iterator that can find the matches to the topic.
+     */
+    match_iterator matches(std::string_view topic) const { return match_iterator(this, topic); }
+    /**
+     * Gets an iterator for the end of the matches.
+     * @return An empty/null iterator indicating the end of the matches.
+     */
+    match_iterator matches_end() const noexcept { return match_iterator{}; }
+    /**
+     * Gets an iterator for the end of the matches.
+     * @return An empty/null iterator indicating the end of the matches.
+     */
+    match_iterator matches_cend() const noexcept { return match_iterator{}; }
+    /**
+     * Determines if there are any matches for the specified topic.
+     * @param topic The topic to search for matches.
+     * @return Whether there are any matches for the topic in the
+     *         collection.
+     */
+    bool has_match(std::string_view topic) const { return matches(topic) != matches_cend(); }
+};
+
+// --------------------------------------------------------------------------
+
+template <typename T>
+compiled_topic_matcher<T> topic_matcher<T>::freeze() const {
+    return compiled_topic_matcher<T>{*this};
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_compiled_topic_matcher_h
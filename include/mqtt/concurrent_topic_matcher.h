@@ -0,0 +1,283 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file concurrent_topic_matcher.h
+/// Declaration of MQTT concurrent_topic_matcher class, a thread-safe topic
+/// matcher that can be searched without taking a lock.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_concurrent_topic_matcher_h
+#define __mqtt_concurrent_topic_matcher_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mqtt/topic_matcher.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A thread-safe collection of MQTT topic filters mapped to values, for
+ * when the collection is searched far more often than it is changed.
+ *
+ * This is typically used to route incoming messages from several threads,
+ * while subscriptions come and go at runtime. The searches, like
+ * matches(), has_match(), and find(), never take a lock, and never wait
+ * on each other or on an update.
+ * @par
+ * The filters are held in an immutable @ref topic_matcher, which is
+ * replaced as a whole on each change. An update copies the current
+ * version, modifies the copy, and then publishes it with a single atomic
+ * store. Searches that started before the store continue to use the old
+ * version, which is only deleted once they have all finished. The readers
+ * are tracked by epoch: each one registers with a counter for the current
+ * epoch, and an update advances the epoch, then waits for the counter of
+ * the previous one to drain.
+ * @par
+ * So an update is expensive, costing a copy of the whole collection, and
+ * updates are serialized with each other. Use update() to make several
+ * changes at once, for the price of a single copy. And note that an
+ * update waits for any search that is in progress, so the function given
+ * to for_each_match() should not block for long, and must not modify the
+ * collection.
+ *
+ * @tparam T The type of the values mapped to the filters. It must be
+ *  		 copyable.
+ */
+template <typename T>
+class concurrent_topic_matcher
+{
+public:
+    /** The single-threaded collection that holds each version */
+    using matcher_type = topic_matcher<T>;
+
+    using key_type = typename matcher_type::key_type;
+    using mapped_type = typename matcher_type::mapped_type;
+    using value_type = typename matcher_type::value_type;
+    using mapped_ptr = typename matcher_type::mapped_ptr;
+
+private:
+    /** The assumed size of a cache line, to keep the counters apart */
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    /** The number of times to check for readers before yielding */
+    static constexpr int SPIN_COUNT = 64;
+
+    /** The number of readers in an epoch */
+    struct alignas(CACHE_LINE_SIZE) reader_count
+    {
+        std::atomic<size_t> n{0};
+    };
+
+    /** The current version of the collection */
+    alignas(CACHE_LINE_SIZE) std::atomic<const matcher_type*> cur_;
+    /** The current epoch, advanced by each update */
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> epoch_{0};
+    /** The readers for the even and odd epochs */
+    mutable reader_count nReaders_[2];
+    /** Serializes the updates */
+    std::mutex updateLock_;
+
+    /**
+     * Registers a search for its duration, and gets the version it
+     * should use.
+     */
+    class read_guard
+    {
+        /** The counter for the epoch the reader is registered in */
+        std::atomic<size_t>* cnt_;
+        /** The version of the collection to search */
+        const matcher_type* matcher_;
+
+    public:
+        read_guard(const concurrent_topic_matcher& tm) {
+            // If an update advances the epoch between reading it and
+            // registering, we can't be sure that the update saw us, so we
+            // back out and try again in the new epoch.
+            while (true) {
+                auto e = tm.epoch_.load();
+                cnt_ = &tm.nReaders_[e & 1].n;
+                cnt_->fetch_add(1);
+                if (tm.epoch_.load() == e)
+                    break;
+                cnt_->fetch_sub(1, std::memory_order_release);
+            }
+            matcher_ = tm.cur_.load(std::memory_order_acquire);
+        }
+        ~read_guard() { cnt_->fetch_sub(1, std::memory_order_release); }
+
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+
+        const matcher_type& operator*() const { return *matcher_; }
+        const matcher_type* operator->() const { return matcher_; }
+    };
+
+    /**
+     * Publishes a new version of the collection, then waits until it's
+     * safe to delete the previous one.
+     * This must be called with the update lock held.
+     */
+    void publish(std::unique_ptr<matcher_type> next) {
+        std::unique_ptr<const matcher_type> prev{cur_.exchange(next.release())};
+
+        auto e = epoch_.load(std::memory_order_relaxed);
+        epoch_.store(e + 1);
+
+        // Any reader that could still see the previous version registered
+        // in the previous epoch.
+        const auto& cnt = nReaders_[e & 1].n;
+        for (int i = 0; cnt.load(std::memory_order_acquire) != 0; ++i) {
+            if (i >= SPIN_COUNT)
+                std::this_thread::yield();
+        }
+    }
+
+    // Non-copyable
+    concurrent_topic_matcher(const concurrent_topic_matcher&) = delete;
+    concurrent_topic_matcher& operator=(const concurrent_topic_matcher&) = delete;
+
+public:
+    /**
+     * Creates a new, empty collection.
+     */
+    concurrent_topic_matcher() : cur_{new matcher_type{}} {}
+    /**
+     * Creates a new collection with a list of key/value pairs.
+     * @param lst The list of key/value pairs to populate the collection.
+     */
+    concurrent_topic_matcher(std::initializer_list<value_type> lst)
+        : cur_{new matcher_type{lst}} {}
+    /**
+     * Destroys the collection.
+     * There must not be any searches in progress.
+     */
+    ~concurrent_topic_matcher() { delete cur_.load(); }
+    /**
+     * Makes any number of changes to the collection, publishing them as a
+     * single new version.
+     *
+     * The function is called with a private copy of the current version,
+     * and can modify it freely. Searches see either all of the changes or
+     * none of them.
+     *
+     * @param f A function taking a reference to a @ref topic_matcher.
+     */
+    template <typename Func>
+    void update(Func&& f) {
+        std::lock_guard<std::mutex> g{updateLock_};
+        auto next = std::make_unique<matcher_type>(*cur_.load(std::memory_order_relaxed));
+        std::forward<Func>(f)(*next);
+        publish(std::move(next));
+    }
+    /**
+     * Inserts a new key/value pair into the collection, replacing any that
+     * is already there for the same filter.
+     * @param val The value to place in the collection.
+     */
+    void insert(value_type&& val) {
+        update([&val](matcher_type& tm) { tm.insert(std::move(val)); });
+    }
+    /**
+     * Inserts a new key/value pair into the collection, replacing any that
+     * is already there for the same filter.
+     * @param val The value to place in the collection.
+     */
+    void insert(const value_type& val) {
+        update([&val](matcher_type& tm) { tm.insert(val); });
+    }
+    /**
+     * Removes an entry from the collection.
+     * If the filter isn't in the collection, this doesn't make a new
+     * version.
+     * @param filter The topic filter to remove.
+     * @return A unique pointer to the value, if any.
+     */
+    mapped_ptr remove(const key_type& filter) {
+        std::lock_guard<std::mutex> g{updateLock_};
+        const auto* cur = cur_.load(std::memory_order_relaxed);
+        if (!(cur->find(filter) != cur->cend()))
+            return mapped_ptr{};
+
+        auto next = std::make_unique<matcher_type>(*cur);
+        auto val = next->remove(filter);
+        next->prune();
+        publish(std::move(next));
+        return val;
+    }
+    /**
+     * Gets a copy of the value for a filter.
+     * @param filter The topic filter entry to find.
+     * @return A unique pointer to a copy of the value if found, or null if
+     *  	   not found.
+     */
+    mapped_ptr find(const key_type& filter) const {
+        read_guard tm{*this};
+        auto it = tm->find(filter);
+        return (it != tm->cend()) ? std::make_unique<mapped_type>(it->second) : mapped_ptr{};
+    }
+    /**
+     * Calls a function for each filter and value that matches the topic.
+     * The search doesn't allocate memory or take any locks.
+     * @param topic The topic to search for matches.
+     * @param f A function taking the matching key/value pair, as a const
+     *  		reference.
+     * @return The number of matches.
+     */
+    template <typename Func>
+    size_t for_each_match(const string& topic, Func&& f) const {
+        read_guard tm{*this};
+        size_t n = 0;
+        for (auto it = tm->matches(topic); it != tm->matches_cend(); ++it, ++n) f(*it);
+        return n;
+    }
+    /**
+     * Gets copies of all the filters and values that match the topic.
+     * @param topic The topic to search for matches.
+     * @return The matching key/value pairs.
+     */
+    std::vector<value_type> matches(const string& topic) const {
+        std::vector<value_type> v;
+        for_each_match(topic, [&v](const value_type& val) { v.push_back(val); });
+        return v;
+    }
+    /**
+     * Determines if there are any matches for the specified topic.
+     * @param topic The topic to search for matches.
+     * @return Whether there are any matches for the topic in the
+     *         collection.
+     */
+    bool has_match(const string& topic) const {
+        read_guard tm{*this};
+        return tm->matches(topic) != tm->matches_cend();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_concurrent_topic_matcher_h
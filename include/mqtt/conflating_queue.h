@@ -0,0 +1,452 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file conflating_queue.h
+/// Implementation of the class 'conflating_queue', a thread-safe queue of
+/// events that keeps only the latest message for each topic.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_conflating_queue_h
+#define __mqtt_conflating_queue_h
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mqtt/event.h"
+#include "mqtt/thread_queue.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A thread-safe queue of events that conflates messages by topic.
+ *
+ * This has the same blocking contract as @ref thread_queue, and can be
+ * used as the consumer queue of a client, but it holds at most one message
+ * for each topic. When a message arrives for a topic that already has one
+ * waiting in the queue, the new message replaces the old one in place, so
+ * the pending topics come out in the order of their first update that
+ * hasn't been read yet, but always with the latest value.
+ * @par
+ * This suits dashboards, control loops, and the like, where only the
+ * newest value for a topic matters. When the consumer falls behind a
+ * bursty feed, the queue stays bounded by the number of topics, and a
+ * consumer never has to work through stale values to get to the current
+ * one. Note that a replaced message is simply dropped, even if it was
+ * sent at QoS 1 or 2, since the library has already acknowledged it. In
+ * manual-ack mode, the replaced message is acked, once the queue is
+ * unlocked, so it doesn't hold up the acks of the messages after it.
+ * @par
+ * Events other than messages, like a lost connection, are never
+ * conflated. Each takes its own place in the queue.
+ * @par
+ * The capacity limits the number of entries in the queue, which is the
+ * number of pending topics plus other events. A message for a topic that
+ * is already pending never blocks, even when the queue is full.
+ */
+class conflating_queue
+{
+public:
+    /** The type of items to be held in the queue. */
+    using value_type = event;
+    /** The type used to specify number of items in the container. */
+    using size_type = std::size_t;
+
+    /** The maximum capacity of the queue. */
+    static constexpr size_type MAX_CAPACITY = std::numeric_limits<size_type>::max();
+
+private:
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** Condition get signaled when item added to empty queue */
+    std::condition_variable notEmptyCond_;
+    /** Condition gets signaled then item removed from full queue */
+    std::condition_variable notFullCond_;
+    /** The capacity of the queue */
+    size_type cap_{MAX_CAPACITY};
+    /** Whether the queue is closed */
+    bool closed_{false};
+
+    /** The entries, in the order of the first pending update */
+    std::deque<value_type> que_;
+    /** The sequence number of the entry at the front of the queue */
+    size_type headSeq_{0};
+    /**
+     * The sequence number of the entry for each pending topic. The key is
+     * a view of the topic of the message in the entry.
+     */
+    std::unordered_map<std::string_view, size_type> index_;
+    /** The number of messages that were replaced by newer ones */
+    size_type nConflated_{0};
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** General purpose guard */
+    using unique_guard = std::unique_lock<std::mutex>;
+
+    /** Gets the message in an event, if it has one */
+    static const message* message_of(value_type& evt) {
+        auto p = evt.get_message_if();
+        return p ? p->get() : nullptr;
+    }
+    /**
+     * Replaces the pending message for the same topic, if there is one
+     * (unsafe). The replaced event is moved into 'old'.
+     * @return @em true if the value replaced a pending message.
+     */
+    bool replace(value_type& val, value_type& old) {
+        // The message stays put when the event is moved
+        auto msg = message_of(val);
+        if (!msg)
+            return false;
+
+        auto it = index_.find(std::string_view{msg->get_topic()});
+        if (it == index_.end())
+            return false;
+
+        // The key has to view the topic of the message now in the entry
+        auto nh = index_.extract(it);
+        nh.key() = std::string_view{msg->get_topic()};
+        auto& entry = que_[nh.mapped() - headSeq_];
+        old = std::move(entry);
+        entry = std::move(val);
+        index_.insert(std::move(nh));
+
+        ++nConflated_;
+        return true;
+    }
+    /** Adds a new entry at the back of the queue (unsafe) */
+    void push(value_type& val) {
+        if (auto msg = message_of(val))
+            index_.emplace(std::string_view{msg->get_topic()}, headSeq_ + que_.size());
+        que_.push_back(std::move(val));
+    }
+    /** Removes the entry at the front of the queue (unsafe) */
+    void pop(value_type* val) {
+        if (auto msg = message_of(que_.front()))
+            index_.erase(std::string_view{msg->get_topic()});
+        *val = std::move(que_.front());
+        que_.pop_front();
+        ++headSeq_;
+    }
+    /** Places the value in the queue, once there's room (unsafe) */
+    void add(value_type& val) {
+        bool wasEmpty = que_.empty();
+        push(val);
+        if (wasEmpty)
+            notEmptyCond_.notify_all();
+    }
+    /** Checks if the queue is done (unsafe) */
+    bool is_done() const { return closed_ && que_.empty(); }
+    /**
+     * Moves up to 'n' items from the front of the queue to the back of the
+     * vector, signaling any blocked producers (unsafe).
+     */
+    size_type move_n(std::vector<value_type>* vec, size_type n) {
+        n = std::min(n, que_.size());
+        vec->reserve(vec->size() + n);
+        for (size_type i = 0; i < n; ++i) {
+            value_type val;
+            pop(&val);
+            vec->push_back(std::move(val));
+        }
+        if (n > 0)
+            notFullCond_.notify_all();
+        return n;
+    }
+
+public:
+    /**
+     * Constructs a queue with the maximum capacity.
+     * This is bounded only by the number of topics.
+     */
+    conflating_queue() {}
+    /**
+     * Constructs a queue with the specified capacity.
+     * @param cap The maximum number of entries that can be placed in the
+     *  		  queue. The minimum capacity is 1.
+     */
+    explicit conflating_queue(size_type cap) : cap_(std::max<size_type>(cap, 1)) {}
+    /**
+     * Determine if the queue is empty.
+     * @return @em true if there are no elements in the queue, @em false if
+     *  	   there are any items in the queue.
+     */
+    bool empty() const {
+        guard g{lock_};
+        return que_.empty();
+    }
+    /**
+     * Gets the capacity of the queue.
+     * @return The maximum number of entries before the queue is full.
+     */
+    size_type capacity() const {
+        guard g{lock_};
+        return cap_;
+    }
+    /**
+     * Gets the number of entries in the queue.
+     * @return The number of pending topics plus other events.
+     */
+    size_type size() const {
+        guard g{lock_};
+        return que_.size();
+    }
+    /**
+     * Gets the number of messages that were dropped because a newer message
+     * for the same topic arrived before they were read.
+     * @return The number of messages that were replaced.
+     */
+    size_type num_conflated() const {
+        guard g{lock_};
+        return nConflated_;
+    }
+    /**
+     * Close the queue.
+     * Once closed, the queue will not accept any new items, but receievers
+     * will still be able to get any remaining items out of the queue until
+     * it is empty.
+     */
+    void close() {
+        guard g{lock_};
+        closed_ = true;
+        notFullCond_.notify_all();
+        notEmptyCond_.notify_all();
+    }
+    /**
+     * Determines if the queue is closed.
+     * @return @em true if the queue is closed, @false otherwise.
+     */
+    bool closed() const {
+        guard g{lock_};
+        return closed_;
+    }
+    /**
+     * Determines if all possible operations are done on the queue.
+     * @return @true if the queue is closed and empty, @em false otherwise.
+     */
+    bool done() const {
+        guard g{lock_};
+        return is_done();
+    }
+    /**
+     * Clear the contents of the queue.
+     * This discards all items in the queue.
+     */
+    void clear() {
+        std::deque<value_type> que;
+        {
+            guard g{lock_};
+            index_.clear();
+            headSeq_ += que_.size();
+            que.swap(que_);
+            notFullCond_.notify_all();
+        }
+        for (auto& val : que) discard_queue_item(val, 0);
+    }
+    /**
+     * Put an item into the queue.
+     * A message for a topic that is already pending replaces the one in
+     * the queue. Otherwise, if the queue is full, this will block the
+     * caller until items are removed.
+     * @param val The value to add to the queue.
+     * @throw queue_closed if the queue is closed.
+     */
+    void put(value_type val) {
+        value_type old;
+        {
+            unique_guard g{lock_};
+            if (closed_)
+                throw queue_closed{};
+            if (!replace(val, old)) {
+                notFullCond_.wait(g, [this] { return que_.size() < cap_ || closed_; });
+                if (closed_)
+                    throw queue_closed{};
+                if (!replace(val, old))
+                    add(val);
+            }
+        }
+        discard_queue_item(old, 0);
+    }
+    /**
+     * Non-blocking attempt to place an item into the queue.
+     * @param val The value to add to the queue.
+     * @return @em true if the item was added to the queue, or replaced a
+     *  	   pending message, @em false if the queue is currently full or
+     *  	   closed.
+     */
+    bool try_put(value_type val) {
+        value_type old;
+        {
+            guard g{lock_};
+            if (closed_)
+                return false;
+            if (!replace(val, old)) {
+                if (que_.size() >= cap_)
+                    return false;
+                add(val);
+                return true;
+            }
+        }
+        discard_queue_item(old, 0);
+        return true;
+    }
+    /**
+     * Retrieve a value from the queue.
+     * If the queue is empty, this will block indefinitely until a value is
+     * added to the queue by another thread, or the queue is closed.
+     * @param val Pointer to a variable to receive the value.
+     * @return @em true if a value was removed from the queue, @em false if
+     *  	   the queue is done.
+     */
+    bool get(value_type* val) {
+        if (!val)
+            return false;
+
+        unique_guard g{lock_};
+        notEmptyCond_.wait(g, [this] { return !que_.empty() || closed_; });
+        if (que_.empty())
+            return false;
+
+        pop(val);
+        notFullCond_.notify_all();
+        return true;
+    }
+    /**
+     * Retrieve a value from the queue.
+     * If the queue is empty, this will block indefinitely until a value is
+     * added to the queue by another thread, or the queue is closed.
+     * @return The value removed from the queue
+     * @throw queue_closed if the queue is done.
+     */
+    value_type get() {
+        value_type val;
+        if (!get(&val))
+            throw queue_closed{};
+        return val;
+    }
+    /**
+     * Attempts to remove a value from the queue without blocking.
+     * @param val Pointer to a variable to receive the value.
+     * @return @em true if a value was removed from the queue, @em false if
+     *  	   the queue is empty.
+     */
+    bool try_get(value_type* val) {
+        if (!val)
+            return false;
+
+        guard g{lock_};
+        if (que_.empty())
+            return false;
+
+        pop(val);
+        notFullCond_.notify_all();
+        return true;
+    }
+    /**
+     * Attempt to remove an item from the queue for a bounded amount of time.
+     * @param val Pointer to a variable to receive the value.
+     * @param relTime The amount of time to wait until timing out.
+     * @return @em true if the value was removed the queue, @em false if a
+     *  	   timeout occurred.
+     */
+    template <typename Rep, class Period>
+    bool try_get_for(value_type* val, const std::chrono::duration<Rep, Period>& relTime) {
+        return try_get_until(val, std::chrono::steady_clock::now() + relTime);
+    }
+    /**
+     * Attempt to remove an item from the queue, waiting up to an absolute
+     * time for one to arrive.
+     * @param val Pointer to a variable to receive the value.
+     * @param absTime The absolute time to wait to before timing out.
+     * @return @em true if the value was removed from the queue, @em false
+     *  	   if a timeout occurred.
+     */
+    template <class Clock, class Duration>
+    bool try_get_until(
+        value_type* val, const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        if (!val)
+            return false;
+
+        unique_guard g{lock_};
+        if (!notEmptyCond_.wait_until(g, absTime, [this] {
+                return !que_.empty() || closed_;
+            }) ||
+            que_.empty())
+            return false;
+
+        pop(val);
+        notFullCond_.notify_all();
+        return true;
+    }
+    /**
+     * Attempts to remove up to 'n' values from the queue without blocking.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @return The number of values removed from the queue.
+     */
+    size_type try_get_n(std::vector<value_type>* vec, size_type n) {
+        if (!vec)
+            return 0;
+
+        guard g{lock_};
+        return move_n(vec, n);
+    }
+    /**
+     * Attempt to remove up to 'n' values from the queue, waiting until the
+     * specified time for the first one to arrive.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @param absTime The absolute time to wait to before timing out.
+     * @return The number of values removed from the queue, which is zero
+     *  	   if a timeout occurred.
+     */
+    template <class Clock, class Duration>
+    size_type try_get_n_until(
+        std::vector<value_type>* vec, size_type n,
+        const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        if (!vec || n == 0)
+            return 0;
+
+        unique_guard g{lock_};
+        if (!notEmptyCond_.wait_until(g, absTime, [this] {
+                return !que_.empty() || closed_;
+            }))
+            return 0;
+
+        return move_n(vec, n);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_conflating_queue_h
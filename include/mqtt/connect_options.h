@@ -31,6 +31,7 @@
 #include "MQTTAsync.h"
 #include "mqtt/message.h"
 #include "mqtt/platform.h"
+#include "mqtt/reconnect_policy.h"
 #include "mqtt/ssl_options.h"
 #include "mqtt/string_collection.h"
 #include "mqtt/token.h"
@@ -97,6 +98,9 @@ class connect_options
     /** Secure HTTPS proxy for websockets */
     string httpsProxy_;
 
+    /** The reconnect policy managed by the client, if any */
+    const_reconnect_policy_ptr reconnPolicy_;
+
     /** The client has special access */
     friend class async_client;
 
@@ -326,6 +330,11 @@ public:
     std::chrono::seconds get_max_retry_interval() const {
         return std::chrono::seconds(opts_.maxRetryInterval);
     }
+    /**
+     * Gets the policy for reconnects that are managed by the client.
+     * @return The reconnect policy, or null if there isn't one.
+     */
+    const_reconnect_policy_ptr get_reconnect_policy() const { return reconnPolicy_; }
     /**
      * Sets whether the server should remember state for the client across
      * reconnects. (MQTT v3.x only)
@@ -494,6 +503,21 @@ public:
             (int)to_seconds_count(minRetryInterval), (int)to_seconds_count(maxRetryInterval)
         );
     }
+    /**
+     * Sets a policy for reconnects that are managed by the client, in
+     * place of the automatic reconnects of the C library, which this turns
+     * off.
+     * @param policy The reconnect policy.
+     * @sa reconnect_policy
+     */
+    void set_reconnect_policy(const reconnect_policy& policy) {
+        reconnPolicy_ = std::make_shared<const reconnect_policy>(policy);
+        set_automatic_reconnect(false);
+    }
+    /**
+     * Removes the policy for reconnects that are managed by the client.
+     */
+    void clear_reconnect_policy() { reconnPolicy_.reset(); }
     /**
      * Gets the connect properties.
      * @return A const reference to the properties for the connect.
@@ -882,6 +906,15 @@ public:
         opts_.set_automatic_reconnect(minRetryInterval, maxRetryInterval);
         return *this;
     }
+    /**
+     * Sets a policy for reconnects that are managed by the client, in
+     * place of the automatic reconnects of the C library.
+     * @param policy The reconnect policy.
+     */
+    auto reconnect_policy(const mqtt::reconnect_policy& policy) -> self& {
+        opts_.set_reconnect_policy(policy);
+        return *this;
+    }
     /**
      * Sets the 'clean start' flag for the connection. (MQTT v5 only)
      * @param on @em true to set the 'clean start' flag for the connect,
@@ -0,0 +1,199 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file consumer_group.h
+/// Declaration of MQTT consumer_group class, a set of clients that share
+/// the load of a set of shared subscriptions.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_consumer_group_h
+#define __mqtt_consumer_group_h
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "mqtt/async_client.h"
+#include "mqtt/connect_options.h"
+#include "mqtt/create_options.h"
+#include "mqtt/dispatcher.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A group of clients in one process that share the load of a set of
+ * subscriptions.
+ *
+ * Each filter that is subscribed through the group is subscribed by every
+ * client as an MQTT v5 shared subscription, like `$share/group/filter`, so
+ * the server spreads the matching messages across the clients. The
+ * messages that arrive on all of the clients are merged into a single
+ * @ref work_stealing_dispatcher, whose worker threads call the handler.
+ * Each client's messages are queued for a worker of its own, but idle
+ * workers take messages from busy ones, so a single busy connection can
+ * still keep all of the cores busy.
+ * @par
+ * The subscriptions are made again each time a client connects or
+ * reconnects.
+ * @par
+ * As with shared subscriptions in general, the order of the messages is
+ * not preserved.
+ */
+class consumer_group
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<consumer_group>;
+    /** The handler for incoming messages */
+    using handler_type = work_stealing_dispatcher::handler_type;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** A subscription made by the group */
+    struct subscription
+    {
+        /** The topic filter, without the share prefix */
+        string filter;
+        /** The QoS for the subscription */
+        int qos;
+    };
+
+    /** The name of the share group */
+    string groupName_;
+    /** The dispatcher for the incoming messages of all the clients */
+    work_stealing_dispatcher disp_;
+    /** The clients */
+    std::vector<std::unique_ptr<async_client>> clients_;
+    /** Lock for the subscriptions */
+    mutable std::mutex lock_;
+    /** The subscriptions */
+    std::vector<subscription> subs_;
+
+    /** Subscribes one client to all the current subscriptions */
+    void resubscribe(async_client& cli);
+
+    consumer_group(const consumer_group&) = delete;
+    consumer_group& operator=(const consumer_group&) = delete;
+
+public:
+    /**
+     * Creates a group of clients.
+     *
+     * The clients use the server and options in @a opts, each with a
+     * client ID made from the one in the options, with a suffix of a dash
+     * and the index of the client, like "myapp-0", "myapp-1", etc. The
+     * options should select MQTT v5.
+     *
+     * @param opts The options for creating the clients.
+     * @param groupName The name of the share group.
+     * @param nClients The number of clients. If zero, a single client is
+     *  			   created.
+     * @param handler The handler for the incoming messages.
+     * @param nWorkers The number of worker threads to handle the messages.
+     *  			   If zero, a thread is used for each hardware core.
+     */
+    consumer_group(
+        const create_options& opts, const string& groupName, std::size_t nClients,
+        handler_type handler, std::size_t nWorkers = 0
+    );
+    /**
+     * Destroys the group.
+     * This stops the dispatcher, after it handles any queued messages. It
+     * does not disconnect the clients.
+     */
+    ~consumer_group();
+    /**
+     * Gets the filter for a shared subscription.
+     * @param groupName The name of the share group.
+     * @param filter The topic filter.
+     * @return The filter for the shared subscription, like
+     *  	   `$share/group/filter`.
+     */
+    static string shared_filter(const string& groupName, const string& filter) {
+        return "$share/" + groupName + "/" + filter;
+    }
+    /**
+     * Gets the name of the share group.
+     * @return The name of the share group.
+     */
+    const string& get_group_name() const { return groupName_; }
+    /**
+     * Gets the number of clients in the group.
+     * @return The number of clients in the group.
+     */
+    std::size_t size() const { return clients_.size(); }
+    /**
+     * Gets one of the clients.
+     * @param i The index of the client.
+     * @return A reference to the client.
+     */
+    async_client& get_client(std::size_t i) { return *clients_.at(i); }
+    /**
+     * Gets the dispatcher that handles the messages for the group.
+     * @return A reference to the dispatcher.
+     */
+    work_stealing_dispatcher& get_dispatcher() { return disp_; }
+    /**
+     * Connects all of the clients, and waits for them to connect.
+     * The subscriptions are made once each client is connected.
+     * @param opts The options for connecting the clients.
+     * @throw exception if any of the clients fails to connect.
+     */
+    void connect(const connect_options& opts);
+    /**
+     * Disconnects all of the clients, and waits for them to disconnect.
+     * @throw exception if any of the clients fails to disconnect.
+     */
+    void disconnect();
+    /**
+     * Adds a subscription for the group.
+     * This is subscribed right away by any clients that are connected,
+     * and waits for the subscriptions to complete.
+     * @param filter The topic filter, without the share prefix.
+     * @param qos The QoS for the subscription.
+     * @throw exception if any of the subscriptions fail.
+     */
+    void subscribe(const string& filter, int qos);
+    /**
+     * Removes a subscription for the group.
+     * This is unsubscribed right away by any clients that are connected,
+     * and waits for the requests to complete.
+     * @param filter The topic filter, without the share prefix.
+     * @throw exception if any of the requests fail.
+     */
+    void unsubscribe(const string& filter);
+    /**
+     * Gets the topic filters that are subscribed by the group.
+     * @return The topic filters, without the share prefix.
+     */
+    std::vector<string> get_subscriptions() const;
+};
+
+/** Smart/shared pointer to a consumer_group */
+using consumer_group_ptr = consumer_group::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_consumer_group_h
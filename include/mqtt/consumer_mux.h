@@ -0,0 +1,196 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file consumer_mux.h
+/// Declaration of MQTT consumer_mux class, which merges the consumer
+/// queues of a number of clients into one.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_consumer_mux_h
+#define __mqtt_consumer_mux_h
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mqtt/async_client.h"
+#include "mqtt/event.h"
+#include "mqtt/thread_queue.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Merges the consumer queues of a number of existing clients into one, so
+ * that a single thread, or a small pool of them, can service all the
+ * connections.
+ *
+ * Each client that's added starts consuming into the mux, rather than into
+ * a queue of its own, and each event is tagged with the index of the
+ * client that it came from. The events of each client keep their order,
+ * and any number of threads can consume from the mux at once.
+ * @code
+ * mqtt::consumer_mux mux;
+ * for (auto& cli : clients)
+ *     mux.add(*cli);
+ *
+ * while (true) {
+ *     auto evt = mux.consume_event();
+ *     if (evt.client == mqtt::consumer_mux::npos)
+ *         break;
+ *     if (auto msg = evt.evt.get_message_if())
+ *         handle(mux.get_client(evt.client), *msg);
+ * }
+ * @endcode
+ * @par
+ * The events must be read from the mux; the clients' own consume calls
+ * get nothing once they are added. Clients that are stopped, with
+ * `async_client::stop_consuming()`, simply stop adding events. The
+ * messages are delivered as they were queued, so the app should check
+ * message::is_expired() if it uses message expiry.
+ * @par
+ * The mux must outlive the time the clients are consuming into it, and
+ * the clients must outlive the mux, or at least stop consuming first.
+ */
+class consumer_mux
+{
+public:
+    /** An event from one of the clients */
+    struct client_event
+    {
+        /** The index of the client. This is @ref npos on shutdown. */
+        size_t client;
+        /** The event */
+        event evt;
+    };
+
+    /** The queue type for the events of all the clients */
+    using queue_type = thread_queue<client_event>;
+
+    /** The index for "no client" */
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /**
+     * The consumer queue given to each client, which tags its events and
+     * puts them into the shared queue.
+     */
+    class source;
+
+    /** The queue of events from all the clients, shared with the sources */
+    std::shared_ptr<queue_type> que_;
+    /** Lock for the clients */
+    mutable std::mutex lock_;
+    /** The clients, by index */
+    std::vector<async_client*> clis_;
+
+public:
+    /**
+     * Creates a mux.
+     * @param capacity The most events to hold. When the mux is full, the
+     *  			   callback threads of the clients block until there's
+     *  			   room.
+     */
+    explicit consumer_mux(size_t capacity = queue_type::MAX_CAPACITY);
+    /**
+     * Destroys the mux, closing the queue.
+     */
+    ~consumer_mux();
+
+    consumer_mux(const consumer_mux&) = delete;
+    consumer_mux& operator=(const consumer_mux&) = delete;
+
+    /**
+     * Adds a client, which starts consuming into the mux.
+     * This replaces any consumer queue that the client had.
+     * @param cli The client.
+     * @return The index of the client, which tags its events.
+     */
+    size_t add(async_client& cli);
+    /**
+     * Gets the number of clients that were added.
+     * @return The number of clients.
+     */
+    size_t size() const;
+    /**
+     * Gets one of the clients.
+     * @param idx The index of the client.
+     * @return A reference to the client.
+     * @throw std::out_of_range if the index is not valid.
+     */
+    async_client& get_client(size_t idx) const;
+    /**
+     * Reads the next event from any of the clients, waiting for one if
+     * needed.
+     * @return The event. After the mux is stopped, this is a shutdown
+     *  	   event, with a client index of @ref npos.
+     */
+    client_event consume_event();
+    /**
+     * Reads the next event from any of the clients, if there is one.
+     * @param evt Pointer to receive the event.
+     * @return @em true if there was an event, @em false if not.
+     */
+    bool try_consume_event(client_event* evt) { return que_->try_get(evt); }
+    /**
+     * Waits a limited time for an event from any of the clients.
+     * @param evt Pointer to receive the event.
+     * @param relTime The longest time to wait.
+     * @return @em true if there was an event, @em false on a timeout.
+     */
+    template <typename Rep, class Period>
+    bool try_consume_event_for(
+        client_event* evt, const std::chrono::duration<Rep, Period>& relTime
+    ) {
+        return que_->try_get_for(evt, relTime);
+    }
+    /**
+     * Reads up to a number of events, from any of the clients, without
+     * waiting, all under a single lock of the queue.
+     * @param evts The vector to receive the events, at the end.
+     * @param maxN The most events to read.
+     * @return The number of events read.
+     */
+    size_t try_consume_events(std::vector<client_event>& evts, size_t maxN) {
+        return que_->try_get_n(&evts, maxN);
+    }
+    /**
+     * Gets the number of events waiting in the queue.
+     * @return The number of events waiting.
+     */
+    size_t queue_size() const { return que_->size(); }
+    /**
+     * Stops the mux.
+     * This closes the queue, which releases any consumers waiting on it,
+     * once the events in it are read. Events that arrive after this are
+     * dropped.
+     */
+    void stop() { que_->close(); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_consumer_mux_h
@@ -24,10 +24,12 @@
 #ifndef __mqtt_create_options_h
 #define __mqtt_create_options_h
 
+#include <chrono>
 #include <variant>
 
 #include "MQTTAsync.h"
 #include "mqtt/iclient_persistence.h"
+#include "mqtt/thread_options.h"
 #include "mqtt/types.h"
 
 namespace mqtt {
@@ -70,11 +72,41 @@ class create_options
     /** The persistence for the client */
     persistence_type persistence_{};
 
+    /** Whether incoming messages adopt the C library buffers */
+    bool zeroCopy_{false};
+
+    /** The maximum number of topics to intern for incoming messages */
+    size_t maxInternedTopics_{0};
+
+    /** The group commit interval for user persistence (zero for none) */
+    std::chrono::milliseconds commitInterval_{0};
+
+    /** The buffered size that triggers a persistence group commit */
+    size_t commitBytes_{0};
+
+    /** The longest time to hold QoS 0 messages to coalesce (zero for none) */
+    std::chrono::microseconds coalesceDelay_{0};
+
+    /** The held size that triggers sending the coalesced messages */
+    size_t coalesceBytes_{0};
+
+    /** The most topic aliases to use for outgoing messages (zero for none) */
+    uint16_t maxTopicAliases_{0};
+
+    /** The options for the threads the client runs on */
+    thread_options threadOpts_;
+
+    /** The number of independently-locked parts of the token table */
+    size_t tokenTableShards_{DFLT_TOKEN_TABLE_SHARDS};
+
     /** The client and tests have special access */
     friend class async_client;
     friend class create_options_builder;
 
 public:
+    /** The default number of independently-locked parts of the token table */
+    static constexpr size_t DFLT_TOKEN_TABLE_SHARDS = 16;
+
     /** Smart/shared pointer to an object of this class. */
     using ptr_t = std::shared_ptr<create_options>;
     /** Smart/shared pointer to a const object of this class. */
@@ -165,7 +197,16 @@ public:
         : opts_{opts.opts_},
           serverURI_{serverURI},
           clientId_{clientId},
-          persistence_{persistence} {}
+          persistence_{persistence},
+          zeroCopy_{opts.zeroCopy_},
+          maxInternedTopics_{opts.maxInternedTopics_},
+          commitInterval_{opts.commitInterval_},
+          commitBytes_{opts.commitBytes_},
+          coalesceDelay_{opts.coalesceDelay_},
+          coalesceBytes_{opts.coalesceBytes_},
+          maxTopicAliases_{opts.maxTopicAliases_},
+          threadOpts_{opts.threadOpts_},
+          tokenTableShards_{opts.tokenTableShards_} {}
     /**
      * Copy constructor.
      * @param opts The other options.
@@ -174,7 +215,16 @@ public:
         : opts_{opts.opts_},
           serverURI_{opts.serverURI_},
           clientId_{opts.clientId_},
-          persistence_{opts.persistence_} {}
+          persistence_{opts.persistence_},
+          zeroCopy_{opts.zeroCopy_},
+          maxInternedTopics_{opts.maxInternedTopics_},
+          commitInterval_{opts.commitInterval_},
+          commitBytes_{opts.commitBytes_},
+          coalesceDelay_{opts.coalesceDelay_},
+          coalesceBytes_{opts.coalesceBytes_},
+          maxTopicAliases_{opts.maxTopicAliases_},
+          threadOpts_{opts.threadOpts_},
+          tokenTableShards_{opts.tokenTableShards_} {}
     /**
      * Move constructor.
      * @param opts The other options.
@@ -183,7 +233,16 @@ public:
         : opts_{opts.opts_},
           serverURI_{std::move(opts.serverURI_)},
           clientId_{std::move(opts.clientId_)},
-          persistence_{std::move(opts.persistence_)} {}
+          persistence_{std::move(opts.persistence_)},
+          zeroCopy_{opts.zeroCopy_},
+          maxInternedTopics_{opts.maxInternedTopics_},
+          commitInterval_{opts.commitInterval_},
+          commitBytes_{opts.commitBytes_},
+          coalesceDelay_{opts.coalesceDelay_},
+          coalesceBytes_{opts.coalesceBytes_},
+          maxTopicAliases_{opts.maxTopicAliases_},
+          threadOpts_{opts.threadOpts_},
+          tokenTableShards_{opts.tokenTableShards_} {}
 
     create_options& operator=(const create_options& rhs);
     create_options& operator=(create_options&& rhs);
@@ -298,6 +357,171 @@ public:
      * @param on @em true if QoS 0 messages are persisted, @em false if not.
      */
     void set_persist_qos0(bool on) { opts_.persistQoS0 = to_int(on); }
+    /**
+     * Whether incoming messages take ownership of the buffers allocated by
+     * the C library, rather than copying them.
+     * @return @em true if incoming messages adopt the C library buffers,
+     *  	   @em false if they are copied.
+     */
+    bool get_zero_copy_messages() const { return zeroCopy_; }
+    /**
+     * Determine whether incoming messages take ownership of the buffers
+     * allocated by the C library, rather than copying them.
+     *
+     * When on, the topic and payload of each incoming message refer
+     * directly to the memory from the C library, which is freed when the
+     * message is destroyed. Use the message's get_payload_ref() and
+     * get_topic_ref() to access the data without a copy. Getting them as
+     * strings will make a one-time copy.
+     * The properties are left in the C list until the app first reads
+     * them, so a message that's only routed by topic, or forwarded on
+     * as-is, is never copied.
+     *
+     * @param on @em true for incoming messages to adopt the C library
+     *  		 buffers, @em false to copy them.
+     */
+    void set_zero_copy_messages(bool on) { zeroCopy_ = on; }
+    /**
+     * Gets the maximum number of topics that the client will intern for
+     * incoming messages.
+     * @return The maximum number of topics to intern. Zero means that
+     *  	   topics are not interned.
+     */
+    size_t get_max_interned_topics() const { return maxInternedTopics_; }
+    /**
+     * Sets the maximum number of topics that the client will intern for
+     * incoming messages.
+     *
+     * When on, incoming messages on the same topic all share a single
+     * topic string, rather than allocating a new one for each message, so
+     * their topics can also be compared by pointer. Once the table is
+     * full, messages on new topics get their own copy of the string.
+     *
+     * @param n The maximum number of topics to intern. Zero, the default,
+     *  		turns interning off.
+     */
+    void set_max_interned_topics(size_t n) { maxInternedTopics_ = n; }
+    /**
+     * Gets the group commit interval for a user persistence store.
+     * @return The longest time that a change to the store is buffered.
+     *  	   Zero means that group commit is off.
+     */
+    std::chrono::milliseconds get_persistence_commit_interval() const {
+        return commitInterval_;
+    }
+    /**
+     * Gets the amount of buffered persistence data that triggers a group
+     * commit.
+     * @return The size threshold, in bytes. Zero means the default.
+     */
+    size_t get_persistence_commit_bytes() const { return commitBytes_; }
+    /**
+     * Sets up group commit for a user persistence store.
+     *
+     * When on, the client wraps the user persistence store in a
+     * @ref group_commit_persistence, which buffers the changes and writes
+     * them to the store in batches, with a single sync per batch. This
+     * greatly reduces the cost of persisting QoS 1 and 2 messages, but up
+     * to one interval of changes can be lost in a crash. This has no
+     * effect on the C library's file persistence.
+     *
+     * @param interval The longest time that a change is buffered. Zero,
+     *  			   the default, turns group commit off.
+     * @param maxBytes The amount of buffered data that triggers a commit.
+     *  			   Zero uses the default.
+     */
+    template <class Rep, class Period>
+    void set_persistence_group_commit(
+        const std::chrono::duration<Rep, Period>& interval, size_t maxBytes = 0
+    ) {
+        commitInterval_ = std::chrono::duration_cast<std::chrono::milliseconds>(interval);
+        commitBytes_ = maxBytes;
+    }
+    /**
+     * Gets the delay for coalescing outgoing QoS 0 messages.
+     * @return The longest time that a QoS 0 message is held to be sent
+     *  	   with others. Zero means that coalescing is off.
+     */
+    std::chrono::microseconds get_publish_coalescing_delay() const { return coalesceDelay_; }
+    /**
+     * Gets the amount of held QoS 0 data that triggers sending the
+     * coalesced messages.
+     * @return The size threshold, in bytes. Zero means the default.
+     */
+    size_t get_publish_coalescing_bytes() const { return coalesceBytes_; }
+    /**
+     * Sets up coalescing for outgoing QoS 0 messages.
+     *
+     * When on, the client holds the QoS 0 messages that it publishes in a
+     * @ref publish_coalescer, and hands them to the library in bursts,
+     * once the oldest one has waited for the delay, or once they add up to
+     * the size threshold. This can greatly raise the throughput of small,
+     * frequent messages, at the cost of up to one delay of added latency.
+     * Messages of other QoS levels are sent right away, and can overtake
+     * the held ones.
+     *
+     * @param delay The longest time that a message is held. Zero, the
+     *  			default, turns coalescing off.
+     * @param maxBytes The amount of held data that triggers sending the
+     *  			   messages. Zero uses the default.
+     */
+    template <class Rep, class Period>
+    void set_publish_coalescing(
+        const std::chrono::duration<Rep, Period>& delay, size_t maxBytes = 0
+    ) {
+        coalesceDelay_ = std::chrono::duration_cast<std::chrono::microseconds>(delay);
+        coalesceBytes_ = maxBytes;
+    }
+    /**
+     * Gets the most topic aliases that the client uses for outgoing
+     * messages.
+     * @return The most topic aliases to use. Zero means that automatic
+     *  	   topic aliasing is off.
+     */
+    uint16_t get_max_topic_aliases() const { return maxTopicAliases_; }
+    /**
+     * Sets up automatic topic aliasing for outgoing QoS 0 messages.
+     *
+     * When on, and connected with MQTT v5, the client assigns topic
+     * aliases to the topics that it publishes to, up to the lesser of this
+     * number and the Topic Alias Maximum from the server, reusing the
+     * aliases of the least recently used topics once they run out. After
+     * the first message to a topic, the rest are sent with only the alias,
+     * and an empty topic. The aliases are reset on each connection.
+     *
+     * @param n The most topic aliases to use. Zero, the default, turns
+     *  		automatic topic aliasing off.
+     * @sa topic_alias_manager
+     */
+    void set_max_topic_aliases(uint16_t n) { maxTopicAliases_ = n; }
+    /**
+     * Gets the options for the threads that the client runs on.
+     * @return The thread options.
+     */
+    const thread_options& get_thread_options() const { return threadOpts_; }
+    /**
+     * Sets the options for the threads that the client runs on, to name
+     * them, pin them to CPUs, or run a hook on each one as it starts.
+     * @param opts The thread options.
+     * @sa thread_options
+     */
+    void set_thread_options(thread_options opts) { threadOpts_ = std::move(opts); }
+    /**
+     * Gets the number of independently-locked parts of the client's table
+     * of pending tokens.
+     * @return The number of parts of the token table.
+     */
+    size_t get_token_table_shards() const { return tokenTableShards_; }
+    /**
+     * Sets the number of independently-locked parts of the client's table
+     * of pending tokens.
+     * More parts let the app's threads and the library's callback thread
+     * add and remove tokens with less contention, at a cost of a couple
+     * hundred bytes each. A process that runs a large number of lightly
+     * loaded clients can save a few kilobytes per client with just one.
+     * @param n The number of parts, which is rounded up to a power of two.
+     */
+    void set_token_table_shards(size_t n) { tokenTableShards_ = n; }
 };
 
 /** Smart/shared pointer to a connection options object. */
@@ -411,6 +635,88 @@ public:
         opts_.opts_.persistQoS0 = to_int(on);
         return *this;
     }
+    /**
+     * Whether incoming messages take ownership of the buffers allocated by
+     * the C library, rather than copying them. (Defaults false)
+     *
+     * @param on @em true for incoming messages to adopt the C library
+     *  		 buffers, @em false to copy them.
+     * @return A reference to this object
+     */
+    auto zero_copy_messages(bool on = true) -> self& {
+        opts_.zeroCopy_ = on;
+        return *this;
+    }
+    /**
+     * Sets the maximum number of topics that the client will intern for
+     * incoming messages. (Defaults zero, for no interning)
+     *
+     * @param n The maximum number of topics to intern.
+     * @return A reference to this object
+     */
+    auto max_interned_topics(size_t n) -> self& {
+        opts_.maxInternedTopics_ = n;
+        return *this;
+    }
+    /**
+     * Sets up group commit for a user persistence store.
+     * @param interval The longest time that a change is buffered. Zero,
+     *  			   the default, turns group commit off.
+     * @param maxBytes The amount of buffered data that triggers a commit.
+     *  			   Zero uses the default.
+     * @return A reference to this object
+     */
+    template <class Rep, class Period>
+    auto persistence_group_commit(
+        const std::chrono::duration<Rep, Period>& interval, size_t maxBytes = 0
+    ) -> self& {
+        opts_.set_persistence_group_commit(interval, maxBytes);
+        return *this;
+    }
+    /**
+     * Sets up coalescing for outgoing QoS 0 messages.
+     * @param delay The longest time that a message is held. Zero, the
+     *  			default, turns coalescing off.
+     * @param maxBytes The amount of held data that triggers sending the
+     *  			   messages. Zero uses the default.
+     * @return A reference to this object
+     */
+    template <class Rep, class Period>
+    auto publish_coalescing(
+        const std::chrono::duration<Rep, Period>& delay, size_t maxBytes = 0
+    ) -> self& {
+        opts_.set_publish_coalescing(delay, maxBytes);
+        return *this;
+    }
+    /**
+     * Sets up automatic topic aliasing for outgoing QoS 0 messages.
+     * @param n The most topic aliases to use. Zero, the default, turns
+     *  		automatic topic aliasing off.
+     * @return A reference to this object
+     */
+    auto max_topic_aliases(uint16_t n) -> self& {
+        opts_.set_max_topic_aliases(n);
+        return *this;
+    }
+    /**
+     * Sets the options for the threads that the client runs on.
+     * @param opts The thread options.
+     * @return A reference to this object
+     */
+    auto thread_options(mqtt::thread_options opts) -> self& {
+        opts_.set_thread_options(std::move(opts));
+        return *this;
+    }
+    /**
+     * Sets the number of independently-locked parts of the client's table
+     * of pending tokens.
+     * @param n The number of parts, which is rounded up to a power of two.
+     * @return A reference to this object
+     */
+    auto token_table_shards(size_t n) -> self& {
+        opts_.set_token_table_shards(n);
+        return *this;
+    }
     /**
      * Finish building the options and return them.
      * @return The option struct as built.
@@ -0,0 +1,120 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file deflate_codec.h
+/// Declaration of MQTT deflate_codec class, a payload codec that uses
+/// zlib.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_deflate_codec_h
+#define __mqtt_deflate_codec_h
+
+#include <memory>
+
+#include "mqtt/payload_codec.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A payload codec that compresses with zlib's deflate.
+ *
+ * This is only in the library when it's built with the CMake option
+ * `PAHO_WITH_ZLIB`.
+ * @par
+ * A preset dictionary, with the strings that are common to the payloads,
+ * like the keys of a JSON schema, can greatly improve the compression of
+ * small payloads. Both ends must use the same dictionary, so a codec with
+ * one has a different name, which includes the dictionary's checksum, and
+ * a receiver without the dictionary leaves those payloads alone.
+ */
+class deflate_codec : public payload_codec
+{
+    /** The compression level */
+    int level_;
+    /** The preset dictionary (if any) */
+    binary dict_;
+    /** The name of the codec */
+    string name_;
+
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<const deflate_codec>;
+
+    /** The name of the codec, without a dictionary */
+    static constexpr const char* NAME = "deflate";
+    /** The default compression level, which is zlib's default */
+    static constexpr int DFLT_LEVEL = -1;
+
+    /**
+     * Creates a codec.
+     * @param level The compression level, from 1, for the fastest, to 9,
+     *  			for the smallest, or -1 for zlib's default.
+     * @param dict A preset dictionary, or empty for none.
+     */
+    explicit deflate_codec(int level = DFLT_LEVEL, const binary& dict = binary());
+    /**
+     * Creates a shared codec.
+     * @param level The compression level.
+     * @param dict A preset dictionary, or empty for none.
+     * @return A shared pointer to the codec.
+     */
+    static ptr_t create(int level = DFLT_LEVEL, const binary& dict = binary()) {
+        return std::make_shared<const deflate_codec>(level, dict);
+    }
+    /**
+     * Gets the compression level.
+     * @return The compression level.
+     */
+    int get_level() const { return level_; }
+    /**
+     * Gets the preset dictionary.
+     * @return The preset dictionary, or empty if there isn't one.
+     */
+    const binary& get_dictionary() const { return dict_; }
+    /**
+     * Gets the name of the codec.
+     * @return "deflate", or "deflate-<checksum>" with a dictionary, where
+     *  	   the checksum is the dictionary's Adler-32, in hex.
+     */
+    string name() const override { return name_; }
+    /**
+     * Compresses a payload.
+     * @param data The payload.
+     * @return The compressed payload.
+     */
+    binary encode(const binary& data) const override;
+    /**
+     * Decompresses a payload.
+     * @param data The compressed payload.
+     * @return The payload.
+     * @throw exception if the data is corrupt, or needs a different
+     *  	  dictionary.
+     */
+    binary decode(const binary& data) const override;
+};
+
+/** Smart/shared pointer to a deflate_codec */
+using deflate_codec_ptr = deflate_codec::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_deflate_codec_h
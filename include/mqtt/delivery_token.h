@@ -24,9 +24,11 @@
 #ifndef __mqtt_delivery_token_h
 #define __mqtt_delivery_token_h
 
+#include <chrono>
 #include <memory>
 
 #include "MQTTAsync.h"
+#include "mqtt/inflight_window.h"
 #include "mqtt/message.h"
 #include "mqtt/token.h"
 
@@ -43,6 +45,14 @@ class delivery_token : public token
 {
     /** The message being tracked. */
     const_message_ptr msg_;
+    /** When the message was handed to the library, for QoS 1 and 2 */
+    std::chrono::steady_clock::time_point sendTime_{};
+    /** The trace context for the message, if it's being traced */
+    string traceCtx_;
+    /** The number of times the message was retried */
+    unsigned retries_{0};
+    /** The in-flight window that the message has a slot in (if any) */
+    inflight_window_ptr window_;
 
     /** Client has special access. */
     friend class async_client;
@@ -72,7 +82,7 @@ public:
      * @param msg The message being tracked.
      */
     delivery_token(iasync_client& cli, const_message_ptr msg)
-        : token(token::Type::PUBLISH, cli, msg->get_topic()), msg_(std::move(msg)) {}
+        : token(token::Type::PUBLISH, cli), msg_(std::move(msg)) {}
     /**
      * Creates a delivery token connected to a particular client.
      * @param cli The asynchronous client object.
@@ -86,20 +96,20 @@ public:
     delivery_token(
         iasync_client& cli, const_message_ptr msg, void* userContext, iaction_listener& cb
     )
-        : token(token::Type::PUBLISH, cli, msg->get_topic(), userContext, cb),
+        : token(token::Type::PUBLISH, cli, userContext, cb),
           msg_(std::move(msg)) {}
     /**
      * Creates an empty delivery token connected to a particular client.
      * @param cli The asynchronous client object.
      */
-    static ptr_t create(iasync_client& cli) { return std::make_shared<delivery_token>(cli); }
+    static ptr_t create(iasync_client& cli) { return make_pooled<delivery_token>(cli); }
     /**
      * Creates a delivery token connected to a particular client.
      * @param cli The asynchronous client object.
      * @param msg The message data.
      */
     static ptr_t create(iasync_client& cli, const_message_ptr msg) {
-        return std::make_shared<delivery_token>(cli, msg);
+        return make_pooled<delivery_token>(cli, msg);
     }
     /**
      * Creates a delivery token connected to a particular client.
@@ -114,13 +124,36 @@ public:
     static ptr_t create(
         iasync_client& cli, const_message_ptr msg, void* userContext, iaction_listener& cb
     ) {
-        return std::make_shared<delivery_token>(cli, msg, userContext, cb);
+        return make_pooled<delivery_token>(cli, msg, userContext, cb);
     }
     /**
      * Gets the message associated with this token.
      * @return The message associated with this token.
      */
     virtual const_message_ptr get_message() const { return msg_; }
+    /**
+     * Gets the trace context of the message, if the client has a
+     * message_tracer.
+     * @return The trace context of the message, or an empty string if it
+     *  	   isn't being traced.
+     */
+    const string& get_trace_context() const { return traceCtx_; }
+    /**
+     * Gets the number of times the message was retried, if the client
+     * retries failed publishes.
+     * @return The number of times the message was retried.
+     */
+    unsigned get_retries() const { return retries_; }
+    /**
+     * Gets the topic of the message being tracked.
+     * The collection is only built when it's requested, so that publishing
+     * a message doesn't need to allocate one.
+     * @return A collection with the topic of the message, or @em nullptr
+     *  	   if there is no message.
+     */
+    const_string_collection_ptr get_topics() const override {
+        return msg_ ? string_collection::create(msg_->get_topic()) : nullptr;
+    }
 };
 
 /** Smart/shared pointer to a delivery_token */
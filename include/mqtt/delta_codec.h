@@ -0,0 +1,250 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file delta_codec.h
+/// Declaration of MQTT delta_codec class, which sends the payloads of a
+/// topic as deltas from the one before, with periodic keyframes.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_delta_codec_h
+#define __mqtt_delta_codec_h
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "mqtt/message.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Sends the payloads of each topic as deltas from the previous payload on
+ * the topic, for devices that send large, mostly unchanged documents.
+ *
+ * The sending side keeps the last payload of each topic. When the next
+ * one is the same size, it's sent as the bytes that changed: the XOR of
+ * the two payloads, with the runs of zeros, for the bytes that didn't
+ * change, sent as just their length. Every so often, and whenever the
+ * size changes, the delta wouldn't be smaller, or the message is
+ * retained, the whole payload is sent instead, as a keyframe.
+ * @par
+ * Each MQTT v5 message is marked with a user property,
+ * @ref DELTA_PROPERTY, with a 'k' for a keyframe or a 'd' for a delta,
+ * followed by its sequence number on the topic. The receiving side keeps
+ * the last payload of each topic as well, and rebuilds each payload from
+ * the delta and the one before it. A delta that doesn't follow the last
+ * payload that was seen, because a message was lost or came out of order,
+ * can't be rebuilt, and is dropped, as are the ones after it until the
+ * next keyframe.
+ * @par
+ * A codec is installed on an async_client with
+ * `async_client::set_delta_codec()`, which encodes each message that's
+ * published as it's handed to the library, and decodes the ones that
+ * arrive, in the order they arrive. A message that's held back, by the
+ * offline buffer, a rate limiter, or a retry, is encoded when it's
+ * finally sent, and one that the library refuses, or that's dropped
+ * before it's sent, doesn't count as the last payload of its topic, so
+ * the receiver doesn't see a gap. The same codec can be used for both
+ * directions, since it keeps the payloads of each direction apart. The
+ * deltas are taken before any @ref payload_codec compresses the payload,
+ * which squeezes them further.
+ */
+class delta_codec
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<delta_codec>;
+
+    /** The name of the user property that marks a keyframe or delta */
+    static constexpr const char* DELTA_PROPERTY = "delta-frame";
+    /** The default number of messages on a topic between keyframes */
+    static constexpr unsigned DFLT_KEY_INTERVAL = 30;
+
+private:
+    /** The last payload of a topic */
+    struct state
+    {
+        /** The sequence number of the payload */
+        uint64_t seq{0};
+        /** The payload */
+        binary_ref payload;
+        /** The number of messages since the last keyframe */
+        unsigned sinceKey{0};
+    };
+
+    /** A message that was encoded, but isn't yet the last one on its topic */
+    struct frame
+    {
+        /** The message to send */
+        const_message_ptr msg;
+        /** The state of the topic, or null if the message was left as is */
+        state* st;
+        /** The state of the topic once the message is sent */
+        state next;
+        /** Whether the message is a keyframe */
+        bool key;
+    };
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** The number of messages between keyframes */
+    const unsigned keyInterval_;
+    /** Lock for the sending side */
+    mutable std::mutex sendLock_;
+    /** The last payloads that were sent, by topic */
+    std::unordered_map<string, state> sent_;
+    /** Lock for the receiving side */
+    mutable std::mutex recvLock_;
+    /** The last payloads that were received, by topic */
+    std::unordered_map<string, state> received_;
+    /** The number of keyframes sent */
+    uint64_t nKeyframes_{0};
+    /** The number of deltas sent */
+    uint64_t nDeltas_{0};
+    /** The number of deltas received that couldn't be rebuilt */
+    uint64_t nUnresolved_{0};
+
+    /** Makes a copy of the message with a new payload and frame marker */
+    static message_ptr with_frame(
+        const message& msg, binary_ref payload, char kind, uint64_t seq
+    );
+    /** Encodes a message, without changing the state. Call with the send lock. */
+    frame prepare(const const_message_ptr& msg);
+    /** Makes an encoded message the last one on its topic. Call with the send lock. */
+    void commit(frame& fr);
+
+public:
+    /**
+     * Creates a codec.
+     * @param keyInterval The number of messages on a topic from one
+     *  				  keyframe to the next. A value of one sends
+     *  				  every payload whole.
+     */
+    explicit delta_codec(unsigned keyInterval = DFLT_KEY_INTERVAL)
+        : keyInterval_{keyInterval ? keyInterval : 1} {}
+
+    delta_codec(const delta_codec&) = delete;
+    delta_codec& operator=(const delta_codec&) = delete;
+
+    /**
+     * Makes the delta that turns one payload into another of the same
+     * size.
+     * @param prev The previous payload.
+     * @param cur The current payload, the same size as @a prev.
+     * @return The delta.
+     */
+    static binary make_delta(const binary& prev, const binary& cur);
+    /**
+     * Rebuilds a payload from the one before it and a delta.
+     * @param prev The previous payload.
+     * @param delta The delta from make_delta().
+     * @param out Gets the rebuilt payload.
+     * @return @em true if the payload was rebuilt, @em false if the delta
+     *  	   is malformed, or doesn't fit the previous payload.
+     */
+    static bool apply_delta(const binary& prev, const binary& delta, binary& out);
+    /**
+     * Encodes a message that's about to be sent, taking it as sent.
+     * A message that's already marked with the @ref DELTA_PROPERTY is
+     * left as it is.
+     * @param msg The message.
+     * @return The message to send, which is either a keyframe or a delta.
+     *  	   This is a copy, so the original message is untouched.
+     */
+    const_message_ptr encode(const_message_ptr msg) {
+        return encode(std::move(msg), [](const const_message_ptr&) { return true; });
+    }
+    /**
+     * Encodes a message and sends it.
+     *
+     * The message only becomes the last payload of its topic, for the
+     * next delta, if it's sent. The codec is locked while it's being
+     * sent, so the frames go out in the order of their sequence numbers,
+     * whatever thread sends them.
+     *
+     * @param msg The message.
+     * @param send The function that sends the encoded message, returning
+     *  		   @em true if it was accepted. It's called with the
+     *  		   codec locked, so it mustn't call back into the codec.
+     * @return The encoded message that was passed to @a send.
+     */
+    template <class Func>
+    const_message_ptr encode(const_message_ptr msg, Func&& send) {
+        if (!msg)
+            return msg;
+
+        guard g{sendLock_};
+        auto fr = prepare(msg);
+        if (send(fr.msg))
+            commit(fr);
+        return std::move(fr.msg);
+    }
+    /**
+     * Decodes a message that arrived.
+     * A message without the @ref DELTA_PROPERTY is passed through as it
+     * is.
+     * @param msg The message.
+     * @return The message with the whole payload, without the frame
+     *  	   marker, or a null pointer if it's a delta that can't be
+     *  	   rebuilt.
+     */
+    const_message_ptr decode(const_message_ptr msg);
+    /**
+     * Forgets the last payloads of all the topics, in both directions.
+     * The next message sent on each topic is a keyframe.
+     */
+    void clear();
+    /**
+     * Gets the number of keyframes that were sent.
+     * @return The number of keyframes sent.
+     */
+    uint64_t num_keyframes() const {
+        guard g{sendLock_};
+        return nKeyframes_;
+    }
+    /**
+     * Gets the number of deltas that were sent.
+     * @return The number of deltas sent.
+     */
+    uint64_t num_deltas() const {
+        guard g{sendLock_};
+        return nDeltas_;
+    }
+    /**
+     * Gets the number of deltas that arrived and couldn't be rebuilt.
+     * @return The number of deltas dropped.
+     */
+    uint64_t num_unresolved() const {
+        guard g{recvLock_};
+        return nUnresolved_;
+    }
+};
+
+/** Smart/shared pointer to a delta_codec */
+using delta_codec_ptr = delta_codec::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_delta_codec_h
@@ -0,0 +1,290 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file dispatcher.h
+/// Declaration of MQTT dispatcher class, which hands incoming messages off
+/// to a pool of worker threads while preserving the order of messages for
+/// each topic.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_dispatcher_h
+#define __mqtt_dispatcher_h
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mqtt/message.h"
+#include "mqtt/thread_queue.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Dispatches messages to a pool of worker threads.
+ *
+ * Each worker thread has its own queue. Every message is assigned to a
+ * worker by hashing a key taken from the message, which by default is the
+ * topic. Messages with the same key therefore always go to the same worker
+ * and are handled in the order that they were dispatched, while messages
+ * with different keys can be handled in parallel.
+ *
+ * The dispatcher is normally used by the async_client, through
+ * `async_client::start_dispatching()`, to move the processing of incoming
+ * messages off of the library's callback thread, although it can be used
+ * on its own.
+ *
+ * Any exception that escapes the handler is caught and discarded by the
+ * worker thread, which goes on to the next message.
+ */
+class dispatcher
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<dispatcher>;
+    /** The handler called by the worker threads for each message */
+    using handler_type = std::function<void(const_message_ptr)>;
+    /** A function to get the key used to assign a message to a worker */
+    using key_function = std::function<std::size_t(const message&)>;
+    /** The message queue for each worker */
+    using queue_type = thread_queue<const_message_ptr>;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Lock for starting and stopping the workers */
+    mutable std::mutex lock_;
+    /** The handler for the messages */
+    handler_type handler_;
+    /** The function to get the key for a message */
+    key_function keyFunc_;
+    /** The queue for each worker */
+    std::vector<std::unique_ptr<queue_type>> ques_;
+    /** The worker threads */
+    std::vector<std::thread> thrs_;
+
+    /** The function run by each worker thread */
+    void run(queue_type& que);
+
+public:
+    /**
+     * Creates a dispatcher and starts the worker threads.
+     * @param nThreads The number of worker threads. If this is zero, a
+     *  			   single thread is used.
+     * @param handler The handler called by the workers for each message.
+     * @param keyFunc The function to get the key used to assign a message to
+     *  			  a worker. If empty, the hash of the topic is used.
+     * @param queCap The capacity of each worker's queue. When a queue is
+     *  			 full, dispatching a message to it blocks until there
+     *  			 is room.
+     */
+    dispatcher(
+        std::size_t nThreads, handler_type handler, key_function keyFunc = key_function{},
+        std::size_t queCap = queue_type::MAX_CAPACITY
+    );
+    /**
+     * Destroys the dispatcher.
+     * This stops the workers, after they handle any queued messages.
+     */
+    ~dispatcher();
+
+    dispatcher(const dispatcher&) = delete;
+    dispatcher& operator=(const dispatcher&) = delete;
+
+    /**
+     * Gets the number of worker threads.
+     * @return The number of worker threads.
+     */
+    std::size_t num_threads() const { return ques_.size(); }
+    /**
+     * Gets the index of the worker that handles the message.
+     * @param msg The message.
+     * @return The index of the worker that handles the message.
+     */
+    std::size_t worker_index(const message& msg) const {
+        return (keyFunc_ ? keyFunc_(msg) : std::hash<string>{}(msg.get_topic())) %
+               ques_.size();
+    }
+    /**
+     * Gets the number of messages waiting to be handled by all the workers.
+     * @return The number of messages waiting to be handled.
+     */
+    std::size_t size() const;
+    /**
+     * Determines if the dispatcher has been stopped.
+     * @return @em true if the dispatcher was stopped, @em false otherwise.
+     */
+    bool stopped() const;
+    /**
+     * Hands a message off to its worker.
+     * @param msg The message.
+     * @return @em true if the message was queued, @em false if the
+     *  	   dispatcher was stopped.
+     */
+    bool dispatch(const_message_ptr msg);
+    /**
+     * Stops the dispatcher.
+     * No more messages are accepted. This waits for the workers to handle
+     * any messages already in their queues, then joins the threads. It is
+     * safe to call this more than once, but not from a worker thread.
+     */
+    void stop();
+};
+
+/** Smart/shared pointer to a dispatcher */
+using dispatcher_ptr = dispatcher::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Dispatches messages to a pool of worker threads that share the load by
+ * stealing work from each other.
+ *
+ * Each worker has its own queue, and a message is placed on the queue
+ * picked by the caller, such as an index for the source of the message.
+ * A worker handles the messages in its own queue first, oldest to newest.
+ * When its queue is empty, it takes the newest message from the queue of
+ * another worker that is falling behind. So, unlike the @ref dispatcher,
+ * this doesn't preserve the order of messages from the same source, but a
+ * burst of messages on one queue is spread across all of the workers.
+ * @par
+ * The queues are unbounded. Workers only sleep when all of the queues are
+ * empty, and are only woken when there are sleeping workers.
+ * @par
+ * Any exception that escapes the handler is caught and discarded by the
+ * worker thread, which goes on to the next message.
+ */
+class work_stealing_dispatcher
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<work_stealing_dispatcher>;
+    /** The handler called by the worker threads for each message */
+    using handler_type = std::function<void(const_message_ptr)>;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** Lock guard that can be used for waiting */
+    using unique_lock = std::unique_lock<std::mutex>;
+
+    /** The queue for a single worker */
+    struct worker_queue
+    {
+        /** Lock for the queue */
+        std::mutex lock;
+        /** The messages waiting for the worker */
+        std::deque<const_message_ptr> msgs;
+        /** The number of messages, which can be read without the lock */
+        std::atomic<std::size_t> size{0};
+    };
+
+    /** The handler for the messages */
+    handler_type handler_;
+    /** The queue for each worker */
+    std::vector<std::unique_ptr<worker_queue>> ques_;
+    /** The worker threads */
+    std::vector<std::thread> thrs_;
+    /** The number of messages in all the queues */
+    std::atomic<std::size_t> nPending_{0};
+    /** The number of messages taken by workers from other queues */
+    std::atomic<std::size_t> nStolen_{0};
+    /** Whether the dispatcher was stopped */
+    std::atomic<bool> stopped_{false};
+    /** The number of workers waiting for a message */
+    std::atomic<int> nIdle_{0};
+    /** Lock for the idle workers, and for starting and stopping */
+    mutable std::mutex lock_;
+    /** Condition signaled when a message is added or the dispatcher stops */
+    std::condition_variable cond_;
+
+    /** Gets a message for the worker, from its own queue or another */
+    bool try_take(std::size_t idx, const_message_ptr* msg);
+    /** The function run by each worker thread */
+    void run(std::size_t idx);
+
+public:
+    /**
+     * Creates a dispatcher and starts the worker threads.
+     * @param nThreads The number of worker threads. If this is zero, a
+     *  			   thread is used for each hardware core.
+     * @param handler The handler called by the workers for each message.
+     */
+    work_stealing_dispatcher(std::size_t nThreads, handler_type handler);
+    /**
+     * Destroys the dispatcher.
+     * This stops the workers, after they handle any queued messages.
+     */
+    ~work_stealing_dispatcher();
+
+    work_stealing_dispatcher(const work_stealing_dispatcher&) = delete;
+    work_stealing_dispatcher& operator=(const work_stealing_dispatcher&) = delete;
+
+    /**
+     * Gets the number of worker threads.
+     * @return The number of worker threads.
+     */
+    std::size_t num_threads() const { return ques_.size(); }
+    /**
+     * Gets the number of messages waiting to be handled by all the workers.
+     * @return The number of messages waiting to be handled.
+     */
+    std::size_t size() const { return nPending_; }
+    /**
+     * Gets the number of messages that were handled by a worker other than
+     * the one that they were dispatched to.
+     * @return The number of stolen messages.
+     */
+    std::size_t num_stolen() const { return nStolen_; }
+    /**
+     * Determines if the dispatcher has been stopped.
+     * @return @em true if the dispatcher was stopped, @em false otherwise.
+     */
+    bool stopped() const { return stopped_; }
+    /**
+     * Hands a message off to a worker.
+     * @param msg The message.
+     * @param hint Selects the queue for the message, modulo the number of
+     *  		   workers.
+     * @return @em true if the message was queued, @em false if the
+     *  	   dispatcher was stopped.
+     */
+    bool dispatch(const_message_ptr msg, std::size_t hint = 0);
+    /**
+     * Stops the dispatcher.
+     * No more messages are accepted. This waits for the workers to handle
+     * any messages already in the queues, then joins the threads. It is
+     * safe to call this more than once, but not from a worker thread.
+     */
+    void stop();
+};
+
+/** Smart/shared pointer to a work-stealing dispatcher */
+using work_stealing_dispatcher_ptr = work_stealing_dispatcher::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_dispatcher_h
@@ -0,0 +1,203 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file duplicate_filter.h
+/// Declaration of MQTT duplicate_filter class, which spots incoming
+/// messages that were already received.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_duplicate_filter_h
+#define __mqtt_duplicate_filter_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "MQTTAsync.h"
+#include "mqtt/message.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Spots the incoming messages that were already received, such as the
+ * QoS 1 messages that the server sends again after a reconnect.
+ *
+ * The messages are keyed in one of two ways:
+ *
+ * @li By topic and packet ID, the default. The server can reuse a packet
+ *  	ID once the message is acknowledged, so only a message that has
+ *  	the @em dup flag set, which marks a redelivery, is taken as a
+ *  	duplicate.
+ * @li By the value of a user property, such as a unique ID that the
+ *  	publisher puts in each message. Any message with a key that was
+ *  	seen is a duplicate. Messages without the property are let through.
+ *
+ * The keys are held in a pair of Bloom filters, each sized for the window
+ * of messages. New keys go in the current one, and when it has a window's
+ * worth, the older one is cleared and they swap. So the keys of at least
+ * the last window of messages are remembered, in a fixed amount of
+ * memory, at the cost of a small chance, about twice the false positive
+ * rate, of a new message being taken for a duplicate.
+ * @par
+ * The filter is normally installed on a client with
+ * `async_client::set_duplicate_filter()`, which drops the duplicates
+ * before they are queued or dispatched.
+ */
+class duplicate_filter
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<duplicate_filter>;
+
+    /** The default number of messages in the window */
+    static constexpr std::size_t DFLT_WINDOW = 16 * 1024;
+    /** The default false positive rate of each Bloom filter */
+    static constexpr double DFLT_FALSE_POSITIVE_RATE = 1.0e-4;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** A Bloom filter for a window of keys */
+    struct generation
+    {
+        /** The bits of the filter */
+        std::vector<uint64_t> bits;
+        /** The number of keys in the filter */
+        std::size_t n{0};
+    };
+
+    /** The name of the user property with the key, or empty for the ID */
+    const string propName_;
+    /** The number of messages in the window */
+    const std::size_t window_;
+    /** The false positive rate of each filter */
+    const double fpRate_;
+    /** The number of bits in each filter */
+    std::size_t nBits_;
+    /** The number of hashes for each key */
+    unsigned nHashes_;
+
+    /** Lock for the filters */
+    mutable std::mutex lock_;
+    /** The current and previous filters */
+    generation gens_[2];
+    /** The index of the current filter */
+    int cur_{0};
+
+    /** The number of messages checked */
+    std::atomic<uint64_t> nChecked_{0};
+    /** The number of duplicates found */
+    std::atomic<uint64_t> nDropped_{0};
+
+    /** Sizes the filters */
+    void init();
+    /** Gets the hash of the key for a message, if it has one */
+    bool get_key(std::string_view topic, const MQTTAsync_message& cmsg, uint64_t& key) const;
+    /** Determines if a key is in a filter */
+    bool contains(const generation& gen, uint64_t key) const;
+    /** Adds a key to a filter */
+    void add(generation& gen, uint64_t key);
+
+public:
+    /**
+     * Creates a filter keyed by topic and packet ID.
+     * @param window The number of messages to remember, at least.
+     * @param fpRate The false positive rate of each Bloom filter.
+     */
+    explicit duplicate_filter(
+        std::size_t window = DFLT_WINDOW, double fpRate = DFLT_FALSE_POSITIVE_RATE
+    );
+    /**
+     * Creates a filter keyed by a user property.
+     * @param propName The name of the user property with the key.
+     * @param window The number of messages to remember, at least.
+     * @param fpRate The false positive rate of each Bloom filter.
+     */
+    explicit duplicate_filter(
+        const string& propName, std::size_t window = DFLT_WINDOW,
+        double fpRate = DFLT_FALSE_POSITIVE_RATE
+    );
+
+    duplicate_filter(const duplicate_filter&) = delete;
+    duplicate_filter& operator=(const duplicate_filter&) = delete;
+
+    /**
+     * Gets the name of the user property with the key.
+     * @return The name of the property, or an empty string if messages are
+     *  	   keyed by topic and packet ID.
+     */
+    const string& get_property_name() const { return propName_; }
+    /**
+     * Gets the number of messages in the window.
+     * @return The number of messages in the window.
+     */
+    std::size_t get_window() const { return window_; }
+    /**
+     * Gets the false positive rate of each Bloom filter.
+     * @return The false positive rate.
+     */
+    double get_false_positive_rate() const { return fpRate_; }
+    /**
+     * Gets the memory used by the Bloom filters.
+     * @return The number of bytes in the filters.
+     */
+    std::size_t memory_size() const { return 2 * (nBits_ / 8); }
+    /**
+     * Checks a message from the C library, and remembers it.
+     * @param topic The topic of the message.
+     * @param cmsg The C message.
+     * @return @em true if it's a duplicate, @em false if not.
+     */
+    bool check(std::string_view topic, const MQTTAsync_message& cmsg);
+    /**
+     * Checks a message, and remembers it.
+     * @param msg The message.
+     * @return @em true if it's a duplicate, @em false if not.
+     */
+    bool check(const message& msg) { return check(msg.get_topic(), msg.msg_); }
+    /**
+     * Forgets all of the messages.
+     */
+    void clear();
+    /**
+     * Gets the number of messages that were checked.
+     * @return The number of messages checked.
+     */
+    uint64_t num_checked() const { return nChecked_.load(std::memory_order_relaxed); }
+    /**
+     * Gets the number of messages that were found to be duplicates.
+     * @return The number of duplicates.
+     */
+    uint64_t num_dropped() const { return nDropped_.load(std::memory_order_relaxed); }
+};
+
+/** Smart/shared pointer to a duplicate_filter */
+using duplicate_filter_ptr = duplicate_filter::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_duplicate_filter_h
@@ -0,0 +1,212 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file endpoint_racer.h
+/// Declaration of MQTT endpoint_racer class, which picks the server to
+/// connect to by racing staggered TCP connects to a list of them.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_endpoint_racer_h
+#define __mqtt_endpoint_racer_h
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "mqtt/connect_options.h"
+#include "mqtt/string_collection.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Picks which of a list of servers to connect to, by racing TCP connects
+ * to all of them, "happy eyeballs" style, and remembers how fast each one
+ * was, so that the fastest is tried first the next time.
+ *
+ * The C library tries the servers of the connect options one after the
+ * other, and a server that is black-holed costs the full connect timeout
+ * before the next is tried. The racer starts a non-blocking connect to
+ * the most preferred server, then to the next one after a short stagger,
+ * and so on, until one of them completes. The sockets are then closed,
+ * and the servers are put in order for the real connect, with the winner
+ * first.
+ * @code
+ * auto racer = std::make_shared<mqtt::endpoint_racer>();
+ * racer->apply(connOpts);
+ * cli.connect(connOpts)->wait();
+ * @endcode
+ * @par
+ * Only the TCP connect is raced, not the MQTT one. Racing full connects
+ * with the same client ID would have the servers taking the session from
+ * each other, and would cost a TLS handshake and CONNACK for each loser.
+ * @par
+ * The preference order is the known servers, fastest first by a moving
+ * average of their connect times, then the ones not tried yet, in the
+ * order they were listed, then the ones that failed, fewest failures
+ * first. A racer can be given to a reconnect_policy to order the servers
+ * before each reconnect attempt.
+ * @par
+ * This is only available on POSIX systems.
+ */
+class endpoint_racer
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<endpoint_racer>;
+    /** The clock for the connect times */
+    using clock = std::chrono::steady_clock;
+    /** The type for the connect times */
+    using duration = std::chrono::microseconds;
+
+    /** The default wait before starting the connect to the next server */
+    static constexpr std::chrono::milliseconds DFLT_STAGGER{250};
+    /** The default longest time for a race */
+    static constexpr std::chrono::milliseconds DFLT_TIMEOUT{5000};
+    /** The weight of the latest connect time in the moving average */
+    static constexpr double DFLT_SMOOTHING = 0.3;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** What's known about a server */
+    struct history
+    {
+        /** The moving average of the connect times */
+        std::optional<duration> latency;
+        /** The number of failures since the last success */
+        unsigned nFailed{0};
+    };
+
+    /** The wait before starting the connect to the next server */
+    std::chrono::milliseconds stagger_;
+    /** The longest time for a race */
+    std::chrono::milliseconds timeout_;
+    /** The weight of the latest connect time in the moving average */
+    double smoothing_{DFLT_SMOOTHING};
+    /** Lock for the history */
+    mutable std::mutex lock_;
+    /** What's known about each server, by URI */
+    std::map<string, history> hist_;
+
+public:
+    /**
+     * Creates a racer.
+     * @param stagger The wait before starting the connect to the next
+     *  			  server, if the earlier ones haven't completed.
+     * @param timeout The longest time for a race.
+     */
+    explicit endpoint_racer(
+        std::chrono::milliseconds stagger = DFLT_STAGGER,
+        std::chrono::milliseconds timeout = DFLT_TIMEOUT
+    )
+        : stagger_{std::max(stagger, std::chrono::milliseconds::zero())},
+          timeout_{std::max(timeout, std::chrono::milliseconds::zero())} {}
+    /**
+     * Gets the wait before starting the connect to the next server.
+     * @return The stagger between connects.
+     */
+    std::chrono::milliseconds get_stagger() const { return stagger_; }
+    /**
+     * Gets the longest time for a race.
+     * @return The timeout for a race.
+     */
+    std::chrono::milliseconds get_timeout() const { return timeout_; }
+    /**
+     * Sets the weight of the latest connect time in the moving average.
+     * @param w The weight, from just over 0.0, to barely change the
+     *  		average, to 1.0, to only keep the latest time.
+     */
+    void set_smoothing(double w) { smoothing_ = std::min(std::max(w, 0.01), 1.0); }
+    /**
+     * Gets the host and port of a server URI.
+     * The port defaults to the one for the scheme, like 1883 for "tcp://"
+     * and 8883 for "ssl://". An IPv6 host is given in brackets, as in
+     * "tcp://[::1]:1883".
+     * @param uri The server URI.
+     * @param host Gets the host name or address.
+     * @param port Gets the port.
+     * @return @em true if the URI is for a TCP server, @em false if not,
+     *  	   such as for a UNIX-domain socket.
+     */
+    static bool host_port(const string& uri, string& host, string& port);
+    /**
+     * Puts a list of servers in the preferred order to try them.
+     * @param uris The server URIs.
+     * @return The URIs, most preferred first.
+     */
+    string_collection order(const string_collection& uris) const;
+    /**
+     * Races TCP connects to a list of servers.
+     * This blocks until one of them connects, all of them fail, or the
+     * timeout runs out, and records the results.
+     * @param uris The server URIs.
+     * @return The URI of the first server to connect, or an empty string
+     *  	   if none did.
+     */
+    string race(const string_collection& uris);
+    /**
+     * Races TCP connects to the servers of the connect options, and puts
+     * them in order for the connect, with the winner first.
+     * If the options have no server list, they are left alone.
+     * @param opts The connect options.
+     * @return @em true if a server won the race, @em false if not.
+     */
+    bool apply(connect_options& opts);
+    /**
+     * Records the time it took to connect to a server.
+     * @param uri The server URI.
+     * @param latency The connect time.
+     */
+    void record(const string& uri, duration latency);
+    /**
+     * Records a failed connect to a server.
+     * @param uri The server URI.
+     */
+    void record_failure(const string& uri);
+    /**
+     * Gets the moving average of the connect times of a server.
+     * @param uri The server URI.
+     * @return The average connect time, if the server ever connected.
+     */
+    std::optional<duration> latency(const string& uri) const;
+    /**
+     * Gets the number of failures of a server since it last connected.
+     * @param uri The server URI.
+     * @return The number of failures.
+     */
+    unsigned num_failures(const string& uri) const;
+    /**
+     * Forgets what's known about all the servers.
+     */
+    void clear();
+};
+
+/** Smart/shared pointer to an endpoint_racer */
+using endpoint_racer_ptr = endpoint_racer::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_endpoint_racer_h
@@ -27,7 +27,11 @@
 #include "mqtt/message.h"
 #include "mqtt/properties.h"
 #include "mqtt/reason_code.h"
+#include "mqtt/thread_queue.h"
 #include "mqtt/types.h"
+#include <memory>
+#include <string_view>
+#include <type_traits>
 #include <variant>
 
 namespace mqtt {
@@ -89,7 +93,50 @@ public:
         const_message_ptr, connected_event, connection_lost_event, disconnected_event, shutdown_event>;
 
 private:
-    event_type evt_{};
+    /** A rarely-used event, kept on the heap */
+    template <typename T>
+    using box = std::unique_ptr<T>;
+
+    /**
+     * The storage for an event.
+     * Messages are nearly all of the events in a consumer queue, so the
+     * connection events, which carry strings and properties, are boxed
+     * to keep every event as small as a message pointer plus the index.
+     */
+    using storage_type = std::variant<
+        const_message_ptr, box<connected_event>, box<connection_lost_event>,
+        box<disconnected_event>, shutdown_event>;
+
+    storage_type evt_{};
+
+    /** Moves an event type into the storage, boxing it as needed */
+    static storage_type to_storage(event_type&& evt) {
+        return std::visit(
+            [](auto&& val) -> storage_type {
+                using T = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<T, const_message_ptr> ||
+                              std::is_same_v<T, shutdown_event>)
+                    return std::move(val);
+                else
+                    return std::make_unique<T>(std::move(val));
+            },
+            std::move(evt)
+        );
+    }
+    /** Makes a deep copy of the storage, since boxes are unique */
+    static storage_type clone(const storage_type& st) {
+        return std::visit(
+            [](const auto& val) -> storage_type {
+                using T = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<T, const_message_ptr> ||
+                              std::is_same_v<T, shutdown_event>)
+                    return val;
+                else
+                    return val ? std::make_unique<typename T::element_type>(*val) : T{};
+            },
+            st
+        );
+    }
 
 public:
     /**
@@ -101,12 +148,12 @@ public:
      * Constructs an event from an event type variant.
      * @param evt The event type variant.
      */
-    event(event_type evt) : evt_{std::move(evt)} {}
+    event(event_type evt) : evt_{to_storage(std::move(evt))} {}
     /**
      * Constructs a message event.
      * @param msg A shared message pointer.
      */
-    event(message_ptr msg) : evt_{std::move(msg)} {}
+    event(message_ptr msg) : evt_{const_message_ptr{std::move(msg)}} {}
     /**
      * Constructs a message event.
      * @param msg A shared const message pointer.
@@ -116,17 +163,19 @@ public:
      * Constructs a 'connected' event.
      * @param evt A connected event.
      */
-    event(connected_event evt) : evt_{std::move(evt)} {}
+    event(connected_event evt) : evt_{std::make_unique<connected_event>(std::move(evt))} {}
     /**
      * Constructs a 'connection lost' event.
      * @param evt A connection lost event.
      */
-    event(connection_lost_event evt) : evt_{std::move(evt)} {}
+    event(connection_lost_event evt)
+        : evt_{std::make_unique<connection_lost_event>(std::move(evt))} {}
     /**
      * Constructs a 'disconnected' event.
      * @param evt A disconnected event.
      */
-    event(disconnected_event evt) : evt_{std::move(evt)} {}
+    event(disconnected_event evt)
+        : evt_{std::make_unique<disconnected_event>(std::move(evt))} {}
     /**
      * Constructs a 'shutdown' event.
      * @param evt A shutdown event.
@@ -136,19 +185,20 @@ public:
      * Copy constructor.
      * @param evt The event to copy.
      */
-    event(const event& evt) : evt_{evt.evt_} {}
+    event(const event& evt) : evt_{clone(evt.evt_)} {}
     /**
      * Move constructor.
+     * This doesn't touch the reference count of a message.
      * @param evt The event to move.
      */
-    event(event&& evt) : evt_{std::move(evt.evt_)} {}
+    event(event&& evt) noexcept : evt_{std::move(evt.evt_)} {}
     /**
      * Assignment from an event type variant.
      * @param evt The event type variant.
      * @return A reference to this object.
      */
     event& operator=(event_type evt) {
-        evt_ = std::move(evt);
+        evt_ = to_storage(std::move(evt));
         return *this;
     }
     /**
@@ -158,15 +208,16 @@ public:
      */
     event& operator=(const event& rhs) {
         if (&rhs != this)
-            evt_ = rhs.evt_;
+            evt_ = clone(rhs.evt_);
         return *this;
     }
     /**
      * Move assignment.
+     * This doesn't touch the reference count of a message.
      * @param rhs The event to move.
      * @return A reference to this object.
      */
-    event& operator=(event&& rhs) {
+    event& operator=(event&& rhs) noexcept {
         if (&rhs != this)
             evt_ = std::move(rhs.evt_);
         return *this;
@@ -185,7 +236,7 @@ public:
      *         otherwise.
      */
     bool is_connected() const {
-        return std::holds_alternative<connected_event>(evt_);
+        return std::holds_alternative<box<connected_event>>(evt_);
     }
     /**
      * Determines if this event is a client connection lost.
@@ -193,7 +244,7 @@ public:
      *         otherwise.
      */
     bool is_connection_lost() const {
-        return std::holds_alternative<connection_lost_event>(evt_);
+        return std::holds_alternative<box<connection_lost_event>>(evt_);
     }
     /**
      * Determines if this event is a client disconnected.
@@ -201,7 +252,7 @@ public:
      *         otherwise.
      */
     bool is_disconnected() const {
-        return std::holds_alternative<disconnected_event>(evt_);
+        return std::holds_alternative<box<disconnected_event>>(evt_);
     }
     /**
      * Determines if this event is an internal shutdown request.
@@ -209,7 +260,7 @@ public:
      *         otherwise.
      */
     bool is_shutdown() const {
-        return std::holds_alternative<disconnected_event>(evt_);
+        return std::holds_alternative<shutdown_event>(evt_);
     }
     /**
      * Determines if this is any type of client disconnect or shutdown.
@@ -217,9 +268,7 @@ public:
      *         as a 'connection lost', 'disconnected', or shutdown event.
      */
     bool is_any_disconnect() const {
-        return std::holds_alternative<connection_lost_event>(evt_)
-            || std::holds_alternative<disconnected_event>(evt_)
-            || std::holds_alternative<shutdown_event>(evt_);
+        return is_connection_lost() || is_disconnected() || is_shutdown();
     }
     /**
      * Gets the message from the event, iff this is a message event.
@@ -239,11 +288,13 @@ public:
      * @throw std::bad_variant_access if this is not a 'disconnected' event.
      */
     disconnected_event get_disconnected() {
-        return std::get<disconnected_event>(evt_);
+        return *std::get<box<disconnected_event>>(evt_);
     }
     /**
      * Gets a pointer to the message in the event, iff this is a message
      * event.
+     * The message can be moved out through the pointer, to take it from
+     * the event without a reference count update.
      * @return A pointer to a message pointer, if this is a message event.
      *         Returns nulltr if this is not a message event.
      */
@@ -251,6 +302,15 @@ public:
     get_message_if() noexcept {
         return std::get_if<const_message_ptr>(&evt_);
     }
+    /**
+     * Gets a pointer to the message in the event, iff this is a message
+     * event.
+     * @return A pointer to a message pointer, if this is a message event.
+     *         Returns nulltr if this is not a message event.
+     */
+    constexpr const const_message_ptr* get_message_if() const noexcept {
+        return std::get_if<const_message_ptr>(&evt_);
+    }
     /**
      * Gets a pointer the underlying information for a disconnected event,
      * iff this is a 'disconnected' event.
@@ -260,9 +320,56 @@ public:
      *         why the server disconnected.
      * @throw std::bad_variant_access if this is not a 'disconnected' event.
      */
-    constexpr std::add_pointer_t<disconnected_event>
-    get_disconnected_if() noexcept {
-        return std::get_if<disconnected_event>(&evt_);
+    std::add_pointer_t<disconnected_event> get_disconnected_if() noexcept {
+        auto p = std::get_if<box<disconnected_event>>(&evt_);
+        return p ? p->get() : nullptr;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The traits of the events in a consumer @ref thread_queue.
+ * A message counts for its topic, payload, and properties, and a new
+ * message can take the place of an older one on the same topic. Other
+ * events are never conflated. A message that is dropped is acked.
+ */
+template <>
+struct thread_queue_traits<event>
+{
+    /** Gets a view of a topic, which may be null */
+    static std::string_view topic_view(const string_ref& topic) noexcept {
+        return topic ? std::string_view{topic.data(), topic.size()} : std::string_view{};
+    }
+    /**
+     * Gets the number of bytes that an event counts for.
+     * @return The size of the event.
+     */
+    static std::size_t size_of(const event& evt) noexcept {
+        auto pmsg = evt.get_message_if();
+        if (!pmsg || !*pmsg)
+            return sizeof(event);
+        return (*pmsg)->memory_size();
+    }
+    /**
+     * Determines if a new event can take the place of an older one.
+     * @return @em true if both are messages on the same topic.
+     */
+    static bool conflates(const event& older, const event& newer) noexcept {
+        auto a = older.get_message_if(), b = newer.get_message_if();
+        if (!a || !b || !*a || !*b)
+            return false;
+        return topic_view((*a)->get_topic_ref()) == topic_view((*b)->get_topic_ref());
+    }
+    /**
+     * Handles an event that the queue dropped or replaced.
+     * A message is acked, so that in manual-ack mode it doesn't hold up
+     * the ones that arrived after it, since the app will never see it.
+     */
+    static void discard(event& evt) {
+        auto pmsg = evt.get_message_if();
+        if (pmsg && *pmsg)
+            (*pmsg)->ack();
     }
 };
 
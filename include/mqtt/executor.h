@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file executor.h
+/// Declaration of MQTT executor classes, which run the completion
+/// callbacks for an async_client.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_executor_h
+#define __mqtt_executor_h
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "mqtt/thread_queue.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Interface for an object that runs tasks.
+ *
+ * The async_client can be given an executor to run the completion
+ * callbacks for its operations, like the action listeners and the user
+ * callback's @em delivery_complete(), so that they don't run on the
+ * library's network thread. An application can implement this to hand
+ * the work to its own thread pool or event loop.
+ */
+class executor
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<executor>;
+    /** The type of task that is run by the executor */
+    using task_type = std::function<void()>;
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~executor() {}
+    /**
+     * Arranges for a task to be run.
+     * @param task The task to run.
+     * @return @em true if the task was accepted, @em false if not, in
+     *  	   which case the caller runs it itself.
+     */
+    virtual bool execute(task_type task) = 0;
+};
+
+/** Smart/shared pointer to an executor */
+using executor_ptr = executor::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An executor that runs each task immediately, on the calling thread.
+ */
+class inline_executor : public executor
+{
+public:
+    /**
+     * Runs the task right away.
+     * @param task The task to run.
+     * @return Always @em true.
+     */
+    bool execute(task_type task) override {
+        if (task)
+            task();
+        return true;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An executor that runs the tasks, in order, on a dedicated thread.
+ *
+ * Any exception that escapes a task is caught and discarded, and the
+ * thread goes on to the next task.
+ */
+class thread_executor : public executor
+{
+public:
+    /** The queue of tasks waiting to run */
+    using queue_type = thread_queue<task_type>;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Lock for stopping the thread */
+    std::mutex lock_;
+    /** The tasks waiting to run */
+    queue_type que_;
+    /** The thread that runs the tasks */
+    std::thread thr_;
+
+    /** The function run by the thread */
+    void run();
+
+public:
+    /**
+     * Creates the executor and starts its thread.
+     * @param queCap The capacity of the task queue. When it's full,
+     *  			 adding a task blocks until there is room.
+     */
+    explicit thread_executor(std::size_t queCap = queue_type::MAX_CAPACITY);
+    /**
+     * Destroys the executor.
+     * This stops the thread after it runs any tasks already queued.
+     */
+    ~thread_executor() override;
+
+    thread_executor(const thread_executor&) = delete;
+    thread_executor& operator=(const thread_executor&) = delete;
+
+    /**
+     * Gets the number of tasks waiting to run.
+     * @return The number of tasks waiting to run.
+     */
+    std::size_t size() const { return que_.size(); }
+    /**
+     * Determines if the executor has been stopped.
+     * @return @em true if the executor was stopped, @em false otherwise.
+     */
+    bool stopped() const { return que_.closed(); }
+    /**
+     * Queues a task to be run by the executor's thread.
+     * @param task The task to run.
+     * @return @em true if the task was queued, @em false if the executor
+     *  	   was stopped.
+     */
+    bool execute(task_type task) override;
+    /**
+     * Stops the executor.
+     * No more tasks are accepted. This waits for the thread to run any
+     * tasks already in the queue, then joins it. It is safe to call this
+     * more than once, but not from a task.
+     */
+    void stop();
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_executor_h
@@ -0,0 +1,615 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file flat_topic_matcher.h
+/// Declaration of MQTT flat_topic_matcher, a compact variant of the
+/// topic_matcher collection.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_flat_topic_matcher_h
+#define __mqtt_flat_topic_matcher_h
+
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mqtt/topic.h"
+#include "mqtt/topic_levels.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A compact collection of MQTT topic filters mapped to arbitrary values.
+ *
+ * This has the same interface and matching rules as @ref topic_matcher,
+ * and can be swapped in for it, but is laid out to be friendlier to the
+ * cache when holding a large number of filters:
+ *
+ * @li Each distinct level (field) of the filters is interned once and
+ *     identified by a small integer ID, so searching compares integers,
+ *     not strings.
+ * @li The nodes of the trie are held in a single, contiguous array, and
+ *     refer to each other by index.
+ * @li The children of all nodes are kept in a single hash table, keyed by
+ *     the parent node and the level ID. The wildcard children of each node
+ *     are held directly in the node.
+ * @li The values are held in a contiguous array.
+ *
+ * A topic is matched without allocating any strings. Its levels are looked
+ * up in the intern table; any that are not there can only match wildcards.
+ *
+ * Unlike the topic_matcher, inserting or removing an item invalidates all
+ * iterators into the collection.
+ */
+template <typename T>
+class flat_topic_matcher
+{
+public:
+    using key_type = string;
+    using mapped_type = T;
+    using value_type = std::pair<key_type, mapped_type>;
+    using reference = value_type;
+    using const_reference = const value_type&;
+
+    using mapped_ptr = std::unique_ptr<mapped_type>;
+
+private:
+    /** The type for indexes and IDs */
+    using index_type = uint32_t;
+
+    /** Index value for an unused slot */
+    static constexpr index_type NONE = std::numeric_limits<index_type>::max();
+    /** The index of the root node */
+    static constexpr index_type ROOT = 0;
+
+    /** A node in the trie */
+    struct node
+    {
+        /** Index of the value for this node, if any */
+        index_type content{NONE};
+        /** Index of the single-level wildcard child, if any */
+        index_type plus{NONE};
+        /** Index of the multi-level wildcard child, if any */
+        index_type hash{NONE};
+    };
+
+    /** The nodes. The root is always first. */
+    std::vector<node> nodes_;
+    /** The children of the nodes, by (parent, level ID) */
+    std::unordered_map<uint64_t, index_type> children_;
+    /** The values */
+    std::vector<value_type> values_;
+    /** The index of the node that owns each value */
+    std::vector<index_type> valueNodes_;
+    /** Storage for the interned levels. A deque never moves its items. */
+    std::deque<string> levels_;
+    /** The ID for each interned level */
+    std::unordered_map<std::string_view, index_type> levelIds_;
+
+    /** Gets the key for the child of a node */
+    static uint64_t child_key(index_type parent, index_type level) {
+        return (uint64_t(parent) << 32) | level;
+    }
+    /** Gets the ID for a level, or NONE if it is not interned */
+    index_type level_id(std::string_view level) const {
+        auto it = levelIds_.find(level);
+        return (it == levelIds_.end()) ? NONE : it->second;
+    }
+    /** Gets the ID for a level, interning it if necessary */
+    index_type intern(const string& level) {
+        auto id = level_id(level);
+        if (id == NONE) {
+            id = index_type(levels_.size());
+            levels_.push_back(level);
+            levelIds_.emplace(levels_.back(), id);
+        }
+        return id;
+    }
+    /** Gets the literal child of a node, or NONE */
+    index_type child(index_type parent, index_type level) const {
+        if (level == NONE)
+            return NONE;
+        auto it = children_.find(child_key(parent, level));
+        return (it == children_.end()) ? NONE : it->second;
+    }
+    /** Gets the child of a node for a level of a filter, or NONE */
+    index_type find_child(index_type parent, std::string_view field) const {
+        if (field == "+")
+            return nodes_[parent].plus;
+        if (field == "#")
+            return nodes_[parent].hash;
+        return child(parent, level_id(field));
+    }
+    /** Gets the child of a node for a level of a filter, creating it */
+    index_type get_child(index_type parent, const string& field) {
+        index_type idx;
+
+        if (field == "+" || field == "#") {
+            bool plus = (field == "+");
+            idx = plus ? nodes_[parent].plus : nodes_[parent].hash;
+            if (idx == NONE) {
+                idx = index_type(nodes_.size());
+                nodes_.emplace_back();
+                (plus ? nodes_[parent].plus : nodes_[parent].hash) = idx;
+            }
+            return idx;
+        }
+
+        auto key = child_key(parent, intern(field));
+        auto it = children_.find(key);
+        if (it != children_.end())
+            return it->second;
+
+        idx = index_type(nodes_.size());
+        nodes_.emplace_back();
+        children_.emplace(key, idx);
+        return idx;
+    }
+    /** Finds the node for a filter, or NONE */
+    index_type find_node(const key_type& filter) const {
+        index_type nd = ROOT;
+        topic_levels levels{filter};
+        for (size_t i = 0; i < levels.size(); ++i) {
+            if ((nd = find_child(nd, levels.level(filter, i))) == NONE)
+                break;
+        }
+        return nd;
+    }
+    /** Gets a pointer to the value for the node, if any. */
+    value_type* content(index_type nd) {
+        auto idx = nodes_[nd].content;
+        return (idx == NONE) ? nullptr : &values_[idx];
+    }
+
+public:
+    /** Generic iterator over all items in the collection. */
+    class iterator
+    {
+        /** The current value */
+        value_type* pval_;
+
+        friend class flat_topic_matcher;
+        iterator(value_type* pval) : pval_{pval} {}
+
+    public:
+        /**
+         * Gets a reference to the current value.
+         * @return A reference to the current value.
+         */
+        reference operator*() noexcept { return *pval_; }
+        /**
+         * Gets a const reference to the current value.
+         * @return A const reference to the current value.
+         */
+        const_reference operator*() const noexcept { return *pval_; }
+        /**
+         * Get a pointer to the current value.
+         * @return A pointer to the current value.
+         */
+        value_type* operator->() noexcept { return pval_; }
+        /**
+         * Get a const pointer to the current value.
+         * @return A const pointer to the current value.
+         */
+        const value_type* operator->() const noexcept { return pval_; }
+        /**
+         * Postfix increment operator.
+         * @return An iterator pointing to the previous item.
+         */
+        iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++pval_;
+            return tmp;
+        }
+        /**
+         * Prefix increment operator.
+         * @return An iterator pointing to the next item.
+         */
+        iterator& operator++() noexcept {
+            ++pval_;
+            return *this;
+        }
+        /**
+         * Compares two iterators to see if they don't refer to the same
+         * item.
+         *
+         * @param other The other iterator to compare against this one.
+         * @return @em true if they don't match, @em false if they do
+         */
+        bool operator!=(const iterator& other) const noexcept { return pval_ != other.pval_; }
+    };
+
+    /** A const iterator over all items in the collection. */
+    class const_iterator : public iterator
+    {
+        using base = iterator;
+
+        friend class flat_topic_matcher;
+        const_iterator(iterator it) : base(it) {}
+
+    public:
+        /**
+         * Gets a const reference to the current value.
+         * @return A const reference to the current value.
+         */
+        const_reference operator*() const noexcept { return base::operator*(); }
+        /**
+         * Get a const pointer to the current value.
+         * @return A const pointer to the current value.
+         */
+        const value_type* operator->() const noexcept { return base::operator->(); }
+    };
+
+    /**
+     * Iterator that efficiently searches the collection for topic
+     * matches.
+     */
+    class match_iterator
+    {
+        /** A node still to be searched, and the topic level to check */
+        struct search_node
+        {
+            index_type node;
+            index_type depth;
+        };
+
+        /** The collection being searched */
+        flat_topic_matcher* tm_;
+        /** The last-found value */
+        value_type* pval_;
+        /** The level IDs of the topic (NONE if not in the collection) */
+        std::vector<index_type> levels_;
+        /** Whether the first level of the topic starts with '$' */
+        bool dollar_;
+        /** The nodes still to be checked, used as a stack */
+        std::vector<search_node> nodes_;
+
+        /**
+         * Move the next iterator to the next value, or to end(), if none
+         * left.
+         */
+        void next() {
+            pval_ = nullptr;
+
+            while (!nodes_.empty()) {
+                auto snode = nodes_.back();
+                nodes_.pop_back();
+
+                const auto& nd = tm_->nodes_[snode.node];
+
+                // At the end of the topic, we either have a value, or
+                // need to move on to the next node to search.
+                if (snode.depth == levels_.size()) {
+                    if ((pval_ = tm_->content(snode.node)) != nullptr)
+                        return;
+                    continue;
+                }
+
+                auto depth = snode.depth + 1;
+
+                // Look for an exact match
+                auto child = tm_->child(snode.node, levels_[snode.depth]);
+                if (child != NONE)
+                    nodes_.push_back({child, depth});
+
+                // Topics starting with '$' don't match wildcards in the first field
+                // MQTT v5 Spec, Section 4.7.2:
+                // https://docs.oasis-open.org/mqtt/mqtt/v5.0/os/mqtt-v5.0-os.html#_Toc3901246
+
+                if (snode.depth != 0 || !dollar_) {
+                    // Look for a single-field wildcard match
+                    if (nd.plus != NONE)
+                        nodes_.push_back({nd.plus, depth});
+
+                    // Look for a terminating match
+                    if (nd.hash != NONE && (pval_ = tm_->content(nd.hash)) != nullptr)
+                        return;
+                }
+            }
+        }
+
+        friend class flat_topic_matcher;
+
+        match_iterator() : tm_{nullptr}, pval_{nullptr}, dollar_{false} {}
+        match_iterator(flat_topic_matcher* tm, const string& topic)
+            : tm_{tm}, pval_{nullptr}, dollar_{!topic.empty() && topic[0] == '$'} {
+            // Split the topic around '/' the same as topic::split(), but
+            // looking up the level IDs rather than creating strings.
+            topic_levels levels{topic};
+            levels_.reserve(levels.size());
+            for (size_t i = 0; i < levels.size(); ++i)
+                levels_.push_back(tm_->level_id(levels.level(topic, i)));
+            nodes_.push_back({ROOT, 0});
+            next();
+        }
+
+    public:
+        /**
+         * Gets a reference to the current value.
+         * @return A reference to the current value.
+         */
+        reference operator*() noexcept { return *pval_; }
+        /**
+         * Gets a const reference to the current value.
+         * @return A const reference to the current value.
+         */
+        const_reference operator*() const noexcept { return *pval_; }
+        /**
+         * Get a pointer to the current value.
+         * @return A pointer to the current value.
+         */
+        value_type* operator->() noexcept { return pval_; }
+        /**
+         * Get a const pointer to the current value.
+         * @return A const pointer to the current value.
+         */
+        const value_type* operator->() const noexcept { return pval_; }
+        /**
+         * Postfix increment operator.
+         * @return An iterator pointing to the previous matching item.
+         */
+        match_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            this->next();
+            return tmp;
+        }
+        /**
+         * Prefix increment operator.
+         * @return An iterator pointing to the next matching item.
+         */
+        match_iterator& operator++() noexcept {
+            this->next();
+            return *this;
+        }
+        /**
+         * Compares two iterators to see if they don't refer to the same
+         * node.
+         *
+         * @param other The other iterator to compare against this one.
+         * @return @em true if they don't match, @em false if they do
+         */
+        bool operator!=(const match_iterator& other) const noexcept {
+            return pval_ != other.pval_;
+        }
+    };
+
+    /**
+     * A const match iterator.
+     */
+    class const_match_iterator : public match_iterator
+    {
+        using base = match_iterator;
+
+        friend class flat_topic_matcher;
+        const_match_iterator(match_iterator it) : base(it) {}
+
+    public:
+        /**
+         * Gets a const reference to the current value.
+         * @return A const reference to the current value.
+         */
+        const_reference operator*() const noexcept { return base::operator*(); }
+        /**
+         * Get a const pointer to the current value.
+         * @return A const pointer to the current value.
+         */
+        const value_type* operator->() const noexcept { return base::operator->(); }
+    };
+
+    /**
+     * Creates  new, empty collection.
+     */
+    flat_topic_matcher() : nodes_(1) {}
+    /**
+     * Creates a new collection with a list of key/value pairs.
+     *
+     * This can be used to create a connection from a table of entries, as
+     * key/value pairs, like:
+     *
+     *     flat_topic_matcher<int> matcher {
+     *  	   { "#", -1 },
+     *  	   { "some/random/topic", 42 },
+     *  	   { "some/#", 99 }
+     *     }
+     *
+     * @param lst The list of key/value pairs to populate the collection.
+     */
+    flat_topic_matcher(std::initializer_list<value_type> lst) : nodes_(1) {
+        for (const auto& v : lst) {
+            insert(v);
+        }
+    }
+    /**
+     * Determines if the collection is empty.
+     * @return @em true if the collection is empty, @em false if it contains
+     *         any filters.
+     */
+    bool empty() const { return values_.empty(); }
+    /**
+     * Gets the number of filters in the collection.
+     * @return The number of filters in the collection.
+     */
+    size_t size() const { return values_.size(); }
+    /**
+     * Inserts a new key/value pair into the collection.
+     * If the filter is already in the collection, its value is replaced.
+     * @param val The value to place in the collection.
+     */
+    void insert(value_type&& val) {
+        index_type nd = ROOT;
+        for (const auto& field : topic::split(val.first)) nd = get_child(nd, field);
+
+        auto& idx = nodes_[nd].content;
+        if (idx != NONE) {
+            values_[idx] = std::move(val);
+        }
+        else {
+            idx = index_type(values_.size());
+            values_.push_back(std::move(val));
+            valueNodes_.push_back(nd);
+        }
+    }
+    /**
+     * Inserts a new value into the collection.
+     * @param val The value to place in the collection.
+     */
+    void insert(const value_type& val) {
+        value_type v{val};
+        this->insert(std::move(v));
+    }
+    /**
+     * Removes an entry from the collection.
+     *
+     * This removes the value from the internal node, but leaves the node in
+     * the collection, even if it is empty.
+     * @param filter The topic filter to remove.
+     * @return A unique pointer to the value, if any.
+     */
+    mapped_ptr remove(const key_type& filter) {
+        auto nd = find_node(filter);
+        if (nd == NONE || nodes_[nd].content == NONE)
+            return mapped_ptr{};
+
+        auto idx = nodes_[nd].content;
+        nodes_[nd].content = NONE;
+
+        auto ret = std::make_unique<mapped_type>(std::move(values_[idx].second));
+
+        // Fill the hole with the last value
+        auto last = index_type(values_.size() - 1);
+        if (idx != last) {
+            values_[idx] = std::move(values_[last]);
+            valueNodes_[idx] = valueNodes_[last];
+            nodes_[valueNodes_[idx]].content = idx;
+        }
+        values_.pop_back();
+        valueNodes_.pop_back();
+
+        return ret;
+    }
+    /**
+     * Removes the empty nodes in the collection.
+     * This rebuilds the collection from the remaining values, which also
+     * drops any levels that are no longer used.
+     */
+    void prune() {
+        flat_topic_matcher tm;
+        for (auto& val : values_) tm.insert(std::move(val));
+        *this = std::move(tm);
+    }
+    /**
+     * Gets an iterator to the full collection of filters.
+     * @return An iterator to the full collection of filters.
+     */
+    iterator begin() { return iterator{values_.data()}; }
+    /**
+     * Gets an iterator to the end of the collection of filters.
+     * @return An iterator to the end of collection of filters.
+     */
+    iterator end() { return iterator{values_.data() + values_.size()}; }
+    /**
+     * Gets an iterator to the end of the collection of filters.
+     * @return An iterator to the end of collection of filters.
+     */
+    const_iterator end() const noexcept {
+        return const_cast<flat_topic_matcher*>(this)->end();
+    }
+    /**
+     * Gets a const iterator to the full collection of filters.
+     * @return A const iterator to the full collection of filters.
+     */
+    const_iterator cbegin() const { return const_cast<flat_topic_matcher*>(this)->begin(); }
+    /**
+     * Gets a const iterator to the end of the collection of filters.
+     * @return A const iterator to the end of collection of filters.
+     */
+    const_iterator cend() const noexcept { return end(); }
+    /**
+     * Gets a pointer to the value at the requested key.
+     * @param filter The topic filter entry to find.
+     * @return An iterator to the value if found, @em end() if not found.
+     */
+    iterator find(const key_type& filter) {
+        auto nd = find_node(filter);
+        value_type* pval = (nd == NONE) ? nullptr : content(nd);
+        return pval ? iterator{pval} : end();
+    }
+    /**
+     * Gets a const pointer to the value at the requested key.
+     * @param filter The topic filter entry to find.
+     * @return A const iterator to the value if found, @em end() if not
+     *  	   found.
+     */
+    const_iterator find(const key_type& filter) const {
+        return const_cast<flat_topic_matcher*>(this)->find(filter);
+    }
+    /**
+     * Gets an match_iterator that can find the matches to the topic.
+     * @param topic The topic to search for matches.
+     * @return An iterator that can find the matches to the topic.
+     */
+    match_iterator matches(const string& topic) { return match_iterator(this, topic); }
+    /**
+     * Gets a const iterator that can find the matches to the topic.
+     * @param topic The topic to search for matches.
+     * @return A const iterator that can find the matches to the topic.
+     */
+    const_match_iterator matches(const string& topic) const {
+        return match_iterator(const_cast<flat_topic_matcher*>(this), topic);
+    }
+    /**
+     * Gets an iterator for the end of the collection.
+     *
+     * This simply returns an empty/null iterator which we can use to signal
+     * the end of the collection.
+     *
+     * @return An empty/null iterator indicating the end of the collection.
+     */
+    const_match_iterator matches_end() const noexcept { return match_iterator{}; }
+    /**
+     * Gets an iterator for the end of the collection.
+     *
+     * This simply returns an empty/null iterator which we can use to signal
+     * the end of the collection.
+     *
+     * @return An empty/null iterator indicating the end of the collection.
+     */
+    const_match_iterator matches_cend() const noexcept { return match_iterator{}; }
+    /**
+     * Determines if there are any matches for the specified topic.
+     * @param topic The topic to search for matches.
+     * @return Whether there are any matches for the topic in the
+     *         collection.
+     */
+    bool has_match(const string& topic) { return matches(topic) != matches_cend(); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_flat_topic_matcher_h
@@ -0,0 +1,215 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file group_commit_persistence.h
+/// Declaration of MQTT group_commit_persistence class, an adapter that
+/// batches the writes to another persistence store.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_group_commit_persistence_h
+#define __mqtt_group_commit_persistence_h
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "mqtt/iclient_persistence.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A persistence adapter that batches the writes to another store.
+ *
+ * Puts and removes are held in memory, and written to the underlying store
+ * together, followed by a single call to its @ref iclient_persistence::sync()
+ * method. A batch is written when the oldest change in it has waited for
+ * the commit interval, or as soon as the buffered data reaches the size
+ * threshold. Reads always see the latest changes, whether or not they were
+ * written yet.
+ *
+ * This trades durability for throughput: if the application crashes, up
+ * to one commit interval of changes can be lost. A shorter interval, or a
+ * smaller size threshold, narrows the window, at the cost of more frequent
+ * syncs.
+ *
+ * The async_client uses this adapter automatically for a user persistence
+ * store, when a commit interval is set in its create_options.
+ */
+class group_commit_persistence : public iclient_persistence
+{
+public:
+    /** The type of clock used for the commit timer */
+    using clock = std::chrono::steady_clock;
+    /** The type of duration used for the commit interval */
+    using duration = clock::duration;
+
+    /** The default threshold, in bytes, that triggers a commit */
+    static constexpr size_t DFLT_MAX_BYTES = 1024 * 1024;
+
+private:
+    /** A change waiting to be written to the store */
+    struct change
+    {
+        /** Whether the key was removed */
+        bool removed{false};
+        /** The data for the key, if it was put */
+        string data;
+    };
+
+    /** The map of pending changes */
+    using change_map = std::unordered_map<string, change>;
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** General purpose guard */
+    using unique_guard = std::unique_lock<std::mutex>;
+
+    /** The store that gets the data */
+    iclient_persistence& store_;
+    /** The longest time a change is held before it is written */
+    duration interval_;
+    /** The amount of buffered data that triggers a commit */
+    size_t maxBytes_;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** Lock for access to the underlying store */
+    mutable std::mutex storeLock_;
+    /** Signals the commit thread */
+    std::condition_variable cond_;
+    /** The changes waiting to be committed */
+    change_map pending_;
+    /** The number of bytes of pending data */
+    size_t pendingBytes_{0};
+    /** The time of the oldest pending change */
+    clock::time_point oldest_;
+    /** Whether the commit thread should exit */
+    bool stop_{false};
+    /** The commit thread */
+    std::thread thr_;
+
+    /** The function run by the commit thread */
+    void run();
+    /** Adds a change to the pending set (unsafe) */
+    void add_change(const string& key, change&& chg);
+    /** Looks up the pending change for the key, if any (unsafe) */
+    const change* find_change(const string& key) const;
+    /** Writes the pending changes to the store (store lock held) */
+    void do_commit();
+    /** Stops the commit thread, if it's running */
+    void stop_thread();
+
+public:
+    /**
+     * Creates an adapter for the store.
+     * @param store The store that gets the data. It must outlive the
+     *  			adapter.
+     * @param interval The longest time that a change is held before it is
+     *  			   written to the store.
+     * @param maxBytes The amount of buffered data that triggers a commit.
+     */
+    template <class Rep, class Period>
+    group_commit_persistence(
+        iclient_persistence& store, const std::chrono::duration<Rep, Period>& interval,
+        size_t maxBytes = DFLT_MAX_BYTES
+    )
+        : store_{store},
+          interval_{std::chrono::duration_cast<duration>(interval)},
+          maxBytes_{maxBytes} {}
+    /**
+     * Destroys the adapter, committing any pending changes.
+     */
+    ~group_commit_persistence() override;
+    /**
+     * Gets the commit interval.
+     * @return The longest time a change is held before it is written.
+     */
+    duration get_interval() const { return interval_; }
+    /**
+     * Gets the size threshold that triggers a commit.
+     * @return The amount of buffered data that triggers a commit.
+     */
+    size_t get_max_bytes() const { return maxBytes_; }
+    /**
+     * Gets the number of changes waiting to be committed.
+     * @return The number of changes waiting to be committed.
+     */
+    size_t num_pending() const {
+        guard g{lock_};
+        return pending_.size();
+    }
+    /**
+     * Writes all the pending changes to the store now, and syncs it.
+     */
+    void commit();
+    /**
+     * Opens the underlying store, and starts the commit timer.
+     * @param clientId The identifier string for the client.
+     * @param serverURI The server to which the client is connected.
+     */
+    void open(const string& clientId, const string& serverURI) override;
+    /**
+     * Commits any pending changes and closes the underlying store.
+     */
+    void close() override;
+    /**
+     * Discards any pending changes and clears the underlying store.
+     */
+    void clear() override;
+    /**
+     * Determines if there is data for the key.
+     * @param key The key to find
+     * @return @em true if the key exists, @em false if not.
+     */
+    bool contains_key(const string& key) override;
+    /**
+     * Gets the keys in the store, including any pending changes.
+     * @return A collection of the keys in the store.
+     */
+    string_collection keys() const override;
+    /**
+     * Buffers the data for the key, to be written with the next commit.
+     * @param key The key.
+     * @param bufs The data to store
+     */
+    void put(const string& key, const std::vector<string_view>& bufs) override;
+    /**
+     * Gets the latest data for the key.
+     * @param key The key
+     * @return The data associated with the key.
+     */
+    string get(const string& key) const override;
+    /**
+     * Buffers the removal of the key, to be made with the next commit.
+     * @param key The key
+     */
+    void remove(const string& key) override;
+    /**
+     * Commits any pending changes.
+     */
+    void sync() override { commit(); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_group_commit_persistence_h
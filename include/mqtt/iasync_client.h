@@ -32,12 +32,14 @@
 #include "mqtt/disconnect_options.h"
 #include "mqtt/event.h"
 #include "mqtt/exception.h"
+#include "mqtt/executor.h"
 #include "mqtt/iaction_listener.h"
 #include "mqtt/iclient_persistence.h"
 #include "mqtt/message.h"
 #include "mqtt/subscribe_options.h"
 #include "mqtt/token.h"
 #include "mqtt/types.h"
+#include "mqtt/wait_strategy.h"
 
 namespace mqtt {
 
@@ -59,7 +61,14 @@ namespace mqtt {
 class iasync_client
 {
     friend class token;
+    friend class batch_token;
     virtual void remove_token(token* tok) = 0;
+    /**
+     * Gives the client a chance to retry a failed publish, rather than
+     * have its token complete.
+     * @return @em true if the publish will be retried.
+     */
+    virtual bool retry_delivery(token&, int /*rc*/, ReasonCode /*reason*/) { return false; }
 
 public:
     /** Type for a collection of QOS values */
@@ -69,6 +78,18 @@ public:
      * Virtual destructor
      */
     virtual ~iasync_client() {}
+    /**
+     * Gets the executor that runs the completion callbacks for the
+     * client's operations.
+     * @return The executor, or null if the callbacks are run on the
+     *  	   library's callback thread.
+     */
+    virtual executor_ptr get_completion_executor() const { return executor_ptr{}; }
+    /**
+     * Gets how threads wait on the client's tokens.
+     * @return The wait strategy.
+     */
+    virtual wait_strategy get_wait_strategy() const { return wait_strategy{}; }
     /**
      * Connects to an MQTT server using the default options.
      * @return token used to track and wait for the connect to complete. The
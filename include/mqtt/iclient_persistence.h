@@ -24,6 +24,10 @@
 #ifndef __mqtt_iclient_persistence_h
 #define __mqtt_iclient_persistence_h
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "MQTTAsync.h"
@@ -85,16 +89,64 @@ class iclient_persistence
     static int persistence_clear(void* handle);
     static int persistence_containskey(void* handle, char* key);
 
+    /** The values read in bulk to restore a session, until they're used */
+    struct restore_cache;
+
+    /** Lock for the restore cache */
+    mutable std::mutex restoreLock_;
+    /** The restore cache, if there is one */
+    std::unique_ptr<restore_cache> restored_;
+    /** Whether there is a restore cache, to skip the lock when not */
+    std::atomic<bool> hasRestored_{false};
+
+    /** Reads the values of any new keys into the restore cache */
+    void prefetch(const std::vector<string>& keys);
+    /** Takes a value from the restore cache, if it is there */
+    char* take_restored(const string& key, size_t* len);
+    /** Drops a key from the restore cache */
+    void forget_restored(const string& key);
+    /** Drops the restore cache, freeing the values that weren't used */
+    void drop_restored();
+
 public:
     /** Smart/shared pointer to an object of this class. */
     using ptr_t = std::shared_ptr<iclient_persistence>;
     /** Smart/shared pointer to a const object of this class. */
     using const_ptr_t = std::shared_ptr<const iclient_persistence>;
+    /** A handler that is called with each key in the store */
+    using key_handler = std::function<void(const string& key)>;
+
+    /**
+     * A value read from the store to restore a session.
+     * The buffer is allocated with @ref persistence_malloc(), and is null
+     * if the value couldn't be read.
+     */
+    struct restored_value
+    {
+        /** The buffer holding the data */
+        char* buf{nullptr};
+        /** The length of the data, in bytes */
+        size_t len{0};
+    };
 
+    /**
+     * Default constructor.
+     */
+    iclient_persistence();
+    /**
+     * Copy constructor.
+     * This does not copy the values being restored to the library.
+     */
+    iclient_persistence(const iclient_persistence&);
     /**
      * Virtual destructor.
      */
-    virtual ~iclient_persistence() {}
+    virtual ~iclient_persistence();
+    /**
+     * Copy assignment.
+     * This does not copy the values being restored to the library.
+     */
+    iclient_persistence& operator=(const iclient_persistence&) { return *this; }
     /**
      * Initialize the persistent store.
      * This uses the client ID and server name to create a unique location
@@ -122,6 +174,18 @@ public:
      * @return A collection of strings representing the keys in the store.
      */
     virtual string_collection keys() const = 0;
+    /**
+     * Calls a handler with each of the keys in the store, without
+     * collecting them first.
+     *
+     * This is what the library uses to list the keys when it restores a
+     * session. The default implementation iterates over @ref keys().
+     * Stores that can hold a lot of data should override this to hand out
+     * their keys directly. The handler must not call back into the store.
+     *
+     * @param fn The handler to call with each key.
+     */
+    virtual void for_each_key(const key_handler& fn) const;
     /**
      * Puts the specified data into the persistent store.
      * @param key The key.
@@ -134,11 +198,50 @@ public:
      * @return A const view of the data associated with the key.
      */
     virtual string get(const string& key) const = 0;
+    /**
+     * Gets the specified data out of the persistent store, directly into a
+     * buffer owned by the C library.
+     *
+     * This is what the library uses to restore persisted data. The default
+     * implementation copies the result of @ref get() into a new buffer.
+     * Implementations that can write their data straight into the buffer
+     * should override this to avoid copying it twice.
+     *
+     * @param key The key
+     * @param len Gets the length of the data, in bytes.
+     * @return A buffer holding the data, allocated with
+     *  	   @ref persistence_malloc(). The caller takes ownership of it.
+     */
+    virtual char* get_into(const string& key, size_t* len) const;
+    /**
+     * Gets the data for a batch of keys, to restore a session.
+     *
+     * When the library lists the keys in the store, the data for all of
+     * them is read with one call to this, and handed to the library as it
+     * asks for each key. The default implementation calls
+     * @ref get_into() for each key. Stores that can read in bulk, or in
+     * parallel, should override this.
+     *
+     * @param keys The keys to read.
+     * @return The values, in the same order as the keys. A value that
+     *  	   couldn't be read has a null buffer, and is read again with
+     *  	   @ref get_into() when the library asks for it. The caller
+     *  	   takes ownership of the buffers.
+     */
+    virtual std::vector<restored_value> get_all(const std::vector<string>& keys) const;
     /**
      * Remove the data for the specified key.
      * @param key The key
      */
     virtual void remove(const string& key) = 0;
+    /**
+     * Flushes any data that was written to the store to durable storage.
+     *
+     * This lets a store that would otherwise sync each change separately
+     * defer it, so that a batch of changes can share a single sync, as
+     * done by @ref group_commit_persistence. The default does nothing.
+     */
+    virtual void sync() {}
 };
 
 /** Smart/shared pointer to a persistence client */
@@ -0,0 +1,281 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file inflight_window.h
+/// Declaration of MQTT inflight_window class, an adaptive limit on the
+/// number of QoS 1 and 2 messages in flight.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_inflight_window_h
+#define __mqtt_inflight_window_h
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An adaptive window on the number of QoS 1 and 2 messages in flight,
+ * which grows and shrinks with the time it takes them to be acknowledged,
+ * in the manner of TCP congestion control.
+ *
+ * Each message takes a slot in the window when it's sent, and gives it
+ * back when it completes. A message that doesn't fit waits in a queue, in
+ * order, until a slot frees up.
+ * @par
+ * The window starts small, and grows by a slot for each acknowledgment
+ * until the first sign of congestion, then by a slot for each window's
+ * worth of them: an additive increase. Congestion is a failed delivery or
+ * a smoothed round-trip time that grows past a multiple of the shortest
+ * one seen, which means that messages are piling up at the server or on
+ * the way to it. The window is then cut in half, a multiplicative
+ * decrease, at most once per round trip. So a link with a long delay
+ * gets a wide window, to keep it full, and a slow server gets a narrow
+ * one, to keep from swamping it, without any tuning.
+ * @par
+ * The window is normally used by the async_client, through
+ * `async_client::start_adaptive_inflight()`. Its maximum should be no more
+ * than the `max_inflight` of the connect options, which the library
+ * enforces on its own.
+ */
+class inflight_window
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<inflight_window>;
+    /** The clock used for timing */
+    using clock = std::chrono::steady_clock;
+    /** The type of duration for the round-trip times */
+    using duration = clock::duration;
+    /**
+     * A waiting operation.
+     * This is called with @em true when it has a slot in the window, or
+     * with @em false if the window stopped before it got one.
+     */
+    using task_type = std::function<void(bool)>;
+
+    /** The default starting size of the window */
+    static constexpr std::size_t DFLT_INIT_WINDOW = 10;
+    /**
+     * The default most operations that can wait for a slot. This is the
+     * number of message IDs, which is the most that could be in flight.
+     */
+    static constexpr std::size_t DFLT_MAX_QUEUE = 65535;
+    /** The default multiple of the shortest round trip that means congestion */
+    static constexpr double DFLT_DELAY_FACTOR = 2.0;
+    /** What the window is multiplied by on congestion */
+    static constexpr double DECREASE_FACTOR = 0.5;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** Lock guard that can be unlocked */
+    using unique_lock = std::unique_lock<std::mutex>;
+
+    /** The smallest the window can get */
+    const std::size_t minWindow_;
+    /** The largest the window can get */
+    const std::size_t maxWindow_;
+    /** The multiple of the shortest round trip that means congestion */
+    const double delayFactor_;
+    /** The most operations that can wait for a slot */
+    const std::size_t maxQueue_;
+
+    /** Lock for everything below */
+    mutable std::mutex lock_;
+    /** The size of the window, in fractions of a slot */
+    double cwnd_;
+    /** The size below which the window grows by a slot for each ack */
+    double ssthresh_;
+    /** The number of slots in use */
+    std::size_t inFlight_{0};
+    /** The operations waiting for a slot */
+    std::deque<task_type> que_;
+    /** The smoothed round-trip time, or zero before the first */
+    duration srtt_{0};
+    /** The shortest round-trip time seen, or zero before the first */
+    duration minRtt_{0};
+    /** The window isn't cut again, or grown, until this time */
+    clock::time_point holdUntil_{};
+    /** The number of acknowledged messages */
+    std::size_t nAcked_{0};
+    /** The number of failed messages */
+    std::size_t nLost_{0};
+    /** The number of times the window was cut */
+    std::size_t nDecreases_{0};
+    /** The number of operations turned away because the queue was full */
+    std::size_t nRejected_{0};
+    /** Whether a thread is running the waiting operations */
+    bool draining_{false};
+    /** Whether the window was stopped */
+    bool stopped_{false};
+
+    /** Gets the number of whole slots in the window */
+    std::size_t window() const;
+    /** Cuts the window for congestion, unless it was just cut */
+    void decrease(clock::time_point now);
+    /** Runs the waiting operations that fit in the window */
+    void drain(unique_lock& g);
+
+public:
+    /**
+     * Creates an in-flight window.
+     * @param maxWindow The largest the window can get.
+     * @param minWindow The smallest the window can get, which is at least
+     *  				one.
+     * @param initWindow The starting size of the window.
+     * @param delayFactor How many times the shortest round trip that the
+     *  				  smoothed round trip can take before it's treated
+     *  				  as congestion.
+     * @param maxQueue The most operations that can wait for a slot, which
+     *  			   is at least one.
+     */
+    explicit inflight_window(
+        std::size_t maxWindow, std::size_t minWindow = 1,
+        std::size_t initWindow = DFLT_INIT_WINDOW, double delayFactor = DFLT_DELAY_FACTOR,
+        std::size_t maxQueue = DFLT_MAX_QUEUE
+    );
+    /**
+     * Destroys the window, stopping it.
+     */
+    ~inflight_window();
+
+    inflight_window(const inflight_window&) = delete;
+    inflight_window& operator=(const inflight_window&) = delete;
+
+    /**
+     * Gets the smallest the window can get.
+     * @return The smallest the window can get.
+     */
+    std::size_t get_min_window() const { return minWindow_; }
+    /**
+     * Gets the largest the window can get.
+     * @return The largest the window can get.
+     */
+    std::size_t get_max_window() const { return maxWindow_; }
+    /**
+     * Gets the multiple of the shortest round trip that means congestion.
+     * @return The multiple of the shortest round trip that means
+     *  	   congestion.
+     */
+    double get_delay_factor() const { return delayFactor_; }
+    /**
+     * Gets the most operations that can wait for a slot.
+     * @return The most operations that can wait for a slot.
+     */
+    std::size_t get_max_queue() const { return maxQueue_; }
+    /**
+     * Gets the current size of the window.
+     * @return The number of messages that can be in flight now.
+     */
+    std::size_t get_window() const;
+    /**
+     * Gets the number of messages in flight.
+     * @return The number of slots in use.
+     */
+    std::size_t in_flight() const;
+    /**
+     * Gets the number of operations waiting for a slot.
+     * @return The number of operations waiting for a slot.
+     */
+    std::size_t queue_size() const;
+    /**
+     * Gets the smoothed round-trip time.
+     * @return The smoothed round-trip time, or zero if no message was
+     *  	   acknowledged yet.
+     */
+    duration get_smoothed_rtt() const;
+    /**
+     * Gets the shortest round-trip time seen.
+     * @return The shortest round-trip time, or zero if no message was
+     *  	   acknowledged yet.
+     */
+    duration get_min_rtt() const;
+    /**
+     * Gets the number of messages that were acknowledged.
+     * @return The number of messages that were acknowledged.
+     */
+    std::size_t num_acked() const;
+    /**
+     * Gets the number of messages that failed.
+     * @return The number of messages that failed.
+     */
+    std::size_t num_lost() const;
+    /**
+     * Gets the number of times the window was cut for congestion.
+     * @return The number of times the window was cut.
+     */
+    std::size_t num_decreases() const;
+    /**
+     * Gets the number of operations that were turned away because too
+     * many were waiting for a slot.
+     * @return The number of operations turned away.
+     */
+    std::size_t num_rejected() const;
+    /**
+     * Submits an operation to run when it has a slot in the window.
+     *
+     * If there's a free slot, and nothing waiting ahead of it, the
+     * operation runs right away, in the calling thread. Otherwise it
+     * waits, and runs in the thread that frees up a slot for it, unless
+     * the most operations are already waiting. Once it runs, it has the
+     * slot until it gives it back with on_acked() or on_lost(), or until
+     * it throws.
+     *
+     * @param task The operation to run.
+     * @return @em true if it was run or queued, @em false if the window
+     *  	   was stopped, or too many operations are waiting.
+     */
+    bool submit(task_type task);
+    /**
+     * Gives back the slot of an acknowledged message, and grows the
+     * window, or cuts it, for the round-trip time.
+     * @param rtt The time from sending the message to its acknowledgment.
+     */
+    void on_acked(duration rtt);
+    /**
+     * Gives back the slot of a message that failed, and cuts the window.
+     */
+    void on_lost();
+    /**
+     * Determines if the window was stopped.
+     * @return @em true if the window was stopped, @em false otherwise.
+     */
+    bool stopped() const;
+    /**
+     * Stops the window.
+     * Any operations waiting for a slot are called with @em false. The
+     * messages in flight can still give back their slots. It is safe to
+     * call this more than once, but not from a waiting operation.
+     */
+    void stop();
+};
+
+/** Smart/shared pointer to an inflight_window */
+using inflight_window_ptr = inflight_window::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_inflight_window_h
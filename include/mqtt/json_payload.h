@@ -0,0 +1,140 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file json_payload.h
+/// Declaration of MQTT json_payload class, a message payload parsed as
+/// JSON with simdjson.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_json_payload_h
+#define __mqtt_json_payload_h
+
+#include <simdjson.h>
+
+#include <memory>
+
+#include "mqtt/buffer_ref.h"
+#include "mqtt/message.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A message payload parsed as JSON, with the SIMD parser of the simdjson
+ * library, into an immutable DOM.
+ *
+ * This is only in the library when it's built with the CMake option
+ * `PAHO_WITH_SIMDJSON`.
+ * @par
+ * The payload is parsed straight from its buffer, without copying it to a
+ * string first, when the buffer has the padding past its end that the
+ * parser reads ahead into. Otherwise it's copied once into a padded
+ * buffer that's kept by the thread for the next payload. The payload of
+ * an incoming message is usually left in the buffer from the C library,
+ * which isn't padded.
+ * @par
+ * The usual way to get one is with get_json(), which parses the payload
+ * of a message once, and keeps the document with the message for all of
+ * its handlers:
+ * @code
+ * cli.set_message_callback([](mqtt::const_message_ptr msg) {
+ *     auto json = mqtt::get_json(*msg);
+ *     double temp = json->root()["temp"];
+ *     ...
+ * });
+ * @endcode
+ * The document can be read from any number of threads.
+ */
+class json_payload
+{
+    /** The parsed document */
+    simdjson::dom::document doc_;
+    /** The root of the document */
+    simdjson::dom::element root_;
+    /** The parse error, if it failed */
+    simdjson::error_code err_{simdjson::SUCCESS};
+    /** Whether the payload was parsed in place */
+    bool inPlace_{false};
+
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<const json_payload>;
+
+    /**
+     * Parses a payload.
+     * A payload that isn't valid JSON still makes an object, which keeps
+     * the error.
+     * @param payload The payload.
+     */
+    explicit json_payload(const binary_ref& payload);
+
+    json_payload(const json_payload&) = delete;
+    json_payload& operator=(const json_payload&) = delete;
+
+    /**
+     * Determines if a payload has the padding past its end to be parsed in
+     * place.
+     * @param payload The payload.
+     * @return @em true if it can be parsed without a copy.
+     */
+    static bool has_padding(const binary_ref& payload);
+    /**
+     * Determines if the payload parsed as valid JSON.
+     * @return @em true if the payload is valid JSON.
+     */
+    bool ok() const { return err_ == simdjson::SUCCESS; }
+    /**
+     * Gets the parse error.
+     * @return The parse error, or @em simdjson::SUCCESS.
+     */
+    simdjson::error_code error() const { return err_; }
+    /**
+     * Determines if the payload was parsed in place, without a copy.
+     * @return @em true if the payload was parsed in place.
+     */
+    bool parsed_in_place() const { return inPlace_; }
+    /**
+     * Gets the root element of the document.
+     * @return The root element.
+     * @throw simdjson::simdjson_error if the payload isn't valid JSON.
+     */
+    simdjson::dom::element root() const {
+        if (err_)
+            throw simdjson::simdjson_error(err_);
+        return root_;
+    }
+};
+
+/** Smart/shared pointer to a json_payload */
+using json_payload_ptr = json_payload::ptr_t;
+
+/**
+ * Gets the payload of a message parsed as JSON.
+ * The payload is parsed the first time, and the document is kept with the
+ * message, so all the handlers of a message share one parse.
+ * @param msg The message.
+ * @return The parsed payload.
+ */
+json_payload_ptr get_json(const message& msg);
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_json_payload_h
@@ -0,0 +1,206 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file last_value_cache.h
+/// Declaration of MQTT last_value_cache class, which keeps the latest
+/// message on each topic.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_last_value_cache_h
+#define __mqtt_last_value_cache_h
+
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "mqtt/message.h"
+#include "mqtt/topic_levels.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A thread-safe cache of the latest message on each topic.
+ *
+ * When installed on a client with `async_client::set_last_value_cache()`,
+ * the cache is fed every incoming message, so the components of an app
+ * can read the current state of a topic, or of all the topics that match
+ * a filter, without subscribing again or keeping their own maps. The
+ * messages are shared, not copied.
+ * @par
+ * The topics are kept in a tree by level, so a wildcard query only visits
+ * the branches that the filter can match. This is the reverse of a
+ * @ref topic_matcher, which holds filters to match against a topic.
+ * @par
+ * As with the broker's retained messages, a retained message with an
+ * empty payload clears the topic.
+ * @par
+ * Reads take a shared lock, so any number of threads can read at once.
+ */
+class last_value_cache
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<last_value_cache>;
+
+private:
+    /** Lock guard for the readers */
+    using shared_guard = std::shared_lock<std::shared_mutex>;
+    /** Lock guard for the writers */
+    using unique_guard = std::unique_lock<std::shared_mutex>;
+
+    /** A level in the tree of topics */
+    struct node
+    {
+        /** The next levels down, by name */
+        std::unordered_map<string, std::unique_ptr<node>> children;
+        /** The latest message on the topic that ends here (if any) */
+        const_message_ptr msg;
+    };
+
+    /** The most topics to hold, or zero for no limit */
+    const std::size_t maxTopics_;
+    /** Whether only retained messages are kept */
+    const bool retainedOnly_;
+
+    /** Lock for everything below */
+    mutable std::shared_mutex lock_;
+    /** The latest message on each topic, for direct reads */
+    std::unordered_map<string, const_message_ptr> index_;
+    /** The tree of topics, for wildcard reads */
+    node root_;
+    /** The estimated memory of the held messages */
+    std::size_t memBytes_{0};
+    /** The most memory the held messages have taken */
+    std::size_t peakMemBytes_{0};
+
+    /** Removes a topic. The lock must be held. */
+    bool remove(const string& topic);
+    /** Collects the messages that match a filter, from a level down */
+    static void collect(
+        const node& nd, const string& filter, const topic_levels& levels, std::size_t i,
+        std::vector<const_message_ptr>& msgs
+    );
+    /** Collects all the messages from a node down */
+    static void collect_all(const node& nd, bool top, std::vector<const_message_ptr>& msgs);
+
+public:
+    /**
+     * Creates a cache.
+     * @param maxTopics The most topics to hold, or zero for no limit. Once
+     *  				the cache is full, messages on new topics are not
+     *  				kept, though the topics already held are still
+     *  				updated.
+     * @param retainedOnly Whether only to keep retained messages, which
+     *  				   the broker sends for a new subscription.
+     */
+    explicit last_value_cache(std::size_t maxTopics = 0, bool retainedOnly = false)
+        : maxTopics_{maxTopics}, retainedOnly_{retainedOnly} {}
+
+    last_value_cache(const last_value_cache&) = delete;
+    last_value_cache& operator=(const last_value_cache&) = delete;
+
+    /**
+     * Gets the most topics that the cache holds.
+     * @return The most topics to hold, or zero for no limit.
+     */
+    std::size_t get_max_topics() const { return maxTopics_; }
+    /**
+     * Determines if the cache only keeps retained messages.
+     * @return @em true if only retained messages are kept.
+     */
+    bool is_retained_only() const { return retainedOnly_; }
+    /**
+     * Updates the cache with a message.
+     * This is normally called by the client, for each incoming message.
+     * @param msg The message.
+     * @return @em true if the cache changed, @em false if the message was
+     *  	   passed over.
+     */
+    bool update(const_message_ptr msg);
+    /**
+     * Gets the latest message on a topic.
+     * @param topic The topic.
+     * @return The message, or a null pointer if there isn't one.
+     */
+    const_message_ptr get_last(const string& topic) const;
+    /**
+     * Gets the latest messages on all the topics that match a filter.
+     * As with subscriptions, wildcards at the start of the filter don't
+     * match topics that begin with '$'.
+     * @param filter The topic filter, which may have wildcards.
+     * @return The messages, in no particular order.
+     */
+    std::vector<const_message_ptr> snapshot(const string& filter) const;
+    /**
+     * Removes a topic from the cache.
+     * @param topic The topic.
+     * @return @em true if the topic was in the cache.
+     */
+    bool erase(const string& topic);
+    /**
+     * Removes all the topics from the cache.
+     */
+    void clear();
+    /**
+     * Gets the number of topics in the cache.
+     * @return The number of topics in the cache.
+     */
+    std::size_t size() const {
+        shared_guard g{lock_};
+        return index_.size();
+    }
+    /**
+     * Determines if the cache is empty.
+     * @return @em true if there are no topics in the cache.
+     */
+    bool empty() const {
+        shared_guard g{lock_};
+        return index_.empty();
+    }
+    /**
+     * Gets an estimate of the memory taken by the messages in the cache,
+     * as given by `message::memory_size()`.
+     * @return The memory of the messages in the cache, in bytes.
+     */
+    std::size_t memory_size() const {
+        shared_guard g{lock_};
+        return memBytes_;
+    }
+    /**
+     * Gets the most memory that the messages in the cache have taken at
+     * once.
+     * @return The high-water mark of the memory of the cache, in bytes.
+     */
+    std::size_t peak_memory_size() const {
+        shared_guard g{lock_};
+        return peakMemBytes_;
+    }
+};
+
+/** Smart/shared pointer to a last_value_cache */
+using last_value_cache_ptr = last_value_cache::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_last_value_cache_h
@@ -0,0 +1,565 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file lock_free_queue.h
+/// Implementation of the template class 'lock_free_queue', a bounded,
+/// thread-safe queue for passing data between threads, which does not take
+/// a lock on its fast path.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_lock_free_queue_h
+#define __mqtt_lock_free_queue_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mqtt/thread_queue.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A bounded, lock-free queue for inter-thread communication.
+ *
+ * This has the same blocking contract as @ref thread_queue - put(), get(),
+ * try_get(), try_get_for(), close(), done(), etc - but moves items through
+ * a fixed-size ring buffer using atomic operations rather than a mutex.
+ * Any number of producers and consumers may use the queue concurrently.
+ * @par
+ * Items are put and removed without taking a lock. A thread only falls
+ * back to waiting on a condition variable when it would otherwise block,
+ * (i.e. a consumer finds the queue empty, or a producer finds it full),
+ * and the other side only signals it when it knows there is a thread
+ * waiting. So under a steady stream of data, no system calls are made.
+ * @par
+ * The capacity is fixed when the queue is constructed, and is rounded up
+ * to the next power of two.
+ * @par
+ * The queue can be closed. After that, no new items can be placed into it,
+ * but receivers can continue to get any items that were added before it
+ * was closed. Unlike the thread_queue, an item put by another thread at
+ * the same moment that the queue is closed may or may not be accepted.
+ *
+ * @tparam T The type of the items to be held in the queue. It must be
+ *  		 default-constructible and move-assignable.
+ */
+template <typename T>
+class lock_free_queue
+{
+public:
+    /** The type of items to be held in the queue. */
+    using value_type = T;
+    /** The type used to specify number of items in the container. */
+    using size_type = std::size_t;
+
+    /** The default capacity of the queue. */
+    static constexpr size_type DFLT_CAPACITY = 16 * 1024;
+
+private:
+    /** The assumed size of a cache line, to keep the indexes apart */
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    /** The number of times to retry before waiting on a condition */
+    static constexpr int SPIN_COUNT = 16;
+
+    /** A slot in the ring buffer */
+    struct cell
+    {
+        /** The sequence number that tells whether the slot is full */
+        std::atomic<size_type> seq;
+        /** The item */
+        value_type val;
+    };
+
+    /** The ring buffer */
+    std::unique_ptr<cell[]> buf_;
+    /** Mask to convert a position into an index into the buffer */
+    const size_type mask_;
+
+    /** Position of the next item to put into the queue */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_type> putPos_{0};
+    /** Position of the next item to get from the queue */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_type> getPos_{0};
+    /** Whether the queue is closed */
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> closed_{false};
+    /** The number of consumers waiting for an item */
+    std::atomic<int> nGetWait_{0};
+    /** The number of producers waiting for space */
+    std::atomic<int> nPutWait_{0};
+
+    /** Lock for blocking operations only */
+    mutable std::mutex lock_;
+    /** Condition get signaled when item added to empty queue */
+    std::condition_variable notEmptyCond_;
+    /** Condition gets signaled then item removed from full queue */
+    std::condition_variable notFullCond_;
+
+    /** General purpose guard */
+    using unique_guard = std::unique_lock<std::mutex>;
+
+    /** Gets the smallest power of two that is not less than n, minimum 2 */
+    static size_type ring_size(size_type n) {
+        size_type sz = 2;
+        while (sz < n) sz <<= 1;
+        return sz;
+    }
+
+    /**
+     * Attempt to place an item into the ring buffer.
+     * The value is only moved from if it was successfully added.
+     */
+    bool push(value_type& val) {
+        // Note that this is called from wait predicates, with the lock held,
+        // so it must not signal the conditions.
+        auto pos = putPos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell& c = buf_[pos & mask_];
+            auto seq = c.seq.load(std::memory_order_acquire);
+            auto dif = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+
+            if (dif == 0) {
+                if (putPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.val = std::move(val);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+                return false;
+            else
+                pos = putPos_.load(std::memory_order_relaxed);
+        }
+    }
+    /**
+     * Attempt to remove an item from the ring buffer.
+     * The value is only assigned if an item was removed.
+     */
+    bool pop(value_type& val) {
+        auto pos = getPos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell& c = buf_[pos & mask_];
+            auto seq = c.seq.load(std::memory_order_acquire);
+            auto dif = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+
+            if (dif == 0) {
+                if (getPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    val = std::move(c.val);
+                    c.val = value_type{};
+                    c.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+                return false;
+            else
+                pos = getPos_.load(std::memory_order_relaxed);
+        }
+    }
+    /**
+     * Wakes a thread waiting on the condition, if there are any.
+     * This must not be called with the lock held.
+     * The fence pairs with the one in wait() so that either the waiter
+     * sees the change to the buffer, or we see the waiter.
+     */
+    void notify(std::atomic<int>& nWait, std::condition_variable& cond) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (nWait.load(std::memory_order_relaxed) > 0) {
+            unique_guard g{lock_};
+            cond.notify_one();
+        }
+    }
+    /**
+     * Spins briefly, then blocks on the condition until the predicate is
+     * satisfied, or the time runs out.
+     * @param nWait The waiter count for the condition.
+     * @param cond The condition to wait on.
+     * @param pred The predicate to test.
+     * @param waitFn Function to do the actual wait on the condition, given
+     *  			 the lock and the predicate.
+     */
+    template <typename Pred, typename WaitFn>
+    bool wait(std::atomic<int>& nWait, std::condition_variable& cond, Pred pred, WaitFn waitFn) {
+        for (int i = 0; i < SPIN_COUNT; ++i) {
+            if (pred())
+                return true;
+            std::this_thread::yield();
+        }
+
+        nWait.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool ok;
+        {
+            unique_guard g{lock_};
+            ok = waitFn(g, cond, pred);
+        }
+        nWait.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    /** Predicate to wait to put a value. Sets 'ok' if it was put. */
+    auto put_pred(value_type& val, bool& ok) {
+        return [this, &val, &ok] {
+            if (closed_.load(std::memory_order_acquire))
+                return true;
+            return (ok = push(val));
+        };
+    }
+    /**
+     * Predicate to wait to get a value. Sets 'ok' if it was removed.
+     * The closed flag is read before checking the buffer so that we never
+     * miss items that were put before the queue was closed.
+     */
+    auto get_pred(value_type* val, bool& ok) {
+        return [this, val, &ok] {
+            bool closed = closed_.load(std::memory_order_acquire);
+            return (ok = pop(*val)) || closed;
+        };
+    }
+
+public:
+    /**
+     * Constructs a queue with the default capacity.
+     */
+    lock_free_queue() : lock_free_queue(DFLT_CAPACITY) {}
+    /**
+     * Constructs a queue with the specified capacity.
+     * @param cap The maximum number of items that can be placed in the
+     *  		  queue. This is rounded up to the next power of two, with
+     *  		  a minimum of two.
+     */
+    explicit lock_free_queue(size_type cap)
+        : buf_{new cell[ring_size(cap)]}, mask_{ring_size(cap) - 1} {
+        for (size_type i = 0; i <= mask_; ++i)
+            buf_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    /**
+     * Determine if the queue is empty.
+     * @return @em true if there are no elements in the queue, @em false if
+     *  	   there are any items in the queue.
+     */
+    bool empty() const { return size() == 0; }
+    /**
+     * Gets the capacity of the queue.
+     * @return The maximum number of elements before the queue is full.
+     */
+    size_type capacity() const { return mask_ + 1; }
+    /**
+     * Gets the number of items in the queue.
+     * This is only a snapshot, and may be out of date as soon as it is
+     * returned if other threads are using the queue.
+     * @return The number of items in the queue.
+     */
+    size_type size() const {
+        auto getPos = getPos_.load(std::memory_order_acquire);
+        auto putPos = putPos_.load(std::memory_order_acquire);
+        return (putPos > getPos) ? std::min(putPos - getPos, capacity()) : 0;
+    }
+    /**
+     * Close the queue.
+     * Once closed, the queue will not accept any new items, but receievers
+     * will still be able to get any remaining items out of the queue until
+     * it is empty.
+     */
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        unique_guard g{lock_};
+        notFullCond_.notify_all();
+        notEmptyCond_.notify_all();
+    }
+    /**
+     * Determines if the queue is closed.
+     * @return @em true if the queue is closed, @false otherwise.
+     */
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+    /**
+     * Determines if all possible operations are done on the queue.
+     * If the queue is closed and empty, then no further useful operations
+     * can be done on it.
+     * @return @true if the queue is closed and empty, @em false otherwise.
+     */
+    bool done() const { return closed() && empty(); }
+    /**
+     * Clear the contents of the queue.
+     * This discards all items in the queue, handing each to the
+     * `discard()` of its @ref thread_queue_traits.
+     */
+    void clear() {
+        value_type val;
+        while (pop(val)) discard_queue_item(val, 0);
+        notify(nPutWait_, notFullCond_);
+    }
+    /**
+     * Put an item into the queue.
+     * If the queue is full, this will block the caller until items are
+     * removed bringing the size less than the capacity.
+     * @param val The value to add to the queue.
+     * @throw queue_closed if the queue is closed.
+     */
+    void put(value_type val) {
+        if (closed())
+            throw queue_closed{};
+
+        if (!push(val)) {
+            bool ok = false;
+            wait(nPutWait_, notFullCond_, put_pred(val, ok), [](auto& g, auto& cond, auto& pred) {
+                cond.wait(g, pred);
+                return true;
+            });
+            if (!ok)
+                throw queue_closed{};
+        }
+        notify(nGetWait_, notEmptyCond_);
+    }
+    /**
+     * Non-blocking attempt to place an item into the queue.
+     * @param val The value to add to the queue.
+     * @return @em true if the item was added to the queue, @em false if the
+     *  	   item was not added because the queue is currently full or
+     *  	   closed.
+     */
+    bool try_put(value_type val) {
+        if (closed() || !push(val))
+            return false;
+        notify(nGetWait_, notEmptyCond_);
+        return true;
+    }
+    /**
+     * Attempt to place an item in the queue with a bounded wait.
+     * This will attempt to place the value in the queue, but if it is full,
+     * it will wait up to the specified time duration before timing out.
+     * @param val The value to add to the queue.
+     * @param relTime The amount of time to wait until timing out.
+     * @return @em true if the value was added to the queue, @em false if a
+     *  	   timeout occurred.
+     */
+    template <typename Rep, class Period>
+    bool try_put_for(value_type val, const std::chrono::duration<Rep, Period>& relTime) {
+        return try_put_until(val, std::chrono::steady_clock::now() + relTime);
+    }
+    /**
+     * Attempt to place an item in the queue with a bounded wait to an
+     * absolute time point.
+     * This will attempt to place the value in the queue, but if it is full,
+     * it will wait up until the specified time before timing out.
+     * @param val The value to add to the queue.
+     * @param absTime The absolute time to wait to before timing out.
+     * @return @em true if the value was added to the queue, @em false if a
+     *  	   timeout occurred.
+     */
+    template <class Clock, class Duration>
+    bool try_put_until(
+        value_type val, const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        if (closed())
+            return false;
+
+        bool ok = push(val);
+        if (!ok) {
+            wait(nPutWait_, notFullCond_, put_pred(val, ok), [&](auto& g, auto& cond, auto& pred) {
+                return cond.wait_until(g, absTime, pred);
+            });
+        }
+        if (ok)
+            notify(nGetWait_, notEmptyCond_);
+        return ok;
+    }
+    /**
+     * Retrieve a value from the queue.
+     * If the queue is empty, this will block indefinitely until a value is
+     * added to the queue by another thread, or the queue is closed.
+     * @param val Pointer to a variable to receive the value.
+     * @return @em true if a value was removed from the queue, @em false if
+     *  	   the queue is done.
+     */
+    bool get(value_type* val) {
+        if (!val)
+            return false;
+
+        bool ok = false;
+        wait(nGetWait_, notEmptyCond_, get_pred(val, ok), [](auto& g, auto& cond, auto& pred) {
+            cond.wait(g, pred);
+            return true;
+        });
+        if (ok)
+            notify(nPutWait_, notFullCond_);
+        return ok;
+    }
+    /**
+     * Retrieve a value from the queue.
+     * If the queue is empty, this will block indefinitely until a value is
+     * added to the queue by another thread, or the queue is closed.
+     * @return The value removed from the queue
+     * @throw queue_closed if the queue is done.
+     */
+    value_type get() {
+        value_type val;
+        if (!get(&val))
+            throw queue_closed{};
+        return val;
+    }
+    /**
+     * Attempts to remove a value from the queue without blocking.
+     * If the queue is currently empty, this will return immediately with a
+     * failure, otherwise it will get the next value and return it.
+     * @param val Pointer to a variable to receive the value.
+     * @return @em true if a value was removed from the queue, @em false if
+     *  	   the queue is empty.
+     */
+    bool try_get(value_type* val) {
+        if (!val || !pop(*val))
+            return false;
+        notify(nPutWait_, notFullCond_);
+        return true;
+    }
+    /**
+     * Attempt to remove an item from the queue for a bounded amount of time.
+     * This will retrieve the next item from the queue. If the queue is
+     * empty, it will wait the specified amount of time for an item to arrive
+     * before timing out.
+     * @param val Pointer to a variable to receive the value.
+     * @param relTime The amount of time to wait until timing out.
+     * @return @em true if the value was removed the queue, @em false if a
+     *  	   timeout occurred.
+     */
+    template <typename Rep, class Period>
+    bool try_get_for(value_type* val, const std::chrono::duration<Rep, Period>& relTime) {
+        return try_get_until(val, std::chrono::steady_clock::now() + relTime);
+    }
+    /**
+     * Attempt to remove an item from the queue for a bounded amount of time.
+     * This will retrieve the next item from the queue. If the queue is
+     * empty, it will wait until the specified time for an item to arrive
+     * before timing out.
+     * @param val Pointer to a variable to receive the value.
+     * @param absTime The absolute time to wait to before timing out.
+     * @return @em true if the value was removed from the queue, @em false
+     *  	   if a timeout occurred.
+     */
+    template <class Clock, class Duration>
+    bool try_get_until(
+        value_type* val, const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        if (!val)
+            return false;
+
+        bool ok = pop(*val);
+        if (!ok) {
+            wait(nGetWait_, notEmptyCond_, get_pred(val, ok), [&](auto& g, auto& cond, auto& pred) {
+                return cond.wait_until(g, absTime, pred);
+            });
+        }
+        if (ok)
+            notify(nPutWait_, notFullCond_);
+        return ok;
+    }
+    /**
+     * Retrieve all the values from the queue.
+     * If the queue is empty, this will block indefinitely until a value is
+     * added to the queue by another thread, or the queue is closed.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @return The number of values removed from the queue. This is zero
+     *  	   only if the queue is done.
+     */
+    size_type get_all(std::vector<value_type>* vec) {
+        if (!vec)
+            return 0;
+
+        value_type val;
+        if (!get(&val))
+            return 0;
+
+        vec->push_back(std::move(val));
+        return 1 + try_get_n(vec, capacity());
+    }
+    /**
+     * Attempts to remove up to 'n' values from the queue without blocking.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @return The number of values removed from the queue.
+     */
+    size_type try_get_n(std::vector<value_type>* vec, size_type n) {
+        if (!vec)
+            return 0;
+
+        size_type i = 0;
+        value_type val;
+        while (i < n && pop(val)) {
+            vec->push_back(std::move(val));
+            ++i;
+        }
+        if (i > 0)
+            notify(nPutWait_, notFullCond_);
+        return i;
+    }
+    /**
+     * Attempt to remove up to 'n' values from the queue, waiting a bounded
+     * amount of time for the first one to arrive.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @param relTime The amount of time to wait until timing out.
+     * @return The number of values removed from the queue, which is zero
+     *  	   if a timeout occurred.
+     */
+    template <typename Rep, class Period>
+    size_type try_get_n_for(
+        std::vector<value_type>* vec, size_type n,
+        const std::chrono::duration<Rep, Period>& relTime
+    ) {
+        return try_get_n_until(vec, n, std::chrono::steady_clock::now() + relTime);
+    }
+    /**
+     * Attempt to remove up to 'n' values from the queue, waiting until the
+     * specified time for the first one to arrive.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @param absTime The absolute time to wait to before timing out.
+     * @return The number of values removed from the queue, which is zero
+     *  	   if a timeout occurred.
+     */
+    template <class Clock, class Duration>
+    size_type try_get_n_until(
+        std::vector<value_type>* vec, size_type n,
+        const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        if (!vec || n == 0)
+            return 0;
+
+        value_type val;
+        if (!try_get_until(&val, absTime))
+            return 0;
+
+        vec->push_back(std::move(val));
+        return 1 + try_get_n(vec, n - 1);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_lock_free_queue_h
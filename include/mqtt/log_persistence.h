@@ -0,0 +1,280 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file log_persistence.h
+/// Declaration of MQTT log_persistence class, a persistence store that
+/// keeps the data in memory-mapped, append-only log segments.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_log_persistence_h
+#define __mqtt_log_persistence_h
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "mqtt/iclient_persistence.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A persistence store that appends the data to memory-mapped log files.
+ *
+ * Rather than writing each persisted packet to its own file, as the
+ * default file persistence does, this writes all of them, one after
+ * another, into a set of fixed-size "segment" files that are mapped into
+ * memory. Removing a key appends a small tombstone record. An in-memory
+ * index maps each key to the location of its latest data, so lookups never
+ * touch the disk. Writes are just copies into the mapped pages, and don't
+ * need any system calls unless a new segment is started.
+ *
+ * Segments are discarded from the front of the log as soon as they no
+ * longer have any live data, which is the normal case for short-lived
+ * QoS 1 and 2 messages. If long-lived data keeps old segments alive, the
+ * log is compacted by copying the live records forward, once the dead
+ * space is well beyond the live data, or when @ref compact() is called.
+ *
+ * When the store is opened, the segments are scanned in order to rebuild
+ * the index.
+ *
+ * By default the data is left to the operating system to write to disk,
+ * which survives a crash of the application, but not necessarily of the
+ * whole system. If @em syncWrites is set, every change is flushed to disk
+ * before returning, at a considerable cost in throughput. Alternately,
+ * @ref sync() flushes everything written since the last sync, which lets
+ * a @ref group_commit_persistence share one sync across many changes.
+ *
+ * This is only available on POSIX systems.
+ */
+class log_persistence : public iclient_persistence
+{
+public:
+    /** The default size of the log segment files */
+    static constexpr size_t DFLT_SEGMENT_SIZE = 4 * 1024 * 1024;
+
+private:
+    /** A memory-mapped log segment file */
+    struct segment
+    {
+        /** The sequence number of the segment */
+        uint32_t id{0};
+        /** The file descriptor */
+        int fd{-1};
+        /** The address of the mapped file */
+        char* base{nullptr};
+        /** The size of the file */
+        size_t size{0};
+        /** The number of bytes written */
+        size_t used{0};
+        /** The number of bytes of live data records */
+        size_t live{0};
+        /** The number of bytes flushed to disk */
+        size_t synced{0};
+    };
+
+    /** The location of the latest data for a key */
+    struct location
+    {
+        /** The segment holding the record */
+        uint32_t segId;
+        /** The offset of the record in the segment */
+        size_t offset;
+        /** The size of the whole record, in bytes */
+        size_t recSize;
+        /** The offset of the value from the start of the segment */
+        size_t valOffset;
+        /** The length of the value */
+        size_t valLen;
+    };
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** The base directory for the stores */
+    string baseDir_;
+    /** The directory for the open store */
+    string dir_;
+    /** The nominal size of each segment */
+    size_t segSize_;
+    /** Whether to flush each change to disk */
+    bool syncWrites_;
+    /** The open segments, in order */
+    std::deque<segment> segs_;
+    /** The index of the latest data for each key */
+    std::unordered_map<string, location> index_;
+    /** The total bytes of live records */
+    size_t liveBytes_{0};
+    /** The total bytes written to all segments */
+    size_t usedBytes_{0};
+
+    /** Gets the segment with the specified ID (unsafe) */
+    segment& get_segment(uint32_t id);
+    /** Gets the file path for the segment with the ID */
+    string segment_path(uint32_t id) const;
+    /** Creates and maps a new segment with at least 'n' bytes (unsafe) */
+    segment& add_segment(size_t n);
+    /** Maps an existing segment file (unsafe) */
+    segment map_segment(uint32_t id);
+    /** Unmaps and closes a segment */
+    static void close_segment(segment& seg);
+    /** Rebuilds the index from the segments on disk (unsafe) */
+    void recover();
+    /** Scans an existing segment, applying its records to the index */
+    void scan_segment(segment& seg);
+    /** Appends a record to the log, returning its location (unsafe) */
+    location append(const string& key, const std::vector<string_view>& bufs, bool tombstone);
+    /** Gets a view of the value for the key in the log (unsafe) */
+    string_view find_value(const string& key) const;
+    /** Marks the data for an index entry as dead (unsafe) */
+    void release(const location& loc);
+    /** Removes any dead segments from the front of the log (unsafe) */
+    void trim();
+    /** Copies the live data out of the old segments (unsafe) */
+    void do_compact();
+    /** Closes all the segments (unsafe) */
+    void close_all();
+
+public:
+    /**
+     * Creates a log persistence store.
+     * @param baseDir The directory under which the stores are kept.
+     *  			  Each client gets its own subdirectory, named for the
+     *  			  client ID and server URI.
+     * @param segSize The size of each log segment file.
+     * @param syncWrites Whether to flush each change to disk before
+     *  				 returning.
+     */
+    explicit log_persistence(
+        const string& baseDir, size_t segSize = DFLT_SEGMENT_SIZE, bool syncWrites = false
+    );
+    /**
+     * Destroys the store, closing it if it's still open.
+     */
+    ~log_persistence() override;
+    /**
+     * Gets the directory of the open store.
+     * @return The directory of the open store, or an empty string if it
+     *  	   is not open.
+     */
+    string get_directory() const {
+        guard g{lock_};
+        return dir_;
+    }
+    /**
+     * Gets the number of segment files in use.
+     * @return The number of segment files in use.
+     */
+    size_t num_segments() const {
+        guard g{lock_};
+        return segs_.size();
+    }
+    /**
+     * Gets the number of bytes of live data in the log.
+     * @return The number of bytes of live data in the log.
+     */
+    size_t live_bytes() const {
+        guard g{lock_};
+        return liveBytes_;
+    }
+    /**
+     * Copies all of the live data to new segments, and removes the old
+     * ones.
+     */
+    void compact();
+    /**
+     * Opens the store for the client.
+     * This creates the directory, if needed, and rebuilds the index from
+     * any segments that are already in it.
+     * @param clientId The identifier string for the client.
+     * @param serverURI The server to which the client is connected.
+     */
+    void open(const string& clientId, const string& serverURI) override;
+    /**
+     * Closes the store, leaving the data on disk.
+     */
+    void close() override;
+    /**
+     * Removes all of the data from the store.
+     */
+    void clear() override;
+    /**
+     * Determines if there is data for the key.
+     * @param key The key to find
+     * @return @em true if the key exists, @em false if not.
+     */
+    bool contains_key(const string& key) override;
+    /**
+     * Gets the keys in the store.
+     * @return A collection of the keys in the store.
+     */
+    string_collection keys() const override;
+    /**
+     * Calls a handler with each of the keys in the store, straight from
+     * the index. The handler must not call back into the store.
+     * @param fn The handler to call with each key.
+     */
+    void for_each_key(const key_handler& fn) const override;
+    /**
+     * Appends the data for the key to the log.
+     * @param key The key.
+     * @param bufs The data to store
+     */
+    void put(const string& key, const std::vector<string_view>& bufs) override;
+    /**
+     * Gets the data for the key.
+     * @param key The key
+     * @return The data associated with the key.
+     */
+    string get(const string& key) const override;
+    /**
+     * Gets the data for the key, copying it straight from the log into a
+     * buffer allocated with @ref persistence_malloc().
+     * @param key The key
+     * @param len Gets the length of the data, in bytes.
+     * @return A buffer holding the data. The caller takes ownership of it.
+     */
+    char* get_into(const string& key, size_t* len) const override;
+    /**
+     * Gets the data for a batch of keys, to restore a session.
+     * The values are all copied out of the log under a single lock, and
+     * when there is a lot of data, by several threads at once.
+     * @param keys The keys to read.
+     * @return The values, in the same order as the keys. A key that isn't
+     *  	   in the store gets a null buffer.
+     */
+    std::vector<restored_value> get_all(const std::vector<string>& keys) const override;
+    /**
+     * Removes the data for the key.
+     * @param key The key
+     */
+    void remove(const string& key) override;
+    /**
+     * Flushes everything written since the last sync to disk.
+     */
+    void sync() override;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_log_persistence_h
@@ -0,0 +1,375 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file loopback_client.h
+/// Declaration of MQTT loopback_broker and loopback_client classes, an
+/// in-process transport that needs no server.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_loopback_client_h
+#define __mqtt_loopback_client_h
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mqtt/callback.h"
+#include "mqtt/delivery_token.h"
+#include "mqtt/event.h"
+#include "mqtt/iasync_client.h"
+#include "mqtt/last_value_cache.h"
+#include "mqtt/thread_queue.h"
+#include "mqtt/token.h"
+#include "mqtt/topic_matcher.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+class loopback_client;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An in-process stand-in for an MQTT server.
+ *
+ * The broker routes the messages published by its @ref loopback_client
+ * objects to the ones that subscribed to matching filters, using a
+ * @ref topic_matcher. It keeps the retained messages, grants each
+ * subscription the QoS that was asked for, and honors the @em no_local
+ * and @em retain_as_published subscribe options and the retain handling
+ * of new subscriptions. Each client gets a message no more than once,
+ * at the highest QoS of its matching subscriptions.
+ * @par
+ * There are no sessions: the subscriptions of a client are dropped when
+ * it disconnects, and nothing is queued for it while it's away.
+ * @par
+ * Messages are shared with the subscribers, not copied, unless the QoS or
+ * retained flag has to change on the way out.
+ */
+class loopback_broker
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<loopback_broker>;
+
+    /** The URI reported by the clients of a broker */
+    static constexpr const char* SERVER_URI = "loopback://broker";
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** A client's subscription to a filter */
+    struct subscriber
+    {
+        /** The client */
+        loopback_client* cli;
+        /** The granted QoS */
+        int qos;
+        /** Whether the client's own messages are kept from it */
+        bool noLocal;
+        /** Whether the retained flag is sent as published */
+        bool retainAsPublished;
+    };
+
+    /** The subscribers for each filter */
+    using subscriber_list = std::vector<subscriber>;
+
+    /** Lock for the subscriptions */
+    mutable std::mutex lock_;
+    /** The subscriptions, by filter */
+    topic_matcher<subscriber_list> subs_;
+    /** The retained messages */
+    last_value_cache retained_{0, true};
+
+    friend class loopback_client;
+
+    /**
+     * Adds or replaces a subscription.
+     * @return The retained messages to send for it.
+     */
+    std::vector<const_message_ptr> subscribe(
+        loopback_client* cli, const string& filter, int qos, const subscribe_options& opts
+    );
+    /**
+     * Removes a subscription.
+     * @return @em true if the client had subscribed to the filter.
+     */
+    bool unsubscribe(loopback_client* cli, const string& filter);
+    /**
+     * Removes all of a client's subscriptions.
+     */
+    void remove(loopback_client* cli);
+    /**
+     * Sends a message to the matching subscribers.
+     */
+    void route(loopback_client* from, const const_message_ptr& msg);
+
+public:
+    /**
+     * Creates a broker.
+     */
+    loopback_broker() = default;
+    /**
+     * Creates a broker on the heap, to be shared by its clients.
+     * @return A shared pointer to the new broker.
+     */
+    static ptr_t create() { return std::make_shared<loopback_broker>(); }
+
+    loopback_broker(const loopback_broker&) = delete;
+    loopback_broker& operator=(const loopback_broker&) = delete;
+
+    /**
+     * Gets the number of retained messages.
+     * @return The number of topics that have a retained message.
+     */
+    std::size_t num_retained() const { return retained_.size(); }
+};
+
+/** Smart/shared pointer to a loopback_broker */
+using loopback_broker_ptr = loopback_broker::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A client that talks to a @ref loopback_broker in the same process.
+ *
+ * This is a full implementation of @ref iasync_client that runs the same
+ * data path as a networked client, without the network, so that apps and
+ * benchmarks can measure the CPU cost of their handlers, and tests can run
+ * without a server.
+ * @par
+ * As with the C library, every client has a thread of its own on which the
+ * tokens are completed and the callbacks are made, in order. Requests are
+ * acknowledged after the broker has acted on them, so that when a publish
+ * token completes, the message has been queued for all of the subscribers.
+ * Requests made while the client is not connected throw an @ref exception
+ * with the code MQTTASYNC_DISCONNECTED.
+ * @par
+ * Incoming messages go to the callback, and to the consumer queue if it
+ * was started, as with @ref async_client.
+ */
+class loopback_client : public virtual iasync_client
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<loopback_client>;
+    /** Handler for incoming messages */
+    using message_handler = std::function<void(const_message_ptr)>;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** A task for the client thread */
+    using job = std::function<void()>;
+
+    /** The broker */
+    loopback_broker_ptr broker_;
+    /** The client ID */
+    const string clientId_;
+    /** Whether the client is connected */
+    std::atomic<bool> connected_{false};
+
+    /** Lock for the members below */
+    mutable std::mutex lock_;
+    /** The user callback (if any) */
+    callback* userCallback_{nullptr};
+    /** The message handler (if any) */
+    message_handler msgHandler_;
+    /** The consumer queue (if started) */
+    std::unique_ptr<thread_queue<event>> que_;
+    /** The delivery tokens that are not complete, by message ID */
+    std::map<int, delivery_token_ptr> pendingTokens_;
+    /** The last message ID handed out */
+    int lastMsgId_{0};
+
+    /** The tasks for the client thread */
+    thread_queue<job> jobs_;
+    /** The client thread */
+    std::thread thr_;
+
+    friend class loopback_broker;
+
+    /** Runs the tasks on the client thread, until the empty one */
+    void run();
+    /** Queues a task for the client thread */
+    void post(job fn) { jobs_.put(std::move(fn)); }
+    /** Throws if the client is not connected */
+    void check_connected() const;
+    /** Queues a message from the broker */
+    void deliver(const_message_ptr msg);
+    /** Completes a token successfully */
+    static void succeed(token_ptr tok, int msgId, std::vector<int> codes = {});
+    /** Gets the ID for the next QoS 1 or 2 message */
+    int next_message_id();
+
+    /** Gets the consumer queue, or throws if it wasn't started */
+    thread_queue<event>* consumer_queue() const;
+
+    /** Carries out a connect request */
+    token_ptr connect_token(token_ptr tok);
+    /** Carries out a disconnect request */
+    token_ptr disconnect_token(token_ptr tok);
+    /** Carries out a publish request */
+    delivery_token_ptr publish_token(delivery_token_ptr tok);
+    /** Carries out a subscribe request */
+    token_ptr subscribe_token(
+        token_ptr tok, const std::vector<string>& filters, const qos_collection& qos,
+        const std::vector<subscribe_options>& opts
+    );
+    /** Carries out an unsubscribe request */
+    token_ptr unsubscribe_token(token_ptr tok, const std::vector<string>& filters);
+
+    /** Non-copyable */
+    loopback_client() = delete;
+    loopback_client(const loopback_client&) = delete;
+    loopback_client& operator=(const loopback_client&) = delete;
+
+public:
+    /**
+     * Creates a client of a broker.
+     * @param broker The broker.
+     * @param clientId The client ID.
+     */
+    loopback_client(loopback_broker_ptr broker, const string& clientId);
+    /**
+     * Destructor.
+     * The client is disconnected, and its thread is stopped.
+     */
+    ~loopback_client() override;
+    /**
+     * Gets the broker for this client.
+     * @return The broker.
+     */
+    loopback_broker_ptr get_broker() const { return broker_; }
+    /**
+     * Sets a handler for incoming messages. This is called in place of
+     * the message_arrived() of any user callback.
+     * @param cb The handler.
+     */
+    void set_message_callback(message_handler cb);
+
+    // ----- iasync_client -----
+
+    /** Removes a completed delivery token from the pending list. */
+    void remove_token(token* tok) override;
+
+    token_ptr connect() override;
+    token_ptr connect(connect_options options) override;
+    token_ptr connect(
+        connect_options options, void* userContext, iaction_listener& cb
+    ) override;
+    token_ptr connect(void* userContext, iaction_listener& cb) override;
+    token_ptr reconnect() override { return connect(); }
+
+    token_ptr disconnect() override;
+    token_ptr disconnect(disconnect_options opts) override;
+    token_ptr disconnect(int timeout) override;
+    token_ptr disconnect(int timeout, void* userContext, iaction_listener& cb) override;
+    token_ptr disconnect(void* userContext, iaction_listener& cb) override;
+
+    delivery_token_ptr get_pending_delivery_token(int msgID) const override;
+    std::vector<delivery_token_ptr> get_pending_delivery_tokens() const override;
+
+    string get_client_id() const override { return clientId_; }
+    string get_server_uri() const override { return loopback_broker::SERVER_URI; }
+    bool is_connected() const override { return connected_; }
+
+    delivery_token_ptr publish(
+        string_ref topic, const void* payload, size_t n, int qos, bool retained,
+        const properties& props = properties()
+    ) override;
+    delivery_token_ptr publish(string_ref topic, const void* payload, size_t n) override;
+    delivery_token_ptr publish(
+        string_ref topic, const void* payload, size_t n, int qos, bool retained,
+        void* userContext, iaction_listener& cb
+    ) override;
+    delivery_token_ptr publish(
+        string_ref topic, binary_ref payload, int qos, bool retained,
+        const properties& props = properties()
+    ) override;
+    delivery_token_ptr publish(string_ref topic, binary_ref payload) override;
+    delivery_token_ptr publish(const_message_ptr msg) override;
+    delivery_token_ptr publish(
+        const_message_ptr msg, void* userContext, iaction_listener& cb
+    ) override;
+
+    void set_callback(callback& cb) override;
+    void disable_callbacks() override;
+
+    token_ptr subscribe(
+        const string& topicFilter, int qos,
+        const subscribe_options& opts = subscribe_options(),
+        const properties& props = properties()
+    ) override;
+    token_ptr subscribe(
+        const string& topicFilter, int qos, void* userContext, iaction_listener& cb,
+        const subscribe_options& opts = subscribe_options(),
+        const properties& props = properties()
+    ) override;
+    token_ptr subscribe(
+        const_string_collection_ptr topicFilters, const qos_collection& qos,
+        const std::vector<subscribe_options>& opts = std::vector<subscribe_options>(),
+        const properties& props = properties()
+    ) override;
+    token_ptr subscribe(
+        const_string_collection_ptr topicFilters, const qos_collection& qos,
+        void* userContext, iaction_listener& cb,
+        const std::vector<subscribe_options>& opts = std::vector<subscribe_options>(),
+        const properties& props = properties()
+    ) override;
+
+    token_ptr unsubscribe(
+        const string& topicFilter, const properties& props = properties()
+    ) override;
+    token_ptr unsubscribe(
+        const_string_collection_ptr topicFilters, const properties& props = properties()
+    ) override;
+    token_ptr unsubscribe(
+        const_string_collection_ptr topicFilters, void* userContext, iaction_listener& cb,
+        const properties& props = properties()
+    ) override;
+    token_ptr unsubscribe(
+        const string& topicFilter, void* userContext, iaction_listener& cb,
+        const properties& props = properties()
+    ) override;
+
+    void start_consuming() override;
+    void stop_consuming() override;
+    void clear_consumer() override;
+    bool consumer_closed() noexcept override;
+    bool consumer_done() noexcept override;
+    std::size_t consumer_queue_size() const override;
+
+    const_message_ptr consume_message() override;
+    bool try_consume_message(const_message_ptr* msg) override;
+    event consume_event() override;
+    bool try_consume_event(event* evt) override;
+};
+
+/** Smart/shared pointer to a loopback_client */
+using loopback_client_ptr = loopback_client::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_loopback_client_h
@@ -0,0 +1,287 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file memory_persistence.h
+/// Declaration of MQTT memory_persistence class, an in-memory persistence
+/// store with a bounded memory budget.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_memory_persistence_h
+#define __mqtt_memory_persistence_h
+
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "mqtt/iclient_persistence.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An in-memory persistence store with a bounded memory budget.
+ *
+ * This keeps the persisted data in RAM, so it doesn't survive a restart of
+ * the application, but lets a client buffer messages through an outage
+ * without any disk I/O, and without growing past a fixed amount of
+ * memory.
+ *
+ * The values are kept in "slabs," blocks of memory that are carved up into
+ * equal-size slots for one of a number of size classes. Values that are too
+ * big for the largest class get an allocation of their own. A slab is
+ * released as soon as it's empty. The budget applies to all the memory
+ * held by the store: the slabs, the large values, and the keys.
+ *
+ * When a put would exceed the budget, the store either rejects it, by
+ * throwing a @ref persistence_exception, or evicts the oldest entries
+ * until the new data fits, depending on the policy. Note that evicting
+ * persisted packets means that the library loses track of the messages
+ * that they held. The store keeps counts of the evictions and rejections
+ * that can be used to monitor this.
+ */
+class memory_persistence : public iclient_persistence
+{
+public:
+    /** What to do when a put would exceed the memory budget */
+    enum EvictPolicy {
+        REJECT,       ///< Fail the put
+        EVICT_OLDEST  ///< Remove the oldest entries until it fits
+    };
+
+    /** The default memory budget, in bytes */
+    static constexpr size_t DFLT_MAX_BYTES = 16 * 1024 * 1024;
+    /** The size of each slab */
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    /** The smallest slot size */
+    static constexpr size_t MIN_SLOT_SIZE = 64;
+    /** The number of slot size classes, doubling from the smallest */
+    static constexpr size_t N_CLASSES = 9;
+    /** The memory charged for each entry beyond the key and value */
+    static constexpr size_t ENTRY_OVERHEAD = 64;
+
+private:
+    /** A slab of equal-size slots */
+    struct slab
+    {
+        /** The memory for the slots */
+        std::unique_ptr<char[]> mem;
+        /** The indexes of the free slots */
+        std::vector<uint32_t> freeSlots;
+    };
+
+    /** The slabs for one size class */
+    struct size_class
+    {
+        /** The size of each slot */
+        size_t slotSize{0};
+        /** The slabs, by ID */
+        std::unordered_map<uint32_t, slab> slabs;
+        /** The IDs of slabs that have free slots */
+        std::vector<uint32_t> avail;
+        /** The next slab ID */
+        uint32_t nextId{0};
+    };
+
+    /** A stored value */
+    struct entry
+    {
+        /** The data */
+        char* data{nullptr};
+        /** The length of the data */
+        size_t len{0};
+        /** The size class, or N_CLASSES for a large value */
+        size_t cls{N_CLASSES};
+        /** The slab that holds the data */
+        uint32_t slabId{0};
+        /** The position of the key in the age order */
+        std::list<string>::iterator age;
+    };
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** The memory budget */
+    size_t maxBytes_;
+    /** The eviction policy */
+    EvictPolicy policy_;
+    /** The slab size classes */
+    std::array<size_class, N_CLASSES> classes_;
+    /** The entries, by key */
+    std::unordered_map<string, entry> index_;
+    /** The keys, from the oldest to the newest */
+    std::list<string> ages_;
+    /** The memory held by the store */
+    size_t memUsed_{0};
+    /** The number of bytes of data */
+    size_t dataBytes_{0};
+    /** The number of entries evicted */
+    size_t nEvicted_{0};
+    /** The number of puts rejected */
+    size_t nRejected_{0};
+
+    /** Gets the size class for a value, or N_CLASSES if it's too big */
+    static size_t class_of(size_t n);
+    /** The extra memory needed to store a value in the class (unsafe) */
+    size_t memory_needed(size_t cls, size_t n) const;
+    /** Gets a slot from the class, allocating a new slab if needed */
+    char* alloc_slot(size_t cls, uint32_t* slabId);
+    /** Returns a slot to its slab, releasing the slab if empty */
+    void free_slot(size_t cls, uint32_t slabId, char* p);
+    /** Releases the memory for an entry and erases it (unsafe) */
+    void erase(std::unordered_map<string, entry>::iterator it);
+
+public:
+    /**
+     * Creates an in-memory store.
+     * @param maxBytes The memory budget, in bytes.
+     * @param policy What to do when a put would exceed the budget.
+     */
+    explicit memory_persistence(
+        size_t maxBytes = DFLT_MAX_BYTES, EvictPolicy policy = REJECT
+    );
+    /**
+     * Destroys the store, releasing all the data.
+     */
+    ~memory_persistence() override;
+    /**
+     * Gets the memory budget.
+     * @return The memory budget, in bytes.
+     */
+    size_t get_max_bytes() const { return maxBytes_; }
+    /**
+     * Gets the eviction policy.
+     * @return The eviction policy.
+     */
+    EvictPolicy get_policy() const { return policy_; }
+    /**
+     * Gets the number of entries in the store.
+     * @return The number of entries in the store.
+     */
+    size_t size() const {
+        guard g{lock_};
+        return index_.size();
+    }
+    /**
+     * Gets the number of bytes of data held in the store.
+     * @return The total size of the values, in bytes.
+     */
+    size_t data_bytes() const {
+        guard g{lock_};
+        return dataBytes_;
+    }
+    /**
+     * Gets the amount of memory held by the store, which is what counts
+     * against the budget.
+     * @return The memory held by the store, in bytes.
+     */
+    size_t memory_used() const {
+        guard g{lock_};
+        return memUsed_;
+    }
+    /**
+     * Gets the number of entries that were evicted to make room for new
+     * data.
+     * @return The number of entries evicted.
+     */
+    size_t num_evicted() const {
+        guard g{lock_};
+        return nEvicted_;
+    }
+    /**
+     * Gets the number of puts that were rejected for lack of room.
+     * @return The number of puts rejected.
+     */
+    size_t num_rejected() const {
+        guard g{lock_};
+        return nRejected_;
+    }
+    /**
+     * Opens the store. This does nothing, as the data is kept in memory.
+     * @param clientId The identifier string for the client.
+     * @param serverURI The server to which the client is connected.
+     */
+    void open(const string& clientId, const string& serverURI) override;
+    /**
+     * Closes the store. The data is kept in case the store is reopened.
+     */
+    void close() override {}
+    /**
+     * Removes all the data from the store, and releases its memory.
+     */
+    void clear() override;
+    /**
+     * Determines if there is data for the key.
+     * @param key The key to find
+     * @return @em true if the key exists, @em false if not.
+     */
+    bool contains_key(const string& key) override;
+    /**
+     * Gets the keys in the store.
+     * @return A collection of the keys in the store.
+     */
+    string_collection keys() const override;
+    /**
+     * Calls a handler with each of the keys in the store, oldest first.
+     * The handler must not call back into the store.
+     * @param fn The handler to call with each key.
+     */
+    void for_each_key(const key_handler& fn) const override;
+    /**
+     * Puts the data for the key into the store.
+     * @param key The key.
+     * @param bufs The data to store
+     * @throw persistence_exception if the data doesn't fit in the budget.
+     */
+    void put(const string& key, const std::vector<string_view>& bufs) override;
+    /**
+     * Gets the data for the key.
+     * @param key The key
+     * @return The data associated with the key.
+     */
+    string get(const string& key) const override;
+    /**
+     * Gets the data for the key, copied straight into a buffer allocated
+     * with @ref persistence_malloc().
+     * @param key The key
+     * @param len Gets the length of the data, in bytes.
+     * @return A buffer holding the data. The caller takes ownership of it.
+     */
+    char* get_into(const string& key, size_t* len) const override;
+    /**
+     * Gets the data for a batch of keys, under a single lock.
+     * @param keys The keys to read.
+     * @return The values, in the same order as the keys. A key that isn't
+     *  	   in the store gets a null buffer.
+     */
+    std::vector<restored_value> get_all(const std::vector<string>& keys) const override;
+    /**
+     * Removes the data for the key.
+     * @param key The key
+     */
+    void remove(const string& key) override;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_memory_persistence_h
@@ -0,0 +1,191 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file memory_usage.h
+/// Declaration of MQTT memory_usage class, an accounting of the memory
+/// that an async_client holds, by what it's holding it for.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_memory_usage_h
+#define __mqtt_memory_usage_h
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A lock-free count of bytes, which keeps its high-water mark.
+ */
+class memory_gauge
+{
+    /** The number of bytes */
+    std::atomic<std::size_t> bytes_{0};
+    /** The most bytes there have been */
+    std::atomic<std::size_t> peak_{0};
+
+public:
+    /**
+     * Adds to the count.
+     * @param n The number of bytes to add.
+     */
+    void add(std::size_t n) noexcept {
+        auto val = bytes_.fetch_add(n, std::memory_order_relaxed) + n;
+        auto peak = peak_.load(std::memory_order_relaxed);
+        while (val > peak &&
+               !peak_.compare_exchange_weak(peak, val, std::memory_order_relaxed));
+    }
+    /**
+     * Takes from the count.
+     * @param n The number of bytes to take, which should have been added.
+     */
+    void sub(std::size_t n) noexcept { bytes_.fetch_sub(n, std::memory_order_relaxed); }
+    /**
+     * Gets the number of bytes.
+     * @return The number of bytes.
+     */
+    std::size_t bytes() const noexcept { return bytes_.load(std::memory_order_relaxed); }
+    /**
+     * Gets the most bytes there have been.
+     * @return The high-water mark, in bytes.
+     */
+    std::size_t peak() const noexcept { return peak_.load(std::memory_order_relaxed); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A snapshot of the memory that an async_client is holding, by category,
+ * with the high-water mark of each.
+ *
+ * Get one with `async_client::get_memory_usage()`. The sizes are
+ * estimates: a message counts for the object, and its topic, payload, and
+ * properties, as given by `message::memory_size()`, and a token for the
+ * object and its topics. They leave out the overhead of the allocator and
+ * the containers, and the memory that the C library holds on its own, but
+ * they grow and shrink with the real thing, which is what matters for
+ * seeing where the memory goes under load. A message that waits in the
+ * offline buffer is shared with its delivery token, so it's counted in
+ * both, and the total errs on the high side.
+ * @par
+ * The high-water marks are kept by the client and each of the queues, so
+ * they catch the peaks between snapshots. The one for the consumer queue,
+ * offline buffer, or cache starts over when it's replaced.
+ */
+class memory_usage
+{
+public:
+    /** The things that the client holds memory for */
+    enum category {
+        /** The tokens for actions other than publishing */
+        PENDING_TOKENS,
+        /** The delivery tokens, with the messages being published */
+        DELIVERY_TOKENS,
+        /** The incoming messages and events in the consumer queue */
+        CONSUMER_QUEUE,
+        /** The messages held by the offline buffer */
+        OFFLINE_BUFFER,
+        /** The retained and latest messages in the last value cache */
+        LAST_VALUE_CACHE
+    };
+
+    /** The number of categories */
+    static constexpr std::size_t N_CATEGORIES = 5;
+
+private:
+    /** The bytes for each category */
+    std::size_t bytes_[N_CATEGORIES]{};
+    /** The high-water mark for each category */
+    std::size_t peaks_[N_CATEGORIES]{};
+
+    /** The client fills in the snapshot */
+    friend class async_client;
+
+    /** Sets the values of a category */
+    void set(category c, std::size_t n, std::size_t peak) {
+        bytes_[c] = n;
+        peaks_[c] = (peak < n) ? n : peak;
+    }
+
+public:
+    /**
+     * Creates a snapshot with everything zero.
+     */
+    memory_usage() {}
+    /**
+     * Gets the name of a category, for logs and exporters.
+     * @param c The category.
+     * @return The name of the category.
+     */
+    static const char* name(category c) {
+        static const char* NAMES[N_CATEGORIES] = {
+            "pending_tokens", "delivery_tokens", "consumer_queue", "offline_buffer",
+            "last_value_cache"
+        };
+        return (std::size_t(c) < N_CATEGORIES) ? NAMES[c] : "";
+    }
+    /**
+     * Gets the bytes held for a category.
+     * @param c The category.
+     * @return The number of bytes.
+     */
+    std::size_t bytes(category c) const { return bytes_[c]; }
+    /**
+     * Gets the most bytes that have been held for a category.
+     * @param c The category.
+     * @return The high-water mark, in bytes.
+     */
+    std::size_t peak(category c) const { return peaks_[c]; }
+    /**
+     * Gets the bytes held for all the categories.
+     * @return The total number of bytes.
+     */
+    std::size_t total() const {
+        std::size_t n = 0;
+        for (auto b : bytes_) n += b;
+        return n;
+    }
+    /**
+     * Adds the values of another snapshot to this one, to total the
+     * memory of a number of clients. The high-water marks are added as
+     * well, which is an upper bound of the combined peak.
+     * @param rhs The snapshot to add.
+     * @return A reference to this object.
+     */
+    memory_usage& operator+=(const memory_usage& rhs) {
+        for (std::size_t i = 0; i < N_CATEGORIES; ++i) {
+            bytes_[i] += rhs.bytes_[i];
+            peaks_[i] += rhs.peaks_[i];
+        }
+        return *this;
+    }
+};
+
+/**
+ * Handler for when a client goes over its soft memory limit.
+ * It's called with the usage that went over.
+ */
+using memory_limit_handler = std::function<void(const memory_usage&)>;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_memory_usage_h
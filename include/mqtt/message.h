@@ -25,16 +25,27 @@
 #ifndef __mqtt_message_h
 #define __mqtt_message_h
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <typeindex>
 
 #include "MQTTAsync.h"
 #include "mqtt/buffer_ref.h"
 #include "mqtt/exception.h"
+#include "mqtt/payload_codec.h"
 #include "mqtt/platform.h"
+#include "mqtt/pool_allocator.h"
 #include "mqtt/properties.h"
+#include "mqtt/serializer.h"
 
 namespace mqtt {
 
+class ack_tracker;
+
 /////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -61,6 +72,20 @@ public:
     /** The default retained flag */
     static constexpr bool DFLT_RETAINED = false;
 
+    /** The priority for latency-critical messages, like commands or alarms */
+    static constexpr int PRIORITY_HIGH = 0;
+    /** The priority for ordinary messages */
+    static constexpr int PRIORITY_NORMAL = 1;
+    /** The priority for bulk messages, like telemetry */
+    static constexpr int PRIORITY_LOW = 2;
+    /** The default priority */
+    static constexpr int DFLT_PRIORITY = PRIORITY_NORMAL;
+
+    /** The clock for the time that a message arrived or was queued */
+    using clock = std::chrono::steady_clock;
+    /** A time point for the clock */
+    using time_point = clock::time_point;
+
 private:
     /** Initializer for the C struct (from the C library) */
     static constexpr MQTTAsync_message DFLT_C_STRUCT MQTTAsync_message_initializer;
@@ -73,15 +98,117 @@ private:
     binary_ref payload_;
     /** The properties for the message  */
     properties props_;
+    /** The priority of the message in the client, which isn't sent */
+    int priority_{DFLT_PRIORITY};
+    /** Whether a newer held message on the topic replaces this one */
+    bool conflate_{false};
+    /** The time the message arrived or was queued, if known */
+    time_point timestamp_{};
+    /** The time the message expires, or the max time if it doesn't */
+    time_point expiryTime_{time_point::max()};
+    /** The time an incoming message was put in the consumer queue, if it was */
+    time_point queueTime_{};
+    /** The time an incoming message was taken from the consumer queue */
+    mutable time_point dequeueTime_{};
+
+    /** The payload of an incoming message, decoded when it's first read */
+    struct decoded_payload
+    {
+        /** The codec for the payload */
+        payload_codec_ptr codec;
+        /** Makes sure the payload is only decoded once */
+        std::once_flag once;
+        /** The decoded payload */
+        binary_ref payload;
+        /** Whether the payload was decoded */
+        std::atomic<bool> done{false};
+    };
+    /** The lazily decoded payload, shared by copies (if any) */
+    std::shared_ptr<decoded_payload> decoded_;
 
+    /** The properties of an adopted C message, converted when first read */
+    struct adopted_properties
+    {
+        /** The C message, which owns the properties list */
+        std::shared_ptr<const MQTTAsync_message> cmsg;
+        /** Makes sure the properties are only converted once */
+        std::once_flag once;
+        /** The converted properties */
+        properties props;
+    };
+    /** The properties still in the adopted C message, shared by copies */
+    std::shared_ptr<adopted_properties> adoptedProps_;
+
+    /** An object parsed from the payload, cached for all its readers */
+    struct parsed_payload
+    {
+        /** The type of the object */
+        std::type_index type;
+        /** The object */
+        std::shared_ptr<const void> obj;
+    };
+    /**
+     * The parsed payload (if any), shared by copies.
+     * This is set by readers of a const message, so it must be accessed
+     * atomically.
+     */
+    mutable std::shared_ptr<const parsed_payload> parsed_;
+    /** The tracker for a message that the app acks itself (if any) */
+    std::weak_ptr<ack_tracker> ackTracker_;
+    /** The place of the message in the tracker's arrival order */
+    uint64_t ackSeq_{0};
+
+    /** The ack tracker sets the handle to ack the message. */
+    friend class ack_tracker;
     /** The client has special access. */
     friend class async_client;
+    /** The bridge hands the ack handle to the messages it copies. */
+    friend class bridge;
+    /** The duplicate filter reads the packet ID and properties. */
+    friend class duplicate_filter;
+    /** The capture reader restores the dup flag. */
+    friend class message_capture;
+    /** The builder has special access. */
+    friend class message_ptr_builder;
+    /** The shared memory reader restores the dup flag. */
+    friend class shm_fanout_reader;
 
+    /**
+     * Updates the time the message expires, from the timestamp and the
+     * Message Expiry Interval property.
+     */
+    void update_expiry_time();
     /**
      * Set the dup flag in the underlying message
      * @param dup Whether to set the dup flag.
      */
     void set_duplicate(bool dup) { msg_.dup = to_int(dup); }
+    /**
+     * Sets the codec to decode the payload when it's first read.
+     * @param codec The codec for the payload.
+     */
+    void set_payload_codec(payload_codec_ptr codec);
+    /**
+     * Decodes the payload, if it wasn't already.
+     * @return The decoded payload.
+     */
+    const binary_ref& decode_payload() const;
+    /**
+     * Gets the payload, decoded if need be.
+     */
+    const binary_ref& payload_ref() const { return decoded_ ? decode_payload() : payload_; }
+    /**
+     * Converts the properties of an adopted C message, if it wasn't
+     * already done.
+     * @return The properties.
+     */
+    const properties& convert_properties() const;
+    /**
+     * Points the C struct at the properties list, wherever it is.
+     */
+    void update_c_properties() {
+        msg_.properties = adoptedProps_ ? adoptedProps_->cmsg->properties : props_.c_struct();
+    }
 
 public:
     /** Smart/shared pointer to this class. */
@@ -89,6 +216,36 @@ public:
     /** Smart/shared pointer to this class. */
     using const_ptr_t = std::shared_ptr<const message>;
 
+private:
+    /**
+     * Creates a shared message.
+     * The message and its shared pointer control block are allocated
+     * together from a pool, and recycled when the last reference to the
+     * message is released.
+     */
+    template <typename... Args>
+    static ptr_t make_pooled(Args&&... args) {
+        return std::allocate_shared<message>(
+            pool_allocator<message>{}, std::forward<Args>(args)...
+        );
+    }
+#if defined(PAHO_MQTTPP_HAS_PMR)
+    /**
+     * Creates a shared message from a memory resource, if there is one.
+     * The message and its shared pointer control block are allocated
+     * together from the resource.
+     */
+    template <typename... Args>
+    static ptr_t make_in(std::pmr::memory_resource* mr, Args&&... args) {
+        if (!mr)
+            return make_pooled(std::forward<Args>(args)...);
+        return std::allocate_shared<message>(
+            std::pmr::polymorphic_allocator<message>{mr}, std::forward<Args>(args)...
+        );
+    }
+#endif
+
+public:
     /**
      * Constructs a message with an empty payload, and all other values set
      * to defaults.
@@ -144,6 +301,29 @@ public:
      * @param cmsg A "C" MQTTAsync_message structure.
      */
     message(string_ref topic, const MQTTAsync_message& cmsg);
+    /**
+     * Constructs a message from the message structure, but using the
+     * specified payload in place of the one in the structure.
+     * This is used to create a message that adopts the payload buffer
+     * from the C library, rather than copying it.
+     * @param topic The message topic
+     * @param payload The message payload.
+     * @param cmsg A "C" MQTTAsync_message structure.
+     */
+    message(string_ref topic, binary_ref payload, const MQTTAsync_message& cmsg);
+    /**
+     * Constructs a message that adopts a C message, without copying any
+     * of it.
+     * The payload refers to the buffer in the C message, and the
+     * properties are left in the C list until they're first read by
+     * get_properties(). So a message that is only routed by its topic,
+     * or forwarded on as-is, is never copied. The C message is freed when
+     * the last message that refers to it is destroyed.
+     * @param topic The message topic
+     * @param cmsg The "C" MQTTAsync_message, which must not be changed
+     *  		   after this.
+     */
+    message(string_ref topic, std::shared_ptr<const MQTTAsync_message> cmsg);
     /**
      * Constructs a message as a copy of the other message.
      * @param other The message to copy into this one.
@@ -172,7 +352,7 @@ public:
         string_ref topic, const void* payload, size_t len, int qos, bool retained,
         const properties& props = properties()
     ) {
-        return std::make_shared<message>(
+        return make_pooled(
             std::move(topic), payload, len, qos, retained, props
         );
     }
@@ -184,7 +364,7 @@ public:
      * @param len the number of bytes in the payload
      */
     static ptr_t create(string_ref topic, const void* payload, size_t len) {
-        return std::make_shared<message>(
+        return make_pooled(
             std::move(topic), payload, len, DFLT_QOS, DFLT_RETAINED
         );
     }
@@ -201,7 +381,7 @@ public:
         string_ref topic, binary_ref payload, int qos, bool retained,
         const properties& props = properties()
     ) {
-        return std::make_shared<message>(
+        return make_pooled(
             std::move(topic), std::move(payload), qos, retained, props
         );
     }
@@ -212,7 +392,7 @@ public:
      * @param payload A byte buffer to use as the message payload.
      */
     static ptr_t create(string_ref topic, binary_ref payload) {
-        return std::make_shared<message>(
+        return make_pooled(
             std::move(topic), std::move(payload), DFLT_QOS, DFLT_RETAINED
         );
     }
@@ -222,8 +402,90 @@ public:
      * @param msg A "C" MQTTAsync_message structure.
      */
     static ptr_t create(string_ref topic, const MQTTAsync_message& msg) {
-        return std::make_shared<message>(std::move(topic), msg);
+        return make_pooled(std::move(topic), msg);
+    }
+    /**
+     * Constructs a message from the C message struct, but using the
+     * specified payload in place of the one in the structure.
+     * @param topic The message topic
+     * @param payload The message payload.
+     * @param msg A "C" MQTTAsync_message structure.
+     */
+    static ptr_t create(string_ref topic, binary_ref payload, const MQTTAsync_message& msg) {
+        return make_pooled(std::move(topic), std::move(payload), msg);
+    }
+    /**
+     * Constructs a message that adopts a C message, without copying any
+     * of it.
+     * @param topic The message topic
+     * @param cmsg The "C" MQTTAsync_message, which must not be changed
+     *  		   after this.
+     */
+    static ptr_t create(string_ref topic, std::shared_ptr<const MQTTAsync_message> cmsg) {
+        return make_pooled(std::move(topic), std::move(cmsg));
+    }
+#if defined(PAHO_MQTTPP_HAS_PMR)
+    /**
+     * Constructs a message from a memory resource, like a per-batch arena.
+     * The message, its shared pointer control block, and the copy of the
+     * payload all come from the resource, which must outlive the message.
+     * The properties are still allocated by the C library.
+     * @param mr The memory resource. If null, this is the same as the
+     *  		 regular create().
+     * @param topic The message topic
+     * @param payload the bytes to use as the message payload
+     * @param len the number of bytes in the payload
+     * @param qos The quality of service for the message.
+     * @param retained Whether the message should be retained by the broker.
+     * @param props The MQTT v5 properties for the message.
+     */
+    static ptr_t create(
+        std::pmr::memory_resource* mr, string_ref topic, const void* payload, size_t len,
+        int qos, bool retained, const properties& props = properties()
+    ) {
+        return make_in(
+            mr, std::move(topic), binary_ref{mr, static_cast<const char*>(payload), len}, qos,
+            retained, props
+        );
+    }
+    /**
+     * Constructs a message from a memory resource, with a payload that was
+     * already created.
+     * The message and its shared pointer control block come from the
+     * resource, which must outlive the message.
+     * @param mr The memory resource. If null, this is the same as the
+     *  		 regular create().
+     * @param topic The message topic
+     * @param payload A byte buffer to use as the message payload.
+     * @param qos The quality of service for the message.
+     * @param retained Whether the message should be retained by the broker.
+     * @param props The MQTT v5 properties for the message.
+     */
+    static ptr_t create(
+        std::pmr::memory_resource* mr, string_ref topic, binary_ref payload, int qos,
+        bool retained, const properties& props = properties()
+    ) {
+        return make_in(mr, std::move(topic), std::move(payload), qos, retained, props);
+    }
+    /**
+     * Constructs a message from a memory resource, as a copy of a C
+     * message struct.
+     * The message, its shared pointer control block, and the copy of the
+     * payload all come from the resource, which must outlive the message.
+     * @param mr The memory resource. If null, this is the same as the
+     *  		 regular create().
+     * @param topic The message topic
+     * @param cmsg A "C" MQTTAsync_message structure.
+     */
+    static ptr_t create(
+        std::pmr::memory_resource* mr, string_ref topic, const MQTTAsync_message& cmsg
+    ) {
+        binary_ref payload{
+            mr, static_cast<const char*>(cmsg.payload), size_t(std::max(cmsg.payloadlen, 0))
+        };
+        return make_in(mr, std::move(topic), std::move(payload), cmsg);
     }
+#endif
     /**
      * Copies another message to this one.
      * @param rhs The other message.
@@ -268,22 +530,98 @@ public:
     void clear_payload();
     /**
      * Gets the payload reference.
+     * An incoming payload that was compressed by a @ref payload_codec is
+     * decoded the first time that it's read, by this or the other payload
+     * getters.
+     * @throw exception if the payload can't be decoded.
+     */
+    const binary_ref& get_payload_ref() const { return payload_ref(); }
+    /**
+     * Gets an object parsed from the payload, like a JSON document.
+     * The payload is parsed the first time it's asked for, and the object
+     * is kept with the message, and its copies, so that all the handlers
+     * of a message share one parse. Only the last type of object is kept,
+     * so asking for another type parses the payload again. If threads
+     * race to be the first, each might parse it, but they all get the
+     * same object back. The object is dropped when the payload changes.
+     * @tparam T The type of the parsed object.
+     * @param parse The function to parse the payload, as
+     *  			`std::shared_ptr<const T>(const binary_ref&)`. Anything
+     *  			it throws is passed on, and nothing is kept.
+     * @return The parsed object.
+     */
+    template <typename T, typename Parser>
+    std::shared_ptr<const T> get_parsed_payload(Parser parse) const {
+        const std::type_index type{typeid(T)};
+        auto cur = std::atomic_load(&parsed_);
+        if (cur && cur->type == type)
+            return std::static_pointer_cast<const T>(cur->obj);
+
+        std::shared_ptr<const T> obj = parse(payload_ref());
+        auto p = std::make_shared<const parsed_payload>(parsed_payload{type, obj});
+        if (!std::atomic_compare_exchange_strong(&parsed_, &cur, p) && cur &&
+            cur->type == type)
+            return std::static_pointer_cast<const T>(cur->obj);
+        return obj;
+    }
+    /**
+     * Gets the size of the payload, as it's held in the message.
+     * This doesn't decode the payload, so for one compressed by a
+     * @ref payload_codec, it's the compressed size.
+     * @return The size of the payload, in bytes.
      */
-    const binary_ref& get_payload_ref() const { return payload_; }
+    std::size_t get_payload_size() const noexcept { return std::size_t(msg_.payloadlen); }
+    /**
+     * Gets an estimate of the memory that the message holds: the object
+     * itself, and its topic, payload, and properties.
+     * A topic or payload that's shared with other messages is counted in
+     * full by each of them.
+     * @return The estimated size of the message, in bytes.
+     */
+    std::size_t memory_size() const noexcept {
+        const auto& props = msg_.properties;
+        return sizeof(message) + (topic_ ? topic_.size() : 0) + get_payload_size() +
+               std::size_t(props.length) + std::size_t(props.max_count) * sizeof(MQTTProperty);
+    }
     /**
      * Gets the payload
      */
     const binary& get_payload() const {
         static const binary EMPTY_BIN;
-        return payload_ ? payload_.str() : EMPTY_BIN;
+        const auto& payload = payload_ref();
+        return payload ? payload.str() : EMPTY_BIN;
     }
     /**
      * Gets the payload as a string
      */
     const string& get_payload_str() const {
         static const string EMPTY_STR;
-        return payload_ ? payload_.str() : EMPTY_STR;
+        const auto& payload = payload_ref();
+        return payload ? payload.str() : EMPTY_STR;
+    }
+    /**
+     * Decodes the payload as a typed value, using its @ref serializer.
+     *
+     * The serializer works on the payload in place, so a type that
+     * decodes to a view, like @em std::string_view, or a zero-copy format
+     * like flatbuffers, doesn't copy the data. Such a view is only valid
+     * for as long as the message is.
+     * @tparam T The type of value.
+     * @return Whatever the serializer for the type decodes.
+     * @throw exception if the payload can't be decoded.
+     */
+    template <typename T>
+    auto as() const -> decltype(serializer<T>::decode(std::declval<binary_view>())) {
+        const auto& payload = payload_ref();
+        return payload ? serializer<T>::decode(binary_view{payload.data(), payload.size()})
+                       : serializer<T>::decode(binary_view{nullptr, 0});
     }
+    /**
+     * Determines if the payload is still waiting to be decoded.
+     * @return @em true if the payload was compressed and hasn't been read
+     *  	   yet.
+     */
+    bool is_payload_encoded() const { return decoded_ && !decoded_->done; }
     /**
      * Returns the quality of service for this message.
      * @return The quality of service for this message.
@@ -342,18 +680,161 @@ public:
      *  			   broker, @em false if not.
      */
     void set_retained(bool retained) { msg_.retained = to_int(retained); }
+    /**
+     * Gets the priority of the message.
+     * @return The priority of the message, where zero is the highest.
+     */
+    int get_priority() const { return priority_; }
+    /**
+     * Sets the priority of the message.
+     *
+     * The priority only matters to the client, and isn't sent to the
+     * server. When the client holds messages back, in the queue of a rate
+     * limiter or in the offline buffer, it sends them in lanes by
+     * priority, so that urgent messages don't wait behind a backlog of
+     * bulk ones.
+     *
+     * @param prio The priority, where zero, @ref PRIORITY_HIGH, is the
+     *  		   highest. Negative values are taken as zero.
+     */
+    void set_priority(int prio) { priority_ = (prio < 0) ? 0 : prio; }
+    /**
+     * Determines if a newer held message on the topic replaces this one.
+     * @return @em true if the message is conflated, @em false if not.
+     */
+    bool get_conflate() const { return conflate_; }
+    /**
+     * Sets whether a newer held message on the topic replaces this one.
+     *
+     * This is for topics where only the latest value matters, like the
+     * state of a device. While the message waits in the offline buffer, a
+     * newer conflated message on the same topic takes its place, so the
+     * backlog has at most one message per topic to send on reconnect.
+     * Like the priority, this only matters to the client, and isn't sent
+     * to the server.
+     *
+     * @param on @em true to conflate the message, @em false to send it
+     *  		 even if a newer one follows.
+     */
+    void set_conflate(bool on) { conflate_ = on; }
+    /**
+     * Gets the Message Expiry Interval of the message.
+     * This is read from the properties without converting them.
+     * @return The expiry interval, in seconds, or zero if the message
+     *  	   doesn't expire.
+     */
+    uint32_t get_expiry_interval() const;
+    /**
+     * Gets the time that the message arrived, or was queued to be sent.
+     * @return The timestamp of the message, or the clock's epoch if it
+     *  	   was never set.
+     */
+    time_point get_timestamp() const { return timestamp_; }
+    /**
+     * Sets the time that the message arrived, or was queued to be sent.
+     * This starts its Message Expiry Interval, if it has one. The client
+     * sets it for incoming messages as they arrive.
+     * @param tp The time point.
+     */
+    void set_timestamp(time_point tp) {
+        timestamp_ = tp;
+        update_expiry_time();
+    }
+    /**
+     * Gets the time that an incoming message was put into the client's
+     * consumer queue.
+     * @return The time the message was queued, or the clock's epoch if it
+     *  	   never was.
+     */
+    time_point get_queue_time() const { return queueTime_; }
+    /**
+     * Gets the time that an incoming message was taken from the client's
+     * consumer queue by one of the consume calls.
+     * This is set by the consumer that took the message, so it's only
+     * meaningful to that consumer.
+     * @return The time the message was taken from the queue, or the
+     *  	   clock's epoch if it never was.
+     */
+    time_point get_dequeue_time() const { return dequeueTime_; }
+    /**
+     * Gets the time from when an incoming message arrived from the server
+     * until it was taken from the consumer queue.
+     * This is the time it spent in the client, which shows how far behind
+     * a consumer is.
+     * @return The time from arrival until the message was consumed, or
+     *  	   zero if it wasn't.
+     */
+    clock::duration get_consume_latency() const {
+        return (timestamp_ == time_point{} || dequeueTime_ == time_point{})
+                   ? clock::duration::zero()
+                   : dequeueTime_ - timestamp_;
+    }
+    /**
+     * Gets the time that an incoming message waited in the consumer queue.
+     * @return The time from when the message was queued until it was
+     *  	   consumed, or zero if it wasn't.
+     */
+    clock::duration get_queue_latency() const {
+        return (queueTime_ == time_point{} || dequeueTime_ == time_point{})
+                   ? clock::duration::zero()
+                   : dequeueTime_ - queueTime_;
+    }
+    /**
+     * Gets the time that the message expires.
+     * This is the timestamp plus the Message Expiry Interval.
+     * @return The expiry time, or the clock's max time if the message
+     *  	   doesn't have a timestamp and an expiry interval.
+     */
+    time_point get_expiry_time() const { return expiryTime_; }
+    /**
+     * Determines if the message expired.
+     * @param now The current time.
+     * @return @em true if the message has passed its expiry time.
+     */
+    bool is_expired(time_point now) const { return expiryTime_ <= now; }
+    /**
+     * Determines if the message has expired.
+     * This only reads the clock if the message can expire.
+     * @return @em true if the message has passed its expiry time.
+     */
+    bool is_expired() const {
+        return expiryTime_ != time_point::max() && expiryTime_ <= clock::now();
+    }
+    /**
+     * Determines if the app is expected to ack this message.
+     * This is the case for the QoS 1 and 2 messages that arrive while the
+     * client is in manual-ack mode. Copies of a message are new
+     * messages, and don't carry the handle.
+     * @return @em true if the message has an ack handle.
+     */
+    bool has_ack() const { return !ackTracker_.expired(); }
+    /**
+     * Acks a message that arrived in manual-ack mode, once the app is done
+     * with it.
+     * Messages can be acked in any order, from any thread. Acking a
+     * message more than once, or one without an ack handle, does nothing.
+     * @return The number of acks this released, in arrival order, which
+     *  	   is zero if an earlier message is still waiting.
+     */
+    std::size_t ack() const;
     /**
      * Gets the properties in the message.
+     * The properties of a message that adopted a C message are converted
+     * the first time that they're read.
      * @return A const reference to the properties in the message.
      */
-    const properties& get_properties() const { return props_; }
+    const properties& get_properties() const {
+        return adoptedProps_ ? convert_properties() : props_;
+    }
     /**
      * Sets the properties in the message.
      * @param props The properties to place into the message.
      */
     void set_properties(const properties& props) {
         props_ = props;
+        adoptedProps_.reset();
         msg_.properties = props_.c_struct();
+        update_expiry_time();
     }
     /**
      * Moves the properties into the message.
@@ -361,7 +842,9 @@ public:
      */
     void set_properties(properties&& props) {
         props_ = std::move(props);
+        adoptedProps_.reset();
         msg_.properties = props_.c_struct();
+        update_expiry_time();
     }
     /**
      * Returns a string representation of this messages payload.
@@ -444,7 +927,7 @@ public:
     /**
      * Default constructor.
      */
-    message_ptr_builder() : msg_{std::make_shared<message>()} {}
+    message_ptr_builder() : msg_{message::make_pooled()} {}
     /**
      * Sets the topic string.
      * @param topic The topic on which the message is published.
@@ -490,6 +973,22 @@ public:
         msg_->set_retained(on);
         return *this;
     }
+    /**
+     * Sets the priority of the message in the client.
+     * @param prio The priority, where zero is the highest.
+     */
+    auto priority(int prio) -> self& {
+        msg_->set_priority(prio);
+        return *this;
+    }
+    /**
+     * Sets whether a newer held message on the topic replaces this one.
+     * @param on @em true to conflate the message, @em false if not.
+     */
+    auto conflate(bool on = true) -> self& {
+        msg_->set_conflate(on);
+        return *this;
+    }
     /**
      * Sets the properties for the disconnect message.
      * @param props The properties for the disconnect message.
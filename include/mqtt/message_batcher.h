@@ -0,0 +1,274 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file message_batcher.h
+/// Declaration of MQTT message_batcher class, which packs small records
+/// for a topic into batch messages.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_message_batcher_h
+#define __mqtt_message_batcher_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mqtt/buffer_view.h"
+#include "mqtt/iasync_client.h"
+#include "mqtt/message.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Packs small records for a topic into batch messages.
+ *
+ * When an app has a flood of tiny records, the per-packet cost of the
+ * protocol, the broker, and the library swamps the data itself. The
+ * batcher packs the records into the payload of a single message, each one
+ * prefixed by its length as an MQTT variable byte integer, and publishes
+ * the batch when it reaches the size threshold, or when its oldest record
+ * has waited for the batching delay, whichever comes first.
+ * @par
+ * A batch is marked with the @ref BATCH_PROPERTY user property, holding
+ * the number of records in it, so it needs an MQTT v5 connection. A
+ * subscriber unpacks it with unpack(), or lets the async_client do it as
+ * the messages arrive with `async_client::set_batch_unpacking()`. Either
+ * way, the records come back as messages of their own, in order, with
+ * payloads that point into the batch, rather than copies of it.
+ * @par
+ * The batches sent when the delay runs out are published from the
+ * batcher's thread, which doesn't wait for them to be delivered. A batch
+ * that the client refuses is counted by num_failed().
+ */
+class message_batcher
+{
+public:
+    /** The type of clock used for the delay */
+    using clock = std::chrono::steady_clock;
+    /** The type of duration used for the delay */
+    using duration = clock::duration;
+
+    /** The user property with the number of records in a batch */
+    static constexpr const char* BATCH_PROPERTY = "batch-count";
+
+    /** The default size, in bytes, of a batch */
+    static constexpr std::size_t DFLT_MAX_BYTES = 16 * 1024;
+    /** The default QoS for the batches */
+    static constexpr int DFLT_QOS = 0;
+    /** The largest record that the length prefix can hold */
+    static constexpr std::size_t MAX_RECORD_SIZE = 268'435'455;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** General purpose guard */
+    using unique_guard = std::unique_lock<std::mutex>;
+
+    /** The client that carries the batches */
+    iasync_client& cli_;
+    /** The topic for the batches */
+    string topic_;
+    /** The longest time a record is held before it is sent */
+    duration delay_;
+    /** The size of the batch that triggers a flush */
+    std::size_t maxBytes_;
+    /** The QoS for the batches */
+    int qos_;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** Keeps the batches in order when flushed from different threads */
+    std::mutex flushLock_;
+    /** Signals the flush thread */
+    std::condition_variable cond_;
+    /** The records of the current batch, with their length prefixes */
+    binary buf_;
+    /** The number of records in the current batch */
+    std::size_t nRecords_{0};
+    /** The time of the oldest record in the current batch */
+    clock::time_point oldest_;
+    /** The number of batches that were published */
+    std::size_t nBatches_{0};
+    /** The number of batches that the client refused */
+    std::size_t nFailed_{0};
+    /** Whether the flush thread should exit */
+    bool stop_{false};
+    /** The flush thread */
+    std::thread thr_;
+
+    /** The function run by the flush thread */
+    void run();
+    /** Flushes on the flush thread, counting the batches that fail */
+    void flush_quietly() noexcept;
+
+    message_batcher(const message_batcher&) = delete;
+    message_batcher& operator=(const message_batcher&) = delete;
+
+public:
+    /**
+     * Creates a batcher for a topic.
+     * @param cli The client that carries the batches.
+     * @param topic The topic for the batches.
+     * @param delay The longest time that a record is held before it is
+     *  			sent.
+     * @param maxBytes The size of the batch that triggers a flush. The
+     *  			   records are packed up to this size, so a batch is only
+     *  			   larger when it holds a single, larger, record.
+     * @param qos The QoS for the batches.
+     */
+    template <class Rep, class Period>
+    message_batcher(
+        iasync_client& cli, const string& topic, const std::chrono::duration<Rep, Period>& delay,
+        std::size_t maxBytes = DFLT_MAX_BYTES, int qos = DFLT_QOS
+    )
+        : cli_{cli},
+          topic_{topic},
+          delay_{std::chrono::duration_cast<duration>(delay)},
+          maxBytes_{maxBytes},
+          qos_{qos} {
+        buf_.reserve(maxBytes_);
+        thr_ = std::thread(&message_batcher::run, this);
+    }
+    /**
+     * Destroys the batcher, publishing any pending records.
+     */
+    ~message_batcher();
+    /**
+     * Gets the topic for the batches.
+     * @return The topic for the batches.
+     */
+    const string& get_topic() const { return topic_; }
+    /**
+     * Gets the batching delay.
+     * @return The longest time a record is held before it is sent.
+     */
+    duration get_delay() const { return delay_; }
+    /**
+     * Gets the size threshold that triggers a flush.
+     * @return The size of the batch that triggers a flush.
+     */
+    std::size_t get_max_bytes() const { return maxBytes_; }
+    /**
+     * Gets the number of records waiting to be sent.
+     * @return The number of records in the current batch.
+     */
+    std::size_t num_pending() const {
+        guard g{lock_};
+        return nRecords_;
+    }
+    /**
+     * Gets the size of the current batch.
+     * @return The number of bytes in the current batch, with the length
+     *  	   prefixes.
+     */
+    std::size_t pending_bytes() const {
+        guard g{lock_};
+        return buf_.size();
+    }
+    /**
+     * Gets the number of batches that were published.
+     * @return The number of batches that were published.
+     */
+    std::size_t num_batches() const {
+        guard g{lock_};
+        return nBatches_;
+    }
+    /**
+     * Gets the number of batches that the client refused, when they were
+     * sent from the batcher's thread.
+     * @return The number of batches that failed.
+     */
+    std::size_t num_failed() const {
+        guard g{lock_};
+        return nFailed_;
+    }
+    /**
+     * Adds a record to the current batch.
+     * If the record doesn't fit in the current batch, that batch is
+     * published first, from the calling thread; and if it fills the batch,
+     * the batch is published right after.
+     * @param rec The record.
+     * @throw std::length_error if the record is too large for the
+     *  	  length prefix.
+     * @throw exception if the client refuses a batch.
+     */
+    void add(binary_view rec);
+    /**
+     * Adds a record to the current batch.
+     * @param data The record.
+     * @param n The size of the record, in bytes.
+     */
+    void add(const void* data, std::size_t n) {
+        add(binary_view{static_cast<const char*>(data), n});
+    }
+    /**
+     * Publishes the current batch now.
+     * @return The token for the batch, or a null pointer if there were no
+     *  	   records waiting.
+     * @throw exception if the client refuses the batch.
+     */
+    delivery_token_ptr flush();
+    /**
+     * Packs records into the payload of a batch.
+     * @param recs The records.
+     * @return The payload of the batch.
+     * @throw std::length_error if a record is too large for the length
+     *  	  prefix.
+     */
+    static binary pack(const std::vector<binary_view>& recs);
+    /**
+     * Gets the number of records in a batch, from its properties.
+     * @param props The properties of a message.
+     * @return The number of records, or zero if the message isn't a batch.
+     */
+    static std::size_t batch_count(const properties& props);
+    /**
+     * Determines if a message is a batch.
+     * @param msg The message.
+     * @return @em true if the message is marked as a batch.
+     */
+    static bool is_batch(const message& msg) {
+        const auto& props = msg.get_properties();
+        return !props.empty() && batch_count(props) != 0;
+    }
+    /**
+     * Unpacks a batch into a message for each of its records.
+     *
+     * The record messages have the topic, QoS, and retained flag of the
+     * batch, and no properties. Their payloads point into the payload of
+     * the batch, and hold onto it, so the batch lives as long as any of
+     * them do, but none of the data is copied.
+     *
+     * @param msg The batch message.
+     * @return The messages for its records, in order, or an empty vector
+     *  	   if the message isn't a batch, or its payload doesn't hold
+     *  	   the number of records that it says that it does.
+     */
+    static std::vector<message_ptr> unpack(const const_message_ptr& msg);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_message_batcher_h
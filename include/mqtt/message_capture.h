@@ -0,0 +1,298 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file message_capture.h
+/// Declaration of MQTT message_recorder and message_capture classes, to
+/// record the incoming messages of a client to a memory-mapped file, and
+/// to read and replay them.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_message_capture_h
+#define __mqtt_message_capture_h
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mqtt/message.h"
+#include "mqtt/message_tracer.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Records messages to a capture file, to be read back later with a
+ * @ref message_capture.
+ *
+ * Each message is appended to the file with its topic, payload,
+ * properties, QoS, flags, and the time it arrived. A small index of the
+ * records and their times is appended to a second file, with the same
+ * name plus ".idx". Both files are memory-mapped a window at a time, so
+ * a record is just a copy into the mapped pages, with no system calls
+ * except when a window fills up and the next one is mapped. A capture
+ * can grow to many gigabytes without using more than a window of
+ * address space.
+ * @par
+ * A recorder is a @ref message_tracer, so it can be installed on a client
+ * to capture everything that arrives:
+ * @code
+ * mqtt::message_recorder rec{"/tmp/prod.cap"};
+ * cli.set_message_tracer(rec);
+ * @endcode
+ * It can also record messages directly, with record(), from any number of
+ * threads or clients.
+ * @par
+ * If the app dies, the records written so far survive, since the magic
+ * number of each record is written last. The reader skips a record that
+ * was only partly written, and rebuilds any of the index that is missing.
+ * The files are in the host's byte order. This is only available on
+ * POSIX systems.
+ */
+class message_recorder : public message_tracer
+{
+public:
+    /** The default size of the mapped window, in bytes */
+    static constexpr size_t DFLT_WINDOW_SIZE = 64 * 1024 * 1024;
+
+private:
+    /** A file that is appended through a moving memory-mapped window */
+    class appender
+    {
+        /** The file descriptor */
+        int fd_{-1};
+        /** The start of the mapped window */
+        char* win_{nullptr};
+        /** The offset in the file of the start of the window */
+        size_t winOff_{0};
+        /** The size of the window */
+        size_t winLen_{0};
+        /** The offset of the end of the data */
+        size_t pos_{0};
+        /** The current size of the file */
+        size_t fileSize_{0};
+        /** The nominal size of the window */
+        size_t winSize_{0};
+
+    public:
+        /** Creates the file, and maps the first window */
+        void open(const string& path, size_t winSize);
+        /** Gets a pointer to write the next 'n' bytes */
+        char* reserve(size_t n);
+        /** Marks 'n' more bytes as written */
+        void commit(size_t n) { pos_ += n; }
+        /** Gets the offset of the end of the data */
+        size_t size() const { return pos_; }
+        /** Schedules the data to be written to disk */
+        void flush();
+        /** Unmaps the file and trims it to the data */
+        void close();
+    };
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** The file of records */
+    appender data_;
+    /** The file of index entries */
+    appender index_;
+    /** The number of records */
+    size_t nRec_{0};
+    /** Whether the files are open */
+    bool open_{false};
+
+public:
+    /**
+     * Creates a recorder, creating or truncating the capture file.
+     * @param path The path to the capture file. The index is put in a file
+     *  		   of the same name, plus ".idx".
+     * @param winSize The size of the window of the file that is mapped at
+     *  			  a time.
+     * @throw exception if the files can't be created.
+     */
+    explicit message_recorder(const string& path, size_t winSize = DFLT_WINDOW_SIZE);
+    /**
+     * Closes the capture files.
+     */
+    ~message_recorder() override;
+
+    message_recorder(const message_recorder&) = delete;
+    message_recorder& operator=(const message_recorder&) = delete;
+
+    /**
+     * Records a message.
+     * @param msg The message.
+     * @param t The time the message arrived.
+     */
+    void record(const message& msg, time_point t = clock::now());
+    /**
+     * Records a message that arrived at a client.
+     * @param msg The message.
+     * @param t The time the message arrived.
+     */
+    void message_arrived(const message& msg, const string&, time_point t) override {
+        record(msg, t);
+    }
+    /**
+     * Gets the number of messages recorded.
+     * @return The number of messages recorded.
+     */
+    size_t size() const {
+        guard g{lock_};
+        return nRec_;
+    }
+    /**
+     * Gets the size of the capture file, in bytes.
+     * @return The size of the capture file, in bytes.
+     */
+    size_t bytes() const {
+        guard g{lock_};
+        return data_.size();
+    }
+    /**
+     * Starts the data recorded so far on its way to disk, without waiting
+     * for it.
+     */
+    void flush();
+    /**
+     * Closes the capture files. Any more messages are dropped.
+     */
+    void close();
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A capture file that was written by a @ref message_recorder, to read or
+ * replay the messages in it.
+ *
+ * The file is memory-mapped, and the messages are views into it: their
+ * topics and payloads are not copied, and keep the file mapped for as
+ * long as any of them are alive. Only the properties, if any, are
+ * decoded into each message.
+ * @par
+ * The messages can be replayed into a handler, at the speed they arrived,
+ * at a multiple of it, or as fast as possible. To replay them to a
+ * broker, publish them from the handler:
+ * @code
+ * mqtt::message_capture cap{"/tmp/prod.cap"};
+ * cap.replay([&cli](mqtt::const_message_ptr msg) { cli.publish(msg); });
+ * @endcode
+ */
+class message_capture
+{
+public:
+    /** The clock for the arrival times */
+    using clock = message_tracer::clock;
+    /** An arrival time */
+    using time_point = clock::time_point;
+    /** A handler for replayed messages */
+    using handler = std::function<void(const_message_ptr)>;
+
+    /** The index for "the end of the capture" */
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    /** An entry in the index */
+    struct entry
+    {
+        /** The offset of the record in the file */
+        uint64_t offset;
+        /** The arrival time, in nanoseconds since the clock's epoch */
+        int64_t timeNs;
+    };
+
+private:
+    /** A read-only mapping of a whole file */
+    struct mapping;
+
+    /** The mapped capture file */
+    std::shared_ptr<mapping> data_;
+    /** The mapped index file, if there is one */
+    std::shared_ptr<mapping> index_;
+    /** The entries in the index file that are valid */
+    size_t nIndexed_{0};
+    /** The entries for the records past the end of the index file */
+    std::vector<entry> tail_;
+
+    /** Gets an index entry */
+    const entry& get_entry(size_t i) const;
+    /** Scans the records from the offset to the end, adding to the tail */
+    void scan(size_t off);
+
+public:
+    /**
+     * Opens a capture file.
+     * @param path The path to the capture file.
+     * @throw exception if the file can't be opened, or is not a capture.
+     */
+    explicit message_capture(const string& path);
+    /**
+     * Gets the number of messages in the capture.
+     * @return The number of messages in the capture.
+     */
+    size_t size() const { return nIndexed_ + tail_.size(); }
+    /**
+     * Determines if the capture is empty.
+     * @return @em true if there are no messages in the capture.
+     */
+    bool empty() const { return size() == 0; }
+    /**
+     * Gets one of the messages, as a view into the file.
+     * @param i The index of the message.
+     * @return The message.
+     * @throw std::out_of_range if the index is not valid.
+     */
+    const_message_ptr get(size_t i) const;
+    /**
+     * Gets the time a message arrived.
+     * @param i The index of the message.
+     * @return The time the message arrived.
+     * @throw std::out_of_range if the index is not valid.
+     */
+    time_point get_time(size_t i) const;
+    /**
+     * Finds the first message that arrived at or after a time.
+     * This is a binary search, so it assumes that the times are in order,
+     * as they are for the messages of a single client.
+     * @param t The time.
+     * @return The index of the message, or size() if there isn't one.
+     */
+    size_t find(time_point t) const;
+    /**
+     * Replays the messages into a handler, from the calling thread.
+     * @param cb The handler.
+     * @param speed The speed, as a multiple of the one the messages
+     *  			arrived at, like 1.0 for the same timing. A value of
+     *  			zero replays them as fast as possible.
+     * @param first The index of the first message to replay.
+     * @param last One past the index of the last message to replay.
+     * @return The number of messages replayed.
+     */
+    size_t replay(const handler& cb, double speed = 1.0, size_t first = 0, size_t last = npos)
+        const;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_message_capture_h
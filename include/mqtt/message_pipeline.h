@@ -0,0 +1,365 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file message_pipeline.h
+/// Declaration of MQTT message_pipeline class, which runs messages through
+/// stages on thread pools, and delivers them in order.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_message_pipeline_h
+#define __mqtt_message_pipeline_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mqtt/iasync_client.h"
+#include "mqtt/message.h"
+#include "mqtt/thread_queue.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Runs messages through a series of processing stages, each on its own
+ * pool of threads, and hands them to a sink in the order they were
+ * submitted.
+ *
+ * Each stage is a function that takes a message and returns the message
+ * for the next stage, which can be the same one, a new one, like a
+ * message with a decoded or enriched payload, or a null pointer to drop
+ * it. Since a stage has several threads, the messages get out of order
+ * as they go through. The sink runs on a single thread, behind a reorder
+ * buffer keyed by the sequence number given to each message when it was
+ * submitted, so it always sees them in the original order. Dropped
+ * messages just leave a gap that the sink skips.
+ * @par
+ * The queues between the stages are bounded, and so is the number of
+ * messages in the whole pipeline, which also bounds the reorder buffer.
+ * When the pipeline is full, submit() blocks until the sink catches up,
+ * holding back the consumer, and in turn the client.
+ * @par
+ * An exception that escapes a stage drops the message, and is counted in
+ * the metrics of the stage. One that escapes the sink is discarded.
+ * @par
+ * A pipeline is put together with a @ref message_pipeline_builder.
+ */
+class message_pipeline
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<message_pipeline>;
+    /** A processing stage, which returns a null pointer to drop a message */
+    using stage_function = std::function<const_message_ptr(const_message_ptr)>;
+    /** The sink at the end of the pipeline */
+    using sink_function = std::function<void(const_message_ptr)>;
+
+    /** The default capacity of the queue in front of each stage */
+    static constexpr std::size_t DFLT_BUFFER_SIZE = 1024;
+    /** The default number of messages in the pipeline at once */
+    static constexpr std::size_t DFLT_MAX_IN_FLIGHT = 8192;
+
+    /** The options for a stage */
+    struct stage_options
+    {
+        /** The name of the stage, for the metrics */
+        string name;
+        /** The number of threads for the stage */
+        std::size_t nThreads;
+        /** The function for the stage */
+        stage_function func;
+    };
+
+    /** A snapshot of the counters for a stage */
+    struct stage_metrics
+    {
+        /** The name of the stage */
+        string name;
+        /** The number of threads for the stage */
+        std::size_t nThreads{0};
+        /** The number of messages the stage processed */
+        uint64_t processed{0};
+        /** The number of messages the stage dropped, including errors */
+        uint64_t dropped{0};
+        /** The number of messages that the stage threw on */
+        uint64_t errors{0};
+        /** The number of messages waiting for the stage */
+        std::size_t queued{0};
+        /** The total time that the stage's threads spent processing */
+        std::chrono::nanoseconds busyTime{0};
+    };
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** Lock guard that can be used for waiting */
+    using unique_lock = std::unique_lock<std::mutex>;
+
+    /** A message on its way through, with its place in the order */
+    struct item
+    {
+        /** The sequence number of the message */
+        uint64_t seq;
+        /** The message, or null if it was dropped */
+        const_message_ptr msg;
+    };
+    /** The queue in front of a stage, or the sink */
+    using item_queue = thread_queue<item>;
+
+    /** A running stage */
+    struct stage
+    {
+        /** The options for the stage */
+        stage_options opts;
+        /** The messages waiting for the stage */
+        item_queue que;
+        /** The threads for the stage */
+        std::vector<std::thread> thrs;
+        /** The number of messages processed */
+        std::atomic<uint64_t> nProcessed{0};
+        /** The number of messages dropped */
+        std::atomic<uint64_t> nDropped{0};
+        /** The number of messages that the function threw on */
+        std::atomic<uint64_t> nErrors{0};
+        /** The time spent processing, in nanoseconds */
+        std::atomic<int64_t> busyNs{0};
+
+        stage(stage_options opts, std::size_t bufSize)
+            : opts{std::move(opts)}, que{bufSize} {}
+    };
+
+    /** The stages, in order */
+    std::vector<std::unique_ptr<stage>> stages_;
+    /** The sink */
+    sink_function sink_;
+    /** The messages waiting for the sink, in any order */
+    item_queue sinkQue_;
+    /** The thread for the sink */
+    std::thread sinkThr_;
+    /** The most messages in the pipeline at once */
+    const std::size_t maxInFlight_;
+
+    /** Lock for the fields below */
+    mutable std::mutex lock_;
+    /** Signaled when messages leave the pipeline, or it's stopped */
+    std::condition_variable cond_;
+    /** The sequence number for the next message submitted */
+    uint64_t nextSeq_{0};
+    /** The number of messages that left the pipeline */
+    uint64_t nDone_{0};
+    /** Whether the pipeline was stopped */
+    bool stopped_{false};
+
+    /** The number of messages waiting in the reorder buffer */
+    std::atomic<std::size_t> nReorder_{0};
+    /** The number of messages handed to the sink */
+    std::atomic<uint64_t> nDelivered_{0};
+
+    /** Gets the queue after a stage */
+    item_queue& next_queue(std::size_t idx) {
+        return (idx + 1 < stages_.size()) ? stages_[idx + 1]->que : sinkQue_;
+    }
+    /** The function run by the threads of a stage */
+    void run_stage(std::size_t idx);
+    /** The function run by the sink thread */
+    void run_sink();
+    /** Hands a message to the sink, and counts it as done */
+    void deliver(const_message_ptr msg);
+
+public:
+    /**
+     * Creates a pipeline and starts its threads.
+     * @param stages The stages, in order. A stage with zero threads gets
+     *  			 one.
+     * @param sink The sink at the end of the pipeline.
+     * @param bufSize The capacity of the queue in front of each stage.
+     * @param maxInFlight The most messages in the pipeline at once.
+     */
+    message_pipeline(
+        std::vector<stage_options> stages, sink_function sink,
+        std::size_t bufSize = DFLT_BUFFER_SIZE, std::size_t maxInFlight = DFLT_MAX_IN_FLIGHT
+    );
+    /**
+     * Destroys the pipeline.
+     * This stops it, after the messages in it are delivered.
+     */
+    ~message_pipeline();
+
+    message_pipeline(const message_pipeline&) = delete;
+    message_pipeline& operator=(const message_pipeline&) = delete;
+
+    /**
+     * Gets the number of stages.
+     * @return The number of stages.
+     */
+    std::size_t num_stages() const { return stages_.size(); }
+    /**
+     * Gets the most messages that can be in the pipeline at once.
+     * @return The most messages in flight.
+     */
+    std::size_t get_max_in_flight() const { return maxInFlight_; }
+    /**
+     * Submits a message to the first stage.
+     * This blocks while the pipeline is full.
+     * @param msg The message.
+     * @return @em true if the message was submitted, @em false if the
+     *  	   pipeline was stopped.
+     */
+    bool submit(const_message_ptr msg);
+    /**
+     * Submits the messages from a client's consumer queue, until it shuts
+     * down or the pipeline is stopped.
+     * The other client events are skipped.
+     * @param cli The client, which must be consuming.
+     * @return The number of messages submitted.
+     */
+    std::size_t feed(iasync_client& cli);
+    /**
+     * Gets the number of messages that were submitted.
+     * @return The number of messages submitted.
+     */
+    uint64_t num_submitted() const {
+        guard g{lock_};
+        return nextSeq_;
+    }
+    /**
+     * Gets the number of messages that were handed to the sink.
+     * @return The number of messages delivered.
+     */
+    uint64_t num_delivered() const { return nDelivered_.load(std::memory_order_relaxed); }
+    /**
+     * Gets the number of messages in the pipeline.
+     * @return The number of messages in flight.
+     */
+    std::size_t num_in_flight() const {
+        guard g{lock_};
+        return std::size_t(nextSeq_ - nDone_);
+    }
+    /**
+     * Gets the number of messages that finished the stages, and are
+     * waiting in the reorder buffer for an earlier one.
+     * @return The number of messages in the reorder buffer.
+     */
+    std::size_t reorder_size() const { return nReorder_.load(std::memory_order_relaxed); }
+    /**
+     * Gets a snapshot of the counters for each stage.
+     * @return The metrics for the stages, in order.
+     */
+    std::vector<stage_metrics> get_metrics() const;
+    /**
+     * Stops the pipeline.
+     * No more messages are accepted. This waits for the messages in the
+     * pipeline to make it through to the sink, then joins the threads. It
+     * is safe to call this more than once, but not from a stage or the
+     * sink.
+     */
+    void stop();
+    /**
+     * Determines if the pipeline was stopped.
+     * @return @em true if the pipeline was stopped.
+     */
+    bool stopped() const {
+        guard g{lock_};
+        return stopped_;
+    }
+};
+
+/** Smart/shared pointer to a message_pipeline */
+using message_pipeline_ptr = message_pipeline::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Class to build a message pipeline.
+ */
+class message_pipeline_builder
+{
+    /** The stages */
+    std::vector<message_pipeline::stage_options> stages_;
+    /** The sink */
+    message_pipeline::sink_function sink_;
+    /** The capacity of the queue in front of each stage */
+    std::size_t bufSize_{message_pipeline::DFLT_BUFFER_SIZE};
+    /** The most messages in the pipeline at once */
+    std::size_t maxInFlight_{message_pipeline::DFLT_MAX_IN_FLIGHT};
+
+public:
+    /** This class */
+    using self = message_pipeline_builder;
+    /**
+     * Default constructor.
+     */
+    message_pipeline_builder() {}
+    /**
+     * Adds a stage to the end of the pipeline.
+     * @param name The name of the stage, for the metrics.
+     * @param nThreads The number of threads for the stage.
+     * @param func The function for the stage.
+     */
+    auto stage(string name, std::size_t nThreads, message_pipeline::stage_function func)
+        -> self& {
+        stages_.push_back({std::move(name), nThreads, std::move(func)});
+        return *this;
+    }
+    /**
+     * Sets the sink at the end of the pipeline.
+     * @param func The sink.
+     */
+    auto sink(message_pipeline::sink_function func) -> self& {
+        sink_ = std::move(func);
+        return *this;
+    }
+    /**
+     * Sets the capacity of the queue in front of each stage.
+     * @param n The capacity of each queue.
+     */
+    auto buffer_size(std::size_t n) -> self& {
+        bufSize_ = n;
+        return *this;
+    }
+    /**
+     * Sets the most messages in the pipeline at once.
+     * @param n The most messages in flight.
+     */
+    auto max_in_flight(std::size_t n) -> self& {
+        maxInFlight_ = n;
+        return *this;
+    }
+    /**
+     * Creates the pipeline and starts its threads.
+     * @return A shared pointer to the pipeline.
+     */
+    message_pipeline_ptr finalize() {
+        return std::make_shared<message_pipeline>(
+            std::move(stages_), std::move(sink_), bufSize_, maxInFlight_
+        );
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_message_pipeline_h
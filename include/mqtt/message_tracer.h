@@ -0,0 +1,136 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file message_tracer.h
+/// Declaration of MQTT message_tracer class, hooks for tracing the
+/// latency of messages from end to end.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_message_tracer_h
+#define __mqtt_message_tracer_h
+
+#include <chrono>
+#include <memory>
+
+#include "mqtt/delivery_token.h"
+#include "mqtt/message.h"
+#include "mqtt/properties.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Hooks for tracing messages through the client, from end to end.
+ *
+ * A tracer is installed on an async_client with
+ * `async_client::set_message_tracer()`. The client then calls it with a
+ * timestamp at each step of a message's trip:
+ *
+ * @li publish_begin() when the app publishes a message,
+ * @li message_sent() when the library returns from sending it,
+ * @li delivery_complete() when the server acknowledges it, or it fails,
+ * @li message_arrived() when a message arrives at a consumer.
+ *
+ * The context that publish_begin() returns, such as a W3C `traceparent`
+ * for an OpenTelemetry span, is sent with an MQTT v5 message as a user
+ * property named @ref TRACE_PROPERTY, and given back to message_arrived()
+ * on the receiving side, so the two ends can be joined into a single
+ * trace. It's also kept in the delivery token, as
+ * `delivery_token::get_trace_context()`, which the other publish hooks
+ * can use to find their span.
+ * @par
+ * Without a tracer, the cost is a single atomic load for each message.
+ * With one, the hooks are called from the publishing thread and the
+ * library's callback threads, so they should be quick, and must be
+ * thread-safe.
+ * @par
+ * Only the publishes that return a delivery token are traced, not
+ * `publish_qos0()` or `publish_batch()`.
+ */
+class message_tracer
+{
+public:
+    /** Smart/shared pointer to an object of this type */
+    using ptr_t = std::shared_ptr<message_tracer>;
+    /** The clock for the timestamps, which can be compared across hosts */
+    using clock = std::chrono::system_clock;
+    /** A timestamp */
+    using time_point = clock::time_point;
+
+    /** The name of the user property that carries the trace context */
+    static constexpr const char* TRACE_PROPERTY = "traceparent";
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~message_tracer() {}
+    /**
+     * Gets the trace context from a set of message properties.
+     * @param props The properties of a message.
+     * @return The value of the @ref TRACE_PROPERTY user property, or an
+     *  	   empty string if there isn't one.
+     */
+    static string get_trace_context(const properties& props) {
+        auto val = get_user_property(props, TRACE_PROPERTY);
+        return val ? string{*val} : string();
+    }
+    /**
+     * Called when the app publishes a message, before it's queued or
+     * sent.
+     * @param msg The message.
+     * @param t When the publish started.
+     * @return The trace context to send with the message, or an empty
+     *  	   string for none. A message that already has the trace
+     *  	   property keeps it.
+     */
+    virtual string publish_begin(const message& /*msg*/, time_point /*t*/) { return string(); }
+    /**
+     * Called when the library returns from sending a message.
+     * @param tok The delivery token for the message.
+     * @param rc The return code from the library.
+     * @param t When the library returned.
+     */
+    virtual void message_sent(const delivery_token& /*tok*/, int /*rc*/, time_point /*t*/) {}
+    /**
+     * Called when a message that was sent completes, because the server
+     * acknowledged it, or it failed. Check the token's return code to
+     * tell which.
+     * @param tok The delivery token for the message.
+     * @param t When the message completed.
+     */
+    virtual void delivery_complete(const delivery_token& /*tok*/, time_point /*t*/) {}
+    /**
+     * Called when a message arrives from the server.
+     * @param msg The message.
+     * @param ctx The trace context that came with the message, if any.
+     * @param t When the message arrived.
+     */
+    virtual void message_arrived(
+        const message& /*msg*/, const string& /*ctx*/, time_point /*t*/
+    ) {}
+};
+
+/** Smart/shared pointer to a message_tracer */
+using message_tracer_ptr = message_tracer::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_message_tracer_h
@@ -0,0 +1,369 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file offline_buffer.h
+/// Declaration of MQTT offline_buffer class, which holds the messages that
+/// are published while the client is disconnected.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_offline_buffer_h
+#define __mqtt_offline_buffer_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "mqtt/message.h"
+#include "mqtt/priority_lanes.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Holds the messages that are published while the client is disconnected,
+ * and sends them, in order, once it connects again.
+ *
+ * Unlike the buffer in the C library, which is turned on by
+ * `create_options::set_send_while_disconnected()`, this one can be seen
+ * from the app: it reports how many messages and bytes are held, it can
+ * drop the messages that are no longer wanted, and it says when the
+ * backlog has been sent.
+ * @par
+ * The backlog is sent from the buffer's own thread, with an optional
+ * limit on the number of messages per second, so that a large backlog
+ * doesn't flood the connection right after a reconnect. Messages that are
+ * published once the client is connected go straight out, alongside the
+ * backlog, rather than waiting behind it. So the order is only kept among
+ * the messages in the buffer.
+ * @par
+ * The buffer has a lane for each message priority, served by weight, so
+ * the order is kept among the messages of a priority, while an urgent
+ * message doesn't wait behind the whole backlog of bulk ones.
+ * @par
+ * A message with a Message Expiry Interval is dropped, rather than sent,
+ * once the interval has run out while it waited in the buffer, since the
+ * server would only be forwarding a message that is already stale.
+ * @par
+ * A message that is marked with `message::set_conflate()` is replaced by
+ * a newer conflated message on the same topic, while it waits. The newer
+ * one keeps the place of the first, in its lane, so the buffer holds at
+ * most one of them per topic, and the backlog for a topic that only
+ * carries state is its latest value. The operation for the replaced
+ * message is called with @em false.
+ * @par
+ * The buffer is normally used by the async_client, through
+ * `async_client::start_offline_buffering()`.
+ */
+class offline_buffer
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<offline_buffer>;
+    /** The clock used for pacing */
+    using clock = std::chrono::steady_clock;
+    /**
+     * The operation for a held message.
+     * This is called with @em true to send the message, and returns
+     * @em false if it couldn't be sent because the client is not
+     * connected, in which case the message goes back to the front of the
+     * buffer and the drain stops. It's called with @em false when the
+     * message is dropped, or the buffer is stopped.
+     */
+    using task_type = std::function<bool(bool)>;
+    /** A predicate to pick messages to drop */
+    using predicate_type = std::function<bool(const message&)>;
+    /** Handler for when the backlog has been sent */
+    using drained_handler = std::function<void()>;
+    /** Handler for a message that expired in the buffer */
+    using expired_handler = std::function<void(const message&)>;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** Lock guard that can be used for waiting */
+    using unique_lock = std::unique_lock<std::mutex>;
+
+    /** A held message */
+    struct entry
+    {
+        /** The message */
+        const_message_ptr msg;
+        /** The operation for the message */
+        task_type task;
+        /** The time the message expires, or the max time for never */
+        clock::time_point expiry;
+        /**
+         * For a conflated message, the entry in the lane only keeps the
+         * place. The latest message for the topic is held here, shared
+         * with the index, so a newer one can replace it.
+         */
+        std::shared_ptr<entry> latest;
+    };
+
+    /** The most messages to hold, or zero for no limit */
+    const std::size_t maxMsgs_;
+    /** The most payload bytes to hold, or zero for no limit */
+    const std::size_t maxBytes_;
+
+    /** Lock for everything below */
+    mutable std::mutex lock_;
+    /** Signaled when a drain starts or the buffer stops */
+    std::condition_variable cond_;
+    /** The held messages, in lanes by priority */
+    priority_lanes<entry> que_;
+    /** The latest conflated message for each topic, by topic */
+    std::unordered_map<string, std::shared_ptr<entry>> conflated_;
+    /** The payload bytes of the held messages */
+    std::size_t nBytes_{0};
+    /** The estimated memory of the held messages */
+    std::size_t memBytes_{0};
+    /** The most memory the held messages have taken */
+    std::size_t peakMemBytes_{0};
+    /** The most messages to send per second while draining, or zero */
+    double drainRate_;
+    /** The time that the next message can be sent, when paced */
+    clock::time_point nextSend_;
+    /** The handler for when the backlog has been sent */
+    drained_handler drainedHandler_;
+    /** The handler for the messages that expired */
+    expired_handler expiredHandler_;
+    /** The number of messages that expired in the buffer */
+    std::size_t nExpired_{0};
+    /** The number of messages that were replaced by newer ones */
+    std::size_t nConflated_{0};
+    /** The thread that sends the backlog, started when needed */
+    std::thread thr_;
+    /** Whether the backlog is being sent */
+    bool draining_{false};
+    /** Whether the buffer was stopped */
+    bool stopped_{false};
+
+    /**
+     * Gets the held message for an entry in a lane.
+     * @param e The entry in the lane.
+     * @return The entry itself, or the latest one for a conflated topic.
+     */
+    static const entry& current(const entry& e) { return e.latest ? *e.latest : e; }
+    /**
+     * Turns an entry that was taken out of a lane into the message that
+     * it holds, removing a conflated topic from the index.
+     * This is called with the lock held.
+     * @param e The entry taken from a lane.
+     */
+    void resolve(entry& e);
+    /** The function run by the drain thread */
+    void run();
+    /**
+     * Calls the drained handler, if a drain just emptied the buffer.
+     * This is called from the drain thread, with the lock held.
+     */
+    void check_drained(unique_lock& g);
+
+public:
+    /**
+     * Creates a buffer.
+     * @param maxMsgs The most messages to hold, or zero for no limit.
+     * @param maxBytes The most payload bytes to hold, or zero for no
+     *  			   limit.
+     * @param drainRate The most messages per second to send when
+     *  				draining the backlog, or zero to send them as fast
+     *  				as the library takes them.
+     */
+    explicit offline_buffer(
+        std::size_t maxMsgs = 0, std::size_t maxBytes = 0, double drainRate = 0.0
+    );
+    /**
+     * Destroys the buffer, stopping it.
+     */
+    ~offline_buffer();
+
+    offline_buffer(const offline_buffer&) = delete;
+    offline_buffer& operator=(const offline_buffer&) = delete;
+
+    /**
+     * Gets the most messages that the buffer holds.
+     * @return The most messages to hold, or zero for no limit.
+     */
+    std::size_t get_max_messages() const { return maxMsgs_; }
+    /**
+     * Gets the most payload bytes that the buffer holds.
+     * @return The most payload bytes to hold, or zero for no limit.
+     */
+    std::size_t get_max_bytes() const { return maxBytes_; }
+    /**
+     * Gets the pace at which the backlog is sent.
+     * @return The most messages per second, or zero for no limit.
+     */
+    double get_drain_rate() const;
+    /**
+     * Sets the pace at which the backlog is sent.
+     * @param msgsPerSec The most messages per second, or zero for no
+     *  				 limit.
+     */
+    void set_drain_rate(double msgsPerSec);
+    /**
+     * Gets the weights of the priority lanes.
+     * @return The most messages each lane sends in a turn.
+     */
+    lane_weights get_lane_weights() const {
+        guard g{lock_};
+        return que_.get_weights();
+    }
+    /**
+     * Sets the weights of the priority lanes, which also sets the number
+     * of lanes.
+     * @param weights The most messages each lane sends in a turn, from the
+     *  			  highest priority to the lowest.
+     */
+    void set_lane_weights(lane_weights weights) {
+        guard g{lock_};
+        que_.set_weights(std::move(weights));
+    }
+    /**
+     * Sets a handler for when the backlog has been sent.
+     * This is called from the drain thread each time a drain empties the
+     * buffer.
+     * @param cb The handler.
+     */
+    void set_drained_handler(drained_handler cb);
+    /**
+     * Sets a handler for the messages that expire in the buffer.
+     * This is called from the drain thread for each expired message,
+     * after its operation was called with @em false.
+     * @param cb The handler.
+     */
+    void set_expired_handler(expired_handler cb);
+    /**
+     * Adds a message to the end of its lane in the buffer.
+     * A conflated message replaces the one held for its topic, if any,
+     * rather than being added.
+     * @param msg The message.
+     * @param task The operation for the message.
+     * @return @em true if the message was added, @em false if the buffer
+     *  	   is full or stopped.
+     */
+    bool add(const_message_ptr msg, task_type task);
+    /**
+     * Gets the number of messages in the buffer.
+     * @return The number of messages in the buffer.
+     */
+    std::size_t size() const {
+        guard g{lock_};
+        return que_.size();
+    }
+    /**
+     * Determines if the buffer is empty.
+     * @return @em true if there are no messages in the buffer.
+     */
+    bool empty() const {
+        guard g{lock_};
+        return que_.empty();
+    }
+    /**
+     * Gets the number of payload bytes in the buffer.
+     * @return The number of payload bytes in the buffer.
+     */
+    std::size_t num_bytes() const {
+        guard g{lock_};
+        return nBytes_;
+    }
+    /**
+     * Gets an estimate of the memory taken by the messages in the buffer,
+     * as given by `message::memory_size()`.
+     * @return The memory of the messages in the buffer, in bytes.
+     */
+    std::size_t memory_size() const {
+        guard g{lock_};
+        return memBytes_;
+    }
+    /**
+     * Gets the most memory that the messages in the buffer have taken at
+     * once.
+     * @return The high-water mark of the memory of the buffer, in bytes.
+     */
+    std::size_t peak_memory_size() const {
+        guard g{lock_};
+        return peakMemBytes_;
+    }
+    /**
+     * Gets the number of messages that expired in the buffer, and were
+     * dropped rather than sent.
+     * @return The number of expired messages.
+     */
+    std::size_t num_expired() const {
+        guard g{lock_};
+        return nExpired_;
+    }
+    /**
+     * Gets the number of messages that were replaced in the buffer by
+     * newer ones on the same topic.
+     * @return The number of conflated messages.
+     */
+    std::size_t num_conflated() const {
+        guard g{lock_};
+        return nConflated_;
+    }
+    /**
+     * Determines if the backlog is being sent.
+     * @return @em true if the buffer is draining.
+     */
+    bool is_draining() const {
+        guard g{lock_};
+        return draining_;
+    }
+    /**
+     * Drops the messages picked by a predicate.
+     * The operation for each one is called with @em false.
+     * @param pred Returns @em true for the messages to drop.
+     * @return The number of messages that were dropped.
+     */
+    std::size_t remove_if(const predicate_type& pred);
+    /**
+     * Starts sending the backlog, from the drain thread.
+     * This is called when the client connects.
+     */
+    void start_drain();
+    /**
+     * Stops the buffer. This waits for the drain thread, if any, then
+     * calls the operations for the messages that are left with
+     * @em false.
+     */
+    void stop();
+    /**
+     * Determines if the buffer was stopped.
+     * @return @em true if the buffer was stopped.
+     */
+    bool stopped() const {
+        guard g{lock_};
+        return stopped_;
+    }
+};
+
+/** Smart/shared pointer to an offline_buffer */
+using offline_buffer_ptr = offline_buffer::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_offline_buffer_h
@@ -0,0 +1,105 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file payload_codec.h
+/// Declaration of MQTT payload_codec class, the interface for compressing
+/// message payloads.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_payload_codec_h
+#define __mqtt_payload_codec_h
+
+#include <memory>
+
+#include "mqtt/properties.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The interface for a codec that compresses message payloads.
+ *
+ * A codec is installed on an async_client with
+ * `async_client::set_payload_codec()`. The client then encodes the payload
+ * of each outgoing MQTT v5 message, and names the codec in a user
+ * property, @ref ENCODING_PROPERTY, so that the receiver knows how to
+ * decode it. An incoming message that names the same codec is decoded
+ * lazily, the first time its payload is read, so a consumer that only
+ * looks at the topic never pays for it.
+ * @par
+ * The library has a zlib codec, @ref deflate_codec, when it's built with
+ * zlib. Others, like zstd or lz4, perhaps with a trained dictionary, can
+ * be plugged in by implementing this interface. A codec is shared by the
+ * client's threads, so it must be thread-safe.
+ */
+class payload_codec
+{
+public:
+    /** Smart/shared pointer to an object of this type */
+    using ptr_t = std::shared_ptr<const payload_codec>;
+
+    /** The name of the user property that names the codec of a payload */
+    static constexpr const char* ENCODING_PROPERTY = "content-encoding";
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~payload_codec() {}
+    /**
+     * Gets the name of the codec, as sent in the @ref ENCODING_PROPERTY.
+     * Codecs that can't decode each other's payloads, like the same
+     * algorithm with different dictionaries, should have different names.
+     * @return The name of the codec.
+     */
+    virtual string name() const = 0;
+    /**
+     * Encodes a payload.
+     * @param data The payload.
+     * @return The encoded payload.
+     * @throw exception if the payload can't be encoded.
+     */
+    virtual binary encode(const binary& data) const = 0;
+    /**
+     * Decodes a payload.
+     * @param data The encoded payload.
+     * @return The payload.
+     * @throw exception if the payload can't be decoded.
+     */
+    virtual binary decode(const binary& data) const = 0;
+    /**
+     * Gets the name of the codec of a payload from a set of message
+     * properties.
+     * @param props The properties of a message.
+     * @return The value of the @ref ENCODING_PROPERTY user property, or an
+     *  	   empty string if there isn't one.
+     */
+    static string get_encoding(const properties& props) {
+        auto val = get_user_property(props, ENCODING_PROPERTY);
+        return val ? string{*val} : string();
+    }
+};
+
+/** Smart/shared pointer to a payload_codec */
+using payload_codec_ptr = payload_codec::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_payload_codec_h
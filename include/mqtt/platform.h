@@ -1,29 +1,37 @@
-/////////////////////////////////////////////////////////////////////////////
-/// @file platform.h
-/// Paho MQTT platform-specific code
-/// @date Nov 19, 2023
-/// @author Frank Pagliughi
-/////////////////////////////////////////////////////////////////////////////
-
-/*******************************************************************************
- * Copyright (c) 2023 Frank Pagliughi <fpagliughi@mindspring.com>
- *
- * All rights reserved. This program and the accompanying materials
- * are made available under the terms of the Eclipse Public License v2.0
- * and Eclipse Distribution License v1.0 which accompany this distribution.
- *
- * The Eclipse Public License is available at
- *    http://www.eclipse.org/legal/epl-v20.html
- * and the Eclipse Distribution License is available at
- *   http://www.eclipse.org/org/documents/edl-v10.php.
- *
- * Contributors:
- *    Frank Pagliughi - initial implementation and documentation
- *******************************************************************************/
-
-#ifndef __mqtt_platform_h
-#define __mqtt_platform_h
-
-#include "mqtt/export.h"
-
-#endif  // __mqtt_platform_h
+/////////////////////////////////////////////////////////////////////////////
+/// @file platform.h
+/// Paho MQTT platform-specific code
+/// @date Nov 19, 2023
+/// @author Frank Pagliughi
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2023 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_platform_h
+#define __mqtt_platform_h
+
+#include "mqtt/export.h"
+
+// The polymorphic memory resources of C++17 are missing from some older
+// standard libraries, so the library only uses them where they're found.
+#if defined(__has_include)
+    #if __has_include(<memory_resource>)
+        #define PAHO_MQTTPP_HAS_PMR 1
+    #endif
+#endif
+
+#endif  // __mqtt_platform_h
@@ -0,0 +1,434 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file pool_allocator.h
+/// Declaration of a thread-safe pool of fixed-size memory blocks, and an
+/// allocator that uses it, to recycle the memory for frequently-created
+/// objects, like messages.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_pool_allocator_h
+#define __mqtt_pool_allocator_h
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A thread-safe pool of fixed-size memory blocks.
+ *
+ * Blocks that are returned to the pool are kept in a free list to be
+ * handed out again by the next allocation, up to a maximum number of free
+ * blocks. Past that, they are returned to the heap. All the blocks are
+ * obtained from the global `operator new`, so a block can always be
+ * returned to any pool of the same block size, or to the heap.
+ * @par
+ * The free list is shared by all threads, behind a lock. A thread that
+ * allocates a lot can put a @ref cache in front of it, which keeps a few
+ * blocks of its own, and goes to the shared list only for a batch of them
+ * at a time.
+ */
+class block_pool
+{
+    /** A free block holds the link to the next one */
+    struct node
+    {
+        node* next;
+    };
+
+    /** The size of each block */
+    const std::size_t blockSize_;
+    /** Lock for the free list */
+    mutable std::mutex lock_;
+    /** The list of free blocks */
+    node* free_{nullptr};
+    /** The number of blocks in the free list */
+    std::size_t nFree_{0};
+    /** The maximum number of blocks to keep in the free list */
+    std::size_t maxFree_;
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Pops all the blocks off the free list (unsafe) */
+    node* take_all() {
+        node* p = free_;
+        free_ = nullptr;
+        nFree_ = 0;
+        return p;
+    }
+    /** Returns a list of blocks to the heap */
+    static void release(node* p) {
+        while (p) {
+            node* next = p->next;
+            ::operator delete(p);
+            p = next;
+        }
+    }
+    /**
+     * Pops up to 'n' blocks off the free list.
+     * @return The list of blocks, with the number of them in 'got'.
+     */
+    node* take_n(std::size_t n, std::size_t& got) {
+        guard g{lock_};
+        node *head = free_, *tail = nullptr;
+        for (got = 0; got < n && free_; ++got) {
+            tail = free_;
+            free_ = free_->next;
+        }
+        if (tail)
+            tail->next = nullptr;
+        nFree_ -= got;
+        return got ? head : nullptr;
+    }
+    /**
+     * Pushes a list of blocks onto the free list, up to the maximum,
+     * returning the rest to the heap.
+     */
+    void put_all(node* p) {
+        {
+            guard g{lock_};
+            while (p && nFree_ < maxFree_) {
+                node* next = p->next;
+                p->next = free_;
+                free_ = p;
+                ++nFree_;
+                p = next;
+            }
+        }
+        release(p);
+    }
+
+public:
+    /** The default maximum number of free blocks kept in a pool */
+    static constexpr std::size_t DFLT_MAX_FREE = 1024;
+
+    /**
+     * A cache of free blocks for a single thread, in front of a pool.
+     *
+     * The cache is refilled from the pool, and gives back to it, half its
+     * size at a time, with one lock of the pool each. So the threads that
+     * allocate and free blocks at the same rate rarely touch the pool at
+     * all, and the ones that only allocate, or only free, as when blocks
+     * are handed from one thread to another, take its lock once per batch.
+     * The cache gives its blocks back to the pool when it's destroyed,
+     * which must outlive it. It is not thread-safe.
+     */
+    class cache
+    {
+        /** The shared pool */
+        block_pool& pool_;
+        /** The most blocks to keep */
+        const std::size_t maxFree_;
+        /** The list of free blocks */
+        node* free_{nullptr};
+        /** The number of blocks in the free list */
+        std::size_t nFree_{0};
+
+    public:
+        /** The default maximum number of free blocks kept in a cache */
+        static constexpr std::size_t DFLT_MAX_FREE = 64;
+
+        /**
+         * Creates a cache in front of a pool.
+         * @param pool The shared pool.
+         * @param maxFree The most free blocks to keep in the cache.
+         */
+        explicit cache(block_pool& pool, std::size_t maxFree = DFLT_MAX_FREE)
+            : pool_{pool}, maxFree_{std::max<std::size_t>(maxFree, 2)} {}
+        /**
+         * Destroys the cache, giving its blocks back to the pool.
+         */
+        ~cache() { pool_.put_all(free_); }
+
+        cache(const cache&) = delete;
+        cache& operator=(const cache&) = delete;
+
+        /**
+         * Gets the number of blocks in the cache.
+         * @return The number of blocks in the cache.
+         */
+        std::size_t num_free() const { return nFree_; }
+        /**
+         * Gets a block from the cache, refilling it from the pool if it's
+         * empty, or allocating a new one from the heap if they both are.
+         * @return A pointer to the block.
+         */
+        void* allocate() {
+            if (!free_)
+                free_ = pool_.take_n(maxFree_ / 2, nFree_);
+            if (!free_)
+                return ::operator new(pool_.block_size());
+
+            node* p = free_;
+            free_ = p->next;
+            --nFree_;
+            return p;
+        }
+        /**
+         * Returns a block to the cache, giving half the cache back to the
+         * pool if it's full.
+         * @param p A block that was obtained from this pool, or any pool
+         *  		with the same block size.
+         */
+        void deallocate(void* p) {
+            if (!p)
+                return;
+
+            if (nFree_ >= maxFree_) {
+                node* q = free_;
+                for (std::size_t i = 1; i < maxFree_ / 2; ++i) q = q->next;
+                node* rest = q->next;
+                q->next = nullptr;
+                pool_.put_all(std::exchange(free_, rest));
+                nFree_ -= maxFree_ / 2;
+            }
+            free_ = ::new (p) node{free_};
+            ++nFree_;
+        }
+    };
+
+    /**
+     * Creates a pool for blocks of the specified size.
+     * @param blockSize The size of the blocks, in bytes.
+     * @param maxFree The maximum number of free blocks to keep.
+     */
+    explicit block_pool(std::size_t blockSize, std::size_t maxFree = DFLT_MAX_FREE)
+        : blockSize_{std::max(blockSize, sizeof(node))}, maxFree_{maxFree} {}
+    /**
+     * Destroys the pool, returning all of the free blocks to the heap.
+     */
+    ~block_pool() { release(take_all()); }
+
+    block_pool(const block_pool&) = delete;
+    block_pool& operator=(const block_pool&) = delete;
+
+    /**
+     * Gets the size of the blocks in the pool.
+     * @return The size of the blocks in the pool, in bytes.
+     */
+    std::size_t block_size() const { return blockSize_; }
+    /**
+     * Gets the number of blocks currently in the free list.
+     * @return The number of blocks currently in the free list.
+     */
+    std::size_t num_free() const {
+        guard g{lock_};
+        return nFree_;
+    }
+    /**
+     * Gets the maximum number of free blocks kept in the pool.
+     * @return The maximum number of free blocks kept in the pool.
+     */
+    std::size_t max_free() const {
+        guard g{lock_};
+        return maxFree_;
+    }
+    /**
+     * Sets the maximum number of free blocks kept in the pool.
+     * If there are more than this number currently in the pool, the excess
+     * are returned to the heap.
+     * @param n The maximum number of free blocks to keep in the pool.
+     */
+    void max_free(std::size_t n) {
+        node* excess = nullptr;
+        {
+            guard g{lock_};
+            maxFree_ = n;
+            while (nFree_ > maxFree_) {
+                node* p = free_;
+                free_ = p->next;
+                p->next = excess;
+                excess = p;
+                --nFree_;
+            }
+        }
+        release(excess);
+    }
+    /**
+     * Returns all the free blocks to the heap.
+     */
+    void clear() {
+        node* p;
+        {
+            guard g{lock_};
+            p = take_all();
+        }
+        release(p);
+    }
+    /**
+     * Gets a block from the pool.
+     * This reuses a free block, if one is available, otherwise it
+     * allocates a new one from the heap.
+     * @return A pointer to the block.
+     */
+    void* allocate() {
+        {
+            guard g{lock_};
+            if (free_) {
+                node* p = free_;
+                free_ = p->next;
+                --nFree_;
+                return p;
+            }
+        }
+        return ::operator new(blockSize_);
+    }
+    /**
+     * Returns a block to the pool.
+     * @param p A block that was obtained from this pool, or any pool with
+     *  		the same block size.
+     */
+    void deallocate(void* p) {
+        if (!p)
+            return;
+        {
+            guard g{lock_};
+            if (nFree_ < maxFree_) {
+                free_ = ::new (p) node{free_};
+                ++nFree_;
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An allocator that recycles single objects through a block pool.
+ *
+ * This is a stateless allocator. Each type that it allocates gets its own
+ * process-wide @ref block_pool, with a @ref block_pool::cache in front of
+ * it for each thread, so threads that create and destroy objects at the
+ * same time don't all contend for the lock of the pool. A thread's cached
+ * blocks go back to the shared pool when the thread exits. It is mainly
+ * intended for use with
+ * `std::allocate_shared()`, which allocates an object together with its
+ * shared pointer control block, both of which are then recycled when the
+ * last reference goes away.
+ *
+ * Allocations of more than a single object go straight to the heap.
+ *
+ * @tparam T The type of object to allocate.
+ */
+template <typename T>
+class pool_allocator
+{
+    static_assert(
+        alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+        "pool_allocator does not support over-aligned types"
+    );
+
+public:
+    /** The type of objects allocated */
+    using value_type = T;
+
+    /**
+     * Creates an allocator.
+     */
+    pool_allocator() noexcept = default;
+    /**
+     * Creates an allocator from one for another type.
+     */
+    template <typename U>
+    pool_allocator(const pool_allocator<U>&) noexcept {}
+    /**
+     * Gets the pool used by allocators of this type.
+     * The pool is intentionally never destroyed, so that objects with
+     * static storage duration can still be released safely during
+     * program exit.
+     * @return The pool used by allocators of this type.
+     */
+    static block_pool& pool() {
+        static block_pool* p = new block_pool{sizeof(T)};
+        return *p;
+    }
+    /**
+     * Gets the calling thread's cache in front of the pool.
+     * Once the thread is exiting, and its cache is gone, objects go
+     * straight to the pool, as they do for objects with static storage
+     * duration that are destroyed after the main thread's cache.
+     * @return The calling thread's cache, or a null pointer if it's gone.
+     */
+    static block_pool::cache* thread_cache() {
+        struct tls_cache : block_pool::cache
+        {
+            bool& gone;
+            explicit tls_cache(bool& g) : block_pool::cache{pool()}, gone{g} {}
+            ~tls_cache() { gone = true; }
+        };
+        // A flag that's trivially destroyed outlives every cache
+        thread_local bool gone = false;
+        if (gone)
+            return nullptr;
+        thread_local tls_cache c{gone};
+        return &c;
+    }
+    /**
+     * Allocates memory for the objects.
+     * @param n The number of objects.
+     * @return Pointer to uninitialized memory for the objects.
+     */
+    T* allocate(std::size_t n) {
+        if (n == 1) {
+            auto c = thread_cache();
+            return static_cast<T*>(c ? c->allocate() : pool().allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    /**
+     * Releases memory for the objects.
+     * @param p Pointer to the memory.
+     * @param n The number of objects.
+     */
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n == 1) {
+            if (auto c = thread_cache())
+                c->deallocate(p);
+            else
+                pool().deallocate(p);
+        }
+        else
+            ::operator delete(p);
+    }
+};
+
+/** Pool allocators are stateless, so all compare equal */
+template <typename T, typename U>
+bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {
+    return true;
+}
+
+/** Pool allocators are stateless, so all compare equal */
+template <typename T, typename U>
+bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_pool_allocator_h
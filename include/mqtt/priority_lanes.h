@@ -0,0 +1,231 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file priority_lanes.h
+/// Declaration of MQTT priority_lanes class template, a queue that orders
+/// items across a few lanes by weight.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_priority_lanes_h
+#define __mqtt_priority_lanes_h
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/** The weights of a set of priority lanes, from the highest to the lowest */
+using lane_weights = std::vector<unsigned>;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A queue with a few lanes, served in turn by weight.
+ *
+ * Each lane is a FIFO. The lanes are served in rounds, from lane 0 up,
+ * with each lane giving up to its weight in items before the next one
+ * gets a turn, and empty lanes skipped. So the items in a lane keep their
+ * order, and an item in the first lane waits for no more than the weights
+ * of the others, however deep they are, while the last lanes still get a
+ * share and aren't starved.
+ * @par
+ * This is used by the client to order the messages that it holds back,
+ * in the @ref rate_limiter queue and the @ref offline_buffer, by the
+ * message's priority, which is the index of its lane.
+ * @par
+ * The class is not thread-safe. The owner is expected to lock it.
+ *
+ * @tparam T The type of the items.
+ */
+template <typename T>
+class priority_lanes
+{
+public:
+    /** The weights of the lanes */
+    using weights_type = lane_weights;
+
+    /** The default weights: high, normal, and low priority */
+    static weights_type default_weights() { return {8, 2, 1}; }
+
+private:
+    /** The queue for each lane */
+    std::vector<std::deque<T>> lanes_;
+    /** The most items each lane gives in a turn */
+    weights_type weights_;
+    /** The lane whose turn it is */
+    std::size_t cur_{0};
+    /** The items the current lane can still give in its turn */
+    unsigned credit_{0};
+    /** The number of items in all the lanes */
+    std::size_t size_{0};
+
+    /** Moves the turn to the next lane that has an item to give */
+    void select() {
+        while (lanes_[cur_].empty() || credit_ == 0) {
+            cur_ = (cur_ + 1) % lanes_.size();
+            credit_ = weights_[cur_];
+        }
+    }
+
+public:
+    /**
+     * Creates a queue with a lane for each weight.
+     * @param weights The most items each lane gives in a turn. A weight of
+     *  			  zero is taken as one. With no weights, there's a
+     *  			  single lane.
+     */
+    explicit priority_lanes(weights_type weights = default_weights()) {
+        set_weights(std::move(weights));
+    }
+    /**
+     * Gets the number of lanes.
+     * @return The number of lanes.
+     */
+    std::size_t num_lanes() const { return lanes_.size(); }
+    /**
+     * Gets the weights of the lanes.
+     * @return The weights of the lanes.
+     */
+    const weights_type& get_weights() const { return weights_; }
+    /**
+     * Sets the weights of the lanes, which also sets the number of lanes.
+     * If there are fewer lanes than before, the items in the lanes that
+     * go away are moved to the end of the new last lane.
+     * @param weights The most items each lane gives in a turn.
+     */
+    void set_weights(weights_type weights) {
+        if (weights.empty())
+            weights.push_back(1);
+        for (auto& w : weights) w = std::max(w, 1u);
+
+        auto n = weights.size();
+        while (lanes_.size() > n) {
+            auto& last = lanes_[lanes_.size() - 2];
+            for (auto& item : lanes_.back()) last.push_back(std::move(item));
+            lanes_.pop_back();
+        }
+        lanes_.resize(n);
+
+        weights_ = std::move(weights);
+        cur_ = 0;
+        credit_ = weights_[0];
+    }
+    /**
+     * Gets the lane for a priority, clamped to the ones there are.
+     * @param prio The priority, where zero is the highest.
+     * @return The index of the lane.
+     */
+    std::size_t lane(int prio) const {
+        return (prio <= 0) ? 0 : std::min(std::size_t(prio), lanes_.size() - 1);
+    }
+    /**
+     * Gets the number of items in all the lanes.
+     * @return The number of items.
+     */
+    std::size_t size() const { return size_; }
+    /**
+     * Determines if all the lanes are empty.
+     * @return @em true if there are no items.
+     */
+    bool empty() const { return size_ == 0; }
+    /**
+     * Gets the number of items in a lane.
+     * @param prio The priority of the lane.
+     * @return The number of items in the lane.
+     */
+    std::size_t lane_size(int prio) const { return lanes_[lane(prio)].size(); }
+    /**
+     * Adds an item to the back of its lane.
+     * @param prio The priority of the item.
+     * @param item The item.
+     */
+    void push_back(int prio, T item) {
+        lanes_[lane(prio)].push_back(std::move(item));
+        ++size_;
+    }
+    /**
+     * Puts an item back at the front of its lane, as the next one that
+     * the lane gives.
+     * @param prio The priority of the item.
+     * @param item The item.
+     */
+    void push_front(int prio, T item) {
+        lanes_[lane(prio)].push_front(std::move(item));
+        ++size_;
+    }
+    /**
+     * Gets the next item, without taking it.
+     * The queue must not be empty.
+     * @return A reference to the next item.
+     */
+    T& front() {
+        select();
+        return lanes_[cur_].front();
+    }
+    /**
+     * Takes the next item.
+     * The queue must not be empty.
+     * @return The next item.
+     */
+    T pop_front() {
+        select();
+        T item = std::move(lanes_[cur_].front());
+        lanes_[cur_].pop_front();
+        --credit_;
+        --size_;
+        return item;
+    }
+    /**
+     * Takes the items picked by a predicate, from all the lanes.
+     * @param pred Returns @em true for the items to take.
+     * @return The items that were taken, from the first lane to the last.
+     */
+    template <typename Pred>
+    std::vector<T> extract_if(Pred pred) {
+        std::vector<T> taken;
+        for (auto& q : lanes_) {
+            std::deque<T> kept;
+            for (auto& item : q) {
+                if (pred(item))
+                    taken.push_back(std::move(item));
+                else
+                    kept.push_back(std::move(item));
+            }
+            q = std::move(kept);
+        }
+        size_ -= taken.size();
+        return taken;
+    }
+    /**
+     * Takes all of the items.
+     * @return The items, from the first lane to the last.
+     */
+    std::vector<T> take_all() {
+        return extract_if([](const T&) { return true; });
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_priority_lanes_h
@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file probes.h
+/// Static tracepoints (USDT probes) on the hot paths of the library.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_probes_h
+#define __mqtt_probes_h
+
+// When the library is built with the CMake option PAHO_WITH_USDT, these
+// are SystemTap-style static probes, in the "paho_mqttpp" provider, which
+// tools like bpftrace and perf can attach to in a running process:
+//
+//   $ bpftrace -e 'usdt:./app:paho_mqttpp:send_message { @[arg0] = count(); }'
+//
+// Each probe is a single no-op instruction until a tool attaches to it.
+// Otherwise they compile to nothing, and their arguments aren't evaluated.
+//
+// The probes and their arguments:
+//
+//   publish_entry      (topic length, payload size, QoS)
+//   publish_return     (message ID, return code)
+//   send_message       (return code, message ID, topic length, payload size)
+//   token_success      (token type, message ID)
+//   token_failure      (token type, message ID, return code)
+//   message_arrived    (topic length, payload size)
+//   connection_lost    ()
+//   queue_put          (queue depth)
+//   queue_get          (queue depth)
+//   queue_get_n        (number of items, queue depth)
+
+#if defined(PAHO_MQTTPP_WITH_USDT)
+    #include <sys/sdt.h>
+
+    #define PAHO_MQTTPP_PROBE(name) DTRACE_PROBE(paho_mqttpp, name)
+    #define PAHO_MQTTPP_PROBE1(name, a1) DTRACE_PROBE1(paho_mqttpp, name, a1)
+    #define PAHO_MQTTPP_PROBE2(name, a1, a2) DTRACE_PROBE2(paho_mqttpp, name, a1, a2)
+    #define PAHO_MQTTPP_PROBE3(name, a1, a2, a3) \
+        DTRACE_PROBE3(paho_mqttpp, name, a1, a2, a3)
+    #define PAHO_MQTTPP_PROBE4(name, a1, a2, a3, a4) \
+        DTRACE_PROBE4(paho_mqttpp, name, a1, a2, a3, a4)
+#else
+    #define PAHO_MQTTPP_PROBE(name) ((void)0)
+    #define PAHO_MQTTPP_PROBE1(name, a1) ((void)0)
+    #define PAHO_MQTTPP_PROBE2(name, a1, a2) ((void)0)
+    #define PAHO_MQTTPP_PROBE3(name, a1, a2, a3) ((void)0)
+    #define PAHO_MQTTPP_PROBE4(name, a1, a2, a3, a4) ((void)0)
+#endif
+
+#endif  // __mqtt_probes_h
@@ -28,13 +28,17 @@ extern "C" {
 #include "MQTTProperties.h"
 }
 
+#include <cstring>
 #include <initializer_list>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string_view>
 #include <tuple>
 #include <typeinfo>
 #include <stdexcept>
+#include <utility>
 
 #include "mqtt/buffer_ref.h"
 #include "mqtt/exception.h"
@@ -45,6 +49,8 @@ namespace mqtt {
 
 /** A pair of strings as a tuple. */
 using string_pair = std::tuple<string, string>;
+/** A pair of string views, referring to the strings of a property */
+using string_view_pair = std::pair<std::string_view, std::string_view>;
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -187,6 +193,53 @@ public:
      * @return The typeid for the value contained in the property.
      */
     const std::type_info& value_type_id();
+    /**
+     * Gets the type of the value for a property code.
+     * This is the same as the C library's @em MQTTProperty_getType(), but
+     * is resolved inline, without searching a table.
+     * @param c The property code.
+     * @return The type of the value, as one of the C library's
+     *  	   @em MQTTPropertyTypes, or -1 for an unknown code.
+     */
+    static constexpr int type_of(code c) noexcept {
+        switch (c) {
+            case PAYLOAD_FORMAT_INDICATOR:
+            case REQUEST_PROBLEM_INFORMATION:
+            case REQUEST_RESPONSE_INFORMATION:
+            case MAXIMUM_QOS:
+            case RETAIN_AVAILABLE:
+            case WILDCARD_SUBSCRIPTION_AVAILABLE:
+            case SUBSCRIPTION_IDENTIFIERS_AVAILABLE:
+            case SHARED_SUBSCRIPTION_AVAILABLE:
+                return MQTTPROPERTY_TYPE_BYTE;
+            case SERVER_KEEP_ALIVE:
+            case RECEIVE_MAXIMUM:
+            case TOPIC_ALIAS_MAXIMUM:
+            case TOPIC_ALIAS:
+                return MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER;
+            case MESSAGE_EXPIRY_INTERVAL:
+            case SESSION_EXPIRY_INTERVAL:
+            case WILL_DELAY_INTERVAL:
+            case MAXIMUM_PACKET_SIZE:
+                return MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER;
+            case SUBSCRIPTION_IDENTIFIER:
+                return MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER;
+            case CORRELATION_DATA:
+            case AUTHENTICATION_DATA:
+                return MQTTPROPERTY_TYPE_BINARY_DATA;
+            case CONTENT_TYPE:
+            case RESPONSE_TOPIC:
+            case ASSIGNED_CLIENT_IDENTIFIER:
+            case AUTHENTICATION_METHOD:
+            case RESPONSE_INFORMATION:
+            case SERVER_REFERENCE:
+            case REASON_STRING:
+                return MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING;
+            case USER_PROPERTY:
+                return MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR;
+        }
+        return -1;
+    }
 };
 
 std::ostream& operator<<(std::ostream& os, const property& prop);
@@ -281,6 +334,141 @@ inline string_pair get<string_pair>(const property& prop) {
     return std::make_tuple(std::move(name), std::move(value));
 }
 
+// --------------------------------------------------------------------------
+// Non-throwing access
+//
+// The try_get() functions check that the property holds a value of the
+// requested type, and return std::nullopt if it doesn't, rather than
+// throwing. The string views refer to the memory of the property, and are
+// only valid as long as it is.
+
+/**
+ * Extracts the value from a C property struct as the specified type.
+ * @return The value, or @em std::nullopt if the property doesn't hold a
+ *  	   value of that type.
+ */
+template <typename T>
+inline std::optional<T> try_get(const MQTTProperty&) {
+    return std::nullopt;
+}
+
+/**
+ * Extracts the value from a C property struct as an unsigned 8-bit
+ * integer.
+ * @return The value, or @em std::nullopt if it's not a byte property.
+ */
+template <>
+inline std::optional<uint8_t> try_get<uint8_t>(const MQTTProperty& cprop) {
+    if (property::type_of(property::code(cprop.identifier)) != MQTTPROPERTY_TYPE_BYTE)
+        return std::nullopt;
+    return uint8_t(cprop.value.byte);
+}
+
+/**
+ * Extracts the value from a C property struct as an unsigned 16-bit
+ * integer.
+ * @return The value, or @em std::nullopt if it's not a 2-byte integer
+ *  	   property.
+ */
+template <>
+inline std::optional<uint16_t> try_get<uint16_t>(const MQTTProperty& cprop) {
+    if (property::type_of(property::code(cprop.identifier)) !=
+        MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER)
+        return std::nullopt;
+    return uint16_t(cprop.value.integer2);
+}
+
+/**
+ * Extracts the value from a C property struct as an unsigned 32-bit
+ * integer.
+ * @return The value, or @em std::nullopt if it's not a 4-byte or variable
+ *  	   byte integer property.
+ */
+template <>
+inline std::optional<uint32_t> try_get<uint32_t>(const MQTTProperty& cprop) {
+    auto typ = property::type_of(property::code(cprop.identifier));
+    if (typ != MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER &&
+        typ != MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER)
+        return std::nullopt;
+    return uint32_t(cprop.value.integer4);
+}
+
+/**
+ * Gets a view of the value of a C property struct, for a string or binary
+ * property, without copying it.
+ * @return A view of the value, or @em std::nullopt if it's not a string
+ *  	   or binary property.
+ */
+template <>
+inline std::optional<std::string_view> try_get<std::string_view>(const MQTTProperty& cprop) {
+    auto typ = property::type_of(property::code(cprop.identifier));
+    if (typ != MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING && typ != MQTTPROPERTY_TYPE_BINARY_DATA)
+        return std::nullopt;
+    if (!cprop.value.data.data)
+        return std::string_view{};
+    return std::string_view{cprop.value.data.data, size_t(cprop.value.data.len)};
+}
+
+/**
+ * Extracts a copy of the value of a C property struct, for a string or
+ * binary property.
+ * @return The value, or @em std::nullopt if it's not a string or binary
+ *  	   property.
+ */
+template <>
+inline std::optional<string> try_get<string>(const MQTTProperty& cprop) {
+    auto sv = try_get<std::string_view>(cprop);
+    if (!sv)
+        return std::nullopt;
+    return string{*sv};
+}
+
+/**
+ * Gets views of the name and value of a C property struct, for a user
+ * property, without copying them.
+ * @return Views of the name and value, or @em std::nullopt if it's not a
+ *  	   string pair property.
+ */
+template <>
+inline std::optional<string_view_pair> try_get<string_view_pair>(const MQTTProperty& cprop) {
+    if (property::type_of(property::code(cprop.identifier)) !=
+        MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR)
+        return std::nullopt;
+
+    const auto& name = cprop.value.data;
+    const auto& val = cprop.value.value;
+    return string_view_pair{
+        name.data ? std::string_view{name.data, size_t(name.len)} : std::string_view{},
+        val.data ? std::string_view{val.data, size_t(val.len)} : std::string_view{}
+    };
+}
+
+/**
+ * Extracts a copy of the name and value of a C property struct, for a
+ * user property.
+ * @return The name and value, or @em std::nullopt if it's not a string
+ *  	   pair property.
+ */
+template <>
+inline std::optional<string_pair> try_get<string_pair>(const MQTTProperty& cprop) {
+    auto kv = try_get<string_view_pair>(cprop);
+    if (!kv)
+        return std::nullopt;
+    return string_pair{string{kv->first}, string{kv->second}};
+}
+
+/**
+ * Extracts the value from the property as the specified type, without
+ * throwing.
+ * @param prop The property
+ * @return The value, or @em std::nullopt if the property doesn't hold a
+ *  	   value of that type.
+ */
+template <typename T>
+inline std::optional<T> try_get(const property& prop) {
+    return try_get<T>(prop.c_struct());
+}
+
 /////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -294,8 +482,24 @@ class properties
     /** The default C struct */
     static constexpr MQTTProperties DFLT_C_STRUCT MQTTProperties_initializer;
 
-    /** The underlying C properties struct */
+    /**
+     * The underlying C properties struct.
+     * This is a view of the list held by the owner, below. It's kept in
+     * the object so that its address is stable for the C options structs
+     * that point to it.
+     */
     MQTTProperties props_{DFLT_C_STRUCT};
+    /**
+     * The owner of the C list, which is shared by copies. The list is
+     * immutable while it's shared, and copied on the first change. This is
+     * null for an empty list, which doesn't use any memory.
+     */
+    std::shared_ptr<MQTTProperties> rep_;
+
+    /** Makes an owner for a C list that this object allocated. */
+    static std::shared_ptr<MQTTProperties> make_rep(const MQTTProperties& cprops);
+    /** Makes sure that this object is the only owner of the list. */
+    void detach();
 
     template <typename T>
     friend T get(const properties& props, property::code propid, size_t idx);
@@ -304,22 +508,52 @@ class properties
     friend T get(const properties& props, property::code propid);
 
 public:
-    /** A const iterator for the properties list */
+    /**
+     * A const iterator for the properties list.
+     * Dereferencing it gives a view of the property in the list, without
+     * copying it. The reference is valid until the iterator is moved or
+     * destroyed; copy the property to keep it for longer.
+     */
     class const_iterator
     {
         const MQTTProperty* curr_;
+        /** A shallow view of the current item, which never owns memory */
         mutable property prop_;
 
         friend properties;
-        const_iterator(const MQTTProperty* curr) : curr_{curr} {}
+
+        template <typename T>
+        friend T get(const properties& props, property::code propid, size_t idx);
+
+        const_iterator(const MQTTProperty* curr) : curr_{curr} {
+            std::memset(&prop_.prop_, 0, sizeof(MQTTProperty));
+        }
 
     public:
+        /**
+         * Copy constructor.
+         * @param other The other iterator.
+         */
+        const_iterator(const const_iterator& other) : const_iterator{other.curr_} {}
+        /**
+         * Destructor.
+         */
+        ~const_iterator() { std::memset(&prop_.prop_, 0, sizeof(MQTTProperty)); }
+        /**
+         * Copy assignment.
+         * @param rhs The other iterator.
+         * @return A reference to this object.
+         */
+        const_iterator& operator=(const const_iterator& rhs) noexcept {
+            curr_ = rhs.curr_;
+            return *this;
+        }
         /**
          * Gets a reference to the current value.
          * @return A reference to the current value.
          */
         const property& operator*() const {
-            prop_ = property{*curr_};
+            std::memcpy(&prop_.prop_, curr_, sizeof(MQTTProperty));
             return prop_;
         }
         /**
@@ -358,21 +592,23 @@ public:
     properties() {}
     /**
      * Copy constructor.
+     * This shares the list with the other one, without copying it.
      * @param other The property list to copy.
      */
-    properties(const properties& other) : props_(::MQTTProperties_copy(&other.props_)) {}
+    properties(const properties& other) : props_{other.props_}, rep_{other.rep_} {}
     /**
      * Move constructor.
      * @param other The property list to move to this one.
      */
-    properties(properties&& other) : props_(other.props_) {
-        std::memset(&other.props_, 0, sizeof(MQTTProperties));
+    properties(properties&& other) : props_{other.props_}, rep_{std::move(other.rep_)} {
+        other.props_ = DFLT_C_STRUCT;
     }
     /**
      * Creates a list of properties from a C struct.
+     * This makes a deep copy of the C list.
      * @param cprops The c struct of properties
      */
-    properties(const MQTTProperties& cprops) { props_ = ::MQTTProperties_copy(&cprops); }
+    properties(const MQTTProperties& cprops);
     /**
      * Constructs from a list of property objects.
      * @param props An initializer list of property objects.
@@ -381,7 +617,7 @@ public:
     /**
      * Destructor.
      */
-    ~properties() { ::MQTTProperties_free(&props_); }
+    ~properties() {}
     /**
      * Gets a reference to the underlying C properties structure.
      * @return A const reference to the underlying C properties structure.
@@ -452,11 +688,14 @@ public:
      * Adds a property to the list.
      * @param prop The property to add to the list.
      */
-    void add(const property& prop) { ::MQTTProperties_add(&props_, &prop.c_struct()); }
+    void add(const property& prop);
     /**
      * Removes all the items from the property list.
      */
-    void clear() { ::MQTTProperties_free(&props_); }
+    void clear() {
+        props_ = DFLT_C_STRUCT;
+        rep_.reset();
+    }
     /**
      * Determines if the list contains a specific property.
      * @param propid The property ID (code).
@@ -491,6 +730,30 @@ public:
      * @return The requested property
      */
     property get(property::code propid, size_t idx = 0) const;
+    /**
+     * Gets the size of the properties in the packed format.
+     * @return The number of bytes that pack() writes.
+     */
+    size_t packed_size() const;
+    /**
+     * Writes the properties in a simple packed format, for keeping them
+     * in files or shared memory.
+     * Each property is its ID as a byte, then a 32-bit value for the
+     * numeric types, or a 32-bit length and the bytes for each string or
+     * binary value, in the host's byte order.
+     * @param p Where to write the properties. There must be room for
+     *  		packed_size() bytes.
+     * @return A pointer just past the properties that were written.
+     */
+    char* pack(char* p) const;
+    /**
+     * Reads properties that were written by pack().
+     * This stops at anything that's malformed.
+     * @param p The packed properties.
+     * @param n The size of the packed properties.
+     * @return The properties.
+     */
+    static properties unpack(const char* p, size_t n);
 };
 
 // --------------------------------------------------------------------------
@@ -512,7 +775,7 @@ inline T get(const properties& props, property::code propid, size_t idx) {
     if (!prop)
         throw bad_cast();
 
-    return get<T>(property(*prop));
+    return get<T>(*properties::const_iterator{prop});
 }
 
 /**
@@ -527,6 +790,126 @@ inline T get(const properties& props, property::code propid) {
     return get<T>(props, propid, 0);
 }
 
+/**
+ * Retrieves a single value from a property list, without throwing, or
+ * copying the property.
+ *
+ * This searches the list directly, and returns std::nullopt if the
+ * property is missing, or doesn't hold a value of the requested type. The
+ * views, @em std::string_view and @ref string_view_pair, refer into the
+ * list, and are only valid until it is changed or destroyed.
+ *
+ * @tparam T The type of the value to retrieve
+ * @param props The property list
+ * @param propid The property ID code for the desired value.
+ * @param idx Index of the desired property ID, if there are more than
+ *  		  one.
+ * @return The requested value, if it's there.
+ */
+template <typename T>
+inline std::optional<T> try_get(const properties& props, property::code propid, size_t idx = 0) {
+    const auto& cprops = props.c_struct();
+    for (int i = 0; i < cprops.count; ++i) {
+        const auto& cprop = cprops.array[i];
+        if (cprop.identifier == MQTTPropertyCodes(propid) && idx-- == 0)
+            return try_get<T>(cprop);
+    }
+    return std::nullopt;
+}
+
+/**
+ * Finds the value of a user property by name, without allocating any
+ * memory.
+ * @param props The property list
+ * @param name The name of the user property.
+ * @return A view of the value of the first user property with the name,
+ *  	   if there is one. It refers into the list, and is only valid until
+ *  	   the list is changed or destroyed.
+ */
+std::optional<std::string_view> get_user_property(
+    const properties& props, std::string_view name
+) noexcept;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An index into a property list, to look up several properties of the
+ * same list quickly.
+ *
+ * Searching a list for a property is a linear scan, which adds up when a
+ * consumer reads a handful of properties from every message. The index
+ * makes one pass over the list and records where the first property with
+ * each code is, so that each lookup after that goes straight to it. It
+ * takes no memory from the heap, so it can be made on the stack for each
+ * message:
+ * @code
+ * mqtt::property_index idx{msg->get_properties()};
+ * auto ctype = idx.try_get<std::string_view>(mqtt::property::CONTENT_TYPE);
+ * auto tenant = idx.get_user_property("tenant");
+ * @endcode
+ * The index refers to the list, and is only valid until the list is
+ * changed or destroyed.
+ */
+class property_index
+{
+    /** The number of property codes */
+    static constexpr size_t N_CODES = property::SHARED_SUBSCRIPTION_AVAILABLE + 1;
+    /** The position for a code that's not in the list */
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    /** The indexed list */
+    const MQTTProperties* props_;
+    /** The position of the first property with each code */
+    uint16_t first_[N_CODES];
+
+    /** Gets the position to start searching for a code */
+    int start(property::code propid) const noexcept {
+        auto c = size_t(propid);
+        if (c >= N_CODES || first_[c] == NONE)
+            return props_->count;
+        return int(first_[c]);
+    }
+
+public:
+    /**
+     * Creates an index of a property list.
+     * @param props The property list.
+     */
+    explicit property_index(const properties& props) noexcept;
+    /**
+     * Determines if the list contains a specific property.
+     * @param propid The property ID (code).
+     * @return @em true if the list contains the property, @em false if not.
+     */
+    bool contains(property::code propid) const noexcept { return start(propid) < props_->count; }
+    /**
+     * Retrieves a single value from the property list, without throwing,
+     * or copying the property.
+     * @tparam T The type of the value to retrieve
+     * @param propid The property ID code for the desired value.
+     * @param idx Index of the desired property ID, if there are more than
+     *  		  one.
+     * @return The requested value, if it's there.
+     */
+    template <typename T>
+    std::optional<T> try_get(property::code propid, size_t idx = 0) const {
+        for (int i = start(propid); i < props_->count; ++i) {
+            const auto& cprop = props_->array[i];
+            if (cprop.identifier == MQTTPropertyCodes(propid) && idx-- == 0)
+                return mqtt::try_get<T>(cprop);
+        }
+        return std::nullopt;
+    }
+    /**
+     * Finds the value of a user property by name, without allocating any
+     * memory.
+     * @param name The name of the user property.
+     * @return A view of the value of the first user property with the
+     *  	   name, if there is one.
+     */
+    std::optional<std::string_view> get_user_property(std::string_view name) const noexcept;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 }  // namespace mqtt
 
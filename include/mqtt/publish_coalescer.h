@@ -0,0 +1,169 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file publish_coalescer.h
+/// Declaration of MQTT publish_coalescer class, which collects outgoing
+/// messages into bursts.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_publish_coalescer_h
+#define __mqtt_publish_coalescer_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Collects outgoing messages and sends them in bursts.
+ *
+ * Each message is added as an operation that sends it. The operations are
+ * held until the oldest one has waited for the coalescing delay, or until
+ * the messages add up to the size threshold, and are then run together,
+ * in order, from the coalescer's thread.
+ * @par
+ * The async_client uses this for QoS 0 messages when a coalescing delay is
+ * set in its create_options. Handing the library a burst of messages at
+ * once, rather than a steady trickle, lets its send thread write them in
+ * a single pass, instead of waking up for each one. This trades a little
+ * latency, up to the delay, for throughput with small, frequent messages.
+ */
+class publish_coalescer
+{
+public:
+    /** The type of clock used for the delay */
+    using clock = std::chrono::steady_clock;
+    /** The type of duration used for the delay */
+    using duration = clock::duration;
+    /** An operation that sends a message */
+    using task_type = std::function<void()>;
+
+    /** The default threshold, in bytes, that triggers a flush */
+    static constexpr size_t DFLT_MAX_BYTES = 64 * 1024;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** General purpose guard */
+    using unique_guard = std::unique_lock<std::mutex>;
+
+    /** The longest time a message is held before it is sent */
+    duration delay_;
+    /** The amount of held data that triggers a flush */
+    size_t maxBytes_;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** Keeps the bursts in order when flushed from different threads */
+    std::mutex flushLock_;
+    /** Signals the flush thread */
+    std::condition_variable cond_;
+    /** The operations waiting to be run */
+    std::vector<task_type> pending_;
+    /** The number of bytes of pending messages */
+    size_t pendingBytes_{0};
+    /** The time of the oldest pending message */
+    clock::time_point oldest_;
+    /** The number of bursts sent */
+    size_t nFlushes_{0};
+    /** Whether the flush thread should exit */
+    bool stop_{false};
+    /** The flush thread */
+    std::thread thr_;
+
+    /** The function run by the flush thread */
+    void run();
+
+    publish_coalescer(const publish_coalescer&) = delete;
+    publish_coalescer& operator=(const publish_coalescer&) = delete;
+
+public:
+    /**
+     * Creates a coalescer.
+     * @param delay The longest time that a message is held before it is
+     *  			sent.
+     * @param maxBytes The amount of held data that triggers a flush.
+     */
+    template <class Rep, class Period>
+    publish_coalescer(
+        const std::chrono::duration<Rep, Period>& delay, size_t maxBytes = DFLT_MAX_BYTES
+    )
+        : delay_{std::chrono::duration_cast<duration>(delay)}, maxBytes_{maxBytes} {
+        thr_ = std::thread(&publish_coalescer::run, this);
+    }
+    /**
+     * Destroys the coalescer, sending any pending messages.
+     */
+    ~publish_coalescer();
+    /**
+     * Gets the coalescing delay.
+     * @return The longest time a message is held before it is sent.
+     */
+    duration get_delay() const { return delay_; }
+    /**
+     * Gets the size threshold that triggers a flush.
+     * @return The amount of held data that triggers a flush.
+     */
+    size_t get_max_bytes() const { return maxBytes_; }
+    /**
+     * Gets the number of messages waiting to be sent.
+     * @return The number of messages waiting to be sent.
+     */
+    size_t num_pending() const {
+        guard g{lock_};
+        return pending_.size();
+    }
+    /**
+     * Gets the number of bytes of the messages waiting to be sent.
+     * @return The number of bytes of the messages waiting to be sent.
+     */
+    size_t pending_bytes() const {
+        guard g{lock_};
+        return pendingBytes_;
+    }
+    /**
+     * Gets the number of bursts that were sent.
+     * @return The number of bursts that were sent.
+     */
+    size_t num_flushes() const {
+        guard g{lock_};
+        return nFlushes_;
+    }
+    /**
+     * Adds a message to the next burst.
+     * @param nBytes The size of the message.
+     * @param task The operation that sends the message.
+     */
+    void add(size_t nBytes, task_type task);
+    /**
+     * Sends all the pending messages now.
+     */
+    void flush();
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_publish_coalescer_h
@@ -0,0 +1,456 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file publish_retrier.h
+/// Declaration of MQTT retry_policy and publish_retrier classes, to retry
+/// failed publishes with a capped, exponential backoff, and keep the ones
+/// that never got through.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_publish_retrier_h
+#define __mqtt_publish_retrier_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "MQTTAsync.h"
+#include "mqtt/message.h"
+#include "mqtt/reason_code.h"
+#include "mqtt/timer_wheel.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The settings for retrying publishes that fail.
+ *
+ * Each retry of a message waits longer than the one before, by a
+ * multiplier, up to a maximum, and each wait is shortened by a random
+ * amount, the jitter, so that a burst of messages that failed together
+ * don't all go back out together. Only the failures that are likely to
+ * clear up on their own are retried, like a lost connection, a full send
+ * queue, or a server that says it's busy or over quota.
+ */
+class retry_policy
+{
+public:
+    /** A function to decide whether a failure is worth retrying */
+    using filter_type = std::function<bool(int rc, ReasonCode reason)>;
+
+    /** The default wait before the first retry */
+    static constexpr std::chrono::milliseconds DFLT_MIN_DELAY{100};
+    /** The default longest wait between retries */
+    static constexpr std::chrono::milliseconds DFLT_MAX_DELAY{30000};
+    /** The default number of retries for a message */
+    static constexpr unsigned DFLT_MAX_RETRIES = 5;
+
+private:
+    /** The wait before the first retry */
+    std::chrono::milliseconds minDelay_{DFLT_MIN_DELAY};
+    /** The longest wait between retries */
+    std::chrono::milliseconds maxDelay_{DFLT_MAX_DELAY};
+    /** What the wait is multiplied by after each retry */
+    double multiplier_{2.0};
+    /** The most that a wait is shortened at random, as a fraction */
+    double jitter_{0.5};
+    /** The most retries for a message */
+    unsigned maxRetries_{DFLT_MAX_RETRIES};
+    /** The app's choice of the failures to retry, if any */
+    filter_type filter_;
+
+public:
+    /**
+     * Creates a policy with the default settings.
+     */
+    retry_policy() {}
+    /**
+     * Creates a policy with the range of waits between retries.
+     * @param minDelay The wait before the first retry.
+     * @param maxDelay The longest wait between retries.
+     * @param maxRetries The most retries for a message.
+     */
+    template <class Rep1, class Period1, class Rep2, class Period2>
+    retry_policy(
+        const std::chrono::duration<Rep1, Period1>& minDelay,
+        const std::chrono::duration<Rep2, Period2>& maxDelay,
+        unsigned maxRetries = DFLT_MAX_RETRIES
+    )
+        : maxRetries_{maxRetries} {
+        set_delay(minDelay, maxDelay);
+    }
+    /**
+     * Gets the wait before the first retry.
+     * @return The wait before the first retry.
+     */
+    std::chrono::milliseconds get_min_delay() const { return minDelay_; }
+    /**
+     * Gets the longest wait between retries.
+     * @return The longest wait between retries.
+     */
+    std::chrono::milliseconds get_max_delay() const { return maxDelay_; }
+    /**
+     * Sets the range of waits between retries.
+     * @param minDelay The wait before the first retry.
+     * @param maxDelay The longest wait between retries. This is raised to
+     *  			   the minimum if it's less.
+     */
+    template <class Rep1, class Period1, class Rep2, class Period2>
+    void set_delay(
+        const std::chrono::duration<Rep1, Period1>& minDelay,
+        const std::chrono::duration<Rep2, Period2>& maxDelay
+    ) {
+        minDelay_ = std::max(to_milliseconds(minDelay), std::chrono::milliseconds::zero());
+        maxDelay_ = std::max(to_milliseconds(maxDelay), minDelay_);
+    }
+    /**
+     * Gets what the wait is multiplied by after each retry.
+     * @return The backoff multiplier.
+     */
+    double get_multiplier() const { return multiplier_; }
+    /**
+     * Sets what the wait is multiplied by after each retry.
+     * @param mult The backoff multiplier. Values below one are taken as
+     *  		   one, for a fixed wait.
+     */
+    void set_multiplier(double mult) { multiplier_ = std::max(mult, 1.0); }
+    /**
+     * Gets the most that a wait is shortened at random.
+     * @return The jitter, as a fraction of the wait.
+     */
+    double get_jitter() const { return jitter_; }
+    /**
+     * Sets the most that a wait is shortened at random.
+     * @param jitter The jitter, as a fraction of the wait, from 0.0 for
+     *  			 none, to 1.0, for a wait anywhere from zero up to the
+     *  			 full backoff.
+     */
+    void set_jitter(double jitter) { jitter_ = std::min(std::max(jitter, 0.0), 1.0); }
+    /**
+     * Gets the most retries for a message.
+     * @return The most retries for a message.
+     */
+    unsigned get_max_retries() const { return maxRetries_; }
+    /**
+     * Sets the most retries for a message.
+     * @param n The most retries for a message. With zero, a failed
+     *  		message goes straight to the dead letters.
+     */
+    void set_max_retries(unsigned n) { maxRetries_ = n; }
+    /**
+     * Sets the function that decides which failures are retried, in place
+     * of the default.
+     * @param filter The function, or an empty one to go back to the
+     *  			 default.
+     */
+    void set_filter(filter_type filter) { filter_ = std::move(filter); }
+    /**
+     * Determines if a failure is the kind that the default policy retries.
+     * These are the ones caused by the connection or the load on the
+     * client or server, rather than the message itself.
+     * @param rc The return code of the failure.
+     * @param reason The MQTT v5 reason code of the failure, if any.
+     * @return @em true if the failure is worth retrying.
+     */
+    static bool is_transient(int rc, ReasonCode reason) {
+        switch (reason) {
+            case ReasonCode::QUOTA_EXCEEDED:
+            case ReasonCode::SERVER_BUSY:
+            case ReasonCode::SERVER_UNAVAILABLE:
+            case ReasonCode::RECEIVE_MAXIMUM_EXCEEDED:
+                return true;
+            default:
+                break;
+        }
+        return rc == MQTTASYNC_DISCONNECTED || rc == MQTTASYNC_OPERATION_INCOMPLETE ||
+               rc == MQTTASYNC_MAX_BUFFERED_MESSAGES;
+    }
+    /**
+     * Determines if a failure should be retried.
+     * @param rc The return code of the failure.
+     * @param reason The MQTT v5 reason code of the failure, if any.
+     * @return @em true if the failure should be retried.
+     */
+    bool is_retryable(int rc, ReasonCode reason) const {
+        return filter_ ? filter_(rc, reason) : is_transient(rc, reason);
+    }
+    /**
+     * Gets the wait before a retry.
+     * @param retry The number of retries already made for the message.
+     * @param rnd A random number from 0.0 up to, but not including, 1.0,
+     *  		  for the jitter.
+     * @return The time to wait before the retry.
+     */
+    std::chrono::milliseconds get_delay(unsigned retry, double rnd) const {
+        double ms = double(minDelay_.count()) * std::pow(multiplier_, double(retry));
+        ms = std::min(ms, double(maxDelay_.count()));
+        ms *= 1.0 - jitter_ * std::min(std::max(rnd, 0.0), 1.0);
+        return std::chrono::milliseconds(std::llround(ms));
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A message that couldn't be published, even after it was retried.
+ */
+struct dead_letter
+{
+    /** The message */
+    const_message_ptr msg;
+    /** The return code of the last failure */
+    int rc{MQTTASYNC_FAILURE};
+    /** The MQTT v5 reason code of the last failure, if any */
+    ReasonCode reasonCode{ReasonCode::SUCCESS};
+    /** The number of times the message was retried */
+    unsigned retries{0};
+    /** The time the message was given up on */
+    std::chrono::system_clock::time_point time{};
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Retries failed publishes on a schedule, and keeps the ones that ran out
+ * of retries.
+ *
+ * The retries of all the messages are timers on a single @ref timer_wheel,
+ * so a burst of failures costs a timer each, not a thread or a busy loop.
+ * The wheel is normally the one shared by the whole client. The backoff
+ * comes from the @ref retry_policy.
+ * @par
+ * The messages that run out of retries are put in a bounded store of
+ * dead letters, oldest first, where the app can take them to log, save,
+ * or publish again later. When the store is full, the oldest one is
+ * dropped to make room. A handler can also be told about each one as it
+ * arrives.
+ * @par
+ * The retrier is normally used by the async_client, through
+ * `async_client::start_publish_retry()`.
+ */
+class publish_retrier
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<publish_retrier>;
+    /** The clock for the retry times */
+    using clock = std::chrono::steady_clock;
+    /**
+     * A scheduled retry.
+     * This is called with @em true when the retry is due, or with
+     * @em false if the retrier is stopped first.
+     */
+    using task_type = std::function<void(bool)>;
+    /** Handler for a new dead letter */
+    using dead_letter_handler = std::function<void(const dead_letter&)>;
+
+    /** The default number of dead letters to keep */
+    static constexpr std::size_t DFLT_MAX_DEAD_LETTERS = 1000;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** Lock guard that can be used for waiting */
+    using unique_lock = std::unique_lock<std::mutex>;
+
+    /** A scheduled retry */
+    struct entry
+    {
+        /** The timer for the retry */
+        timer_wheel::timer_id timer;
+        /** The operation for the retry */
+        task_type task;
+    };
+
+    /** The policy for the retries */
+    const retry_policy policy_;
+    /** The most dead letters to keep */
+    const std::size_t maxDeadLetters_;
+
+    /** Lock for everything below */
+    mutable std::mutex lock_;
+    /** The wheel for the retry timers */
+    timer_wheel_ptr wheel_;
+    /** The scheduled retries, by the order they were scheduled */
+    std::unordered_map<uint64_t, entry> que_;
+    /** The count of retries scheduled, as keys for the retries */
+    uint64_t seq_{0};
+    /** The timer of the retry that's running, if any */
+    timer_wheel::timer_id running_{0};
+    /** The random numbers for the jitter */
+    std::mt19937 rng_{std::random_device{}()};
+    /** The dead letters, oldest first */
+    std::deque<dead_letter> deadLetters_;
+    /** The handler for new dead letters */
+    dead_letter_handler deadLetterHandler_;
+    /** Whether the retrier was stopped */
+    bool stopped_{false};
+
+    /** The number of retries scheduled */
+    std::atomic<uint64_t> nRetries_{0};
+    /** The number of messages delivered after being retried */
+    std::atomic<uint64_t> nRecovered_{0};
+    /** The number of messages that ran out of retries */
+    std::atomic<uint64_t> nDeadLettered_{0};
+    /** The number of dead letters dropped to make room for new ones */
+    std::atomic<uint64_t> nDropped_{0};
+
+    /** Runs a retry when its timer fires */
+    void run(uint64_t key);
+
+public:
+    /**
+     * Creates a retrier.
+     * @param policy The policy for the retries.
+     * @param maxDeadLetters The most dead letters to keep.
+     * @param wheel The wheel for the retry timers. If null, the retrier
+     *  			makes one of its own.
+     */
+    explicit publish_retrier(
+        retry_policy policy = retry_policy{},
+        std::size_t maxDeadLetters = DFLT_MAX_DEAD_LETTERS,
+        timer_wheel_ptr wheel = timer_wheel_ptr{}
+    );
+    /**
+     * Destroys the retrier, stopping it.
+     */
+    ~publish_retrier();
+
+    publish_retrier(const publish_retrier&) = delete;
+    publish_retrier& operator=(const publish_retrier&) = delete;
+
+    /**
+     * Gets the policy for the retries.
+     * @return The policy for the retries.
+     */
+    const retry_policy& get_policy() const { return policy_; }
+    /**
+     * Gets the most dead letters that are kept.
+     * @return The most dead letters that are kept.
+     */
+    std::size_t get_max_dead_letters() const { return maxDeadLetters_; }
+    /**
+     * Gets the wheel for the retry timers.
+     * @return The wheel for the retry timers.
+     */
+    timer_wheel_ptr get_timer_wheel() const { return wheel_; }
+    /**
+     * Schedules a retry after the backoff in the policy.
+     * @param retry The number of retries already made for the message.
+     * @param task The operation for the retry.
+     * @return @em true if it was scheduled, @em false if the retrier is
+     *  	   stopped, in which case the task is not called.
+     */
+    bool schedule(unsigned retry, task_type task);
+    /**
+     * Schedules a retry at a specific time.
+     * @param due The time the retry is due.
+     * @param task The operation for the retry.
+     * @return @em true if it was scheduled, @em false if the retrier is
+     *  	   stopped, in which case the task is not called.
+     */
+    bool schedule_at(clock::time_point due, task_type task);
+    /**
+     * Adds a message that ran out of retries to the dead letters.
+     * If the store is full, the oldest one is dropped to make room.
+     * @param dl The dead letter.
+     */
+    void add_dead_letter(dead_letter dl);
+    /**
+     * Notes that a message was delivered after being retried.
+     */
+    void on_recovered() { nRecovered_.fetch_add(1, std::memory_order_relaxed); }
+    /**
+     * Sets a handler that's told about each new dead letter.
+     * This is called from the thread that gave up on the message, which
+     * is normally the library's callback thread, so it should be quick.
+     * @param cb The handler.
+     */
+    void set_dead_letter_handler(dead_letter_handler cb);
+    /**
+     * Takes all the dead letters out of the store.
+     * @return The dead letters, oldest first.
+     */
+    std::vector<dead_letter> take_dead_letters();
+    /**
+     * Gets the number of dead letters in the store.
+     * @return The number of dead letters in the store.
+     */
+    std::size_t num_dead_letters() const {
+        guard g{lock_};
+        return deadLetters_.size();
+    }
+    /**
+     * Gets the number of retries waiting for their time.
+     * @return The number of scheduled retries.
+     */
+    std::size_t num_scheduled() const {
+        guard g{lock_};
+        return que_.size();
+    }
+    /**
+     * Gets the number of retries that were scheduled.
+     * @return The number of retries that were scheduled.
+     */
+    uint64_t num_retries() const { return nRetries_.load(std::memory_order_relaxed); }
+    /**
+     * Gets the number of messages that were delivered after being
+     * retried.
+     * @return The number of messages that were delivered after a retry.
+     */
+    uint64_t num_recovered() const { return nRecovered_.load(std::memory_order_relaxed); }
+    /**
+     * Gets the number of messages that ran out of retries.
+     * @return The number of messages that became dead letters.
+     */
+    uint64_t num_dead_lettered() const {
+        return nDeadLettered_.load(std::memory_order_relaxed);
+    }
+    /**
+     * Gets the number of dead letters that were dropped from a full store.
+     * @return The number of dead letters that were dropped.
+     */
+    uint64_t num_dead_letters_dropped() const {
+        return nDropped_.load(std::memory_order_relaxed);
+    }
+    /**
+     * Stops the retrier.
+     * Any retries still waiting are called with @em false, from the
+     * calling thread, and no more can be scheduled.
+     */
+    void stop();
+};
+
+/** Smart/shared pointer to a publish_retrier */
+using publish_retrier_ptr = publish_retrier::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_publish_retrier_h
@@ -0,0 +1,267 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file rate_limiter.h
+/// Declaration of MQTT rate_limiter class, a token bucket to limit the
+/// rate of outgoing messages.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_rate_limiter_h
+#define __mqtt_rate_limiter_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "mqtt/priority_lanes.h"
+#include "mqtt/timer_wheel.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Limits the rate of outgoing messages with a pair of token buckets, one
+ * for the number of messages and the other for the number of bytes.
+ *
+ * Each bucket fills at the configured rate, up to a burst size, and a
+ * message can go once both buckets have enough in them for it. A message
+ * larger than the byte bucket can go when the bucket is full, leaving
+ * the bucket in debt, so that messages of any size eventually get
+ * through, while still keeping to the average rate.
+ * @par
+ * The limiter is normally used by the async_client, through
+ * `async_client::start_rate_limiting()`, in which case the policy tells
+ * the client what to do with a message that arrives too soon: block the
+ * publishing thread until it can go, fail the publish, or queue the
+ * message to be sent from a @ref timer_wheel when its turn comes.
+ * @par
+ * It also measures the recent rate of messages and bytes that it let
+ * through, as a moving average over about the last second.
+ */
+class rate_limiter
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<rate_limiter>;
+    /** The clock used for timing */
+    using clock = std::chrono::steady_clock;
+    /**
+     * A queued operation.
+     * This is called with @em true when it's the operation's turn, or
+     * with @em false if the limiter stopped before it got one.
+     */
+    using task_type = std::function<void(bool)>;
+
+    /** What to do with a message that would exceed the rate */
+    enum Policy {
+        BLOCK,  ///< Wait until it can go
+        FAIL,   ///< Reject it
+        QUEUE   ///< Queue it to go later
+    };
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** Lock guard that can be used for waiting */
+    using unique_lock = std::unique_lock<std::mutex>;
+
+    /** A single token bucket */
+    struct bucket
+    {
+        /** The rate at which the bucket fills, per second. Zero for no limit */
+        double rate;
+        /** The most that the bucket can hold */
+        double capacity;
+        /** What the bucket holds now, which can be negative */
+        double level;
+    };
+
+    /** A queued operation */
+    struct pending
+    {
+        /** The size of the message */
+        std::size_t nBytes;
+        /** The operation */
+        task_type task;
+    };
+
+    /** The policy for messages that would exceed the rate */
+    const Policy policy_;
+
+    /** Lock for everything below */
+    mutable std::mutex lock_;
+    /** Signaled when an operation is queued or the limiter stops */
+    std::condition_variable cond_;
+    /** The bucket for the number of messages */
+    bucket msgs_;
+    /** The bucket for the number of bytes */
+    bucket bytes_;
+    /** The last time the buckets were filled */
+    clock::time_point lastFill_;
+    /** The recent rate of messages, as a decaying count */
+    mutable double msgRate_{0.0};
+    /** The recent rate of bytes, as a decaying count */
+    mutable double byteRate_{0.0};
+    /** The last time the rates were decayed */
+    mutable clock::time_point lastRate_;
+    /** The queued operations, in lanes by priority */
+    priority_lanes<pending> que_;
+    /** The wheel that runs the queued operations, made when needed */
+    timer_wheel_ptr wheel_;
+    /** The timer that's due, or running, to run the queued operations */
+    timer_wheel::timer_id timer_{0};
+    /** Whether the limiter was stopped */
+    bool stopped_{false};
+
+    /** Fills the buckets for the time since they were last filled */
+    void fill(clock::time_point now);
+    /** Decays the measured rates to the time */
+    void decay(clock::time_point now) const;
+    /**
+     * Takes what's needed for a message from the buckets, if possible.
+     * @return Zero if taken, otherwise how long until it could be.
+     */
+    clock::duration take(std::size_t nBytes, clock::time_point now);
+    /** Runs the queued operations that the buckets allow */
+    void run();
+
+public:
+    /**
+     * Creates a rate limiter.
+     * @param msgRate The maximum average number of messages per second.
+     *  			  Zero for no limit.
+     * @param byteRate The maximum average number of bytes per second.
+     *  			   Zero for no limit.
+     * @param policy What to do with a message that would exceed the rate.
+     * @param burstSecs How long the buckets take to fill from empty,
+     *  				which sets how big a burst can go at once after a
+     *  				quiet period. At least one message can always go.
+     * @param wheel The wheel that runs the queued operations. If null,
+     *  			the limiter makes one of its own when it's first needed.
+     */
+    rate_limiter(
+        double msgRate, double byteRate = 0.0, Policy policy = BLOCK, double burstSecs = 1.0,
+        timer_wheel_ptr wheel = timer_wheel_ptr{}
+    );
+    /**
+     * Destroys the limiter, stopping it.
+     */
+    ~rate_limiter();
+
+    rate_limiter(const rate_limiter&) = delete;
+    rate_limiter& operator=(const rate_limiter&) = delete;
+
+    /**
+     * Gets the policy for messages that would exceed the rate.
+     * @return The policy for messages that would exceed the rate.
+     */
+    Policy get_policy() const { return policy_; }
+    /**
+     * Gets the maximum rate of messages.
+     * @return The maximum number of messages per second, or zero for no
+     *  	   limit.
+     */
+    double get_message_rate() const { return msgs_.rate; }
+    /**
+     * Gets the maximum rate of bytes.
+     * @return The maximum number of bytes per second, or zero for no
+     *  	   limit.
+     */
+    double get_byte_rate() const { return bytes_.rate; }
+    /**
+     * Tries to get permission to send a message right away.
+     * @param nBytes The size of the message.
+     * @return @em true if the message can go now, @em false if not.
+     */
+    bool try_acquire(std::size_t nBytes);
+    /**
+     * Waits for permission to send a message.
+     * @param nBytes The size of the message.
+     * @return @em true when the message can go, or @em false if the
+     *  	   limiter was stopped.
+     */
+    bool acquire(std::size_t nBytes);
+    /**
+     * Queues an operation to run when it's allowed.
+     *
+     * The operation runs on the limiter's timer wheel, once its turn comes
+     * and the buckets allow. The queue has a lane for each priority, which are
+     * served by weight, so the operations of a priority run in the order
+     * that they were submitted, but an urgent one doesn't wait behind all
+     * the others. If the limiter is stopped first, the operation is
+     * called with @em false.
+     *
+     * @param nBytes The size of the message.
+     * @param task The operation to run.
+     * @param prio The priority of the message, where zero is the highest.
+     * @return @em true if it was queued, @em false if the limiter was
+     *  	   stopped.
+     */
+    bool submit(std::size_t nBytes, task_type task, int prio = 1);
+    /**
+     * Gets the weights of the priority lanes of the queue.
+     * @return The most operations each lane runs in a turn.
+     */
+    lane_weights get_lane_weights() const;
+    /**
+     * Sets the weights of the priority lanes of the queue, which also
+     * sets the number of lanes.
+     * @param weights The most operations each lane runs in a turn, from
+     *  			  the highest priority to the lowest.
+     */
+    void set_lane_weights(lane_weights weights);
+    /**
+     * Gets the number of operations waiting in the queue.
+     * @return The number of operations waiting in the queue.
+     */
+    std::size_t queue_size() const;
+    /**
+     * Gets the recent rate of messages that the limiter let through.
+     * @return The recent number of messages per second.
+     */
+    double current_message_rate() const;
+    /**
+     * Gets the recent rate of bytes that the limiter let through.
+     * @return The recent number of bytes per second.
+     */
+    double current_byte_rate() const;
+    /**
+     * Determines if the limiter was stopped.
+     * @return @em true if the limiter was stopped, @em false otherwise.
+     */
+    bool stopped() const;
+    /**
+     * Stops the limiter.
+     * Any threads waiting on acquire() are released, and any queued
+     * operations are called with @em false. It is safe to call this more
+     * than once, but not from a queued operation.
+     */
+    void stop();
+};
+
+/** Smart/shared pointer to a rate_limiter */
+using rate_limiter_ptr = rate_limiter::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_rate_limiter_h
@@ -0,0 +1,243 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file receive_filter.h
+/// Declaration of MQTT receive_filter class, which thins out the incoming
+/// messages before they're built.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_receive_filter_h
+#define __mqtt_receive_filter_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MQTTAsync.h"
+#include "mqtt/message.h"
+#include "mqtt/topic.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Drops some of the incoming messages, for consumers that only need a
+ * sample of them.
+ *
+ * The filter is a list of stages, each applied to the topics that match
+ * its topic filter:
+ *
+ * @li A @em sample keeps one in every N of the messages that match.
+ * @li A @em min-interval keeps no more than one message per topic in each
+ *  	interval, dropping the rest.
+ * @li A @em predicate keeps the messages that a function of the topic and
+ *  	QoS accepts.
+ *
+ * The stages run in the order they were added, and a message is dropped
+ * at the first one that rejects it, so the cheap ones should go first.
+ * @par
+ * The filter is normally installed on a client with
+ * `async_client::set_receive_filter()`, which checks the messages as they
+ * come from the C library, before they're made into message objects, and
+ * before they're cached, queued, or dispatched. The messages that are
+ * dropped are still acknowledged to the server.
+ * @par
+ * The stages must be added before the filter is installed. Checking
+ * messages is thread safe.
+ */
+class receive_filter
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<receive_filter>;
+    /** The clock for the intervals */
+    using clock = std::chrono::steady_clock;
+    /** The type for the intervals */
+    using duration = clock::duration;
+    /** A point in time */
+    using time_point = clock::time_point;
+    /**
+     * A function that decides which messages to keep.
+     * This takes the topic and QoS of a message, and returns @em true to
+     * keep it, or @em false to drop it.
+     */
+    using predicate = std::function<bool(std::string_view topic, int qos)>;
+
+    /** The default number of topics to track in a min-interval stage */
+    static constexpr std::size_t DFLT_MAX_TOPICS = 64 * 1024;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** The types of stages */
+    enum class stage_type { SAMPLE, MIN_INTERVAL, PREDICATE };
+
+    /** A stage of the filter */
+    struct stage
+    {
+        /** The type of stage */
+        stage_type type;
+        /** The topics that the stage applies to */
+        topic_filter filt;
+        /** Whether the stage applies to all topics */
+        bool all;
+        /** The number of messages for each one kept, for a sample */
+        uint64_t n{1};
+        /** The number of matching messages seen, for a sample */
+        std::atomic<uint64_t> count{0};
+        /** The interval between messages on a topic */
+        duration ival{};
+        /** The most topics to remember for the interval */
+        std::size_t maxTopics{DFLT_MAX_TOPICS};
+        /** Lock for the times */
+        std::mutex lock;
+        /** The time each topic last had a message kept, by its hash */
+        std::unordered_map<uint64_t, time_point> lastKept;
+        /** The function for a predicate */
+        predicate pred;
+        /** The number of messages the stage dropped */
+        std::atomic<uint64_t> nDropped{0};
+
+        /** Creates a stage for a filter */
+        stage(stage_type typ, const string& filter)
+            : type{typ}, filt{filter}, all{filter == "#"} {}
+
+        /** Determines if the stage keeps a message */
+        bool keep(std::string_view topic, int qos, time_point now);
+    };
+
+    /** The stages, in the order they run */
+    std::vector<std::unique_ptr<stage>> stages_;
+    /** Whether any stage needs the time */
+    bool timed_{false};
+
+    /** The number of messages checked */
+    std::atomic<uint64_t> nChecked_{0};
+    /** The number of messages dropped */
+    std::atomic<uint64_t> nDropped_{0};
+
+public:
+    /**
+     * Creates a filter with no stages, which keeps everything.
+     */
+    receive_filter() = default;
+
+    receive_filter(const receive_filter&) = delete;
+    receive_filter& operator=(const receive_filter&) = delete;
+
+    /**
+     * Adds a stage that keeps one in every @em n messages.
+     * The first matching message is kept, then every n'th one after it,
+     * counting all the topics that match the filter together.
+     * @param filter The topic filter for the messages to sample.
+     * @param n The number of messages for each one that's kept.
+     * @throw std::invalid_argument if @em n is zero.
+     */
+    void add_sample(const string& filter, unsigned n);
+    /**
+     * Adds a stage that keeps no more than one message per topic in an
+     * interval.
+     * Each topic that matches the filter is timed on its own. The topics
+     * are remembered by a hash of their names, and if more than
+     * @em maxTopics are seen within an interval, they are all forgotten,
+     * which lets their next messages through early.
+     * @param filter The topic filter for the messages to limit.
+     * @param ival The least time between the messages kept on a topic.
+     * @param maxTopics The most topics to remember.
+     */
+    void add_min_interval(
+        const string& filter, duration ival, std::size_t maxTopics = DFLT_MAX_TOPICS
+    );
+    /**
+     * Adds a stage that keeps the messages accepted by a function.
+     * @param pred The function, which returns @em true to keep a message.
+     *  		   It's called from the client's callback thread.
+     * @param filter The topic filter for the messages to check.
+     */
+    void add_predicate(predicate pred, const string& filter = "#");
+    /**
+     * Gets the number of stages in the filter.
+     * @return The number of stages.
+     */
+    std::size_t num_stages() const { return stages_.size(); }
+    /**
+     * Checks a message.
+     * @param topic The topic of the message.
+     * @param qos The QoS of the message.
+     * @param now The current time, used by the min-interval stages.
+     * @return @em true if the message should be dropped, @em false if it
+     *  	   should be kept.
+     */
+    bool check(std::string_view topic, int qos, time_point now);
+    /**
+     * Checks a message from the C library.
+     * The clock is only read if there is a min-interval stage.
+     * @param topic The topic of the message.
+     * @param cmsg The C message.
+     * @return @em true if the message should be dropped, @em false if it
+     *  	   should be kept.
+     */
+    bool check(std::string_view topic, const MQTTAsync_message& cmsg) {
+        return check(topic, cmsg.qos, timed_ ? clock::now() : time_point{});
+    }
+    /**
+     * Checks a message.
+     * @param msg The message.
+     * @return @em true if the message should be dropped, @em false if it
+     *  	   should be kept.
+     */
+    bool check(const message& msg) {
+        return check(msg.get_topic(), msg.get_qos(), timed_ ? clock::now() : time_point{});
+    }
+    /**
+     * Gets the number of messages that were checked.
+     * @return The number of messages checked.
+     */
+    uint64_t num_checked() const { return nChecked_.load(std::memory_order_relaxed); }
+    /**
+     * Gets the number of messages that were dropped.
+     * @return The number of messages dropped.
+     */
+    uint64_t num_dropped() const { return nDropped_.load(std::memory_order_relaxed); }
+    /**
+     * Gets the number of messages that were dropped by one stage.
+     * @param i The index of the stage, in the order they were added.
+     * @return The number of messages the stage dropped.
+     * @throw std::out_of_range if there is no such stage.
+     */
+    uint64_t num_dropped(std::size_t i) const {
+        return stages_.at(i)->nDropped.load(std::memory_order_relaxed);
+    }
+};
+
+/** Smart/shared pointer to a receive_filter */
+using receive_filter_ptr = receive_filter::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_receive_filter_h
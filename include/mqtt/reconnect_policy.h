@@ -0,0 +1,229 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file reconnect_policy.h
+/// Declaration of MQTT reconnect_policy class, the backoff and recovery
+/// settings for reconnects that are managed by the client.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_reconnect_policy_h
+#define __mqtt_reconnect_policy_h
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+class endpoint_racer;
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The settings for reconnects that are managed by the async_client, rather
+ * than by the C library.
+ *
+ * When the connection is lost, the client waits, then tries to connect
+ * again, with the same options as the last connect. Each failed attempt
+ * multiplies the wait, up to a maximum, and each wait is shortened by a
+ * random amount, the jitter, so that a fleet of clients that lost a
+ * server at the same moment don't all come back to it at the same moment.
+ * @par
+ * With a list of servers in the connect options, each attempt can start
+ * with the next server in the list, so the load of a failed server is
+ * spread over the others. Or, with an endpoint_racer, each attempt can
+ * start with whichever server answers fastest.
+ * @par
+ * Once connected, the client can restore the subscriptions that were made
+ * through it, in a single batched request. This is skipped when the
+ * server says that it kept the session, since it still has them.
+ */
+class reconnect_policy
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<reconnect_policy>;
+    /** Smart/shared pointer to a const object of this class */
+    using const_ptr_t = std::shared_ptr<const reconnect_policy>;
+
+    /** The default wait before the first attempt */
+    static constexpr std::chrono::milliseconds DFLT_MIN_DELAY{1000};
+    /** The default longest wait between attempts */
+    static constexpr std::chrono::milliseconds DFLT_MAX_DELAY{60000};
+
+private:
+    /** The wait before the first attempt */
+    std::chrono::milliseconds minDelay_{DFLT_MIN_DELAY};
+    /** The longest wait between attempts */
+    std::chrono::milliseconds maxDelay_{DFLT_MAX_DELAY};
+    /** What the wait is multiplied by after each failed attempt */
+    double multiplier_{2.0};
+    /** The most that a wait is shortened at random, as a fraction */
+    double jitter_{0.5};
+    /** The most attempts for a lost connection, or zero for no limit */
+    unsigned maxAttempts_{0};
+    /** Whether to start each attempt with the next server in the list */
+    bool rotateServers_{true};
+    /** Whether to restore the subscriptions after reconnecting */
+    bool resubscribe_{true};
+    /** The racer that orders the servers before each attempt, if any */
+    std::shared_ptr<endpoint_racer> racer_;
+
+public:
+    /**
+     * Creates a policy with the default settings.
+     */
+    reconnect_policy() {}
+    /**
+     * Creates a policy with the range of waits between attempts.
+     * @param minDelay The wait before the first attempt.
+     * @param maxDelay The longest wait between attempts.
+     */
+    template <class Rep1, class Period1, class Rep2, class Period2>
+    reconnect_policy(
+        const std::chrono::duration<Rep1, Period1>& minDelay,
+        const std::chrono::duration<Rep2, Period2>& maxDelay
+    ) {
+        set_delay(minDelay, maxDelay);
+    }
+    /**
+     * Gets the wait before the first attempt.
+     * @return The wait before the first attempt.
+     */
+    std::chrono::milliseconds get_min_delay() const { return minDelay_; }
+    /**
+     * Gets the longest wait between attempts.
+     * @return The longest wait between attempts.
+     */
+    std::chrono::milliseconds get_max_delay() const { return maxDelay_; }
+    /**
+     * Sets the range of waits between attempts.
+     * @param minDelay The wait before the first attempt.
+     * @param maxDelay The longest wait between attempts. This is raised to
+     *  			   the minimum if it's less.
+     */
+    template <class Rep1, class Period1, class Rep2, class Period2>
+    void set_delay(
+        const std::chrono::duration<Rep1, Period1>& minDelay,
+        const std::chrono::duration<Rep2, Period2>& maxDelay
+    ) {
+        minDelay_ = std::max(to_milliseconds(minDelay), std::chrono::milliseconds::zero());
+        maxDelay_ = std::max(to_milliseconds(maxDelay), minDelay_);
+    }
+    /**
+     * Gets what the wait is multiplied by after each failed attempt.
+     * @return The backoff multiplier.
+     */
+    double get_multiplier() const { return multiplier_; }
+    /**
+     * Sets what the wait is multiplied by after each failed attempt.
+     * @param mult The backoff multiplier. Values below one are taken as
+     *  		   one, for a fixed wait.
+     */
+    void set_multiplier(double mult) { multiplier_ = std::max(mult, 1.0); }
+    /**
+     * Gets the most that a wait is shortened at random.
+     * @return The jitter, as a fraction of the wait.
+     */
+    double get_jitter() const { return jitter_; }
+    /**
+     * Sets the most that a wait is shortened at random.
+     * @param jitter The jitter, as a fraction of the wait, from 0.0 for
+     *  			 none, to 1.0, for a wait anywhere from zero up to the
+     *  			 full backoff.
+     */
+    void set_jitter(double jitter) { jitter_ = std::min(std::max(jitter, 0.0), 1.0); }
+    /**
+     * Gets the most attempts to make for a lost connection.
+     * @return The most attempts, or zero for no limit.
+     */
+    unsigned get_max_attempts() const { return maxAttempts_; }
+    /**
+     * Sets the most attempts to make for a lost connection.
+     * @param n The most attempts, or zero to keep trying until the client
+     *  		is disconnected or destroyed.
+     */
+    void set_max_attempts(unsigned n) { maxAttempts_ = n; }
+    /**
+     * Determines if each attempt starts with the next server in the list.
+     * @return @em true if the servers are rotated, @em false if not.
+     */
+    bool get_rotate_servers() const { return rotateServers_; }
+    /**
+     * Sets whether each attempt starts with the next server in the list.
+     * @param on @em true to rotate the servers, @em false to always start
+     *  		 with the first one.
+     */
+    void set_rotate_servers(bool on) { rotateServers_ = on; }
+    /**
+     * Gets the racer that orders the servers before each attempt.
+     * @return The racer, or nullptr if there isn't one.
+     */
+    std::shared_ptr<endpoint_racer> get_endpoint_racer() const { return racer_; }
+    /**
+     * Sets a racer to order the servers before each attempt.
+     * When there's more than one server, the racer picks which one the
+     * attempt starts with, instead of rotating them. It's shared, so that
+     * it keeps what it learns about the servers from one attempt to the
+     * next. This is only used on POSIX systems.
+     * @param racer The racer, or nullptr for none.
+     */
+    void set_endpoint_racer(std::shared_ptr<endpoint_racer> racer) {
+        racer_ = std::move(racer);
+    }
+    /**
+     * Determines if the subscriptions are restored after reconnecting.
+     * @return @em true if the subscriptions are restored, @em false if not.
+     */
+    bool get_resubscribe() const { return resubscribe_; }
+    /**
+     * Sets whether the subscriptions are restored after reconnecting.
+     * @param on @em true to restore the subscriptions, @em false to leave
+     *  		 it to the app.
+     */
+    void set_resubscribe(bool on) { resubscribe_ = on; }
+    /**
+     * Gets the wait before an attempt.
+     * @param attempt The number of attempts already made for this lost
+     *  			  connection.
+     * @param rnd A random number from 0.0 up to, but not including, 1.0,
+     *  		  for the jitter.
+     * @return The time to wait before the attempt.
+     */
+    std::chrono::milliseconds get_delay(unsigned attempt, double rnd) const {
+        double ms = double(minDelay_.count()) * std::pow(multiplier_, double(attempt));
+        ms = std::min(ms, double(maxDelay_.count()));
+        ms *= 1.0 - jitter_ * std::min(std::max(rnd, 0.0), 1.0);
+        return std::chrono::milliseconds(std::llround(ms));
+    }
+};
+
+/** Smart/shared pointer to a reconnect_policy */
+using reconnect_policy_ptr = reconnect_policy::ptr_t;
+
+/** Smart/shared pointer to a const reconnect_policy */
+using const_reconnect_policy_ptr = reconnect_policy::const_ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_reconnect_policy_h
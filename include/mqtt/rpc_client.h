@@ -0,0 +1,260 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file rpc_client.h
+/// Declaration of MQTT rpc_client class, which makes MQTT v5 remote
+/// procedure calls.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_rpc_client_h
+#define __mqtt_rpc_client_h
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "mqtt/async_client.h"
+#include "mqtt/buffer_ref.h"
+#include "mqtt/message.h"
+#include "mqtt/properties.h"
+#include "mqtt/timer_wheel.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Makes MQTT v5 remote procedure calls over an async_client.
+ *
+ * Each call publishes a request with a @em RESPONSE_TOPIC property naming
+ * this client's response topic, and a @em CORRELATION_DATA property with
+ * an ID that's unique to the call. The server is expected to publish its
+ * reply to the response topic with the same correlation data.
+ * @par
+ * All the replies arrive through a single subscription to the response
+ * topic, and are matched to their calls with a hash map of the ones that
+ * are outstanding, so any number of calls can be in flight at once, from
+ * any number of threads, over the one connection. Each call has a
+ * timeout, after which it fails with a @ref timeout_error, and a late
+ * reply is dropped.
+ * @par
+ * The timeouts are timers on the client's @ref timer_wheel, so any number
+ * of outstanding calls cost a timer each, set and cancelled in constant
+ * time. The handler for a call is run on the client's callback thread
+ * when the reply arrives, or on the wheel's thread when it times out, so
+ * it should be quick. The future returned by the other form of call() is simply set
+ * from there.
+ * @par
+ * The client must not be destroyed from within one of the handlers.
+ */
+class rpc_client
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<rpc_client>;
+    /** The clock used for the timeouts */
+    using clock = std::chrono::steady_clock;
+    /** The type of duration used for the timeouts */
+    using duration = clock::duration;
+    /**
+     * The handler for the result of a call.
+     * This gets the reply on success, or a null message and the error on
+     * failure.
+     */
+    using response_handler = std::function<void(const_message_ptr rsp, std::exception_ptr err)>;
+
+    /** The default QoS for the requests and the response subscription */
+    static constexpr int DFLT_QOS = 1;
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** General purpose guard */
+    using unique_guard = std::unique_lock<std::mutex>;
+
+    /** An outstanding call */
+    struct pending
+    {
+        /** The handler for the result */
+        response_handler handler;
+        /** The timer for the timeout */
+        timer_wheel::timer_id timer;
+    };
+
+    /**
+     * The link from the subscription back to this object, which is cut
+     * when it's destroyed, since the async_client may still be calling
+     * the subscription's handler.
+     */
+    struct link
+    {
+        /** Held while a reply is being handled */
+        std::mutex lock;
+        /** The RPC client, or null once it's gone */
+        rpc_client* cli;
+    };
+
+    /** The client that carries the calls */
+    async_client& cli_;
+    /** The topic for the replies */
+    string rspTopic_;
+    /** The QoS for the requests and the response subscription */
+    int qos_;
+
+    /** The wheel for the timeouts */
+    timer_wheel_ptr wheel_;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** The outstanding calls, by correlation ID */
+    std::unordered_map<uint64_t, pending> pending_;
+    /** The next correlation ID */
+    uint64_t nextId_{1};
+    /** The number of calls that timed out */
+    size_t nTimeouts_{0};
+    /** The number of replies that didn't match an outstanding call */
+    size_t nUnmatched_{0};
+    /** Whether the client was stopped */
+    bool stopped_{false};
+    /** The link from the subscription */
+    std::shared_ptr<link> link_;
+
+    /** Fails a call that timed out */
+    void on_timeout(uint64_t id);
+    /** Handles a message on the response topic */
+    void on_response(const_message_ptr msg);
+    /** Encodes a correlation ID */
+    static binary encode_id(uint64_t id);
+    /** Decodes a correlation ID, returning zero if it isn't one. */
+    static uint64_t decode_id(const binary& data);
+
+    rpc_client(const rpc_client&) = delete;
+    rpc_client& operator=(const rpc_client&) = delete;
+
+public:
+    /**
+     * Creates an RPC client.
+     * @param cli The client that carries the calls. It must outlive this
+     *  		  object.
+     * @param rspTopic The topic for the replies. If empty, the topic
+     *  			   `replies/<clientId>/rpc` is used, which needs the
+     *  			   client to have a client ID.
+     * @param qos The QoS for the requests and the response subscription.
+     * @throw std::invalid_argument if no topic was given, and the client
+     *  	  doesn't have a client ID.
+     */
+    explicit rpc_client(
+        async_client& cli, const string& rspTopic = string{}, int qos = DFLT_QOS
+    );
+    /**
+     * Destroys the client, stopping it.
+     */
+    ~rpc_client();
+    /**
+     * Gets the topic for the replies.
+     * @return The topic for the replies.
+     */
+    const string& get_response_topic() const { return rspTopic_; }
+    /**
+     * Gets the QoS for the requests and the response subscription.
+     * @return The QoS for the requests and the response subscription.
+     */
+    int get_qos() const { return qos_; }
+    /**
+     * Subscribes to the response topic.
+     * This should be done once the client is connected, and before any
+     * calls are made. With a clean session, it must be done again on each
+     * connection.
+     * @return A token to track the subscription.
+     */
+    token_ptr start();
+    /**
+     * Stops the client.
+     * This unsubscribes from the response topic, stops the timer, and fails
+     * any outstanding calls. It's safe to call this more than once.
+     */
+    void stop();
+    /**
+     * Makes a call, with a handler for the result.
+     * @param topic The topic for the request.
+     * @param payload The payload of the request.
+     * @param timeout How long to wait for the reply.
+     * @param handler The handler for the result of the call.
+     * @param props Any other properties for the request.
+     * @throw exception if the request could not be published, in which case
+     *  	  the handler is not called.
+     */
+    void call(
+        const string& topic, binary_ref payload, duration timeout, response_handler handler,
+        const properties& props = properties()
+    );
+    /**
+     * Makes a call, with a future for the result.
+     * @param topic The topic for the request.
+     * @param payload The payload of the request.
+     * @param timeout How long to wait for the reply.
+     * @param props Any other properties for the request.
+     * @return A future for the reply, which holds a @ref timeout_error if
+     *  	   the call times out.
+     * @throw exception if the request could not be published.
+     */
+    std::future<const_message_ptr> call(
+        const string& topic, binary_ref payload, duration timeout,
+        const properties& props = properties()
+    );
+    /**
+     * Gets the number of outstanding calls.
+     * @return The number of outstanding calls.
+     */
+    size_t num_pending() const {
+        guard g{lock_};
+        return pending_.size();
+    }
+    /**
+     * Gets the number of calls that timed out.
+     * @return The number of calls that timed out.
+     */
+    size_t num_timeouts() const {
+        guard g{lock_};
+        return nTimeouts_;
+    }
+    /**
+     * Gets the number of replies that didn't match an outstanding call,
+     * such as ones that arrived after their call timed out.
+     * @return The number of replies that didn't match a call.
+     */
+    size_t num_unmatched() const {
+        guard g{lock_};
+        return nUnmatched_;
+    }
+};
+
+/** Smart/shared pointer to an rpc_client */
+using rpc_client_ptr = rpc_client::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_rpc_client_h
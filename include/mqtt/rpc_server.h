@@ -0,0 +1,179 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file rpc_server.h
+/// Declaration of MQTT rpc_server class, which serves MQTT v5 remote
+/// procedure calls.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_rpc_server_h
+#define __mqtt_rpc_server_h
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "mqtt/async_client.h"
+#include "mqtt/dispatcher.h"
+#include "mqtt/message.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Serves MQTT v5 remote procedure calls over an async_client.
+ *
+ * The server subscribes to a filter for the requests, and runs the handler
+ * for each one on a pool of worker threads, a @ref work_stealing_dispatcher,
+ * so that slow calls don't hold up the client's callback thread, or each
+ * other. The value returned by the handler is published as the reply to
+ * the request's @em RESPONSE_TOPIC, with its @em CORRELATION_DATA, at the
+ * QoS of the request.
+ * @par
+ * A request without a response topic is handled, but not answered. If the
+ * handler throws an exception, no reply is sent, and the caller times out.
+ * @par
+ * The requests are handled in no particular order. To spread them across
+ * several server processes, use a shared subscription, like
+ * `$share/group/requests/#`, as the filter.
+ * @par
+ * The server must not be destroyed from within the handler.
+ */
+class rpc_server
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<rpc_server>;
+    /**
+     * The handler for a request.
+     * This returns the payload for the reply.
+     */
+    using request_handler = std::function<binary(const_message_ptr req)>;
+
+    /** The default QoS for the request subscription */
+    static constexpr int DFLT_QOS = 1;
+
+private:
+    /**
+     * The link from the subscription back to this object, which is cut
+     * when it's destroyed, since the async_client may still be calling
+     * the subscription's handler.
+     */
+    struct link
+    {
+        /** Held while a request is being queued */
+        std::mutex lock;
+        /** The RPC server, or null once it's gone */
+        rpc_server* srvr;
+    };
+
+    /** The client that carries the calls */
+    async_client& cli_;
+    /** The filter for the requests */
+    string reqFilter_;
+    /** The QoS for the request subscription */
+    int qos_;
+    /** The handler for the requests */
+    request_handler handler_;
+    /** The number of requests that were answered */
+    std::atomic<size_t> nReplies_{0};
+    /** The number of requests that failed */
+    std::atomic<size_t> nErrors_{0};
+    /** The worker threads that run the handler */
+    work_stealing_dispatcher disp_;
+    /** The link from the subscription */
+    std::shared_ptr<link> link_;
+
+    /** Handles a request on a worker thread */
+    void handle(const_message_ptr req);
+
+    rpc_server(const rpc_server&) = delete;
+    rpc_server& operator=(const rpc_server&) = delete;
+
+public:
+    /**
+     * Creates an RPC server.
+     * @param cli The client that carries the calls. It must outlive this
+     *  		  object.
+     * @param reqFilter The topic filter for the requests.
+     * @param handler The handler for the requests.
+     * @param nWorkers The number of worker threads to run the handler. If
+     *  			   zero, a thread is used for each hardware core.
+     * @param qos The QoS for the request subscription.
+     */
+    rpc_server(
+        async_client& cli, const string& reqFilter, request_handler handler,
+        std::size_t nWorkers = 0, int qos = DFLT_QOS
+    );
+    /**
+     * Destroys the server, stopping it.
+     */
+    ~rpc_server();
+    /**
+     * Gets the topic filter for the requests.
+     * @return The topic filter for the requests.
+     */
+    const string& get_request_filter() const { return reqFilter_; }
+    /**
+     * Gets the number of worker threads.
+     * @return The number of worker threads.
+     */
+    std::size_t num_workers() const { return disp_.num_threads(); }
+    /**
+     * Gets the number of requests that are waiting for a worker.
+     * @return The number of requests that are waiting for a worker.
+     */
+    std::size_t num_pending() const { return disp_.size(); }
+    /**
+     * Gets the number of requests that were answered.
+     * @return The number of requests that were answered.
+     */
+    std::size_t num_replies() const { return nReplies_; }
+    /**
+     * Gets the number of requests that failed, because the handler threw
+     * an exception, or the reply could not be published.
+     * @return The number of requests that failed.
+     */
+    std::size_t num_errors() const { return nErrors_; }
+    /**
+     * Subscribes to the requests.
+     * This should be done once the client is connected. With a clean
+     * session, it must be done again on each connection.
+     * @return A token to track the subscription.
+     */
+    token_ptr start();
+    /**
+     * Stops the server.
+     * This unsubscribes from the requests, then waits for the workers to
+     * finish the ones that were already queued. It's safe to call this
+     * more than once.
+     */
+    void stop();
+};
+
+/** Smart/shared pointer to an rpc_server */
+using rpc_server_ptr = rpc_server::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_rpc_server_h
@@ -0,0 +1,179 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file serializer.h
+/// Declaration of the MQTT serializer customization point, which converts
+/// typed values to and from message payloads.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_serializer_h
+#define __mqtt_serializer_h
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "mqtt/buffer_ref.h"
+#include "mqtt/buffer_view.h"
+#include "mqtt/exception.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The customization point to convert values of a type to and from message
+ * payloads.
+ *
+ * The primary template is not defined. To make a type serializable,
+ * specialize it with two static functions:
+ *
+ * @code
+ * template <>
+ * struct mqtt::serializer<my_type> {
+ *     // Appends the encoded value to the buffer
+ *     static void encode(const my_type& val, mqtt::binary& buf);
+ *     // Decodes a value from the payload
+ *     static my_type decode(mqtt::binary_view data);
+ * };
+ * @endcode
+ *
+ * The encoder appends straight into the buffer that becomes the payload
+ * of the message, so a format with a streaming writer, like protobuf or
+ * msgpack, needs no intermediate copy.
+ * @par
+ * The decoder can return any type, not just @em T. A zero-copy format,
+ * like flatbuffers, can return a view or a pointer into the payload data,
+ * which stays valid as long as the message does.
+ * @par
+ * Specializations are supplied for @em string and @em binary (copies),
+ * @em std::string_view and @ref binary_view (views into the payload), and
+ * the arithmetic types, which are sent in the host's byte order.
+ *
+ * @tparam T The type of value.
+ * @tparam Enable For SFINAE in partial specializations.
+ */
+template <typename T, typename Enable = void>
+struct serializer;
+
+/** Serializer for strings, which are also used for binary data */
+template <>
+struct serializer<string>
+{
+    static void encode(const string& val, binary& buf) { buf.append(val); }
+    static string decode(binary_view data) { return data.str(); }
+};
+
+/** Serializer for string views, which decode in place */
+template <>
+struct serializer<std::string_view>
+{
+    static void encode(std::string_view val, binary& buf) {
+        buf.append(val.data(), val.size());
+    }
+    static std::string_view decode(binary_view data) { return {data.data(), data.size()}; }
+};
+
+/** Serializer for binary views, which decode in place */
+template <>
+struct serializer<binary_view>
+{
+    static void encode(const binary_view& val, binary& buf) {
+        buf.append(val.data(), val.size());
+    }
+    static binary_view decode(binary_view data) { return data; }
+};
+
+/** Serializer for the arithmetic types, in the host's byte order */
+template <typename T>
+struct serializer<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+{
+    static void encode(T val, binary& buf) {
+        buf.append(reinterpret_cast<const char*>(&val), sizeof(T));
+    }
+    static T decode(binary_view data) {
+        if (data.size() != sizeof(T))
+            throw exception(MQTTASYNC_FAILURE, "Payload is the wrong size for the type");
+        T val;
+        std::memcpy(&val, data.data(), sizeof(T));
+        return val;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Determines if there is a @ref serializer for a type.
+ */
+template <typename T, typename = void>
+struct is_serializable : std::false_type
+{
+};
+
+template <typename T>
+struct is_serializable<
+    T, std::void_t<decltype(serializer<T>::encode(
+           std::declval<const T&>(), std::declval<binary&>()
+       ))>> : std::true_type
+{
+};
+
+/** Whether there is a @ref serializer for a type */
+template <typename T>
+inline constexpr bool is_serializable_v = is_serializable<T>::value;
+
+/**
+ * Encodes a value into a payload.
+ *
+ * The value is encoded straight into the buffer that becomes the payload,
+ * so there's no copy. A per-thread hint of the size of the last payload
+ * reserves the space up front, so that a stream of similar messages
+ * doesn't regrow the buffer in steps.
+ *
+ * @param val The value to encode.
+ * @return The payload.
+ */
+template <typename T>
+binary_ref to_payload(const T& val) {
+    thread_local std::size_t sizeHint = 0;
+
+    binary buf;
+    buf.reserve(sizeHint);
+    serializer<T>::encode(val, buf);
+    sizeHint = buf.size();
+    return binary_ref{std::move(buf)};
+}
+
+/**
+ * Decodes a value from payload data.
+ * @param data The payload data.
+ * @return Whatever the serializer for the type decodes, which might be a
+ *  	   view into the data.
+ */
+template <typename T>
+auto from_payload(binary_view data) -> decltype(serializer<T>::decode(data)) {
+    return serializer<T>::decode(data);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_serializer_h
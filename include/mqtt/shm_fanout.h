@@ -0,0 +1,315 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file shm_fanout.h
+/// Declaration of MQTT shm_fanout_writer and shm_fanout_reader classes,
+/// which fan out the messages of one client to many local processes
+/// through a ring in shared memory.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_shm_fanout_h
+#define __mqtt_shm_fanout_h
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+#include "mqtt/compiled_topic_matcher.h"
+#include "mqtt/message.h"
+#include "mqtt/message_tracer.h"
+#include "mqtt/topic_matcher.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Writes the messages that arrive at a client into a ring in shared
+ * memory, where any number of local processes can read them with a
+ * @ref shm_fanout_reader.
+ *
+ * This lets one connection and one subscription to the broker feed many
+ * processes on the same host, without each of them holding its own
+ * session, and without the broker sending each message once for each
+ * of them.
+ * @par
+ * The ring is a POSIX shared memory object, which holds a small header
+ * and the records, each of which is the topic, properties and payload
+ * of a message. It's a one-way broadcast: the writer never waits for
+ * the readers, and overwrites the oldest records when the ring fills.
+ * A reader that falls behind by more than the size of the ring loses
+ * the messages that were overwritten, and counts them.
+ * @par
+ * A writer is a @ref message_tracer, so it can be installed on a client
+ * to fan out everything that arrives:
+ * @code
+ * mqtt::shm_fanout_writer fan{"/mqtt-feed"};
+ * cli.set_message_tracer(fan);
+ * @endcode
+ * It can also write messages directly, with write(), from any number of
+ * threads. The ring is removed when the writer is destroyed, although
+ * readers that have it open can keep reading what's in it. This is only
+ * available on POSIX systems.
+ */
+class shm_fanout_writer : public message_tracer
+{
+public:
+    /** The default size of the ring, in bytes */
+    static constexpr size_t DFLT_CAPACITY = 16 * 1024 * 1024;
+
+private:
+    /** The mapped ring */
+    struct ring;
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** Lock for writing to the ring */
+    mutable std::mutex lock_;
+    /** The name of the shared memory object */
+    string name_;
+    /** The mapped ring */
+    std::unique_ptr<ring> ring_;
+    /** The number of messages that were too big for the ring */
+    uint64_t nDropped_{0};
+
+public:
+    /**
+     * Creates the ring in shared memory.
+     * An existing ring with the same name is replaced.
+     * @param name The name of the shared memory object, which should be
+     *  		   like "/name".
+     * @param capacity The size of the ring for the records, in bytes.
+     *  			   This is rounded up to a whole number of pages.
+     * @throw exception if the ring can't be created.
+     */
+    explicit shm_fanout_writer(const string& name, size_t capacity = DFLT_CAPACITY);
+    /**
+     * Unmaps the ring, and removes its name.
+     */
+    ~shm_fanout_writer() override;
+
+    shm_fanout_writer(const shm_fanout_writer&) = delete;
+    shm_fanout_writer& operator=(const shm_fanout_writer&) = delete;
+
+    /**
+     * Writes a message to the ring.
+     * @param msg The message.
+     * @return @em true if the message was written, @em false if it's too
+     *  	   big to fit in the ring.
+     */
+    bool write(const message& msg);
+    /**
+     * Writes a message that arrived at a client to the ring.
+     * @param msg The message.
+     */
+    void message_arrived(const message& msg, const string&, time_point) override {
+        write(msg);
+    }
+    /**
+     * Gets the name of the shared memory object.
+     * @return The name of the shared memory object.
+     */
+    const string& name() const { return name_; }
+    /**
+     * Gets the size of the ring for the records.
+     * @return The size of the ring, in bytes.
+     */
+    size_t capacity() const;
+    /**
+     * Gets the number of messages written to the ring.
+     * @return The number of messages written.
+     */
+    uint64_t num_written() const;
+    /**
+     * Gets the number of messages that were too big to fit in the ring.
+     * @return The number of messages that were dropped.
+     */
+    uint64_t num_dropped() const {
+        guard g{lock_};
+        return nDropped_;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Reads the messages that a @ref shm_fanout_writer puts in a ring in
+ * shared memory, in the same or another process.
+ *
+ * A reader starts at the end of the ring, and gets the messages that are
+ * written after it was opened. It can add topic filters, to only get the
+ * messages that match them. The filters are compiled into a single trie,
+ * and each topic is matched in place in the ring, without being copied.
+ * @par
+ * The messages that poll() hands to its handler are views into the ring:
+ * their topics and payloads are not copied, and only the properties, if
+ * any, are decoded. A view is only good until the writer wraps around
+ * and overwrites it, so a handler should process a message right away,
+ * or copy or republish it if it has to be kept. Before a record is
+ * handed over, it's checked that the writer hasn't reached it, so a
+ * reader that falls behind skips ahead and counts the messages it lost,
+ * rather than reading torn data.
+ * @par
+ * A reader isn't thread-safe. Each thread that reads the ring should have
+ * its own.
+ */
+class shm_fanout_reader
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<shm_fanout_reader>;
+    /** A handler for the messages that are read */
+    using handler = std::function<void(const_message_ptr)>;
+
+    /** Read all the messages that are available */
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+private:
+    /** A read-only mapping of the ring */
+    struct mapping;
+
+    /** The mapped ring */
+    std::shared_ptr<mapping> map_;
+    /** The position of the next record to read */
+    uint64_t pos_{0};
+    /** The index of the next message, to count the lost ones */
+    uint64_t nextIdx_{0};
+    /** The filters that were added */
+    topic_matcher<bool> filters_;
+    /** The filters, compiled for matching */
+    compiled_topic_matcher<bool> compiled_;
+    /** The number of messages handed to the handler */
+    uint64_t nRead_{0};
+    /** The number of messages that didn't match the filters */
+    uint64_t nFiltered_{0};
+    /** The number of messages that were overwritten before being read */
+    uint64_t nLost_{0};
+
+    /** Moves ahead to the end of the ring, after falling behind */
+    void skip_to(uint64_t pos);
+    /** Whether the record at the position is still intact */
+    bool intact(uint64_t pos) const;
+
+public:
+    /**
+     * Opens a ring that was created by a writer.
+     * @param name The name of the shared memory object.
+     * @throw exception if the ring doesn't exist or isn't valid.
+     */
+    explicit shm_fanout_reader(const string& name);
+
+    shm_fanout_reader(const shm_fanout_reader&) = delete;
+    shm_fanout_reader& operator=(const shm_fanout_reader&) = delete;
+
+    /**
+     * Adds a topic filter.
+     * Once there are any filters, only the messages that match one of
+     * them are read.
+     * @param filter The topic filter.
+     */
+    void add_filter(const string& filter);
+    /**
+     * Reads the messages that are available, without waiting.
+     * @param cb The handler for the messages. The messages are views into
+     *  		 the ring, which are only good while the handler runs.
+     * @param maxN The most messages to read.
+     * @return The number of messages handed to the handler.
+     */
+    size_t poll(const handler& cb, size_t maxN = npos);
+    /**
+     * Reads the messages that are available, waiting for some to arrive
+     * if there are none.
+     * This polls the ring with a short sleep that backs off, up to a
+     * millisecond, while it's waiting.
+     * @param cb The handler for the messages.
+     * @param relTime The most time to wait for a message.
+     * @param maxN The most messages to read.
+     * @return The number of messages handed to the handler, which is zero
+     *  	   if none arrived in time.
+     */
+    template <typename Rep, class Period>
+    size_t poll_for(
+        const handler& cb, const std::chrono::duration<Rep, Period>& relTime, size_t maxN = npos
+    ) {
+        return poll_until(cb, std::chrono::steady_clock::now() + relTime, maxN);
+    }
+    /**
+     * Reads the messages that are available, waiting for some to arrive
+     * until a time if there are none.
+     * @param cb The handler for the messages.
+     * @param absTime The time to stop waiting for a message.
+     * @param maxN The most messages to read.
+     * @return The number of messages handed to the handler, which is zero
+     *  	   if none arrived in time.
+     */
+    size_t poll_until(
+        const handler& cb, std::chrono::steady_clock::time_point absTime, size_t maxN = npos
+    );
+    /**
+     * Reads one message, waiting for it to arrive if there's none.
+     * Unlike the views from poll(), this is a copy, which can be kept.
+     * @param relTime The most time to wait for a message.
+     * @return The message, or a null pointer if none arrived in time.
+     */
+    template <typename Rep, class Period>
+    const_message_ptr try_consume_for(const std::chrono::duration<Rep, Period>& relTime) {
+        const_message_ptr msg;
+        poll_for(
+            [&msg](const_message_ptr m) {
+                auto cpy = message::create(
+                    string(m->get_topic()), m->get_payload(), m->get_qos(), m->is_retained(),
+                    m->get_properties()
+                );
+                cpy->set_duplicate(m->is_duplicate());
+                msg = std::move(cpy);
+            },
+            relTime, 1
+        );
+        return msg;
+    }
+    /**
+     * Gets the number of bytes in the ring that haven't been read yet.
+     * @return The number of bytes behind the writer.
+     */
+    uint64_t lag() const;
+    /**
+     * Gets the number of messages handed to the handler.
+     * @return The number of messages read.
+     */
+    uint64_t num_read() const { return nRead_; }
+    /**
+     * Gets the number of messages that didn't match the filters.
+     * @return The number of messages filtered out.
+     */
+    uint64_t num_filtered() const { return nFiltered_; }
+    /**
+     * Gets the number of messages that were overwritten by the writer
+     * before they were read.
+     * @return The number of messages lost.
+     */
+    uint64_t num_lost() const { return nLost_; }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_shm_fanout_h
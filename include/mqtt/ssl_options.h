@@ -42,6 +42,12 @@ namespace mqtt {
 
 /**
  * Holds the set of SSL options for connection.
+ *
+ * These are only the settings for a connection. The Paho C library makes
+ * and owns the OpenSSL context and session for each connection, and has
+ * no way to pass in either one, so TLS session resumption on a reconnect,
+ * and an SSL context shared by many clients, aren't available through
+ * these options.
  */
 class ssl_options
 {
@@ -0,0 +1,353 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file static_topic_filter.h
+/// Declaration of MQTT static_topic_filter and static_topic_matcher
+/// classes, for topic filters that are known at compile time.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_static_topic_filter_h
+#define __mqtt_static_topic_filter_h
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A topic filter that can be checked and matched at compile time.
+ *
+ * This is a light version of @ref topic_filter for filters that are string
+ * literals, like "plant/+/line/+/temp". It only holds a view of the
+ * string, and matches a topic in a single pass over both strings, without
+ * splitting either one, so it never allocates. All of it is @em constexpr,
+ * so a filter declared as a constant is validated by the compiler:
+ * @code
+ * constexpr mqtt::static_topic_filter TEMP{"plant/+/line/+/temp"};
+ * static_assert(TEMP.matches("plant/a/line/2/temp"));
+ * @endcode
+ * A bad filter, like "plant/#/temp", fails to compile when it's a
+ * constant, and throws @em std::invalid_argument otherwise.
+ * @par
+ * The matching rules are the same as for @ref topic_filter. The string
+ * must outlive the filter.
+ */
+class static_topic_filter
+{
+    /** The filter string */
+    std::string_view filter_;
+    /** Whether the filter has any wildcards */
+    bool hasWildcards_{false};
+
+    /**
+     * Checks that the wildcards in a filter are each a whole level, and
+     * that a '#' is only in the last one.
+     * @return @em true if the filter has any wildcards.
+     * @throw std::invalid_argument if the filter is not valid.
+     */
+    static constexpr bool check(std::string_view filter) {
+        if (filter.empty())
+            throw std::invalid_argument("empty topic filter");
+
+        bool wild = false;
+        std::size_t n = filter.size();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            char c = filter[i];
+            if (c != '+' && c != '#')
+                continue;
+
+            if ((i > 0 && filter[i - 1] != '/') || (i + 1 < n && filter[i + 1] != '/'))
+                throw std::invalid_argument("wildcard not a whole level in topic filter");
+
+            if (c == '#' && i + 1 != n)
+                throw std::invalid_argument("'#' not the last level in topic filter");
+
+            wild = true;
+        }
+        return wild;
+    }
+    /** Gets the end of the level that starts at 'pos' */
+    static constexpr std::size_t level_end(std::string_view s, std::size_t pos) {
+        auto end = s.find('/', pos);
+        return (end == std::string_view::npos) ? s.size() : end;
+    }
+
+public:
+    /**
+     * Creates an empty filter, which matches nothing.
+     */
+    constexpr static_topic_filter() noexcept {}
+    /**
+     * Creates a filter.
+     * @param filter The filter string. This is kept by reference, and must
+     *  			 outlive the filter.
+     * @throw std::invalid_argument if the filter is not valid. At compile
+     *  	  time, this is an error.
+     */
+    constexpr explicit static_topic_filter(std::string_view filter)
+        : filter_{filter}, hasWildcards_{check(filter)} {}
+    /**
+     * Gets the filter string.
+     * @return A view of the filter string.
+     */
+    constexpr std::string_view view() const noexcept { return filter_; }
+    /**
+     * Gets a copy of the filter string.
+     * @return The filter string.
+     */
+    string to_string() const { return string{filter_}; }
+    /**
+     * Determines if the filter is empty.
+     * @return @em true if the filter is empty.
+     */
+    constexpr bool empty() const noexcept { return filter_.empty(); }
+    /**
+     * Determines if the filter has any wildcards.
+     * @return @em true if the filter has any wildcards.
+     */
+    constexpr bool has_wildcards() const noexcept { return hasWildcards_; }
+    /**
+     * Gets the number of levels in the filter.
+     * @return The number of levels in the filter.
+     */
+    constexpr std::size_t num_levels() const noexcept {
+        if (filter_.empty())
+            return 0;
+
+        std::size_t n = 1;
+        for (auto c : filter_) {
+            if (c == '/')
+                ++n;
+        }
+        return n;
+    }
+    /**
+     * Determines if the topic matches this filter.
+     *
+     * A filter without wildcards is matched with a string comparison.
+     * Otherwise the levels of the filter and the topic are compared as
+     * they're found.
+     *
+     * @param topic An MQTT topic. It should not contain wildcards.
+     * @return @em true if the topic matches this filter.
+     */
+    constexpr bool matches(std::string_view topic) const noexcept {
+        if (!hasWildcards_)
+            return !filter_.empty() && topic == filter_;
+
+        // An empty topic has no levels, and topics starting with '$' don't
+        // match wildcards in the first level.
+        if (topic.empty() || (topic[0] == '$' && (filter_[0] == '+' || filter_[0] == '#')))
+            return false;
+
+        std::size_t i = 0, j = 0;
+
+        while (true) {
+            auto fend = level_end(filter_, i), tend = level_end(topic, j);
+            auto fld = filter_.substr(i, fend - i);
+
+            if (fld == "#")
+                return true;
+
+            if (fld != "+" && fld != topic.substr(j, tend - j))
+                return false;
+
+            // The last level of either one has to be the last of both
+            if (fend == filter_.size() || tend == topic.size())
+                return fend == filter_.size() && tend == topic.size();
+
+            i = fend + 1;
+            j = tend + 1;
+        }
+    }
+    /**
+     * Compares the filter strings.
+     */
+    friend constexpr bool operator==(
+        const static_topic_filter& lhs, const static_topic_filter& rhs
+    ) noexcept {
+        return lhs.filter_ == rhs.filter_;
+    }
+    /**
+     * Compares the filter strings.
+     */
+    friend constexpr bool operator!=(
+        const static_topic_filter& lhs, const static_topic_filter& rhs
+    ) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A fixed set of topic filters, each with a value, that's built at compile
+ * time.
+ *
+ * This is the compile-time counterpart of @ref topic_matcher, for routing
+ * tables that are fixed in the code. The filters are checked by the
+ * compiler, and matching a topic just runs through them in order, with
+ * no allocation and no indirection. For the handful of routes that an
+ * app typically has, this beats walking a trie.
+ * @code
+ * constexpr auto ROUTES = mqtt::make_static_topic_matcher<int>({
+ *     {"plant/+/line/+/temp", 1},
+ *     {"plant/+/alarm/#", 2},
+ * });
+ * static_assert(*ROUTES.find_first("plant/a/alarm/fire") == 2);
+ * @endcode
+ * @tparam T The type of the values.
+ * @tparam N The number of filters.
+ */
+template <typename T, std::size_t N>
+class static_topic_matcher
+{
+public:
+    /** The type of the values */
+    using mapped_type = T;
+    /** A filter and its value */
+    using value_type = std::pair<static_topic_filter, T>;
+    /** Iterator over the entries */
+    using const_iterator = const value_type*;
+
+private:
+    /** The entries, in order */
+    std::array<value_type, N> entries_;
+
+    template <std::size_t... I>
+    constexpr static_topic_matcher(
+        const std::pair<std::string_view, T> (&entries)[N], std::index_sequence<I...>
+    )
+        : entries_{{value_type{static_topic_filter{entries[I].first}, entries[I].second}...}} {}
+
+public:
+    /**
+     * Creates a matcher from a list of filters and their values.
+     * @param entries The filters and their values.
+     * @throw std::invalid_argument if a filter is not valid. At compile
+     *  	  time, this is an error.
+     */
+    constexpr explicit static_topic_matcher(const std::pair<std::string_view, T> (&entries)[N])
+        : static_topic_matcher(entries, std::make_index_sequence<N>{}) {}
+    /**
+     * Gets the number of filters.
+     * @return The number of filters.
+     */
+    constexpr std::size_t size() const noexcept { return N; }
+    /**
+     * Gets an iterator to the first entry.
+     */
+    constexpr const_iterator begin() const noexcept { return entries_.data(); }
+    /**
+     * Gets an iterator past the last entry.
+     */
+    constexpr const_iterator end() const noexcept { return entries_.data() + N; }
+    /**
+     * Gets the value for a filter.
+     * @param filter The filter string.
+     * @return A pointer to the value, or null if the filter isn't in the
+     *  	   set.
+     */
+    constexpr const T* find(std::string_view filter) const noexcept {
+        for (const auto& e : entries_) {
+            if (e.first.view() == filter)
+                return &e.second;
+        }
+        return nullptr;
+    }
+    /**
+     * Gets the value of the first filter, in order, that matches a topic.
+     * @param topic The topic.
+     * @return A pointer to the value, or null if no filter matches.
+     */
+    constexpr const T* find_first(std::string_view topic) const noexcept {
+        for (const auto& e : entries_) {
+            if (e.first.matches(topic))
+                return &e.second;
+        }
+        return nullptr;
+    }
+    /**
+     * Determines if any filter matches a topic.
+     * @param topic The topic.
+     * @return @em true if any filter matches the topic.
+     */
+    constexpr bool has_match(std::string_view topic) const noexcept {
+        return find_first(topic) != nullptr;
+    }
+    /**
+     * Calls a function for each entry with a filter that matches a topic,
+     * in order.
+     * @param topic The topic.
+     * @param fn The function, called with each matching entry.
+     * @return The number of matching filters.
+     */
+    template <typename Func>
+    std::size_t for_each_match(std::string_view topic, Func fn) const {
+        std::size_t n = 0;
+        for (const auto& e : entries_) {
+            if (e.first.matches(topic)) {
+                fn(e);
+                ++n;
+            }
+        }
+        return n;
+    }
+};
+
+/**
+ * Creates a matcher from a list of filters and their values, deducing the
+ * number of filters.
+ * @param entries The filters and their values.
+ * @return The matcher.
+ * @throw std::invalid_argument if a filter is not valid. At compile time,
+ *  	  this is an error.
+ */
+template <typename T, std::size_t N>
+constexpr static_topic_matcher<T, N> make_static_topic_matcher(
+    const std::pair<std::string_view, T> (&entries)[N]
+) {
+    return static_topic_matcher<T, N>{entries};
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace literals {
+
+/**
+ * Creates a topic filter from a string literal, like "a/+/c"_filter.
+ * Used to initialize a constant, the filter is checked at compile time.
+ */
+constexpr static_topic_filter operator""_filter(const char* s, std::size_t n) {
+    return static_topic_filter{std::string_view{s, n}};
+}
+
+}  // namespace literals
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_static_topic_filter_h
@@ -216,6 +216,13 @@ public:
      * @return The number of strings in the collection.
      */
     size_t size() const { return coll_.size(); }
+    /**
+     * Reserves space for a number of strings.
+     * When building a large collection one string at a time, this keeps
+     * the pointers to the C strings from being rebuilt as it grows.
+     * @param n The number of strings to reserve space for.
+     */
+    void reserve(size_t n);
     /**
      * Copies a string onto the back of the collection.
      * @param str A string.
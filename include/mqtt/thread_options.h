@@ -0,0 +1,184 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file thread_options.h
+/// Declaration of MQTT thread_options class, which sets the name, CPU
+/// affinity, and priority of the threads that the client runs code on.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_thread_options_h
+#define __mqtt_thread_options_h
+
+#include <functional>
+#include <vector>
+
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The threads that the client runs code on.
+ */
+enum class thread_role {
+    /** The C library thread that runs the client's callbacks */
+    CLIENT_CALLBACK,
+    /** The thread that reconnects the client with a reconnect policy */
+    RECONNECT,
+    /** A thread that runs the user callbacks of a synchronous client */
+    SYNC_CALLBACK
+};
+
+/**
+ * Gets the default name for the threads with a role.
+ * The names fit the 15 characters that Linux allows.
+ * @param role The role of the thread.
+ * @return The name of the thread, like "mqtt-callback".
+ */
+string thread_role_name(thread_role role);
+
+/**
+ * Sets the name of the calling thread, as seen by debuggers and tools
+ * like @em top. Names are cut to 15 characters on Linux.
+ * @param name The name.
+ * @return @em true on success, @em false if it's not supported on the
+ *  	   platform.
+ */
+bool set_current_thread_name(const string& name);
+/**
+ * Pins the calling thread to a set of CPUs.
+ * @param cpus The CPUs that the thread can run on.
+ * @return @em true on success, @em false if it's not supported on the
+ *  	   platform, or a CPU is out of range.
+ */
+bool set_current_thread_affinity(const std::vector<int>& cpus);
+/**
+ * Sets the real-time priority of the calling thread.
+ * This uses the FIFO scheduling policy, which normally needs special
+ * privileges.
+ * @param prio The priority.
+ * @return @em true on success, @em false if it's not supported on the
+ *  	   platform, or isn't allowed.
+ */
+bool set_current_thread_priority(int prio);
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Options for the threads that the client runs code on.
+ *
+ * These are applied to each thread the first time the client runs on
+ * it. That includes the thread in the C library that runs the client's
+ * callbacks, like the one for incoming messages, and the threads that
+ * the C++ library creates for the client, like the reconnect thread.
+ * @par
+ * The C library's own send and receive threads, and the callback thread,
+ * are shared by all the clients in the process. The options of the first
+ * client that runs on one of those threads are the ones that stick.
+ * @par
+ * The start handler is called last, on the thread, so it can do anything
+ * more that the app needs, like setting a scheduling policy of its own
+ * or registering the thread with a profiler.
+ */
+class thread_options
+{
+public:
+    /**
+     * Handler called on a thread when the client first runs on it.
+     * @param role The role of the thread.
+     * @param name The name for the thread.
+     */
+    using start_handler = std::function<void(thread_role role, const string& name)>;
+
+private:
+    /** Whether to name the threads */
+    bool nameThreads_{false};
+    /** The CPUs to pin the threads to (empty for any) */
+    std::vector<int> affinity_;
+    /** The real-time priority for the threads (zero to leave it) */
+    int priority_{0};
+    /** The handler called on each thread (if any) */
+    start_handler startHandler_;
+
+public:
+    /**
+     * Creates options that leave the threads alone.
+     */
+    thread_options() {}
+    /**
+     * Determines if the options leave the threads alone.
+     * @return @em true if nothing is set.
+     */
+    bool empty() const {
+        return !nameThreads_ && affinity_.empty() && priority_ == 0 && !startHandler_;
+    }
+    /**
+     * Determines if the threads are named after their roles.
+     * @return @em true if the threads are named.
+     */
+    bool get_name_threads() const { return nameThreads_; }
+    /**
+     * Sets whether to name the threads after their roles, using
+     * thread_role_name().
+     * @param on @em true to name the threads.
+     */
+    void set_name_threads(bool on) { nameThreads_ = on; }
+    /**
+     * Gets the CPUs that the threads are pinned to.
+     * @return The CPUs, or an empty set if the threads aren't pinned.
+     */
+    const std::vector<int>& get_affinity() const { return affinity_; }
+    /**
+     * Pins the threads to a set of CPUs.
+     * @param cpus The CPUs, or an empty set to leave the threads alone.
+     */
+    void set_affinity(std::vector<int> cpus) { affinity_ = std::move(cpus); }
+    /**
+     * Gets the real-time priority for the threads.
+     * @return The priority, or zero if it's left alone.
+     */
+    int get_priority() const { return priority_; }
+    /**
+     * Sets a real-time priority for the threads.
+     * @param prio The priority, or zero to leave it alone.
+     */
+    void set_priority(int prio) { priority_ = prio; }
+    /**
+     * Gets the handler called on each thread.
+     * @return The handler, which might be empty.
+     */
+    const start_handler& get_start_handler() const { return startHandler_; }
+    /**
+     * Sets a handler to call on each thread, when the client first runs
+     * on it.
+     * @param cb The handler.
+     */
+    void set_start_handler(start_handler cb) { startHandler_ = std::move(cb); }
+    /**
+     * Applies the options to the calling thread.
+     * Any exception from the start handler is discarded.
+     * @param role The role of the thread.
+     */
+    void apply(thread_role role) const;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_thread_options_h
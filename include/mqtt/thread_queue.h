@@ -26,12 +26,18 @@
 #define __mqtt_thread_queue_h
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
 #include <limits>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <vector>
+
+#include "mqtt/probes.h"
+#include "mqtt/wait_strategy.h"
 
 namespace mqtt {
 
@@ -47,6 +53,49 @@ public:
 
 /////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Traits for the items of a @ref thread_queue, used by the byte capacity
+ * and the conflating overflow policy.
+ * This can be specialized for item types that know their own size, like
+ * the @ref event objects of a consumer queue.
+ * @tparam T The type of the items in the queue.
+ */
+template <typename T>
+struct thread_queue_traits
+{
+    /**
+     * Gets the number of bytes that an item counts for.
+     * @return The size of the item.
+     */
+    static std::size_t size_of(const T&) noexcept { return sizeof(T); }
+    /**
+     * Determines if a new item can take the place of an older one in the
+     * queue, when the queue conflates.
+     * @return @em true if the new item replaces the old one.
+     */
+    static bool conflates(const T& /*older*/, const T& /*newer*/) noexcept { return false; }
+    /**
+     * Handles an item that the queue dropped or replaced, or that was
+     * cleared out of it, before it's destroyed. This is called without
+     * the queue locked. Specializations can leave it out.
+     */
+    static void discard(T& /*item*/) {}
+};
+
+/**
+ * Hands an item that a queue dropped to the `discard()` of its traits.
+ * This does nothing for traits that were specialized without one.
+ * @param item The item.
+ */
+template <typename T>
+auto discard_queue_item(T& item, int) -> decltype(thread_queue_traits<T>::discard(item)) {
+    thread_queue_traits<T>::discard(item);
+}
+template <typename T>
+void discard_queue_item(T&, long) {}
+
+/////////////////////////////////////////////////////////////////////////////
+
 /**
  * A thread-safe queue for inter-thread communication.
  *
@@ -63,6 +112,28 @@ public:
  * queue will block until the number of items are removed from the queue to
  * bring the size below the new capacity.
  * @par
+ * The queue can also be limited by the total size of the items in it,
+ * in bytes, as counted by @ref thread_queue_traits. A single item larger
+ * than the byte capacity can still go into an empty queue. So a queue of
+ * a mix of small and very large items can be kept to a fixed amount of
+ * memory.
+ * @par
+ * What happens to an item put into a full queue is set by the overflow
+ * policy:
+ * @li @em BLOCK, the default, makes the caller wait for room.
+ * @li @em DROP_NEWEST discards the new item.
+ * @li @em DROP_OLDEST discards the items at the front of the queue until
+ *     the new one fits.
+ * @li @em CONFLATE replaces the newest item in the queue that the new one
+ *     can take the place of, according to the traits. If there isn't one,
+ *     the oldest items are dropped, as with @em DROP_OLDEST.
+ *
+ * With any policy other than @em BLOCK, putting an item never waits, so a
+ * producer that mustn't stall, like the library's network thread, can't be
+ * held up by a slow consumer. The items that are dropped or replaced are
+ * counted, and handed to the `discard()` of the traits once the queue is
+ * unlocked, as are the items thrown out by `clear()`.
+ * @par
  * The queue can be closed. After that, no new items can be placed into it;
  * a `put()` calls will fail. Receivers can still continue to get any items
  * out of the queue that were added before it was closed. Once there are no
@@ -76,10 +147,16 @@ public:
  * be left in the queue. This is especially useful when creating queues of
  * shared pointers, as the "dead" part of the queue will not hold onto a
  * reference count after the item has been removed from the queue.
+ * @par
+ * A receiver waiting on an empty queue normally blocks on a condition
+ * variable. With a @ref wait_strategy that spins, it spins on a flag
+ * instead, without holding the lock, so that a receiver on a core of its
+ * own picks up a new item without the delay of being woken by the OS.
  *
  * @tparam T The type of the items to be held in the queue.
  * @tparam Container The type of the underlying container to use. It must
- * support back(), front(), push_back(), pop_front().
+ * support front(), emplace_back(), pop_front(), clear(), and reverse
+ * iterators.
  */
 template <typename T, class Container = std::deque<T>>
 class thread_queue
@@ -95,7 +172,22 @@ public:
     /** The maximum capacity of the queue. */
     static constexpr size_type MAX_CAPACITY = std::numeric_limits<size_type>::max();
 
+    /** What to do with an item put into a full queue */
+    enum overflow_policy {
+        /** Wait for room */
+        BLOCK,
+        /** Discard the new item */
+        DROP_NEWEST,
+        /** Discard the oldest items to make room */
+        DROP_OLDEST,
+        /** Replace an item the new one can take the place of */
+        CONFLATE
+    };
+
 private:
+    /** The traits of the items */
+    using traits = thread_queue_traits<T>;
+
     /** Object lock */
     mutable std::mutex lock_;
     /** Condition get signaled when item added to empty queue */
@@ -104,11 +196,30 @@ private:
     std::condition_variable notFullCond_;
     /** The capacity of the queue */
     size_type cap_{MAX_CAPACITY};
+    /** The capacity of the queue, in bytes */
+    size_type byteCap_{MAX_CAPACITY};
+    /** What to do when the queue is full */
+    overflow_policy policy_{BLOCK};
     /** Whether the queue is closed */
     bool closed_{false};
+    /** How a receiver waits on an empty queue */
+    wait_strategy waitStrategy_;
+    /**
+     * Whether there's an item in the queue, or it's closed, for receivers
+     * to spin on without the lock.
+     */
+    std::atomic<bool> ready_{false};
+    /** The total size of the items in the queue, in bytes */
+    size_type bytes_{0};
+    /** The most bytes there have been in the queue */
+    size_type peakBytes_{0};
+    /** The number of items that were dropped because the queue was full */
+    uint64_t nDropped_{0};
+    /** The number of items that were replaced by newer ones */
+    uint64_t nConflated_{0};
 
     /** The actual STL container to hold data */
-    std::queue<T, Container> que_;
+    Container que_;
 
     /** Simple, scope-based lock guard */
     using guard = std::lock_guard<std::mutex>;
@@ -119,6 +230,141 @@ private:
     bool is_done() const {
         return closed_ && que_.empty();
     }
+    /** Determines if there is room for an item of 'n' bytes (unsafe) */
+    bool has_room(size_type n) const {
+        return que_.size() < cap_ &&
+               (que_.empty() || (bytes_ <= byteCap_ && n <= byteCap_ - bytes_));
+    }
+    /** Adds an item of 'n' bytes to the back of the queue (unsafe) */
+    void push(value_type&& val, size_type n) {
+        que_.emplace_back(std::move(val));
+        bytes_ += n;
+        if (bytes_ > peakBytes_)
+            peakBytes_ = bytes_;
+        ready_.store(true, std::memory_order_release);
+        PAHO_MQTTPP_PROBE1(queue_put, que_.size());
+        notEmptyCond_.notify_one();
+    }
+    /** Removes the item at the front of the queue (unsafe) */
+    value_type take() {
+        bytes_ -= traits::size_of(que_.front());
+        value_type val = std::move(que_.front());
+        que_.pop_front();
+        if (que_.empty())
+            ready_.store(closed_, std::memory_order_release);
+        return val;
+    }
+    /**
+     * Spins for an item, or for the queue to close, before a receiver
+     * blocks, as the wait strategy calls for (unsafe). The lock is dropped
+     * while spinning.
+     * @return @em true if the receiver shouldn't block, because there's
+     *  	   an item, the queue is closed, or the time ran out for a
+     *  	   strategy that never blocks.
+     */
+    template <class Clock, class Duration>
+    bool spin_for_item(
+        unique_guard& g, const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        const auto ws = waitStrategy_;
+        while (que_.empty() && !closed_ && ws.spins()) {
+            g.unlock();
+            bool ready = ws.spin_until(
+                [this] { return ready_.load(std::memory_order_acquire); }, absTime
+            );
+            g.lock();
+            if (!ready)
+                return !que_.empty() || closed_ || !ws.parks();
+        }
+        return !que_.empty() || closed_;
+    }
+    /** Waits for an item, or for the queue to close (unsafe) */
+    void wait_for_item(unique_guard& g) {
+        if (!spin_for_item(g, std::chrono::steady_clock::time_point::max()))
+            notEmptyCond_.wait(g, [this] { return !que_.empty() || closed_; });
+    }
+    /** Waits up to a time for an item, or for the queue to close (unsafe) */
+    template <class Clock, class Duration>
+    void wait_for_item(unique_guard& g, const std::chrono::time_point<Clock, Duration>& absTime) {
+        if (!spin_for_item(g, absTime))
+            notEmptyCond_.wait_until(g, absTime, [this] { return !que_.empty() || closed_; });
+    }
+    /** Waits a while for an item, or for the queue to close (unsafe) */
+    template <typename Rep, class Period>
+    void wait_for_item(unique_guard& g, const std::chrono::duration<Rep, Period>& relTime) {
+        if (waitStrategy_.spins())
+            wait_for_item(g, wait_strategy::deadline_after(relTime));
+        else
+            notEmptyCond_.wait_for(g, relTime, [this] { return !que_.empty() || closed_; });
+    }
+    /**
+     * Places an item into a full queue, according to the overflow policy,
+     * which must not be BLOCK (unsafe).
+     * The items that are dropped or replaced, which may be the new one,
+     * are moved to the back of 'dropped'.
+     * @return @em true if the item went into the queue.
+     */
+    bool put_full(value_type&& val, size_type n, std::vector<value_type>& dropped) {
+        if (policy_ == DROP_NEWEST) {
+            dropped.push_back(std::move(val));
+            ++nDropped_;
+            return false;
+        }
+
+        if (policy_ == CONFLATE) {
+            for (auto it = que_.rbegin(); it != que_.rend(); ++it) {
+                if (traits::conflates(*it, val)) {
+                    bytes_ = bytes_ - traits::size_of(*it) + n;
+                    if (bytes_ > peakBytes_)
+                        peakBytes_ = bytes_;
+                    dropped.push_back(std::move(*it));
+                    *it = std::move(val);
+                    ++nConflated_;
+                    return true;
+                }
+            }
+        }
+
+        while (!que_.empty() && !has_room(n)) {
+            dropped.push_back(take());
+            ++nDropped_;
+        }
+        push(std::move(val), n);
+        return true;
+    }
+    /**
+     * Places an item into the queue if there's room, or according to the
+     * overflow policy if not (unsafe).
+     * @return @em true if the item went into the queue.
+     */
+    bool place(value_type&& val, size_type n, std::vector<value_type>& dropped) {
+        if (has_room(n)) {
+            push(std::move(val), n);
+            return true;
+        }
+        return policy_ != BLOCK && put_full(std::move(val), n, dropped);
+    }
+    /**
+     * Hands the items that were dropped to the traits. The queue must not
+     * be locked.
+     */
+    static void discard(std::vector<value_type>& dropped) {
+        for (auto& val : dropped) discard_queue_item(val, 0);
+    }
+    /**
+     * Moves up to 'n' items from the front of the queue to the back of the
+     * vector, signaling any blocked producers (unsafe).
+     */
+    size_type move_n(std::vector<value_type>* vec, size_type n) {
+        n = std::min(n, que_.size());
+        vec->reserve(vec->size() + n);
+        for (size_type i = 0; i < n; ++i) vec->push_back(take());
+        if (n > 0) {
+            PAHO_MQTTPP_PROBE2(queue_get_n, n, que_.size());
+            notFullCond_.notify_all();
+        }
+        return n;
+    }
 
 public:
     /**
@@ -133,6 +379,17 @@ public:
      *  		  queue. The minimum capacity is 1.
      */
     explicit thread_queue(size_t cap) : cap_(std::max<size_type>(cap, 1)) {}
+    /**
+     * Constructs a queue with the specified capacity, in items and bytes,
+     * and overflow policy.
+     * @param cap The maximum number of items that can be placed in the
+     *  		  queue. The minimum capacity is 1.
+     * @param byteCap The maximum total size of the items in the queue,
+     *  			  in bytes.
+     * @param policy What to do with an item put into a full queue.
+     */
+    thread_queue(size_t cap, size_t byteCap, overflow_policy policy = BLOCK)
+        : cap_(std::max<size_type>(cap, 1)), byteCap_(byteCap), policy_(policy) {}
     /**
      * Determine if the queue is empty.
      * @return @em true if there are no elements in the queue, @em false if
@@ -160,6 +417,59 @@ public:
         guard g{lock_};
         cap_ = cap;
     }
+    /**
+     * Gets the capacity of the queue, in bytes.
+     * @return The maximum total size of the items, in bytes.
+     */
+    size_type byte_capacity() const {
+        guard g{lock_};
+        return byteCap_;
+    }
+    /**
+     * Sets the capacity of the queue, in bytes.
+     * As with the item capacity, this can be smaller than the total size
+     * of the items already in the queue.
+     * @param byteCap The maximum total size of the items, in bytes.
+     */
+    void byte_capacity(size_type byteCap) {
+        guard g{lock_};
+        byteCap_ = byteCap;
+        notFullCond_.notify_all();
+    }
+    /**
+     * Gets what is done with an item put into a full queue.
+     * @return The overflow policy.
+     */
+    overflow_policy policy() const {
+        guard g{lock_};
+        return policy_;
+    }
+    /**
+     * Sets what is done with an item put into a full queue.
+     * @param policy The overflow policy.
+     */
+    void policy(overflow_policy policy) {
+        guard g{lock_};
+        policy_ = policy;
+        notFullCond_.notify_all();
+    }
+    /**
+     * Gets how a receiver waits on an empty queue.
+     * @return The wait strategy.
+     */
+    wait_strategy get_wait_strategy() const {
+        guard g{lock_};
+        return waitStrategy_;
+    }
+    /**
+     * Sets how a receiver waits on an empty queue.
+     * This applies to the receivers that start to wait after it's set.
+     * @param ws The wait strategy.
+     */
+    void set_wait_strategy(const wait_strategy& ws) {
+        guard g{lock_};
+        waitStrategy_ = ws;
+    }
     /**
      * Gets the number of items in the queue.
      * @return The number of items in the queue.
@@ -168,6 +478,41 @@ public:
         guard g{lock_};
         return que_.size();
     }
+    /**
+     * Gets the total size of the items in the queue.
+     * @return The size of the items in the queue, in bytes.
+     */
+    size_type bytes() const {
+        guard g{lock_};
+        return bytes_;
+    }
+    /**
+     * Gets the most bytes there have been in the queue at once.
+     * @return The high-water mark of the size of the queue, in bytes.
+     */
+    size_type peak_bytes() const {
+        guard g{lock_};
+        return peakBytes_;
+    }
+    /**
+     * Gets the number of items that were dropped because the queue was
+     * full. These are the new items with @em DROP_NEWEST, and the old ones
+     * with @em DROP_OLDEST or @em CONFLATE.
+     * @return The number of items dropped.
+     */
+    uint64_t num_dropped() const {
+        guard g{lock_};
+        return nDropped_;
+    }
+    /**
+     * Gets the number of items that were replaced by newer ones, with the
+     * @em CONFLATE policy.
+     * @return The number of items replaced.
+     */
+    uint64_t num_conflated() const {
+        guard g{lock_};
+        return nConflated_;
+    }
     /**
      * Close the queue.
      * Once closed, the queue will not accept any new items, but receievers
@@ -177,6 +522,7 @@ public:
     void close() {
         guard g{lock_};
         closed_ = true;
+        ready_.store(true, std::memory_order_release);
         notFullCond_.notify_all();
         notEmptyCond_.notify_all();
     }
@@ -206,24 +552,35 @@ public:
      * This discards all items in the queue.
      */
     void clear() {
-        guard g{lock_};
-        while (!que_.empty())
-            que_.pop();
-        notFullCond_.notify_all();
+        Container que;
+        {
+            guard g{lock_};
+            que.swap(que_);
+            bytes_ = 0;
+            ready_.store(closed_, std::memory_order_release);
+            notFullCond_.notify_all();
+        }
+        for (auto& val : que) discard_queue_item(val, 0);
     }
     /**
      * Put an item into the queue.
      * If the queue is full, this will block the caller until items are
-     * removed bringing the size less than the capacity.
+     * removed bringing the size less than the capacity, unless the
+     * overflow policy drops or replaces items instead.
      * @param val The value to add to the queue.
      */
     void put(value_type val) {
-        unique_guard g{lock_};
-        notFullCond_.wait(g, [this] { return que_.size() < cap_ || closed_; });
-        if (closed_) throw queue_closed{};
+        std::vector<value_type> dropped;
+        {
+            unique_guard g{lock_};
+            auto n = traits::size_of(val);
+            if (policy_ == BLOCK)
+                notFullCond_.wait(g, [this, n] { return has_room(n) || closed_; });
+            if (closed_) throw queue_closed{};
 
-        que_.emplace(std::move(val));
-        notEmptyCond_.notify_one();
+            place(std::move(val), n, dropped);
+        }
+        discard(dropped);
     }
     /**
      * Non-blocking attempt to place an item into the queue.
@@ -232,13 +589,18 @@ public:
      *  	   item was not added because the queue is currently full.
      */
     bool try_put(value_type val) {
-        guard g{lock_};
-        if (que_.size() >= cap_ || closed_)
-            return false;
+        std::vector<value_type> dropped;
+        bool ok;
+        {
+            guard g{lock_};
+            if (closed_)
+                return false;
 
-        que_.emplace(std::move(val));
-        notEmptyCond_.notify_one();
-        return true;
+            auto n = traits::size_of(val);
+            ok = place(std::move(val), n, dropped);
+        }
+        discard(dropped);
+        return ok;
     }
     /**
      * Attempt to place an item in the queue with a bounded wait.
@@ -251,17 +613,22 @@ public:
      */
     template <typename Rep, class Period>
     bool try_put_for(value_type val, const std::chrono::duration<Rep, Period>& relTime) {
-        unique_guard g{lock_};
-        bool to = !notFullCond_.wait_for(
-			g, relTime,
-			[this] { return que_.size() < cap_ || closed_; }
-	    );
-        if (to || closed_)
-            return false;
+        std::vector<value_type> dropped;
+        bool ok;
+        {
+            unique_guard g{lock_};
+            auto n = traits::size_of(val);
+            bool to = policy_ == BLOCK && !notFullCond_.wait_for(
+                g, relTime,
+                [this, n] { return has_room(n) || closed_; }
+            );
+            if (to || closed_)
+                return false;
 
-        que_.emplace(std::move(val));
-        notEmptyCond_.notify_one();
-        return true;
+            ok = place(std::move(val), n, dropped);
+        }
+        discard(dropped);
+        return ok;
     }
     /**
      * Attempt to place an item in the queue with a bounded wait to an
@@ -277,18 +644,23 @@ public:
     bool try_put_until(
         value_type val, const std::chrono::time_point<Clock, Duration>& absTime
     ) {
-        unique_guard g{lock_};
-        bool to = !notFullCond_.wait_until(
-			g, absTime,
-			[this] { return que_.size() < cap_ || closed_; }
-	    );
+        std::vector<value_type> dropped;
+        bool ok;
+        {
+            unique_guard g{lock_};
+            auto n = traits::size_of(val);
+            bool to = policy_ == BLOCK && !notFullCond_.wait_until(
+                g, absTime,
+                [this, n] { return has_room(n) || closed_; }
+            );
 
-        if (to || closed_)
-            return false;
+            if (to || closed_)
+                return false;
 
-        que_.emplace(std::move(val));
-        notEmptyCond_.notify_one();
-        return true;
+            ok = place(std::move(val), n, dropped);
+        }
+        discard(dropped);
+        return ok;
     }
     /**
      * Retrieve a value from the queue.
@@ -301,12 +673,12 @@ public:
             return false;
 
         unique_guard g{lock_};
-        notEmptyCond_.wait(g, [this] { return !que_.empty() || closed_; });
+        wait_for_item(g);
         if (que_.empty())  // We must be done
             return false;
 
-        *val = std::move(que_.front());
-        que_.pop();
+        *val = take();
+        PAHO_MQTTPP_PROBE1(queue_get, que_.size());
         notFullCond_.notify_one();
         return true;
     }
@@ -318,12 +690,12 @@ public:
      */
     value_type get() {
         unique_guard g{lock_};
-        notEmptyCond_.wait(g, [this] { return !que_.empty() || closed_; });
+        wait_for_item(g);
         if (que_.empty())  // We must be done
             throw queue_closed{};
 
-        value_type val = std::move(que_.front());
-        que_.pop();
+        value_type val = take();
+        PAHO_MQTTPP_PROBE1(queue_get, que_.size());
         notFullCond_.notify_one();
         return val;
     }
@@ -343,8 +715,8 @@ public:
         if (que_.empty())
             return false;
 
-        *val = std::move(que_.front());
-        que_.pop();
+        *val = take();
+        PAHO_MQTTPP_PROBE1(queue_get, que_.size());
         notFullCond_.notify_one();
         return true;
     }
@@ -364,16 +736,12 @@ public:
             return false;
 
         unique_guard g{lock_};
-        notEmptyCond_.wait_for(
-			g, relTime,
-			[this] { return !que_.empty() || closed_; }
-	    );
-
+        wait_for_item(g, relTime);
         if (que_.empty())
             return false;
 
-        *val = std::move(que_.front());
-        que_.pop();
+        *val = take();
+        PAHO_MQTTPP_PROBE1(queue_get, que_.size());
         notFullCond_.notify_one();
         return true;
     }
@@ -395,17 +763,92 @@ public:
             return false;
 
         unique_guard g{lock_};
-        notEmptyCond_.wait_until(
-			g, absTime, [this] { return !que_.empty() || closed_; }
-	    );
+        wait_for_item(g, absTime);
         if (que_.empty())
             return false;
 
-        *val = std::move(que_.front());
-        que_.pop();
+        *val = take();
+        PAHO_MQTTPP_PROBE1(queue_get, que_.size());
         notFullCond_.notify_one();
         return true;
     }
+    /**
+     * Retrieve all the values from the queue.
+     * If the queue is empty, this will block indefinitely until a value is
+     * added to the queue by another thread, or the queue is closed. Then
+     * everything in the queue is removed under a single lock.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @return The number of values removed from the queue. This is zero
+     *  	   only if the queue is done.
+     */
+    size_type get_all(std::vector<value_type>* vec) {
+        if (!vec)
+            return 0;
+
+        unique_guard g{lock_};
+        wait_for_item(g);
+        return move_n(vec, que_.size());
+    }
+    /**
+     * Attempts to remove up to 'n' values from the queue without blocking.
+     * The values are all removed under a single lock.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @return The number of values removed from the queue.
+     */
+    size_type try_get_n(std::vector<value_type>* vec, size_type n) {
+        if (!vec)
+            return 0;
+
+        guard g{lock_};
+        return move_n(vec, n);
+    }
+    /**
+     * Attempt to remove up to 'n' values from the queue, waiting a bounded
+     * amount of time for the first one to arrive.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @param relTime The amount of time to wait until timing out.
+     * @return The number of values removed from the queue, which is zero
+     *  	   if a timeout occurred.
+     */
+    template <typename Rep, class Period>
+    size_type try_get_n_for(
+        std::vector<value_type>* vec, size_type n,
+        const std::chrono::duration<Rep, Period>& relTime
+    ) {
+        if (!vec)
+            return 0;
+
+        unique_guard g{lock_};
+        wait_for_item(g, relTime);
+        return move_n(vec, n);
+    }
+    /**
+     * Attempt to remove up to 'n' values from the queue, waiting until the
+     * specified time for the first one to arrive.
+     * @param vec Pointer to a vector to receive the values. They are added
+     *  		  to the end, after any items already in it.
+     * @param n The maximum number of values to remove.
+     * @param absTime The absolute time to wait to before timing out.
+     * @return The number of values removed from the queue, which is zero
+     *  	   if a timeout occurred.
+     */
+    template <class Clock, class Duration>
+    size_type try_get_n_until(
+        std::vector<value_type>* vec, size_type n,
+        const std::chrono::time_point<Clock, Duration>& absTime
+    ) {
+        if (!vec)
+            return 0;
+
+        unique_guard g{lock_};
+        wait_for_item(g, absTime);
+        return move_n(vec, n);
+    }
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,262 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file timer_wheel.h
+/// Declaration of MQTT timer_wheel class, a hierarchical timer wheel for
+/// large numbers of deadlines.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_timer_wheel_h
+#define __mqtt_timer_wheel_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A hierarchical timer wheel, which runs operations at their deadlines
+ * from a single thread.
+ *
+ * Time is cut into ticks, and the timers are kept in four wheels of 64
+ * slots each. The first wheel has a slot for each of the next 64 ticks,
+ * the second for each of the next 64 runs of 64 ticks, and so on. As the
+ * first wheel comes around, the timers in the next slot of the one above
+ * it are spread down into it. So scheduling or cancelling a timer is
+ * constant time, however many there are, unlike a heap, which pays a
+ * log for each; and the thread only wakes for the ticks that have timers
+ * due, or to spread down the wheels above. With a 1ms tick, the wheels
+ * span about four and a half hours, and a timer past that rides around
+ * at the top until it's in reach.
+ * @par
+ * A timer never fires before its deadline, and usually within a tick of
+ * it. The ones that come due in the same tick run in the order of their
+ * deadlines, then the order they were scheduled. They run on the wheel's
+ * thread, one at a time, so they should be quick; a long one holds up
+ * the rest.
+ * @par
+ * The async_client has a wheel, made when it's first needed, that's
+ * shared by its operation timeouts, its RPC client, publish retries, and
+ * queued rate limiting. See `async_client::get_timer_wheel()`.
+ */
+class timer_wheel
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<timer_wheel>;
+    /** The clock for the deadlines */
+    using clock = std::chrono::steady_clock;
+    /** The type of duration used for the tick */
+    using duration = clock::duration;
+    /** The operation run when a timer fires */
+    using task_type = std::function<void()>;
+    /** The ID of a timer, which is never zero */
+    using timer_id = uint64_t;
+
+    /** The default length of a tick */
+    static constexpr duration DFLT_TICK = std::chrono::milliseconds(1);
+
+private:
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** General purpose guard */
+    using unique_guard = std::unique_lock<std::mutex>;
+
+    /** The number of bits of the tick count for each wheel */
+    static constexpr unsigned SLOT_BITS = 6;
+    /** The number of slots in a wheel */
+    static constexpr size_t N_SLOTS = size_t(1) << SLOT_BITS;
+    /** The number of wheels */
+    static constexpr size_t N_LEVELS = 4;
+
+    /** A timer in a slot */
+    struct entry
+    {
+        /** The ID of the timer */
+        timer_id id;
+        /** The tick in which it's due */
+        uint64_t tick;
+    };
+
+    /** A scheduled timer */
+    struct timer
+    {
+        /** When it's due */
+        clock::time_point deadline;
+        /** The operation to run */
+        task_type task;
+    };
+
+    /** The length of a tick */
+    const duration tick_;
+    /** The time of tick zero */
+    const clock::time_point start_;
+
+    /** Object lock */
+    mutable std::mutex lock_;
+    /** Signals the thread when a timer is scheduled, or the wheel stops */
+    std::condition_variable cond_;
+    /** Signals the cancellers when a running timer is done */
+    std::condition_variable doneCond_;
+    /** The slots of the wheels. Cancelled timers are left to be skipped. */
+    std::vector<entry> slots_[N_LEVELS][N_SLOTS];
+    /** The number of entries in each wheel */
+    size_t levelCount_[N_LEVELS]{};
+    /** The scheduled timers, by ID */
+    std::unordered_map<timer_id, timer> timers_;
+    /** The last tick that was processed */
+    uint64_t now_{0};
+    /** The tick the thread will next wake for */
+    uint64_t nextWake_{0};
+    /** The next timer ID */
+    timer_id nextId_{1};
+    /** The timer that's running now, if any */
+    timer_id running_{0};
+    /** The number of timers that fired */
+    size_t nFired_{0};
+    /** Whether the thread should exit */
+    bool stop_{false};
+    /** The thread that runs the timers */
+    std::thread thr_;
+
+    /** Gets the tick for a time, rounded down */
+    uint64_t tick_of(clock::time_point tp) const;
+    /** Gets the time of the start of a tick */
+    clock::time_point time_of(uint64_t tick) const { return start_ + tick_ * tick; }
+    /** Puts an entry into its slot */
+    void insert(const entry& e);
+    /** Spreads the entries of a slot in an upper wheel down the wheels */
+    void cascade(size_t level);
+    /** Processes the ticks up to the target, collecting the due timers */
+    void advance(uint64_t target, std::vector<timer_id>& due);
+    /** Gets the next tick that the thread needs to wake for */
+    uint64_t next_tick() const;
+    /** The function run by the thread */
+    void run();
+
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+public:
+    /**
+     * Creates a timer wheel, and starts its thread.
+     * @param tick The length of a tick, which is the resolution of the
+     *  		   timers.
+     */
+    explicit timer_wheel(duration tick = DFLT_TICK);
+    /**
+     * Creates a timer wheel, and starts its thread.
+     * @param tick The length of a tick, which is the resolution of the
+     *  		   timers.
+     */
+    template <class Rep, class Period>
+    explicit timer_wheel(const std::chrono::duration<Rep, Period>& tick)
+        : timer_wheel(std::chrono::duration_cast<duration>(tick)) {}
+    /**
+     * Destroys the wheel, stopping its thread.
+     * Any timers that haven't fired are dropped, without running.
+     */
+    ~timer_wheel();
+    /**
+     * Creates a timer wheel shared pointer.
+     * @param tick The length of a tick.
+     * @return A shared pointer to a new timer wheel.
+     */
+    static ptr_t create(duration tick = DFLT_TICK) { return std::make_shared<timer_wheel>(tick); }
+    /**
+     * Gets the length of a tick.
+     * @return The length of a tick.
+     */
+    duration get_tick() const { return tick_; }
+    /**
+     * Schedules an operation to run at a deadline.
+     * A deadline that has already passed runs on the next tick.
+     * @param deadline When to run the operation.
+     * @param task The operation.
+     * @return The ID of the timer, or zero if the wheel was stopped.
+     */
+    timer_id schedule_at(clock::time_point deadline, task_type task);
+    /**
+     * Schedules an operation to run after a time.
+     * @param d How long to wait before running the operation.
+     * @param task The operation.
+     * @return The ID of the timer, or zero if the wheel was stopped.
+     */
+    template <class Rep, class Period>
+    timer_id schedule_after(const std::chrono::duration<Rep, Period>& d, task_type task) {
+        return schedule_at(
+            clock::now() + std::chrono::duration_cast<duration>(d), std::move(task)
+        );
+    }
+    /**
+     * Cancels a timer.
+     * If the timer is running on the wheel's thread, this waits for it to
+     * finish, unless it's called from the wheel's thread. So once this
+     * returns, the operation isn't running and won't be.
+     * @param id The ID of the timer.
+     * @return @em true if the timer was cancelled before it ran, @em false
+     *  	   if it already ran, or wasn't a timer.
+     */
+    bool cancel(timer_id id);
+    /**
+     * Gets the number of timers waiting to fire.
+     * @return The number of timers waiting to fire.
+     */
+    size_t size() const {
+        guard g{lock_};
+        return timers_.size();
+    }
+    /**
+     * Determines if there are no timers waiting to fire.
+     * @return @em true if there are no timers waiting.
+     */
+    bool empty() const { return size() == 0; }
+    /**
+     * Gets the number of timers that fired.
+     * @return The number of timers that fired.
+     */
+    size_t num_fired() const {
+        guard g{lock_};
+        return nFired_;
+    }
+    /**
+     * Stops the wheel's thread.
+     * Any timers that haven't fired are dropped, without running, and no
+     * more can be scheduled. It's safe to call this more than once, but
+     * not from a timer.
+     */
+    void stop();
+};
+
+/** Smart/shared pointer to a timer_wheel */
+using timer_wheel_ptr = timer_wheel::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_timer_wheel_h
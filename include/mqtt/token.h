@@ -25,8 +25,10 @@
 #ifndef __mqtt_token_h
 #define __mqtt_token_h
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -35,10 +37,12 @@
 #include "mqtt/buffer_ref.h"
 #include "mqtt/exception.h"
 #include "mqtt/iaction_listener.h"
+#include "mqtt/pool_allocator.h"
 #include "mqtt/properties.h"
 #include "mqtt/server_response.h"
 #include "mqtt/string_collection.h"
 #include "mqtt/types.h"
+#include "mqtt/wait_strategy.h"
 
 namespace mqtt {
 
@@ -63,6 +67,12 @@ public:
     /** The type of request that the token is tracking */
     enum Type { CONNECT, SUBSCRIBE, PUBLISH, UNSUBSCRIBE, DISCONNECT };
 
+    /**
+     * Handler that is called once when the action completes.
+     * This is mainly intended to resume a suspended coroutine.
+     */
+    using complete_handler = std::function<void()>;
+
 private:
     /** Lock guard type for this class. */
     using guard = std::lock_guard<std::mutex>;
@@ -71,8 +81,13 @@ private:
 
     /** Object monitor mutex. */
     mutable std::mutex lock_;
-    /** Condition variable signals when the action completes */
-    mutable std::condition_variable cond_;
+    /**
+     * Condition variable signals when the action completes.
+     * This is only created once a thread waits on the token, so the many
+     * tokens that are never waited on, like most for QoS 0 messages, don't
+     * pay to set up or signal one.
+     */
+    mutable std::unique_ptr<std::condition_variable> cond_;
 
     /** The type of request that the token is tracking */
     Type type_;
@@ -97,10 +112,22 @@ private:
      * complete, but before the token is signaled.
      */
     iaction_listener* listener_;
+    /** Handler for the completion of the action, called after the listener */
+    complete_handler completeHandler_;
     /** The number of expected responses */
     size_t nExpected_;
-    /** Whether the action has yet to complete */
-    bool complete_;
+    /** The bytes that the client counted for the token while it's pending */
+    size_t memBytes_{0};
+    /** The timer for the deadline of the action, if any */
+    std::atomic<uint64_t> timerId_{0};
+    /** Whether the action was failed by its deadline */
+    bool timedOut_{false};
+    /**
+     * Whether the action has yet to complete.
+     * This is set under the lock, but can be read without it by a waiter
+     * that spins.
+     */
+    std::atomic<bool> complete_;
 
     /** Connection response (null if not available) */
     std::unique_ptr<connect_response> connRsp_;
@@ -111,13 +138,73 @@ private:
 
     /** Client and token-related options have special access */
     friend class async_client;
+    friend class loopback_client;
     friend class mock_async_client;
+    friend class batch_token;
 
     friend class connect_options;
     friend class response_options;
     friend class delivery_response_options;
     friend class disconnect_options;
 
+    /**
+     * Gets the condition variable, creating it if this is the first
+     * waiter. The lock must be held.
+     */
+    std::condition_variable& cond() const {
+        if (!cond_)
+            cond_ = std::make_unique<std::condition_variable>();
+        return *cond_;
+    }
+    /**
+     * Gets how threads wait on the token, which is the wait strategy of
+     * the client.
+     */
+    wait_strategy get_wait_strategy() const;
+    /**
+     * Spins for the action to complete before a waiter blocks, as the
+     * wait strategy calls for. The lock must be held. It's dropped while
+     * spinning.
+     * @return @em true if the waiter shouldn't block, because the action
+     *  	   is complete, or the time ran out for a strategy that never
+     *  	   blocks.
+     */
+    template <class Clock, class Duration>
+    bool spin_for_complete(
+        const wait_strategy& ws, unique_lock& g,
+        const std::chrono::time_point<Clock, Duration>& absTime
+    ) const {
+        if (complete_ || !ws.spins())
+            return complete_;
+
+        g.unlock();
+        bool done =
+            ws.spin_until([this] { return complete_.load(std::memory_order_acquire); }, absTime);
+        g.lock();
+        return done || complete_ || !ws.parks();
+    }
+    /**
+     * Waits for the action to complete, as the wait strategy calls for.
+     * The lock must be held.
+     */
+    void wait_complete(const wait_strategy& ws, unique_lock& g) const {
+        if (!spin_for_complete(ws, g, std::chrono::steady_clock::time_point::max()))
+            cond().wait(g, [this] { return complete_.load(); });
+    }
+    /**
+     * Marks the action as complete, signals any waiters, and runs the
+     * callbacks.
+     * @param g The lock on the token, which is released.
+     * @param success Whether the action succeeded.
+     */
+    void complete(unique_lock& g, bool success);
+    /**
+     * Asks the client whether to retry a failed publish.
+     * @param g The lock on the token, which is held again if the publish
+     *  		is not retried.
+     * @return @em true if the publish will be retried.
+     */
+    bool retry(unique_lock& g);
     /**
      * Resets the token back to a non-signaled state.
      */
@@ -172,6 +259,21 @@ private:
      */
     void on_failure(MQTTAsync_failureData* rsp);
     void on_failure5(MQTTAsync_failureData5* rsp);
+    /**
+     * Fails the action because it passed its deadline.
+     * The token is completed, and its waiters woken, but it's left with
+     * the client until the library is done with the action, whose result
+     * is then dropped.
+     * @return @em true if the token timed out, @em false if it had already
+     *  	   completed.
+     */
+    bool expire();
+    /**
+     * Handles the library's result for an action that already timed out.
+     * @return @em true if the action timed out, and the result was
+     *  	   dropped.
+     */
+    bool drop_if_timed_out(unique_lock& g);
 
     /**
      * Check the current return code and throw an exception if it is not a
@@ -182,6 +284,18 @@ private:
             throw exception(rc_, reasonCode_, errMsg_);
     }
 
+protected:
+    /**
+     * Creates a shared token.
+     * The token and its shared pointer control block are allocated
+     * together from a pool, and recycled when the last reference to the
+     * token is released.
+     */
+    template <typename T, typename... Args>
+    static std::shared_ptr<T> make_pooled(Args&&... args) {
+        return std::allocate_shared<T>(pool_allocator<T>{}, std::forward<Args>(args)...);
+    }
+
 public:
     /**
      * Constructs a token object.
@@ -264,7 +378,7 @@ public:
      * @return A smart/shared pointer to a token.
      */
     static ptr_t create(Type typ, iasync_client& cli) {
-        return std::make_shared<token>(typ, cli);
+        return make_pooled<token>(typ, cli);
     }
     /**
      * Constructs a token object.
@@ -278,7 +392,7 @@ public:
     static ptr_t create(
         Type typ, iasync_client& cli, void* userContext, iaction_listener& cb
     ) {
-        return std::make_shared<token>(typ, cli, userContext, cb);
+        return make_pooled<token>(typ, cli, userContext, cb);
     }
     /**
      * Constructs a token object.
@@ -287,7 +401,7 @@ public:
      * @param topic The topic associated with the token
      */
     static ptr_t create(Type typ, iasync_client& cli, const string& topic) {
-        return std::make_shared<token>(typ, cli, topic);
+        return make_pooled<token>(typ, cli, topic);
     }
     /**
      * Constructs a token object.
@@ -303,7 +417,7 @@ public:
         Type typ, iasync_client& cli, const string& topic, void* userContext,
         iaction_listener& cb
     ) {
-        return std::make_shared<token>(typ, cli, topic, userContext, cb);
+        return make_pooled<token>(typ, cli, topic, userContext, cb);
     }
     /**
      * Constructs a token object.
@@ -312,7 +426,7 @@ public:
      * @param topics The topics associated with the token
      */
     static ptr_t create(Type typ, iasync_client& cli, const_string_collection_ptr topics) {
-        return std::make_shared<token>(typ, cli, topics);
+        return make_pooled<token>(typ, cli, topics);
     }
     /**
      * Constructs a token object.
@@ -328,7 +442,7 @@ public:
         Type typ, iasync_client& cli, const_string_collection_ptr topics, void* userContext,
         iaction_listener& cb
     ) {
-        return std::make_shared<token>(typ, cli, topics, userContext, cb);
+        return make_pooled<token>(typ, cli, topics, userContext, cb);
     }
     /**
      * Gets the type of request the token is tracking, like CONNECT,
@@ -378,6 +492,15 @@ public:
      * @return @em true if the transaction has completed, @em false if not.
      */
     virtual bool is_complete() const { return complete_; }
+    /**
+     * Determines if the action was failed because it passed its deadline.
+     * See `async_client::set_operation_timeout()`.
+     * @return @em true if the action timed out.
+     */
+    bool is_timed_out() const {
+        guard g(lock_);
+        return timedOut_;
+    }
     /**
      * Determines if the reference is valid.
      * If the reference is invalid then it is not safe to call @em any
@@ -401,6 +524,24 @@ public:
      * @param listener The callback to be notified when actions complete.
      */
     virtual void set_action_callback(iaction_listener& listener);
+    /**
+     * Sets a handler to be called when the action completes.
+     *
+     * The handler is called once, from the library's callback thread,
+     * after any action listener and after waiting threads are signaled.
+     * It should not block. Setting a new handler replaces any previous
+     * one.
+     *
+     * Unlike @ref set_action_callback(), if the action has already
+     * completed, the handler is not called, and this returns @em false,
+     * so that a caller can deal with the completion itself without
+     * racing the callback thread.
+     *
+     * @param cb The handler to call on completion.
+     * @return @em true if the handler was set, @em false if the action
+     *  	   had already completed.
+     */
+    bool set_complete_handler(complete_handler cb);
     /**
      * Store some context associated with an action.
      * @param userContext optional object used to pass context to the
@@ -460,10 +601,19 @@ public:
      */
     template <class Rep, class Period>
     bool wait_for(const std::chrono::duration<Rep, Period>& relTime) {
+        const auto ws = get_wait_strategy();
         unique_lock g(lock_);
-        if (!cond_.wait_for(g, std::chrono::milliseconds(relTime), [this] {
-                return complete_;
-            }))
+        if (ws.spins()) {
+            auto until = wait_strategy::deadline_after(relTime);
+            if (!spin_for_complete(ws, g, until))
+                cond().wait_until(g, until, [this] { return complete_.load(); });
+        }
+        else {
+            cond().wait_for(g, std::chrono::milliseconds(relTime), [this] {
+                return complete_.load();
+            });
+        }
+        if (!complete_)
             return false;
         check_ret();
         return true;
@@ -476,8 +626,11 @@ public:
      */
     template <class Clock, class Duration>
     bool wait_until(const std::chrono::time_point<Clock, Duration>& absTime) {
+        const auto ws = get_wait_strategy();
         unique_lock g(lock_);
-        if (!cond_.wait_until(g, absTime, [this] { return complete_; }))
+        if (!spin_for_complete(ws, g, absTime))
+            cond().wait_until(g, absTime, [this] { return complete_.load(); });
+        if (!complete_)
             return false;
         check_ret();
         return true;
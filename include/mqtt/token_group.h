@@ -0,0 +1,217 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file token_group.h
+/// Declaration of MQTT token_group class, which waits on many tokens at
+/// once.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_token_group_h
+#define __mqtt_token_group_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "mqtt/token.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A group of tokens that can be waited on together.
+ *
+ * Each token added to the group signals the group when it completes,
+ * through its completion handler, and the group just counts them. So
+ * waiting for a large batch of publishes to be acknowledged takes a
+ * single wait and a single wakeup, rather than a wait on each token, one
+ * at a time.
+ * @code
+ * mqtt::token_group grp;
+ * for (const auto& msg : msgs)
+ *     grp.add(cli.publish(msg));
+ *
+ * grp.wait_all();
+ * if (grp.num_failed() != 0)
+ *     ...
+ * @endcode
+ * @par
+ * The group takes over the completion handler of each token that's added
+ * to it, replacing any that was set before. It doesn't keep the tokens
+ * themselves. The group can be destroyed while tokens are still pending.
+ */
+class token_group
+{
+    /**
+     * The counters, which are shared with the handlers of the pending
+     * tokens, and outlive the group until the last of them completes.
+     */
+    struct state;
+
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+    /** Lock guard that can be used for waiting */
+    using unique_lock = std::unique_lock<std::mutex>;
+
+    /** The shared state */
+    state* st_;
+
+    /** Called by the handler of each token as it completes */
+    static void on_complete(state* st, const token& tok);
+
+    /** Gets the lock for the state */
+    std::mutex& lock() const;
+    /** Gets the condition variable for the state */
+    std::condition_variable& cond() const;
+    /** Whether all the tokens are complete (with the lock held) */
+    bool all_done() const;
+    /** Whether any token is complete (with the lock held) */
+    bool any_done() const;
+    /**
+     * Registers, or unregisters, a thread waiting for any token (with the
+     * lock held).
+     */
+    void any_waiter(int delta);
+
+public:
+    /**
+     * Creates an empty group.
+     */
+    token_group();
+    /**
+     * Destroys the group.
+     * Any tokens that are still pending just stop signaling it.
+     */
+    ~token_group();
+
+    token_group(const token_group&) = delete;
+    token_group& operator=(const token_group&) = delete;
+
+    /**
+     * Adds a token to the group.
+     * A token that is already complete is counted right away.
+     * @param tok The token. A null token is ignored.
+     */
+    void add(const token_ptr& tok);
+    /**
+     * Gets the number of tokens that were added to the group.
+     * @return The number of tokens in the group.
+     */
+    std::size_t size() const;
+    /**
+     * Determines if no tokens were added to the group.
+     * @return @em true if the group is empty.
+     */
+    bool empty() const { return size() == 0; }
+    /**
+     * Gets the number of tokens that completed, with success or failure.
+     * @return The number of tokens that completed.
+     */
+    std::size_t num_complete() const;
+    /**
+     * Gets the number of tokens that haven't completed yet.
+     * @return The number of tokens still pending.
+     */
+    std::size_t num_pending() const;
+    /**
+     * Gets the number of tokens that completed with a failure.
+     * @return The number of tokens that failed.
+     */
+    std::size_t num_failed() const;
+    /**
+     * Gets the return code of the first token that failed.
+     * @return The return code of the first failure, or MQTTASYNC_SUCCESS
+     *  	   if nothing failed.
+     */
+    int get_first_return_code() const;
+    /**
+     * Gets the reason code of the first token that failed.
+     * @return The MQTT v5 reason code of the first failure, or SUCCESS if
+     *  	   nothing failed.
+     */
+    ReasonCode get_first_reason_code() const;
+    /**
+     * Gets the error message of the first token that failed.
+     * @return The error message of the first failure, if any.
+     */
+    string get_first_error_message() const;
+    /**
+     * Waits until all the tokens in the group are complete.
+     */
+    void wait_all();
+    /**
+     * Waits a limited time for all the tokens in the group to complete.
+     * @param relTime The amount of time to wait.
+     * @return @em true if all the tokens completed, @em false on a
+     *  	   timeout.
+     */
+    template <class Rep, class Period>
+    bool wait_all_for(const std::chrono::duration<Rep, Period>& relTime) {
+        unique_lock g{lock()};
+        return cond().wait_for(g, relTime, [this] { return all_done(); });
+    }
+    /**
+     * Waits until a point in time for all the tokens in the group to
+     * complete.
+     * @param absTime The time point to wait until.
+     * @return @em true if all the tokens completed, @em false on a
+     *  	   timeout.
+     */
+    template <class Clock, class Duration>
+    bool wait_all_until(const std::chrono::time_point<Clock, Duration>& absTime) {
+        unique_lock g{lock()};
+        return cond().wait_until(g, absTime, [this] { return all_done(); });
+    }
+    /**
+     * Waits until any token in the group is complete.
+     * This returns right away if one already completed, or if the group is
+     * empty.
+     * @return The number of tokens that completed.
+     */
+    std::size_t wait_any();
+    /**
+     * Waits a limited time for any token in the group to complete.
+     * @param relTime The amount of time to wait.
+     * @return @em true if a token completed, @em false on a timeout.
+     */
+    template <class Rep, class Period>
+    bool wait_any_for(const std::chrono::duration<Rep, Period>& relTime) {
+        return wait_any_until(std::chrono::steady_clock::now() + relTime);
+    }
+    /**
+     * Waits until a point in time for any token in the group to complete.
+     * @param absTime The time point to wait until.
+     * @return @em true if a token completed, @em false on a timeout.
+     */
+    template <class Clock, class Duration>
+    bool wait_any_until(const std::chrono::time_point<Clock, Duration>& absTime) {
+        unique_lock g{lock()};
+        any_waiter(1);
+        bool ok = cond().wait_until(g, absTime, [this] { return any_done(); });
+        any_waiter(-1);
+        return ok;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_token_group_h
@@ -24,17 +24,22 @@
 #ifndef __mqtt_topic_h
 #define __mqtt_topic_h
 
+#include <cstdint>
+#include <string_view>
 #include <vector>
 
 #include "MQTTAsync.h"
 #include "mqtt/delivery_token.h"
 #include "mqtt/message.h"
 #include "mqtt/subscribe_options.h"
+#include "mqtt/topic_levels.h"
 #include "mqtt/types.h"
 
 namespace mqtt {
 
 class iasync_client;
+class async_client;
+class prepared_publisher;
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -169,6 +174,15 @@ public:
      * @return A token used to track the progress of the operation.
      */
     token_ptr subscribe(const subscribe_options& opts = subscribe_options());
+    /**
+     * Creates a publisher for this topic, with everything but the payload
+     * set up ahead of time.
+     * @param props The MQTT v5 properties for the messages.
+     * @return A publisher for the topic, with the default QoS and retained
+     *  	   flag of the topic.
+     * @sa prepared_publisher
+     */
+    prepared_publisher prepare(const properties& props = properties()) const;
     /**
      * Returns a string representation of this topic.
      * @return The name of the topic
@@ -182,6 +196,117 @@ using topic_ptr = topic::ptr_t;
 /** A smart/shared pointer to a const topic object. */
 using const_topic_ptr = topic::const_ptr_t;
 
+/////////////////////////////////////////////////////////////////////////////
+//  						Prepared Publisher
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Publishes messages to a single topic, with everything but the payload
+ * set up ahead of time.
+ *
+ * Each call to @ref topic::publish() makes a new, shared copy of the topic
+ * name for the message. A prepared publisher makes that once, along with
+ * the QoS, retained flag, and properties, so that each publish just wraps
+ * the payload. This is meant for apps that publish to the same set of
+ * topics over and over.
+ * @par
+ * For QoS 0, send() skips the message and the token entirely, when the
+ * client is an @ref async_client, and hands the prepared topic, flags, and
+ * properties straight to the C library.
+ * @par
+ * The publisher keeps a reference to the client, which must outlive it.
+ */
+class prepared_publisher
+{
+    /** The client that publishes the messages */
+    iasync_client& cli_;
+    /** The same client, if it's an async_client, for the fast path */
+    async_client* asyncCli_;
+    /** The shared topic name */
+    string_ref topic_;
+    /** The QoS for the messages */
+    int qos_;
+    /** The retained flag for the messages */
+    bool retained_;
+    /** The MQTT v5 properties for the messages */
+    properties props_;
+
+public:
+    /**
+     * Creates a publisher for a topic.
+     * @param cli The client that publishes the messages.
+     * @param topic The topic name.
+     * @param qos The QoS for the messages.
+     * @param retained The retained flag for the messages.
+     * @param props The MQTT v5 properties for the messages.
+     */
+    prepared_publisher(
+        iasync_client& cli, string_ref topic, int qos = message::DFLT_QOS,
+        bool retained = message::DFLT_RETAINED, const properties& props = properties()
+    );
+    /**
+     * Gets the client.
+     * @return The client that publishes the messages.
+     */
+    iasync_client& get_client() { return cli_; }
+    /**
+     * Gets the topic name.
+     * @return The topic name.
+     */
+    const string& get_topic() const { return topic_.str(); }
+    /**
+     * Gets the QoS for the messages.
+     * @return The QoS for the messages.
+     */
+    int get_qos() const { return qos_; }
+    /**
+     * Gets the retained flag for the messages.
+     * @return The retained flag for the messages.
+     */
+    bool get_retained() const { return retained_; }
+    /**
+     * Gets the properties for the messages.
+     * @return The properties for the messages.
+     */
+    const properties& get_properties() const { return props_; }
+    /**
+     * Creates a message for the topic, without publishing it.
+     * @param payload The payload.
+     * @return A message with the prepared topic, flags, and properties.
+     */
+    message_ptr make_message(binary_ref payload) const {
+        return message::create(topic_, std::move(payload), qos_, retained_, props_);
+    }
+    /**
+     * Publishes a message to the topic.
+     * @param payload The payload.
+     * @return The delivery token used to track and wait for the publish to
+     *  	   complete.
+     */
+    delivery_token_ptr publish(binary_ref payload);
+    /**
+     * Publishes a message to the topic.
+     * @param payload The bytes to use as the payload.
+     * @param n The number of bytes in the payload.
+     * @return The delivery token used to track and wait for the publish to
+     *  	   complete.
+     */
+    delivery_token_ptr publish(const void* payload, size_t n);
+    /**
+     * Publishes a message to the topic, without a way to track it.
+     *
+     * For QoS 0 on an @ref async_client, this uses
+     * @ref async_client::publish_qos0(), so the payload goes straight from
+     * the caller's memory without a message object or token. Otherwise
+     * it's the same as publish(), with the token dropped.
+     *
+     * @param payload The bytes to use as the payload.
+     * @param n The number of bytes in the payload.
+     * @throw exception if the library could not accept the message.
+     */
+    void send(const void* payload, size_t n);
+};
+
 /////////////////////////////////////////////////////////////////////////////
 //  						Topic Filter
 /////////////////////////////////////////////////////////////////////////////
@@ -199,8 +324,16 @@ using const_topic_ptr = topic::const_ptr_t;
  */
 class topic_filter
 {
-    /** We store the filter as a vector of the individual fields.  */
-    std::vector<string> fields_;
+    /** The filter string */
+    string filter_;
+    /**
+     * The fields of the filter, as offsets into the string. These are only
+     * needed, and only set, if the filter contains wildcards.
+     */
+    topic_levels fields_;
+
+    /** Gets a view of a field from the filter string */
+    std::string_view field_view(std::size_t i) const { return fields_.level(filter_, i); }
 
 public:
     /**
@@ -224,7 +357,7 @@ public:
 	 * @param s The string to check
 	 * @return @em true if `c` is a wildcard, "+" or "#"
 	 */
-	static bool is_wildcard(const string& s) {
+	static bool is_wildcard(std::string_view s) {
 		return s.size() == 1 && is_wildcard(s[0]);
 	}
     /**
@@ -242,14 +375,23 @@ public:
      *  	   if not.
      */
     bool has_wildcards() const;
+    /**
+     * Gets the filter string.
+     * @return The filter string.
+     */
+    const string& to_string() const { return filter_; }
     /**
      * Determine if the topic matches this filter.
      *
+     * A filter without wildcards is matched with a simple string
+     * comparison. Otherwise the topic is checked one field at a time,
+     * without making any copies of it.
+     *
      * @param topic An MQTT topic. It should not contain wildcards.
      * @return  @em true of the topic matches this filter, @em false
      *  		otherwise.
      */
-    bool matches(const string& topic) const;
+    bool matches(std::string_view topic) const;
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,172 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file topic_alias_manager.h
+/// Declaration of MQTT topic_alias_manager class, which assigns MQTT v5
+/// topic aliases to outgoing messages.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_topic_alias_manager_h
+#define __mqtt_topic_alias_manager_h
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "MQTTAsync.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Assigns MQTT v5 topic aliases to the topics of outgoing messages.
+ *
+ * The first message sent to a topic carries both the topic and a new
+ * alias, which sets up the alias on the server. Once the library has
+ * accepted that message, later ones to the same topic are sent with an
+ * empty topic and only the alias, which can save most of the bandwidth of
+ * small messages on long topics.
+ * @par
+ * The server decides how many aliases it accepts, with the Topic Alias
+ * Maximum in its CONNACK, and the aliases only last for one connection.
+ * So the manager is reset with the server's maximum each time the client
+ * connects. When all the aliases are in use, the one for the least
+ * recently used topic is taken for the new one.
+ * @par
+ * The async_client uses this for QoS 0 messages when a maximum number of
+ * aliases is set in its create_options. Messages with a higher QoS are not
+ * aliased, since the library may send them again on a later connection,
+ * where the alias would mean something else, or nothing at all.
+ */
+class topic_alias_manager
+{
+    /** Simple, scope-based lock guard */
+    using guard = std::lock_guard<std::mutex>;
+
+    /** A topic with an alias */
+    struct entry
+    {
+        /** The topic */
+        string topic;
+        /** The alias for the topic */
+        uint16_t alias;
+        /** Whether the alias was sent to the server with the topic */
+        bool established;
+    };
+
+    /** The entries, in order of use, most recent first */
+    using entry_list = std::list<entry>;
+
+    /** The most aliases that the client will use */
+    const uint16_t limit_;
+    /** Object lock, also held while sending, to keep the aliases in order */
+    mutable std::mutex lock_;
+    /** The most aliases that can be used on this connection */
+    uint16_t max_{0};
+    /** The entries, in order of use */
+    entry_list lru_;
+    /** The entries, by a view of their topic */
+    std::unordered_map<std::string_view, entry_list::iterator> index_;
+
+    /** Finds or assigns the entry for a topic, as the most recent (unsafe) */
+    entry& lookup(const string& topic);
+
+    topic_alias_manager(const topic_alias_manager&) = delete;
+    topic_alias_manager& operator=(const topic_alias_manager&) = delete;
+
+public:
+    /**
+     * Creates a manager.
+     * No aliases are used until it's reset with the server's maximum.
+     * @param limit The most aliases that the client will use, whatever the
+     *  			server allows.
+     */
+    explicit topic_alias_manager(uint16_t limit) : limit_{limit} {}
+    /**
+     * Gets the most aliases that the client will use.
+     * @return The most aliases that the client will use.
+     */
+    uint16_t get_limit() const { return limit_; }
+    /**
+     * Gets the most aliases that can be used on the current connection.
+     * @return The lesser of the client's limit and the server's maximum.
+     */
+    uint16_t get_maximum() const {
+        guard g{lock_};
+        return max_;
+    }
+    /**
+     * Gets the number of aliases that are assigned.
+     * @return The number of aliases that are assigned.
+     */
+    size_t size() const {
+        guard g{lock_};
+        return lru_.size();
+    }
+    /**
+     * Gets the alias assigned to a topic, if any.
+     * @param topic The topic.
+     * @return The alias for the topic, or zero if it doesn't have one.
+     */
+    uint16_t get_alias(const string& topic) const;
+    /**
+     * Forgets all the aliases, for a new connection.
+     * @param serverMax The Topic Alias Maximum from the server. Zero turns
+     *  				aliasing off.
+     */
+    void reset(uint16_t serverMax);
+    /**
+     * Sends a message with an alias for its topic, if possible.
+     *
+     * The function is called, with the manager locked, with the alias to
+     * use and whether it's already established. If the alias is zero, the
+     * message should be sent normally. If the alias is not established,
+     * the message should be sent with both the topic and the alias.
+     * Otherwise it should be sent with an empty topic and the alias. If
+     * the function returns success, the alias is taken to be established.
+     *
+     * @param topic The topic of the message.
+     * @param f The function that sends the message, taking the alias and
+     *  		whether it's established, and returning the library's
+     *  		return code.
+     * @return The return code from the function.
+     */
+    template <typename Func>
+    int send(const string& topic, Func&& f) {
+        guard g{lock_};
+        if (max_ == 0 || topic.empty())
+            return f(uint16_t(0), false);
+
+        auto& ent = lookup(topic);
+        int rc = f(ent.alias, ent.established);
+        if (rc == MQTTASYNC_SUCCESS)
+            ent.established = true;
+        return rc;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_topic_alias_manager_h
@@ -0,0 +1,133 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file topic_levels.h
+/// Declaration of MQTT topic_levels class, which finds the levels of a
+/// topic string.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_topic_levels_h
+#define __mqtt_topic_levels_h
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The locations of the levels in a topic or topic filter string.
+ *
+ * This splits a string around the '/' separators, the same way as
+ * @ref topic::split(), but rather than copying the levels into separate
+ * strings, it just records the offsets of the separators. The first
+ * @ref INLINE_LEVELS separators are kept in the object itself, so most
+ * topics can be split without any heap allocation.
+ *
+ * The scan for the separators uses SSE2 or NEON instructions, where they
+ * are available, to check 16 bytes at a time, with a plain loop as the
+ * fallback.
+ *
+ * The object only holds offsets, not a reference to the string, so the
+ * string must be supplied to get the text of a level. This keeps copies
+ * of the object valid for a copy of the string.
+ *
+ * As with @ref topic::split(), an empty string has no levels, and any
+ * other string has one more level than it has separators.
+ */
+class topic_levels
+{
+public:
+    /** The number of separators that are stored without allocating */
+    static constexpr std::size_t INLINE_LEVELS = 16;
+
+private:
+    /** The length of the string */
+    std::size_t len_{0};
+    /** The number of separators */
+    std::size_t nSeps_{0};
+    /** The offsets of the first separators */
+    std::array<uint32_t, INLINE_LEVELS> seps_;
+    /** The offsets of any separators past the ones that fit inline */
+    std::vector<uint32_t> moreSeps_;
+
+    /** Adds the offset of the next separator */
+    void add_separator(std::size_t pos) {
+        if (nSeps_ < INLINE_LEVELS)
+            seps_[nSeps_] = uint32_t(pos);
+        else
+            moreSeps_.push_back(uint32_t(pos));
+        ++nSeps_;
+    }
+    /** Gets the offset of the separator with the index */
+    std::size_t separator(std::size_t i) const {
+        return (i < INLINE_LEVELS) ? seps_[i] : moreSeps_[i - INLINE_LEVELS];
+    }
+
+public:
+    /**
+     * Creates an empty set of levels.
+     */
+    topic_levels() {}
+    /**
+     * Finds the levels in the string.
+     * @param topic The topic or filter string.
+     */
+    explicit topic_levels(std::string_view topic);
+    /**
+     * Gets the number of levels.
+     * @return The number of levels.
+     */
+    std::size_t size() const { return (len_ == 0) ? 0 : (nSeps_ + 1); }
+    /**
+     * Determines if there are no levels, which is only the case for an
+     * empty string.
+     * @return @em true if there are no levels, @em false otherwise.
+     */
+    bool empty() const { return len_ == 0; }
+    /**
+     * Gets the offset of the start of a level.
+     * @param i The index of the level.
+     * @return The offset of the start of the level in the string.
+     */
+    std::size_t level_begin(std::size_t i) const { return (i == 0) ? 0 : (separator(i - 1) + 1); }
+    /**
+     * Gets the offset just past the end of a level.
+     * @param i The index of the level.
+     * @return The offset just past the end of the level in the string.
+     */
+    std::size_t level_end(std::size_t i) const { return (i == nSeps_) ? len_ : separator(i); }
+    /**
+     * Gets the text of a level.
+     * @param topic The string that was split.
+     * @param i The index of the level.
+     * @return A view of the level in the string.
+     */
+    std::string_view level(std::string_view topic, std::size_t i) const {
+        auto pos = level_begin(i);
+        return topic.substr(pos, level_end(i) - pos);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_topic_levels_h
@@ -24,18 +24,24 @@
 #ifndef __mqtt_topic_matcher_h
 #define __mqtt_topic_matcher_h
 
-#include <forward_list>
+#include <algorithm>
+#include <cstdint>
 #include <initializer_list>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "mqtt/topic.h"
+#include "mqtt/topic_levels.h"
 #include "mqtt/types.h"
 
 namespace mqtt {
 
+template <typename T>
+class compiled_topic_matcher;
+
 /////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -103,6 +109,12 @@ namespace mqtt {
  * `topic_matcher::matches(string)` method. This is an optimized search
  * iterator for finding all the filters and values that match the specified
  * topic string.
+ *
+ * To match a lot of topics at once, like a batch of incoming messages,
+ * `topic_matcher::match_batch()` finds the matches for all of them into a
+ * reusable @ref batch_matches object. It sorts the topics, so that the
+ * ones with the same leading fields are next to each other, and only
+ * searches the trie once for each shared prefix.
  */
 template <typename T>
 class topic_matcher
@@ -124,7 +136,7 @@ private:
     struct node
     {
         using ptr_t = std::unique_ptr<node>;
-        using map_t = std::map<string, ptr_t>;
+        using map_t = std::map<string, ptr_t, std::less<>>;
 
         /** The value that matches the topic at this node, if any */
         value_ptr content;
@@ -133,6 +145,16 @@ private:
 
         /** Creates a new, empty node */
         static ptr_t create() { return std::make_unique<node>(); }
+        /** Creates a deep copy of this node and everything under it */
+        ptr_t clone() const {
+            auto nd = create();
+            if (content)
+                nd->content = std::make_unique<value_type>(*content);
+            for (const auto& child : children) {
+                nd->children.emplace(child.first, child.second->clone());
+            }
+            return nd;
+        }
         /** Determines if this node is empty (no content or children) */
         bool empty() const { return !content && children.empty(); }
 
@@ -278,19 +300,21 @@ public:
         {
             /** The current node being searched. */
             node* node_;
-            /** The fields of the topic still to be searched. */
-            std::forward_list<string> fields_;
+            /** The index of the next field of the topic to be searched. */
+            size_t level_;
             /** Whether this is the first/root node */
             bool first_;
 
-            search_node(node* nd, const std::forward_list<string>& sy, bool first = false)
-                : node_{nd}, fields_{sy}, first_{first} {}
-            search_node(node* nd, std::forward_list<string>&& sy, bool first = false)
-                : node_{nd}, fields_{std::move(sy)}, first_{first} {}
+            search_node(node* nd, size_t level, bool first = false)
+                : node_{nd}, level_{level}, first_{first} {}
         };
 
         /** The last-found value */
         value_type* pval_;
+        /** The topic being matched */
+        string topic_;
+        /** The locations of the fields in the topic */
+        topic_levels levels_;
         /** The nodes still to be checked, used as a stack */
         std::vector<search_node> nodes_;
 
@@ -309,12 +333,12 @@ public:
                 return;
 
             // Get the next node to search.
-            auto snode = std::move(nodes_.back());
+            auto snode = nodes_.back();
             nodes_.pop_back();
 
             // If we're at the end of the topic fields, we either have a value,
             // or need to move on to the next node to search.
-            if (snode.fields_.empty()) {
+            if (snode.level_ == levels_.size()) {
                 pval_ = snode.node_->content.get();
                 if (!pval_)
                     this->next();
@@ -322,15 +346,15 @@ public:
             }
 
             // Get the next field of the topic to search
-            auto field = std::move(snode.fields_.front());
-            snode.fields_.pop_front();
+            auto field = levels_.level(topic_, snode.level_);
+            auto level = snode.level_ + 1;
 
             typename node_map::iterator child;
             const auto map_end = snode.node_->children.end();
 
             // Look for an exact match
             if ((child = snode.node_->children.find(field)) != map_end) {
-                nodes_.push_back({child->second.get(), snode.fields_});
+                nodes_.push_back({child->second.get(), level});
             }
 
             // Topics starting with '$' don't match wildcards in the first field
@@ -340,7 +364,7 @@ public:
             if (!snode.first_ || field.empty() || field[0] != '$') {
                 // Look for a single-field wildcard match
                 if ((child = snode.node_->children.find("+")) != map_end) {
-                    nodes_.push_back({child->second.get(), snode.fields_});
+                    nodes_.push_back({child->second.get(), level});
                 }
 
                 // Look for a terminating match
@@ -358,10 +382,9 @@ public:
 
         match_iterator() : pval_{nullptr} {}
         match_iterator(value_type* pval) : pval_{pval} {}
-        match_iterator(node* root, const string& topic) : pval_{nullptr} {
-            auto v = topic::split(topic);
-            std::forward_list<string> fields{v.begin(), v.end()};
-            nodes_.push_back(search_node{root, std::move(fields), true});
+        match_iterator(node* root, const string& topic)
+            : pval_{nullptr}, topic_{topic}, levels_{topic_} {
+            nodes_.push_back(search_node{root, 0, true});
             next();
         }
 
@@ -438,6 +461,116 @@ public:
         const value_type* operator->() const noexcept { return base::operator->(); }
     };
 
+    /**
+     * The matches for a batch of topics, from match_batch().
+     *
+     * This holds the matching values of each topic, in the order that the
+     * topics were given, along with the working space for the search. It
+     * should be kept and reused from one batch to the next, so that once
+     * it has grown to the size of the batches, matching them doesn't
+     * allocate any memory.
+     * @par
+     * The results point into the collection, so they're only good until
+     * it's next changed.
+     */
+    class batch_matches
+    {
+    public:
+        /** The matching values of one topic */
+        class range
+        {
+            const value_type* const* begin_;
+            const value_type* const* end_;
+
+            friend class batch_matches;
+            range(const value_type* const* b, const value_type* const* e) : begin_{b}, end_{e} {}
+
+        public:
+            /** Gets an iterator to the first matching value */
+            const value_type* const* begin() const noexcept { return begin_; }
+            /** Gets an iterator past the last matching value */
+            const value_type* const* end() const noexcept { return end_; }
+            /** Gets the number of matching values */
+            size_t size() const noexcept { return size_t(end_ - begin_); }
+            /** Determines if there were no matches */
+            bool empty() const noexcept { return begin_ == end_; }
+        };
+
+    private:
+        /** The matching values of all the topics, in the order searched */
+        std::vector<const value_type*> vals_;
+        /** The offset and count of each topic's values, in the order given */
+        std::vector<std::pair<uint32_t, uint32_t>> spans_;
+
+        /** The topics of the batch */
+        std::vector<std::string_view> topics_;
+        /** The order to search the topics, sorted by topic */
+        std::vector<uint32_t> order_;
+        /** The fields of the current and previous topics */
+        std::vector<std::string_view> fields_, prevFields_;
+        /** The nodes reached at each level of the current topic */
+        std::vector<node*> nodes_;
+        /** The index in nodes_ where each level starts */
+        std::vector<size_t> levelStart_;
+        /** The '#' values found at each level of the current topic */
+        std::vector<const value_type*> hashVals_;
+        /** The index in hashVals_ where each level starts */
+        std::vector<size_t> hashStart_;
+
+        friend class topic_matcher;
+
+        /** Splits a topic into its fields */
+        static void split(std::string_view topic, std::vector<std::string_view>& fields) {
+            fields.clear();
+            if (topic.empty())
+                return;
+            for (size_t pos = 0;;) {
+                auto sep = topic.find('/', pos);
+                if (sep == std::string_view::npos) {
+                    fields.push_back(topic.substr(pos));
+                    return;
+                }
+                fields.push_back(topic.substr(pos, sep - pos));
+                pos = sep + 1;
+            }
+        }
+
+    public:
+        /**
+         * Gets the number of topics in the batch.
+         * @return The number of topics in the batch.
+         */
+        size_t size() const noexcept { return spans_.size(); }
+        /**
+         * Gets the total number of matches for all the topics.
+         * @return The total number of matches.
+         */
+        size_t num_matches() const noexcept { return vals_.size(); }
+        /**
+         * Gets the matching values of a topic, in no particular order.
+         * @param i The index of the topic in the batch.
+         * @return The matching values.
+         */
+        range operator[](size_t i) const noexcept {
+            const auto& sp = spans_[i];
+            auto p = vals_.data() + sp.first;
+            return range{p, p + sp.second};
+        }
+        /**
+         * Determines if a topic had any matches.
+         * @param i The index of the topic in the batch.
+         * @return @em true if the topic had at least one match.
+         */
+        bool has_match(size_t i) const noexcept { return spans_[i].second != 0; }
+        /**
+         * Removes the results, keeping the memory for the next batch.
+         */
+        void clear() noexcept {
+            vals_.clear();
+            spans_.clear();
+        }
+    };
+
     /**
      * Creates  new, empty collection.
      */
@@ -461,6 +594,23 @@ public:
             insert(v);
         }
     }
+    /**
+     * Creates a copy of another collection.
+     * This makes a deep copy of all the filters and values.
+     * @param other The collection to copy.
+     */
+    topic_matcher(const topic_matcher& other) : root_(other.root_->clone()) {}
+    /**
+     * Copy assignment.
+     * This makes a deep copy of all the filters and values.
+     * @param rhs The collection to copy.
+     * @return A reference to this collection.
+     */
+    topic_matcher& operator=(const topic_matcher& rhs) {
+        if (&rhs != this)
+            root_ = rhs.root_->clone();
+        return *this;
+    }
     /**
      * Determines if the collection is empty.
      * @return @em true if the collection is empty, @em false if it contains
@@ -504,10 +654,10 @@ public:
      */
     mapped_ptr remove(const key_type& filter) {
         auto nd = root_.get();
-        auto fields = topic::split(filter);
+        topic_levels fields{filter};
 
-        for (auto& field : fields) {
-            auto it = nd->children.find(field);
+        for (size_t i = 0; i < fields.size(); ++i) {
+            auto it = nd->children.find(fields.level(filter, i));
             if (it == nd->children.end())
                 return mapped_ptr{};
 
@@ -556,10 +706,10 @@ public:
      */
     iterator find(const key_type& filter) {
         auto nd = root_.get();
-        auto fields = topic::split(filter);
+        topic_levels fields{filter};
 
-        for (auto& field : fields) {
-            auto it = nd->children.find(field);
+        for (size_t i = 0; i < fields.size(); ++i) {
+            auto it = nd->children.find(fields.level(filter, i));
             if (it == nd->children.end())
                 return end();
             nd = it->second.get();
@@ -614,6 +764,117 @@ public:
      *         collection.
      */
     bool has_match(const string& topic) { return matches(topic) != matches_cend(); }
+    /**
+     * Finds the matches for a batch of topics, all at once.
+     * This gets the same values for each topic as matches(), but the
+     * topics are searched in sorted order, and the part of the search for
+     * the leading fields that a topic shares with the one before it is
+     * reused, so a batch with a lot of topics under the same few prefixes
+     * is matched much faster than one at a time.
+     * @param first Iterator to the first topic. The topics can be any
+     *  			type that converts to a std::string_view, and must
+     *  			stay valid during the call.
+     * @param last Iterator past the last topic.
+     * @param out Gets the matches for each topic. Anything in it is
+     *  		  cleared first.
+     */
+    template <typename InputIt>
+    void match_batch(InputIt first, InputIt last, batch_matches& out) const {
+        out.clear();
+        out.topics_.clear();
+        for (; first != last; ++first) out.topics_.emplace_back(std::string_view(*first));
+
+        const auto n = out.topics_.size();
+        out.spans_.resize(n);
+        out.order_.resize(n);
+        for (size_t i = 0; i < n; ++i) out.order_[i] = uint32_t(i);
+
+        const auto& topics = out.topics_;
+        std::sort(out.order_.begin(), out.order_.end(), [&topics](uint32_t a, uint32_t b) {
+            return topics[a] < topics[b];
+        });
+
+        auto& fields = out.fields_;
+        auto& nodes = out.nodes_;
+        auto& levelStart = out.levelStart_;
+        auto& hashVals = out.hashVals_;
+        auto& hashStart = out.hashStart_;
+
+        // The search state of the previous topic is good through the
+        // levels of the fields the two topics have in common.
+        out.prevFields_.clear();
+        nodes.assign(1, root_.get());
+        levelStart.assign({0, 1});
+        hashVals.clear();
+        hashStart.assign(1, 0);
+
+        for (auto idx : out.order_) {
+            std::swap(fields, out.prevFields_);
+            batch_matches::split(topics[idx], fields);
+
+            size_t lvl = 0;
+            const auto nPrev = out.prevFields_.size();
+            while (lvl < fields.size() && lvl < nPrev && fields[lvl] == out.prevFields_[lvl])
+                ++lvl;
+
+            nodes.resize(levelStart[lvl + 1]);
+            levelStart.resize(lvl + 2);
+            hashVals.resize(hashStart[lvl]);
+            hashStart.resize(lvl + 1);
+
+            for (; lvl < fields.size(); ++lvl) {
+                const auto field = fields[lvl];
+                // Topics starting with '$' don't match wildcards in the first field
+                const bool wild = lvl != 0 || field.empty() || field[0] != '$';
+
+                for (auto i = levelStart[lvl]; i < levelStart[lvl + 1]; ++i) {
+                    const auto& children = nodes[i]->children;
+                    const auto map_end = children.end();
+                    typename node_map::const_iterator child;
+
+                    if ((child = children.find(field)) != map_end)
+                        nodes.push_back(child->second.get());
+
+                    if (wild) {
+                        if ((child = children.find("+")) != map_end)
+                            nodes.push_back(child->second.get());
+                        if ((child = children.find("#")) != map_end && child->second->content)
+                            hashVals.push_back(child->second->content.get());
+                    }
+                }
+                levelStart.push_back(nodes.size());
+                hashStart.push_back(hashVals.size());
+            }
+
+            // The values are those at the last level, and any '#' found on
+            // the way down.
+            const auto off = out.vals_.size();
+            for (auto i = levelStart[lvl]; i < levelStart[lvl + 1]; ++i) {
+                if (auto pval = nodes[i]->content.get())
+                    out.vals_.push_back(pval);
+            }
+            out.vals_.insert(out.vals_.end(), hashVals.begin(), hashVals.end());
+            out.spans_[idx] = {uint32_t(off), uint32_t(out.vals_.size() - off)};
+        }
+    }
+    /**
+     * Finds the matches for a batch of topics, all at once.
+     * @param topics The topics, in a container of any type that converts
+     *  			 to a std::string_view.
+     * @param out Gets the matches for each topic, in the same order.
+     * @sa match_batch(InputIt, InputIt, batch_matches&)
+     */
+    template <typename Container>
+    void match_batch(const Container& topics, batch_matches& out) const {
+        match_batch(std::begin(topics), std::end(topics), out);
+    }
+    /**
+     * Creates an immutable copy of the collection that is optimized for
+     * searching.
+     * This requires including "mqtt/compiled_topic_matcher.h".
+     * @return A compiled copy of the collection.
+     */
+    compiled_topic_matcher<T> freeze() const;
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,251 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file topic_stats.h
+/// Declaration of MQTT topic_stats class, which counts the traffic of a
+/// client by topic filter and topic prefix.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_topic_stats_h
+#define __mqtt_topic_stats_h
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+#include "mqtt/topic_matcher.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Counts the messages and bytes that a client sends and receives, by
+ * topic filter, and by topic prefix, to show which parts of the topic
+ * tree are busy, without logging every message.
+ *
+ * The filters to count are added up front, like "sensors/#" or
+ * "cmd/+/reply". Each message is counted by every filter that matches its
+ * topic. With a prefix depth, the stats also count each distinct prefix
+ * of that many levels as it shows up, so with a depth of two, a message on
+ * "plant/line4/temp" is counted under "plant/line4/#", up to a limit on
+ * the number of prefixes.
+ * @par
+ * The filters and prefixes are kept in a topic_matcher, so counting a
+ * message is a single walk of the trie. The counters are relaxed atomics,
+ * split into shards, each used by some of the threads, so that the
+ * callback and publishing threads don't contend for the same cache
+ * lines. A snapshot adds up the shards, and may be slightly out of step
+ * with messages that are counted while it's taken.
+ * @par
+ * The stats are normally installed on a client with
+ * `async_client::set_topic_stats()`, which counts the messages as they
+ * are received, and as they are handed to the C library to be sent.
+ */
+class topic_stats
+{
+public:
+    /** Smart/shared pointer to an object of this class */
+    using ptr_t = std::shared_ptr<topic_stats>;
+    /** The clock for the time a filter last saw a message */
+    using clock = std::chrono::steady_clock;
+    /** A point in time */
+    using time_point = clock::time_point;
+
+    /** The number of shards for each counter */
+    static constexpr size_t N_SHARDS = 8;
+    /** The default most prefixes to count */
+    static constexpr size_t DFLT_MAX_PREFIXES = 1024;
+
+    /** The counts for one direction */
+    struct counts
+    {
+        /** The number of messages */
+        uint64_t msgs{0};
+        /** The number of payload bytes */
+        uint64_t bytes{0};
+        /** The time of the last message, or the epoch if there was none */
+        time_point lastSeen{};
+    };
+
+    /** A snapshot of the counts for a filter or prefix */
+    struct entry
+    {
+        /** The filter */
+        string filter;
+        /** Whether this is a prefix that was found, or a filter that was added */
+        bool prefix{false};
+        /** The counts of the messages sent */
+        counts sent;
+        /** The counts of the messages received */
+        counts received;
+    };
+
+private:
+    /** One shard of the counts for a direction */
+    struct alignas(64) shard
+    {
+        std::atomic<uint64_t> msgs{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    /** The counters for a direction */
+    struct direction
+    {
+        shard shards[N_SHARDS];
+        std::atomic<clock::rep> lastSeen{0};
+
+        void add(size_t idx, size_t n, time_point now);
+        counts get() const;
+        void reset();
+    };
+
+    /** The counters for a filter or prefix */
+    struct counters
+    {
+        bool prefix{false};
+        direction sent;
+        direction received;
+    };
+
+    /** Exclusive lock, for adding to the trie */
+    using unique_lock = std::unique_lock<std::shared_mutex>;
+    /** Shared lock, for counting and reading */
+    using shared_lock = std::shared_lock<std::shared_mutex>;
+
+    /** The number of topic levels for the prefixes, or zero for none */
+    const unsigned prefixDepth_;
+    /** The most prefixes to count */
+    const size_t maxPrefixes_;
+    /** Lock for the trie */
+    mutable std::shared_mutex lock_;
+    /** The counters for the filters and prefixes */
+    topic_matcher<std::shared_ptr<counters>> trie_;
+    /** The number of filters that were added */
+    size_t nFilters_{0};
+    /** The number of prefixes that were found */
+    size_t nPrefixes_{0};
+    /** The number of messages whose prefix wasn't counted, for the limit */
+    std::atomic<uint64_t> nOverflow_{0};
+
+    /** Gets the shard for the calling thread */
+    static size_t shard_index();
+    /** Counts a message in one direction */
+    void count(bool sent, const string& topic, size_t n, time_point now);
+    /** Makes a snapshot of the counters for a filter */
+    static entry make_entry(const string& filter, const counters& ctrs);
+
+public:
+    /**
+     * Creates the stats.
+     * @param prefixDepth The number of topic levels for the prefixes that
+     *  				  are counted as they show up, or zero to only count
+     *  				  the filters that are added.
+     * @param maxPrefixes The most prefixes to count. Messages with new
+     *  				  prefixes past this are only counted by the
+     *  				  filters.
+     */
+    explicit topic_stats(unsigned prefixDepth = 0, size_t maxPrefixes = DFLT_MAX_PREFIXES)
+        : prefixDepth_{prefixDepth}, maxPrefixes_{maxPrefixes} {}
+
+    topic_stats(const topic_stats&) = delete;
+    topic_stats& operator=(const topic_stats&) = delete;
+
+    /**
+     * Adds a topic filter to count.
+     * Adding a filter that's already counted does nothing.
+     * @param filter The topic filter.
+     */
+    void add_filter(const string& filter);
+    /**
+     * Gets the number of topic levels for the prefixes.
+     * @return The prefix depth, or zero if prefixes aren't counted.
+     */
+    unsigned get_prefix_depth() const { return prefixDepth_; }
+    /**
+     * Counts a message that was sent.
+     * @param topic The topic of the message.
+     * @param n The size of the payload.
+     * @param now The current time.
+     */
+    void on_sent(const string& topic, size_t n, time_point now = clock::now()) {
+        count(true, topic, n, now);
+    }
+    /**
+     * Counts a message that was received.
+     * @param topic The topic of the message.
+     * @param n The size of the payload.
+     * @param now The current time.
+     */
+    void on_received(const string& topic, size_t n, time_point now = clock::now()) {
+        count(false, topic, n, now);
+    }
+    /**
+     * Gets a snapshot of the counts of all the filters and prefixes.
+     * @return The counts, in the order of the topic tree.
+     */
+    std::vector<entry> snapshot() const;
+    /**
+     * Gets a snapshot of the counts of one filter or prefix.
+     * A prefix is named as a filter, like "plant/line4/#".
+     * @param filter The filter.
+     * @return The counts, if the filter is counted.
+     */
+    std::optional<entry> get(const string& filter) const;
+    /**
+     * Gets the number of filters that were added.
+     * @return The number of filters.
+     */
+    size_t num_filters() const {
+        shared_lock g{lock_};
+        return nFilters_;
+    }
+    /**
+     * Gets the number of prefixes that were found.
+     * @return The number of prefixes.
+     */
+    size_t num_prefixes() const {
+        shared_lock g{lock_};
+        return nPrefixes_;
+    }
+    /**
+     * Gets the number of messages whose prefix wasn't counted, because
+     * the most prefixes were already counted.
+     * @return The number of messages over the prefix limit.
+     */
+    uint64_t num_overflow() const { return nOverflow_.load(std::memory_order_relaxed); }
+    /**
+     * Sets all the counts back to zero.
+     * The filters and prefixes are kept.
+     */
+    void reset();
+};
+
+/** Smart/shared pointer to a topic_stats */
+using topic_stats_ptr = topic_stats::ptr_t;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_topic_stats_h
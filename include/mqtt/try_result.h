@@ -0,0 +1,151 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file try_result.h
+/// Declaration of MQTT try_result class, the result of a client call that
+/// reports its errors rather than throwing them.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_try_result_h
+#define __mqtt_try_result_h
+
+#include <utility>
+
+#include "MQTTAsync.h"
+#include "mqtt/delivery_token.h"
+#include "mqtt/exception.h"
+#include "mqtt/token.h"
+#include "mqtt/types.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The result of a client call that doesn't throw on a runtime error, like
+ * `async_client::try_publish()`.
+ *
+ * It holds either the value of the call, usually a token, or the error
+ * that an exception would have carried: the return code, the reason code,
+ * and an optional fixed message. Nothing is allocated for an error, so a
+ * client that's turning away thousands of publishes a second, because its
+ * buffers are full, doesn't make its overload worse by building and
+ * unwinding an exception for each of them.
+ * @code
+ * auto res = cli.try_publish(msg);
+ * if (!res) {
+ *     if (res.get_return_code() == MQTTASYNC_MAX_BUFFERED_MESSAGES)
+ *         ...back off...
+ * }
+ * @endcode
+ * An error can still be turned into the exception with value() or
+ * to_exception(), when it's no longer on the hot path.
+ */
+template <class T>
+class try_result
+{
+    /** The value, for a success */
+    T val_{};
+    /** The return code */
+    int rc_{MQTTASYNC_SUCCESS};
+    /** The reason code */
+    ReasonCode reasonCode_{ReasonCode::SUCCESS};
+    /** A static message for the error, if any */
+    const char* msg_{nullptr};
+
+public:
+    /**
+     * Creates a successful result.
+     * @param val The value.
+     */
+    try_result(T val) : val_{std::move(val)} {}
+    /**
+     * Creates a failed result.
+     * @param rc The error return code.
+     * @param reasonCode The reason code, if any.
+     * @param msg A message for the error, which must have static storage
+     *  		  duration, or @em nullptr for the text of the return code.
+     * @return The failed result.
+     */
+    static try_result error(
+        int rc, ReasonCode reasonCode = ReasonCode::SUCCESS, const char* msg = nullptr
+    ) {
+        try_result res{T{}};
+        res.rc_ = rc;
+        res.reasonCode_ = reasonCode;
+        res.msg_ = msg;
+        return res;
+    }
+    /**
+     * Determines if the call succeeded.
+     * @return @em true if the call succeeded.
+     */
+    bool ok() const noexcept { return rc_ == MQTTASYNC_SUCCESS; }
+    /**
+     * Determines if the call succeeded.
+     * @return @em true if the call succeeded.
+     */
+    explicit operator bool() const noexcept { return ok(); }
+    /**
+     * Gets the return code.
+     * @return The return code, which is @em MQTTASYNC_SUCCESS for a
+     *  	   success.
+     */
+    int get_return_code() const noexcept { return rc_; }
+    /**
+     * Gets the reason code.
+     * @return The reason code.
+     */
+    ReasonCode get_reason_code() const noexcept { return reasonCode_; }
+    /**
+     * Gets the message for the error.
+     * @return The message, or the text for the return code.
+     */
+    string get_message() const { return msg_ ? string{msg_} : exception::error_str(rc_); }
+    /**
+     * Gets the value, without checking for an error.
+     * @return The value, which is empty for an error.
+     */
+    const T& get() const noexcept { return val_; }
+    /**
+     * Gets the value.
+     * @return The value.
+     * @throw exception if the call failed.
+     */
+    const T& value() const {
+        if (!ok())
+            throw to_exception();
+        return val_;
+    }
+    /**
+     * Gets the exception for the error, as the throwing call would have
+     * thrown it.
+     * @return The exception.
+     */
+    exception to_exception() const { return exception(rc_, reasonCode_, get_message()); }
+};
+
+/** The result of a publish that doesn't throw */
+using publish_result = try_result<delivery_token_ptr>;
+/** The result of a subscribe or unsubscribe that doesn't throw */
+using token_result = try_result<token_ptr>;
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_try_result_h
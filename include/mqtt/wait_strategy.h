@@ -0,0 +1,232 @@
+/////////////////////////////////////////////////////////////////////////////
+/// @file wait_strategy.h
+/// Declaration of MQTT wait_strategy class, which sets how a thread waits
+/// on a queue or token: by blocking, by spinning, or a mix of the two.
+/// @date 14-Oct-2026
+/////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_wait_strategy_h
+#define __mqtt_wait_strategy_h
+
+#include <chrono>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * How a thread waits for an item in a @ref thread_queue, or for a
+ * @ref token to complete.
+ *
+ * By default, a waiting thread blocks on a condition variable right away,
+ * and is woken by the thread that puts the item or completes the action.
+ * That doesn't use any CPU while waiting, but waking a thread through the
+ * OS takes tens of microseconds, sometimes a lot more. A thread that has a
+ * core to itself can get the item within about a microsecond by spinning
+ * on it instead:
+ *
+ * @li @em PARK blocks right away. This is the default.
+ * @li @em SPIN spins until the item arrives or the time is up, and never
+ *     blocks. It keeps the core busy the whole time.
+ * @li @em SPIN_YIELD spins for the budget, then keeps checking, but yields
+ *     the core to other threads between checks.
+ * @li @em SPIN_PARK spins for the budget, then blocks. This catches the
+ *     items that come quickly, at the cost of the budget in CPU time for
+ *     the ones that don't.
+ *
+ * The spinning modes are only worth it when the waiting thread is pinned
+ * to a core that has nothing else to do, like with @ref thread_options.
+ * @code
+ * cli.set_wait_strategy(mqtt::wait_strategy::spin_park(microseconds(200)));
+ * @endcode
+ */
+class wait_strategy
+{
+public:
+    /** The way to wait */
+    enum mode {
+        /** Block right away */
+        PARK,
+        /** Spin until done, never blocking */
+        SPIN,
+        /** Spin for the budget, then yield between checks */
+        SPIN_YIELD,
+        /** Spin for the budget, then block */
+        SPIN_PARK
+    };
+
+    /** The default time to spin before yielding or blocking */
+    static constexpr std::chrono::microseconds DFLT_SPIN_BUDGET{50};
+
+private:
+    /** The number of spins between looks at the clock */
+    static constexpr unsigned CLOCK_INTERVAL = 64;
+
+    /** The way to wait */
+    mode mode_{PARK};
+    /** The time to spin before yielding or blocking */
+    std::chrono::nanoseconds budget_{DFLT_SPIN_BUDGET};
+
+public:
+    /**
+     * Creates the default strategy, which blocks right away.
+     */
+    constexpr wait_strategy() noexcept {}
+    /**
+     * Creates a strategy.
+     * @param m The way to wait.
+     * @param budget The time to spin before yielding or blocking, for the
+     *  			 @em SPIN_YIELD and @em SPIN_PARK modes.
+     */
+    constexpr wait_strategy(mode m, std::chrono::nanoseconds budget = DFLT_SPIN_BUDGET) noexcept
+        : mode_{m}, budget_{budget} {}
+    /**
+     * Gets a strategy that blocks right away.
+     * @return A strategy that blocks right away.
+     */
+    static constexpr wait_strategy park() noexcept { return wait_strategy{}; }
+    /**
+     * Gets a strategy that only spins.
+     * @return A strategy that only spins.
+     */
+    static constexpr wait_strategy spin() noexcept { return wait_strategy{SPIN}; }
+    /**
+     * Gets a strategy that spins, then yields between checks.
+     * @param budget The time to spin before yielding.
+     * @return A strategy that spins, then yields.
+     */
+    static constexpr wait_strategy spin_yield(
+        std::chrono::nanoseconds budget = DFLT_SPIN_BUDGET
+    ) noexcept {
+        return wait_strategy{SPIN_YIELD, budget};
+    }
+    /**
+     * Gets a strategy that spins, then blocks.
+     * @param budget The time to spin before blocking.
+     * @return A strategy that spins, then blocks.
+     */
+    static constexpr wait_strategy spin_park(
+        std::chrono::nanoseconds budget = DFLT_SPIN_BUDGET
+    ) noexcept {
+        return wait_strategy{SPIN_PARK, budget};
+    }
+    /**
+     * Gets the way to wait.
+     * @return The way to wait.
+     */
+    constexpr mode get_mode() const noexcept { return mode_; }
+    /**
+     * Gets the time to spin before yielding or blocking.
+     * @return The spin budget.
+     */
+    constexpr std::chrono::nanoseconds get_budget() const noexcept { return budget_; }
+    /**
+     * Determines if a waiter spins at all.
+     * @return @em true if the mode is anything but @em PARK.
+     */
+    constexpr bool spins() const noexcept { return mode_ != PARK; }
+    /**
+     * Determines if a waiter ever blocks.
+     * @return @em true for @em PARK and @em SPIN_PARK.
+     */
+    constexpr bool parks() const noexcept { return mode_ == PARK || mode_ == SPIN_PARK; }
+    /**
+     * Tells the CPU that the thread is in a spin loop, which saves power
+     * and lets the other hardware thread on the core run.
+     */
+    static void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+        __asm__ __volatile__("yield");
+#endif
+    }
+    /**
+     * Gets the time that's a relative time from now, on the steady clock,
+     * stopping at the end of the clock for very long times.
+     * @param relTime The relative time.
+     * @return The absolute time.
+     */
+    template <typename Rep, class Period>
+    static std::chrono::steady_clock::time_point deadline_after(
+        const std::chrono::duration<Rep, Period>& relTime
+    ) {
+        using clock = std::chrono::steady_clock;
+        using fsec = std::chrono::duration<double>;
+
+        auto now = clock::now();
+        if (fsec(relTime) >= fsec(clock::time_point::max() - now))
+            return clock::time_point::max();
+        return now + std::chrono::duration_cast<clock::duration>(relTime);
+    }
+    /**
+     * Spins until a condition is met, as the mode calls for.
+     * This only returns early, without the condition, when the time runs
+     * out, or when the budget runs out in the @em SPIN_PARK mode, after
+     * which the caller should block. The @em PARK mode doesn't spin at
+     * all.
+     * @param pred The condition, which is checked without any lock, so it
+     *  		   should only read an atomic flag or the like.
+     * @param absTime The time to give up.
+     * @return @em true if the condition was met, @em false if not.
+     */
+    template <typename Pred, class Clock, class Duration>
+    bool spin_until(Pred pred, const std::chrono::time_point<Clock, Duration>& absTime) const {
+        using clock = std::chrono::steady_clock;
+
+        if (mode_ == PARK)
+            return pred();
+
+        const auto budgetEnd = (mode_ == SPIN) ? clock::time_point::max() : deadline_after(budget_);
+        bool yielding = false;
+
+        for (unsigned i = 1;; ++i) {
+            if (pred())
+                return true;
+
+            // The clocks are only read now and then while spinning
+            if (yielding || i % CLOCK_INTERVAL == 0) {
+                if (Clock::now() >= absTime)
+                    return false;
+                if (!yielding && clock::now() >= budgetEnd) {
+                    if (mode_ == SPIN_PARK)
+                        return false;
+                    yielding = true;
+                }
+            }
+
+            if (yielding)
+                std::this_thread::yield();
+            else
+                cpu_relax();
+        }
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
+
+#endif  // __mqtt_wait_strategy_h
@@ -0,0 +1,77 @@
+// ack_tracker.cpp
+//
+// Implementation of the ack_tracker class for the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/ack_tracker.h"
+
+#include <vector>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							ack_tracker
+/////////////////////////////////////////////////////////////////////////////
+
+bool ack_tracker::track(const message_ptr& msg)
+{
+    if (!msg || msg->get_qos() == 0)
+        return false;
+
+    guard g{lock_};
+    msg->ackTracker_ = weak_from_this();
+    msg->ackSeq_ = baseSeq_ + slots_.size();
+    slots_.push_back({msg, false});
+    return true;
+}
+
+// The released prefix is popped and handed to the handler under the
+// release lock, so that two threads that ack at once can't deliver their
+// releases out of order. The handler runs outside of the main lock, so
+// new messages can still be tracked while it works.
+
+std::size_t ack_tracker::ack(uint64_t seq)
+{
+    std::lock_guard<std::mutex> rg{releaseLock_};
+
+    std::vector<const_message_ptr> released;
+    release_handler cb;
+    {
+        guard g{lock_};
+        if (seq < baseSeq_ || seq - baseSeq_ >= slots_.size())
+            return 0;
+
+        slots_[size_t(seq - baseSeq_)].acked = true;
+
+        while (!slots_.empty() && slots_.front().acked) {
+            released.push_back(std::move(slots_.front().msg));
+            slots_.pop_front();
+            ++baseSeq_;
+        }
+        cb = releaseHandler_;
+    }
+
+    if (cb) {
+        for (const auto& msg : released) cb(msg);
+    }
+    return released.size();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
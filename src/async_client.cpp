@@ -19,15 +19,20 @@
 
 #include "mqtt/async_client.h"
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <mutex>
+#include <random>
 #include <thread>
+#include <utility>
 
 #include "mqtt/disconnect_options.h"
+#include "mqtt/endpoint_racer.h"
 #include "mqtt/message.h"
+#include "mqtt/probes.h"
 #include "mqtt/response_options.h"
 #include "mqtt/token.h"
 
@@ -67,8 +72,19 @@ void async_client::create()
         );
     }
     else {
+        iclient_persistence* userPersist = *userp;
+
+        if (auto interval = opts.get_persistence_commit_interval(); interval.count() > 0) {
+            auto maxBytes = opts.get_persistence_commit_bytes();
+            groupCommit_.reset(new group_commit_persistence{
+                *userPersist, interval,
+                maxBytes ? maxBytes : group_commit_persistence::DFLT_MAX_BYTES
+            });
+            userPersist = groupCommit_.get();
+        }
+
         persist_.reset(new MQTTClient_persistence{
-            *userp, &iclient_persistence::persistence_open,
+            userPersist, &iclient_persistence::persistence_open,
             &iclient_persistence::persistence_close, &iclient_persistence::persistence_put,
             &iclient_persistence::persistence_get, &iclient_persistence::persistence_remove,
             &iclient_persistence::persistence_keys, &iclient_persistence::persistence_clear,
@@ -82,9 +98,42 @@ void async_client::create()
     }
     if (rc != MQTTASYNC_SUCCESS)
         throw exception(rc);
+
+    if (auto delay = opts.get_publish_coalescing_delay(); delay.count() > 0) {
+        auto maxBytes = opts.get_publish_coalescing_bytes();
+        coalescer_.reset(new publish_coalescer{
+            delay, maxBytes ? maxBytes : publish_coalescer::DFLT_MAX_BYTES
+        });
+    }
+
+    if (auto n = opts.get_max_topic_aliases(); n > 0)
+        aliases_.reset(new topic_alias_manager{n});
 }
 
-async_client::~async_client() { MQTTAsync_destroy(&cli_); }
+async_client::~async_client()
+{
+    stop_reconnect(true);
+
+    // Finish with any held messages while the client can still complete them
+    stop_publish_retry();
+    stop_offline_buffering();
+    stop_rate_limiting();
+    stop_adaptive_inflight();
+    coalescer_.reset();
+    MQTTAsync_destroy(&cli_);
+
+    // The batch timer calls back into the client
+    timer_wheel::timer_id timer;
+    {
+        guard g{deliveryBatchLock_};
+        timer = std::exchange(deliveryTimer_, 0);
+    }
+    if (timer && timerWheel_)
+        timerWheel_->cancel(timer);
+
+    if (timerWheel_)
+        timerWheel_->stop();
+}
 
 // --------------------------------------------------------------------------
 // Class static callbacks.
@@ -102,11 +151,62 @@ void async_client::on_connected(void* context, char* cause)
         return;
 
     async_client* cli = static_cast<async_client*>(context);
+    cli->check_callback_thread();
+    cli->metrics_.on_connected();
 
     auto tok = cli->connTok_;
     if (tok)
         tok->on_success(nullptr);
 
+    // The aliases only last for a connection, and the server says how many
+    // we can use on this one in the CONNACK.
+    if (cli->aliases_) {
+        uint16_t serverMax = 0;
+        if (tok) {
+            guard g{tok->lock_};
+            if (tok->connRsp_) {
+                const auto& props = tok->connRsp_->get_properties();
+                if (props.contains(property::TOPIC_ALIAS_MAXIMUM))
+                    serverMax = get<uint16_t>(props, property::TOPIC_ALIAS_MAXIMUM);
+            }
+        }
+        cli->aliases_->reset(serverMax);
+    }
+
+    // A v5 server supports subscription identifiers unless it says not
+    bool subIdsAvailable = false;
+    if (tok) {
+        guard g{tok->lock_};
+        if (tok->connRsp_ && tok->connRsp_->get_mqtt_version() >= MQTTVERSION_5) {
+            const auto& props = tok->connRsp_->get_properties();
+            subIdsAvailable = !props.contains(property::SUBSCRIPTION_IDENTIFIERS_AVAILABLE) ||
+                              get<uint8_t>(props, property::SUBSCRIPTION_IDENTIFIERS_AVAILABLE);
+        }
+    }
+    cli->subIdsAvailable_ = subIdsAvailable;
+
+    // A server that kept the session still has the subscriptions
+    const_reconnect_policy_ptr policy;
+    {
+        guard g{cli->lock_};
+        policy = cli->reconnPolicy_;
+    }
+    if (policy && policy->get_resubscribe()) {
+        bool sessionPresent = false;
+        if (tok) {
+            guard g{tok->lock_};
+            if (tok->connRsp_)
+                sessionPresent = tok->connRsp_->is_session_present();
+        }
+        if (!sessionPresent)
+            cli->resubscribe();
+    }
+
+    if (cli->offlineBuffered_) {
+        if (auto buf = cli->get_offline_buffer())
+            buf->start_drain();
+    }
+
     callback* cb = cli->userCallback_;
     auto& connHandler = cli->connHandler_;
     auto& que = cli->que_;
@@ -120,8 +220,10 @@ void async_client::on_connected(void* context, char* cause)
         if (connHandler)
             connHandler(cause_str);
 
-        if (que)
+        if (que) {
             que->put(connected_event{cause_str});
+            cli->notify_awaiters();
+        }
     }
 }
 
@@ -137,6 +239,13 @@ void async_client::on_connection_lost(void* context, char* cause)
         return;
 
     async_client* cli = static_cast<async_client*>(context);
+    cli->check_callback_thread();
+    PAHO_MQTTPP_PROBE(connection_lost);
+    cli->metrics_.on_connection_lost();
+    cli->flush_delivery_batch();
+
+    if (cli->aliases_)
+        cli->aliases_->reset(0);
 
     callback* cb = cli->userCallback_;
     auto& connLostHandler = cli->connLostHandler_;
@@ -151,9 +260,13 @@ void async_client::on_connection_lost(void* context, char* cause)
         if (connLostHandler)
             connLostHandler(cause_str);
 
-        if (que)
+        if (que) {
             que->put(connection_lost_event{cause_str});
+            cli->notify_awaiters();
+        }
     }
+
+    cli->start_reconnect();
 }
 
 // Callback from the C lib for when a disconnect packet is received from
@@ -166,6 +279,8 @@ void async_client::on_disconnected(
         return;
 
     async_client* cli = static_cast<async_client*>(context);
+    cli->check_callback_thread();
+    cli->flush_delivery_batch();
 
     auto& disconnectedHandler = cli->disconnectedHandler_;
     auto& que = cli->que_;
@@ -176,8 +291,10 @@ void async_client::on_disconnected(
         if (disconnectedHandler)
             disconnectedHandler(props, ReasonCode(reasonCode));
 
-        if (que)
+        if (que) {
             que->put(disconnected_event{std::move(props), ReasonCode(reasonCode)});
+            cli->notify_awaiters();
+        }
     }
 }
 
@@ -191,29 +308,196 @@ int async_client::on_message_arrived(
     if (!context)
         return to_int(true);
 
+    // The C library passes a zero length for a NUL-terminated topic
+    PAHO_MQTTPP_PROBE2(
+        message_arrived, topicLen ? size_t(topicLen) : std::strlen(topicName),
+        msg ? msg->payloadlen : 0
+    );
+
     async_client* cli = static_cast<async_client*>(context);
+    cli->check_callback_thread();
+
     callback* cb = cli->userCallback_;
     auto& que = cli->que_;
     auto& msgHandler = cli->msgHandler_;
 
-    if (cb || que || msgHandler) {
+    auto tr = cli->tracer_.load(std::memory_order_relaxed);
+    message_tracer::time_point arrived;
+    if (tr)
+        arrived = message_tracer::clock::now();
+
+    // With flow control, a full queue leaves the message with the C lib,
+    // which holds off the ack and offers the message to us again later.
+    if (cli->flowCapacity_ > 0 && que && !que->closed() && que->size() >= cli->flowCapacity_)
+        return to_int(false);
+
+    // The same goes while the client is over its soft memory limit, when
+    // the consumer has messages to work through.
+    if (cli->check_memory_limit() && cli->memLimitHolds_ && que && !que->closed() &&
+        que->size() > 0)
+        return to_int(false);
+
+    // In manual-ack mode, the same goes while too many are in flight.
+    ack_tracker_ptr acker;
+    if (cli->hasAckTracker_ && msg->qos > 0) {
+        acker = cli->get_ack_tracker();
+        if (acker && acker->full())
+            return to_int(false);
+    }
+
+    cli->metrics_.on_received(msg->qos, size_t(msg->payloadlen));
+
+    if (cli->hasTopicStats_) {
+        if (auto stats = cli->get_topic_stats()) {
+            size_t len = (topicLen == 0) ? strlen(topicName) : size_t(topicLen);
+            stats->on_received(string{topicName, len}, size_t(msg->payloadlen));
+        }
+    }
+
+    if (cli->hasDupFilter_) {
+        auto filt = cli->get_duplicate_filter();
         size_t len = (topicLen == 0) ? strlen(topicName) : size_t(topicLen);
+        if (filt && filt->check(std::string_view{topicName, len}, *msg)) {
+            cli->metrics_.on_duplicate_dropped();
+            MQTTAsync_freeMessage(&msg);
+            MQTTAsync_free(topicName);
+            return to_int(true);
+        }
+    }
 
-        string topic{topicName, len};
-        auto m = message::create(std::move(topic), *msg);
+    if (cli->hasRecvFilter_) {
+        auto filt = cli->get_receive_filter();
+        size_t len = (topicLen == 0) ? strlen(topicName) : size_t(topicLen);
+        if (filt && filt->check(std::string_view{topicName, len}, *msg)) {
+            cli->metrics_.on_filtered_dropped();
+            MQTTAsync_freeMessage(&msg);
+            MQTTAsync_free(topicName);
+            return to_int(true);
+        }
+    }
 
-        if (msgHandler)
-            msgHandler(m);
+    if (cb || que || msgHandler || cli->hasSubHandlers_ || cli->hasLvCache_) {
+        size_t len = (topicLen == 0) ? strlen(topicName) : size_t(topicLen);
+        message_ptr m;
+
+        string_ref topic;
+        if (cli->createOpts_.get_max_interned_topics() > 0)
+            topic = cli->intern_topic(topicName, len);
+
+        if (cli->createOpts_.get_zero_copy_messages()) {
+            // The message takes ownership of the C buffers, which are
+            // freed when the last reference to them is released.
+            std::shared_ptr<MQTTAsync_message> cmsg{
+                msg, [](MQTTAsync_message* p) { MQTTAsync_freeMessage(&p); }
+            };
+            msg = nullptr;
+
+            if (!topic) {
+                topic = string_ref{
+                    string_ref::external_pointer_type{
+                        topicName, [](const char* p) { MQTTAsync_free(const_cast<char*>(p)); }
+                    },
+                    len
+                };
+                topicName = nullptr;
+            }
 
-        if (cb)
-            cb->message_arrived(m);
+            m = message::create(std::move(topic), std::move(cmsg));
+        }
+        else {
+#if defined(PAHO_MQTTPP_HAS_PMR)
+            if (auto mr = cli->msgResource_.load(std::memory_order_relaxed)) {
+                if (!topic)
+                    topic = string_ref{mr, topicName, len};
+                m = message::create(mr, std::move(topic), *msg);
+            }
+            else
+#endif
+            {
+                if (!topic)
+                    topic = string{topicName, len};
+                m = message::create(std::move(topic), *msg);
+            }
+        }
+
+        if (cli->hasCodec_ && cli->mqttVersion_ >= MQTTVERSION_5) {
+            const auto& props = m->get_properties();
+            if (!props.empty()) {
+                auto codec = cli->get_payload_codec();
+                if (codec && payload_codec::get_encoding(props) == codec->name())
+                    m->set_payload_codec(std::move(codec));
+            }
+        }
+
+        // The delta codec gives back the same message, or a new one that
+        // no one else has yet.
+        if (cli->hasDeltaCodec_ && cli->mqttVersion_ >= MQTTVERSION_5) {
+            if (auto dc = cli->get_delta_codec()) {
+                m = std::const_pointer_cast<message>(dc->decode(std::move(m)));
+                if (!m) {
+                    if (msg)
+                        MQTTAsync_freeMessage(&msg);
+                    if (topicName)
+                        MQTTAsync_free(topicName);
+                    return to_int(true);
+                }
+            }
+        }
+
+        // The Message Expiry Interval runs from when the message arrived
+        m->set_timestamp(message::clock::now());
+
+        if (acker)
+            acker->track(m);
+
+        if (tr)
+            tr->message_arrived(
+                *m, message_tracer::get_trace_context(m->get_properties()), arrived
+            );
+
+        auto deliver = [&](message_ptr m) {
+            if (cli->hasLvCache_) {
+                if (auto cache = cli->get_last_value_cache())
+                    cache->update(m);
+            }
 
-        if (que)
-            que->put(m);
+            if (!cli->dispatch_to_sub_handlers(m)) {
+                if (msgHandler)
+                    msgHandler(m);
+
+                if (cb)
+                    cb->message_arrived(m);
+
+                if (que) {
+                    m->queueTime_ = message::clock::now();
+                    que->put(std::move(m));
+                    cli->notify_awaiters();
+                }
+            }
+        };
+
+        // A batch is delivered as its records, which are stamped as the
+        // batch was, unless it's damaged.
+        std::vector<message_ptr> recs;
+        if (cli->unpackBatches_ && !acker && cli->mqttVersion_ >= MQTTVERSION_5 &&
+            message_batcher::is_batch(*m))
+            recs = message_batcher::unpack(m);
+
+        if (recs.empty()) {
+            deliver(std::move(m));
+        }
+        else {
+            for (auto& rec : recs) {
+                rec->set_timestamp(m->get_timestamp());
+                deliver(std::move(rec));
+            }
+        }
     }
 
-    MQTTAsync_freeMessage(&msg);
-    MQTTAsync_free(topicName);
+    if (msg)
+        MQTTAsync_freeMessage(&msg);
+    if (topicName)
+        MQTTAsync_free(topicName);
     return to_int(true);
 }
 
@@ -258,222 +542,1349 @@ int async_client::on_update_connection(void* context, MQTTAsync_connectData* cda
 }
 
 // --------------------------------------------------------------------------
-// Private methods
+// Token table
 
-void async_client::add_token(token_ptr tok)
+async_client::token_table::token_table(size_t nShards)
 {
-    if (tok) {
-        guard g(lock_);
-        pendingTokens_.push_back(tok);
+    size_t n = 1;
+    while (n < nShards) n <<= 1;
+
+    shards_.reset(new shard[n]);
+    mask_ = n - 1;
+}
+
+size_t async_client::token_table::memory_size(const token& tok)
+{
+    size_t n = sizeof(token);
+    if (const auto& topics = tok.topics_) {
+        for (size_t i = 0; i < topics->size(); ++i) n += (*topics)[i].size();
     }
+    return n;
 }
 
-void async_client::add_token(delivery_token_ptr tok)
+size_t async_client::token_table::memory_size(const delivery_token& tok)
 {
-    if (tok) {
-        guard g(lock_);
-        pendingDeliveryTokens_.push_back(tok);
+    size_t n = memory_size(static_cast<const token&>(tok)) + sizeof(delivery_token) -
+               sizeof(token);
+    if (const auto& msg = tok.get_message())
+        n += msg->memory_size();
+    return n;
+}
+
+// The size that was counted for a token is kept with it, and taken back
+// out when it's removed, so the counts stay exact even if the token
+// changes while it's pending.
+
+void async_client::token_table::add(token_ptr tok)
+{
+    auto& sh = addr_shard(tok.get());
+    std::lock_guard<std::mutex> g(sh.lock);
+    auto n = memory_size(*tok);
+    auto p = tok.get();
+    if (sh.toks.emplace(p, std::move(tok)).second) {
+        nToks_.fetch_add(1, std::memory_order_relaxed);
+        p->memBytes_ = n;
+        tokBytes_.add(n);
     }
 }
 
-// Note that we uniquely identify a token by the address of its raw pointer,
-// since the message ID is not unique.
+void async_client::token_table::add(delivery_token_ptr tok)
+{
+    auto& sh = addr_shard(tok.get());
+    std::lock_guard<std::mutex> g(sh.lock);
+    auto n = memory_size(*tok);
+    auto p = tok.get();
+    if (sh.dtoks.emplace(p, std::move(tok)).second) {
+        nToks_.fetch_add(1, std::memory_order_relaxed);
+        nDtoks_.fetch_add(1, std::memory_order_relaxed);
+        p->memBytes_ = n;
+        dtokBytes_.add(n);
+    }
+}
 
-void async_client::remove_token(token* tok)
+// The token may have already completed (and been removed) by the time the
+// message ID is known, as is always the case with QoS 0, so we only index
+// it if it's still in the table. The address and ID shards are locked
+// together so a concurrent removal sees either both entries or neither.
+// They're taken with std::lock(), since another thread may be indexing a
+// token whose address and ID shards are the other way around.
+
+void async_client::token_table::index(const delivery_token_ptr& tok)
 {
-    if (!tok)
+    int msgID = tok->get_message_id();
+    if (msgID <= 0)
         return;
 
-    guard g(lock_);
-    for (auto p = pendingDeliveryTokens_.begin(); p != pendingDeliveryTokens_.end(); ++p) {
-        if (p->get() == tok) {
-            delivery_token_ptr dtok = *p;
-            pendingDeliveryTokens_.erase(p);
-
-            // If there's a user callback registered, we can now call
-            // delivery_complete()
-
-            if (userCallback_) {
-                const_message_ptr msg = dtok->get_message();
-                if (msg && msg->get_qos() > 0) {
-                    callback* cb = userCallback_;
-                    g.unlock();
-                    cb->delivery_complete(dtok);
-                }
+    auto& sh = addr_shard(tok.get());
+    auto& ish = id_shard(msgID);
+
+    std::unique_lock<std::mutex> g(sh.lock, std::defer_lock);
+    std::unique_lock<std::mutex> ig(ish.lock, std::defer_lock);
+    if (&ish == &sh)
+        g.lock();
+    else
+        std::lock(g, ig);
+
+    if (sh.dtoks.find(tok.get()) != sh.dtoks.end())
+        ish.ids[msgID] = tok;
+}
+
+void async_client::token_table::unindex(const delivery_token_ptr& tok)
+{
+    int msgID = tok->get_message_id();
+    if (msgID <= 0)
+        return;
+
+    auto& ish = id_shard(msgID);
+    std::lock_guard<std::mutex> g(ish.lock);
+    if (auto p = ish.ids.find(msgID); p != ish.ids.end() && p->second == tok)
+        ish.ids.erase(p);
+}
+
+delivery_token_ptr async_client::token_table::remove(const token* tok)
+{
+    delivery_token_ptr dtok;
+    {
+        auto& sh = addr_shard(tok);
+        std::lock_guard<std::mutex> g(sh.lock);
+
+        if (auto p = sh.dtoks.find(tok); p != sh.dtoks.end()) {
+            dtok = std::move(p->second);
+            sh.dtoks.erase(p);
+            dtokBytes_.sub(dtok->memBytes_);
+            if (nDtoks_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                notify_drained();
+            nToks_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else {
+            if (auto q = sh.toks.find(tok); q != sh.toks.end()) {
+                tokBytes_.sub(q->second->memBytes_);
+                sh.toks.erase(q);
+                nToks_.fetch_sub(1, std::memory_order_relaxed);
             }
-            return;
+            return dtok;
         }
     }
-    for (auto p = pendingTokens_.begin(); p != pendingTokens_.end(); ++p) {
-        if (p->get() == tok) {
-            pendingTokens_.erase(p);
-            return;
-        }
+
+    // Only drop the ID entry if it still refers to this token.
+    if (int msgID = dtok->get_message_id(); msgID > 0) {
+        auto& ish = id_shard(msgID);
+        std::lock_guard<std::mutex> g(ish.lock);
+        if (auto p = ish.ids.find(msgID); p != ish.ids.end() && p->second == dtok)
+            ish.ids.erase(p);
     }
+    return dtok;
 }
 
-// --------------------------------------------------------------------------
-// Callback management
+// The tokens are grouped by shard, through a sorted list of their indexes
+// so that the result stays in the original order. Like the single
+// removal, the ID entries are only dropped if they still refer to the
+// removed tokens.
 
-void async_client::set_callback(callback& cb)
+std::vector<delivery_token_ptr> async_client::token_table::remove(
+    std::vector<delivery_token_ptr> toks
+)
 {
-    {
-        guard g(lock_);
-        userCallback_ = &cb;
+    const size_t n = toks.size();
+    std::vector<size_t> idx(n);
+    for (size_t i = 0; i < n; ++i) idx[i] = i;
+
+    std::sort(idx.begin(), idx.end(), [this, &toks](size_t a, size_t b) {
+        return addr_shard_index(toks[a].get()) < addr_shard_index(toks[b].get());
+    });
+
+    std::vector<bool> removed(n, false);
+    size_t nRemoved = 0;
+
+    for (size_t i = 0; i < n;) {
+        auto& sh = addr_shard(toks[idx[i]].get());
+        std::lock_guard<std::mutex> g(sh.lock);
+        for (; i < n && &addr_shard(toks[idx[i]].get()) == &sh; ++i) {
+            if (sh.dtoks.erase(toks[idx[i]].get()) != 0) {
+                removed[idx[i]] = true;
+                dtokBytes_.sub(toks[idx[i]]->memBytes_);
+                ++nRemoved;
+            }
+        }
     }
-    int rc = MQTTAsync_setConnected(cli_, this, &async_client::on_connected);
 
-    if (rc == MQTTASYNC_SUCCESS) {
-        MQTTAsync_setCallbacks(
-            cli_, this, &async_client::on_connection_lost, &async_client::on_message_arrived,
-            nullptr /*&async_client::on_delivery_complete*/
-        );
+    if (nRemoved != 0 && nDtoks_.fetch_sub(nRemoved, std::memory_order_acq_rel) == nRemoved)
+        notify_drained();
+    nToks_.fetch_sub(nRemoved, std::memory_order_relaxed);
+
+    auto id_index = [mask = mask_](const delivery_token_ptr& tok) {
+        return size_t(tok->get_message_id()) & mask;
+    };
+
+    std::sort(idx.begin(), idx.end(), [&toks, &id_index](size_t a, size_t b) {
+        return id_index(toks[a]) < id_index(toks[b]);
+    });
+
+    for (size_t i = 0; i < n;) {
+        auto& ish = id_shard(toks[idx[i]]->get_message_id());
+        std::lock_guard<std::mutex> g(ish.lock);
+        for (; i < n && &id_shard(toks[idx[i]]->get_message_id()) == &ish; ++i) {
+            const auto& tok = toks[idx[i]];
+            int msgID = tok->get_message_id();
+            if (!removed[idx[i]] || msgID <= 0)
+                continue;
+            if (auto p = ish.ids.find(msgID); p != ish.ids.end() && p->second == tok)
+                ish.ids.erase(p);
+        }
     }
-    else {
-        MQTTAsync_setConnected(cli_, nullptr, nullptr);
 
-        guard g(lock_);
-        userCallback_ = nullptr;
-        throw exception(rc);
+    std::vector<delivery_token_ptr> done;
+    done.reserve(nRemoved);
+    for (size_t i = 0; i < n; ++i) {
+        if (removed[i])
+            done.push_back(std::move(toks[i]));
     }
+    return done;
 }
 
-void async_client::disable_callbacks()
+delivery_token_ptr async_client::token_table::find_delivery_token(const token* tok) const
 {
-    // TODO: It would be nice to disable callbacks at the C library level,
-    // but the setCallback function currently does not accept a nullptr for
-    // the "message arrived" parameter. So, for now we send it an empty
-    // lambda function.
-    int rc = MQTTAsync_setCallbacks(
-        cli_, this, nullptr,
-        [](void*, char*, int, MQTTAsync_message*) -> int { return to_int(true); }, nullptr
-    );
-
-    if (rc != MQTTASYNC_SUCCESS)
-        throw exception(rc);
+    const auto& sh = addr_shard(tok);
+    std::lock_guard<std::mutex> g(sh.lock);
+    if (auto p = sh.dtoks.find(tok); p != sh.dtoks.end())
+        return p->second;
+    return delivery_token_ptr{};
 }
 
-void async_client::set_connected_handler(connection_handler cb)
+// Completed deliveries that are held for the batched handler are still in
+// the table, but they're no longer in flight.
+
+delivery_token_ptr async_client::token_table::get_delivery_token(int msgID) const
 {
-    connHandler_ = cb;
-    check_ret(::MQTTAsync_setConnected(cli_, this, &async_client::on_connected));
+    if (msgID > 0) {
+        const auto& ish = id_shard(msgID);
+        std::lock_guard<std::mutex> g(ish.lock);
+        if (auto p = ish.ids.find(msgID); p != ish.ids.end() && !p->second->is_complete())
+            return p->second;
+    }
+    return delivery_token_ptr{};
 }
 
-void async_client::set_connection_lost_handler(connection_handler cb)
+std::vector<delivery_token_ptr> async_client::token_table::get_delivery_tokens() const
 {
-    connLostHandler_ = cb;
-    check_ret(
-        ::MQTTAsync_setConnectionLostCallback(cli_, this, &async_client::on_connection_lost)
-    );
+    std::vector<delivery_token_ptr> toks;
+    for (size_t i = 0; i <= mask_; ++i) {
+        const auto& sh = shards_[i];
+        std::lock_guard<std::mutex> g(sh.lock);
+        for (const auto& t : sh.ids) {
+            if (!t.second->is_complete())
+                toks.push_back(t.second);
+        }
+    }
+    return toks;
 }
 
-void async_client::set_disconnected_handler(disconnected_handler cb)
+std::vector<delivery_token_ptr> async_client::token_table::get_incomplete_delivery_tokens() const
 {
-    disconnectedHandler_ = cb;
-    check_ret(::MQTTAsync_setDisconnected(cli_, this, &async_client::on_disconnected));
+    std::vector<delivery_token_ptr> toks;
+    for (size_t i = 0; i <= mask_; ++i) {
+        const auto& sh = shards_[i];
+        std::lock_guard<std::mutex> g(sh.lock);
+        for (const auto& t : sh.dtoks) {
+            if (!t.second->is_complete())
+                toks.push_back(t.second);
+        }
+    }
+    return toks;
 }
 
-void async_client::set_message_callback(message_handler cb)
+// The lock is taken, and dropped, before signaling so that a waiter can't
+// miss the wakeup between checking the count and starting to wait.
+
+void async_client::token_table::notify_drained()
 {
-    msgHandler_ = cb;
-    check_ret(
-        ::MQTTAsync_setMessageArrivedCallback(cli_, this, &async_client::on_message_arrived)
-    );
+    {
+        std::lock_guard<std::mutex> g(drainLock_);
+    }
+    drainCond_.notify_all();
 }
 
-void async_client::set_update_connection_handler(update_connection_handler cb)
+bool async_client::token_table::wait_drained(
+    const std::chrono::steady_clock::time_point& deadline
+) const
 {
-    updateConnectionHandler_ = cb;
-    check_ret(
-        ::MQTTAsync_setUpdateConnectOptions(cli_, this, &async_client::on_update_connection)
-    );
+    std::unique_lock<std::mutex> lk(drainLock_);
+    return drainCond_.wait_until(lk, deadline, [this] {
+        return nDtoks_.load(std::memory_order_acquire) == 0;
+    });
 }
 
-// --------------------------------------------------------------------------
-// Connect
-
-token_ptr async_client::connect() { return connect(connect_options{}); }
+client_metrics async_client::get_metrics() const
+{
+    client_metrics m{metrics_};
+    m.nPendingTokens_ = pendingTokens_.size();
+    m.nPendingDeliveryTokens_ = pendingTokens_.num_delivery_tokens();
+    m.queueSize_ = consumer_queue_size();
+    return m;
+}
 
-token_ptr async_client::connect(connect_options opts)
+memory_usage async_client::get_memory_usage() const
 {
-    // TODO: We should update the MQTT version from the response
-    //  	(when the server confirms the requested version)
-    mqttVersion_ = opts.opts_.MQTTVersion;
+    memory_usage mu;
 
-    // The C lib is very picky about version and clean start/session
-    if (opts.opts_.MQTTVersion < 5)
-        opts.opts_.cleanstart = 0;
-    else
-        opts.opts_.cleansession = 0;
+    const auto& toks = pendingTokens_.token_bytes();
+    mu.set(memory_usage::PENDING_TOKENS, toks.bytes(), toks.peak());
 
-    // TODO: If connTok_ is non-null, there could be a pending connect
-    // which might complete after creating/assigning a new one. If that
-    // happened, the callback would have the context address of the previous
-    // token which was destroyed. So for now, keep the old one alive within
-    // this function, and check the behavior of the C library...
-    auto tmpTok = connTok_;
-    connTok_ = token::create(token::Type::CONNECT, *this);
-    add_token(connTok_);
+    const auto& dtoks = pendingTokens_.delivery_token_bytes();
+    mu.set(memory_usage::DELIVERY_TOKENS, dtoks.bytes(), dtoks.peak());
 
-    opts.set_token(connTok_);
+    if (que_)
+        mu.set(memory_usage::CONSUMER_QUEUE, que_->bytes(), que_->peak_bytes());
 
-    // TODO: Lock!
-    connOpts_ = std::move(opts);
-    int rc = MQTTAsync_connect(cli_, &connOpts_.opts_);
+    if (auto buf = get_offline_buffer())
+        mu.set(memory_usage::OFFLINE_BUFFER, buf->memory_size(), buf->peak_memory_size());
 
-    if (rc != MQTTASYNC_SUCCESS) {
-        remove_token(connTok_);
-        connTok_.reset();
-        throw exception(rc);
-    }
+    if (auto cache = get_last_value_cache())
+        mu.set(
+            memory_usage::LAST_VALUE_CACHE, cache->memory_size(), cache->peak_memory_size()
+        );
 
-    UNUSED(tmpTok);
-    return connTok_;
+    return mu;
 }
 
-token_ptr async_client::connect(connect_options opts, void* userContext, iaction_listener& cb)
+void async_client::set_memory_limit(
+    std::size_t bytes, memory_limit_handler cb /*={}*/, bool holdIncoming /*=false*/
+)
 {
-    // Remember the requested protocol version
-    mqttVersion_ = opts.opts_.MQTTVersion;
-
-    // The C lib is very picky about version and clean start/session
-    if (opts.opts_.MQTTVersion < 5)
-        opts.opts_.cleanstart = 0;
-    else
-        opts.opts_.cleansession = 0;
-
-    // Keep the old connTok_ alive (see above)
-    auto tmpTok = connTok_;
-    connTok_ = token::create(token::Type::CONNECT, *this, userContext, cb);
-    add_token(connTok_);
-
-    opts.set_token(connTok_);
-
-    connOpts_ = std::move(opts);
-    int rc = MQTTAsync_connect(cli_, &connOpts_.opts_);
-
-    if (rc != MQTTASYNC_SUCCESS) {
-        remove_token(connTok_);
-        connTok_.reset();
-        throw exception(rc);
+    {
+        guard g{lock_};
+        memLimitHandler_ = std::move(cb);
     }
-
-    UNUSED(tmpTok);
-    return connTok_;
+    memLimitHolds_ = holdIncoming;
+    overMemLimit_ = false;
+    memLimit_ = bytes;
 }
 
 // --------------------------------------------------------------------------
-// Re-connect
+// Private methods
 
-token_ptr async_client::reconnect()
+// The messages for a shared subscription arrive on their own topics, so
+// its handler is matched without the "$share/<group>/" prefix.
+
+void async_client::remember_subscription(const string& topicFilter, int qos)
 {
-    auto tok = connTok_;
+    guard g{subLock_};
+    subs_[topicFilter] = qos;
+}
 
-    if (!tok)
-        throw exception(MQTTASYNC_FAILURE, "Can't reconnect before a successful connect");
+void async_client::forget_subscription(const string& topicFilter)
+{
+    guard g{subLock_};
+    subs_.erase(topicFilter);
+}
 
-    tok->reset();
-    add_token(tok);
+// The subscriptions are restored from the C library's callback thread, so
+// this only makes the request, without waiting for it.
+
+// The subscriptions with handlers are restored one at a time, so each can
+// keep its identifier, and the rest are sent as a batch.
+
+void async_client::resubscribe()
+{
+    auto filters = std::make_shared<string_collection>();
+    qos_collection qos;
+    std::vector<std::tuple<string, int, uint32_t>> tagged;
+    {
+        guard g{subLock_};
+        filters->reserve(subs_.size());
+        qos.reserve(subs_.size());
+        for (const auto& sub : subs_) {
+            uint32_t id = 0;
+            if (subIdsAvailable_ && !handlerSubIds_.empty()) {
+                auto p = handlerSubIds_.find(handler_filter(sub.first));
+                if (p != handlerSubIds_.end())
+                    id = p->second;
+            }
+            if (id != 0) {
+                tagged.emplace_back(sub.first, sub.second, id);
+            }
+            else {
+                filters->push_back(sub.first);
+                qos.push_back(sub.second);
+            }
+        }
+    }
+
+    try {
+        for (const auto& [filter, subQos, id] : tagged) {
+            properties props{{property::SUBSCRIPTION_IDENTIFIER, int32_t(id)}};
+            subscribe_filter(filter, subQos, subscribe_options{}, props);
+        }
+        if (!filters->empty())
+            subscribe_batch(filters, qos);
+    }
+    catch (const exception&) {
+    }
+}
+
+string async_client::handler_filter(const string& topicFilter)
+{
+    static const string SHARE_PREFIX{"$share/"};
+
+    if (topicFilter.compare(0, SHARE_PREFIX.size(), SHARE_PREFIX) == 0) {
+        auto pos = topicFilter.find('/', SHARE_PREFIX.size());
+        if (pos != string::npos)
+            return topicFilter.substr(pos + 1);
+    }
+    return topicFilter;
+}
+
+// The identifiers index a flat table of handlers. Freed identifiers are
+// reused oldest first, so that a message still in flight for a removed
+// subscription is unlikely to find a new handler in its slot.
+
+uint32_t async_client::add_sub_handler(
+    const string& topicFilter, message_handler cb, bool tagged
+)
+{
+    auto filter = handler_filter(topicFilter);
+    auto handler = std::make_shared<message_handler>(std::move(cb));
+
+    guard g(subLock_);
+
+    uint32_t id = 0;
+    if (tagged) {
+        if (!freeSubIds_.empty()) {
+            id = freeSubIds_.front();
+            freeSubIds_.pop_front();
+            subIdHandlers_[id] = handler;
+        }
+        else {
+            if (subIdHandlers_.empty())
+                subIdHandlers_.emplace_back();
+            id = uint32_t(subIdHandlers_.size());
+            subIdHandlers_.push_back(handler);
+        }
+    }
+    else {
+        ++nUntaggedHandlers_;
+    }
+
+    // The identifier of a replaced handler is released after the new one
+    // is taken, so it's not reused right away.
+    if (auto p = handlerSubIds_.find(filter); p != handlerSubIds_.end()) {
+        if (p->second == 0)
+            --nUntaggedHandlers_;
+        else
+            release_sub_id(p->second);
+        p->second = id;
+    }
+    else {
+        handlerSubIds_.emplace(filter, id);
+    }
+
+    subHandlers_.insert({std::move(filter), std::move(handler)});
+    hasSubHandlers_ = true;
+    return id;
+}
+
+void async_client::remove_sub_handler(const string& topicFilter)
+{
+    guard g(subLock_);
+    if (hasSubHandlers_ && subHandlers_.remove(handler_filter(topicFilter))) {
+        subHandlers_.prune();
+        hasSubHandlers_ = subHandlers_.begin() != subHandlers_.end();
+
+        if (auto p = handlerSubIds_.find(handler_filter(topicFilter));
+            p != handlerSubIds_.end()) {
+            if (p->second == 0)
+                --nUntaggedHandlers_;
+            else
+                release_sub_id(p->second);
+            handlerSubIds_.erase(p);
+        }
+    }
+}
+
+void async_client::release_sub_id(uint32_t id)
+{
+    subIdHandlers_[id].reset();
+    freeSubIds_.push_back(id);
+}
+
+void async_client::check_user_sub_id(const properties& props)
+{
+    if (props.contains(property::SUBSCRIPTION_IDENTIFIER)) {
+        guard g(subLock_);
+        userSubIds_ = true;
+    }
+}
+
+// The matching handlers are collected under the lock, but called after
+// it is released, so that they can safely subscribe or unsubscribe.
+//
+// A message for subscriptions tagged by the client carries their
+// identifiers, which lead straight to the handlers. It's only matched
+// against the filters if it doesn't have any, or one is unknown, or not
+// every handler can be found that way.
+
+bool async_client::dispatch_to_sub_handlers(const const_message_ptr& msg)
+{
+    if (!hasSubHandlers_)
+        return false;
+
+    // A handler may throw, or dispatch another message on this thread, so
+    // the list can't be shared from one call to the next.
+    std::vector<std::shared_ptr<message_handler>> handlers;
+    {
+        guard g(subLock_);
+
+        if (nUntaggedHandlers_ == 0 && !userSubIds_) {
+            const auto& props = msg->get_properties();
+            size_t n = props.count(property::SUBSCRIPTION_IDENTIFIER);
+
+            for (size_t i = 0; i < n; ++i) {
+                auto id = get<uint32_t>(props, property::SUBSCRIPTION_IDENTIFIER, i);
+                if (id >= subIdHandlers_.size() || !subIdHandlers_[id]) {
+                    handlers.clear();
+                    break;
+                }
+                handlers.push_back(subIdHandlers_[id]);
+            }
+        }
+
+        if (handlers.empty()) {
+            for (auto it = subHandlers_.matches(msg->get_topic());
+                 it != subHandlers_.matches_cend(); ++it)
+                handlers.push_back(it->second);
+        }
+    }
+
+    if (handlers.empty())
+        return false;
+
+    for (const auto& handler : handlers) (*handler)(msg);
+    return true;
+}
+
+string_ref async_client::intern_topic(const char* topicName, size_t len)
+{
+    std::string_view sv{topicName, len};
+    guard g(internLock_);
+
+    if (auto p = internedTopics_.find(sv); p != internedTopics_.end())
+        return p->second;
+
+    if (internedTopics_.size() >= createOpts_.get_max_interned_topics())
+        return string_ref{};
+
+    // The key is a view of the interned string, which never moves. It's
+    // always a shared string, even if it's short enough to be inline, so
+    // that the messages can share it.
+    string_ref topic{std::make_shared<const string>(sv)};
+    internedTopics_.emplace(std::string_view{topic.data(), topic.size()}, topic);
+    return topic;
+}
+
+void async_client::add_token(token_ptr tok)
+{
+    if (tok) {
+        arm_operation_timeout(tok);
+        pendingTokens_.add(std::move(tok));
+    }
+}
+
+void async_client::add_token(delivery_token_ptr tok)
+{
+    if (tok) {
+        arm_operation_timeout(tok);
+        pendingTokens_.add(std::move(tok));
+        check_memory_limit();
+    }
+}
+
+// The connect and disconnect have timeouts of their own in their options.
+
+void async_client::arm_operation_timeout(const token_ptr& tok)
+{
+    auto timeout = opTimeout_.load(std::memory_order_relaxed);
+    if (timeout == 0)
+        return;
+
+    auto type = tok->get_type();
+    if (type == token::Type::CONNECT || type == token::Type::DISCONNECT)
+        return;
+
+    using std::chrono::steady_clock;
+    set_deadline(tok, steady_clock::now() + steady_clock::duration{timeout});
+}
+
+timer_wheel_ptr async_client::get_timer_wheel() const
+{
+    guard g{lock_};
+    if (!timerWheel_) {
+        timerWheel_ = timer_wheel::create();
+        wheel_ = timerWheel_.get();
+    }
+    return timerWheel_;
+}
+
+// The timer holds a reference to the token, which it gives up when it
+// fires, or when the token completes and the timer is cancelled.
+
+bool async_client::set_deadline(
+    const token_ptr& tok, const std::chrono::steady_clock::time_point& deadline
+)
+{
+    if (!tok || tok->is_complete())
+        return false;
+
+    auto wheel = wheel_.load();
+    if (!wheel)
+        wheel = get_timer_wheel().get();
+
+    auto id = wheel->schedule_at(deadline, [tok] { tok->expire(); });
+
+    if (auto prev = tok->timerId_.exchange(id))
+        wheel->cancel(prev);
+
+    // It may have completed while the timer was set, and missed it
+    if (tok->is_complete()) {
+        if (auto cur = tok->timerId_.exchange(0))
+            wheel->cancel(cur);
+    }
+    return true;
+}
+
+// The handler is only called on the way over the limit, by the one thread
+// that flips the flag, so a client that stays over it isn't flooded with
+// calls.
+
+bool async_client::check_memory_limit()
+{
+    auto lim = memLimit_.load(std::memory_order_relaxed);
+    if (lim == 0)
+        return false;
+
+    auto mu = get_memory_usage();
+    if (mu.total() <= lim) {
+        overMemLimit_.store(false, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (!overMemLimit_.exchange(true)) {
+        memory_limit_handler cb;
+        {
+            guard g{lock_};
+            cb = memLimitHandler_;
+        }
+        if (cb)
+            cb(mu);
+    }
+    return true;
+}
+
+// A delivery that didn't succeed gives back its slot in the window as a
+// loss, whether it failed, timed out, or was never sent.
+
+void async_client::on_delivery_done(delivery_token& dtok)
+{
+    const_message_ptr msg = dtok.get_message();
+    bool acked = msg && msg->get_qos() > 0 && dtok.is_complete();
+    bool ok = acked && dtok.get_return_code() == MQTTASYNC_SUCCESS;
+
+    if (acked) {
+        if (ok)
+            metrics_.on_delivered(std::chrono::steady_clock::now() - dtok.sendTime_);
+        else
+            metrics_.on_publish_failed();
+    }
+
+    if (auto win = std::move(dtok.window_)) {
+        if (ok)
+            win->on_acked(std::chrono::steady_clock::now() - dtok.sendTime_);
+        else
+            win->on_lost();
+    }
+
+    auto tr = tracer_.load(std::memory_order_relaxed);
+    if (tr && dtok.is_complete())
+        tr->delivery_complete(dtok, message_tracer::clock::now());
+}
+
+void async_client::remove_token(token* tok)
+{
+    if (!tok)
+        return;
+
+    if (auto id = tok->timerId_.exchange(0, std::memory_order_relaxed)) {
+        if (auto wheel = wheel_.load())
+            wheel->cancel(id);
+    }
+
+    if (batchedDelivery_.load(std::memory_order_relaxed) && hold_delivery(tok))
+        return;
+
+    auto dtok = pendingTokens_.remove(tok);
+
+    // If it was a delivery token and there's a user callback registered,
+    // we can now call delivery_complete()
+
+    if (dtok) {
+        const_message_ptr msg = dtok->get_message();
+        on_delivery_done(*dtok);
+
+        if (dtok->retries_ != 0 && dtok->get_return_code() == MQTTASYNC_SUCCESS) {
+            if (auto rt = get_publish_retrier())
+                rt->on_recovered();
+        }
+
+        callback* cb;
+        {
+            guard g(lock_);
+            cb = userCallback_;
+        }
+        if (cb && msg && msg->get_qos() > 0)
+            cb->delivery_complete(dtok);
+    }
+}
+
+// The held deliveries stay in the table until the batch is handed off, so
+// there's nothing to hold once every delivery still in the table is in
+// the batch. The first one in a batch starts its timer, which just
+// flushes whatever batch is held when it fires, so a timer that was
+// too late to be cancelled only hands off the next batch a bit early.
+// The wheel never holds its lock while it runs a timer, so one can be
+// set while the batch is locked, but only cancelled once it's unlocked.
+
+bool async_client::hold_delivery(const token* tok)
+{
+    auto dtok = pendingTokens_.find_delivery_token(tok);
+    if (!dtok || !dtok->is_complete())
+        return false;
+
+    auto msg = dtok->get_message();
+    if (!msg || msg->get_qos() == 0)
+        return false;
+
+    std::vector<delivery_token_ptr> batch;
+    delivery_batch_handler cb;
+    timer_wheel::timer_id timer = 0;
+    {
+        guard g{deliveryBatchLock_};
+        if (!deliveryBatchHandler_)
+            return false;
+
+        deliveryBatch_.push_back(dtok);
+        if (deliveryBatch_.size() >= maxDeliveryBatch_ ||
+            deliveryBatch_.size() >= pendingTokens_.num_delivery_tokens()) {
+            batch.swap(deliveryBatch_);
+            deliveryBatch_.reserve(maxDeliveryBatch_);
+            cb = deliveryBatchHandler_;
+            timer = std::exchange(deliveryTimer_, 0);
+        }
+        else if (deliveryBatch_.size() == 1 && maxDeliveryDelay_ > maxDeliveryDelay_.zero()) {
+            if (auto wheel = wheel_.load())
+                deliveryTimer_ =
+                    wheel->schedule_after(maxDeliveryDelay_, [this] { flush_delivery_batch(); });
+        }
+    }
+
+    on_delivery_done(*dtok);
+
+    if (!batch.empty())
+        deliver_batch(std::move(batch), cb, timer);
+    return true;
+}
+
+void async_client::deliver_batch(
+    std::vector<delivery_token_ptr> toks, const delivery_batch_handler& cb,
+    timer_wheel::timer_id timer
+)
+{
+    if (timer) {
+        if (auto wheel = wheel_.load())
+            wheel->cancel(timer);
+    }
+
+    if (toks.empty())
+        return;
+
+    auto done = pendingTokens_.remove(std::move(toks));
+    if (cb && !done.empty())
+        cb(done);
+}
+
+// The wheel is made up front, so that the deliveries can set their timers
+// without the client's lock.
+
+void async_client::set_delivery_batch_handler(
+    delivery_batch_handler cb, std::size_t maxBatch,
+    std::chrono::steady_clock::duration maxDelay
+)
+{
+    if (cb && maxDelay > maxDelay.zero())
+        get_timer_wheel();
+
+    std::vector<delivery_token_ptr> batch;
+    delivery_batch_handler prev;
+    timer_wheel::timer_id timer;
+    {
+        guard g{deliveryBatchLock_};
+        batch.swap(deliveryBatch_);
+        timer = std::exchange(deliveryTimer_, 0);
+        prev = std::move(deliveryBatchHandler_);
+        deliveryBatchHandler_ = std::move(cb);
+        maxDeliveryBatch_ = std::max<std::size_t>(maxBatch, 1);
+        maxDeliveryDelay_ = std::max(maxDelay, maxDelay.zero());
+        if (deliveryBatchHandler_)
+            deliveryBatch_.reserve(maxDeliveryBatch_);
+        batchedDelivery_ = bool(deliveryBatchHandler_);
+    }
+    deliver_batch(std::move(batch), prev, timer);
+}
+
+void async_client::flush_delivery_batch()
+{
+    if (!batchedDelivery_.load(std::memory_order_relaxed))
+        return;
+
+    std::vector<delivery_token_ptr> batch;
+    delivery_batch_handler cb;
+    timer_wheel::timer_id timer;
+    {
+        guard g{deliveryBatchLock_};
+        batch.swap(deliveryBatch_);
+        deliveryBatch_.reserve(maxDeliveryBatch_);
+        cb = deliveryBatchHandler_;
+        timer = std::exchange(deliveryTimer_, 0);
+    }
+    deliver_batch(std::move(batch), cb, timer);
+}
+
+// --------------------------------------------------------------------------
+// Callback management
+
+void async_client::set_callback(callback& cb)
+{
+    {
+        guard g(lock_);
+        userCallback_ = &cb;
+    }
+    int rc = MQTTAsync_setConnected(cli_, this, &async_client::on_connected);
+
+    if (rc == MQTTASYNC_SUCCESS) {
+        MQTTAsync_setCallbacks(
+            cli_, this, &async_client::on_connection_lost, &async_client::on_message_arrived,
+            nullptr /*&async_client::on_delivery_complete*/
+        );
+    }
+    else {
+        MQTTAsync_setConnected(cli_, nullptr, nullptr);
+
+        guard g(lock_);
+        userCallback_ = nullptr;
+        throw exception(rc);
+    }
+}
+
+void async_client::disable_callbacks()
+{
+    // TODO: It would be nice to disable callbacks at the C library level,
+    // but the setCallback function currently does not accept a nullptr for
+    // the "message arrived" parameter. So, for now we send it an empty
+    // lambda function.
+    int rc = MQTTAsync_setCallbacks(
+        cli_, this, nullptr,
+        [](void*, char*, int, MQTTAsync_message*) -> int { return to_int(true); }, nullptr
+    );
+
+    if (rc != MQTTASYNC_SUCCESS)
+        throw exception(rc);
+}
+
+void async_client::set_connected_handler(connection_handler cb)
+{
+    connHandler_ = cb;
+    check_ret(::MQTTAsync_setConnected(cli_, this, &async_client::on_connected));
+}
+
+void async_client::set_connection_lost_handler(connection_handler cb)
+{
+    connLostHandler_ = cb;
+    check_ret(
+        ::MQTTAsync_setConnectionLostCallback(cli_, this, &async_client::on_connection_lost)
+    );
+}
+
+void async_client::set_disconnected_handler(disconnected_handler cb)
+{
+    disconnectedHandler_ = cb;
+    check_ret(::MQTTAsync_setDisconnected(cli_, this, &async_client::on_disconnected));
+}
+
+void async_client::set_message_callback(message_handler cb)
+{
+    msgHandler_ = cb;
+    check_ret(
+        ::MQTTAsync_setMessageArrivedCallback(cli_, this, &async_client::on_message_arrived)
+    );
+}
+
+void async_client::start_dispatching(
+    std::size_t nThreads, message_handler cb,
+    dispatcher::key_function keyFunc /*=dispatcher::key_function{}*/,
+    std::size_t queCap /*=dispatcher::queue_type::MAX_CAPACITY*/
+)
+{
+    auto disp = std::make_shared<dispatcher>(nThreads, std::move(cb), std::move(keyFunc), queCap);
+
+    // The callback keeps the dispatcher alive on the callback thread,
+    // even if it's replaced while a message is being handed off.
+    set_message_callback([disp](const_message_ptr msg) { disp->dispatch(std::move(msg)); });
+
+    dispatcher_ptr prev;
+    {
+        guard g{lock_};
+        prev = std::move(dispatcher_);
+        dispatcher_ = std::move(disp);
+    }
+    if (prev)
+        prev->stop();
+}
+
+void async_client::stop_dispatching()
+{
+    dispatcher_ptr disp;
+    {
+        guard g{lock_};
+        disp = std::move(dispatcher_);
+    }
+    if (disp) {
+        msgHandler_ = message_handler{};
+        disp->stop();
+    }
+}
+
+void async_client::start_rate_limiting(
+    double msgRate, double byteRate /*=0.0*/,
+    rate_limiter::Policy policy /*=rate_limiter::BLOCK*/, double burstSecs /*=1.0*/
+)
+{
+    auto lim = std::make_shared<rate_limiter>(
+        msgRate, byteRate, policy, burstSecs, get_timer_wheel()
+    );
+
+    rate_limiter_ptr prev;
+    {
+        guard g{lock_};
+        prev = std::move(limiter_);
+        limiter_ = std::move(lim);
+        rateLimited_ = true;
+    }
+    if (prev)
+        prev->stop();
+}
+
+void async_client::stop_rate_limiting()
+{
+    rate_limiter_ptr lim;
+    {
+        guard g{lock_};
+        lim = std::move(limiter_);
+        rateLimited_ = false;
+    }
+    if (lim)
+        lim->stop();
+}
+
+void async_client::start_adaptive_inflight(
+    std::size_t maxWindow, std::size_t minWindow /*=1*/,
+    std::size_t initWindow /*=inflight_window::DFLT_INIT_WINDOW*/,
+    std::size_t maxQueue /*=inflight_window::DFLT_MAX_QUEUE*/
+)
+{
+    auto win = std::make_shared<inflight_window>(
+        maxWindow, minWindow, initWindow, inflight_window::DFLT_DELAY_FACTOR, maxQueue
+    );
+
+    inflight_window_ptr prev;
+    {
+        guard g{lock_};
+        prev = std::move(window_);
+        window_ = std::move(win);
+        windowed_ = true;
+    }
+    if (prev)
+        prev->stop();
+}
+
+void async_client::stop_adaptive_inflight()
+{
+    inflight_window_ptr win;
+    {
+        guard g{lock_};
+        win = std::move(window_);
+        windowed_ = false;
+    }
+    if (win)
+        win->stop();
+}
+
+void async_client::start_publish_retry(
+    retry_policy policy /*=retry_policy{}*/,
+    std::size_t maxDeadLetters /*=publish_retrier::DFLT_MAX_DEAD_LETTERS*/
+)
+{
+    auto rt =
+        std::make_shared<publish_retrier>(std::move(policy), maxDeadLetters, get_timer_wheel());
+
+    publish_retrier_ptr prev;
+    {
+        guard g{lock_};
+        prev = std::move(retrier_);
+        retrier_ = std::move(rt);
+        retrying_ = true;
+    }
+    if (prev)
+        prev->stop();
+}
+
+void async_client::stop_publish_retry()
+{
+    publish_retrier_ptr rt;
+    {
+        guard g{lock_};
+        rt = std::move(retrier_);
+        retrying_ = false;
+    }
+    if (rt)
+        rt->stop();
+}
+
+// The token stays in the table while the retry waits, but without its old
+// message ID, which the library may give to another message, or its slot
+// in the in-flight window, which it takes again when it's sent. A retry
+// that can't even be sent fails the token again, which comes back here, so
+// the backoff and the count of retries apply the same way to both kinds of
+// failures. When the retrier is stopped, the failure completes the token.
+
+bool async_client::retry_delivery(token& tok, int rc, ReasonCode reason)
+{
+    if (!retrying_.load(std::memory_order_relaxed))
+        return false;
+
+    auto rt = get_publish_retrier();
+    if (!rt || !rt->get_policy().is_retryable(rc, reason))
+        return false;
+
+    auto dtok = pendingTokens_.find_delivery_token(&tok);
+    if (!dtok)
+        return false;
+
+    if (dtok->retries_ >= rt->get_policy().get_max_retries()) {
+        rt->add_dead_letter(
+            dead_letter{dtok->get_message(), rc, reason, dtok->retries_, {}}
+        );
+        return false;
+    }
+
+    pendingTokens_.unindex(dtok);
+    if (auto win = std::move(dtok->window_))
+        win->on_lost();
+    auto retry = dtok->retries_++;
+
+    return rt->schedule(retry, [this, dtok](bool due) {
+        if (!due) {
+            fail_token(dtok, MQTTASYNC_OPERATION_INCOMPLETE);
+            return;
+        }
+
+        // While disconnected, the offline buffer can hold it for the reconnect
+        auto buf = offlineBuffered_ ? get_offline_buffer() : offline_buffer_ptr{};
+        if (!buf || is_connected() || !buffer_message(*buf, dtok))
+            send_in_window(dtok);
+    });
+}
+
+void async_client::set_payload_codec(payload_codec_ptr codec, std::size_t minSize /*=0*/)
+{
+    guard g{lock_};
+    hasCodec_ = bool(codec);
+    codec_ = std::move(codec);
+    codecMinSize_ = minSize;
+}
+
+void async_client::start_offline_buffering(
+    std::size_t maxMsgs /*=0*/, std::size_t maxBytes /*=0*/, double drainRate /*=0.0*/
+)
+{
+    auto buf = std::make_shared<offline_buffer>(maxMsgs, maxBytes, drainRate);
+    buf->set_expired_handler([this](const message&) { metrics_.on_expired_sent(); });
+
+    offline_buffer_ptr prev;
+    {
+        guard g{lock_};
+        prev = std::move(offlineBuf_);
+        offlineBuf_ = std::move(buf);
+        offlineBuffered_ = true;
+    }
+    if (prev)
+        prev->stop();
+}
+
+void async_client::stop_offline_buffering()
+{
+    offline_buffer_ptr buf;
+    {
+        guard g{lock_};
+        buf = std::move(offlineBuf_);
+        offlineBuffered_ = false;
+    }
+    if (buf)
+        buf->stop();
+}
+
+void async_client::set_update_connection_handler(update_connection_handler cb)
+{
+    updateConnectionHandler_ = cb;
+    check_ret(
+        ::MQTTAsync_setUpdateConnectOptions(cli_, this, &async_client::on_update_connection)
+    );
+}
+
+// --------------------------------------------------------------------------
+// Connect
+
+token_ptr async_client::connect() { return connect(connect_options{}); }
+
+// The Receive Maximum is a 16-bit value, so a larger queue just uses the
+// largest that can be requested.
+
+void async_client::add_flow_control(connect_options& opts) const
+{
+    if (flowCapacity_ == 0 || opts.opts_.MQTTVersion < MQTTVERSION_5 ||
+        opts.get_properties().contains(property::RECEIVE_MAXIMUM))
+        return;
+
+    properties props{opts.get_properties()};
+    props.add({property::RECEIVE_MAXIMUM, int32_t(std::min<std::size_t>(flowCapacity_, 65535))});
+    opts.set_properties(std::move(props));
+}
+
+token_ptr async_client::connect(connect_options opts)
+{
+    // TODO: We should update the MQTT version from the response
+    //  	(when the server confirms the requested version)
+    mqttVersion_ = opts.opts_.MQTTVersion;
+    add_flow_control(opts);
+
+    // The C lib is very picky about version and clean start/session
+    if (opts.opts_.MQTTVersion < 5)
+        opts.opts_.cleanstart = 0;
+    else
+        opts.opts_.cleansession = 0;
+
+    // TODO: If connTok_ is non-null, there could be a pending connect
+    // which might complete after creating/assigning a new one. If that
+    // happened, the callback would have the context address of the previous
+    // token which was destroyed. So for now, keep the old one alive within
+    // this function, and check the behavior of the C library...
+    auto tmpTok = connTok_;
+    connTok_ = token::create(token::Type::CONNECT, *this);
+    add_token(connTok_);
+
+    opts.set_token(connTok_);
+
+    // TODO: Lock!
+    connOpts_ = std::move(opts);
+    {
+        guard g{lock_};
+        reconnPolicy_ = connOpts_.get_reconnect_policy();
+    }
+    int rc = MQTTAsync_connect(cli_, &connOpts_.opts_);
+
+    if (rc != MQTTASYNC_SUCCESS) {
+        remove_token(connTok_);
+        connTok_.reset();
+        throw exception(rc);
+    }
+
+    UNUSED(tmpTok);
+    return connTok_;
+}
+
+token_ptr async_client::connect(connect_options opts, void* userContext, iaction_listener& cb)
+{
+    // Remember the requested protocol version
+    mqttVersion_ = opts.opts_.MQTTVersion;
+    add_flow_control(opts);
+
+    // The C lib is very picky about version and clean start/session
+    if (opts.opts_.MQTTVersion < 5)
+        opts.opts_.cleanstart = 0;
+    else
+        opts.opts_.cleansession = 0;
+
+    // Keep the old connTok_ alive (see above)
+    auto tmpTok = connTok_;
+    connTok_ = token::create(token::Type::CONNECT, *this, userContext, cb);
+    add_token(connTok_);
+
+    opts.set_token(connTok_);
+
+    connOpts_ = std::move(opts);
+    {
+        guard g{lock_};
+        reconnPolicy_ = connOpts_.get_reconnect_policy();
+    }
+    int rc = MQTTAsync_connect(cli_, &connOpts_.opts_);
+
+    if (rc != MQTTASYNC_SUCCESS) {
+        remove_token(connTok_);
+        connTok_.reset();
+        throw exception(rc);
+    }
+
+    UNUSED(tmpTok);
+    return connTok_;
+}
+
+// --------------------------------------------------------------------------
+// Managed reconnects
+
+// The reconnects run on a thread of their own, since the connection lost
+// callback comes from the C library, which must be free to complete the
+// connect attempts. Waits are done in slices so the thread can be
+// cancelled promptly by a disconnect.
+
+void async_client::start_reconnect()
+{
+    const_reconnect_policy_ptr policy;
+    {
+        guard g{lock_};
+        policy = reconnPolicy_;
+    }
+    if (!policy || connOpts_.get_automatic_reconnect())
+        return;
+
+    guard g{reconnLock_};
+    if (reconnClosed_ || reconnActive_)
+        return;
+
+    if (reconnThr_.joinable())
+        reconnThr_.join();
+
+    reconnActive_ = true;
+    reconnThr_ = std::thread(&async_client::reconnect_loop, this, std::move(policy));
+}
+
+void async_client::stop_reconnect(bool close /*=false*/)
+{
+    std::thread thr;
+    {
+        guard g{reconnLock_};
+        reconnCancel_ = true;
+        if (close)
+            reconnClosed_ = true;
+        thr = std::move(reconnThr_);
+    }
+    reconnCond_.notify_all();
+
+    if (thr.joinable()) {
+        if (thr.get_id() == std::this_thread::get_id())
+            thr.detach();
+        else
+            thr.join();
+    }
+
+    guard g{reconnLock_};
+    reconnCancel_ = false;
+    reconnActive_ = false;
+}
+
+// The flag is per thread, not per client, since the C library runs the
+// callbacks for all the clients on the same thread.
+
+void async_client::check_callback_thread() const
+{
+    thread_local bool applied = false;
+
+    if (!applied) {
+        const auto& opts = createOpts_.get_thread_options();
+        if (!opts.empty()) {
+            applied = true;
+            opts.apply(thread_role::CLIENT_CALLBACK);
+        }
+    }
+}
+
+void async_client::reconnect_loop(const_reconnect_policy_ptr policy)
+{
+    static constexpr auto WAIT_SLICE = std::chrono::milliseconds(100);
+
+    const auto& threadOpts = createOpts_.get_thread_options();
+    if (!threadOpts.empty())
+        threadOpts.apply(thread_role::RECONNECT);
+
+    std::mt19937 rng{std::random_device{}()};
+    std::uniform_real_distribution<double> jitter{0.0, 1.0};
+
+    auto cancelled = [this] { return reconnCancel_ || reconnClosed_; };
+    auto maxAttempts = policy->get_max_attempts();
+
+    for (unsigned i = 0; maxAttempts == 0 || i < maxAttempts; ++i) {
+        {
+            guard g{reconnLock_};
+            if (reconnCond_.wait_for(g, policy->get_delay(i, jitter(rng)), cancelled))
+                break;
+        }
+
+        try {
+            auto opts = connOpts_;
+            auto servers = opts.get_servers();
+
+            auto racer = policy->get_endpoint_racer();
+            if (racer && servers && servers->size() > 1) {
+#if !defined(_WIN32)
+                // Start with whichever server answers first
+                racer->apply(opts);
+#endif
+            }
+            // Start each attempt with the next server in the list
+            else if (policy->get_rotate_servers() && servers && servers->size() > 1) {
+                auto rotated = std::make_shared<string_collection>();
+                for (size_t j = 1; j <= servers->size(); ++j)
+                    rotated->push_back((*servers)[j % servers->size()]);
+                opts.set_servers(rotated);
+            }
+
+            auto tok = connect(std::move(opts));
+
+            bool done = false, stop = false;
+            while (!done && !stop) {
+                done = tok->wait_for(WAIT_SLICE);
+                guard g{reconnLock_};
+                stop = cancelled();
+            }
+            if (done || stop)
+                break;
+        }
+        catch (const exception&) {
+        }
+    }
+
+    guard g{reconnLock_};
+    reconnActive_ = false;
+}
+
+// --------------------------------------------------------------------------
+// Re-connect
+
+token_ptr async_client::reconnect()
+{
+    auto tok = connTok_;
+
+    if (!tok)
+        throw exception(MQTTASYNC_FAILURE, "Can't reconnect before a successful connect");
+
+    tok->reset();
+    add_token(tok);
 
     int rc = MQTTAsync_setConnected(cli_, this, &async_client::on_connected);
 
@@ -493,145 +1904,644 @@ token_ptr async_client::reconnect()
 
 token_ptr async_client::disconnect(disconnect_options opts)
 {
+    stop_reconnect();
+
     auto tok = token::create(token::Type::DISCONNECT, *this);
     add_token(tok);
 
-    opts.set_token(tok, mqttVersion_);
+    opts.set_token(tok, mqttVersion_);
+
+    int rc = MQTTAsync_disconnect(cli_, &opts.opts_);
+
+    if (rc != MQTTASYNC_SUCCESS) {
+        remove_token(tok);
+        throw exception(rc);
+    }
+
+    return tok;
+}
+
+token_ptr async_client::disconnect(int timeout, void* userContext, iaction_listener& cb)
+{
+    stop_reconnect();
+
+    auto tok = token::create(token::Type::DISCONNECT, *this, userContext, cb);
+    add_token(tok);
+
+    disconnect_options opts(timeout);
+    opts.set_token(tok, mqttVersion_);
+
+    int rc = MQTTAsync_disconnect(cli_, &opts.opts_);
+
+    if (rc != MQTTASYNC_SUCCESS) {
+        remove_token(tok);
+        throw exception(rc);
+    }
+
+    return tok;
+}
+
+// --------------------------------------------------------------------------
+// Queries
+
+delivery_token_ptr async_client::get_pending_delivery_token(int msgID) const
+{
+    // Messages with QOS=1 or QOS=2 that require a response/acknowledge should
+    // have a non-zero 16-bit message ID. The library keeps the token objects
+    // for all of these messages that are in flight. When the acknowledge comes
+    // back from the broker, the C++ library can look up the token from the
+    // msgID and signal it, indicating completion.
+
+    return pendingTokens_.get_delivery_token(msgID);
+}
+
+std::vector<delivery_token_ptr> async_client::get_pending_delivery_tokens() const
+{
+    return pendingTokens_.get_delivery_tokens();
+}
+
+// Held QoS 0 messages are sent right away, since there's no point waiting
+// on the coalescer's timer.
+
+std::vector<delivery_token_ptr> async_client::flush(
+    const std::chrono::steady_clock::time_point& deadline
+)
+{
+    flush_publishes();
+
+    if (pendingTokens_.wait_drained(deadline))
+        return std::vector<delivery_token_ptr>{};
+
+    return pendingTokens_.get_incomplete_delivery_tokens();
+}
+
+async_client::flush_result async_client::flush_and_disconnect(
+    const std::chrono::steady_clock::time_point& deadline, disconnect_options opts
+)
+{
+    flush_result res;
+    res.undelivered = flush(deadline);
+    res.disconnectTok = disconnect(std::move(opts));
+    return res;
+}
+
+std::size_t async_client::num_interned_topics() const
+{
+    guard g(internLock_);
+    return internedTopics_.size();
+}
+
+void async_client::clear_interned_topics()
+{
+    guard g(internLock_);
+    internedTopics_.clear();
+}
+
+// --------------------------------------------------------------------------
+// Publish
+
+delivery_token_ptr async_client::publish(
+    string_ref topic, const void* payload, size_t n, int qos, bool retained,
+    const properties& props /*=properties()*/
+)
+{
+    auto msg = message::create(std::move(topic), payload, n, qos, retained, props);
+    return publish(std::move(msg));
+}
+
+delivery_token_ptr async_client::publish(
+    string_ref topic, binary_ref payload, int qos, bool retained,
+    const properties& props /*=properties()*/
+)
+{
+    auto msg = message::create(std::move(topic), std::move(payload), qos, retained, props);
+    return publish(std::move(msg));
+}
+
+delivery_token_ptr async_client::publish(
+    string_ref topic, const std::vector<binary_view>& bufs,
+    int qos /*=message::DFLT_QOS*/, bool retained /*=message::DFLT_RETAINED*/,
+    const properties& props /*=properties()*/
+)
+{
+    size_t n = 0;
+    for (const auto& buf : bufs) n += buf.size();
+
+    binary payload;
+    payload.reserve(n);
+    for (const auto& buf : bufs) payload.append(buf.data(), buf.size());
+
+    // The payload string is moved into the message, not copied.
+    auto msg = message::create(
+        std::move(topic), binary_ref{std::move(payload)}, qos, retained, props
+    );
+    return publish(std::move(msg));
+}
+
+delivery_token_ptr async_client::publish(
+    string_ref topic, const void* payload, size_t n, int qos, bool retained,
+    void* userContext, iaction_listener& cb
+)
+{
+    auto msg = message::create(std::move(topic), payload, n, qos, retained);
+    return publish(std::move(msg), userContext, cb);
+}
+
+// Only QoS 0 messages are aliased, since the library might send others
+// again on a new connection, where the alias is no longer valid. A message
+// that already has an alias from the app is left alone.
+
+int async_client::send_message(
+    const string& topic, const MQTTAsync_message& cmsg, MQTTAsync_responseOptions& opts
+)
+{
+    auto cprops = const_cast<MQTTProperties*>(&cmsg.properties);
+
+    int rc;
+
+    if (!aliases_ || cmsg.qos != 0 ||
+        MQTTProperties_hasProperty(cprops, MQTTPROPERTY_CODE_TOPIC_ALIAS))
+        rc = MQTTAsync_sendMessage(cli_, topic.c_str(), &cmsg, &opts);
+    else
+        rc = send_aliased(topic, cmsg, opts);
+
+    PAHO_MQTTPP_PROBE4(send_message, rc, opts.token, topic.size(), cmsg.payloadlen);
+
+    if (rc == MQTTASYNC_SUCCESS) {
+        metrics_.on_sent(cmsg.qos, size_t(cmsg.payloadlen));
+        if (hasTopicStats_) {
+            if (auto stats = get_topic_stats())
+                stats->on_sent(topic, size_t(cmsg.payloadlen));
+        }
+    }
+    return rc;
+}
+
+int async_client::send_aliased(
+    const string& topic, const MQTTAsync_message& cmsg, MQTTAsync_responseOptions& opts
+)
+{
+    return aliases_->send(topic, [&](uint16_t alias, bool established) {
+        if (alias == 0)
+            return MQTTAsync_sendMessage(cli_, topic.c_str(), &cmsg, &opts);
+
+        properties props{cmsg.properties};
+        props.add({property::TOPIC_ALIAS, int32_t(alias)});
+
+        auto amsg = cmsg;
+        amsg.properties = props.c_struct();
+        return MQTTAsync_sendMessage(cli_, established ? "" : topic.c_str(), &amsg, &opts);
+    });
+}
+
+// The payloads are encoded as they're handed to the library, rather than
+// when they're published, so that a message that's held back, dropped, or
+// refused doesn't leave a gap in the deltas of its topic, and the ones
+// that are held go out as deltas in the order they're actually sent.
+
+int async_client::send_message(const delivery_token_ptr& tok)
+{
+    auto dc = (hasDeltaCodec_ && mqttVersion_ >= MQTTVERSION_5) ? get_delta_codec()
+                                                                 : delta_codec_ptr{};
+    if (!dc)
+        return send_encoded(tok, encode_payload(tok->get_message()));
+
+    int rc = MQTTASYNC_FAILURE;
+    dc->encode(tok->get_message(), [&](const const_message_ptr& msg) {
+        rc = send_encoded(tok, encode_payload(msg));
+        return rc == MQTTASYNC_SUCCESS;
+    });
+    return rc;
+}
+
+// The token has the encoded message while it's being sent, since the
+// library may complete it from another thread before the call returns.
+// If the library refuses it, the token gets the original back, to be
+// encoded again if it's sent again.
+
+int async_client::send_encoded(const delivery_token_ptr& tok, const_message_ptr msg)
+{
+    auto orig = tok->get_message();
+    if (msg != orig)
+        tok->set_message(msg);
+
+    delivery_response_options rspOpts(tok, mqttVersion_);
+
+    if (msg->get_qos() > 0)
+        tok->sendTime_ = std::chrono::steady_clock::now();
+
+    int rc = send_message(msg->get_topic(), msg->msg_, rspOpts.opts_);
+
+    if (auto tr = tracer_.load(std::memory_order_relaxed))
+        tr->message_sent(*tok, rc, message_tracer::clock::now());
+
+    if (rc == MQTTASYNC_SUCCESS) {
+        tok->set_message_id(rspOpts.opts_.token);
+        pendingTokens_.index(tok);
+    }
+    else if (msg != orig) {
+        tok->set_message(std::move(orig));
+    }
+    return rc;
+}
+
+// A message that's held back, by a queueing rate limiter, the in-flight
+// window, a retry, or the coalescer, has its token returned before the
+// message is sent, so it gets the same fallbacks as a publish that's sent
+// right away, just later. If the connection dropped, it goes to the offline
+// buffer. Any other failure is reported through the token, which retries
+// it if it can, or removes it from the table. Since the library doesn't
+// have it, it gives back its slot in the window first, as a loss.
+
+void async_client::send_held_message(const delivery_token_ptr& tok)
+{
+    int rc = send_message(tok);
+    if (rc == MQTTASYNC_SUCCESS)
+        return;
+
+    if (auto win = std::move(tok->window_))
+        win->on_lost();
+
+    auto buf = offlineBuffered_ ? get_offline_buffer() : offline_buffer_ptr{};
+    if (rc == MQTTASYNC_DISCONNECTED && buf && buffer_message(*buf, tok))
+        return;
+
+    fail_token(tok, rc);
+}
+
+// The token keeps the window it has a slot in, so the slot goes back to
+// that one, even if the window is replaced while the message is in flight.
+// The window holds the task, so the task only holds the window weakly.
+
+inflight_window::task_type async_client::window_task(
+    const inflight_window_ptr& win, const delivery_token_ptr& tok
+)
+{
+    return [this, tok, w = std::weak_ptr<inflight_window>(win)](bool ok) {
+        auto win = w.lock();
+        if (!ok || !win) {
+            fail_token(tok, MQTTASYNC_OPERATION_INCOMPLETE);
+            return;
+        }
+        tok->window_ = std::move(win);
+        send_held_message(tok);
+    };
+}
+
+void async_client::send_in_window(const delivery_token_ptr& tok)
+{
+    auto win = windowed_ ? get_inflight_window() : inflight_window_ptr{};
+
+    if (!win || tok->get_message()->get_qos() == 0)
+        send_held_message(tok);
+    else if (!win->submit(window_task(win, tok))) {
+        int rc = win->stopped() ? MQTTASYNC_OPERATION_INCOMPLETE
+                                : MQTTASYNC_MAX_BUFFERED_MESSAGES;
+        fail_token(tok, rc);
+    }
+}
+
+void async_client::fail_token(const delivery_token_ptr& tok, int rc)
+{
+    MQTTAsync_failureData rsp{};
+    rsp.code = rc;
+    tok->on_failure(&rsp);
+}
+
+// A buffered message that the library won't take because the client lost
+// the connection again stays in the buffer for the next one. Any other
+// failure is final, and reported through the token.
+
+bool async_client::buffer_message(offline_buffer& buf, const delivery_token_ptr& tok)
+{
+    return buf.add(tok->get_message(), [this, tok](bool send) {
+        if (!send) {
+            fail_token(tok, MQTTASYNC_OPERATION_INCOMPLETE);
+            return true;
+        }
+
+        int rc = send_message(tok);
+        if (rc == MQTTASYNC_DISCONNECTED)
+            return false;
+
+        if (rc != MQTTASYNC_SUCCESS)
+            fail_token(tok, rc);
+        return true;
+    });
+}
+
+// The encoded message is a copy, so the caller's message is untouched,
+// and keeps its original payload.
+
+const_message_ptr async_client::encode_payload(const_message_ptr msg) const
+{
+    if (!hasCodec_ || mqttVersion_ < MQTTVERSION_5)
+        return msg;
+
+    payload_codec_ptr codec;
+    std::size_t minSize;
+    {
+        guard g{lock_};
+        codec = codec_;
+        minSize = codecMinSize_;
+    }
+    return codec ? encode_payload(*codec, minSize, std::move(msg)) : msg;
+}
+
+const_message_ptr async_client::encode_payload(
+    const payload_codec& codec, std::size_t minSize, const_message_ptr msg
+) const
+{
+    const auto& payload = msg->get_payload();
+    if (payload.empty() || payload.size() < minSize)
+        return msg;
+
+    const auto& props = msg->get_properties();
+    if (!payload_codec::get_encoding(props).empty())
+        return msg;
+
+    auto enc = codec.encode(payload);
+    if (enc.size() >= payload.size())
+        return msg;
+
+    auto encProps = props;
+    encProps.add({property::USER_PROPERTY, payload_codec::ENCODING_PROPERTY, codec.name()});
+
+    auto emsg = std::make_shared<message>(*msg);
+    emsg->set_payload(std::move(enc));
+    emsg->set_properties(std::move(encProps));
+    return emsg;
+}
+
+// The trace context only goes in the message for MQTT v5, but it's kept
+// in the token in any case, for the other hooks.
+
+void async_client::begin_trace(message_tracer& tr, const delivery_token_ptr& tok)
+{
+    const auto& msg = tok->get_message();
+    auto ctx = tr.publish_begin(*msg, message_tracer::clock::now());
+
+    auto cur = message_tracer::get_trace_context(msg->get_properties());
+    if (!cur.empty()) {
+        tok->traceCtx_ = std::move(cur);
+        return;
+    }
+
+    if (ctx.empty())
+        return;
+
+    if (mqttVersion_ >= MQTTVERSION_5) {
+        auto props = msg->get_properties();
+        props.add({property::USER_PROPERTY, message_tracer::TRACE_PROPERTY, ctx});
+
+        auto tmsg = std::make_shared<message>(*msg);
+        tmsg->set_properties(std::move(props));
+        tok->set_message(std::move(tmsg));
+    }
+    tok->traceCtx_ = std::move(ctx);
+}
+
+publish_result async_client::try_publish_token(delivery_token_ptr tok)
+{
+    PAHO_MQTTPP_PROBE3(
+        publish_entry, tok->get_message()->get_topic().size(),
+        tok->get_message()->get_payload().size(), tok->get_message()->get_qos()
+    );
+
+    if (auto tr = tracer_.load(std::memory_order_relaxed))
+        begin_trace(*tr, tok);
+
+    add_token(tok);
+
+    auto buf = offlineBuffered_ ? get_offline_buffer() : offline_buffer_ptr{};
 
-    int rc = MQTTAsync_disconnect(cli_, &opts.opts_);
+    if (buf && !is_connected()) {
+        if (!buffer_message(*buf, tok)) {
+            remove_token(tok);
+            return publish_result::error(MQTTASYNC_MAX_BUFFERED_MESSAGES);
+        }
+        return tok;
+    }
 
-    if (rc != MQTTASYNC_SUCCESS) {
-        remove_token(tok);
-        throw exception(rc);
+    auto lim = rateLimited_ ? get_rate_limiter() : rate_limiter_ptr{};
+
+    if (lim) {
+        auto n = tok->get_message()->get_payload().size();
+
+        switch (lim->get_policy()) {
+            case rate_limiter::BLOCK:
+                if (!lim->acquire(n)) {
+                    remove_token(tok);
+                    return publish_result::error(
+                        MQTTASYNC_FAILURE, ReasonCode::SUCCESS, "Rate limiter stopped"
+                    );
+                }
+                break;
+
+            case rate_limiter::FAIL:
+                if (!lim->try_acquire(n)) {
+                    remove_token(tok);
+                    return publish_result::error(
+                        MQTTASYNC_FAILURE, ReasonCode::QUOTA_EXCEEDED,
+                        "Publish rate limit exceeded"
+                    );
+                }
+                break;
+
+            case rate_limiter::QUEUE: {
+                auto task = [this, tok](bool ok) {
+                    if (ok)
+                        send_in_window(tok);
+                    else
+                        fail_token(tok, MQTTASYNC_OPERATION_INCOMPLETE);
+                };
+                auto prio = tok->get_message()->get_priority();
+                if (!lim->submit(n, std::move(task), prio)) {
+                    remove_token(tok);
+                    return publish_result::error(
+                        MQTTASYNC_FAILURE, ReasonCode::SUCCESS, "Rate limiter stopped"
+                    );
+                }
+                return tok;
+            }
+        }
     }
 
-    return tok;
-}
+    auto win = windowed_ ? get_inflight_window() : inflight_window_ptr{};
 
-token_ptr async_client::disconnect(int timeout, void* userContext, iaction_listener& cb)
-{
-    auto tok = token::create(token::Type::DISCONNECT, *this, userContext, cb);
-    add_token(tok);
+    if (win && tok->get_message()->get_qos() > 0) {
+        if (!win->submit(window_task(win, tok))) {
+            remove_token(tok);
+            if (win->stopped())
+                return publish_result::error(
+                    MQTTASYNC_FAILURE, ReasonCode::SUCCESS, "In-flight window stopped"
+                );
+            return publish_result::error(MQTTASYNC_MAX_BUFFERED_MESSAGES);
+        }
+        return tok;
+    }
 
-    disconnect_options opts(timeout);
-    opts.set_token(tok, mqttVersion_);
+    if (coalescer_ && tok->get_message()->get_qos() == 0) {
+        const auto& msg = tok->get_message();
+        auto n = msg->get_topic().size() + msg->get_payload().size();
+        coalescer_->add(n, [this, tok] { send_held_message(tok); });
+        return tok;
+    }
 
-    int rc = MQTTAsync_disconnect(cli_, &opts.opts_);
+    int rc = send_message(tok);
+    PAHO_MQTTPP_PROBE2(publish_return, tok->get_message_id(), rc);
+
+    // The connection may have dropped since it was checked
+    if (rc == MQTTASYNC_DISCONNECTED && buf && buffer_message(*buf, tok))
+        return tok;
 
     if (rc != MQTTASYNC_SUCCESS) {
+        if (retrying_ && retry_delivery(*tok, rc, ReasonCode::SUCCESS))
+            return tok;
         remove_token(tok);
-        throw exception(rc);
+        return publish_result::error(rc);
     }
 
     return tok;
 }
 
-// --------------------------------------------------------------------------
-// Queries
-
-delivery_token_ptr async_client::get_pending_delivery_token(int msgID) const
+delivery_token_ptr async_client::publish_token(delivery_token_ptr tok)
 {
-    // Messages with QOS=1 or QOS=2 that require a response/acknowledge should
-    // have a non-zero 16-bit message ID. The library keeps the token objects
-    // for all of these messages that are in flight. When the acknowledge comes
-    // back from the broker, the C++ library can look up the token from the
-    // msgID and signal it, indicating completion.
-
-    if (msgID > 0) {
-        guard g(lock_);
-        const auto it = std::find_if(
-            pendingDeliveryTokens_.cbegin(), pendingDeliveryTokens_.cend(),
-            [msgID](const auto& t) { return t->get_message_id() == msgID; }
-        );
-        if (it != pendingDeliveryTokens_.end())
-            return *it;
-    }
-    return delivery_token_ptr();
+    return try_publish_token(std::move(tok)).value();
 }
 
-std::vector<delivery_token_ptr> async_client::get_pending_delivery_tokens() const
+delivery_token_ptr async_client::publish(const_message_ptr msg)
 {
-    std::vector<delivery_token_ptr> toks;
-    guard g(lock_);
-    for (const auto& t : pendingDeliveryTokens_) {
-        if (t->get_message_id() > 0) {
-            toks.push_back(t);
-        }
-    }
-    return toks;
+    return publish_token(delivery_token::create(*this, std::move(msg)));
 }
 
-// --------------------------------------------------------------------------
-// Publish
+publish_result async_client::try_publish(const_message_ptr msg)
+{
+    return try_publish_token(delivery_token::create(*this, std::move(msg)));
+}
 
-delivery_token_ptr async_client::publish(
+publish_result async_client::try_publish(
     string_ref topic, const void* payload, size_t n, int qos, bool retained,
     const properties& props /*=properties()*/
 )
 {
     auto msg = message::create(std::move(topic), payload, n, qos, retained, props);
-    return publish(std::move(msg));
+    return try_publish(std::move(msg));
 }
 
-delivery_token_ptr async_client::publish(
+publish_result async_client::try_publish(
     string_ref topic, binary_ref payload, int qos, bool retained,
     const properties& props /*=properties()*/
 )
 {
     auto msg = message::create(std::move(topic), std::move(payload), qos, retained, props);
-    return publish(std::move(msg));
+    return try_publish(std::move(msg));
 }
 
-delivery_token_ptr async_client::publish(
-    string_ref topic, const void* payload, size_t n, int qos, bool retained,
-    void* userContext, iaction_listener& cb
+// The C library copies the topic, payload, and properties before the call
+// returns, so they can be passed straight from the caller's memory.
+
+void async_client::publish_qos0(
+    const string& topic, const void* payload, size_t n,
+    bool retained /*=message::DFLT_RETAINED*/, const properties& props /*=properties()*/
 )
 {
-    auto msg = message::create(std::move(topic), payload, n, qos, retained);
-    return publish(std::move(msg), userContext, cb);
+    int rc = try_publish_qos0(topic, payload, n, retained, props);
+    if (rc != MQTTASYNC_SUCCESS)
+        throw exception(rc);
 }
 
-delivery_token_ptr async_client::publish(const_message_ptr msg)
+int async_client::try_publish_qos0(
+    const string& topic, const void* payload, size_t n,
+    bool retained /*=message::DFLT_RETAINED*/, const properties& props /*=properties()*/
+)
 {
-    auto tok = delivery_token::create(*this, msg);
-    add_token(tok);
-
-    delivery_response_options rspOpts(tok, mqttVersion_);
+    // A held message needs its own copy of everything
+    if (coalescer_) {
+        auto msg = message::create(topic, payload, n, 0, retained, props);
+        coalescer_->add(topic.size() + n, [this, msg] {
+            MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+            send_message(msg->get_topic(), msg->msg_, opts);
+        });
+        return MQTTASYNC_SUCCESS;
+    }
 
-    int rc =
-        MQTTAsync_sendMessage(cli_, msg->get_topic().c_str(), &(msg->msg_), &rspOpts.opts_);
+    MQTTAsync_message cmsg = MQTTAsync_message_initializer;
+    cmsg.payload = const_cast<void*>(payload);
+    cmsg.payloadlen = int(n);
+    cmsg.qos = 0;
+    cmsg.retained = to_int(retained);
+    cmsg.properties = props.c_struct();
 
-    if (rc == MQTTASYNC_SUCCESS) {
-        tok->set_message_id(rspOpts.opts_.token);
-    }
-    else {
-        remove_token(tok);
-        throw exception(rc);
-    }
+    MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
 
-    return tok;
+    return send_message(topic, cmsg, opts);
 }
 
 delivery_token_ptr async_client::publish(
     const_message_ptr msg, void* userContext, iaction_listener& cb
 )
 {
-    delivery_token_ptr tok = delivery_token::create(*this, msg, userContext, cb);
-    add_token(tok);
+    return publish_token(delivery_token::create(*this, std::move(msg), userContext, cb));
+}
 
-    delivery_response_options rspOpts(tok, mqttVersion_);
+// Each message gets its own C callback context, pointing back into the
+// batch token, so the whole batch only needs a single entry in the table
+// of pending tokens. The messages go through the same low-level send as
+// a single publish, for the topic aliases and the statistics. Like a
+// single publish, the token has the encoded message while it's being
+// sent, and gets the original back if the library refuses it.
 
-    int rc =
-        MQTTAsync_sendMessage(cli_, msg->get_topic().c_str(), &(msg->msg_), &rspOpts.opts_);
+batch_token_ptr async_client::publish_batch(std::vector<const_message_ptr> msgs)
+{
+    auto tok = batch_token::create(*this, std::move(msgs));
 
-    if (rc == MQTTASYNC_SUCCESS) {
-        tok->set_message_id(rspOpts.opts_.token);
-    }
-    else {
-        remove_token(tok);
-        throw exception(rc);
+    size_t n = tok->size();
+    if (n == 0)
+        return tok;
+
+    add_token(tok);
+
+    auto dc = (hasDeltaCodec_ && mqttVersion_ >= MQTTVERSION_5) ? get_delta_codec()
+                                                                 : delta_codec_ptr{};
+
+    int firstRc = MQTTASYNC_SUCCESS;
+    size_t nAccepted = 0;
+
+    // Like a single publish, each message is encoded as it's sent
+    auto send = [&](size_t i, const_message_ptr msg) {
+        const auto& emsg = tok->msgs_[i] = encode_payload(std::move(msg));
+        auto opts = tok->response_options(i, mqttVersion_);
+        return send_message(emsg->get_topic(), emsg->msg_, opts);
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+        auto orig = tok->msgs_[i];
+        int rc = MQTTASYNC_FAILURE;
+        if (dc) {
+            dc->encode(orig, [&](const const_message_ptr& msg) {
+                rc = send(i, msg);
+                return rc == MQTTASYNC_SUCCESS;
+            });
+        }
+        else {
+            rc = send(i, orig);
+        }
+
+        if (rc == MQTTASYNC_SUCCESS) {
+            ++nAccepted;
+        }
+        else {
+            tok->msgs_[i] = std::move(orig);
+            if (firstRc == MQTTASYNC_SUCCESS)
+                firstRc = rc;
+            tok->on_item_complete(i, rc);
+        }
     }
 
+    if (nAccepted == 0)
+        throw exception(firstRc);
+
     return tok;
 }
 
@@ -643,6 +2553,30 @@ token_ptr async_client::subscribe(
     const subscribe_options& opts /*=subscribe_options()*/,
     const properties& props /*=properties()*/
 )
+{
+    check_user_sub_id(props);
+    return subscribe_filter(topicFilter, qos, opts, props);
+}
+
+token_ptr async_client::subscribe_filter(
+    const string& topicFilter, int qos, const subscribe_options& opts, const properties& props
+)
+{
+    return try_subscribe_filter(topicFilter, qos, opts, props).value();
+}
+
+token_result async_client::try_subscribe(
+    const string& topicFilter, int qos, const subscribe_options& opts /*=subscribe_options()*/,
+    const properties& props /*=properties()*/
+)
+{
+    check_user_sub_id(props);
+    return try_subscribe_filter(topicFilter, qos, opts, props);
+}
+
+token_result async_client::try_subscribe_filter(
+    const string& topicFilter, int qos, const subscribe_options& opts, const properties& props
+)
 {
     auto tok = token::create(token::Type::SUBSCRIBE, *this, topicFilter);
     tok->set_num_expected(0);  // Indicates non-array response for single val
@@ -658,9 +2592,10 @@ token_ptr async_client::subscribe(
 
     if (rc != MQTTASYNC_SUCCESS) {
         remove_token(tok);
-        throw exception(rc);
+        return token_result::error(rc);
     }
 
+    remember_subscription(topicFilter, qos);
     return tok;
 }
 
@@ -670,6 +2605,8 @@ token_ptr async_client::subscribe(
     const properties& props /*=properties()*/
 )
 {
+    check_user_sub_id(props);
+
     auto tok = token::create(token::Type::SUBSCRIBE, *this, topicFilter, userContext, cb);
     tok->set_num_expected(0);
     add_token(tok);
@@ -687,9 +2624,41 @@ token_ptr async_client::subscribe(
         throw exception(rc);
     }
 
+    remember_subscription(topicFilter, qos);
     return tok;
 }
 
+token_ptr async_client::subscribe(
+    const string& topicFilter, int qos, message_handler cb,
+    const subscribe_options& opts /*=subscribe_options()*/,
+    const properties& props /*=properties()*/
+)
+{
+    // Install the handler first, to catch any retained messages that
+    // might arrive before the subscribe completes.
+    check_ret(
+        ::MQTTAsync_setMessageArrivedCallback(cli_, this, &async_client::on_message_arrived)
+    );
+
+    bool tagged = mqttVersion_ >= MQTTVERSION_5 && subIdsAvailable_ &&
+                  !props.contains(property::SUBSCRIPTION_IDENTIFIER);
+
+    auto id = add_sub_handler(topicFilter, std::move(cb), tagged);
+
+    try {
+        if (id != 0) {
+            properties subProps{props};
+            subProps.add({property::SUBSCRIPTION_IDENTIFIER, int32_t(id)});
+            return subscribe_filter(topicFilter, qos, opts, subProps);
+        }
+        return subscribe(topicFilter, qos, opts, props);
+    }
+    catch (...) {
+        remove_sub_handler(topicFilter);
+        throw;
+    }
+}
+
 token_ptr async_client::subscribe(
     const_string_collection_ptr topicFilters, const qos_collection& qos,
     const std::vector<subscribe_options>& opts
@@ -702,6 +2671,8 @@ token_ptr async_client::subscribe(
     if (n != qos.size())
         throw std::invalid_argument("Collection sizes don't match");
 
+    check_user_sub_id(props);
+
     auto tok = token::create(token::Type::SUBSCRIBE, *this, topicFilters);
     tok->set_num_expected(n);
     add_token(tok);
@@ -721,6 +2692,7 @@ token_ptr async_client::subscribe(
         throw exception(rc);
     }
 
+    for (size_t i = 0; i < n; ++i) remember_subscription((*topicFilters)[i], qos[i]);
     return tok;
 }
 
@@ -737,6 +2709,8 @@ token_ptr async_client::subscribe(
     if (n != qos.size())
         throw std::invalid_argument("Collection sizes don't match");
 
+    check_user_sub_id(props);
+
     auto tok = token::create(token::Type::SUBSCRIBE, *this, topicFilters, userContext, cb);
     tok->set_num_expected(n);
     add_token(tok);
@@ -756,6 +2730,77 @@ token_ptr async_client::subscribe(
         throw exception(rc);
     }
 
+    for (size_t i = 0; i < n; ++i) remember_subscription((*topicFilters)[i], qos[i]);
+    return tok;
+}
+
+// Each chunk is a single request to the C library, pointing into the arrays
+// of the whole batch, which the library copies before the call returns.
+
+batch_token_ptr async_client::subscribe_batch(
+    const_string_collection_ptr topicFilters, const qos_collection& qos,
+    const std::vector<subscribe_options>& opts
+    /*=std::vector<subscribe_options>()*/,
+    const properties& props /*=properties()*/
+)
+{
+    size_t n = topicFilters->size();
+
+    if (n != qos.size() || (!opts.empty() && n != opts.size()))
+        throw std::invalid_argument("Collection sizes don't match");
+
+    check_user_sub_id(props);
+
+    auto tok = batch_token::create(
+        *this, token::Type::SUBSCRIBE, topicFilters, subChunkSize_.load()
+    );
+
+    if (n == 0)
+        return tok;
+
+    std::vector<MQTTSubscribe_options> subOpts;
+    if (mqttVersion_ >= MQTTVERSION_5) {
+        subOpts.reserve(opts.size());
+        for (const auto& opt : opts) subOpts.push_back(opt.opts_);
+    }
+
+    add_token(tok);
+
+    int firstRc = MQTTASYNC_SUCCESS;
+    size_t nAccepted = 0;
+
+    for (size_t i = 0; i < tok->num_requests(); ++i) {
+        const auto& itm = tok->items_[i];
+        auto rspOpts = tok->response_options(i, mqttVersion_);
+
+        if (mqttVersion_ >= MQTTVERSION_5) {
+            rspOpts.properties = props.c_struct();
+            if (!subOpts.empty()) {
+                rspOpts.subscribeOptionsCount = int(itm.count);
+                rspOpts.subscribeOptionsList = subOpts.data() + itm.first;
+            }
+        }
+
+        int rc = MQTTAsync_subscribeMany(
+            cli_, int(itm.count), topicFilters->c_arr() + itm.first,
+            const_cast<int*>(qos.data()) + itm.first, &rspOpts
+        );
+
+        if (rc == MQTTASYNC_SUCCESS) {
+            ++nAccepted;
+            for (size_t j = itm.first; j < itm.first + itm.count; ++j)
+                remember_subscription((*topicFilters)[j], qos[j]);
+        }
+        else {
+            if (firstRc == MQTTASYNC_SUCCESS)
+                firstRc = rc;
+            tok->on_item_complete(i, rc);
+        }
+    }
+
+    if (nAccepted == 0)
+        throw exception(firstRc);
+
     return tok;
 }
 
@@ -765,6 +2810,16 @@ token_ptr async_client::subscribe(
 token_ptr async_client::
     unsubscribe(const string& topicFilter, const properties& props /*=properties()*/)
 {
+    return try_unsubscribe(topicFilter, props).value();
+}
+
+token_result async_client::try_unsubscribe(
+    const string& topicFilter, const properties& props /*=properties()*/
+)
+{
+    remove_sub_handler(topicFilter);
+    forget_subscription(topicFilter);
+
     auto tok = token::create(token::Type::UNSUBSCRIBE, *this, topicFilter);
     tok->set_num_expected(0);  // Indicates non-array response for single val
     add_token(tok);
@@ -776,7 +2831,7 @@ token_ptr async_client::
 
     if (rc != MQTTASYNC_SUCCESS) {
         remove_token(tok);
-        throw exception(rc);
+        return token_result::error(rc);
     }
 
     return tok;
@@ -788,6 +2843,11 @@ token_ptr async_client::unsubscribe(
 {
     size_t n = topicFilters->size();
 
+    for (size_t i = 0; i < n; ++i) {
+        remove_sub_handler((*topicFilters)[i]);
+        forget_subscription((*topicFilters)[i]);
+    }
+
     auto tok = token::create(token::Type::UNSUBSCRIBE, *this, topicFilters);
     tok->set_num_expected(n);
     add_token(tok);
@@ -812,6 +2872,11 @@ token_ptr async_client::unsubscribe(
 {
     size_t n = topicFilters->size();
 
+    for (size_t i = 0; i < n; ++i) {
+        remove_sub_handler((*topicFilters)[i]);
+        forget_subscription((*topicFilters)[i]);
+    }
+
     auto tok = token::create(token::Type::UNSUBSCRIBE, *this, topicFilters, userContext, cb);
     tok->set_num_expected(n);
     add_token(tok);
@@ -834,6 +2899,9 @@ token_ptr async_client::unsubscribe(
     const properties& props /*=properties()*/
 )
 {
+    remove_sub_handler(topicFilter);
+    forget_subscription(topicFilter);
+
     auto tok = token::create(token::Type::UNSUBSCRIBE, *this, topicFilter, userContext, cb);
     add_token(tok);
 
@@ -850,17 +2918,72 @@ token_ptr async_client::unsubscribe(
     return tok;
 }
 
+batch_token_ptr async_client::unsubscribe_batch(
+    const_string_collection_ptr topicFilters, const properties& props /*=properties()*/
+)
+{
+    size_t n = topicFilters->size();
+
+    for (size_t i = 0; i < n; ++i) {
+        remove_sub_handler((*topicFilters)[i]);
+        forget_subscription((*topicFilters)[i]);
+    }
+
+    auto tok = batch_token::create(
+        *this, token::Type::UNSUBSCRIBE, topicFilters, subChunkSize_.load()
+    );
+
+    if (n == 0)
+        return tok;
+
+    add_token(tok);
+
+    int firstRc = MQTTASYNC_SUCCESS;
+    size_t nAccepted = 0;
+
+    for (size_t i = 0; i < tok->num_requests(); ++i) {
+        const auto& itm = tok->items_[i];
+        auto rspOpts = tok->response_options(i, mqttVersion_);
+
+        if (mqttVersion_ >= MQTTVERSION_5)
+            rspOpts.properties = props.c_struct();
+
+        int rc = MQTTAsync_unsubscribeMany(
+            cli_, int(itm.count), topicFilters->c_arr() + itm.first, &rspOpts
+        );
+
+        if (rc == MQTTASYNC_SUCCESS) {
+            ++nAccepted;
+        }
+        else {
+            if (firstRc == MQTTASYNC_SUCCESS)
+                firstRc = rc;
+            tok->on_item_complete(i, rc);
+        }
+    }
+
+    if (nAccepted == 0)
+        throw exception(firstRc);
+
+    return tok;
+}
+
 // --------------------------------------------------------------------------
 
-void async_client::start_consuming()
+void async_client::start_consuming(consumer_queue_type que, std::size_t flowCapacity)
 {
+    if (!que)
+        throw std::invalid_argument("Consumer queue is required");
+
     // Make sure callbacks don't happen while we update the que, etc
     disable_callbacks();
 
     // TODO: Should we replace user callback?
     // userCallback_ = nullptr;
 
-    que_.reset(new thread_queue<event>);
+    que_ = std::move(que);
+    que_->set_wait_strategy(get_wait_strategy());
+    flowCapacity_ = flowCapacity;
 
     int rc = MQTTAsync_setCallbacks(
         cli_, this, &async_client::on_connection_lost, &async_client::on_message_arrived,
@@ -872,12 +2995,24 @@ void async_client::start_consuming()
     check_ret(::MQTTAsync_setDisconnected(cli_, this, &async_client::on_disconnected));
 }
 
+void async_client::start_consuming_bounded(std::size_t capacity)
+{
+    if (capacity == 0)
+        throw std::invalid_argument("Consumer queue capacity is required");
+
+    start_consuming(
+        consumer_queue_type{new consumer_queue_adapter<thread_queue<event>>(capacity)}, capacity
+    );
+}
+
 void async_client::stop_consuming()
 {
     try {
         disable_callbacks();
-        if (que_)
+        if (que_) {
             que_->close();
+            notify_awaiters();
+        }
     }
     catch (...) {
         if (que_)
@@ -890,7 +3025,9 @@ event async_client::consume_event()
 {
     event evt;
     try {
-        evt = que_->get();
+        do {
+            evt = que_->get();
+        } while (on_dequeued(evt));
     }
     catch (queue_closed&) {
         evt = event{shutdown_event{}};
@@ -902,7 +3039,8 @@ bool async_client::try_consume_event(event* evt)
 {
     bool res = false;
     try {
-        res = que_->try_get(evt);
+        while ((res = que_->try_get(evt)) && on_dequeued(*evt))
+            ;
     }
     catch (queue_closed&) {
         *evt = event{shutdown_event{}};
@@ -911,6 +3049,27 @@ bool async_client::try_consume_event(event* evt)
     return res;
 }
 
+std::size_t async_client::try_consume_events(std::vector<event>& evts, std::size_t maxN)
+{
+    if (!que_)
+        throw mqtt::exception(-1, "Consumer not started");
+
+    auto first = evts.size();
+    auto n = que_->try_get_n(&evts, maxN);
+    return (n > 0) ? (n - on_dequeued(evts, first)) : 0;
+}
+
+std::size_t async_client::on_dequeued(std::vector<event>& evts, std::size_t first)
+{
+    auto now = message::clock::now();
+    auto it = std::remove_if(evts.begin() + first, evts.end(), [this, now](event& evt) {
+        return on_dequeued(evt, now);
+    });
+    auto n = std::size_t(evts.end() - it);
+    evts.erase(it, evts.end());
+    return n;
+}
+
 const_message_ptr async_client::consume_message()
 {
     if (!que_)
@@ -921,14 +3080,79 @@ const_message_ptr async_client::consume_message()
     while (true) {
         auto evt = consume_event();
 
-        if (const auto* pval = evt.get_message_if())
-            return *pval;
+        if (auto* pval = evt.get_message_if())
+            return std::move(*pval);
 
         if (evt.is_any_disconnect())
             return const_message_ptr{};
     }
 }
 
+// A waiter only takes from the queue when no one is waiting ahead of it,
+// so they are served in order.
+
+bool async_client::await_message(const_message_ptr* msg, message_waiter cb)
+{
+    if (!que_)
+        throw mqtt::exception(-1, "Consumer not started");
+
+    hasAwaiters_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    guard g{awaitLock_};
+    if (awaiters_.empty() && next_awaited(msg))
+        return false;
+
+    awaiters_.push_back(std::move(cb));
+    return true;
+}
+
+bool async_client::next_awaited(const_message_ptr* msg)
+{
+    event evt;
+
+    try {
+        while (que_->try_get(&evt)) {
+            if (on_dequeued(evt))
+                continue;
+
+            if (auto* pval = evt.get_message_if()) {
+                *msg = std::move(*pval);
+                return true;
+            }
+            if (evt.is_any_disconnect()) {
+                msg->reset();
+                return true;
+            }
+        }
+        if (!que_->done())
+            return false;
+    }
+    catch (const queue_closed&) {
+    }
+
+    msg->reset();
+    return true;
+}
+
+// The waiters are called after the lock is released, since they
+// typically resume a coroutine, which might wait again.
+
+void async_client::do_notify_awaiters()
+{
+    std::vector<std::pair<message_waiter, const_message_ptr>> ready;
+    {
+        guard g{awaitLock_};
+        const_message_ptr msg;
+        while (!awaiters_.empty() && que_ && next_awaited(&msg)) {
+            ready.emplace_back(std::move(awaiters_.front()), std::move(msg));
+            awaiters_.pop_front();
+        }
+    }
+
+    for (auto& r : ready) r.first(std::move(r.second));
+}
+
 bool async_client::try_consume_message(const_message_ptr* msg)
 {
     if (!que_)
@@ -940,7 +3164,7 @@ bool async_client::try_consume_message(const_message_ptr* msg)
         if (!try_consume_event(&evt))
             return false;
 
-        if (const auto* pval = evt.get_message_if()) {
+        if (auto* pval = evt.get_message_if()) {
             *msg = std::move(*pval);
             break;
         }
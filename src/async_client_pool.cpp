@@ -0,0 +1,107 @@
+// async_client_pool.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/async_client_pool.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							async_client_pool
+/////////////////////////////////////////////////////////////////////////////
+
+async_client_pool::async_client_pool(const create_options& opts, std::size_t nClients)
+{
+    if (nClients == 0)
+        nClients = std::max(std::thread::hardware_concurrency(), 1u);
+
+    clients_.reserve(nClients);
+    for (std::size_t i = 0; i < nClients; ++i) {
+        create_options cliOpts{opts};
+        cliOpts.set_client_id(opts.get_client_id() + "-" + std::to_string(i));
+        clients_.push_back(std::make_unique<async_client>(cliOpts));
+    }
+}
+
+void async_client_pool::connect(const connect_options& opts)
+{
+    std::vector<token_ptr> toks;
+    toks.reserve(clients_.size());
+
+    for (auto& cli : clients_) toks.push_back(cli->connect(opts));
+
+    for (auto& tok : toks) tok->wait();
+}
+
+void async_client_pool::disconnect()
+{
+    std::vector<token_ptr> toks;
+    toks.reserve(clients_.size());
+
+    for (auto& cli : clients_) {
+        if (cli->is_connected())
+            toks.push_back(cli->disconnect());
+    }
+
+    for (auto& tok : toks) tok->wait();
+}
+
+bool async_client_pool::is_connected() const
+{
+    for (const auto& cli : clients_) {
+        if (!cli->is_connected())
+            return false;
+    }
+    return true;
+}
+
+std::vector<delivery_token_ptr> async_client_pool::get_pending_delivery_tokens() const
+{
+    std::vector<delivery_token_ptr> toks;
+    for (const auto& cli : clients_) {
+        auto cliToks = cli->get_pending_delivery_tokens();
+        toks.insert(toks.end(), cliToks.begin(), cliToks.end());
+    }
+    return toks;
+}
+
+bool async_client_pool::flush()
+{
+    bool ok = true;
+    for (auto& tok : get_pending_delivery_tokens()) {
+        try {
+            tok->wait();
+        }
+        catch (const exception&) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+client_metrics async_client_pool::get_metrics() const
+{
+    client_metrics metrics;
+    for (const auto& cli : clients_) metrics += cli->get_metrics();
+    return metrics;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,223 @@
+// batch_token.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/batch_token.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "mqtt/async_client.h"
+
+namespace mqtt {
+
+// --------------------------------------------------------------------------
+// Constructors
+
+batch_token::batch_token(iasync_client& cli, std::vector<const_message_ptr> msgs)
+    : token{token::Type::PUBLISH, cli},
+      msgs_{std::move(msgs)},
+      rcs_(msgs_.size(), MQTTASYNC_SUCCESS),
+      reasonCodes_(msgs_.size(), ReasonCode::SUCCESS),
+      nPending_{msgs_.size()}
+{
+    items_.reserve(msgs_.size());
+    for (size_t i = 0; i < msgs_.size(); ++i) items_.push_back({this, i, 1});
+
+    // An empty batch has nothing to wait for
+    if (nPending_ == 0)
+        complete_ = true;
+}
+
+batch_token::batch_token(
+    iasync_client& cli, Type typ, const_string_collection_ptr topics, size_t chunkSize
+)
+    : token{typ, cli}, topics_{std::move(topics)}, nPending_{0}
+{
+    if (typ != Type::SUBSCRIBE && typ != Type::UNSUBSCRIBE)
+        throw std::invalid_argument("Batch must be of subscribe or unsubscribe requests");
+
+    if (chunkSize == 0)
+        throw std::invalid_argument("Chunk size must be non-zero");
+
+    size_t n = topics_ ? topics_->size() : 0;
+
+    rcs_.assign(n, MQTTASYNC_SUCCESS);
+    reasonCodes_.assign(n, ReasonCode::SUCCESS);
+
+    items_.reserve((n + chunkSize - 1) / chunkSize);
+    for (size_t i = 0; i < n; i += chunkSize)
+        items_.push_back({this, i, std::min(chunkSize, n - i)});
+
+    nPending_ = items_.size();
+    if (nPending_ == 0)
+        complete_ = true;
+}
+
+// --------------------------------------------------------------------------
+// Class static callbacks.
+// The 'context' is a raw pointer to the item for one request in the batch.
+
+void batch_token::on_item_success(void* context, MQTTAsync_successData* rsp)
+{
+    if (context) {
+        auto itm = static_cast<item*>(context);
+        auto batch = itm->batch;
+
+        // A SUBACK has the granted QoS, or a failure, for each filter
+        if (rsp && batch->type_ == Type::SUBSCRIBE) {
+            if (itm->count == 1)
+                batch->on_item_complete(*itm, &rsp->alt.qos, 1);
+            else if (rsp->alt.qosList)
+                batch->on_item_complete(*itm, rsp->alt.qosList, itm->count);
+            else
+                batch->on_item_complete(*itm, MQTTASYNC_SUCCESS);
+        }
+        else {
+            batch->on_item_complete(*itm, MQTTASYNC_SUCCESS);
+        }
+    }
+}
+
+// When there's a single filter in a request, the C library puts its reason
+// code in the main part of the struct, like with the subscribe_response.
+
+void batch_token::on_item_success5(void* context, MQTTAsync_successData5* rsp)
+{
+    if (context) {
+        auto itm = static_cast<item*>(context);
+        auto batch = itm->batch;
+
+        if (!rsp) {
+            batch->on_item_complete(*itm, MQTTASYNC_SUCCESS);
+            return;
+        }
+
+        // The sub and unsub alternatives have the same layout
+        int nCodes = 0;
+        MQTTReasonCodes* codes = nullptr;
+
+        if (batch->type_ == Type::SUBSCRIBE) {
+            nCodes = rsp->alt.sub.reasonCodeCount;
+            codes = rsp->alt.sub.reasonCodes;
+        }
+        else if (batch->type_ == Type::UNSUBSCRIBE) {
+            nCodes = rsp->alt.unsub.reasonCodeCount;
+            codes = rsp->alt.unsub.reasonCodes;
+        }
+
+        if (nCodes > 1 && codes)
+            batch->on_item_complete(*itm, codes, std::min(size_t(nCodes), itm->count));
+        else
+            batch->on_item_complete(*itm, MQTTASYNC_SUCCESS, ReasonCode(rsp->reasonCode));
+    }
+}
+
+void batch_token::on_item_failure(void* context, MQTTAsync_failureData* rsp)
+{
+    if (context) {
+        auto itm = static_cast<item*>(context);
+        itm->batch->on_item_complete(*itm, rsp ? rsp->code : -1);
+    }
+}
+
+void batch_token::on_item_failure5(void* context, MQTTAsync_failureData5* rsp)
+{
+    if (context) {
+        auto itm = static_cast<item*>(context);
+        if (rsp)
+            itm->batch->on_item_complete(*itm, rsp->code, ReasonCode(rsp->reasonCode));
+        else
+            itm->batch->on_item_complete(*itm, -1);
+    }
+}
+
+// --------------------------------------------------------------------------
+// Object callbacks
+
+void batch_token::set_result(size_t idx, int rc, ReasonCode reasonCode)
+{
+    rcs_[idx] = rc;
+    reasonCodes_[idx] = reasonCode;
+
+    if (rc != MQTTASYNC_SUCCESS || reasonCode >= 0x80) {
+        // The batch reports the first failure
+        if (nFailed_++ == 0) {
+            rc_ = rc;
+            reasonCode_ = reasonCode;
+        }
+    }
+}
+
+void batch_token::on_item_complete(const item& itm, int rc, ReasonCode reasonCode)
+{
+    unique_lock g(lock_);
+
+    for (size_t i = 0; i < itm.count; ++i) set_result(itm.first + i, rc, reasonCode);
+
+    if (--nPending_ == 0)
+        complete(g, nFailed_ == 0);
+}
+
+template <typename T>
+void batch_token::on_item_complete(const item& itm, const T* codes, size_t n)
+{
+    unique_lock g(lock_);
+
+    for (size_t i = 0; i < itm.count; ++i) {
+        auto reasonCode = (i < n) ? ReasonCode(codes[i]) : ReasonCode::SUCCESS;
+        set_result(itm.first + i, MQTTASYNC_SUCCESS, reasonCode);
+    }
+
+    if (--nPending_ == 0)
+        complete(g, nFailed_ == 0);
+}
+
+MQTTAsync_responseOptions batch_token::response_options(size_t idx, int mqttVersion)
+{
+    MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+
+    if (mqttVersion < MQTTVERSION_5) {
+        opts.onSuccess = &batch_token::on_item_success;
+        opts.onFailure = &batch_token::on_item_failure;
+    }
+    else {
+        opts.onSuccess5 = &batch_token::on_item_success5;
+        opts.onFailure5 = &batch_token::on_item_failure5;
+    }
+    opts.context = &items_[idx];
+    return opts;
+}
+
+// --------------------------------------------------------------------------
+// API
+
+std::vector<size_t> batch_token::failed_items() const
+{
+    guard g(lock_);
+    std::vector<size_t> failed;
+    failed.reserve(nFailed_);
+
+    for (size_t i = 0; i < rcs_.size(); ++i) {
+        if (rcs_[i] != MQTTASYNC_SUCCESS || reasonCodes_[i] >= 0x80)
+            failed.push_back(i);
+    }
+    return failed;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,237 @@
+// bridge.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/bridge.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "mqtt/exception.h"
+#include "mqtt/properties.h"
+
+namespace mqtt {
+
+// Determines if a property belongs to the connection that a message
+// arrived on, and can't be sent on another.
+static bool is_connection_property(int id)
+{
+    return id == MQTTPROPERTY_CODE_TOPIC_ALIAS ||
+           id == MQTTPROPERTY_CODE_SUBSCRIPTION_IDENTIFIER;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  							bridge::state
+/////////////////////////////////////////////////////////////////////////////
+
+void bridge::state::on_complete(const delivery_token& tok)
+{
+    --nInFlight;
+
+    auto msg = tok.get_message();
+    if (tok.get_return_code() == MQTTASYNC_SUCCESS && tok.get_reason_code() < 0x80)
+        ++nDelivered;
+    else
+        on_failure(msg, tok.get_return_code());
+
+    if (msg)
+        msg->ack();
+}
+
+void bridge::state::on_failure(const const_message_ptr& msg, int rc)
+{
+    ++nFailed;
+
+    failure_handler cb;
+    {
+        guard g{lock};
+        cb = onFailure;
+    }
+    if (cb)
+        cb(msg, rc);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  								bridge
+/////////////////////////////////////////////////////////////////////////////
+
+bridge::bridge(
+    async_client& src, async_client& dst, std::size_t maxInFlight /*=DFLT_MAX_IN_FLIGHT*/
+)
+    : src_{src},
+      dst_{dst},
+      state_{std::make_shared<state>()},
+      link_{std::make_shared<link>()}
+{
+    link_->br = this;
+    src_.start_manual_ack(maxInFlight);
+}
+
+bridge::~bridge()
+{
+    {
+        guard g{link_->lock};
+        link_->br = nullptr;
+    }
+    stop();
+}
+
+void bridge::add_rule(
+    const string& filter, int qos /*=1*/, const string& srcPrefix /*=string{}*/,
+    const string& dstPrefix /*=string{}*/
+)
+{
+    if (matcher_.find(filter) != matcher_.end())
+        throw std::invalid_argument("There is already a bridge rule for the filter");
+
+    matcher_.insert({filter, rules_.size()});
+    rules_.push_back(rule{filter, qos, srcPrefix, dstPrefix});
+}
+
+void bridge::set_failure_handler(failure_handler cb)
+{
+    guard g{state_->lock};
+    state_->onFailure = std::move(cb);
+}
+
+size_t bridge::find_rule(const string& topic) const
+{
+    auto idx = rules_.size();
+    for (auto it = matcher_.matches(topic); it != matcher_.matches_cend(); ++it) {
+        if (it->second < idx)
+            idx = it->second;
+    }
+    return idx;
+}
+
+string bridge::map_topic(const string& topic) const
+{
+    auto idx = find_rule(topic);
+    if (idx == rules_.size())
+        return string{};
+
+    const auto& r = rules_[idx];
+    if (topic.compare(0, r.srcPrefix.size(), r.srcPrefix) != 0)
+        return topic;
+    return r.dstPrefix + topic.substr(r.srcPrefix.size());
+}
+
+bool bridge::forward(const const_message_ptr& msg)
+{
+    return forward(find_rule(msg->get_topic()), msg);
+}
+
+// The inbound message is published as it is whenever it can be. Otherwise
+// the copy shares the payload, and any adopted C properties, with it, and
+// takes over its ack handle, so that the delivery of the copy acks the
+// source.
+
+bool bridge::forward(size_t idx, const const_message_ptr& msg)
+{
+    if (idx >= rules_.size()) {
+        ++nUnmatched_;
+        msg->ack();
+        return false;
+    }
+
+    const auto& r = rules_[idx];
+    const auto& topic = msg->get_topic();
+    bool rename = !r.srcPrefix.empty() || !r.dstPrefix.empty();
+    rename = rename && topic.compare(0, r.srcPrefix.size(), r.srcPrefix) == 0;
+
+    const auto& cprops = msg->msg_.properties;
+    bool trim = false;
+    for (int i = 0; i < cprops.count && !trim; ++i)
+        trim = is_connection_property(cprops.array[i].identifier);
+
+    const_message_ptr out = msg;
+
+    if (rename || trim) {
+        auto cpy = std::make_shared<message>(*msg);
+        if (rename)
+            cpy->set_topic(r.dstPrefix + topic.substr(r.srcPrefix.size()));
+
+        if (trim) {
+            properties props;
+            for (int i = 0; i < cprops.count; ++i) {
+                if (!is_connection_property(cprops.array[i].identifier))
+                    props.add(property{cprops.array[i]});
+            }
+            cpy->set_properties(std::move(props));
+        }
+
+        cpy->ackTracker_ = msg->ackTracker_;
+        cpy->ackSeq_ = msg->ackSeq_;
+        out = std::move(cpy);
+        ++state_->nCopied;
+    }
+
+    delivery_token_ptr tok;
+    try {
+        tok = dst_.publish(out);
+    }
+    catch (const exception& exc) {
+        state_->on_failure(out, exc.get_return_code());
+        out->ack();
+        return false;
+    }
+
+    ++state_->nForwarded;
+    ++state_->nInFlight;
+
+    // The token may already be done, in which case we handle it here.
+    auto st = state_;
+    auto ptok = tok.get();
+    if (!tok->set_complete_handler([st, ptok] { st->on_complete(*ptok); }))
+        st->on_complete(*tok);
+
+    return true;
+}
+
+std::vector<token_ptr> bridge::start()
+{
+    std::vector<token_ptr> toks;
+    for (size_t i = 0; i < rules_.size(); ++i) {
+        const auto& r = rules_[i];
+        toks.push_back(src_.subscribe(
+            r.filter, r.qos,
+            [lnk = link_, i](const_message_ptr msg) {
+                // The client calls the handler of every matching filter,
+                // but only the winning rule forwards the message.
+                guard g{lnk->lock};
+                if (lnk->br && lnk->br->find_rule(msg->get_topic()) == i)
+                    lnk->br->forward(i, msg);
+            }
+        ));
+    }
+    return toks;
+}
+
+void bridge::stop()
+{
+    for (const auto& r : rules_) {
+        try {
+            src_.unsubscribe(r.filter);
+        }
+        catch (...) {
+        }
+    }
+    src_.stop_manual_ack();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,184 @@
+// chunk_reassembler.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/chunk_reassembler.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace mqtt {
+
+namespace {
+
+// The properties that identify a chunk
+struct chunk_info
+{
+    string streamId;
+    uint64_t seq{0};
+    bool last{false};
+    std::size_t size{0};
+};
+
+bool parse_number(const string& s, uint64_t& val)
+{
+    if (s.empty() || s.find_first_not_of("0123456789") != string::npos)
+        return false;
+    val = std::strtoull(s.c_str(), nullptr, 10);
+    return true;
+}
+
+bool get_chunk_info(const properties& props, chunk_info& info)
+{
+    bool haveSeq = false;
+
+    for (const auto& prop : props) {
+        auto kv = try_get<string_view_pair>(prop);
+        if (!kv)
+            continue;
+
+        auto key = kv->first;
+        string val{kv->second};
+
+        if (key == chunked_publisher::STREAM_PROPERTY) {
+            info.streamId = val;
+        }
+        else if (key == chunked_publisher::SEQ_PROPERTY) {
+            if (!parse_number(val, info.seq))
+                return false;
+            haveSeq = true;
+        }
+        else if (key == chunked_publisher::SIZE_PROPERTY) {
+            uint64_t n;
+            if (!parse_number(val, n))
+                return false;
+            info.last = true;
+            info.size = std::size_t(n);
+        }
+    }
+    return !info.streamId.empty() && haveSeq;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+chunk_reassembler::chunk_reassembler(
+    sink_type sink, std::size_t maxPending /*=DFLT_MAX_PENDING*/
+)
+    : maxPending_{maxPending}, sink_{std::move(sink)}
+{
+}
+
+bool chunk_reassembler::is_chunk(const message& msg)
+{
+    chunk_info info;
+    return get_chunk_info(msg.get_properties(), info);
+}
+
+void chunk_reassembler::write(const string& id, stream& st, const message& msg)
+{
+    const auto& data = msg.get_payload_ref();
+    if (sink_ && data)
+        sink_(id, st.nBytes, data);
+    st.nBytes += data.size();
+    ++st.nextSeq;
+}
+
+void chunk_reassembler::finish(const string& id, bool ok)
+{
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+        return;
+
+    auto nBytes = it->second.nBytes;
+    streams_.erase(it);
+
+    finished_.push_back(id);
+    if (finished_.size() > MAX_FINISHED)
+        finished_.pop_front();
+
+    if (completeHandler_)
+        completeHandler_(id, nBytes, ok);
+}
+
+bool chunk_reassembler::is_finished(const string& id) const
+{
+    return std::find(finished_.begin(), finished_.end(), id) != finished_.end();
+}
+
+// Each chunk is written as soon as the ones before it have been, so at
+// most the early ones are held.
+
+bool chunk_reassembler::handle(const const_message_ptr& msg)
+{
+    chunk_info info;
+    if (!msg || !get_chunk_info(msg->get_properties(), info))
+        return false;
+
+    const auto& id = info.streamId;
+
+    guard g{lock_};
+    if (is_finished(id))
+        return true;
+
+    auto& st = streams_[id];
+    if (info.seq < st.nextSeq || st.pending.count(info.seq) != 0)
+        return true;
+
+    if (info.last) {
+        st.haveLast = true;
+        st.lastSeq = info.seq;
+        st.size = info.size;
+    }
+
+    if (info.seq != st.nextSeq) {
+        if (st.pending.size() >= maxPending_)
+            finish(id, false);
+        else
+            st.pending.emplace(info.seq, msg);
+        return true;
+    }
+
+    write(id, st, *msg);
+
+    auto it = st.pending.begin();
+    while (it != st.pending.end() && it->first == st.nextSeq) {
+        write(id, st, *it->second);
+        it = st.pending.erase(it);
+    }
+
+    if (progressHandler_)
+        progressHandler_(id, st.nBytes);
+
+    if (st.haveLast && st.nextSeq > st.lastSeq)
+        finish(id, st.nBytes == st.size);
+
+    return true;
+}
+
+bool chunk_reassembler::abandon(const string& streamId)
+{
+    guard g{lock_};
+    if (streams_.count(streamId) == 0)
+        return false;
+    finish(streamId, false);
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,138 @@
+// chunked_publisher.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/chunked_publisher.h"
+
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+chunked_publisher::chunked_publisher(
+    iasync_client& cli, const string& topic, std::size_t chunkSize /*=DFLT_CHUNK_SIZE*/,
+    std::size_t maxInFlight /*=DFLT_MAX_IN_FLIGHT*/, int qos /*=DFLT_QOS*/
+)
+    : cli_{cli},
+      topic_{topic},
+      chunkSize_{chunkSize},
+      maxInFlight_{(maxInFlight == 0) ? 1 : maxInFlight},
+      qos_{qos}
+{
+    if (chunkSize_ == 0)
+        throw std::invalid_argument("The chunk size can't be zero");
+}
+
+string chunked_publisher::make_stream_id()
+{
+    std::mt19937_64 rng{std::random_device{}()};
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(rng()));
+    return string(buf);
+}
+
+const_message_ptr chunked_publisher::make_chunk(
+    const string& streamId, uint64_t seq, binary&& data, bool last, std::size_t nBytes
+) const
+{
+    properties props{
+        {property::USER_PROPERTY, STREAM_PROPERTY, streamId},
+        {property::USER_PROPERTY, SEQ_PROPERTY, std::to_string(seq)}
+    };
+    if (last)
+        props.add({property::USER_PROPERTY, SIZE_PROPERTY, std::to_string(nBytes)});
+
+    return message::create(topic_, binary_ref(std::move(data)), qos_, false, props);
+}
+
+// The source is read one chunk ahead, so that the last chunk can be
+// marked as such when it's sent. The window is checked before each read,
+// so no more than the window and the read-ahead are held at once.
+
+std::size_t chunked_publisher::publish(
+    const source_type& src, const string& streamId /*=string()*/
+)
+{
+    auto id = streamId.empty() ? make_stream_id() : streamId;
+
+    auto read_chunk = [this, &src] {
+        binary buf(chunkSize_, '\0');
+        std::size_t n = 0;
+        while (n < chunkSize_) {
+            auto k = src(&buf[n], chunkSize_ - n);
+            if (k == 0)
+                break;
+            n += k;
+        }
+        buf.resize(n);
+        return buf;
+    };
+
+    // The chunks in flight, with the byte count once each is acked
+    std::deque<std::pair<delivery_token_ptr, std::size_t>> inFlight;
+
+    auto wait_oldest = [this, &inFlight] {
+        auto [tok, nBytes] = std::move(inFlight.front());
+        inFlight.pop_front();
+        tok->wait();
+        if (progressHandler_)
+            progressHandler_(nBytes);
+    };
+
+    auto cur = read_chunk();
+    std::size_t nBytes = 0;
+    uint64_t seq = 0;
+
+    while (true) {
+        if (inFlight.size() >= maxInFlight_)
+            wait_oldest();
+
+        // A short chunk means that the source is done
+        auto next = (cur.size() == chunkSize_) ? read_chunk() : binary();
+        bool last = next.empty();
+
+        nBytes += cur.size();
+        auto tok = cli_.publish(make_chunk(id, seq++, std::move(cur), last, nBytes));
+        inFlight.emplace_back(std::move(tok), nBytes);
+
+        if (last)
+            break;
+        cur = std::move(next);
+    }
+
+    while (!inFlight.empty()) wait_oldest();
+    return nBytes;
+}
+
+std::size_t chunked_publisher::publish(std::istream& is, const string& streamId /*=string()*/)
+{
+    return publish(
+        [&is](char* buf, std::size_t n) {
+            is.read(buf, std::streamsize(n));
+            return std::size_t(is.gcount());
+        },
+        streamId
+    );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
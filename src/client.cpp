@@ -75,6 +75,78 @@ client::client(
 {
 }
 
+client::~client()
+{
+    {
+        std::lock_guard<std::mutex> g{cbLock_};
+        cbStop_ = true;
+    }
+    cbCond_.notify_all();
+
+    if (cbThr_.joinable())
+        cbThr_.join();
+}
+
+// --------------------------------------------------------------------------
+// User callbacks
+
+void client::run_callback(std::function<void()> f)
+{
+    std::unique_lock<std::mutex> g{cbLock_};
+
+    if (cbBusy_ || cbStop_) {
+        g.unlock();
+        std::async(std::launch::async, [this, &f] {
+            apply_thread_options();
+            f();
+        }).wait();
+        return;
+    }
+
+    if (!cbThr_.joinable())
+        cbThr_ = std::thread(&client::callback_thread, this);
+
+    cbTask_ = std::move(f);
+    cbBusy_ = true;
+    cbCond_.notify_all();
+    cbCond_.wait(g, [this] { return !cbBusy_; });
+}
+
+void client::apply_thread_options() const
+{
+    const auto& opts = cli_.get_create_options().get_thread_options();
+    if (!opts.empty())
+        opts.apply(thread_role::SYNC_CALLBACK);
+}
+
+void client::callback_thread()
+{
+    apply_thread_options();
+
+    std::unique_lock<std::mutex> g{cbLock_};
+
+    while (true) {
+        cbCond_.wait(g, [this] { return cbTask_ || cbStop_; });
+        if (!cbTask_)
+            break;
+
+        auto task = std::move(cbTask_);
+        cbTask_ = nullptr;
+        g.unlock();
+
+        // As with std::async, an exception from the user is discarded
+        try {
+            task();
+        }
+        catch (...) {
+        }
+
+        g.lock();
+        cbBusy_ = false;
+        cbCond_.notify_all();
+    }
+}
+
 // --------------------------------------------------------------------------
 
 void client::set_callback(callback& cb)
@@ -83,6 +155,73 @@ void client::set_callback(callback& cb)
     cli_.set_callback(*this);
 }
 
+// --------------------------------------------------------------------------
+// Publishing
+
+// A publish is only retired once it completes, whether it succeeded or
+// failed, so a timeout leaves it at the front of the window.
+
+void client::drain_window(size_t n)
+{
+    while (!inFlight_.empty()) {
+        bool mustWait = inFlight_.size() > n;
+        auto tok = inFlight_.front();
+        if (!mustWait && !tok->is_complete())
+            break;
+
+        bool done;
+        try {
+            done = mustWait ? tok->wait_for(timeout_) : tok->try_wait();
+        }
+        catch (...) {
+            inFlight_.pop_front();
+            throw;
+        }
+
+        if (!done)
+            throw timeout_error();
+        inFlight_.pop_front();
+    }
+}
+
+void client::publish(const_message_ptr msg)
+{
+    std::unique_lock<std::mutex> g{winLock_};
+
+    if (pubWindow_ == 0) {
+        g.unlock();
+        if (!cli_.publish(std::move(msg))->wait_for(timeout_))
+            throw timeout_error();
+        return;
+    }
+
+    drain_window(pubWindow_ - 1);
+    inFlight_.push_back(cli_.publish(std::move(msg)));
+}
+
+void client::publish(const message& msg)
+{
+    if (get_publish_window() == 0)
+        cli_.publish(ptr(msg))->wait();
+    else
+        publish(std::make_shared<const message>(msg));
+}
+
+void client::set_publish_window(size_t n)
+{
+    std::lock_guard<std::mutex> g{winLock_};
+    pubWindow_ = n;
+    drain_window(n);
+}
+
+void client::flush()
+{
+    std::lock_guard<std::mutex> g{winLock_};
+    drain_window(0);
+}
+
+// --------------------------------------------------------------------------
+
 connect_response client::connect()
 {
     cli_.start_consuming();
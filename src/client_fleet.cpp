@@ -0,0 +1,211 @@
+// client_fleet.cpp
+//
+// Implementation of the client_fleet class for the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/client_fleet.h"
+
+#include <stdexcept>
+
+#include "mqtt/token_group.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+client_fleet::client_fleet(
+    const create_options& createOpts, const connect_options& connOpts, double connectRate
+)
+    : createOpts_{createOpts},
+      connOpts_{connOpts},
+      limiter_{connectRate, 0.0, rate_limiter::QUEUE}
+{
+    // Each client is lightly loaded, so it doesn't need a table of tokens
+    // split up for concurrency, unless the app asked for it.
+    if (createOpts_.get_token_table_shards() == create_options::DFLT_TOKEN_TABLE_SHARDS)
+        createOpts_.set_token_table_shards(1);
+}
+
+// The connects that are still waiting are dropped before the clients go
+// away, since they refer to them.
+
+client_fleet::~client_fleet()
+{
+    limiter_.stop();
+    que_.close();
+}
+
+// The handlers each capture just the fleet and the index of the client,
+// which fit in the small buffer of a std::function, so they don't need
+// any memory of their own.
+
+size_t client_fleet::add(const string& clientId)
+{
+    create_options opts{
+        createOpts_.get_server_uri(), clientId, createOpts_, createOpts_.get_persistence()
+    };
+    auto cli = std::make_unique<async_client>(opts);
+
+    guard g{lock_};
+    size_t idx = clis_.size();
+
+    cli->set_connected_handler([this, idx](const string& cause) { on_connected(idx, cause); });
+    cli->set_connection_lost_handler([this, idx](const string& cause) {
+        on_connection_lost(idx, cause);
+    });
+    cli->set_message_callback([this, idx](const_message_ptr msg) {
+        on_message(idx, std::move(msg));
+    });
+
+    clis_.push_back(std::move(cli));
+    return idx;
+}
+
+size_t client_fleet::size() const
+{
+    guard g{lock_};
+    return clis_.size();
+}
+
+async_client& client_fleet::get_client(size_t idx)
+{
+    guard g{lock_};
+    return *clis_.at(idx);
+}
+
+const async_client& client_fleet::get_client(size_t idx) const
+{
+    guard g{lock_};
+    return *clis_.at(idx);
+}
+
+void client_fleet::on_connected(size_t idx, const string& cause)
+{
+    if (connHandler_)
+        connHandler_(idx, cause);
+
+    if (consuming_)
+        que_.try_put(client_event{idx, event{connected_event{cause}}});
+}
+
+void client_fleet::on_connection_lost(size_t idx, const string& cause)
+{
+    if (connLostHandler_)
+        connLostHandler_(idx, cause);
+
+    if (consuming_)
+        que_.try_put(client_event{idx, event{connection_lost_event{cause}}});
+}
+
+void client_fleet::on_message(size_t idx, const_message_ptr msg)
+{
+    if (msgHandler_)
+        msgHandler_(idx, msg);
+
+    if (consuming_)
+        que_.try_put(client_event{idx, event{std::move(msg)}});
+}
+
+void client_fleet::stop_consuming()
+{
+    consuming_ = false;
+    que_.close();
+}
+
+void client_fleet::do_connect(size_t idx)
+{
+    async_client* cli;
+    {
+        guard g{lock_};
+        cli = clis_[idx].get();
+    }
+
+    try {
+        if (!cli->is_connected())
+            cli->connect(connOpts_, nullptr, connListener_);
+    }
+    catch (const exception&) {
+        ++nConnectFailed_;
+    }
+}
+
+void client_fleet::connect(size_t idx)
+{
+    {
+        guard g{lock_};
+        if (idx >= clis_.size())
+            throw std::out_of_range("client_fleet: no client at index");
+    }
+    limiter_.submit(0, [this, idx](bool ok) {
+        if (ok)
+            do_connect(idx);
+    });
+}
+
+void client_fleet::connect_all()
+{
+    size_t n = size();
+    for (size_t i = 0; i < n; ++i) {
+        if (!get_client(i).is_connected())
+            connect(i);
+    }
+}
+
+size_t client_fleet::num_connected() const
+{
+    guard g{lock_};
+    size_t n = 0;
+    for (const auto& cli : clis_) {
+        if (cli->is_connected())
+            ++n;
+    }
+    return n;
+}
+
+bool client_fleet::disconnect_all(std::chrono::milliseconds timeout)
+{
+    std::vector<async_client*> clis;
+    {
+        guard g{lock_};
+        for (const auto& cli : clis_) clis.push_back(cli.get());
+    }
+
+    token_group grp;
+    for (auto cli : clis) {
+        if (!cli->is_connected())
+            continue;
+        try {
+            grp.add(cli->disconnect());
+        }
+        catch (const exception&) {
+        }
+    }
+    return grp.wait_all_for(timeout);
+}
+
+client_fleet::client_event client_fleet::consume_event()
+{
+    client_event evt;
+    if (!que_.get(&evt))
+        evt = client_event{npos, event{shutdown_event{}}};
+    return evt;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
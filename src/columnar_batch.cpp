@@ -0,0 +1,337 @@
+// columnar_batch.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/columnar_batch.h"
+
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr size_t MAX_OFFSET = size_t(std::numeric_limits<int32_t>::max());
+
+// Appends bytes to a data buffer, and its new end to the offsets
+void append_bytes(
+    std::vector<int32_t>& offsets, std::vector<char>& data, const char* p, size_t n
+) {
+    if (data.size() + n > MAX_OFFSET)
+        throw std::length_error("columnar_batch: column over 2GB");
+    data.insert(data.end(), p, p + n);
+    offsets.push_back(int32_t(data.size()));
+}
+
+// An empty buffer still needs a valid pointer for the Arrow consumer
+template <typename T>
+const void* buf(const std::vector<T>& v) {
+    static const int64_t ZERO = 0;
+    return v.empty() ? static_cast<const void*>(&ZERO) : static_cast<const void*>(v.data());
+}
+
+// The exported structs each own a private node, which holds a share of
+// the columns, and the arrays of pointers that the struct points to. As
+// the interface requires, releasing a parent releases any children that
+// the consumer didn't move out, and then marks it released.
+
+struct array_private
+{
+    std::shared_ptr<const void> hold;
+    std::vector<const void*> buffers;
+    std::vector<ArrowArray> childArrays;
+    std::vector<ArrowArray*> children;
+    ArrowArray dict{};
+};
+
+struct schema_private
+{
+    string format;
+    string name;
+    std::vector<ArrowSchema> childSchemas;
+    std::vector<ArrowSchema*> children;
+    ArrowSchema dict{};
+};
+
+void release_array(ArrowArray* arr) {
+    auto pd = static_cast<array_private*>(arr->private_data);
+    for (auto child : pd->children) {
+        if (child->release)
+            child->release(child);
+    }
+    if (arr->dictionary && arr->dictionary->release)
+        arr->dictionary->release(arr->dictionary);
+    delete pd;
+    arr->release = nullptr;
+}
+
+void release_schema(ArrowSchema* sch) {
+    auto pd = static_cast<schema_private*>(sch->private_data);
+    for (auto child : pd->children) {
+        if (child->release)
+            child->release(child);
+    }
+    if (sch->dictionary && sch->dictionary->release)
+        sch->dictionary->release(sch->dictionary);
+    delete pd;
+    sch->release = nullptr;
+}
+
+array_private* init_array(
+    ArrowArray* arr, std::shared_ptr<const void> hold, size_t len, int64_t nullCount,
+    std::vector<const void*> buffers, size_t nChildren = 0
+) {
+    auto pd = new array_private;
+    pd->hold = std::move(hold);
+    pd->buffers = std::move(buffers);
+    pd->childArrays.resize(nChildren);
+    for (auto& child : pd->childArrays) pd->children.push_back(&child);
+
+    *arr = ArrowArray{};
+    arr->length = int64_t(len);
+    arr->null_count = nullCount;
+    arr->n_buffers = int64_t(pd->buffers.size());
+    arr->buffers = pd->buffers.data();
+    arr->n_children = int64_t(nChildren);
+    arr->children = nChildren ? pd->children.data() : nullptr;
+    arr->release = release_array;
+    arr->private_data = pd;
+    return pd;
+}
+
+schema_private* init_schema(
+    ArrowSchema* sch, string format, string name, int64_t flags, size_t nChildren = 0
+) {
+    auto pd = new schema_private;
+    pd->format = std::move(format);
+    pd->name = std::move(name);
+    pd->childSchemas.resize(nChildren);
+    for (auto& child : pd->childSchemas) pd->children.push_back(&child);
+
+    *sch = ArrowSchema{};
+    sch->format = pd->format.c_str();
+    sch->name = pd->name.c_str();
+    sch->flags = flags;
+    sch->n_children = int64_t(nChildren);
+    sch->children = nChildren ? pd->children.data() : nullptr;
+    sch->release = release_schema;
+    sch->private_data = pd;
+    return pd;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//  						columnar_batch
+/////////////////////////////////////////////////////////////////////////////
+
+columnar_batch::columnar_batch(std::vector<string> propNames /*={}*/)
+    : propNames_{std::move(propNames)}
+{
+    reset();
+}
+
+void columnar_batch::reset()
+{
+    cols_.props.resize(propNames_.size());
+    sysBase_ = clock::now();
+    steadyBase_ = message::clock::now();
+}
+
+void columnar_batch::append(const message& msg)
+{
+    const auto& topic = msg.get_topic();
+    auto it = dict_.find(topic);
+    if (it == dict_.end()) {
+        append_bytes(cols_.dictOffsets, cols_.dictData, topic.data(), topic.size());
+        it = dict_.emplace(topic, int32_t(dict_.size())).first;
+    }
+
+    const auto& payload = msg.get_payload();
+    append_bytes(cols_.payloadOffsets, cols_.payloadData, payload.data(), payload.size());
+    cols_.topicIdx.push_back(it->second);
+    cols_.qos.push_back(uint8_t(msg.get_qos()));
+
+    // The steady arrival time is put on the wall clock as of the batch start
+    auto ts = msg.get_timestamp();
+    if (ts == message::time_point{})
+        ts = message::clock::now();
+    auto sys = sysBase_ + std::chrono::duration_cast<clock::duration>(ts - steadyBase_);
+    cols_.timestamp.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(sys.time_since_epoch()).count()
+    );
+
+    const size_t row = cols_.topicIdx.size() - 1;
+    const auto& props = msg.get_properties();
+
+    for (size_t i = 0; i < propNames_.size(); ++i) {
+        auto& col = cols_.props[i];
+        if (row % 8 == 0)
+            col.validity.push_back(0);
+
+        auto val = props.empty() ? std::nullopt : get_user_property(props, propNames_[i]);
+        if (val) {
+            col.validity.back() |= uint8_t(1u << (row % 8));
+            append_bytes(col.offsets, col.data, val->data(), val->size());
+        }
+        else {
+            col.offsets.push_back(col.offsets.back());
+            ++col.nullCount;
+        }
+    }
+}
+
+void columnar_batch::clear()
+{
+    cols_.topicIdx.clear();
+    cols_.dictOffsets.resize(1);
+    cols_.dictData.clear();
+    cols_.payloadOffsets.resize(1);
+    cols_.payloadData.clear();
+    cols_.qos.clear();
+    cols_.timestamp.clear();
+    for (auto& col : cols_.props) {
+        col.validity.clear();
+        col.offsets.resize(1);
+        col.data.clear();
+        col.nullCount = 0;
+    }
+    dict_.clear();
+    reset();
+}
+
+std::string_view columnar_batch::topic(size_t i) const
+{
+    auto idx = size_t(cols_.topicIdx[i]);
+    auto off = size_t(cols_.dictOffsets[idx]);
+    return {cols_.dictData.data() + off, size_t(cols_.dictOffsets[idx + 1]) - off};
+}
+
+std::string_view columnar_batch::payload(size_t i) const
+{
+    auto off = size_t(cols_.payloadOffsets[i]);
+    return {cols_.payloadData.data() + off, size_t(cols_.payloadOffsets[i + 1]) - off};
+}
+
+std::optional<std::string_view> columnar_batch::property(size_t col, size_t i) const
+{
+    const auto& c = cols_.props.at(col);
+    if (!(c.validity[i / 8] & (1u << (i % 8))))
+        return std::nullopt;
+    auto off = size_t(c.offsets[i]);
+    return std::string_view{c.data.data() + off, size_t(c.offsets[i + 1]) - off};
+}
+
+void columnar_batch::export_schema(ArrowSchema* schema) const
+{
+    auto pd = init_schema(schema, "+s", "", 0, 4 + propNames_.size());
+
+    auto topic = init_schema(pd->children[0], "i", TOPIC_COLUMN, 0);
+    init_schema(&topic->dict, "u", "", 0);
+    pd->children[0]->dictionary = &topic->dict;
+
+    init_schema(pd->children[1], "z", PAYLOAD_COLUMN, 0);
+    init_schema(pd->children[2], "C", QOS_COLUMN, 0);
+    init_schema(pd->children[3], "tsn:UTC", TIMESTAMP_COLUMN, 0);
+
+    for (size_t i = 0; i < propNames_.size(); ++i)
+        init_schema(pd->children[4 + i], "u", propNames_[i], ARROW_FLAG_NULLABLE);
+}
+
+void columnar_batch::export_to_c(ArrowArray* array, ArrowSchema* schema /*=nullptr*/)
+{
+    if (schema)
+        export_schema(schema);
+
+    auto hold = std::make_shared<columns>(std::move(cols_));
+    cols_ = columns{};
+    const auto& c = *hold;
+    const size_t n = c.topicIdx.size();
+
+    auto pd = init_array(array, hold, n, 0, {nullptr}, 4 + c.props.size());
+
+    auto topic = init_array(pd->children[0], hold, n, 0, {nullptr, buf(c.topicIdx)});
+    init_array(
+        &topic->dict, hold, c.dictOffsets.size() - 1, 0,
+        {nullptr, buf(c.dictOffsets), buf(c.dictData)}
+    );
+    pd->children[0]->dictionary = &topic->dict;
+
+    init_array(
+        pd->children[1], hold, n, 0, {nullptr, buf(c.payloadOffsets), buf(c.payloadData)}
+    );
+    init_array(pd->children[2], hold, n, 0, {nullptr, buf(c.qos)});
+    init_array(pd->children[3], hold, n, 0, {nullptr, buf(c.timestamp)});
+
+    for (size_t i = 0; i < c.props.size(); ++i) {
+        const auto& col = c.props[i];
+        init_array(
+            pd->children[4 + i], hold, n, col.nullCount,
+            {col.nullCount ? buf(col.validity) : nullptr, buf(col.offsets), buf(col.data)}
+        );
+    }
+
+    dict_.clear();
+    reset();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  						columnar_consumer
+/////////////////////////////////////////////////////////////////////////////
+
+// Until the first message arrives, this waits in slices of the batch age,
+// so that it notices a shutdown. After that, it waits no later than the
+// age limit of the batch.
+
+bool columnar_consumer::fill(columnar_batch& batch)
+{
+    using clock = std::chrono::steady_clock;
+
+    batch.clear();
+    auto deadline = clock::time_point::max();
+
+    while (batch.size() < maxRows_ && batch.payload_bytes() < maxBytes_) {
+        auto now = clock::now();
+        if (now >= deadline)
+            break;
+
+        evts_.clear();
+        auto until = batch.empty() ? now + maxAge_ : deadline;
+        cli_.consume_events_until(evts_, maxRows_ - batch.size(), until);
+
+        bool done = false;
+        for (const auto& evt : evts_) {
+            if (auto pmsg = evt.get_message_if()) {
+                if (batch.empty())
+                    deadline = clock::now() + maxAge_;
+                batch.append(**pmsg);
+            }
+            else if (evt.is_shutdown()) {
+                done = true;
+            }
+        }
+        if (done)
+            break;
+    }
+    return !batch.empty();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,157 @@
+// consumer_group.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/consumer_group.h"
+
+#include <algorithm>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							consumer_group
+/////////////////////////////////////////////////////////////////////////////
+
+consumer_group::consumer_group(
+    const create_options& opts, const string& groupName, std::size_t nClients,
+    handler_type handler, std::size_t nWorkers /*=0*/
+)
+    : groupName_{groupName}, disp_{nWorkers, std::move(handler)}
+{
+    if (nClients == 0)
+        nClients = 1;
+
+    clients_.reserve(nClients);
+    for (std::size_t i = 0; i < nClients; ++i) {
+        create_options cliOpts{opts};
+        cliOpts.set_client_id(opts.get_client_id() + "-" + std::to_string(i));
+
+        auto cli = std::make_unique<async_client>(cliOpts);
+        auto pcli = cli.get();
+
+        // Each client feeds its own worker queue in the dispatcher
+        cli->set_message_callback([this, i](const_message_ptr msg) {
+            disp_.dispatch(std::move(msg), i);
+        });
+        cli->set_connected_handler([this, pcli](const string&) { resubscribe(*pcli); });
+
+        clients_.push_back(std::move(cli));
+    }
+}
+
+// The clients go first, so that no more messages arrive while the
+// dispatcher drains its queues.
+
+consumer_group::~consumer_group()
+{
+    clients_.clear();
+    disp_.stop();
+}
+
+// This is called from the client's callback thread when it connects, so
+// it can't wait for the subscriptions to complete.
+
+void consumer_group::resubscribe(async_client& cli)
+{
+    guard g{lock_};
+    for (const auto& sub : subs_) {
+        try {
+            cli.subscribe(shared_filter(groupName_, sub.filter), sub.qos);
+        }
+        catch (const exception&) {
+        }
+    }
+}
+
+void consumer_group::connect(const connect_options& opts)
+{
+    std::vector<token_ptr> toks;
+    toks.reserve(clients_.size());
+
+    for (auto& cli : clients_) toks.push_back(cli->connect(opts));
+
+    for (auto& tok : toks) tok->wait();
+}
+
+void consumer_group::disconnect()
+{
+    std::vector<token_ptr> toks;
+    toks.reserve(clients_.size());
+
+    for (auto& cli : clients_) {
+        if (cli->is_connected())
+            toks.push_back(cli->disconnect());
+    }
+
+    for (auto& tok : toks) tok->wait();
+}
+
+void consumer_group::subscribe(const string& filter, int qos)
+{
+    std::vector<token_ptr> toks;
+    {
+        guard g{lock_};
+        auto it = std::find_if(subs_.begin(), subs_.end(), [&filter](const subscription& sub) {
+            return sub.filter == filter;
+        });
+        if (it != subs_.end())
+            it->qos = qos;
+        else
+            subs_.push_back({filter, qos});
+
+        for (auto& cli : clients_) {
+            if (cli->is_connected())
+                toks.push_back(cli->subscribe(shared_filter(groupName_, filter), qos));
+        }
+    }
+
+    for (auto& tok : toks) tok->wait();
+}
+
+void consumer_group::unsubscribe(const string& filter)
+{
+    std::vector<token_ptr> toks;
+    {
+        guard g{lock_};
+        subs_.erase(
+            std::remove_if(
+                subs_.begin(), subs_.end(),
+                [&filter](const subscription& sub) { return sub.filter == filter; }
+            ),
+            subs_.end()
+        );
+
+        for (auto& cli : clients_) {
+            if (cli->is_connected())
+                toks.push_back(cli->unsubscribe(shared_filter(groupName_, filter)));
+        }
+    }
+
+    for (auto& tok : toks) tok->wait();
+}
+
+std::vector<string> consumer_group::get_subscriptions() const
+{
+    guard g{lock_};
+    std::vector<string> filters;
+    filters.reserve(subs_.size());
+    for (const auto& sub : subs_) filters.push_back(sub.filter);
+    return filters;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,118 @@
+// consumer_mux.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/consumer_mux.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  						consumer_mux::source
+/////////////////////////////////////////////////////////////////////////////
+
+// The client only puts events into its queue, so the reads come up empty.
+// It checks the size for flow control, which is the size of the shared
+// queue. Closing the source just stops its events; the shared queue is
+// only closed by the mux.
+
+class consumer_mux::source : public async_client::consumer_queue
+{
+    std::shared_ptr<queue_type> que_;
+    size_t idx_;
+    std::atomic<bool> closed_{false};
+
+public:
+    source(std::shared_ptr<queue_type> que, size_t idx) : que_{std::move(que)}, idx_{idx} {}
+
+    std::size_t size() const override { return que_->size(); }
+    bool closed() const override { return closed_ || que_->closed(); }
+    bool done() const override { return closed(); }
+    void clear() override {}
+    void close() override { closed_ = true; }
+
+    void put(event evt) override {
+        if (closed_)
+            return;
+        try {
+            que_->put(client_event{idx_, std::move(evt)});
+        }
+        catch (const queue_closed&) {
+        }
+    }
+
+    event get() override { throw queue_closed{}; }
+    bool try_get(event*) override { return false; }
+    bool try_get_until(event*, const clock::time_point&) override { return false; }
+    std::size_t try_get_n(std::vector<event>*, std::size_t) override { return 0; }
+    std::size_t try_get_n_until(
+        std::vector<event>*, std::size_t, const clock::time_point&
+    ) override {
+        return 0;
+    }
+    std::size_t capacity() const override { return que_->capacity(); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+//  							consumer_mux
+/////////////////////////////////////////////////////////////////////////////
+
+consumer_mux::consumer_mux(size_t capacity /*=queue_type::MAX_CAPACITY*/)
+    : que_{std::make_shared<queue_type>(capacity)}
+{
+}
+
+consumer_mux::~consumer_mux() { stop(); }
+
+size_t consumer_mux::add(async_client& cli)
+{
+    size_t idx;
+    {
+        guard g{lock_};
+        idx = clis_.size();
+        clis_.push_back(&cli);
+    }
+
+    cli.start_consuming(async_client::consumer_queue_type{new source{que_, idx}});
+    return idx;
+}
+
+size_t consumer_mux::size() const
+{
+    guard g{lock_};
+    return clis_.size();
+}
+
+async_client& consumer_mux::get_client(size_t idx) const
+{
+    guard g{lock_};
+    return *clis_.at(idx);
+}
+
+consumer_mux::client_event consumer_mux::consume_event()
+{
+    client_event evt;
+    if (!que_->get(&evt))
+        evt = client_event{npos, event{shutdown_event{}}};
+    return evt;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -41,6 +41,15 @@ create_options& create_options::operator=(const create_options& rhs)
         serverURI_ = rhs.serverURI_;
         clientId_ = rhs.clientId_;
         persistence_ = rhs.persistence_;
+        zeroCopy_ = rhs.zeroCopy_;
+        maxInternedTopics_ = rhs.maxInternedTopics_;
+        commitInterval_ = rhs.commitInterval_;
+        commitBytes_ = rhs.commitBytes_;
+        coalesceDelay_ = rhs.coalesceDelay_;
+        coalesceBytes_ = rhs.coalesceBytes_;
+        maxTopicAliases_ = rhs.maxTopicAliases_;
+        threadOpts_ = rhs.threadOpts_;
+        tokenTableShards_ = rhs.tokenTableShards_;
     }
     return *this;
 }
@@ -52,6 +61,15 @@ create_options& create_options::operator=(create_options&& rhs)
         serverURI_ = std::move(rhs.serverURI_);
         clientId_ = std::move(rhs.clientId_);
         persistence_ = std::move(rhs.persistence_);
+        zeroCopy_ = rhs.zeroCopy_;
+        maxInternedTopics_ = rhs.maxInternedTopics_;
+        commitInterval_ = rhs.commitInterval_;
+        commitBytes_ = rhs.commitBytes_;
+        coalesceDelay_ = rhs.coalesceDelay_;
+        coalesceBytes_ = rhs.coalesceBytes_;
+        maxTopicAliases_ = rhs.maxTopicAliases_;
+        threadOpts_ = std::move(rhs.threadOpts_);
+        tokenTableShards_ = rhs.tokenTableShards_;
     }
     return *this;
 }
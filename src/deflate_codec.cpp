@@ -0,0 +1,134 @@
+// deflate_codec.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/deflate_codec.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "mqtt/exception.h"
+
+namespace mqtt {
+
+namespace {
+
+// Gets a pointer to the bytes of a buffer, as zlib wants them
+inline Bytef* bytes(const binary& buf)
+{
+    return reinterpret_cast<Bytef*>(const_cast<char*>(buf.data()));
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//  							deflate_codec
+/////////////////////////////////////////////////////////////////////////////
+
+deflate_codec::deflate_codec(int level /*=DFLT_LEVEL*/, const binary& dict /*=binary()*/)
+    : level_{level}, dict_{dict}, name_{NAME}
+{
+    if (level_ < Z_DEFAULT_COMPRESSION || level_ > Z_BEST_COMPRESSION)
+        throw exception(MQTTASYNC_FAILURE, "Bad deflate compression level");
+
+    if (!dict_.empty()) {
+        auto sum = adler32(0L, bytes(dict_), uInt(dict_.size()));
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "-%08lx", static_cast<unsigned long>(sum));
+        name_ += buf;
+    }
+}
+
+// The output is sized for the worst case up front, so the data is
+// compressed in a single pass.
+
+binary deflate_codec::encode(const binary& data) const
+{
+    z_stream strm{};
+    if (deflateInit(&strm, level_) != Z_OK)
+        throw exception(MQTTASYNC_FAILURE, "Can't start the deflate codec");
+
+    if (!dict_.empty() &&
+        deflateSetDictionary(&strm, bytes(dict_), uInt(dict_.size())) != Z_OK) {
+        deflateEnd(&strm);
+        throw exception(MQTTASYNC_FAILURE, "Can't set the deflate dictionary");
+    }
+
+    binary out(deflateBound(&strm, uLong(data.size())), '\0');
+
+    strm.next_in = bytes(data);
+    strm.avail_in = uInt(data.size());
+    strm.next_out = bytes(out);
+    strm.avail_out = uInt(out.size());
+
+    int rc = deflate(&strm, Z_FINISH);
+    out.resize(strm.total_out);
+    deflateEnd(&strm);
+
+    if (rc != Z_STREAM_END)
+        throw exception(MQTTASYNC_FAILURE, "Deflate failed");
+
+    return out;
+}
+
+// The size of the inflated data isn't known, so the output grows as
+// needed, starting from a guess of a typical compression ratio.
+
+binary deflate_codec::decode(const binary& data) const
+{
+    z_stream strm{};
+    if (inflateInit(&strm) != Z_OK)
+        throw exception(MQTTASYNC_FAILURE, "Can't start the deflate codec");
+
+    strm.next_in = bytes(data);
+    strm.avail_in = uInt(data.size());
+
+    binary out(std::max<size_t>(4 * data.size(), 256), '\0');
+    int rc = Z_OK;
+
+    while (rc != Z_STREAM_END) {
+        if (strm.total_out == out.size())
+            out.resize(2 * out.size());
+
+        strm.next_out = bytes(out) + strm.total_out;
+        strm.avail_out = uInt(out.size() - strm.total_out);
+
+        rc = inflate(&strm, Z_NO_FLUSH);
+
+        if (rc == Z_NEED_DICT) {
+            if (dict_.empty() ||
+                inflateSetDictionary(&strm, bytes(dict_), uInt(dict_.size())) != Z_OK) {
+                inflateEnd(&strm);
+                throw exception(MQTTASYNC_FAILURE, "Wrong deflate dictionary");
+            }
+            rc = Z_OK;
+        }
+        else if (rc != Z_OK && rc != Z_STREAM_END && !(rc == Z_BUF_ERROR && strm.avail_out == 0)) {
+            inflateEnd(&strm);
+            throw exception(MQTTASYNC_FAILURE, "Corrupt deflate payload");
+        }
+    }
+
+    out.resize(strm.total_out);
+    inflateEnd(&strm);
+    return out;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,264 @@
+// delta_codec.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/delta_codec.h"
+
+#include <cstdlib>
+
+#include "mqtt/exception.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// A delta is a list of runs, each of which is the number of bytes that
+// didn't change, then the number that did, as LEB128 varints, then the
+// XOR of the old and new values of the bytes that did. A short run of
+// unchanged bytes is folded into the changed ones around it, since it
+// would cost more to skip than to send.
+
+constexpr size_t MIN_SKIP = 4;
+
+void put_varint(binary& out, size_t n) {
+    while (n >= 0x80) {
+        out.push_back(char((n & 0x7F) | 0x80));
+        n >>= 7;
+    }
+    out.push_back(char(n));
+}
+
+bool get_varint(const binary& in, size_t& pos, size_t& n) {
+    n = 0;
+    for (unsigned shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        auto b = uint8_t(in[pos++]);
+        n |= size_t(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+const binary& payload_of(const binary_ref& ref) {
+    static const binary EMPTY_BIN;
+    return ref ? ref.str() : EMPTY_BIN;
+}
+
+// The properties of a message, less the frame marker
+properties without_frame(const properties& props) {
+    properties out;
+    for (const auto& prop : props) {
+        if (prop.type() == property::USER_PROPERTY &&
+            std::get<0>(get<string_pair>(prop)) == delta_codec::DELTA_PROPERTY)
+            continue;
+        out.add(property{prop});
+    }
+    return out;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+binary delta_codec::make_delta(const binary& prev, const binary& cur)
+{
+    const size_t n = cur.size();
+    binary out;
+    size_t i = 0;
+
+    while (i < n) {
+        size_t start = i;
+        while (i < n && prev[i] == cur[i]) ++i;
+        size_t skip = i - start;
+        if (i == n)
+            break;
+
+        // Take changed bytes up to the next long enough run of unchanged ones
+        start = i;
+        while (i < n) {
+            if (prev[i] != cur[i]) {
+                ++i;
+                continue;
+            }
+            size_t j = i;
+            while (j < n && prev[j] == cur[j] && j - i < MIN_SKIP) ++j;
+            if (j - i >= MIN_SKIP || j == n)
+                break;
+            i = j;
+        }
+
+        put_varint(out, skip);
+        put_varint(out, i - start);
+        for (size_t k = start; k < i; ++k) out.push_back(char(prev[k] ^ cur[k]));
+
+        // Trailing unchanged bytes don't need to be sent
+        if (i < n) {
+            size_t j = i;
+            while (j < n && prev[j] == cur[j]) ++j;
+            if (j == n)
+                break;
+        }
+    }
+    return out;
+}
+
+bool delta_codec::apply_delta(const binary& prev, const binary& delta, binary& out)
+{
+    out = prev;
+    size_t pos = 0, off = 0;
+
+    while (pos < delta.size()) {
+        size_t skip, len;
+        if (!get_varint(delta, pos, skip) || !get_varint(delta, pos, len))
+            return false;
+        if (skip > out.size() - off || len > out.size() - off - skip ||
+            len > delta.size() - pos)
+            return false;
+
+        off += skip;
+        for (size_t k = 0; k < len; ++k) out[off + k] ^= delta[pos + k];
+        off += len;
+        pos += len;
+    }
+    return true;
+}
+
+message_ptr delta_codec::with_frame(
+    const message& msg, binary_ref payload, char kind, uint64_t seq
+)
+{
+    auto props = msg.get_properties();
+    props.add({property::USER_PROPERTY, DELTA_PROPERTY, kind + std::to_string(seq)});
+
+    auto fmsg = std::make_shared<message>(msg);
+    fmsg->set_payload(std::move(payload));
+    fmsg->set_properties(std::move(props));
+    return fmsg;
+}
+
+// The state of the topic is only worked out here, and left for commit(),
+// so that a message that isn't sent after all doesn't count as the last
+// one on its topic.
+
+delta_codec::frame delta_codec::prepare(const const_message_ptr& msg)
+{
+    if (get_user_property(msg->get_properties(), DELTA_PROPERTY))
+        return frame{msg, nullptr, state{}, false};
+
+    const auto& payload = msg->get_payload_ref();
+    const auto& cur = payload_of(payload);
+
+    auto& st = sent_[msg->get_topic()];
+    state next{st.seq + 1, payload, st.sinceKey};
+
+    bool key = st.seq == 0 || msg->is_retained() || ++next.sinceKey >= keyInterval_;
+
+    const auto& prev = payload_of(st.payload);
+    binary delta;
+    if (!key) {
+        if (prev.size() == cur.size())
+            delta = make_delta(prev, cur);
+        key = prev.size() != cur.size() || delta.size() >= cur.size();
+    }
+
+    if (key) {
+        next.sinceKey = 0;
+        return frame{with_frame(*msg, payload, 'k', next.seq), &st, std::move(next), true};
+    }
+    auto fmsg = with_frame(*msg, binary_ref{std::move(delta)}, 'd', next.seq);
+    return frame{std::move(fmsg), &st, std::move(next), false};
+}
+
+void delta_codec::commit(frame& fr)
+{
+    if (!fr.st)
+        return;
+
+    *fr.st = std::move(fr.next);
+    if (fr.key)
+        ++nKeyframes_;
+    else
+        ++nDeltas_;
+}
+
+const_message_ptr delta_codec::decode(const_message_ptr msg)
+{
+    if (!msg)
+        return msg;
+
+    auto val = get_user_property(msg->get_properties(), DELTA_PROPERTY);
+    if (!val)
+        return msg;
+
+    char kind = val->empty() ? '\0' : (*val)[0];
+    string num{val->substr(val->empty() ? 0 : 1)};
+    char* end = nullptr;
+    uint64_t seq = std::strtoull(num.c_str(), &end, 10);
+    bool valid = (kind == 'k' || kind == 'd') && !num.empty() && *end == '\0';
+
+    guard g{recvLock_};
+    if (!valid) {
+        ++nUnresolved_;
+        return const_message_ptr{};
+    }
+
+    try {
+        auto& st = received_[msg->get_topic()];
+        binary_ref payload;
+
+        if (kind == 'k') {
+            payload = msg->get_payload_ref();
+        }
+        else {
+            binary out;
+            if (st.seq == 0 || seq != st.seq + 1 ||
+                !apply_delta(payload_of(st.payload), msg->get_payload(), out)) {
+                ++nUnresolved_;
+                return const_message_ptr{};
+            }
+            payload = binary_ref{std::move(out)};
+        }
+
+        st.seq = seq;
+        st.payload = payload;
+
+        auto dmsg = std::make_shared<message>(*msg);
+        dmsg->set_payload(std::move(payload));
+        dmsg->set_properties(without_frame(msg->get_properties()));
+        return dmsg;
+    }
+    catch (const exception&) {
+        // The payload codec couldn't decode it
+        ++nUnresolved_;
+        return const_message_ptr{};
+    }
+}
+
+void delta_codec::clear()
+{
+    {
+        guard g{sendLock_};
+        sent_.clear();
+    }
+    guard g{recvLock_};
+    received_.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,238 @@
+// dispatcher.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/dispatcher.h"
+
+#include <algorithm>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							dispatcher
+/////////////////////////////////////////////////////////////////////////////
+
+dispatcher::dispatcher(
+    std::size_t nThreads, handler_type handler, key_function keyFunc /*=key_function{}*/,
+    std::size_t queCap /*=queue_type::MAX_CAPACITY*/
+)
+    : handler_{std::move(handler)}, keyFunc_{std::move(keyFunc)}
+{
+    if (nThreads == 0)
+        nThreads = 1;
+
+    ques_.reserve(nThreads);
+    for (std::size_t i = 0; i < nThreads; ++i)
+        ques_.push_back(std::make_unique<queue_type>(queCap));
+
+    thrs_.reserve(nThreads);
+    for (auto& que : ques_) thrs_.emplace_back(&dispatcher::run, this, std::ref(*que));
+}
+
+dispatcher::~dispatcher() { stop(); }
+
+// Each worker runs until its queue is closed and empty.
+
+void dispatcher::run(queue_type& que)
+{
+    const_message_ptr msg;
+    while (que.get(&msg)) {
+        try {
+            if (handler_)
+                handler_(msg);
+        }
+        catch (...) {
+        }
+        msg.reset();
+    }
+}
+
+std::size_t dispatcher::size() const
+{
+    std::size_t n = 0;
+    for (const auto& que : ques_) n += que->size();
+    return n;
+}
+
+bool dispatcher::stopped() const { return ques_.front()->closed(); }
+
+bool dispatcher::dispatch(const_message_ptr msg)
+{
+    if (!msg)
+        return false;
+
+    try {
+        ques_[worker_index(*msg)]->put(std::move(msg));
+    }
+    catch (const queue_closed&) {
+        return false;
+    }
+    return true;
+}
+
+void dispatcher::stop()
+{
+    guard g{lock_};
+
+    for (auto& que : ques_) que->close();
+
+    for (auto& thr : thrs_) {
+        if (thr.joinable())
+            thr.join();
+    }
+    thrs_.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  						work_stealing_dispatcher
+/////////////////////////////////////////////////////////////////////////////
+
+work_stealing_dispatcher::work_stealing_dispatcher(std::size_t nThreads, handler_type handler)
+    : handler_{std::move(handler)}
+{
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    ques_.reserve(nThreads);
+    for (std::size_t i = 0; i < nThreads; ++i) ques_.push_back(std::make_unique<worker_queue>());
+
+    thrs_.reserve(nThreads);
+    for (std::size_t i = 0; i < nThreads; ++i)
+        thrs_.emplace_back(&work_stealing_dispatcher::run, this, i);
+}
+
+work_stealing_dispatcher::~work_stealing_dispatcher() { stop(); }
+
+// A worker takes the oldest message from its own queue. Failing that, it
+// steals the newest from the fullest of the other queues, going around
+// the others starting with its neighbor, so the first of a tie is the
+// closest. The sizes are read without the locks, so the queue picked
+// might be emptied by another worker before it's locked, in which case
+// it looks again, until all the queues are seen to be empty.
+
+bool work_stealing_dispatcher::try_take(std::size_t idx, const_message_ptr* msg)
+{
+    {
+        auto& que = *ques_[idx];
+        guard g{que.lock};
+        if (!que.msgs.empty()) {
+            *msg = std::move(que.msgs.front());
+            que.msgs.pop_front();
+            --que.size;
+            --nPending_;
+            return true;
+        }
+    }
+
+    const auto n = ques_.size();
+    while (true) {
+        worker_queue* victim = nullptr;
+        std::size_t maxSize = 0;
+
+        for (std::size_t i = 1; i < n; ++i) {
+            auto& que = *ques_[(idx + i) % n];
+            auto sz = que.size.load(std::memory_order_relaxed);
+            if (sz > maxSize) {
+                maxSize = sz;
+                victim = &que;
+            }
+        }
+
+        if (!victim)
+            return false;
+
+        guard g{victim->lock};
+        if (!victim->msgs.empty()) {
+            *msg = std::move(victim->msgs.back());
+            victim->msgs.pop_back();
+            --victim->size;
+            --nPending_;
+            ++nStolen_;
+            return true;
+        }
+    }
+}
+
+// Each worker runs until the dispatcher is stopped and all the queues are
+// empty.
+
+void work_stealing_dispatcher::run(std::size_t idx)
+{
+    const_message_ptr msg;
+
+    while (true) {
+        if (!try_take(idx, &msg)) {
+            unique_lock g{lock_};
+            ++nIdle_;
+            cond_.wait(g, [this] { return nPending_ != 0 || stopped_; });
+            --nIdle_;
+
+            if (nPending_ == 0 && stopped_)
+                break;
+            continue;
+        }
+
+        try {
+            if (handler_)
+                handler_(msg);
+        }
+        catch (...) {
+        }
+        msg.reset();
+    }
+}
+
+bool work_stealing_dispatcher::dispatch(const_message_ptr msg, std::size_t hint /*=0*/)
+{
+    if (!msg || stopped_)
+        return false;
+
+    {
+        auto& que = *ques_[hint % ques_.size()];
+        guard g{que.lock};
+        que.msgs.push_back(std::move(msg));
+        ++que.size;
+        ++nPending_;
+    }
+
+    // Only take the lock to wake a worker if one might be waiting. Taking
+    // it here means a worker can't miss the signal between checking the
+    // queues and going to sleep.
+    if (nIdle_ != 0) {
+        { guard g{lock_}; }
+        cond_.notify_one();
+    }
+    return true;
+}
+
+void work_stealing_dispatcher::stop()
+{
+    {
+        guard g{lock_};
+        stopped_ = true;
+    }
+    cond_.notify_all();
+
+    for (auto& thr : thrs_) {
+        if (thr.joinable())
+            thr.join();
+    }
+    thrs_.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,166 @@
+// duplicate_filter.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/duplicate_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace mqtt {
+
+namespace {
+
+// The 'splitmix64' finalizer, to spread the bits of a hash
+uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t hash_of(std::string_view sv) { return mix(std::hash<std::string_view>{}(sv)); }
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+duplicate_filter::duplicate_filter(
+    std::size_t window /*=DFLT_WINDOW*/, double fpRate /*=DFLT_FALSE_POSITIVE_RATE*/
+)
+    : window_{std::max<std::size_t>(window, 1)},
+      fpRate_{(fpRate > 0.0 && fpRate < 1.0) ? fpRate : DFLT_FALSE_POSITIVE_RATE}
+{
+    init();
+}
+
+duplicate_filter::duplicate_filter(
+    const string& propName, std::size_t window /*=DFLT_WINDOW*/,
+    double fpRate /*=DFLT_FALSE_POSITIVE_RATE*/
+)
+    : propName_{propName},
+      window_{std::max<std::size_t>(window, 1)},
+      fpRate_{(fpRate > 0.0 && fpRate < 1.0) ? fpRate : DFLT_FALSE_POSITIVE_RATE}
+{
+    init();
+}
+
+// The usual sizing for a Bloom filter of n keys with a false positive
+// rate of p: m = -n ln(p) / ln(2)^2 bits, with k = (m/n) ln(2) hashes.
+
+void duplicate_filter::init()
+{
+    const double LN2 = std::log(2.0);
+    auto n = double(window_);
+
+    auto m = std::size_t(std::ceil(-n * std::log(fpRate_) / (LN2 * LN2)));
+    nBits_ = std::max<std::size_t>((m + 63) / 64, 1) * 64;
+    nHashes_ = std::max(1u, unsigned(std::lround(double(nBits_) / n * LN2)));
+
+    for (auto& gen : gens_) gen.bits.assign(nBits_ / 64, 0);
+}
+
+bool duplicate_filter::get_key(
+    std::string_view topic, const MQTTAsync_message& cmsg, uint64_t& key
+) const
+{
+    if (propName_.empty()) {
+        // QoS 0 messages have no packet ID, and aren't sent again
+        if (cmsg.qos == 0)
+            return false;
+        key = hash_of(topic) ^ mix(uint64_t(cmsg.msgid));
+        return true;
+    }
+
+    const auto& props = cmsg.properties;
+    for (int i = 0; i < props.count; ++i) {
+        const auto& prop = props.array[i];
+        if (prop.identifier != MQTTPROPERTY_CODE_USER_PROPERTY)
+            continue;
+
+        std::string_view name{prop.value.data.data, size_t(prop.value.data.len)};
+        if (name == propName_) {
+            key = hash_of({prop.value.value.data, size_t(prop.value.value.len)});
+            return true;
+        }
+    }
+    return false;
+}
+
+// The k hashes are made from two, as h1 + i*h2, which works as well as k
+// separate ones for a Bloom filter.
+
+bool duplicate_filter::contains(const generation& gen, uint64_t key) const
+{
+    uint64_t h2 = mix(key) | 1;
+    for (unsigned i = 0; i < nHashes_; ++i) {
+        auto bit = (key + i * h2) % nBits_;
+        if ((gen.bits[bit / 64] & (uint64_t(1) << (bit % 64))) == 0)
+            return false;
+    }
+    return true;
+}
+
+void duplicate_filter::add(generation& gen, uint64_t key)
+{
+    uint64_t h2 = mix(key) | 1;
+    for (unsigned i = 0; i < nHashes_; ++i) {
+        auto bit = (key + i * h2) % nBits_;
+        gen.bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    ++gen.n;
+}
+
+bool duplicate_filter::check(std::string_view topic, const MQTTAsync_message& cmsg)
+{
+    uint64_t key;
+    if (!get_key(topic, cmsg, key))
+        return false;
+
+    nChecked_.fetch_add(1, std::memory_order_relaxed);
+
+    guard g{lock_};
+    bool seen = contains(gens_[cur_], key) || contains(gens_[1 - cur_], key);
+
+    // A reused packet ID is only a duplicate if it's marked as one
+    if (seen && (!propName_.empty() || cmsg.dup != 0)) {
+        nDropped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (gens_[cur_].n >= window_) {
+        cur_ = 1 - cur_;
+        std::fill(gens_[cur_].bits.begin(), gens_[cur_].bits.end(), 0);
+        gens_[cur_].n = 0;
+    }
+    add(gens_[cur_], key);
+    return false;
+}
+
+void duplicate_filter::clear()
+{
+    guard g{lock_};
+    for (auto& gen : gens_) {
+        std::fill(gen.bits.begin(), gen.bits.end(), 0);
+        gen.n = 0;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
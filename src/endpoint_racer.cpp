@@ -0,0 +1,292 @@
+// endpoint_racer.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/endpoint_racer.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <tuple>
+#include <vector>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// A connect in progress
+struct attempt
+{
+    size_t idx;
+    int fd;
+    endpoint_racer::clock::time_point start;
+};
+
+// Starts a non-blocking connect to the first address of a host.
+// Returns the socket, or -1 if the connect failed right away. Sets `done`
+// if it completed right away, as it can for the local host.
+int start_connect(const string& host, const string& port, bool& done)
+{
+    done = false;
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* res = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res)
+        return -1;
+
+    int fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd >= 0) {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        if (::connect(fd, res->ai_addr, res->ai_addrlen) == 0)
+            done = true;
+        else if (errno != EINPROGRESS) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(res);
+    return fd;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool endpoint_racer::host_port(const string& uri, string& host, string& port)
+{
+    static const std::map<string, string> DFLT_PORTS{
+        {"tcp", "1883"}, {"mqtt", "1883"}, {"ssl", "8883"}, {"mqtts", "8883"},
+        {"ws", "80"},    {"wss", "443"}
+    };
+
+    auto pos = uri.find("://");
+    auto scheme = (pos == string::npos) ? string{"tcp"} : uri.substr(0, pos);
+    auto it = DFLT_PORTS.find(scheme);
+    if (it == DFLT_PORTS.end())
+        return false;
+
+    auto addr = (pos == string::npos) ? uri : uri.substr(pos + 3);
+    addr = addr.substr(0, addr.find('/'));
+
+    string::size_type colon;
+    if (!addr.empty() && addr.front() == '[') {
+        auto end = addr.find(']');
+        if (end == string::npos)
+            return false;
+        host = addr.substr(1, end - 1);
+        colon = (end + 1 < addr.size() && addr[end + 1] == ':') ? end + 1 : string::npos;
+    }
+    else {
+        colon = addr.rfind(':');
+        host = addr.substr(0, colon);
+    }
+
+    port = (colon == string::npos) ? it->second : addr.substr(colon + 1);
+    return !host.empty() && !port.empty();
+}
+
+string_collection endpoint_racer::order(const string_collection& uris) const
+{
+    // Rank: 0 = connected before, 1 = not tried, 2 = failed
+    using key_type = std::tuple<int, duration::rep, unsigned>;
+    std::vector<std::pair<key_type, const string*>> keyed;
+    keyed.reserve(uris.size());
+    {
+        guard g{lock_};
+        for (const auto& uri : uris) {
+            key_type key{1, 0, 0};
+            auto it = hist_.find(uri);
+            if (it != hist_.end()) {
+                const auto& h = it->second;
+                if (h.nFailed > 0)
+                    key = key_type{2, 0, h.nFailed};
+                else if (h.latency)
+                    key = key_type{0, h.latency->count(), 0};
+            }
+            keyed.emplace_back(key, &uri);
+        }
+    }
+
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    string_collection ordered;
+    ordered.reserve(keyed.size());
+    for (const auto& k : keyed) ordered.push_back(*k.second);
+    return ordered;
+}
+
+// The connects are started in order of preference, each one a stagger
+// after the last, or right away if all the earlier ones have failed.
+// The first to complete wins. Servers still pending when there's a winner
+// are just abandoned, since they might have been a moment behind, but the
+// ones that time out count as failures.
+
+string endpoint_racer::race(const string_collection& uris)
+{
+    const auto ordered = order(uris);
+    const auto deadline = clock::now() + timeout_;
+
+    std::vector<attempt> pending;
+    size_t next = 0;
+    auto nextStart = clock::now();
+    string winner;
+
+    while (winner.empty()) {
+        auto now = clock::now();
+        if (now >= deadline)
+            break;
+
+        if (next < ordered.size() && (pending.empty() || now >= nextStart)) {
+            const auto& uri = ordered[next];
+            string host, port;
+            bool done = false;
+            int fd = host_port(uri, host, port) ? start_connect(host, port, done) : -1;
+
+            if (fd < 0)
+                record_failure(uri);
+            else if (done) {
+                ::close(fd);
+                record(uri, std::chrono::duration_cast<duration>(clock::now() - now));
+                winner = uri;
+                break;
+            }
+            else
+                pending.push_back({next, fd, now});
+
+            ++next;
+            nextStart = now + stagger_;
+            continue;
+        }
+
+        if (pending.empty())
+            break;
+
+        auto until = (next < ordered.size()) ? std::min(nextStart, deadline) : deadline;
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(until - now).count();
+
+        std::vector<pollfd> fds;
+        fds.reserve(pending.size());
+        for (const auto& a : pending) fds.push_back({a.fd, POLLOUT, 0});
+
+        int n = ::poll(fds.data(), nfds_t(fds.size()), int(std::max<decltype(ms)>(ms, 0)));
+        if (n < 0 && errno != EINTR)
+            break;
+        if (n <= 0)
+            continue;
+
+        // The most preferred server wins if more than one completed
+        now = clock::now();
+        std::vector<attempt> still;
+        for (size_t i = 0; i < fds.size(); ++i) {
+            const auto& a = pending[i];
+            if (fds[i].revents == 0) {
+                still.push_back(a);
+                continue;
+            }
+
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (::getsockopt(a.fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0)
+                err = errno;
+
+            if (err != 0)
+                record_failure(ordered[a.idx]);
+            else if (winner.empty()) {
+                record(ordered[a.idx], std::chrono::duration_cast<duration>(now - a.start));
+                winner = ordered[a.idx];
+            }
+            ::close(a.fd);
+        }
+        pending = std::move(still);
+    }
+
+    for (const auto& a : pending) {
+        if (winner.empty())
+            record_failure(ordered[a.idx]);
+        ::close(a.fd);
+    }
+    return winner;
+}
+
+bool endpoint_racer::apply(connect_options& opts)
+{
+    auto servers = opts.get_servers();
+    if (!servers || servers->empty())
+        return false;
+
+    auto winner = race(*servers);
+
+    // The race recorded the winner, so it's first in the new order
+    opts.set_servers(std::make_shared<string_collection>(order(*servers)));
+    return !winner.empty();
+}
+
+void endpoint_racer::record(const string& uri, duration latency)
+{
+    guard g{lock_};
+    auto& h = hist_[uri];
+    if (h.latency) {
+        auto avg = smoothing_ * double(latency.count()) +
+                   (1.0 - smoothing_) * double(h.latency->count());
+        h.latency = duration{duration::rep(avg)};
+    }
+    else
+        h.latency = latency;
+    h.nFailed = 0;
+}
+
+void endpoint_racer::record_failure(const string& uri)
+{
+    guard g{lock_};
+    ++hist_[uri].nFailed;
+}
+
+std::optional<endpoint_racer::duration> endpoint_racer::latency(const string& uri) const
+{
+    guard g{lock_};
+    auto it = hist_.find(uri);
+    return (it == hist_.end()) ? std::nullopt : it->second.latency;
+}
+
+unsigned endpoint_racer::num_failures(const string& uri) const
+{
+    guard g{lock_};
+    auto it = hist_.find(uri);
+    return (it == hist_.end()) ? 0 : it->second.nFailed;
+}
+
+void endpoint_racer::clear()
+{
+    guard g{lock_};
+    hist_.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
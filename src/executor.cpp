@@ -0,0 +1,70 @@
+// executor.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/executor.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							thread_executor
+/////////////////////////////////////////////////////////////////////////////
+
+thread_executor::thread_executor(std::size_t queCap /*=queue_type::MAX_CAPACITY*/)
+    : que_{queCap}, thr_{&thread_executor::run, this}
+{
+}
+
+thread_executor::~thread_executor() { stop(); }
+
+// The thread runs until the queue is closed and empty.
+
+void thread_executor::run()
+{
+    task_type task;
+    while (que_.get(&task)) {
+        try {
+            if (task)
+                task();
+        }
+        catch (...) {
+        }
+        task = nullptr;
+    }
+}
+
+bool thread_executor::execute(task_type task)
+{
+    try {
+        que_.put(std::move(task));
+    }
+    catch (const queue_closed&) {
+        return false;
+    }
+    return true;
+}
+
+void thread_executor::stop()
+{
+    guard g{lock_};
+    que_.close();
+    if (thr_.joinable())
+        thr_.join();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,272 @@
+// group_commit_persistence.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/group_commit_persistence.h"
+
+#include <set>
+
+#include "mqtt/exception.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  						group_commit_persistence
+/////////////////////////////////////////////////////////////////////////////
+
+// The locks are always taken in the order: storeLock_, then lock_.
+// Puts only need lock_, so they never wait on the store.
+
+group_commit_persistence::~group_commit_persistence()
+{
+    stop_thread();
+    try {
+        commit();
+    }
+    catch (...) {
+    }
+}
+
+void group_commit_persistence::stop_thread()
+{
+    {
+        guard g{lock_};
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thr_.joinable())
+        thr_.join();
+}
+
+// The commit thread wakes when the oldest pending change has waited for
+// the commit interval, or when the size threshold is reached.
+
+void group_commit_persistence::run()
+{
+    unique_guard g{lock_};
+
+    while (!stop_) {
+        if (pending_.empty()) {
+            cond_.wait(g, [this] { return stop_ || !pending_.empty(); });
+        }
+        else {
+            cond_.wait_until(g, oldest_ + interval_, [this] {
+                return stop_ || pendingBytes_ >= maxBytes_;
+            });
+        }
+
+        if (stop_ || pending_.empty())
+            continue;
+
+        if (pendingBytes_ >= maxBytes_ || clock::now() >= oldest_ + interval_) {
+            g.unlock();
+            try {
+                commit();
+            }
+            catch (...) {
+            }
+            g.lock();
+        }
+    }
+}
+
+void group_commit_persistence::add_change(const string& key, change&& chg)
+{
+    bool wasEmpty = pending_.empty();
+    if (wasEmpty)
+        oldest_ = clock::now();
+
+    size_t n = chg.data.size();
+    auto it = pending_.find(key);
+    if (it != pending_.end()) {
+        pendingBytes_ -= it->second.data.size();
+        it->second = std::move(chg);
+    }
+    else {
+        pending_.emplace(key, std::move(chg));
+    }
+    pendingBytes_ += n;
+
+    if (wasEmpty || pendingBytes_ >= maxBytes_)
+        cond_.notify_one();
+}
+
+const group_commit_persistence::change* group_commit_persistence::find_change(
+    const string& key
+) const
+{
+    auto it = pending_.find(key);
+    return (it == pending_.end()) ? nullptr : &it->second;
+}
+
+// If the store fails, the changes are put back, unless they have since
+// been replaced, to be retried with the next commit.
+
+void group_commit_persistence::do_commit()
+{
+    change_map chgs;
+    {
+        guard g{lock_};
+        if (pending_.empty())
+            return;
+        chgs.swap(pending_);
+        pendingBytes_ = 0;
+    }
+
+    try {
+        for (const auto& [key, chg] : chgs) {
+            if (chg.removed) {
+                if (store_.contains_key(key))
+                    store_.remove(key);
+            }
+            else {
+                store_.put(key, {string_view{chg.data}});
+            }
+        }
+        store_.sync();
+    }
+    catch (...) {
+        guard g{lock_};
+        if (pending_.empty())
+            oldest_ = clock::now();
+        for (auto& [key, chg] : chgs) {
+            auto n = chg.data.size();
+            if (pending_.emplace(key, std::move(chg)).second)
+                pendingBytes_ += n;
+        }
+        throw;
+    }
+}
+
+void group_commit_persistence::commit()
+{
+    guard sg{storeLock_};
+    do_commit();
+}
+
+void group_commit_persistence::open(const string& clientId, const string& serverURI)
+{
+    stop_thread();
+    {
+        guard sg{storeLock_};
+        store_.open(clientId, serverURI);
+    }
+
+    guard g{lock_};
+    stop_ = false;
+    thr_ = std::thread(&group_commit_persistence::run, this);
+}
+
+void group_commit_persistence::close()
+{
+    stop_thread();
+
+    guard sg{storeLock_};
+    do_commit();
+    store_.close();
+}
+
+void group_commit_persistence::clear()
+{
+    guard sg{storeLock_};
+    {
+        guard g{lock_};
+        pending_.clear();
+        pendingBytes_ = 0;
+    }
+    store_.clear();
+}
+
+bool group_commit_persistence::contains_key(const string& key)
+{
+    guard sg{storeLock_};
+    {
+        guard g{lock_};
+        if (auto chg = find_change(key); chg)
+            return !chg->removed;
+    }
+    return store_.contains_key(key);
+}
+
+string_collection group_commit_persistence::keys() const
+{
+    guard sg{storeLock_};
+    auto storeKeys = store_.keys();
+
+    std::set<string> ks;
+    for (size_t i = 0; i < storeKeys.size(); ++i) ks.insert(storeKeys[i]);
+
+    guard g{lock_};
+    for (const auto& [key, chg] : pending_) {
+        if (chg.removed)
+            ks.erase(key);
+        else
+            ks.insert(key);
+    }
+
+    string_collection coll;
+    for (const auto& key : ks) coll.push_back(key);
+    return coll;
+}
+
+void group_commit_persistence::put(const string& key, const std::vector<string_view>& bufs)
+{
+    change chg;
+    size_t n = 0;
+    for (const auto& buf : bufs) n += buf.size();
+
+    chg.data.reserve(n);
+    for (const auto& buf : bufs) chg.data.append(buf.data(), buf.size());
+
+    guard g{lock_};
+    add_change(key, std::move(chg));
+}
+
+string group_commit_persistence::get(const string& key) const
+{
+    guard sg{storeLock_};
+    {
+        guard g{lock_};
+        if (auto chg = find_change(key); chg) {
+            if (chg->removed)
+                throw persistence_exception();
+            return chg->data;
+        }
+    }
+    return store_.get(key);
+}
+
+void group_commit_persistence::remove(const string& key)
+{
+    guard sg{storeLock_};
+    guard g{lock_};
+
+    if (auto chg = find_change(key); chg) {
+        if (chg->removed)
+            throw persistence_exception();
+    }
+    else if (!store_.contains_key(key)) {
+        throw persistence_exception();
+    }
+
+    change chg;
+    chg.removed = true;
+    add_change(key, std::move(chg));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -20,6 +20,8 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <new>
+#include <unordered_map>
 #include <vector>
 
 #include "mqtt/types.h"
@@ -28,6 +30,108 @@ using namespace std;
 
 namespace mqtt {
 
+/////////////////////////////////////////////////////////////////////////////
+// The restore cache
+
+// When the library restores a session, it lists the keys, then gets the
+// values one at a time. So the values are read in bulk when the keys are
+// listed, and handed out from this cache as they're asked for. The keys
+// stay in the cache after their values are taken, so that listing the
+// keys again, as the library does on connect, only reads the new ones.
+
+struct iclient_persistence::restore_cache
+{
+    /** A cached value, and whether it was given to the library */
+    struct entry
+    {
+        restored_value val;
+        bool taken{false};
+    };
+
+    std::unordered_map<string, entry> vals;
+
+    ~restore_cache() {
+        for (auto& [key, ent] : vals) {
+            if (!ent.taken)
+                persistence_free(ent.val.buf);
+        }
+    }
+};
+
+iclient_persistence::iclient_persistence() {}
+
+iclient_persistence::iclient_persistence(const iclient_persistence&) {}
+
+iclient_persistence::~iclient_persistence() {}
+
+void iclient_persistence::prefetch(const std::vector<string>& keys)
+{
+    std::lock_guard<std::mutex> g{restoreLock_};
+
+    if (!restored_)
+        restored_ = std::make_unique<restore_cache>();
+
+    std::vector<string> newKeys;
+    for (const auto& key : keys) {
+        if (restored_->vals.find(key) == restored_->vals.end())
+            newKeys.push_back(key);
+    }
+
+    if (newKeys.empty())
+        return;
+
+    auto vals = get_all(newKeys);
+    for (size_t i = 0; i < newKeys.size(); ++i) {
+        auto val = (i < vals.size()) ? vals[i] : restored_value{};
+        auto& ent = restored_->vals[std::move(newKeys[i])];
+        ent.val = val;
+        ent.taken = !val.buf;
+    }
+    hasRestored_ = true;
+}
+
+char* iclient_persistence::take_restored(const string& key, size_t* len)
+{
+    if (!hasRestored_)
+        return nullptr;
+
+    std::lock_guard<std::mutex> g{restoreLock_};
+    if (!restored_)
+        return nullptr;
+
+    auto it = restored_->vals.find(key);
+    if (it == restored_->vals.end() || it->second.taken)
+        return nullptr;
+
+    it->second.taken = true;
+    *len = it->second.val.len;
+    return it->second.val.buf;
+}
+
+void iclient_persistence::forget_restored(const string& key)
+{
+    if (!hasRestored_)
+        return;
+
+    std::lock_guard<std::mutex> g{restoreLock_};
+    if (!restored_)
+        return;
+
+    auto it = restored_->vals.find(key);
+    if (it != restored_->vals.end()) {
+        if (!it->second.taken)
+            persistence_free(it->second.val.buf);
+        restored_->vals.erase(it);
+    }
+}
+
+void iclient_persistence::drop_restored()
+{
+    std::lock_guard<std::mutex> g{restoreLock_};
+    restored_.reset();
+    hasRestored_ = false;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Functions to transition C persistence calls to the C++ persistence object.
 
@@ -56,7 +160,9 @@ int iclient_persistence::persistence_close(void* handle)
 {
     try {
         if (handle) {
-            static_cast<iclient_persistence*>(handle)->close();
+            auto self = static_cast<iclient_persistence*>(handle);
+            self->drop_restored();
+            self->close();
             return MQTTASYNC_SUCCESS;
         }
     }
@@ -75,7 +181,9 @@ int iclient_persistence::persistence_put(
             std::vector<string_view> vec;
             for (int i = 0; i < bufcount; ++i)
                 vec.push_back(string_view(buffers[i], buflens[i]));
-            static_cast<iclient_persistence*>(handle)->put(key, vec);
+            auto self = static_cast<iclient_persistence*>(handle);
+            self->forget_restored(key);
+            self->put(key, vec);
             return MQTTASYNC_SUCCESS;
         }
     }
@@ -89,10 +197,10 @@ int iclient_persistence::persistence_get(void* handle, char* key, char** buffer,
 {
     try {
         if (handle && key && buffer && buflen) {
-            auto s = static_cast<iclient_persistence*>(handle)->get(key);
-            size_t n = s.length();
-            *buffer = static_cast<char*>(MQTTAsync_malloc(n));
-            memcpy(*buffer, s.data(), n);
+            auto self = static_cast<iclient_persistence*>(handle);
+            size_t n = 0;
+            char* buf = self->take_restored(key, &n);
+            *buffer = buf ? buf : self->get_into(key, &n);
             *buflen = int(n);
             return MQTTASYNC_SUCCESS;
         }
@@ -107,7 +215,9 @@ int iclient_persistence::persistence_remove(void* handle, char* key)
 {
     try {
         if (handle && key) {
-            static_cast<iclient_persistence*>(handle)->remove(key);
+            auto self = static_cast<iclient_persistence*>(handle);
+            self->forget_restored(key);
+            self->remove(key);
             return MQTTASYNC_SUCCESS;
         }
     }
@@ -117,26 +227,51 @@ int iclient_persistence::persistence_remove(void* handle, char* key)
     return MQTTCLIENT_PERSISTENCE_ERROR;
 }
 
+// The keys are streamed from the store, and the values for all of them are
+// read in bulk, since the library is about to ask for each one of them.
+
 int iclient_persistence::persistence_keys(void* handle, char*** keys, int* nkeys)
 {
     try {
         if (handle && keys && nkeys) {
-            auto k = static_cast<iclient_persistence*>(handle)->keys();
-            size_t n = k.size();
-            *nkeys = int(n);
+            auto self = static_cast<iclient_persistence*>(handle);
+
+            std::vector<string> ks;
+            self->for_each_key([&ks](const string& key) { ks.push_back(key); });
+
+            size_t n = ks.size();
             if (n == 0) {
                 *keys = nullptr;
+                *nkeys = 0;
+                return MQTTASYNC_SUCCESS;
             }
-            else {
-                *keys = static_cast<char**>(MQTTAsync_malloc(n * sizeof(char*)));
-                for (size_t i = 0; i < n; ++i) {
-                    auto sz = k[i].size();
-                    char* buf = static_cast<char*>(MQTTAsync_malloc(sz + 1));
-                    strncpy(buf, k[i].c_str(), sz + 1);
-                    buf[sz] = '\0';
-                    (*keys)[i] = buf;
+
+            auto arr = static_cast<char**>(MQTTAsync_malloc(n * sizeof(char*)));
+            if (!arr)
+                return MQTTCLIENT_PERSISTENCE_ERROR;
+
+            for (size_t i = 0; i < n; ++i) {
+                auto sz = ks[i].size();
+                char* buf = static_cast<char*>(MQTTAsync_malloc(sz + 1));
+                if (!buf) {
+                    while (i > 0) MQTTAsync_free(arr[--i]);
+                    MQTTAsync_free(arr);
+                    return MQTTCLIENT_PERSISTENCE_ERROR;
                 }
+                memcpy(buf, ks[i].data(), sz);
+                buf[sz] = '\0';
+                arr[i] = buf;
+            }
+
+            // A failed read just leaves the values to be read one at a time
+            try {
+                self->prefetch(ks);
             }
+            catch (...) {
+            }
+
+            *keys = arr;
+            *nkeys = int(n);
             return MQTTASYNC_SUCCESS;
         }
     }
@@ -150,7 +285,9 @@ int iclient_persistence::persistence_clear(void* handle)
 {
     try {
         if (handle) {
-            static_cast<iclient_persistence*>(handle)->clear();
+            auto self = static_cast<iclient_persistence*>(handle);
+            self->drop_restored();
+            self->clear();
             return MQTTASYNC_SUCCESS;
         }
     }
@@ -172,6 +309,49 @@ int iclient_persistence::persistence_containskey(void* handle, char* key)
     return MQTTCLIENT_PERSISTENCE_ERROR;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Default implementations of the optional virtual methods.
+
+char* iclient_persistence::get_into(const string& key, size_t* len) const
+{
+    auto s = get(key);
+    size_t n = s.length();
+
+    char* buf = static_cast<char*>(persistence_malloc(n));
+    if (!buf && n > 0)
+        throw std::bad_alloc();
+
+    memcpy(buf, s.data(), n);
+    if (len)
+        *len = n;
+    return buf;
+}
+
+void iclient_persistence::for_each_key(const key_handler& fn) const
+{
+    auto ks = keys();
+    for (size_t i = 0; i < ks.size(); ++i) fn(ks[i]);
+}
+
+// A value that can't be read is left for get_into() to try again, and
+// report the error, when the library asks for it.
+
+std::vector<iclient_persistence::restored_value> iclient_persistence::get_all(
+    const std::vector<string>& keys
+) const
+{
+    std::vector<restored_value> vals(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        try {
+            vals[i].buf = get_into(keys[i], &vals[i].len);
+        }
+        catch (...) {
+            vals[i] = restored_value{};
+        }
+    }
+    return vals;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // end namespace mqtt
 }  // namespace mqtt
@@ -0,0 +1,231 @@
+// inflight_window.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/inflight_window.h"
+
+#include <algorithm>
+
+namespace mqtt {
+
+constexpr std::size_t inflight_window::DFLT_INIT_WINDOW;
+constexpr std::size_t inflight_window::DFLT_MAX_QUEUE;
+constexpr double inflight_window::DFLT_DELAY_FACTOR;
+constexpr double inflight_window::DECREASE_FACTOR;
+
+/////////////////////////////////////////////////////////////////////////////
+//  							inflight_window
+/////////////////////////////////////////////////////////////////////////////
+
+// The window grows without a threshold until the first congestion, as TCP
+// does in slow start, so it finds the size of the link quickly.
+
+inflight_window::inflight_window(
+    std::size_t maxWindow, std::size_t minWindow /*=1*/,
+    std::size_t initWindow /*=DFLT_INIT_WINDOW*/, double delayFactor /*=DFLT_DELAY_FACTOR*/,
+    std::size_t maxQueue /*=DFLT_MAX_QUEUE*/
+)
+    : minWindow_{std::max<std::size_t>(minWindow, 1)},
+      maxWindow_{std::max(maxWindow, minWindow_)},
+      delayFactor_{std::max(delayFactor, 1.0)},
+      maxQueue_{std::max<std::size_t>(maxQueue, 1)},
+      cwnd_{double(std::min(std::max(initWindow, minWindow_), maxWindow_))},
+      ssthresh_{double(maxWindow_)}
+{
+}
+
+inflight_window::~inflight_window() { stop(); }
+
+std::size_t inflight_window::window() const
+{
+    return std::max(minWindow_, std::size_t(cwnd_));
+}
+
+void inflight_window::decrease(clock::time_point now)
+{
+    if (now < holdUntil_)
+        return;
+
+    cwnd_ = std::max(cwnd_ * DECREASE_FACTOR, double(minWindow_));
+    ssthresh_ = cwnd_;
+    holdUntil_ = now + srtt_;
+    ++nDecreases_;
+}
+
+// Only one thread at a time runs the waiting operations, so an operation
+// that gives back its slot right away, like a send that fails, doesn't
+// start another round of them under itself. An operation that throws
+// mustn't leave the window thinking that it's still being drained, or
+// keep its slot, since it can't give it back.
+
+void inflight_window::drain(unique_lock& g)
+{
+    if (draining_)
+        return;
+
+    draining_ = true;
+    while (!stopped_ && !que_.empty() && inFlight_ < window()) {
+        auto task = std::move(que_.front());
+        que_.pop_front();
+        ++inFlight_;
+
+        g.unlock();
+        bool threw = false;
+        try {
+            task(true);
+        }
+        catch (...) {
+            threw = true;
+        }
+        g.lock();
+
+        if (threw && inFlight_ > 0)
+            --inFlight_;
+    }
+    draining_ = false;
+}
+
+std::size_t inflight_window::get_window() const
+{
+    guard g{lock_};
+    return window();
+}
+
+std::size_t inflight_window::in_flight() const
+{
+    guard g{lock_};
+    return inFlight_;
+}
+
+std::size_t inflight_window::queue_size() const
+{
+    guard g{lock_};
+    return que_.size();
+}
+
+inflight_window::duration inflight_window::get_smoothed_rtt() const
+{
+    guard g{lock_};
+    return srtt_;
+}
+
+inflight_window::duration inflight_window::get_min_rtt() const
+{
+    guard g{lock_};
+    return minRtt_;
+}
+
+std::size_t inflight_window::num_acked() const
+{
+    guard g{lock_};
+    return nAcked_;
+}
+
+std::size_t inflight_window::num_lost() const
+{
+    guard g{lock_};
+    return nLost_;
+}
+
+std::size_t inflight_window::num_decreases() const
+{
+    guard g{lock_};
+    return nDecreases_;
+}
+
+std::size_t inflight_window::num_rejected() const
+{
+    guard g{lock_};
+    return nRejected_;
+}
+
+bool inflight_window::submit(task_type task)
+{
+    unique_lock g{lock_};
+    if (stopped_)
+        return false;
+
+    if (que_.size() >= maxQueue_) {
+        ++nRejected_;
+        return false;
+    }
+
+    que_.push_back(std::move(task));
+    drain(g);
+    return true;
+}
+
+// The round trip is smoothed with the same 1/8 gain as TCP, so a single
+// slow ack doesn't cut the window, but a queue that builds up does.
+
+void inflight_window::on_acked(duration rtt)
+{
+    unique_lock g{lock_};
+    if (inFlight_ > 0)
+        --inFlight_;
+    ++nAcked_;
+
+    rtt = std::max(rtt, duration{1});
+    srtt_ = (srtt_ == duration::zero()) ? rtt : srtt_ + (rtt - srtt_) / 8;
+    if (minRtt_ == duration::zero() || rtt < minRtt_)
+        minRtt_ = rtt;
+
+    auto now = clock::now();
+    if (double(srtt_.count()) > delayFactor_ * double(minRtt_.count())) {
+        decrease(now);
+    }
+    else if (now >= holdUntil_) {
+        if (cwnd_ < ssthresh_)
+            cwnd_ += 1.0;
+        else
+            cwnd_ += 1.0 / cwnd_;
+        cwnd_ = std::min(cwnd_, double(maxWindow_));
+    }
+
+    drain(g);
+}
+
+void inflight_window::on_lost()
+{
+    unique_lock g{lock_};
+    if (inFlight_ > 0)
+        --inFlight_;
+    ++nLost_;
+
+    decrease(clock::now());
+    drain(g);
+}
+
+bool inflight_window::stopped() const
+{
+    guard g{lock_};
+    return stopped_;
+}
+
+void inflight_window::stop()
+{
+    std::deque<task_type> que;
+    {
+        guard g{lock_};
+        stopped_ = true;
+        que.swap(que_);
+    }
+    for (auto& task : que) task(false);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
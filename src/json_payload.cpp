@@ -0,0 +1,67 @@
+// json_payload.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/json_payload.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// The parser holds the working space of a parse, and the padded buffer
+// for payloads that get copied, so each thread keeps one to reuse. The
+// document is separate, and is kept with the payload.
+simdjson::dom::parser& thread_parser()
+{
+    thread_local simdjson::dom::parser parser;
+    return parser;
+}
+
+}  // namespace
+
+// Only a payload in its own string buffer can have room past its end. An
+// inline or external buffer is taken to have none.
+
+bool json_payload::has_padding(const binary_ref& payload)
+{
+    if (!payload || payload.is_external() || payload.is_inline())
+        return false;
+    const auto& str = payload.str();
+    return str.capacity() - str.size() >= simdjson::SIMDJSON_PADDING;
+}
+
+json_payload::json_payload(const binary_ref& payload) : inPlace_{has_padding(payload)}
+{
+    const char* data = payload ? payload.data() : "";
+    size_t len = payload ? payload.size() : 0;
+
+    auto res = thread_parser().parse_into_document(doc_, data, len, !inPlace_);
+    if ((err_ = res.error()) == simdjson::SUCCESS)
+        root_ = res.value_unsafe();
+}
+
+json_payload_ptr get_json(const message& msg)
+{
+    return msg.get_parsed_payload<json_payload>([](const binary_ref& payload) {
+        return std::make_shared<const json_payload>(payload);
+    });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,178 @@
+// last_value_cache.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/last_value_cache.h"
+
+#include <utility>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool last_value_cache::update(const_message_ptr msg)
+{
+    if (!msg || (retainedOnly_ && !msg->is_retained()))
+        return false;
+
+    const auto& topic = msg->get_topic();
+    topic_levels levels{topic};
+    if (levels.empty())
+        return false;
+
+    unique_guard g{lock_};
+
+    if (msg->is_retained() && msg->get_payload_ref().empty())
+        return remove(topic);
+
+    auto it = index_.find(topic);
+    if (it != index_.end()) {
+        memBytes_ -= it->second->memory_size();
+        it->second = msg;
+    }
+    else {
+        if (maxTopics_ != 0 && index_.size() >= maxTopics_)
+            return false;
+        index_.emplace(topic, msg);
+    }
+    memBytes_ += msg->memory_size();
+    if (memBytes_ > peakMemBytes_)
+        peakMemBytes_ = memBytes_;
+
+    auto nd = &root_;
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        auto& child = nd->children[string(levels.level(topic, i))];
+        if (!child)
+            child = std::make_unique<node>();
+        nd = child.get();
+    }
+    nd->msg = std::move(msg);
+    return true;
+}
+
+// The nodes that are left empty are removed on the way back up, so the
+// tree only has the branches for the topics that are held.
+
+bool last_value_cache::remove(const string& topic)
+{
+    auto it = index_.find(topic);
+    if (it == index_.end())
+        return false;
+    memBytes_ -= it->second->memory_size();
+    index_.erase(it);
+
+    topic_levels levels{topic};
+    std::vector<node*> path{&root_};
+
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        auto it = path.back()->children.find(string(levels.level(topic, i)));
+        if (it == path.back()->children.end())
+            return true;
+        path.push_back(it->second.get());
+    }
+    path.back()->msg.reset();
+
+    for (auto i = levels.size(); i > 0; --i) {
+        auto nd = path[i];
+        if (nd->msg || !nd->children.empty())
+            break;
+        path[i - 1]->children.erase(string(levels.level(topic, i - 1)));
+    }
+    return true;
+}
+
+const_message_ptr last_value_cache::get_last(const string& topic) const
+{
+    shared_guard g{lock_};
+    auto it = index_.find(topic);
+    return (it == index_.end()) ? const_message_ptr{} : it->second;
+}
+
+void last_value_cache::collect_all(
+    const node& nd, bool top, std::vector<const_message_ptr>& msgs
+)
+{
+    if (nd.msg)
+        msgs.push_back(nd.msg);
+
+    for (const auto& [name, child] : nd.children) {
+        if (top && !name.empty() && name[0] == '$')
+            continue;
+        collect_all(*child, false, msgs);
+    }
+}
+
+void last_value_cache::collect(
+    const node& nd, const string& filter, const topic_levels& levels, std::size_t i,
+    std::vector<const_message_ptr>& msgs
+)
+{
+    if (i == levels.size()) {
+        if (nd.msg)
+            msgs.push_back(nd.msg);
+        return;
+    }
+
+    auto lvl = levels.level(filter, i);
+    bool top = (i == 0);
+
+    if (lvl == "#") {
+        // The multi-level wildcard also matches the parent level
+        collect_all(nd, top, msgs);
+    }
+    else if (lvl == "+") {
+        for (const auto& [name, child] : nd.children) {
+            if (top && !name.empty() && name[0] == '$')
+                continue;
+            collect(*child, filter, levels, i + 1, msgs);
+        }
+    }
+    else {
+        auto it = nd.children.find(string(lvl));
+        if (it != nd.children.end())
+            collect(*it->second, filter, levels, i + 1, msgs);
+    }
+}
+
+std::vector<const_message_ptr> last_value_cache::snapshot(const string& filter) const
+{
+    std::vector<const_message_ptr> msgs;
+    topic_levels levels{filter};
+    if (levels.empty())
+        return msgs;
+
+    shared_guard g{lock_};
+    collect(root_, filter, levels, 0, msgs);
+    return msgs;
+}
+
+bool last_value_cache::erase(const string& topic)
+{
+    unique_guard g{lock_};
+    return remove(topic);
+}
+
+void last_value_cache::clear()
+{
+    unique_guard g{lock_};
+    index_.clear();
+    root_.children.clear();
+    memBytes_ = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
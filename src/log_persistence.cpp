@@ -0,0 +1,573 @@
+// log_persistence.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/log_persistence.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <thread>
+
+#include "mqtt/exception.h"
+
+namespace fs = std::filesystem;
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Each record in a segment is a header, followed by the key and then the
+// value, padded out to a multiple of 8 bytes. The magic number is written
+// last, so a record that was only partly written is never seen as valid.
+
+struct rec_header
+{
+    uint32_t magic;
+    uint32_t keyLen;
+    uint32_t valLen;
+    uint32_t flags;
+};
+
+constexpr uint32_t REC_MAGIC = 0x4d51544c;  // "MQTL"
+constexpr uint32_t REC_TOMBSTONE = 0x01;
+
+constexpr size_t HDR_SIZE = sizeof(rec_header);
+
+// The amount of data to restore before it's split across threads
+constexpr size_t PARALLEL_RESTORE_SIZE = 16 * 1024 * 1024;
+// The most threads to use to restore data
+constexpr size_t MAX_RESTORE_THREADS = 8;
+
+constexpr size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+size_t page_size() {
+    static const size_t sz = size_t(::sysconf(_SC_PAGESIZE));
+    return sz;
+}
+
+[[noreturn]] void throw_errno(const string& what) {
+    throw persistence_exception(what + ": " + std::strerror(errno));
+}
+
+// Flushes a range of a mapped segment to disk.
+void sync_range(char* base, size_t offset, size_t len) {
+    auto pg = page_size();
+    auto start = (offset / pg) * pg;
+    if (::msync(base + start, offset + len - start, MS_SYNC) != 0)
+        throw_errno("Error syncing log segment");
+}
+
+// Makes a file name from the client ID and server URI
+string store_name(const string& clientId, const string& serverURI) {
+    string name = clientId + "-" + serverURI;
+    for (auto& c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-')
+            c = '-';
+    }
+    return name;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//  							log_persistence
+/////////////////////////////////////////////////////////////////////////////
+
+log_persistence::log_persistence(
+    const string& baseDir, size_t segSize /*=DFLT_SEGMENT_SIZE*/, bool syncWrites /*=false*/
+)
+    : baseDir_{baseDir}, segSize_{std::max(segSize, page_size())}, syncWrites_{syncWrites}
+{
+}
+
+log_persistence::~log_persistence() { close_all(); }
+
+// --------------------------------------------------------------------------
+// Segments
+
+log_persistence::segment& log_persistence::get_segment(uint32_t id)
+{
+    auto it = std::lower_bound(
+        segs_.begin(), segs_.end(), id, [](const segment& seg, uint32_t id) { return seg.id < id; }
+    );
+    if (it == segs_.end() || it->id != id)
+        throw persistence_exception("Missing log segment");
+    return *it;
+}
+
+string log_persistence::segment_path(uint32_t id) const
+{
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%08x.log", unsigned(id));
+    return dir_ + "/" + buf;
+}
+
+log_persistence::segment& log_persistence::add_segment(size_t n)
+{
+    auto pg = page_size();
+
+    segment seg;
+    seg.id = segs_.empty() ? 0 : (segs_.back().id + 1);
+    seg.size = ((std::max(segSize_, n) + pg - 1) / pg) * pg;
+
+    auto path = segment_path(seg.id);
+    seg.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (seg.fd < 0)
+        throw_errno("Error creating log segment '" + path + "'");
+
+    if (::ftruncate(seg.fd, off_t(seg.size)) != 0) {
+        ::close(seg.fd);
+        throw_errno("Error sizing log segment '" + path + "'");
+    }
+
+    void* p = ::mmap(nullptr, seg.size, PROT_READ | PROT_WRITE, MAP_SHARED, seg.fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(seg.fd);
+        throw_errno("Error mapping log segment '" + path + "'");
+    }
+    seg.base = static_cast<char*>(p);
+
+    segs_.push_back(seg);
+    return segs_.back();
+}
+
+log_persistence::segment log_persistence::map_segment(uint32_t id)
+{
+    segment seg;
+    seg.id = id;
+
+    auto path = segment_path(id);
+    seg.fd = ::open(path.c_str(), O_RDWR);
+    if (seg.fd < 0)
+        throw_errno("Error opening log segment '" + path + "'");
+
+    struct stat st;
+    if (::fstat(seg.fd, &st) != 0 || st.st_size <= 0) {
+        ::close(seg.fd);
+        throw_errno("Error reading log segment '" + path + "'");
+    }
+    seg.size = size_t(st.st_size);
+
+    void* p = ::mmap(nullptr, seg.size, PROT_READ | PROT_WRITE, MAP_SHARED, seg.fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(seg.fd);
+        throw_errno("Error mapping log segment '" + path + "'");
+    }
+    seg.base = static_cast<char*>(p);
+    return seg;
+}
+
+void log_persistence::close_segment(segment& seg)
+{
+    if (seg.base) {
+        ::munmap(seg.base, seg.size);
+        seg.base = nullptr;
+    }
+    if (seg.fd >= 0) {
+        ::close(seg.fd);
+        seg.fd = -1;
+    }
+}
+
+void log_persistence::close_all()
+{
+    for (auto& seg : segs_) close_segment(seg);
+    segs_.clear();
+    index_.clear();
+    liveBytes_ = usedBytes_ = 0;
+}
+
+// --------------------------------------------------------------------------
+// Records
+
+void log_persistence::scan_segment(segment& seg)
+{
+    size_t off = 0;
+
+    while (off + HDR_SIZE <= seg.size) {
+        rec_header hdr;
+        std::memcpy(&hdr, seg.base + off, HDR_SIZE);
+        if (hdr.magic != REC_MAGIC)
+            break;
+
+        size_t recSize = align8(HDR_SIZE + size_t(hdr.keyLen) + size_t(hdr.valLen));
+        if (recSize > seg.size - off)
+            break;
+
+        string key{seg.base + off + HDR_SIZE, hdr.keyLen};
+
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            release(it->second);
+            index_.erase(it);
+        }
+
+        if ((hdr.flags & REC_TOMBSTONE) == 0) {
+            location loc{seg.id, off, recSize, off + HDR_SIZE + hdr.keyLen, hdr.valLen};
+            index_.emplace(std::move(key), loc);
+            seg.live += recSize;
+            liveBytes_ += recSize;
+        }
+        off += recSize;
+    }
+
+    seg.used = seg.synced = off;
+    usedBytes_ += off;
+}
+
+void log_persistence::recover()
+{
+    std::vector<uint32_t> ids;
+
+    for (const auto& entry : fs::directory_iterator(dir_)) {
+        auto name = entry.path().filename().string();
+        unsigned id;
+        char c;
+        if (name.size() == 12 && std::sscanf(name.c_str(), "%8x.lo%c", &id, &c) == 2 &&
+            c == 'g')
+            ids.push_back(uint32_t(id));
+    }
+    std::sort(ids.begin(), ids.end());
+
+    for (auto id : ids) {
+        segs_.push_back(map_segment(id));
+        scan_segment(segs_.back());
+    }
+    trim();
+}
+
+log_persistence::location log_persistence::append(
+    const string& key, const std::vector<string_view>& bufs, bool tombstone
+)
+{
+    size_t valLen = 0;
+    for (const auto& buf : bufs) valLen += buf.size();
+
+    size_t recSize = align8(HDR_SIZE + key.size() + valLen);
+
+    if (segs_.empty() || segs_.back().size - segs_.back().used < recSize)
+        add_segment(recSize);
+
+    auto& seg = segs_.back();
+    size_t off = seg.used;
+    char* p = seg.base + off;
+
+    std::memcpy(p + HDR_SIZE, key.data(), key.size());
+    char* v = p + HDR_SIZE + key.size();
+    for (const auto& buf : bufs) {
+        std::memcpy(v, buf.data(), buf.size());
+        v += buf.size();
+    }
+
+    rec_header hdr{0, uint32_t(key.size()), uint32_t(valLen), tombstone ? REC_TOMBSTONE : 0};
+    std::memcpy(p, &hdr, HDR_SIZE);
+    std::atomic_signal_fence(std::memory_order_release);
+    hdr.magic = REC_MAGIC;
+    std::memcpy(p, &hdr.magic, sizeof(hdr.magic));
+
+    seg.used += recSize;
+    usedBytes_ += recSize;
+
+    if (syncWrites_) {
+        sync_range(seg.base, off, recSize);
+        seg.synced = seg.used;
+    }
+
+    return location{seg.id, off, recSize, off + HDR_SIZE + key.size(), valLen};
+}
+
+string_view log_persistence::find_value(const string& key) const
+{
+    auto it = index_.find(key);
+    if (it == index_.end())
+        throw persistence_exception();
+
+    const auto& loc = it->second;
+    auto segIt = std::lower_bound(
+        segs_.begin(), segs_.end(), loc.segId,
+        [](const segment& seg, uint32_t id) { return seg.id < id; }
+    );
+    return string_view{segIt->base + loc.valOffset, loc.valLen};
+}
+
+void log_persistence::release(const location& loc)
+{
+    get_segment(loc.segId).live -= loc.recSize;
+    liveBytes_ -= loc.recSize;
+}
+
+// Segments are only ever removed from the front of the log, so that a
+// tombstone is never lost while the data it deletes is still on disk.
+
+void log_persistence::trim()
+{
+    while (segs_.size() > 1 && segs_.front().live == 0) {
+        auto& seg = segs_.front();
+        usedBytes_ -= seg.used;
+        close_segment(seg);
+        fs::remove(segment_path(seg.id));
+        segs_.pop_front();
+    }
+}
+
+// Live records are copied into fresh segments, after all the existing
+// ones, so a crash part way through only leaves duplicates, and the newer
+// copies win when the log is scanned.
+
+void log_persistence::do_compact()
+{
+    if (segs_.empty())
+        return;
+
+    uint32_t lastOld = segs_.back().id;
+    add_segment(segSize_);
+
+    for (auto& [key, loc] : index_) {
+        if (loc.segId > lastOld)
+            continue;
+
+        auto& old = get_segment(loc.segId);
+        string_view val{old.base + loc.valOffset, loc.valLen};
+
+        auto newLoc = append(key, {val}, false);
+        release(loc);
+        loc = newLoc;
+        get_segment(loc.segId).live += loc.recSize;
+        liveBytes_ += loc.recSize;
+    }
+    trim();
+}
+
+// --------------------------------------------------------------------------
+// Public API
+
+void log_persistence::compact()
+{
+    guard g{lock_};
+    do_compact();
+}
+
+void log_persistence::open(const string& clientId, const string& serverURI)
+{
+    guard g{lock_};
+    close_all();
+
+    try {
+        dir_ = baseDir_ + "/" + store_name(clientId, serverURI);
+        fs::create_directories(dir_);
+        recover();
+    }
+    catch (const fs::filesystem_error& exc) {
+        close_all();
+        dir_.clear();
+        throw persistence_exception(exc.what());
+    }
+    catch (...) {
+        close_all();
+        dir_.clear();
+        throw;
+    }
+}
+
+void log_persistence::close()
+{
+    guard g{lock_};
+    close_all();
+    dir_.clear();
+}
+
+void log_persistence::clear()
+{
+    guard g{lock_};
+
+    std::vector<uint32_t> ids;
+    for (const auto& seg : segs_) ids.push_back(seg.id);
+
+    close_all();
+    for (auto id : ids) fs::remove(segment_path(id));
+}
+
+bool log_persistence::contains_key(const string& key)
+{
+    guard g{lock_};
+    return index_.find(key) != index_.end();
+}
+
+string_collection log_persistence::keys() const
+{
+    guard g{lock_};
+
+    string_collection ks;
+    for (const auto& entry : index_) ks.push_back(entry.first);
+    return ks;
+}
+
+void log_persistence::for_each_key(const key_handler& fn) const
+{
+    guard g{lock_};
+    for (const auto& entry : index_) fn(entry.first);
+}
+
+void log_persistence::put(const string& key, const std::vector<string_view>& bufs)
+{
+    guard g{lock_};
+
+    if (dir_.empty())
+        throw persistence_exception("Log persistence store is not open");
+
+    auto loc = append(key, bufs, false);
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        release(it->second);
+        it->second = loc;
+    }
+    else {
+        index_.emplace(key, loc);
+    }
+
+    get_segment(loc.segId).live += loc.recSize;
+    liveBytes_ += loc.recSize;
+    trim();
+}
+
+string log_persistence::get(const string& key) const
+{
+    guard g{lock_};
+    auto val = find_value(key);
+    return string{val.data(), val.size()};
+}
+
+char* log_persistence::get_into(const string& key, size_t* len) const
+{
+    guard g{lock_};
+    auto val = find_value(key);
+
+    char* buf = static_cast<char*>(persistence_malloc(val.size()));
+    if (!buf && val.size() > 0)
+        throw std::bad_alloc();
+
+    std::memcpy(buf, val.data(), val.size());
+    if (len)
+        *len = val.size();
+    return buf;
+}
+
+// The values are found under the lock, which is held while they're copied
+// out, so that the segments stay mapped. The copies are split across
+// threads by the amount of data, not the number of keys.
+
+auto log_persistence::get_all(const std::vector<string>& keys) const
+    -> std::vector<restored_value>
+{
+    guard g{lock_};
+
+    const size_t n = keys.size();
+    std::vector<string_view> views(n, string_view{nullptr, 0});
+    std::vector<restored_value> vals(n);
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (index_.count(keys[i]) != 0) {
+            views[i] = find_value(keys[i]);
+            total += views[i].size();
+        }
+    }
+
+    auto copy = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            if (!views[i].data())
+                continue;
+            auto sz = views[i].size();
+            char* buf = static_cast<char*>(persistence_malloc(sz == 0 ? 1 : sz));
+            if (!buf)
+                continue;
+            std::memcpy(buf, views[i].data(), sz);
+            vals[i] = restored_value{buf, sz};
+        }
+    };
+
+    size_t nthr = std::min<size_t>(
+        std::max(1u, std::thread::hardware_concurrency()), MAX_RESTORE_THREADS
+    );
+    nthr = std::min(nthr, total / PARALLEL_RESTORE_SIZE + 1);
+
+    if (nthr <= 1) {
+        copy(0, n);
+        return vals;
+    }
+
+    std::vector<std::thread> thrs;
+    size_t first = 0, acc = 0;
+    for (size_t i = 0; i < n && thrs.size() + 1 < nthr; ++i) {
+        acc += views[i].size();
+        if (acc >= total / nthr) {
+            thrs.emplace_back(copy, first, i + 1);
+            first = i + 1;
+            acc = 0;
+        }
+    }
+    copy(first, n);
+
+    for (auto& thr : thrs) thr.join();
+    return vals;
+}
+
+void log_persistence::remove(const string& key)
+{
+    guard g{lock_};
+
+    auto it = index_.find(key);
+    if (it == index_.end())
+        throw persistence_exception();
+
+    append(key, {}, true);
+    release(it->second);
+    index_.erase(it);
+
+    trim();
+    if (segs_.size() > 2 && usedBytes_ - liveBytes_ > liveBytes_ + 2 * segSize_)
+        do_compact();
+}
+
+void log_persistence::sync()
+{
+    guard g{lock_};
+
+    for (auto& seg : segs_) {
+        if (seg.synced < seg.used) {
+            sync_range(seg.base, seg.synced, seg.used - seg.synced);
+            seg.synced = seg.used;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,740 @@
+// loopback_client.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/loopback_client.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mqtt/exception.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//                            loopback_broker
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<const_message_ptr> loopback_broker::subscribe(
+    loopback_client* cli, const string& filter, int qos, const subscribe_options& opts
+)
+{
+    subscriber sub{cli, qos, opts.get_no_local(), opts.get_retain_as_published()};
+    bool isNew = true;
+
+    guard g{lock_};
+
+    auto it = subs_.find(filter);
+    if (it != subs_.end()) {
+        auto& lst = it->second;
+        auto p = std::find_if(lst.begin(), lst.end(), [cli](const subscriber& s) {
+            return s.cli == cli;
+        });
+        if (p != lst.end()) {
+            *p = sub;
+            isNew = false;
+        }
+        else {
+            lst.push_back(sub);
+        }
+    }
+    else {
+        subs_.insert({filter, subscriber_list{sub}});
+    }
+
+    std::vector<const_message_ptr> msgs;
+    auto handling = opts.get_retain_handling();
+
+    if (handling == subscribe_options::SEND_RETAINED_ON_SUBSCRIBE ||
+        (handling == subscribe_options::SEND_RETAINED_ON_NEW && isNew)) {
+        for (auto& msg : retained_.snapshot(filter)) {
+            if (msg->get_qos() > qos) {
+                auto m = std::make_shared<message>(*msg);
+                m->set_qos(qos);
+                msgs.push_back(std::move(m));
+            }
+            else {
+                msgs.push_back(std::move(msg));
+            }
+        }
+    }
+    return msgs;
+}
+
+bool loopback_broker::unsubscribe(loopback_client* cli, const string& filter)
+{
+    guard g{lock_};
+
+    // The matcher's iterators only compare for inequality
+    auto it = subs_.find(filter);
+    if (!(it != subs_.end()))
+        return false;
+
+    auto& lst = it->second;
+    auto p = std::find_if(lst.begin(), lst.end(), [cli](const subscriber& s) {
+        return s.cli == cli;
+    });
+    if (p == lst.end())
+        return false;
+
+    lst.erase(p);
+    if (lst.empty()) {
+        subs_.remove(filter);
+        subs_.prune();
+    }
+    return true;
+}
+
+void loopback_broker::remove(loopback_client* cli)
+{
+    guard g{lock_};
+
+    std::vector<string> emptyFilters;
+    for (auto it = subs_.begin(); it != subs_.end(); ++it) {
+        auto& lst = it->second;
+        lst.erase(
+            std::remove_if(
+                lst.begin(), lst.end(), [cli](const subscriber& s) { return s.cli == cli; }
+            ),
+            lst.end()
+        );
+        if (lst.empty())
+            emptyFilters.push_back(it->first);
+    }
+
+    if (!emptyFilters.empty()) {
+        for (const auto& filter : emptyFilters) subs_.remove(filter);
+        subs_.prune();
+    }
+}
+
+// The messages are queued to the clients under the lock, so a client
+// can't go away in the middle of it. That's cheap, since queuing is just
+// a move into the client's job queue.
+
+void loopback_broker::route(loopback_client* from, const const_message_ptr& msg)
+{
+    guard g{lock_};
+
+    if (msg->is_retained())
+        retained_.update(msg);
+
+    // Each client gets the message once, at its highest matching QoS
+    std::vector<subscriber> targets;
+
+    for (auto it = subs_.matches(msg->get_topic()); it != subs_.matches_cend(); ++it) {
+        for (const auto& sub : it->second) {
+            if (sub.noLocal && sub.cli == from)
+                continue;
+
+            auto p = std::find_if(targets.begin(), targets.end(), [&sub](const subscriber& s) {
+                return s.cli == sub.cli;
+            });
+            if (p == targets.end()) {
+                targets.push_back(sub);
+            }
+            else {
+                p->qos = std::max(p->qos, sub.qos);
+                p->retainAsPublished = p->retainAsPublished || sub.retainAsPublished;
+            }
+        }
+    }
+
+    for (const auto& sub : targets) {
+        int qos = std::min(msg->get_qos(), sub.qos);
+        bool retained = msg->is_retained() && sub.retainAsPublished;
+
+        if (qos == msg->get_qos() && retained == msg->is_retained()) {
+            sub.cli->deliver(msg);
+        }
+        else {
+            auto m = std::make_shared<message>(*msg);
+            m->set_qos(qos);
+            m->set_retained(retained);
+            sub.cli->deliver(std::move(m));
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//                            loopback_client
+/////////////////////////////////////////////////////////////////////////////
+
+loopback_client::loopback_client(loopback_broker_ptr broker, const string& clientId)
+    : broker_{std::move(broker)}, clientId_{clientId}
+{
+    if (!broker_)
+        throw std::invalid_argument("A loopback broker is required");
+
+    thr_ = std::thread(&loopback_client::run, this);
+}
+
+loopback_client::~loopback_client()
+{
+    connected_ = false;
+    broker_->remove(this);
+
+    // The empty job tells the thread to quit, after the ones before it
+    jobs_.put(job{});
+    thr_.join();
+}
+
+void loopback_client::run()
+{
+    while (true) {
+        auto fn = jobs_.get();
+        if (!fn)
+            break;
+
+        try {
+            fn();
+        }
+        catch (...) {
+            // Like the C library, an exception from a user callback
+            // doesn't stop the client thread.
+        }
+    }
+}
+
+void loopback_client::check_connected() const
+{
+    if (!connected_)
+        throw exception(MQTTASYNC_DISCONNECTED);
+}
+
+void loopback_client::deliver(const_message_ptr msg)
+{
+    post([this, msg = std::move(msg)] {
+        callback* cb;
+        message_handler handler;
+        {
+            guard g{lock_};
+            cb = userCallback_;
+            handler = msgHandler_;
+            if (que_)
+                que_->try_put(event{msg});
+        }
+
+        if (handler)
+            handler(msg);
+        else if (cb)
+            cb->message_arrived(msg);
+    });
+}
+
+// The tokens are completed through the same v5 success path that the C
+// library uses, with a response made to look like the server's.
+
+void loopback_client::succeed(token_ptr tok, int msgId, std::vector<int> codes /*={}*/)
+{
+    MQTTAsync_successData5 rsp{};
+    rsp.token = MQTTAsync_token(msgId);
+
+    std::vector<MQTTReasonCodes> reasonCodes;
+    for (auto code : codes) reasonCodes.push_back(MQTTReasonCodes(code));
+
+    if (!reasonCodes.empty())
+        rsp.reasonCode = reasonCodes.front();
+
+    switch (tok->get_type()) {
+        case token::Type::CONNECT:
+            rsp.alt.connect.serverURI = const_cast<char*>(loopback_broker::SERVER_URI);
+            rsp.alt.connect.MQTTVersion = MQTTVERSION_5;
+            rsp.alt.connect.sessionPresent = 0;
+            break;
+
+        case token::Type::SUBSCRIBE:
+            rsp.alt.sub.reasonCodeCount = int(reasonCodes.size());
+            rsp.alt.sub.reasonCodes = reasonCodes.data();
+            break;
+
+        case token::Type::UNSUBSCRIBE:
+            rsp.alt.unsub.reasonCodeCount = int(reasonCodes.size());
+            rsp.alt.unsub.reasonCodes = reasonCodes.data();
+            break;
+
+        default:
+            break;
+    }
+
+    token::on_success5(tok.get(), &rsp);
+}
+
+int loopback_client::next_message_id()
+{
+    // Packet IDs are 1-65535, skipping any still in use
+    do {
+        if (++lastMsgId_ > 65535)
+            lastMsgId_ = 1;
+    } while (pendingTokens_.count(lastMsgId_) != 0);
+    return lastMsgId_;
+}
+
+void loopback_client::remove_token(token* tok)
+{
+    if (!tok || tok->get_type() != token::Type::PUBLISH)
+        return;
+
+    guard g{lock_};
+    auto it = pendingTokens_.find(int(tok->get_message_id()));
+    if (it != pendingTokens_.end() && it->second.get() == tok)
+        pendingTokens_.erase(it);
+}
+
+// --------------------------------------------------------------------------
+// Connect
+
+token_ptr loopback_client::connect_token(token_ptr tok)
+{
+    connected_ = true;
+
+    post([this, tok] {
+        succeed(tok, 0);
+
+        callback* cb;
+        {
+            guard g{lock_};
+            cb = userCallback_;
+            if (que_)
+                que_->try_put(event{connected_event{string{}}});
+        }
+        if (cb)
+            cb->connected(string{});
+    });
+    return tok;
+}
+
+token_ptr loopback_client::connect() { return connect(connect_options{}); }
+
+token_ptr loopback_client::connect(connect_options /*options*/)
+{
+    return connect_token(token::create(token::Type::CONNECT, *this));
+}
+
+token_ptr loopback_client::connect(
+    connect_options /*options*/, void* userContext, iaction_listener& cb
+)
+{
+    return connect_token(token::create(token::Type::CONNECT, *this, userContext, cb));
+}
+
+token_ptr loopback_client::connect(void* userContext, iaction_listener& cb)
+{
+    return connect(connect_options{}, userContext, cb);
+}
+
+// --------------------------------------------------------------------------
+// Disconnect
+
+token_ptr loopback_client::disconnect_token(token_ptr tok)
+{
+    check_connected();
+
+    connected_ = false;
+    broker_->remove(this);
+
+    post([tok] { succeed(tok, 0); });
+    return tok;
+}
+
+token_ptr loopback_client::disconnect()
+{
+    return disconnect_token(token::create(token::Type::DISCONNECT, *this));
+}
+
+token_ptr loopback_client::disconnect(disconnect_options /*opts*/) { return disconnect(); }
+
+token_ptr loopback_client::disconnect(int /*timeout*/) { return disconnect(); }
+
+token_ptr loopback_client::disconnect(int /*timeout*/, void* userContext, iaction_listener& cb)
+{
+    return disconnect_token(token::create(token::Type::DISCONNECT, *this, userContext, cb));
+}
+
+token_ptr loopback_client::disconnect(void* userContext, iaction_listener& cb)
+{
+    return disconnect(0, userContext, cb);
+}
+
+// --------------------------------------------------------------------------
+// Queries
+
+delivery_token_ptr loopback_client::get_pending_delivery_token(int msgID) const
+{
+    guard g{lock_};
+    auto it = pendingTokens_.find(msgID);
+    return (it == pendingTokens_.end()) ? delivery_token_ptr{} : it->second;
+}
+
+std::vector<delivery_token_ptr> loopback_client::get_pending_delivery_tokens() const
+{
+    std::vector<delivery_token_ptr> toks;
+    guard g{lock_};
+    for (const auto& p : pendingTokens_) toks.push_back(p.second);
+    return toks;
+}
+
+// --------------------------------------------------------------------------
+// Publish
+
+delivery_token_ptr loopback_client::publish(
+    string_ref topic, const void* payload, size_t n, int qos, bool retained,
+    const properties& props /*=properties()*/
+)
+{
+    return publish(message::create(std::move(topic), payload, n, qos, retained, props));
+}
+
+delivery_token_ptr loopback_client::publish(string_ref topic, const void* payload, size_t n)
+{
+    return publish(message::create(std::move(topic), payload, n));
+}
+
+delivery_token_ptr loopback_client::publish(
+    string_ref topic, const void* payload, size_t n, int qos, bool retained,
+    void* userContext, iaction_listener& cb
+)
+{
+    auto msg = message::create(std::move(topic), payload, n, qos, retained);
+    return publish(std::move(msg), userContext, cb);
+}
+
+delivery_token_ptr loopback_client::publish(
+    string_ref topic, binary_ref payload, int qos, bool retained,
+    const properties& props /*=properties()*/
+)
+{
+    return publish(message::create(std::move(topic), std::move(payload), qos, retained, props));
+}
+
+delivery_token_ptr loopback_client::publish(string_ref topic, binary_ref payload)
+{
+    return publish(message::create(std::move(topic), std::move(payload)));
+}
+
+delivery_token_ptr loopback_client::publish(const_message_ptr msg)
+{
+    check_connected();
+    return publish_token(delivery_token::create(*this, std::move(msg)));
+}
+
+delivery_token_ptr loopback_client::publish(
+    const_message_ptr msg, void* userContext, iaction_listener& cb
+)
+{
+    check_connected();
+    return publish_token(delivery_token::create(*this, std::move(msg), userContext, cb));
+}
+
+delivery_token_ptr loopback_client::publish_token(delivery_token_ptr tok)
+{
+    auto msg = tok->get_message();
+    if (!msg)
+        throw std::invalid_argument("A message is required");
+
+    int msgId = 0;
+    if (msg->get_qos() > 0) {
+        guard g{lock_};
+        msgId = next_message_id();
+        pendingTokens_[msgId] = tok;
+    }
+
+    broker_->route(this, msg);
+
+    post([this, tok, msgId] {
+        succeed(tok, msgId);
+
+        callback* cb;
+        {
+            guard g{lock_};
+            cb = userCallback_;
+        }
+        if (cb)
+            cb->delivery_complete(tok);
+    });
+    return tok;
+}
+
+// --------------------------------------------------------------------------
+// Callbacks
+
+void loopback_client::set_callback(callback& cb)
+{
+    guard g{lock_};
+    userCallback_ = &cb;
+}
+
+void loopback_client::disable_callbacks()
+{
+    guard g{lock_};
+    userCallback_ = nullptr;
+    msgHandler_ = message_handler{};
+}
+
+void loopback_client::set_message_callback(message_handler cb)
+{
+    guard g{lock_};
+    msgHandler_ = std::move(cb);
+}
+
+// --------------------------------------------------------------------------
+// Subscribe
+
+token_ptr loopback_client::subscribe_token(
+    token_ptr tok, const std::vector<string>& filters, const qos_collection& qos,
+    const std::vector<subscribe_options>& opts
+)
+{
+    check_connected();
+
+    if (filters.size() != qos.size())
+        throw std::invalid_argument("Collection sizes don't match");
+
+    if (!opts.empty() && opts.size() != filters.size())
+        throw std::invalid_argument("Collection sizes don't match");
+
+    std::vector<int> granted;
+    std::vector<const_message_ptr> retained;
+
+    for (size_t i = 0; i < filters.size(); ++i) {
+        auto sopts = opts.empty() ? subscribe_options{} : opts[i];
+        for (auto& msg : broker_->subscribe(this, filters[i], qos[i], sopts))
+            retained.push_back(std::move(msg));
+        granted.push_back(qos[i]);
+    }
+
+    // The acknowledgment goes out ahead of the retained messages
+    post([tok, granted = std::move(granted)] { succeed(tok, 0, granted); });
+
+    for (auto& msg : retained) deliver(std::move(msg));
+    return tok;
+}
+
+token_ptr loopback_client::subscribe(
+    const string& topicFilter, int qos,
+    const subscribe_options& opts /*=subscribe_options()*/,
+    const properties& /*props=properties()*/
+)
+{
+    return subscribe_token(
+        token::create(token::Type::SUBSCRIBE, *this, topicFilter), {topicFilter}, {qos},
+        {opts}
+    );
+}
+
+token_ptr loopback_client::subscribe(
+    const string& topicFilter, int qos, void* userContext, iaction_listener& cb,
+    const subscribe_options& opts /*=subscribe_options()*/,
+    const properties& /*props=properties()*/
+)
+{
+    return subscribe_token(
+        token::create(token::Type::SUBSCRIBE, *this, topicFilter, userContext, cb),
+        {topicFilter}, {qos}, {opts}
+    );
+}
+
+token_ptr loopback_client::subscribe(
+    const_string_collection_ptr topicFilters, const qos_collection& qos,
+    const std::vector<subscribe_options>& opts /*=std::vector<subscribe_options>()*/,
+    const properties& /*props=properties()*/
+)
+{
+    std::vector<string> filters{topicFilters->begin(), topicFilters->end()};
+    return subscribe_token(
+        token::create(token::Type::SUBSCRIBE, *this, topicFilters), filters, qos, opts
+    );
+}
+
+token_ptr loopback_client::subscribe(
+    const_string_collection_ptr topicFilters, const qos_collection& qos, void* userContext,
+    iaction_listener& cb,
+    const std::vector<subscribe_options>& opts /*=std::vector<subscribe_options>()*/,
+    const properties& /*props=properties()*/
+)
+{
+    std::vector<string> filters{topicFilters->begin(), topicFilters->end()};
+    return subscribe_token(
+        token::create(token::Type::SUBSCRIBE, *this, topicFilters, userContext, cb),
+        filters, qos, opts
+    );
+}
+
+// --------------------------------------------------------------------------
+// Unsubscribe
+
+token_ptr loopback_client::unsubscribe_token(token_ptr tok, const std::vector<string>& filters)
+{
+    check_connected();
+
+    std::vector<int> codes;
+    for (const auto& filter : filters) {
+        codes.push_back(
+            broker_->unsubscribe(this, filter) ? int(ReasonCode::SUCCESS)
+                                               : int(ReasonCode::NO_SUBSCRIPTION_FOUND)
+        );
+    }
+
+    post([tok, codes = std::move(codes)] { succeed(tok, 0, codes); });
+    return tok;
+}
+
+token_ptr loopback_client::unsubscribe(
+    const string& topicFilter, const properties& /*props=properties()*/
+)
+{
+    return unsubscribe_token(
+        token::create(token::Type::UNSUBSCRIBE, *this, topicFilter), {topicFilter}
+    );
+}
+
+token_ptr loopback_client::unsubscribe(
+    const_string_collection_ptr topicFilters, const properties& /*props=properties()*/
+)
+{
+    std::vector<string> filters{topicFilters->begin(), topicFilters->end()};
+    return unsubscribe_token(
+        token::create(token::Type::UNSUBSCRIBE, *this, topicFilters), filters
+    );
+}
+
+token_ptr loopback_client::unsubscribe(
+    const_string_collection_ptr topicFilters, void* userContext, iaction_listener& cb,
+    const properties& /*props=properties()*/
+)
+{
+    std::vector<string> filters{topicFilters->begin(), topicFilters->end()};
+    return unsubscribe_token(
+        token::create(token::Type::UNSUBSCRIBE, *this, topicFilters, userContext, cb),
+        filters
+    );
+}
+
+token_ptr loopback_client::unsubscribe(
+    const string& topicFilter, void* userContext, iaction_listener& cb,
+    const properties& /*props=properties()*/
+)
+{
+    return unsubscribe_token(
+        token::create(token::Type::UNSUBSCRIBE, *this, topicFilter, userContext, cb),
+        {topicFilter}
+    );
+}
+
+// --------------------------------------------------------------------------
+// Consumer
+
+void loopback_client::start_consuming()
+{
+    guard g{lock_};
+    que_ = std::make_unique<thread_queue<event>>();
+}
+
+void loopback_client::stop_consuming()
+{
+    guard g{lock_};
+    if (que_)
+        que_->close();
+}
+
+void loopback_client::clear_consumer()
+{
+    guard g{lock_};
+    if (que_)
+        que_->clear();
+}
+
+bool loopback_client::consumer_closed() noexcept
+{
+    guard g{lock_};
+    return !que_ || que_->closed();
+}
+
+bool loopback_client::consumer_done() noexcept
+{
+    guard g{lock_};
+    return !que_ || que_->done();
+}
+
+std::size_t loopback_client::consumer_queue_size() const
+{
+    guard g{lock_};
+    return (que_) ? que_->size() : 0;
+}
+
+thread_queue<event>* loopback_client::consumer_queue() const
+{
+    guard g{lock_};
+    if (!que_)
+        throw exception(-1, "Consumer not started");
+    return que_.get();
+}
+
+event loopback_client::consume_event()
+{
+    auto que = consumer_queue();
+    try {
+        return que->get();
+    }
+    catch (queue_closed&) {
+        return event{shutdown_event{}};
+    }
+}
+
+bool loopback_client::try_consume_event(event* evt)
+{
+    return consumer_queue()->try_get(evt);
+}
+
+const_message_ptr loopback_client::consume_message()
+{
+    // As with the async_client, the 'connected' events are skipped,
+    // and a disconnect returns an empty pointer.
+    while (true) {
+        auto evt = consume_event();
+
+        if (auto* pval = evt.get_message_if())
+            return std::move(*pval);
+
+        if (evt.is_any_disconnect())
+            return const_message_ptr{};
+    }
+}
+
+bool loopback_client::try_consume_message(const_message_ptr* msg)
+{
+    event evt;
+
+    while (true) {
+        if (!try_consume_event(&evt))
+            return false;
+
+        if (auto* pval = evt.get_message_if()) {
+            *msg = std::move(*pval);
+            break;
+        }
+
+        if (evt.is_any_disconnect()) {
+            *msg = const_message_ptr{};
+            break;
+        }
+    }
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
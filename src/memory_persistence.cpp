@@ -0,0 +1,313 @@
+// memory_persistence.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/memory_persistence.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "mqtt/exception.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							memory_persistence
+/////////////////////////////////////////////////////////////////////////////
+
+memory_persistence::memory_persistence(
+    size_t maxBytes /*=DFLT_MAX_BYTES*/, EvictPolicy policy /*=REJECT*/
+)
+    : maxBytes_{maxBytes}, policy_{policy}
+{
+    size_t sz = MIN_SLOT_SIZE;
+    for (auto& cls : classes_) {
+        cls.slotSize = sz;
+        sz *= 2;
+    }
+}
+
+memory_persistence::~memory_persistence() { clear(); }
+
+// --------------------------------------------------------------------------
+// Slabs
+
+size_t memory_persistence::class_of(size_t n)
+{
+    size_t cls = 0, sz = MIN_SLOT_SIZE;
+    while (cls < N_CLASSES && sz < n) {
+        ++cls;
+        sz *= 2;
+    }
+    return cls;
+}
+
+size_t memory_persistence::memory_needed(size_t cls, size_t n) const
+{
+    if (cls == N_CLASSES)
+        return n;
+    return classes_[cls].avail.empty() ? SLAB_SIZE : 0;
+}
+
+char* memory_persistence::alloc_slot(size_t cls, uint32_t* slabId)
+{
+    if (cls == N_CLASSES)
+        return nullptr;
+
+    auto& sc = classes_[cls];
+
+    if (sc.avail.empty()) {
+        auto id = sc.nextId++;
+        auto nSlots = uint32_t(SLAB_SIZE / sc.slotSize);
+
+        slab s;
+        s.mem.reset(new char[SLAB_SIZE]);
+        s.freeSlots.reserve(nSlots);
+        for (uint32_t i = nSlots; i > 0; --i) s.freeSlots.push_back(i - 1);
+
+        sc.slabs.emplace(id, std::move(s));
+        sc.avail.push_back(id);
+        memUsed_ += SLAB_SIZE;
+    }
+
+    auto id = sc.avail.back();
+    auto& s = sc.slabs[id];
+
+    auto idx = s.freeSlots.back();
+    s.freeSlots.pop_back();
+    if (s.freeSlots.empty())
+        sc.avail.pop_back();
+
+    *slabId = id;
+    return s.mem.get() + idx * sc.slotSize;
+}
+
+void memory_persistence::free_slot(size_t cls, uint32_t slabId, char* p)
+{
+    auto& sc = classes_[cls];
+    auto it = sc.slabs.find(slabId);
+    if (it == sc.slabs.end())
+        return;
+
+    auto& s = it->second;
+    bool wasFull = s.freeSlots.empty();
+    s.freeSlots.push_back(uint32_t((p - s.mem.get()) / sc.slotSize));
+
+    if (s.freeSlots.size() == SLAB_SIZE / sc.slotSize) {
+        if (!wasFull)
+            sc.avail.erase(std::find(sc.avail.begin(), sc.avail.end(), slabId));
+        sc.slabs.erase(it);
+        memUsed_ -= SLAB_SIZE;
+    }
+    else if (wasFull) {
+        sc.avail.push_back(slabId);
+    }
+}
+
+void memory_persistence::erase(std::unordered_map<string, entry>::iterator it)
+{
+    auto& ent = it->second;
+
+    if (ent.cls == N_CLASSES) {
+        delete[] ent.data;
+        memUsed_ -= ent.len;
+    }
+    else {
+        free_slot(ent.cls, ent.slabId, ent.data);
+    }
+
+    memUsed_ -= it->first.size() + ENTRY_OVERHEAD;
+    dataBytes_ -= ent.len;
+    ages_.erase(ent.age);
+    index_.erase(it);
+}
+
+// --------------------------------------------------------------------------
+// Public API
+
+void memory_persistence::open(const string&, const string&) {}
+
+void memory_persistence::clear()
+{
+    guard g{lock_};
+
+    for (auto& [key, ent] : index_) {
+        if (ent.cls == N_CLASSES)
+            delete[] ent.data;
+    }
+    index_.clear();
+    ages_.clear();
+
+    for (auto& sc : classes_) {
+        sc.slabs.clear();
+        sc.avail.clear();
+    }
+    memUsed_ = dataBytes_ = 0;
+}
+
+bool memory_persistence::contains_key(const string& key)
+{
+    guard g{lock_};
+    return index_.find(key) != index_.end();
+}
+
+string_collection memory_persistence::keys() const
+{
+    guard g{lock_};
+
+    string_collection ks;
+    for (const auto& key : ages_) ks.push_back(key);
+    return ks;
+}
+
+void memory_persistence::for_each_key(const key_handler& fn) const
+{
+    guard g{lock_};
+    for (const auto& key : ages_) fn(key);
+}
+
+// The new value is stored before the old one is released, so that a
+// rejected put leaves the store as it was.
+
+void memory_persistence::put(const string& key, const std::vector<string_view>& bufs)
+{
+    size_t n = 0;
+    for (const auto& buf : bufs) n += buf.size();
+
+    guard g{lock_};
+
+    auto it = index_.find(key);
+    auto cls = class_of(n);
+    auto keyMem = (it == index_.end()) ? (key.size() + ENTRY_OVERHEAD) : 0;
+
+    // Don't evict anything for data that could never fit
+    size_t maxNeeded = ((cls == N_CLASSES) ? n : SLAB_SIZE) + key.size() + ENTRY_OVERHEAD;
+    if (maxNeeded > maxBytes_) {
+        ++nRejected_;
+        throw persistence_exception("Memory persistence budget exceeded");
+    }
+
+    while (memUsed_ + memory_needed(cls, n) + keyMem > maxBytes_) {
+        auto victim = ages_.begin();
+        if (victim != ages_.end() && *victim == key)
+            ++victim;
+
+        if (policy_ != EVICT_OLDEST || victim == ages_.end()) {
+            ++nRejected_;
+            throw persistence_exception("Memory persistence budget exceeded");
+        }
+
+        erase(index_.find(*victim));
+        ++nEvicted_;
+    }
+
+    entry ent;
+    ent.len = n;
+    ent.cls = cls;
+    if (cls == N_CLASSES) {
+        ent.data = new char[n];
+        memUsed_ += n;
+    }
+    else {
+        ent.data = alloc_slot(cls, &ent.slabId);
+    }
+
+    char* p = ent.data;
+    for (const auto& buf : bufs) {
+        std::memcpy(p, buf.data(), buf.size());
+        p += buf.size();
+    }
+
+    // Look up again, as the old entry might have been evicted
+    it = index_.find(key);
+    if (it != index_.end())
+        erase(it);
+
+    ages_.push_back(key);
+    ent.age = std::prev(ages_.end());
+    index_.emplace(key, ent);
+
+    memUsed_ += key.size() + ENTRY_OVERHEAD;
+    dataBytes_ += n;
+}
+
+string memory_persistence::get(const string& key) const
+{
+    guard g{lock_};
+
+    auto it = index_.find(key);
+    if (it == index_.end())
+        throw persistence_exception();
+
+    return string{it->second.data, it->second.len};
+}
+
+char* memory_persistence::get_into(const string& key, size_t* len) const
+{
+    guard g{lock_};
+
+    auto it = index_.find(key);
+    if (it == index_.end())
+        throw persistence_exception();
+
+    const auto& ent = it->second;
+    char* buf = static_cast<char*>(persistence_malloc(ent.len));
+    if (!buf && ent.len > 0)
+        throw std::bad_alloc();
+
+    std::memcpy(buf, ent.data, ent.len);
+    if (len)
+        *len = ent.len;
+    return buf;
+}
+
+auto memory_persistence::get_all(const std::vector<string>& keys) const
+    -> std::vector<restored_value>
+{
+    guard g{lock_};
+
+    std::vector<restored_value> vals(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto it = index_.find(keys[i]);
+        if (it == index_.end())
+            continue;
+
+        const auto& ent = it->second;
+        char* buf = static_cast<char*>(persistence_malloc(ent.len == 0 ? 1 : ent.len));
+        if (!buf)
+            continue;
+
+        std::memcpy(buf, ent.data, ent.len);
+        vals[i] = restored_value{buf, ent.len};
+    }
+    return vals;
+}
+
+void memory_persistence::remove(const string& key)
+{
+    guard g{lock_};
+
+    auto it = index_.find(key);
+    if (it == index_.end())
+        throw persistence_exception();
+
+    erase(it);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -21,6 +21,8 @@
 #include <cstring>
 #include <utility>
 
+#include "mqtt/ack_tracker.h"
+
 namespace mqtt {
 
 /////////////////////////////////////////////////////////////////////////////
@@ -56,20 +58,74 @@ message::message(string_ref topic, const MQTTAsync_message& cmsg)
     msg_.properties = props_.c_struct();
 }
 
+message::message(string_ref topic, binary_ref payload, const MQTTAsync_message& cmsg)
+    : msg_(cmsg), topic_(std::move(topic)), props_(cmsg.properties)
+{
+    set_payload(std::move(payload));
+    msg_.properties = props_.c_struct();
+}
+
+// The payload and properties are left in the C message, which is kept
+// alive by the payload reference and the adopted properties. The C struct
+// still points at the C properties list, so the message can be sent on
+// as-is.
+
+message::message(string_ref topic, std::shared_ptr<const MQTTAsync_message> cmsg)
+    : msg_(*cmsg), topic_(std::move(topic))
+{
+    binary_ref payload;
+    if (cmsg->payloadlen > 0) {
+        payload = binary_ref{
+            binary_ref::external_pointer_type{cmsg, static_cast<const char*>(cmsg->payload)},
+            size_t(cmsg->payloadlen)
+        };
+    }
+    set_payload(std::move(payload));
+
+    if (cmsg->properties.count > 0) {
+        adoptedProps_ = std::make_shared<adopted_properties>();
+        adoptedProps_->cmsg = std::move(cmsg);
+    }
+    update_c_properties();
+}
+
 message::message(const message& other)
-    : msg_(other.msg_), topic_(other.topic_), props_(other.props_)
+    : msg_(other.msg_),
+      topic_(other.topic_),
+      props_(other.props_),
+      priority_(other.priority_),
+      conflate_(other.conflate_),
+      timestamp_(other.timestamp_),
+      expiryTime_(other.expiryTime_),
+      queueTime_(other.queueTime_),
+      dequeueTime_(other.dequeueTime_),
+      adoptedProps_(other.adoptedProps_)
 {
     set_payload(other.payload_);
-    msg_.properties = props_.c_struct();
+    decoded_ = other.decoded_;
+    parsed_ = std::atomic_load(&other.parsed_);
+    update_c_properties();
 }
 
 message::message(message&& other)
-    : msg_(other.msg_), topic_(std::move(other.topic_)), props_(std::move(other.props_))
+    : msg_(other.msg_),
+      topic_(std::move(other.topic_)),
+      props_(std::move(other.props_)),
+      priority_(other.priority_),
+      conflate_(other.conflate_),
+      timestamp_(other.timestamp_),
+      expiryTime_(other.expiryTime_),
+      queueTime_(other.queueTime_),
+      dequeueTime_(other.dequeueTime_),
+      adoptedProps_(std::move(other.adoptedProps_))
 {
     set_payload(std::move(other.payload_));
+    decoded_ = std::move(other.decoded_);
+    parsed_ = std::move(other.parsed_);
     other.msg_.payloadlen = 0;
     other.msg_.payload = nullptr;
-    msg_.properties = props_.c_struct();
+    other.update_c_properties();
+    update_c_properties();
 }
 
 message& message::operator=(const message& rhs)
@@ -78,7 +134,17 @@ message& message::operator=(const message& rhs)
         msg_ = rhs.msg_;
         topic_ = rhs.topic_;
         set_payload(rhs.payload_);
+        decoded_ = rhs.decoded_;
+        parsed_ = std::atomic_load(&rhs.parsed_);
         set_properties(rhs.props_);
+        adoptedProps_ = rhs.adoptedProps_;
+        update_c_properties();
+        priority_ = rhs.priority_;
+        conflate_ = rhs.conflate_;
+        timestamp_ = rhs.timestamp_;
+        expiryTime_ = rhs.expiryTime_;
+        queueTime_ = rhs.queueTime_;
+        dequeueTime_ = rhs.dequeueTime_;
     }
     return *this;
 }
@@ -89,16 +155,52 @@ message& message::operator=(message&& rhs)
         msg_ = rhs.msg_;
         topic_ = std::move(rhs.topic_);
         set_payload(std::move(rhs.payload_));
+        decoded_ = std::move(rhs.decoded_);
+        parsed_ = std::move(rhs.parsed_);
         set_properties(std::move(rhs.props_));
+        adoptedProps_ = std::move(rhs.adoptedProps_);
+        update_c_properties();
+        priority_ = rhs.priority_;
+        conflate_ = rhs.conflate_;
+        timestamp_ = rhs.timestamp_;
+        expiryTime_ = rhs.expiryTime_;
+        queueTime_ = rhs.queueTime_;
+        dequeueTime_ = rhs.dequeueTime_;
 
         rhs.msg_ = DFLT_C_STRUCT;
     }
     return *this;
 }
 
+std::size_t message::ack() const
+{
+    auto tracker = ackTracker_.lock();
+    return tracker ? tracker->ack(ackSeq_) : 0;
+}
+
+// The C struct always points at the properties in effect, whether they're
+// still in an adopted C message or not.
+
+uint32_t message::get_expiry_interval() const
+{
+    auto prop = MQTTProperties_getProperty(
+        const_cast<MQTTProperties*>(&msg_.properties),
+        MQTTPropertyCodes(property::MESSAGE_EXPIRY_INTERVAL)
+    );
+    return prop ? uint32_t(prop->value.integer4) : 0;
+}
+
+void message::update_expiry_time()
+{
+    uint32_t secs = (timestamp_ == time_point{}) ? 0 : get_expiry_interval();
+    expiryTime_ = (secs == 0) ? time_point::max() : timestamp_ + std::chrono::seconds(secs);
+}
+
 void message::clear_payload()
 {
     payload_.reset();
+    decoded_.reset();
+    parsed_.reset();
     msg_.payload = nullptr;
     msg_.payloadlen = 0;
 }
@@ -106,6 +208,8 @@ void message::clear_payload()
 void message::set_payload(binary_ref payload)
 {
     payload_ = std::move(payload);
+    decoded_.reset();
+    parsed_.reset();
 
     if (payload_.empty()) {
         msg_.payload = nullptr;
@@ -117,5 +221,38 @@ void message::set_payload(binary_ref payload)
     }
 }
 
+// The decoded payload is shared by all the copies of the message, so
+// whichever reads it first decodes it for all of them. A failed decode
+// throws, and leaves it to be tried again.
+
+void message::set_payload_codec(payload_codec_ptr codec)
+{
+    decoded_ = std::make_shared<decoded_payload>();
+    decoded_->codec = std::move(codec);
+    parsed_.reset();
+}
+
+const binary_ref& message::decode_payload() const
+{
+    auto& dec = *decoded_;
+    std::call_once(dec.once, [this, &dec] {
+        static const binary EMPTY_BIN;
+        dec.payload = binary_ref(dec.codec->decode(payload_ ? payload_.str() : EMPTY_BIN));
+        dec.done = true;
+    });
+    return dec.payload;
+}
+
+// Like the payload, the converted properties are shared by the copies of
+// the message. The C struct keeps pointing at the C list, which has the
+// same contents.
+
+const properties& message::convert_properties() const
+{
+    auto& adp = *adoptedProps_;
+    std::call_once(adp.once, [&adp] { adp.props = properties(adp.cmsg->properties); });
+    return adp.props;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 }  // namespace mqtt
@@ -0,0 +1,251 @@
+// message_batcher.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/message_batcher.h"
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace mqtt {
+
+namespace {
+
+// The length of each record is an MQTT variable byte integer: seven bits
+// to a byte, low bits first, with the top bit set on all but the last,
+// up to four bytes.
+
+constexpr std::size_t MAX_LEN_BYTES = 4;
+
+std::size_t len_size(std::size_t n)
+{
+    std::size_t k = 1;
+    while (n >= 0x80) {
+        n >>= 7;
+        ++k;
+    }
+    return k;
+}
+
+void put_len(binary& out, std::size_t n)
+{
+    if (n > message_batcher::MAX_RECORD_SIZE)
+        throw std::length_error("Record too large for a batch");
+
+    do {
+        char c = char(n & 0x7F);
+        n >>= 7;
+        if (n)
+            c |= char(0x80);
+        out.push_back(c);
+    } while (n);
+}
+
+bool get_len(const char* p, std::size_t sz, std::size_t& pos, std::size_t& n)
+{
+    n = 0;
+    for (std::size_t i = 0; i < MAX_LEN_BYTES && pos < sz; ++i) {
+        auto c = static_cast<unsigned char>(p[pos++]);
+        n |= std::size_t(c & 0x7F) << (7 * i);
+        if (!(c & 0x80))
+            return n <= sz - pos;
+    }
+    return false;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+message_batcher::~message_batcher()
+{
+    {
+        guard g{lock_};
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thr_.joinable())
+        thr_.join();
+
+    flush_quietly();
+}
+
+// The flush thread wakes when the oldest record in the batch has waited
+// for the delay. A full batch is sent by the thread that filled it.
+
+void message_batcher::run()
+{
+    unique_guard g{lock_};
+
+    while (!stop_) {
+        if (nRecords_ == 0) {
+            cond_.wait(g, [this] { return stop_ || nRecords_ != 0; });
+        }
+        else {
+            auto oldest = oldest_;
+            cond_.wait_until(g, oldest + delay_, [this, oldest] {
+                return stop_ || nRecords_ == 0 || oldest_ != oldest;
+            });
+        }
+
+        if (stop_ || nRecords_ == 0)
+            continue;
+
+        if (clock::now() >= oldest_ + delay_) {
+            g.unlock();
+            flush_quietly();
+            g.lock();
+        }
+    }
+}
+
+void message_batcher::flush_quietly() noexcept
+{
+    try {
+        flush();
+    }
+    catch (...) {
+        guard g{lock_};
+        ++nFailed_;
+    }
+}
+
+void message_batcher::add(binary_view rec)
+{
+    if (rec.size() > MAX_RECORD_SIZE)
+        throw std::length_error("Record too large for a batch");
+
+    auto n = len_size(rec.size()) + rec.size();
+
+    bool full;
+    {
+        guard g{lock_};
+        full = nRecords_ != 0 && buf_.size() + n > maxBytes_;
+    }
+    if (full)
+        flush();
+
+    bool notify = false;
+    {
+        guard g{lock_};
+        if (nRecords_ == 0) {
+            oldest_ = clock::now();
+            notify = true;
+        }
+        put_len(buf_, rec.size());
+        buf_.append(rec.data(), rec.size());
+        ++nRecords_;
+        full = buf_.size() >= maxBytes_;
+    }
+
+    if (full)
+        flush();
+    else if (notify)
+        cond_.notify_one();
+}
+
+delivery_token_ptr message_batcher::flush()
+{
+    guard fg{flushLock_};
+
+    binary buf;
+    std::size_t n;
+    {
+        guard g{lock_};
+        if (nRecords_ == 0)
+            return delivery_token_ptr{};
+        buf.reserve(maxBytes_);
+        buf.swap(buf_);
+        n = nRecords_;
+        nRecords_ = 0;
+    }
+    cond_.notify_one();
+
+    properties props{{property::USER_PROPERTY, BATCH_PROPERTY, std::to_string(n)}};
+    auto msg = message::create(topic_, binary_ref(std::move(buf)), qos_, false, props);
+    auto tok = cli_.publish(std::move(msg));
+
+    guard g{lock_};
+    ++nBatches_;
+    return tok;
+}
+
+binary message_batcher::pack(const std::vector<binary_view>& recs)
+{
+    std::size_t n = 0;
+    for (const auto& rec : recs) n += len_size(rec.size()) + rec.size();
+
+    binary buf;
+    buf.reserve(n);
+    for (const auto& rec : recs) {
+        put_len(buf, rec.size());
+        buf.append(rec.data(), rec.size());
+    }
+    return buf;
+}
+
+std::size_t message_batcher::batch_count(const properties& props)
+{
+    for (const auto& prop : props) {
+        auto kv = try_get<string_view_pair>(prop);
+        if (kv && kv->first == BATCH_PROPERTY)
+            return std::strtoull(string{kv->second}.c_str(), nullptr, 10);
+    }
+    return 0;
+}
+
+// The records are checked before any messages are made for them, so a
+// damaged batch gives back nothing, rather than some of its records.
+
+std::vector<message_ptr> message_batcher::unpack(const const_message_ptr& msg)
+{
+    std::vector<message_ptr> recs;
+    if (!msg)
+        return recs;
+
+    auto count = batch_count(msg->get_properties());
+    if (count == 0)
+        return recs;
+
+    const auto& payload = msg->get_payload_ref();
+    const char* p = payload.data();
+    auto sz = payload.size();
+
+    std::size_t pos = 0, n = 0, k = 0;
+    while (pos < sz) {
+        if (k == count || !get_len(p, sz, pos, n))
+            return recs;
+        pos += n;
+        ++k;
+    }
+    if (k != count)
+        return recs;
+
+    const auto& topic = msg->get_topic_ref();
+    auto qos = msg->get_qos();
+    bool retained = msg->is_retained();
+
+    recs.reserve(count);
+    for (pos = 0; pos < sz; pos += n) {
+        get_len(p, sz, pos, n);
+        recs.push_back(message::create(topic, binary_ref(msg, p + pos, n), qos, retained));
+    }
+    return recs;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
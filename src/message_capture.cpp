@@ -0,0 +1,451 @@
+// message_capture.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/message_capture.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "mqtt/exception.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Both files start with a small header. The capture file is followed by
+// the records, each of which is a header, the topic, and the encoded
+// properties, padded out to a multiple of 8 bytes, then the payload,
+// padded the same way. That keeps every payload 8-byte aligned in the
+// file, for decoding in place. The index file is followed by an entry for
+// each record, with its offset and time. As in the log persistence, the
+// magic number of each record is written last, so a record that was only
+// partly written is never seen as valid.
+
+struct file_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t reserved;
+};
+
+struct rec_header
+{
+    uint32_t magic;
+    uint32_t topicLen;
+    uint32_t propsLen;
+    uint32_t payloadLen;
+    int64_t timeNs;
+    uint8_t qos;
+    uint8_t flags;
+    uint16_t reserved1;
+    uint32_t reserved2;
+};
+
+constexpr uint32_t CAPTURE_MAGIC = 0x5043514d;  // "MQCP"
+constexpr uint32_t INDEX_MAGIC = 0x4943514d;    // "MQCI"
+constexpr uint32_t REC_MAGIC = 0x5243514d;      // "MQCR"
+constexpr uint32_t VERSION = 1;
+
+constexpr uint8_t REC_RETAINED = 0x01;
+constexpr uint8_t REC_DUPLICATE = 0x02;
+
+constexpr size_t FILE_HDR_SIZE = sizeof(file_header);
+constexpr size_t REC_HDR_SIZE = sizeof(rec_header);
+constexpr size_t ENTRY_SIZE = sizeof(message_capture::entry);
+
+constexpr size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+size_t page_size() {
+    static const size_t sz = size_t(::sysconf(_SC_PAGESIZE));
+    return sz;
+}
+
+[[noreturn]] void throw_errno(const string& what) {
+    throw exception(MQTTASYNC_FAILURE, what + ": " + std::strerror(errno));
+}
+
+// The offset of the payload from the start of a record
+size_t payload_offset(const rec_header& hdr) {
+    return align8(REC_HDR_SIZE + size_t(hdr.topicLen) + size_t(hdr.propsLen));
+}
+
+// The size of a whole record
+size_t record_size(const rec_header& hdr) {
+    return align8(payload_offset(hdr) + size_t(hdr.payloadLen));
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//  						message_recorder::appender
+/////////////////////////////////////////////////////////////////////////////
+
+void message_recorder::appender::open(const string& path, size_t winSize)
+{
+    auto pg = page_size();
+    winSize_ = ((std::max(winSize, pg) + pg - 1) / pg) * pg;
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        throw_errno("Error creating capture file '" + path + "'");
+}
+
+// When a write doesn't fit in the window, the old one is unmapped, and a
+// new one is mapped from the page holding the end of the data. The file is
+// extended ahead of the window, and trimmed back to the data on close.
+
+char* message_recorder::appender::reserve(size_t n)
+{
+    if (pos_ + n <= winOff_ + winLen_ && win_)
+        return win_ + (pos_ - winOff_);
+
+    if (win_) {
+        ::munmap(win_, winLen_);
+        win_ = nullptr;
+    }
+
+    auto pg = page_size();
+    winOff_ = (pos_ / pg) * pg;
+    winLen_ = std::max(winSize_, ((pos_ + n - winOff_ + pg - 1) / pg) * pg);
+
+    if (fileSize_ < winOff_ + winLen_) {
+        if (::ftruncate(fd_, off_t(winOff_ + winLen_)) != 0)
+            throw_errno("Error extending capture file");
+        fileSize_ = winOff_ + winLen_;
+    }
+
+    void* p = ::mmap(nullptr, winLen_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, off_t(winOff_));
+    if (p == MAP_FAILED) {
+        winLen_ = 0;
+        throw_errno("Error mapping capture file");
+    }
+    win_ = static_cast<char*>(p);
+    return win_ + (pos_ - winOff_);
+}
+
+void message_recorder::appender::flush()
+{
+    if (win_)
+        ::msync(win_, winLen_, MS_ASYNC);
+}
+
+void message_recorder::appender::close()
+{
+    if (win_) {
+        ::munmap(win_, winLen_);
+        win_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        (void)::ftruncate(fd_, off_t(pos_));
+        ::close(fd_);
+        fd_ = -1;
+    }
+    winOff_ = winLen_ = fileSize_ = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  							message_recorder
+/////////////////////////////////////////////////////////////////////////////
+
+message_recorder::message_recorder(const string& path, size_t winSize /*=DFLT_WINDOW_SIZE*/)
+{
+    data_.open(path, winSize);
+    try {
+        index_.open(path + ".idx", winSize / 16);
+    }
+    catch (...) {
+        data_.close();
+        throw;
+    }
+
+    file_header hdr{CAPTURE_MAGIC, VERSION, 0};
+    std::memcpy(data_.reserve(FILE_HDR_SIZE), &hdr, FILE_HDR_SIZE);
+    data_.commit(FILE_HDR_SIZE);
+
+    hdr.magic = INDEX_MAGIC;
+    std::memcpy(index_.reserve(FILE_HDR_SIZE), &hdr, FILE_HDR_SIZE);
+    index_.commit(FILE_HDR_SIZE);
+
+    open_ = true;
+}
+
+message_recorder::~message_recorder() { close(); }
+
+void message_recorder::record(const message& msg, time_point t /*=clock::now()*/)
+{
+    const auto& topic = msg.get_topic_ref();
+    const auto& payload = msg.get_payload_ref();
+    const auto& props = msg.get_properties();
+
+    rec_header hdr{};
+    hdr.topicLen = uint32_t(topic.size());
+    hdr.propsLen = uint32_t(props.empty() ? 0 : props.packed_size());
+    hdr.payloadLen = uint32_t(payload.size());
+    hdr.timeNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    hdr.qos = uint8_t(msg.get_qos());
+    hdr.flags = uint8_t(
+        (msg.is_retained() ? REC_RETAINED : 0) | (msg.is_duplicate() ? REC_DUPLICATE : 0)
+    );
+
+    auto payOff = payload_offset(hdr);
+    auto recSize = record_size(hdr);
+
+    guard g{lock_};
+    if (!open_)
+        return;
+
+    auto off = data_.size();
+    char* p = data_.reserve(recSize);
+
+    if (hdr.topicLen)
+        std::memcpy(p + REC_HDR_SIZE, topic.data(), hdr.topicLen);
+    if (hdr.propsLen)
+        props.pack(p + REC_HDR_SIZE + hdr.topicLen);
+    if (hdr.payloadLen)
+        std::memcpy(p + payOff, payload.data(), hdr.payloadLen);
+
+    std::memcpy(p, &hdr, REC_HDR_SIZE);
+    std::atomic_signal_fence(std::memory_order_release);
+    hdr.magic = REC_MAGIC;
+    std::memcpy(p, &hdr.magic, sizeof(hdr.magic));
+    data_.commit(recSize);
+
+    // The offset goes in last, since a zero offset marks the end of the
+    // index.
+    message_capture::entry ent{0, hdr.timeNs};
+    char* q = index_.reserve(ENTRY_SIZE);
+    std::memcpy(q, &ent, ENTRY_SIZE);
+    std::atomic_signal_fence(std::memory_order_release);
+    ent.offset = uint64_t(off);
+    std::memcpy(q, &ent.offset, sizeof(ent.offset));
+    index_.commit(ENTRY_SIZE);
+
+    ++nRec_;
+}
+
+void message_recorder::flush()
+{
+    guard g{lock_};
+    data_.flush();
+    index_.flush();
+}
+
+void message_recorder::close()
+{
+    guard g{lock_};
+    if (open_) {
+        data_.close();
+        index_.close();
+        open_ = false;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  							message_capture
+/////////////////////////////////////////////////////////////////////////////
+
+struct message_capture::mapping
+{
+    const char* base{nullptr};
+    size_t size{0};
+
+    explicit mapping(const string& path, bool required) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (required)
+                throw_errno("Error opening capture file '" + path + "'");
+            return;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                base = static_cast<const char*>(p);
+                size = size_t(st.st_size);
+            }
+        }
+        ::close(fd);
+
+        if (!base && required)
+            throw exception(MQTTASYNC_FAILURE, "Error mapping capture file '" + path + "'");
+    }
+    ~mapping() {
+        if (base)
+            ::munmap(const_cast<char*>(base), size);
+    }
+
+    mapping(const mapping&) = delete;
+    mapping& operator=(const mapping&) = delete;
+
+    // Whether the file starts with a valid header
+    bool has_header(uint32_t magic) const {
+        if (size < FILE_HDR_SIZE)
+            return false;
+        file_header hdr;
+        std::memcpy(&hdr, base, FILE_HDR_SIZE);
+        return hdr.magic == magic && hdr.version == VERSION;
+    }
+    // Gets the header of the valid record at the offset, if there is one
+    bool get_record(size_t off, rec_header& hdr) const {
+        if (off < FILE_HDR_SIZE || off + REC_HDR_SIZE > size)
+            return false;
+        std::memcpy(&hdr, base + off, REC_HDR_SIZE);
+        return hdr.magic == REC_MAGIC && record_size(hdr) <= size - off;
+    }
+};
+
+// The entries from the index file are used as long as they point to valid
+// records. Anything past them, whether the index was lost or just fell
+// behind, is found by scanning the records.
+
+message_capture::message_capture(const string& path)
+    : data_{std::make_shared<mapping>(path, true)},
+      index_{std::make_shared<mapping>(path + ".idx", false)}
+{
+    if (!data_->has_header(CAPTURE_MAGIC))
+        throw exception(MQTTASYNC_FAILURE, "Not a capture file: '" + path + "'");
+
+    size_t off = FILE_HDR_SIZE;
+
+    if (index_->has_header(INDEX_MAGIC)) {
+        size_t n = (index_->size - FILE_HDR_SIZE) / ENTRY_SIZE;
+        auto ents = reinterpret_cast<const entry*>(index_->base + FILE_HDR_SIZE);
+        rec_header hdr;
+        while (nIndexed_ < n) {
+            if (ents[nIndexed_].offset != off || !data_->get_record(off, hdr))
+                break;
+            off += record_size(hdr);
+            ++nIndexed_;
+        }
+    }
+
+    if (nIndexed_ == 0)
+        index_.reset();
+
+    scan(off);
+}
+
+const message_capture::entry& message_capture::get_entry(size_t i) const
+{
+    if (i < nIndexed_)
+        return reinterpret_cast<const entry*>(index_->base + FILE_HDR_SIZE)[i];
+    return tail_.at(i - nIndexed_);
+}
+
+void message_capture::scan(size_t off)
+{
+    rec_header hdr;
+    while (data_->get_record(off, hdr)) {
+        tail_.push_back(entry{uint64_t(off), hdr.timeNs});
+        off += record_size(hdr);
+    }
+}
+
+const_message_ptr message_capture::get(size_t i) const
+{
+    if (i >= size())
+        throw std::out_of_range("message_capture: no message at index");
+
+    size_t off = size_t(get_entry(i).offset);
+    rec_header hdr;
+    data_->get_record(off, hdr);
+
+    const char* p = data_->base + off;
+    string_ref topic{data_, p + REC_HDR_SIZE, hdr.topicLen};
+    binary_ref payload{data_, p + payload_offset(hdr), hdr.payloadLen};
+
+    properties props;
+    if (hdr.propsLen)
+        props = properties::unpack(p + REC_HDR_SIZE + hdr.topicLen, hdr.propsLen);
+
+    auto msg = message::create(
+        std::move(topic), std::move(payload), hdr.qos, (hdr.flags & REC_RETAINED) != 0, props
+    );
+    msg->set_duplicate((hdr.flags & REC_DUPLICATE) != 0);
+    return msg;
+}
+
+message_capture::time_point message_capture::get_time(size_t i) const
+{
+    if (i >= size())
+        throw std::out_of_range("message_capture: no message at index");
+
+    auto d = std::chrono::nanoseconds(get_entry(i).timeNs);
+    return time_point{std::chrono::duration_cast<clock::duration>(d)};
+}
+
+size_t message_capture::find(time_point t) const
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+
+    size_t lo = 0, hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (get_entry(mid).timeNs < ns)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// The timing is kept relative to the first message that is replayed, and
+// each message waits for its own deadline, so that the time taken by the
+// handler doesn't build up over a long replay.
+
+size_t message_capture::replay(
+    const handler& cb, double speed /*=1.0*/, size_t first /*=0*/, size_t last /*=npos*/
+) const
+{
+    using namespace std::chrono;
+
+    last = std::min(last, size());
+    if (first >= last)
+        return 0;
+
+    auto start = steady_clock::now();
+    auto t0 = get_entry(first).timeNs;
+
+    for (size_t i = first; i < last; ++i) {
+        if (speed > 0.0) {
+            auto dt = duration<double, std::nano>(double(get_entry(i).timeNs - t0) / speed);
+            if (dt.count() > 0)
+                std::this_thread::sleep_until(
+                    start + duration_cast<steady_clock::duration>(dt)
+                );
+        }
+        cb(get(i));
+    }
+    return last - first;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,234 @@
+// message_pipeline.cpp
+//
+// Implementation of the message_pipeline class for the Paho MQTT C++
+// library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/message_pipeline.h"
+
+#include <algorithm>
+#include <map>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							message_pipeline
+/////////////////////////////////////////////////////////////////////////////
+
+message_pipeline::message_pipeline(
+    std::vector<stage_options> stages, sink_function sink,
+    std::size_t bufSize /*=DFLT_BUFFER_SIZE*/, std::size_t maxInFlight /*=DFLT_MAX_IN_FLIGHT*/
+)
+    : sink_{std::move(sink)}, sinkQue_{bufSize}, maxInFlight_{std::max<std::size_t>(maxInFlight, 1)}
+{
+    stages_.reserve(stages.size());
+    for (auto& opts : stages) {
+        if (opts.nThreads == 0)
+            opts.nThreads = 1;
+        stages_.push_back(std::make_unique<stage>(std::move(opts), bufSize));
+    }
+
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        auto& st = *stages_[i];
+        st.thrs.reserve(st.opts.nThreads);
+        for (std::size_t j = 0; j < st.opts.nThreads; ++j)
+            st.thrs.emplace_back(&message_pipeline::run_stage, this, i);
+    }
+    sinkThr_ = std::thread(&message_pipeline::run_sink, this);
+}
+
+message_pipeline::~message_pipeline() { stop(); }
+
+// A dropped message still goes down the line, without its message, so
+// that the sink knows not to wait for it.
+
+void message_pipeline::run_stage(std::size_t idx)
+{
+    using clock = std::chrono::steady_clock;
+
+    auto& st = *stages_[idx];
+    auto& next = next_queue(idx);
+
+    item it;
+    while (st.que.get(&it)) {
+        if (it.msg) {
+            auto start = clock::now();
+            try {
+                if (st.opts.func)
+                    it.msg = st.opts.func(std::move(it.msg));
+            }
+            catch (...) {
+                it.msg.reset();
+                st.nErrors.fetch_add(1, std::memory_order_relaxed);
+            }
+            st.busyNs.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start)
+                    .count(),
+                std::memory_order_relaxed
+            );
+            st.nProcessed.fetch_add(1, std::memory_order_relaxed);
+            if (!it.msg)
+                st.nDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        next.put(std::move(it));
+    }
+}
+
+// The sink takes the messages in sequence. Any that arrive ahead of their
+// turn wait in the reorder buffer, which can't hold more than the number
+// of messages in flight. When the pipeline stops, anything left, from a
+// submit that lost a race with the stop, goes out in order.
+
+void message_pipeline::run_sink()
+{
+    std::map<uint64_t, const_message_ptr> reorder;
+    uint64_t nextSeq = 0;
+
+    item it;
+    while (sinkQue_.get(&it)) {
+        if (it.seq != nextSeq) {
+            reorder.emplace(it.seq, std::move(it.msg));
+            nReorder_.store(reorder.size(), std::memory_order_relaxed);
+            continue;
+        }
+
+        deliver(std::move(it.msg));
+        ++nextSeq;
+
+        auto p = reorder.begin();
+        while (p != reorder.end() && p->first == nextSeq) {
+            deliver(std::move(p->second));
+            p = reorder.erase(p);
+            ++nextSeq;
+        }
+        nReorder_.store(reorder.size(), std::memory_order_relaxed);
+    }
+
+    for (auto& val : reorder) deliver(std::move(val.second));
+    nReorder_.store(0, std::memory_order_relaxed);
+}
+
+void message_pipeline::deliver(const_message_ptr msg)
+{
+    if (msg) {
+        try {
+            if (sink_)
+                sink_(std::move(msg));
+        }
+        catch (...) {
+        }
+        nDelivered_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        guard g{lock_};
+        ++nDone_;
+    }
+    cond_.notify_all();
+}
+
+bool message_pipeline::submit(const_message_ptr msg)
+{
+    if (!msg)
+        return false;
+
+    uint64_t seq;
+    {
+        unique_lock g{lock_};
+        cond_.wait(g, [this] { return stopped_ || nextSeq_ - nDone_ < maxInFlight_; });
+        if (stopped_)
+            return false;
+        seq = nextSeq_++;
+    }
+
+    try {
+        (stages_.empty() ? sinkQue_ : stages_.front()->que).put({seq, std::move(msg)});
+    }
+    catch (const queue_closed&) {
+        return false;
+    }
+    return true;
+}
+
+std::size_t message_pipeline::feed(iasync_client& cli)
+{
+    std::size_t n = 0;
+
+    while (true) {
+        auto evt = cli.consume_event();
+
+        if (auto* pval = evt.get_message_if()) {
+            if (!submit(std::move(*pval)))
+                break;
+            ++n;
+        }
+        else if (evt.is_shutdown())
+            break;
+    }
+    return n;
+}
+
+std::vector<message_pipeline::stage_metrics> message_pipeline::get_metrics() const
+{
+    std::vector<stage_metrics> metrics;
+    metrics.reserve(stages_.size());
+
+    for (const auto& st : stages_) {
+        stage_metrics m;
+        m.name = st->opts.name;
+        m.nThreads = st->opts.nThreads;
+        m.processed = st->nProcessed.load(std::memory_order_relaxed);
+        m.dropped = st->nDropped.load(std::memory_order_relaxed);
+        m.errors = st->nErrors.load(std::memory_order_relaxed);
+        m.queued = st->que.size();
+        m.busyTime = std::chrono::nanoseconds{st->busyNs.load(std::memory_order_relaxed)};
+        metrics.push_back(std::move(m));
+    }
+    return metrics;
+}
+
+// The stages are closed and drained from the front, so each one finishes
+// before the queue after it is closed.
+
+void message_pipeline::stop()
+{
+    {
+        guard g{lock_};
+        if (stopped_)
+            return;
+        stopped_ = true;
+    }
+    cond_.notify_all();
+
+    for (auto& st : stages_) {
+        st->que.close();
+        for (auto& thr : st->thrs) {
+            if (thr.joinable())
+                thr.join();
+        }
+        st->thrs.clear();
+    }
+
+    sinkQue_.close();
+    if (sinkThr_.joinable())
+        sinkThr_.join();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,296 @@
+// offline_buffer.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/offline_buffer.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							offline_buffer
+/////////////////////////////////////////////////////////////////////////////
+
+offline_buffer::offline_buffer(
+    std::size_t maxMsgs /*=0*/, std::size_t maxBytes /*=0*/, double drainRate /*=0.0*/
+)
+    : maxMsgs_{maxMsgs}, maxBytes_{maxBytes}, drainRate_{std::max(drainRate, 0.0)}
+{
+}
+
+offline_buffer::~offline_buffer() { stop(); }
+
+double offline_buffer::get_drain_rate() const
+{
+    guard g{lock_};
+    return drainRate_;
+}
+
+void offline_buffer::set_drain_rate(double msgsPerSec)
+{
+    {
+        guard g{lock_};
+        drainRate_ = std::max(msgsPerSec, 0.0);
+        nextSend_ = clock::time_point{};
+    }
+    cond_.notify_all();
+}
+
+void offline_buffer::set_drained_handler(drained_handler cb)
+{
+    guard g{lock_};
+    drainedHandler_ = std::move(cb);
+}
+
+void offline_buffer::set_expired_handler(expired_handler cb)
+{
+    guard g{lock_};
+    expiredHandler_ = std::move(cb);
+}
+
+// The Message Expiry Interval starts when the message is buffered. A
+// conflated message that replaces a held one takes its place in the lane,
+// so it isn't pushed to the back of the backlog by each update.
+
+bool offline_buffer::add(const_message_ptr msg, task_type task)
+{
+    auto n = msg->get_payload().size();
+    auto mem = msg->memory_size();
+    auto secs = msg->get_expiry_interval();
+    auto expiry = (secs == 0) ? clock::time_point::max()
+                              : clock::now() + std::chrono::seconds(secs);
+    task_type replaced;
+    {
+        guard g{lock_};
+        if (stopped_)
+            return false;
+
+        auto it = msg->get_conflate() ? conflated_.find(msg->get_topic()) : conflated_.end();
+        if (it != conflated_.end()) {
+            auto& cur = *it->second;
+            auto n0 = cur.msg->get_payload().size();
+            if (maxBytes_ != 0 && nBytes_ - n0 + n > maxBytes_)
+                return false;
+
+            replaced = std::move(cur.task);
+            memBytes_ = memBytes_ - cur.msg->memory_size() + mem;
+            cur = entry{std::move(msg), std::move(task), expiry, nullptr};
+            nBytes_ = nBytes_ - n0 + n;
+            ++nConflated_;
+        }
+        else {
+            if ((maxMsgs_ != 0 && que_.size() >= maxMsgs_) ||
+                (maxBytes_ != 0 && nBytes_ + n > maxBytes_))
+                return false;
+
+            auto prio = msg->get_priority();
+            if (msg->get_conflate()) {
+                auto latest = std::make_shared<entry>(
+                    entry{std::move(msg), std::move(task), expiry, nullptr}
+                );
+                conflated_.emplace(latest->msg->get_topic(), latest);
+                que_.push_back(prio, {nullptr, nullptr, expiry, std::move(latest)});
+            }
+            else
+                que_.push_back(prio, {std::move(msg), std::move(task), expiry, nullptr});
+            nBytes_ += n;
+            memBytes_ += mem;
+        }
+        if (memBytes_ > peakMemBytes_)
+            peakMemBytes_ = memBytes_;
+    }
+
+    if (replaced)
+        replaced(false);
+    else
+        cond_.notify_all();
+    return true;
+}
+
+void offline_buffer::resolve(entry& e)
+{
+    if (e.latest) {
+        auto p = std::move(e.latest);
+        conflated_.erase(p->msg->get_topic());
+        e = std::move(*p);
+    }
+}
+
+// The operations for the dropped messages are called outside the lock,
+// since they complete the tokens, which can run user callbacks.
+
+std::size_t offline_buffer::remove_if(const predicate_type& pred)
+{
+    std::vector<entry> dropped;
+    {
+        guard g{lock_};
+        dropped = que_.extract_if([&pred](const entry& e) { return pred(*current(e).msg); });
+        for (auto& e : dropped) {
+            resolve(e);
+            nBytes_ -= e.msg->get_payload().size();
+            memBytes_ -= e.msg->memory_size();
+        }
+    }
+
+    for (auto& e : dropped) e.task(false);
+    return dropped.size();
+}
+
+void offline_buffer::start_drain()
+{
+    {
+        guard g{lock_};
+        if (stopped_ || que_.empty())
+            return;
+
+        draining_ = true;
+        if (!thr_.joinable())
+            thr_ = std::thread(&offline_buffer::run, this);
+    }
+    cond_.notify_all();
+}
+
+// A message that can't be sent goes back to the front of the buffer, to
+// wait for the next connection. When paced, the sends keep to a schedule,
+// so a late wakeup doesn't slow the drain, but the schedule restarts when
+// it falls more than a slot behind, so an idle spell doesn't turn into a
+// burst. An expired message is dropped without taking a send slot. A
+// conflated message that couldn't be sent is dropped if a newer one for
+// its topic came in while it was out of the buffer.
+
+void offline_buffer::run()
+{
+    unique_lock g{lock_};
+
+    while (true) {
+        cond_.wait(g, [this] { return stopped_ || (draining_ && !que_.empty()); });
+        if (stopped_)
+            break;
+
+        if (current(que_.front()).expiry <= clock::now()) {
+            auto e = que_.pop_front();
+            resolve(e);
+            nBytes_ -= e.msg->get_payload().size();
+            memBytes_ -= e.msg->memory_size();
+            ++nExpired_;
+            auto cb = expiredHandler_;
+
+            g.unlock();
+            e.task(false);
+            if (cb)
+                cb(*e.msg);
+            g.lock();
+
+            check_drained(g);
+            continue;
+        }
+
+        if (drainRate_ > 0.0) {
+            auto now = clock::now();
+            if (nextSend_ > now) {
+                cond_.wait_until(g, nextSend_);
+                continue;
+            }
+            auto interval = std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(1.0 / drainRate_)
+            );
+            if (nextSend_ + interval < now)
+                nextSend_ = now;
+            nextSend_ += interval;
+        }
+
+        auto e = que_.pop_front();
+        resolve(e);
+        auto n = e.msg->get_payload().size();
+        auto mem = e.msg->memory_size();
+        nBytes_ -= n;
+        memBytes_ -= mem;
+
+        g.unlock();
+        bool sent = e.task(true);
+        g.lock();
+
+        if (!sent) {
+            auto prio = e.msg->get_priority();
+            draining_ = false;
+
+            if (!e.msg->get_conflate())
+                que_.push_front(prio, std::move(e));
+            else if (conflated_.count(e.msg->get_topic()) == 0) {
+                auto latest = std::make_shared<entry>(std::move(e));
+                conflated_.emplace(latest->msg->get_topic(), latest);
+                que_.push_front(prio, {nullptr, nullptr, latest->expiry, std::move(latest)});
+            }
+            else {
+                ++nConflated_;
+                g.unlock();
+                e.task(false);
+                g.lock();
+                continue;
+            }
+            nBytes_ += n;
+            memBytes_ += mem;
+        }
+        else
+            check_drained(g);
+    }
+}
+
+void offline_buffer::check_drained(unique_lock& g)
+{
+    if (draining_ && que_.empty()) {
+        draining_ = false;
+        auto cb = drainedHandler_;
+        if (cb) {
+            g.unlock();
+            cb();
+            g.lock();
+        }
+    }
+}
+
+void offline_buffer::stop()
+{
+    std::thread thr;
+    {
+        guard g{lock_};
+        stopped_ = true;
+        thr = std::move(thr_);
+    }
+    cond_.notify_all();
+
+    if (thr.joinable())
+        thr.join();
+
+    std::vector<entry> que;
+    {
+        guard g{lock_};
+        que = que_.take_all();
+        for (auto& e : que) resolve(e);
+        nBytes_ = 0;
+        memBytes_ = 0;
+        draining_ = false;
+    }
+
+    for (auto& e : que) e.task(false);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -18,6 +18,8 @@
 
 #include "mqtt/properties.h"
 
+#include <cstring>
+
 namespace mqtt {
 
 PAHO_MQTTPP_EXPORT const std::map<property::code, std::string_view> property::TYPE_NAME{
@@ -234,18 +236,46 @@ std::ostream& operator<<(std::ostream& os, const property& prop)
 
 /////////////////////////////////////////////////////////////////////////////
 
+// The C list is allocated by the C library, so it's freed by it as well.
+
+std::shared_ptr<MQTTProperties> properties::make_rep(const MQTTProperties& cprops)
+{
+    return std::shared_ptr<MQTTProperties>(new MQTTProperties(cprops), [](MQTTProperties* p) {
+        ::MQTTProperties_free(p);
+        delete p;
+    });
+}
+
+properties::properties(const MQTTProperties& cprops)
+{
+    if (cprops.count > 0) {
+        props_ = ::MQTTProperties_copy(&cprops);
+        rep_ = make_rep(props_);
+    }
+}
+
 properties::properties(std::initializer_list<property> props)
 {
-    for (const auto& prop : props) {
-        ::MQTTProperties_add(&props_, &prop.c_struct());
+    for (const auto& prop : props) add(prop);
+}
+
+void properties::detach()
+{
+    if (!rep_) {
+        props_ = DFLT_C_STRUCT;
+        rep_ = make_rep(props_);
+    }
+    else if (rep_.use_count() > 1) {
+        props_ = ::MQTTProperties_copy(&props_);
+        rep_ = make_rep(props_);
     }
 }
 
 properties& properties::operator=(const properties& rhs)
 {
     if (&rhs != this) {
-        ::MQTTProperties_free(&props_);
-        props_ = ::MQTTProperties_copy(&rhs.props_);
+        props_ = rhs.props_;
+        rep_ = rhs.rep_;
     }
     return *this;
 }
@@ -253,13 +283,20 @@ properties& properties::operator=(const properties& rhs)
 properties& properties::operator=(properties&& rhs)
 {
     if (&rhs != this) {
-        ::MQTTProperties_free(&props_);
         props_ = rhs.props_;
+        rep_ = std::move(rhs.rep_);
         rhs.props_ = DFLT_C_STRUCT;
     }
     return *this;
 }
 
+void properties::add(const property& prop)
+{
+    detach();
+    ::MQTTProperties_add(&props_, &prop.c_struct());
+    *rep_ = props_;
+}
+
 property properties::get(property::code propid, size_t idx /*=0*/) const
 {
     MQTTProperty* prop = MQTTProperties_getPropertyAt(
@@ -271,5 +308,189 @@ property properties::get(property::code propid, size_t idx /*=0*/) const
     return property(*prop);
 }
 
+// --------------------------------------------------------------------------
+// The packed format is a sequence of the property ID as a byte, followed
+// by the value: a 32-bit integer for the numeric types, and a 32-bit
+// length and the bytes for each string or binary value. It's in the
+// host's byte order.
+
+namespace {
+
+char* put_u32(char* p, uint32_t v) {
+    std::memcpy(p, &v, sizeof(v));
+    return p + sizeof(v);
+}
+
+char* put_str(char* p, const MQTTLenString& s) {
+    p = put_u32(p, uint32_t(s.len));
+    if (s.len > 0)
+        std::memcpy(p, s.data, size_t(s.len));
+    return p + s.len;
+}
+
+}  // namespace
+
+size_t properties::packed_size() const
+{
+    size_t n = 0;
+    for (const auto& prop : *this) {
+        const auto& cprop = prop.c_struct();
+        n += 1;
+        switch (::MQTTProperty_getType(cprop.identifier)) {
+            case MQTTPROPERTY_TYPE_BINARY_DATA:
+            case MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING:
+                n += sizeof(uint32_t) + size_t(cprop.value.data.len);
+                break;
+            case MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR:
+                n += 2 * sizeof(uint32_t) + size_t(cprop.value.data.len) +
+                     size_t(cprop.value.value.len);
+                break;
+            default:
+                n += sizeof(uint32_t);
+                break;
+        }
+    }
+    return n;
+}
+
+char* properties::pack(char* p) const
+{
+    for (const auto& prop : *this) {
+        const auto& cprop = prop.c_struct();
+        *p++ = char(cprop.identifier);
+        switch (::MQTTProperty_getType(cprop.identifier)) {
+            case MQTTPROPERTY_TYPE_BYTE:
+                p = put_u32(p, cprop.value.byte);
+                break;
+            case MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER:
+                p = put_u32(p, cprop.value.integer2);
+                break;
+            case MQTTPROPERTY_TYPE_BINARY_DATA:
+            case MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING:
+                p = put_str(p, cprop.value.data);
+                break;
+            case MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR:
+                p = put_str(p, cprop.value.data);
+                p = put_str(p, cprop.value.value);
+                break;
+            default:
+                p = put_u32(p, cprop.value.integer4);
+                break;
+        }
+    }
+    return p;
+}
+
+// Reads the packed properties, stopping at anything malformed.
+
+properties properties::unpack(const char* p, size_t n)
+{
+    properties props;
+    const char* end = p + n;
+
+    auto get_u32 = [&](uint32_t& v) {
+        if (size_t(end - p) < sizeof(v))
+            return false;
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return true;
+    };
+    auto get_str = [&](string_ref& s) {
+        uint32_t len;
+        if (!get_u32(len) || size_t(end - p) < len)
+            return false;
+        s = string_ref{p, len};
+        p += len;
+        return true;
+    };
+
+    while (p < end) {
+        auto c = property::code(uint8_t(*p++));
+        uint32_t v;
+        string_ref s1, s2;
+
+        switch (::MQTTProperty_getType(MQTTPropertyCodes(c))) {
+            case MQTTPROPERTY_TYPE_BINARY_DATA:
+            case MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING:
+                if (!get_str(s1))
+                    return props;
+                props.add(property{c, std::move(s1)});
+                break;
+            case MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR:
+                if (!get_str(s1) || !get_str(s2))
+                    return props;
+                props.add(property{c, std::move(s1), std::move(s2)});
+                break;
+            case MQTTPROPERTY_TYPE_BYTE:
+            case MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER:
+            case MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER:
+            case MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER:
+                if (!get_u32(v))
+                    return props;
+                props.add(property{c, v});
+                break;
+            default:
+                return props;
+        }
+    }
+    return props;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Finds the first user property with the name, starting at position 'i'
+std::optional<std::string_view> find_user_property(
+    const MQTTProperties& cprops, int i, std::string_view name
+) noexcept
+{
+    for (; i < cprops.count; ++i) {
+        const auto& cprop = cprops.array[i];
+        if (cprop.identifier != MQTTPROPERTY_CODE_USER_PROPERTY)
+            continue;
+
+        const auto& key = cprop.value.data;
+        if (size_t(key.len) == name.size() &&
+            (name.empty() || std::memcmp(key.data, name.data(), name.size()) == 0)) {
+            const auto& val = cprop.value.value;
+            return val.data ? std::string_view{val.data, size_t(val.len)} : std::string_view{};
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<std::string_view> get_user_property(
+    const properties& props, std::string_view name
+) noexcept
+{
+    return find_user_property(props.c_struct(), 0, name);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// A list that's too long to index by 16-bit positions is rare enough that
+// the positions past it just aren't indexed, and those lookups fall back
+// to searching from the start.
+
+property_index::property_index(const properties& props) noexcept : props_{&props.c_struct()}
+{
+    std::fill(std::begin(first_), std::end(first_), NONE);
+
+    for (int i = 0; i < props_->count; ++i) {
+        auto c = size_t(props_->array[i].identifier);
+        if (c < N_CODES && first_[c] == NONE)
+            first_[c] = (i < int(NONE)) ? uint16_t(i) : uint16_t(0);
+    }
+}
+
+std::optional<std::string_view> property_index::get_user_property(std::string_view name
+) const noexcept
+{
+    return find_user_property(*props_, start(property::USER_PROPERTY), name);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 }  // namespace mqtt
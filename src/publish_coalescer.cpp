@@ -0,0 +1,107 @@
+// publish_coalescer.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/publish_coalescer.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+publish_coalescer::~publish_coalescer()
+{
+    {
+        guard g{lock_};
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thr_.joinable())
+        thr_.join();
+
+    flush();
+}
+
+// The flush thread wakes when the oldest pending message has waited for
+// the delay, or when the size threshold is reached.
+
+void publish_coalescer::run()
+{
+    unique_guard g{lock_};
+
+    while (!stop_) {
+        if (pending_.empty()) {
+            cond_.wait(g, [this] { return stop_ || !pending_.empty(); });
+        }
+        else {
+            cond_.wait_until(g, oldest_ + delay_, [this] {
+                return stop_ || pendingBytes_ >= maxBytes_;
+            });
+        }
+
+        if (stop_ || pending_.empty())
+            continue;
+
+        if (pendingBytes_ >= maxBytes_ || clock::now() >= oldest_ + delay_) {
+            g.unlock();
+            flush();
+            g.lock();
+        }
+    }
+}
+
+void publish_coalescer::add(size_t nBytes, task_type task)
+{
+    bool notify = false;
+    {
+        guard g{lock_};
+        if (pending_.empty()) {
+            oldest_ = clock::now();
+            notify = true;
+        }
+        pending_.push_back(std::move(task));
+        pendingBytes_ += nBytes;
+        notify = notify || pendingBytes_ >= maxBytes_;
+    }
+    if (notify)
+        cond_.notify_one();
+}
+
+void publish_coalescer::flush()
+{
+    guard fg{flushLock_};
+
+    std::vector<task_type> tasks;
+    {
+        guard g{lock_};
+        if (pending_.empty())
+            return;
+        tasks.swap(pending_);
+        pendingBytes_ = 0;
+        ++nFlushes_;
+    }
+
+    for (auto& task : tasks) {
+        try {
+            task();
+        }
+        catch (...) {
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
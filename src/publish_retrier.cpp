@@ -0,0 +1,161 @@
+// publish_retrier.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/publish_retrier.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  							publish_retrier
+/////////////////////////////////////////////////////////////////////////////
+
+publish_retrier::publish_retrier(
+    retry_policy policy /*=retry_policy{}*/,
+    std::size_t maxDeadLetters /*=DFLT_MAX_DEAD_LETTERS*/,
+    timer_wheel_ptr wheel /*=timer_wheel_ptr{}*/
+)
+    : policy_{std::move(policy)},
+      maxDeadLetters_{maxDeadLetters},
+      wheel_{wheel ? std::move(wheel) : timer_wheel::create()}
+{
+}
+
+publish_retrier::~publish_retrier() { stop(); }
+
+// The retries are run without the lock, since they normally send the
+// message again, and may schedule another retry.
+
+void publish_retrier::run(uint64_t key)
+{
+    task_type task;
+    {
+        guard g{lock_};
+        auto it = que_.find(key);
+        if (it == que_.end())
+            return;
+        task = std::move(it->second.task);
+        running_ = it->second.timer;
+        que_.erase(it);
+    }
+
+    task(true);
+
+    guard g{lock_};
+    running_ = 0;
+}
+
+bool publish_retrier::schedule(unsigned retry, task_type task)
+{
+    std::chrono::milliseconds delay;
+    {
+        guard g{lock_};
+        delay = policy_.get_delay(retry, std::uniform_real_distribution<double>{0.0, 1.0}(rng_));
+    }
+    return schedule_at(clock::now() + delay, std::move(task));
+}
+
+bool publish_retrier::schedule_at(clock::time_point due, task_type task)
+{
+    {
+        guard g{lock_};
+        if (stopped_)
+            return false;
+
+        auto key = seq_++;
+        auto id = wheel_->schedule_at(due, [this, key] { run(key); });
+        if (id == 0)
+            return false;
+        que_.emplace(key, entry{id, std::move(task)});
+    }
+    nRetries_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void publish_retrier::add_dead_letter(dead_letter dl)
+{
+    if (dl.time == std::chrono::system_clock::time_point{})
+        dl.time = std::chrono::system_clock::now();
+
+    dead_letter_handler cb;
+    {
+        guard g{lock_};
+        if (maxDeadLetters_ != 0) {
+            if (deadLetters_.size() >= maxDeadLetters_) {
+                deadLetters_.pop_front();
+                nDropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            deadLetters_.push_back(dl);
+        }
+        cb = deadLetterHandler_;
+    }
+    nDeadLettered_.fetch_add(1, std::memory_order_relaxed);
+
+    if (cb)
+        cb(dl);
+}
+
+void publish_retrier::set_dead_letter_handler(dead_letter_handler cb)
+{
+    guard g{lock_};
+    deadLetterHandler_ = std::move(cb);
+}
+
+std::vector<dead_letter> publish_retrier::take_dead_letters()
+{
+    guard g{lock_};
+    std::vector<dead_letter> dls{
+        std::make_move_iterator(deadLetters_.begin()),
+        std::make_move_iterator(deadLetters_.end())
+    };
+    deadLetters_.clear();
+    return dls;
+}
+
+// Cancelling the timers waits out the one that's running, if any, so no
+// retry runs once this returns.
+
+void publish_retrier::stop()
+{
+    std::unordered_map<uint64_t, entry> que;
+    timer_wheel::timer_id running;
+    {
+        guard g{lock_};
+        stopped_ = true;
+        que.swap(que_);
+        running = running_;
+    }
+
+    for (auto& e : que) wheel_->cancel(e.second.timer);
+    if (running)
+        wheel_->cancel(running);
+
+    // The ones that were waiting are cancelled in the order they were
+    // scheduled.
+    std::vector<std::pair<uint64_t, task_type>> tasks;
+    for (auto& e : que) tasks.emplace_back(e.first, std::move(e.second.task));
+    std::sort(tasks.begin(), tasks.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (auto& t : tasks) t.second(false);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,233 @@
+// rate_limiter.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/rate_limiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mqtt {
+
+namespace {
+
+// Gets the time between two points, in seconds
+inline double seconds(rate_limiter::clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//  							rate_limiter
+/////////////////////////////////////////////////////////////////////////////
+
+rate_limiter::rate_limiter(
+    double msgRate, double byteRate /*=0.0*/, Policy policy /*=BLOCK*/,
+    double burstSecs /*=1.0*/, timer_wheel_ptr wheel /*=timer_wheel_ptr{}*/
+)
+    : policy_{policy}, lastFill_{clock::now()}, lastRate_{lastFill_}, wheel_{std::move(wheel)}
+{
+    msgRate = std::max(msgRate, 0.0);
+    byteRate = std::max(byteRate, 0.0);
+
+    // The buckets start out full
+    auto msgCap = std::max(1.0, msgRate * burstSecs);
+    auto byteCap = std::max(1.0, byteRate * burstSecs);
+
+    msgs_ = bucket{msgRate, msgCap, msgCap};
+    bytes_ = bucket{byteRate, byteCap, byteCap};
+}
+
+rate_limiter::~rate_limiter() { stop(); }
+
+void rate_limiter::fill(clock::time_point now)
+{
+    auto dt = seconds(now - lastFill_);
+    lastFill_ = now;
+
+    for (auto b : {&msgs_, &bytes_}) {
+        if (b->rate > 0.0)
+            b->level = std::min(b->capacity, b->level + b->rate * dt);
+    }
+}
+
+// The measured rates are counts that decay with a one second time
+// constant, which makes each one about the number in the last second.
+
+void rate_limiter::decay(clock::time_point now) const
+{
+    auto k = std::exp(-seconds(now - lastRate_));
+    lastRate_ = now;
+    msgRate_ *= k;
+    byteRate_ *= k;
+}
+
+// A message larger than the byte bucket only needs the bucket to be full,
+// and then leaves it in debt.
+
+rate_limiter::clock::duration rate_limiter::take(std::size_t nBytes, clock::time_point now)
+{
+    fill(now);
+
+    auto n = double(nBytes);
+    double wait = 0.0;
+
+    if (msgs_.rate > 0.0 && msgs_.level < 1.0)
+        wait = (1.0 - msgs_.level) / msgs_.rate;
+
+    auto byteNeed = std::min(n, bytes_.capacity);
+    if (bytes_.rate > 0.0 && bytes_.level < byteNeed)
+        wait = std::max(wait, (byteNeed - bytes_.level) / bytes_.rate);
+
+    if (wait > 0.0) {
+        auto d = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(wait));
+        return std::max(d, clock::duration{1});
+    }
+
+    if (msgs_.rate > 0.0)
+        msgs_.level -= 1.0;
+    if (bytes_.rate > 0.0)
+        bytes_.level -= n;
+
+    decay(now);
+    msgRate_ += 1.0;
+    byteRate_ += n;
+
+    return clock::duration::zero();
+}
+
+bool rate_limiter::try_acquire(std::size_t nBytes)
+{
+    guard g{lock_};
+    return !stopped_ && take(nBytes, clock::now()) == clock::duration::zero();
+}
+
+bool rate_limiter::acquire(std::size_t nBytes)
+{
+    unique_lock g{lock_};
+    while (!stopped_) {
+        auto d = take(nBytes, clock::now());
+        if (d == clock::duration::zero())
+            return true;
+        cond_.wait_for(g, d);
+    }
+    return false;
+}
+
+bool rate_limiter::submit(std::size_t nBytes, task_type task, int prio /*=1*/)
+{
+    guard g{lock_};
+    if (stopped_)
+        return false;
+
+    que_.push_back(prio, {nBytes, std::move(task)});
+    if (timer_ == 0) {
+        if (!wheel_)
+            wheel_ = timer_wheel::create();
+        timer_ = wheel_->schedule_at(clock::now(), [this] { run(); });
+    }
+    return true;
+}
+
+// The timer runs the operations in order, each once the buckets allow,
+// and is set again for when the next one can go. It stays set while it's
+// running, so that a stop waits it out.
+
+void rate_limiter::run()
+{
+    unique_lock g{lock_};
+
+    while (!stopped_ && !que_.empty()) {
+        auto d = take(que_.front().nBytes, clock::now());
+        if (d != clock::duration::zero()) {
+            timer_ = wheel_->schedule_after(d, [this] { run(); });
+            return;
+        }
+
+        auto task = que_.pop_front().task;
+
+        g.unlock();
+        task(true);
+        g.lock();
+    }
+    timer_ = 0;
+}
+
+lane_weights rate_limiter::get_lane_weights() const
+{
+    guard g{lock_};
+    return que_.get_weights();
+}
+
+void rate_limiter::set_lane_weights(lane_weights weights)
+{
+    guard g{lock_};
+    que_.set_weights(std::move(weights));
+}
+
+std::size_t rate_limiter::queue_size() const
+{
+    guard g{lock_};
+    return que_.size();
+}
+
+double rate_limiter::current_message_rate() const
+{
+    guard g{lock_};
+    decay(clock::now());
+    return msgRate_;
+}
+
+double rate_limiter::current_byte_rate() const
+{
+    guard g{lock_};
+    decay(clock::now());
+    return byteRate_;
+}
+
+bool rate_limiter::stopped() const
+{
+    guard g{lock_};
+    return stopped_;
+}
+
+void rate_limiter::stop()
+{
+    timer_wheel::timer_id timer;
+    {
+        guard g{lock_};
+        stopped_ = true;
+        timer = timer_;
+    }
+    cond_.notify_all();
+
+    if (timer != 0)
+        wheel_->cancel(timer);
+
+    std::vector<pending> que;
+    {
+        guard g{lock_};
+        timer_ = 0;
+        que = que_.take_all();
+    }
+    for (auto& p : que) p.task(false);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,118 @@
+// receive_filter.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/receive_filter.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  						receive_filter::stage
+/////////////////////////////////////////////////////////////////////////////
+
+// The min-interval stage keys the topics by hash, so that checking a
+// message doesn't need a copy of its topic. When the table fills up, the
+// topics whose interval already ran out are forgotten first, since that
+// doesn't change what gets through.
+
+bool receive_filter::stage::keep(std::string_view topic, int qos, time_point now)
+{
+    if (!all && !filt.matches(topic))
+        return true;
+
+    switch (type) {
+        case stage_type::SAMPLE:
+            return count.fetch_add(1, std::memory_order_relaxed) % n == 0;
+
+        case stage_type::MIN_INTERVAL: {
+            auto key = uint64_t(std::hash<std::string_view>{}(topic));
+            guard g{lock};
+            auto it = lastKept.find(key);
+            if (it != lastKept.end()) {
+                if (now - it->second < ival)
+                    return false;
+                it->second = now;
+                return true;
+            }
+
+            if (lastKept.size() >= maxTopics) {
+                for (auto p = lastKept.begin(); p != lastKept.end();)
+                    p = (now - p->second >= ival) ? lastKept.erase(p) : std::next(p);
+                if (lastKept.size() >= maxTopics)
+                    lastKept.clear();
+            }
+            lastKept.emplace(key, now);
+            return true;
+        }
+
+        case stage_type::PREDICATE:
+            return pred(topic, qos);
+    }
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  							receive_filter
+/////////////////////////////////////////////////////////////////////////////
+
+void receive_filter::add_sample(const string& filter, unsigned n)
+{
+    if (n == 0)
+        throw std::invalid_argument("The sample rate can't be zero");
+
+    auto stg = std::make_unique<stage>(stage_type::SAMPLE, filter);
+    stg->n = n;
+    stages_.push_back(std::move(stg));
+}
+
+void receive_filter::add_min_interval(
+    const string& filter, duration ival, std::size_t maxTopics /*=DFLT_MAX_TOPICS*/
+)
+{
+    auto stg = std::make_unique<stage>(stage_type::MIN_INTERVAL, filter);
+    stg->ival = ival;
+    stg->maxTopics = maxTopics;
+    stages_.push_back(std::move(stg));
+    timed_ = true;
+}
+
+void receive_filter::add_predicate(predicate pred, const string& filter /*="#"*/)
+{
+    auto stg = std::make_unique<stage>(stage_type::PREDICATE, filter);
+    stg->pred = std::move(pred);
+    stages_.push_back(std::move(stg));
+}
+
+bool receive_filter::check(std::string_view topic, int qos, time_point now)
+{
+    nChecked_.fetch_add(1, std::memory_order_relaxed);
+
+    for (auto& stg : stages_) {
+        if (!stg->keep(topic, qos, now)) {
+            stg->nDropped.fetch_add(1, std::memory_order_relaxed);
+            nDropped_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,207 @@
+// rpc_client.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/rpc_client.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+rpc_client::rpc_client(async_client& cli, const string& rspTopic, int qos)
+    : cli_{cli},
+      rspTopic_{rspTopic},
+      qos_{qos},
+      wheel_{cli.get_timer_wheel()},
+      link_{std::make_shared<link>()}
+{
+    if (rspTopic_.empty()) {
+        auto clientId = cli_.get_client_id();
+        if (clientId.empty())
+            throw std::invalid_argument("RPC client needs a response topic or a client ID");
+        rspTopic_ = "replies/" + clientId + "/rpc";
+    }
+    link_->cli = this;
+}
+
+rpc_client::~rpc_client()
+{
+    stop();
+
+    std::lock_guard<std::mutex> g{link_->lock};
+    link_->cli = nullptr;
+}
+
+// The correlation data is the ID's bytes, in whatever order the host uses,
+// since the server just sends them back.
+
+binary rpc_client::encode_id(uint64_t id)
+{
+    return binary{reinterpret_cast<const char*>(&id), sizeof(id)};
+}
+
+uint64_t rpc_client::decode_id(const binary& data)
+{
+    uint64_t id = 0;
+    if (data.size() == sizeof(id))
+        std::memcpy(&id, data.data(), sizeof(id));
+    return id;
+}
+
+token_ptr rpc_client::start()
+{
+    return cli_.subscribe(rspTopic_, qos_, [lnk = link_](const_message_ptr msg) {
+        std::lock_guard<std::mutex> g{lnk->lock};
+        if (lnk->cli)
+            lnk->cli->on_response(std::move(msg));
+    });
+}
+
+void rpc_client::stop()
+{
+    std::unordered_map<uint64_t, pending> calls;
+    {
+        guard g{lock_};
+        if (stopped_)
+            return;
+        stopped_ = true;
+        calls.swap(pending_);
+    }
+
+    // This waits out a timeout that's being handled
+    for (auto& call : calls) wheel_->cancel(call.second.timer);
+
+    try {
+        cli_.unsubscribe(rspTopic_);
+    }
+    catch (...) {
+    }
+
+    auto err = std::make_exception_ptr(
+        exception(MQTTASYNC_OPERATION_INCOMPLETE, "RPC client stopped")
+    );
+    for (auto& call : calls) call.second.handler(const_message_ptr{}, err);
+}
+
+// A timeout doesn't touch the object once the call is taken out of the
+// table, and stop() waits out one that's still looking for its call.
+
+void rpc_client::on_timeout(uint64_t id)
+{
+    response_handler handler;
+    {
+        guard g{lock_};
+        auto it = pending_.find(id);
+        if (it == pending_.end())
+            return;
+
+        handler = std::move(it->second.handler);
+        pending_.erase(it);
+        ++nTimeouts_;
+    }
+    handler(const_message_ptr{}, std::make_exception_ptr(timeout_error()));
+}
+
+void rpc_client::on_response(const_message_ptr msg)
+{
+    const auto& props = msg->get_properties();
+    uint64_t id = 0;
+    if (props.contains(property::CORRELATION_DATA))
+        id = decode_id(get<binary>(props, property::CORRELATION_DATA));
+
+    response_handler handler;
+    timer_wheel::timer_id timer;
+    {
+        guard g{lock_};
+        auto it = pending_.find(id);
+        if (it == pending_.end()) {
+            ++nUnmatched_;
+            return;
+        }
+        handler = std::move(it->second.handler);
+        timer = it->second.timer;
+        pending_.erase(it);
+    }
+    wheel_->cancel(timer);
+    handler(std::move(msg), std::exception_ptr{});
+}
+
+void rpc_client::call(
+    const string& topic, binary_ref payload, duration timeout, response_handler handler,
+    const properties& props /*=properties()*/
+)
+{
+    auto deadline = clock::now() + timeout;
+    uint64_t id;
+    {
+        guard g{lock_};
+        if (stopped_)
+            throw exception(MQTTASYNC_OPERATION_INCOMPLETE, "RPC client stopped");
+
+        id = nextId_++;
+        auto timer = wheel_->schedule_at(deadline, [this, id] { on_timeout(id); });
+        pending_.emplace(id, pending{std::move(handler), timer});
+    }
+
+    properties reqProps{props};
+    reqProps.add({property::RESPONSE_TOPIC, rspTopic_});
+    reqProps.add({property::CORRELATION_DATA, encode_id(id)});
+
+    try {
+        cli_.publish(message::create(topic, std::move(payload), qos_, false, reqProps));
+    }
+    catch (...) {
+        timer_wheel::timer_id timer = 0;
+        {
+            guard g{lock_};
+            auto it = pending_.find(id);
+            if (it != pending_.end()) {
+                timer = it->second.timer;
+                pending_.erase(it);
+            }
+        }
+        wheel_->cancel(timer);
+        throw;
+    }
+}
+
+std::future<const_message_ptr> rpc_client::call(
+    const string& topic, binary_ref payload, duration timeout,
+    const properties& props /*=properties()*/
+)
+{
+    auto prom = std::make_shared<std::promise<const_message_ptr>>();
+    auto fut = prom->get_future();
+
+    call(
+        topic, std::move(payload), timeout,
+        [prom](const_message_ptr rsp, std::exception_ptr err) {
+            if (err)
+                prom->set_exception(err);
+            else
+                prom->set_value(std::move(rsp));
+        },
+        props
+    );
+    return fut;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,97 @@
+// rpc_server.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/rpc_server.h"
+
+#include "mqtt/properties.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+rpc_server::rpc_server(
+    async_client& cli, const string& reqFilter, request_handler handler,
+    std::size_t nWorkers /*=0*/, int qos /*=DFLT_QOS*/
+)
+    : cli_{cli},
+      reqFilter_{reqFilter},
+      qos_{qos},
+      handler_{std::move(handler)},
+      disp_{nWorkers, [this](const_message_ptr req) { handle(std::move(req)); }},
+      link_{std::make_shared<link>()}
+{
+    link_->srvr = this;
+}
+
+rpc_server::~rpc_server()
+{
+    {
+        std::lock_guard<std::mutex> g{link_->lock};
+        link_->srvr = nullptr;
+    }
+    stop();
+}
+
+token_ptr rpc_server::start()
+{
+    return cli_.subscribe(reqFilter_, qos_, [lnk = link_](const_message_ptr req) {
+        std::lock_guard<std::mutex> g{lnk->lock};
+        if (lnk->srvr)
+            lnk->srvr->disp_.dispatch(std::move(req));
+    });
+}
+
+void rpc_server::stop()
+{
+    try {
+        cli_.unsubscribe(reqFilter_);
+    }
+    catch (...) {
+    }
+    disp_.stop();
+}
+
+void rpc_server::handle(const_message_ptr req)
+{
+    try {
+        auto payload = handler_(req);
+
+        const auto& props = req->get_properties();
+        if (!props.contains(property::RESPONSE_TOPIC))
+            return;
+
+        properties rspProps;
+        if (props.contains(property::CORRELATION_DATA)) {
+            rspProps.add(
+                {property::CORRELATION_DATA, get<binary>(props, property::CORRELATION_DATA)}
+            );
+        }
+
+        cli_.publish(message::create(
+            get<string>(props, property::RESPONSE_TOPIC), binary_ref{std::move(payload)},
+            req->get_qos(), false, rspProps
+        ));
+        ++nReplies_;
+    }
+    catch (...) {
+        ++nErrors_;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,406 @@
+// shm_fanout.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/shm_fanout.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <thread>
+
+#include "mqtt/exception.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// The shared memory object is a header, followed by the ring of records.
+// Positions in the ring are byte counts that only ever increase, and the
+// offset of a position is that count modulo the capacity. Each record is
+// a header, the topic, and the packed properties, padded out to a
+// multiple of 8 bytes, then the payload, padded the same way, as in a
+// capture file. A record never wraps around the end of the ring: if it
+// doesn't fit, the rest of the ring is skipped, with a padding record if
+// there's room for one.
+//
+// The writer works like a seqlock. Before it touches the ring, it sets
+// 'reserve' to the end of what it's about to write, and once a record is
+// complete, it moves 'head' up to it. A reader copies out what it needs
+// for a record, and then checks 'reserve' to see that the writer didn't
+// reach the record in the meantime.
+
+struct ring_header
+{
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> reserve;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> nMsgs;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory needs lock-free atomics");
+
+struct rec_header
+{
+    uint64_t pos;
+    uint64_t idx;
+    uint32_t size;
+    uint32_t topicLen;
+    uint32_t propsLen;
+    uint32_t payloadLen;
+    uint8_t qos;
+    uint8_t flags;
+    uint16_t reserved1;
+    uint32_t reserved2;
+};
+
+constexpr uint32_t RING_MAGIC = 0x4653514d;  // "MQSF"
+constexpr uint32_t VERSION = 1;
+
+constexpr uint8_t REC_RETAINED = 0x01;
+constexpr uint8_t REC_DUPLICATE = 0x02;
+constexpr uint8_t REC_PADDING = 0x80;
+
+constexpr size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+constexpr size_t RING_HDR_SIZE = (sizeof(ring_header) + 63) & ~size_t(63);
+constexpr size_t REC_HDR_SIZE = sizeof(rec_header);
+
+[[noreturn]] void throw_errno(const string& what) {
+    throw exception(MQTTASYNC_FAILURE, what + ": " + std::strerror(errno));
+}
+
+// The offset of the payload from the start of a record
+size_t payload_offset(const rec_header& hdr) {
+    return align8(REC_HDR_SIZE + size_t(hdr.topicLen) + size_t(hdr.propsLen));
+}
+
+// The size of a whole record
+size_t record_size(const rec_header& hdr) {
+    return align8(payload_offset(hdr) + size_t(hdr.payloadLen));
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//  						shm_fanout_writer
+/////////////////////////////////////////////////////////////////////////////
+
+struct shm_fanout_writer::ring
+{
+    char* base{nullptr};
+    size_t size{0};
+    ring_header* hdr{nullptr};
+    char* data{nullptr};
+    uint64_t cap{0};
+    // The end of the last record, and the index of the next one
+    uint64_t pos{0};
+    uint64_t idx{0};
+
+    ring(const string& name, size_t capacity) {
+        auto pg = size_t(::sysconf(_SC_PAGESIZE));
+        cap = ((std::max(capacity, pg) + pg - 1) / pg) * pg;
+        size = RING_HDR_SIZE + size_t(cap);
+
+        ::shm_unlink(name.c_str());
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0)
+            throw_errno("Error creating shared memory '" + name + "'");
+
+        void* p = MAP_FAILED;
+        if (::ftruncate(fd, off_t(size)) == 0)
+            p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (p == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            throw_errno("Error mapping shared memory '" + name + "'");
+        }
+
+        base = static_cast<char*>(p);
+        data = base + RING_HDR_SIZE;
+
+        // The magic number goes in last, so a reader never sees the
+        // header before it's set up.
+        hdr = new (base) ring_header{};
+        hdr->version = VERSION;
+        hdr->capacity = cap;
+        hdr->magic.store(RING_MAGIC, std::memory_order_release);
+    }
+
+    ~ring() { ::munmap(base, size); }
+
+    ring(const ring&) = delete;
+    ring& operator=(const ring&) = delete;
+};
+
+shm_fanout_writer::shm_fanout_writer(const string& name, size_t capacity /*=DFLT_CAPACITY*/)
+    : name_{name}, ring_{std::make_unique<ring>(name, capacity)}
+{
+}
+
+shm_fanout_writer::~shm_fanout_writer() { ::shm_unlink(name_.c_str()); }
+
+bool shm_fanout_writer::write(const message& msg)
+{
+    const auto& topic = msg.get_topic_ref();
+    const auto& payload = msg.get_payload_ref();
+    const auto& props = msg.get_properties();
+
+    rec_header hdr{};
+    hdr.topicLen = uint32_t(topic.size());
+    hdr.propsLen = uint32_t(props.empty() ? 0 : props.packed_size());
+    hdr.payloadLen = uint32_t(payload.size());
+    hdr.qos = uint8_t(msg.get_qos());
+    hdr.flags = uint8_t(
+        (msg.is_retained() ? REC_RETAINED : 0) | (msg.is_duplicate() ? REC_DUPLICATE : 0)
+    );
+
+    auto payOff = payload_offset(hdr);
+    auto recSize = record_size(hdr);
+
+    guard g{lock_};
+    auto& r = *ring_;
+
+    if (recSize > r.cap) {
+        ++nDropped_;
+        return false;
+    }
+
+    uint64_t off = r.pos % r.cap, padLen = 0;
+    if (off + recSize > r.cap)
+        padLen = r.cap - off;
+
+    const uint64_t end = r.pos + padLen + recSize;
+    r.hdr->reserve.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (padLen >= REC_HDR_SIZE) {
+        rec_header pad{};
+        pad.pos = r.pos;
+        pad.idx = r.idx;
+        pad.size = uint32_t(padLen);
+        pad.flags = REC_PADDING;
+        std::memcpy(r.data + off, &pad, REC_HDR_SIZE);
+    }
+
+    hdr.pos = r.pos + padLen;
+    hdr.idx = r.idx;
+    hdr.size = uint32_t(recSize);
+
+    char* p = r.data + (hdr.pos % r.cap);
+    std::memcpy(p, &hdr, REC_HDR_SIZE);
+    if (hdr.topicLen)
+        std::memcpy(p + REC_HDR_SIZE, topic.data(), hdr.topicLen);
+    if (hdr.propsLen)
+        props.pack(p + REC_HDR_SIZE + hdr.topicLen);
+    if (hdr.payloadLen)
+        std::memcpy(p + payOff, payload.data(), hdr.payloadLen);
+
+    r.pos = end;
+    ++r.idx;
+    r.hdr->nMsgs.store(r.idx, std::memory_order_relaxed);
+    r.hdr->head.store(end, std::memory_order_release);
+    return true;
+}
+
+size_t shm_fanout_writer::capacity() const { return size_t(ring_->cap); }
+
+uint64_t shm_fanout_writer::num_written() const
+{
+    guard g{lock_};
+    return ring_->idx;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  						shm_fanout_reader
+/////////////////////////////////////////////////////////////////////////////
+
+struct shm_fanout_reader::mapping
+{
+    const char* base{nullptr};
+    size_t size{0};
+    const ring_header* hdr{nullptr};
+    const char* data{nullptr};
+    uint64_t cap{0};
+
+    explicit mapping(const string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            throw_errno("Error opening shared memory '" + name + "'");
+
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && size_t(st.st_size) >= RING_HDR_SIZE) {
+            size = size_t(st.st_size);
+            p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+
+        if (p == MAP_FAILED)
+            throw exception(MQTTASYNC_FAILURE, "Error mapping shared memory '" + name + "'");
+
+        base = static_cast<const char*>(p);
+        hdr = reinterpret_cast<const ring_header*>(base);
+        data = base + RING_HDR_SIZE;
+        cap = hdr->capacity;
+
+        if (hdr->magic.load(std::memory_order_acquire) != RING_MAGIC ||
+            hdr->version != VERSION || cap == 0 || RING_HDR_SIZE + cap > size) {
+            ::munmap(const_cast<char*>(base), size);
+            throw exception(MQTTASYNC_FAILURE, "Not a fan-out ring: '" + name + "'");
+        }
+    }
+
+    ~mapping() { ::munmap(const_cast<char*>(base), size); }
+
+    mapping(const mapping&) = delete;
+    mapping& operator=(const mapping&) = delete;
+};
+
+shm_fanout_reader::shm_fanout_reader(const string& name)
+    : map_{std::make_shared<mapping>(name)}
+{
+    pos_ = map_->hdr->head.load(std::memory_order_acquire);
+    nextIdx_ = map_->hdr->nMsgs.load(std::memory_order_relaxed);
+}
+
+void shm_fanout_reader::add_filter(const string& filter)
+{
+    filters_.insert({filter, true});
+    compiled_ = filters_.freeze();
+}
+
+// The messages that were skipped are counted from the index of the next
+// record that's read.
+
+void shm_fanout_reader::skip_to(uint64_t pos) { pos_ = pos; }
+
+bool shm_fanout_reader::intact(uint64_t pos) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return map_->hdr->reserve.load(std::memory_order_relaxed) <= pos + map_->cap;
+}
+
+size_t shm_fanout_reader::poll(const handler& cb, size_t maxN /*=npos*/)
+{
+    const auto& m = *map_;
+    size_t n = 0;
+
+    uint64_t head = m.hdr->head.load(std::memory_order_acquire);
+    if (head - pos_ > m.cap)
+        skip_to(head);
+
+    while (n < maxN && pos_ < head) {
+        uint64_t off = pos_ % m.cap;
+        if (m.cap - off < REC_HDR_SIZE) {
+            pos_ += m.cap - off;
+            continue;
+        }
+
+        const char* p = m.data + off;
+        rec_header hdr;
+        std::memcpy(&hdr, p, REC_HDR_SIZE);
+
+        bool padding = (hdr.flags & REC_PADDING) != 0;
+        if (!intact(pos_) || hdr.pos != pos_ || hdr.size == 0 || hdr.size > m.cap - off ||
+            (!padding && record_size(hdr) != hdr.size)) {
+            head = m.hdr->head.load(std::memory_order_acquire);
+            skip_to(head);
+            break;
+        }
+
+        if (padding) {
+            pos_ += hdr.size;
+            continue;
+        }
+
+        if (hdr.idx > nextIdx_)
+            nLost_ += hdr.idx - nextIdx_;
+        nextIdx_ = hdr.idx + 1;
+
+        std::string_view topic{p + REC_HDR_SIZE, hdr.topicLen};
+        if (!compiled_.empty() && !(compiled_.matches(topic) != compiled_.matches_end())) {
+            ++nFiltered_;
+            pos_ += hdr.size;
+            continue;
+        }
+
+        properties props;
+        if (hdr.propsLen)
+            props = properties::unpack(p + REC_HDR_SIZE + hdr.topicLen, hdr.propsLen);
+
+        auto msg = message::create(
+            string_ref{map_, p + REC_HDR_SIZE, hdr.topicLen},
+            binary_ref{map_, p + payload_offset(hdr), hdr.payloadLen}, hdr.qos,
+            (hdr.flags & REC_RETAINED) != 0, props
+        );
+        msg->set_duplicate((hdr.flags & REC_DUPLICATE) != 0);
+
+        if (!intact(pos_)) {
+            ++nLost_;
+            head = m.hdr->head.load(std::memory_order_acquire);
+            skip_to(head);
+            break;
+        }
+
+        pos_ += hdr.size;
+        ++nRead_;
+        ++n;
+        cb(std::move(msg));
+    }
+    return n;
+}
+
+// While there's nothing to read, the sleep between polls starts short, for
+// a busy feed, and backs off to a millisecond, for an idle one.
+
+size_t shm_fanout_reader::poll_until(
+    const handler& cb, std::chrono::steady_clock::time_point absTime, size_t maxN /*=npos*/
+)
+{
+    using namespace std::chrono;
+    auto nap = microseconds(50);
+
+    while (true) {
+        size_t n = poll(cb, maxN);
+        if (n > 0 || steady_clock::now() >= absTime)
+            return n;
+        std::this_thread::sleep_for(nap);
+        nap = std::min(nap * 2, duration_cast<microseconds>(milliseconds(1)));
+    }
+}
+
+uint64_t shm_fanout_reader::lag() const
+{
+    return map_->hdr->head.load(std::memory_order_acquire) - pos_;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -18,6 +18,8 @@
 
 #include "mqtt/string_collection.h"
 
+#include <utility>
+
 namespace mqtt {
 
 /////////////////////////////////////////////////////////////////////////////
@@ -67,16 +69,38 @@ string_collection& string_collection::operator=(const string_collection& coll)
     return *this;
 }
 
+// Moving the strings when the vector is reallocated can move the data of
+// short strings, so the C pointers are only appended when the strings stay
+// in place, and rebuilt otherwise. The vector grows geometrically, so the
+// rebuilds are amortized.
+
+void string_collection::reserve(size_t n)
+{
+    auto cap = coll_.capacity();
+    coll_.reserve(n);
+    cArr_.reserve(n);
+    if (coll_.capacity() != cap)
+        update_c_arr();
+}
+
 void string_collection::push_back(const string& str)
 {
+    auto cap = coll_.capacity();
     coll_.push_back(str);
-    update_c_arr();
+    if (coll_.capacity() == cap)
+        cArr_.push_back(coll_.back().c_str());
+    else
+        update_c_arr();
 }
 
 void string_collection::push_back(string&& str)
 {
-    coll_.push_back(str);
-    update_c_arr();
+    auto cap = coll_.capacity();
+    coll_.push_back(std::move(str));
+    if (coll_.capacity() == cap)
+        cArr_.push_back(coll_.back().c_str());
+    else
+        update_c_arr();
 }
 
 void string_collection::clear()
@@ -0,0 +1,118 @@
+// thread_options.cpp
+//
+// Implementation of the thread_options class for the Paho MQTT C++
+// library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/thread_options.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+string thread_role_name(thread_role role)
+{
+    switch (role) {
+        case thread_role::CLIENT_CALLBACK:
+            return "mqtt-callback";
+        case thread_role::RECONNECT:
+            return "mqtt-reconnect";
+        case thread_role::SYNC_CALLBACK:
+            return "mqtt-sync-cb";
+    }
+    return "mqtt";
+}
+
+bool set_current_thread_name(const string& name)
+{
+#if defined(__linux__)
+    return ::pthread_setname_np(::pthread_self(), name.substr(0, 15).c_str()) == 0;
+#elif defined(__APPLE__)
+    return ::pthread_setname_np(name.c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+bool set_current_thread_affinity(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+            return false;
+        CPU_SET(cpu, &set);
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+bool set_current_thread_priority(int prio)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    sched_param param{};
+    param.sched_priority = prio;
+    return ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    (void)prio;
+    return false;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  							thread_options
+/////////////////////////////////////////////////////////////////////////////
+
+// The settings are best effort. A thread that can't be pinned, or given
+// a priority, still runs.
+
+void thread_options::apply(thread_role role) const
+{
+    auto name = thread_role_name(role);
+
+    if (nameThreads_)
+        set_current_thread_name(name);
+
+    if (!affinity_.empty())
+        set_current_thread_affinity(affinity_);
+
+    if (priority_ != 0)
+        set_current_thread_priority(priority_);
+
+    if (startHandler_) {
+        try {
+            startHandler_(role, name);
+        }
+        catch (...) {
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,256 @@
+// timer_wheel.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace mqtt {
+
+constexpr timer_wheel::duration timer_wheel::DFLT_TICK;
+
+/////////////////////////////////////////////////////////////////////////////
+
+timer_wheel::timer_wheel(duration tick /*=DFLT_TICK*/)
+    : tick_{std::max(tick, duration{1})}, start_{clock::now()}
+{
+    thr_ = std::thread(&timer_wheel::run, this);
+}
+
+timer_wheel::~timer_wheel() { stop(); }
+
+uint64_t timer_wheel::tick_of(clock::time_point tp) const
+{
+    return (tp <= start_) ? 0 : uint64_t((tp - start_) / tick_);
+}
+
+// A timer goes in the lowest wheel that reaches its tick, in the slot for
+// its digit in that wheel. One past the reach of the top wheel rides in
+// its farthest slot, and is put back when that slot comes around.
+
+void timer_wheel::insert(const entry& e)
+{
+    auto delta = (e.tick > now_) ? e.tick - now_ : 0;
+    auto tick = e.tick;
+
+    size_t level = 0;
+    while (level < N_LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+        ++level;
+
+    auto span = uint64_t(1) << (SLOT_BITS * N_LEVELS);
+    if (delta >= span)
+        tick = now_ + span - 1;
+
+    auto slot = (tick >> (SLOT_BITS * level)) & (N_SLOTS - 1);
+    slots_[level][slot].push_back(e);
+    ++levelCount_[level];
+}
+
+void timer_wheel::cascade(size_t level)
+{
+    auto slot = (now_ >> (SLOT_BITS * level)) & (N_SLOTS - 1);
+
+    std::vector<entry> entries;
+    entries.swap(slots_[level][slot]);
+    levelCount_[level] -= entries.size();
+
+    for (const auto& e : entries) {
+        if (timers_.count(e.id))
+            insert(e);
+    }
+}
+
+// The ticks with nothing in the first wheel are skipped, up to the next
+// turn of the wheel, when the ones above may have something to spread
+// down into it.
+
+void timer_wheel::advance(uint64_t target, std::vector<timer_id>& due)
+{
+    if (timers_.empty()) {
+        for (size_t level = 0; level < N_LEVELS; ++level) {
+            if (levelCount_[level] != 0) {
+                for (auto& slot : slots_[level]) slot.clear();
+                levelCount_[level] = 0;
+            }
+        }
+        now_ = std::max(now_, target);
+        return;
+    }
+
+    auto mask = uint64_t(N_SLOTS - 1);
+
+    while (now_ < target) {
+        if (levelCount_[0] == 0)
+            now_ = std::min(target, (now_ | mask) + 1) - 1;
+
+        ++now_;
+
+        // Spread the upper wheels down, from the top, at each of their turns
+        size_t top = 0;
+        while (top < N_LEVELS - 1 &&
+               (now_ & ((uint64_t(1) << (SLOT_BITS * (top + 1))) - 1)) == 0)
+            ++top;
+        for (size_t level = top; level > 0; --level) cascade(level);
+
+        auto& slot = slots_[0][now_ & mask];
+        if (slot.empty())
+            continue;
+
+        std::vector<entry> entries;
+        entries.swap(slot);
+        levelCount_[0] -= entries.size();
+
+        auto first = due.size();
+        for (const auto& e : entries) {
+            if (!timers_.count(e.id))
+                continue;
+            if (e.tick <= now_)
+                due.push_back(e.id);
+            else
+                insert(e);
+        }
+
+        std::sort(due.begin() + first, due.end(), [this](timer_id a, timer_id b) {
+            const auto &ta = timers_[a], &tb = timers_[b];
+            return ta.deadline != tb.deadline ? ta.deadline < tb.deadline : a < b;
+        });
+    }
+}
+
+uint64_t timer_wheel::next_tick() const
+{
+    auto mask = uint64_t(N_SLOTS - 1);
+    auto turn = (now_ | mask) + 1;
+
+    if (levelCount_[0] != 0) {
+        for (auto t = now_ + 1; t < turn; ++t) {
+            if (!slots_[0][t & mask].empty())
+                return t;
+        }
+    }
+    return turn;
+}
+
+// The timers are looked up again as they're run, so that one that's
+// cancelled by an earlier one in the same tick doesn't run.
+
+void timer_wheel::run()
+{
+    unique_guard g{lock_};
+    std::vector<timer_id> due;
+
+    while (!stop_) {
+        advance(tick_of(clock::now()), due);
+
+        for (auto id : due) {
+            auto it = timers_.find(id);
+            if (it == timers_.end())
+                continue;
+
+            auto task = std::move(it->second.task);
+            timers_.erase(it);
+            running_ = id;
+            ++nFired_;
+
+            g.unlock();
+            try {
+                task();
+            }
+            catch (...) {
+            }
+            task = task_type{};
+            g.lock();
+
+            running_ = 0;
+            doneCond_.notify_all();
+            if (stop_)
+                break;
+        }
+        due.clear();
+
+        if (stop_)
+            break;
+
+        if (timers_.empty()) {
+            nextWake_ = std::numeric_limits<uint64_t>::max();
+            cond_.wait(g, [this] { return stop_ || !timers_.empty(); });
+        }
+        else {
+            nextWake_ = next_tick();
+            cond_.wait_until(g, time_of(nextWake_));
+        }
+        nextWake_ = 0;
+    }
+}
+
+timer_wheel::timer_id timer_wheel::schedule_at(clock::time_point deadline, task_type task)
+{
+    bool notify;
+    timer_id id;
+    {
+        guard g{lock_};
+        if (stop_)
+            return 0;
+
+        // The deadline is rounded up to a tick, and at the earliest, the
+        // next one, since the thread is done with this one.
+        auto tick = tick_of(deadline);
+        if (time_of(tick) < deadline)
+            ++tick;
+        tick = std::max(tick, now_ + 1);
+
+        id = nextId_++;
+        timers_.emplace(id, timer{deadline, std::move(task)});
+        insert(entry{id, tick});
+        notify = tick < nextWake_;
+    }
+    if (notify)
+        cond_.notify_one();
+    return id;
+}
+
+bool timer_wheel::cancel(timer_id id)
+{
+    unique_guard g{lock_};
+    if (timers_.erase(id) != 0)
+        return true;
+
+    if (id != 0 && std::this_thread::get_id() != thr_.get_id())
+        doneCond_.wait(g, [this, id] { return running_ != id; });
+    return false;
+}
+
+void timer_wheel::stop()
+{
+    std::thread thr;
+    std::unordered_map<timer_id, timer> timers;
+    {
+        guard g{lock_};
+        stop_ = true;
+        thr = std::move(thr_);
+        timers.swap(timers_);
+    }
+    cond_.notify_all();
+
+    if (thr.joinable())
+        thr.join();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
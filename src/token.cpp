@@ -23,6 +23,7 @@
 #include <iostream>
 
 #include "mqtt/async_client.h"
+#include "mqtt/probes.h"
 
 namespace mqtt {
 
@@ -111,7 +112,8 @@ void token::on_failure5(void* context, MQTTAsync_failureData5* rsp)
 void token::on_success(MQTTAsync_successData* rsp)
 {
     unique_lock g(lock_);
-    iaction_listener* listener = listener_;
+    if (drop_if_timed_out(g))
+        return;
 
     if (rsp) {
         msgId_ = rsp->token;
@@ -136,15 +138,8 @@ void token::on_success(MQTTAsync_successData* rsp)
     }
 
     rc_ = MQTTASYNC_SUCCESS;
-    complete_ = true;
-    g.unlock();
-
-    // Note: callback always completes before the object is signaled.
-    if (listener)
-        listener->on_success(*this);
-    cond_.notify_all();
-
-    cli_->remove_token(this);
+    PAHO_MQTTPP_PROBE2(token_success, int(type_), msgId_);
+    complete(g, true);
 }
 
 //
@@ -153,7 +148,8 @@ void token::on_success(MQTTAsync_successData* rsp)
 void token::on_success5(MQTTAsync_successData5* rsp)
 {
     unique_lock g(lock_);
-    iaction_listener* listener = listener_;
+    if (drop_if_timed_out(g))
+        return;
     if (rsp) {
         msgId_ = rsp->token;
         reasonCode_ = ReasonCode(rsp->reasonCode);
@@ -177,15 +173,8 @@ void token::on_success5(MQTTAsync_successData5* rsp)
         }
     }
     rc_ = MQTTASYNC_SUCCESS;
-    complete_ = true;
-    g.unlock();
-
-    // Note: callback always completes before the object is signaled.
-    if (listener)
-        listener->on_success(*this);
-    cond_.notify_all();
-
-    cli_->remove_token(this);
+    PAHO_MQTTPP_PROBE2(token_success, int(type_), msgId_);
+    complete(g, true);
 }
 
 //
@@ -194,7 +183,8 @@ void token::on_success5(MQTTAsync_successData5* rsp)
 void token::on_failure(MQTTAsync_failureData* rsp)
 {
     unique_lock g(lock_);
-    iaction_listener* listener = listener_;
+    if (drop_if_timed_out(g))
+        return;
     if (rsp) {
         msgId_ = rsp->token;
         rc_ = rsp->code;
@@ -206,15 +196,10 @@ void token::on_failure(MQTTAsync_failureData* rsp)
     else {
         rc_ = -1;
     }
-    complete_ = true;
-    g.unlock();
-
-    // Note: callback always completes before the object is signaled.
-    if (listener)
-        listener->on_failure(*this);
-    cond_.notify_all();
-
-    cli_->remove_token(this);
+    PAHO_MQTTPP_PROBE3(token_failure, int(type_), msgId_, rc_);
+    if (type_ == Type::PUBLISH && retry(g))
+        return;
+    complete(g, false);
 }
 
 //
@@ -223,7 +208,8 @@ void token::on_failure(MQTTAsync_failureData* rsp)
 void token::on_failure5(MQTTAsync_failureData5* rsp)
 {
     unique_lock g(lock_);
-    iaction_listener* listener = listener_;
+    if (drop_if_timed_out(g))
+        return;
     if (rsp) {
         msgId_ = rsp->token;
         reasonCode_ = ReasonCode(rsp->reasonCode);
@@ -234,17 +220,126 @@ void token::on_failure5(MQTTAsync_failureData5* rsp)
     else {
         rc_ = -1;
     }
+    PAHO_MQTTPP_PROBE3(token_failure, int(type_), msgId_, rc_);
+    if (type_ == Type::PUBLISH && retry(g))
+        return;
+    complete(g, false);
+}
+
+//
+// A failed publish may be sent again by the client, in which case the
+// token stays incomplete. The lock is dropped while the client decides,
+// since it may send the message right away.
+//
+bool token::retry(unique_lock& g)
+{
+    int rc = rc_;
+    ReasonCode reason = reasonCode_;
+    g.unlock();
+
+    if (cli_->retry_delivery(*this, rc, reason))
+        return true;
+
+    g.lock();
+    return false;
+}
+
+//
+// Marks the action complete, and runs the callbacks. Normally this is all
+// done right away, on the library's thread, but if the client has a
+// completion executor, the waiting threads are signaled here while the
+// callbacks, and the removal of the token, are handed to the executor.
+// The client's table keeps the token alive until it's removed.
+//
+// A token that timed out was completed without leaving the client, which
+// keeps it alive for the library's callback, so it's only removed now.
+
+bool token::drop_if_timed_out(unique_lock& g)
+{
+    if (!timedOut_)
+        return false;
+    g.unlock();
+    cli_->remove_token(this);
+    return true;
+}
+
+// The deadline is run from the client's timer wheel, which holds a
+// reference to the token, so the callbacks are made right there, rather
+// than handed to the completion executor.
+
+bool token::expire()
+{
+    unique_lock g(lock_);
+    if (complete_)
+        return false;
+
+    rc_ = MQTTASYNC_FAILURE;
+    reasonCode_ = ReasonCode::SUCCESS;
+    errMsg_ = "Timeout";
+    timedOut_ = true;
+    PAHO_MQTTPP_PROBE3(token_failure, int(type_), msgId_, rc_);
+
     complete_ = true;
+    auto cv = cond_.get();
+    iaction_listener* listener = listener_;
+    auto handler = std::move(completeHandler_);
     g.unlock();
 
-    // Note: callback always completes before the object is signaled.
     if (listener)
         listener->on_failure(*this);
-    cond_.notify_all();
+    if (cv)
+        cv->notify_all();
+    if (handler)
+        handler();
+    return true;
+}
+
+void token::complete(unique_lock& g, bool success)
+{
+    complete_ = true;
+    auto cv = cond_.get();
+    iaction_listener* listener = listener_;
+    auto handler = std::move(completeHandler_);
+    g.unlock();
+
+    if (auto exec = cli_->get_completion_executor()) {
+        if (cv)
+            cv->notify_all();
+
+        auto done = [this, listener, handler = std::move(handler), success] {
+            if (listener) {
+                if (success)
+                    listener->on_success(*this);
+                else
+                    listener->on_failure(*this);
+            }
+            if (handler)
+                handler();
+            cli_->remove_token(this);
+        };
+
+        if (!exec->execute(done))
+            done();
+        return;
+    }
+
+    // Note: callback always completes before the object is signaled.
+    if (listener) {
+        if (success)
+            listener->on_success(*this);
+        else
+            listener->on_failure(*this);
+    }
+    if (cv)
+        cv->notify_all();
+    if (handler)
+        handler();
 
     cli_->remove_token(this);
 }
 
+wait_strategy token::get_wait_strategy() const { return cli_->get_wait_strategy(); }
+
 // --------------------------------------------------------------------------
 // API
 
@@ -252,6 +347,7 @@ void token::reset()
 {
     guard g(lock_);
     complete_ = false;
+    timedOut_ = false;
     rc_ = MQTTASYNC_SUCCESS;
     reasonCode_ = ReasonCode::SUCCESS;
     errMsg_.clear();
@@ -272,10 +368,20 @@ void token::set_action_callback(iaction_listener& listener)
     }
 }
 
+bool token::set_complete_handler(complete_handler cb)
+{
+    guard g{lock_};
+    if (complete_)
+        return false;
+    completeHandler_ = std::move(cb);
+    return true;
+}
+
 void token::wait()
 {
+    const auto ws = get_wait_strategy();
     unique_lock g(lock_);
-    cond_.wait(g, [this] { return complete_; });
+    wait_complete(ws, g);
     check_ret();
 }
 
@@ -284,8 +390,9 @@ connect_response token::get_connect_response() const
     if (type_ != Type::CONNECT)
         throw bad_cast();
 
+    const auto ws = get_wait_strategy();
     unique_lock g(lock_);
-    cond_.wait(g, [this] { return complete_; });
+    wait_complete(ws, g);
     check_ret();
 
     if (!connRsp_)
@@ -299,8 +406,9 @@ subscribe_response token::get_subscribe_response() const
     if (type_ != Type::SUBSCRIBE)
         throw bad_cast();
 
+    const auto ws = get_wait_strategy();
     unique_lock g(lock_);
-    cond_.wait(g, [this] { return complete_; });
+    wait_complete(ws, g);
     check_ret();
 
     if (!subRsp_)
@@ -314,8 +422,9 @@ unsubscribe_response token::get_unsubscribe_response() const
     if (type_ != Type::UNSUBSCRIBE)
         throw bad_cast();
 
+    const auto ws = get_wait_strategy();
     unique_lock g(lock_);
-    cond_.wait(g, [this] { return complete_; });
+    wait_complete(ws, g);
     check_ret();
 
     if (!unsubRsp_)
@@ -0,0 +1,172 @@
+// token_group.cpp
+//
+// Implementation of the token_group class for the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/token_group.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+// The handler of each token only captures a pointer to the state and a
+// pointer to the token, so that it fits in the small buffer of the
+// std::function and adding a token doesn't allocate. The state is then
+// freed by whichever of the group or the last pending token is done with
+// it last.
+
+struct token_group::state
+{
+    std::mutex lock;
+    std::condition_variable cond;
+    std::size_t nAdded{0};
+    std::size_t nDone{0};
+    std::size_t nFailed{0};
+    int nAnyWaiters{0};
+    bool orphaned{false};
+    int firstRc{MQTTASYNC_SUCCESS};
+    ReasonCode firstReason{ReasonCode::SUCCESS};
+    string firstErr;
+};
+
+token_group::token_group() : st_{new state} {}
+
+token_group::~token_group()
+{
+    bool last;
+    {
+        guard g{st_->lock};
+        last = (st_->nDone == st_->nAdded);
+        st_->orphaned = true;
+    }
+    if (last)
+        delete st_;
+}
+
+void token_group::on_complete(state* st, const token& tok)
+{
+    int rc = tok.get_return_code();
+    bool last = false;
+    {
+        guard g{st->lock};
+        if (rc != MQTTASYNC_SUCCESS && st->nFailed++ == 0) {
+            st->firstRc = rc;
+            st->firstReason = tok.get_reason_code();
+            st->firstErr = tok.get_error_message();
+        }
+        bool all = (++st->nDone == st->nAdded);
+
+        // Once orphaned, nothing waits on the state, and the last one out
+        // frees it. Otherwise the notify is under the lock so the group
+        // can't go away in the middle of it.
+        if (st->orphaned)
+            last = all;
+        else if (all || st->nAnyWaiters > 0)
+            st->cond.notify_all();
+    }
+    if (last)
+        delete st;
+}
+
+std::mutex& token_group::lock() const { return st_->lock; }
+
+std::condition_variable& token_group::cond() const { return st_->cond; }
+
+bool token_group::all_done() const { return st_->nDone == st_->nAdded; }
+
+bool token_group::any_done() const { return st_->nDone != 0 || st_->nAdded == 0; }
+
+void token_group::any_waiter(int delta) { st_->nAnyWaiters += delta; }
+
+void token_group::add(const token_ptr& tok)
+{
+    if (!tok)
+        return;
+
+    {
+        guard g{st_->lock};
+        ++st_->nAdded;
+    }
+
+    auto st = st_;
+    auto ptok = tok.get();
+
+    if (!tok->set_complete_handler([st, ptok] { on_complete(st, *ptok); }))
+        on_complete(st, *tok);
+}
+
+std::size_t token_group::size() const
+{
+    guard g{st_->lock};
+    return st_->nAdded;
+}
+
+std::size_t token_group::num_complete() const
+{
+    guard g{st_->lock};
+    return st_->nDone;
+}
+
+std::size_t token_group::num_pending() const
+{
+    guard g{st_->lock};
+    return st_->nAdded - st_->nDone;
+}
+
+std::size_t token_group::num_failed() const
+{
+    guard g{st_->lock};
+    return st_->nFailed;
+}
+
+int token_group::get_first_return_code() const
+{
+    guard g{st_->lock};
+    return st_->firstRc;
+}
+
+ReasonCode token_group::get_first_reason_code() const
+{
+    guard g{st_->lock};
+    return st_->firstReason;
+}
+
+string token_group::get_first_error_message() const
+{
+    guard g{st_->lock};
+    return st_->firstErr;
+}
+
+void token_group::wait_all()
+{
+    unique_lock g{st_->lock};
+    st_->cond.wait(g, [this] { return all_done(); });
+}
+
+std::size_t token_group::wait_any()
+{
+    unique_lock g{st_->lock};
+    ++st_->nAnyWaiters;
+    st_->cond.wait(g, [this] { return any_done(); });
+    --st_->nAnyWaiters;
+    return st_->nDone;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
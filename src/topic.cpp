@@ -31,20 +31,11 @@ namespace mqtt {
 // This is just a string split around '/'
 std::vector<string> topic::split(const string& s)
 {
+    topic_levels levels{s};
     std::vector<std::string> v;
+    v.reserve(levels.size());
 
-    if (s.empty())
-        return v;
-
-    const auto delim = '/';
-    string::size_type startPos = 0, pos;
-
-    do {
-        pos = s.find(delim, startPos);
-        auto n = (pos == string::npos) ? pos : (pos - startPos);
-        v.push_back(s.substr(startPos, n));
-        startPos = pos + 1;
-    } while (pos != string::npos);
+    for (size_t i = 0; i < levels.size(); ++i) v.emplace_back(levels.level(s, i));
 
     return v;
 }
@@ -74,11 +65,59 @@ token_ptr topic::subscribe(const subscribe_options& opts)
     return cli_.subscribe(name_, qos_, opts);
 }
 
+prepared_publisher topic::prepare(const properties& props /*=properties()*/) const
+{
+    return prepared_publisher{cli_, name_, qos_, retained_, props};
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  						prepared_publisher
+/////////////////////////////////////////////////////////////////////////////
+
+prepared_publisher::prepared_publisher(
+    iasync_client& cli, string_ref topic, int qos /*=message::DFLT_QOS*/,
+    bool retained /*=message::DFLT_RETAINED*/, const properties& props /*=properties()*/
+)
+    : cli_{cli},
+      asyncCli_{dynamic_cast<async_client*>(&cli)},
+      topic_{std::move(topic)},
+      qos_{qos},
+      retained_{retained},
+      props_{props}
+{
+    message::validate_qos(qos_);
+}
+
+delivery_token_ptr prepared_publisher::publish(binary_ref payload)
+{
+    return cli_.publish(make_message(std::move(payload)));
+}
+
+delivery_token_ptr prepared_publisher::publish(const void* payload, size_t n)
+{
+    return cli_.publish(message::create(topic_, payload, n, qos_, retained_, props_));
+}
+
+void prepared_publisher::send(const void* payload, size_t n)
+{
+    if (qos_ == 0 && asyncCli_)
+        asyncCli_->publish_qos0(topic_.str(), payload, n, retained_, props_);
+    else
+        publish(payload, n);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //  						topic_filter
 /////////////////////////////////////////////////////////////////////////////
 
-topic_filter::topic_filter(const string& filter) : fields_(topic::split(filter)) {}
+// The filter is split into fields once, here, but only if it has
+// wildcards. Otherwise it's matched as a plain string.
+
+topic_filter::topic_filter(const string& filter) : filter_{filter}
+{
+    if (has_wildcards(filter_))
+        fields_ = topic_levels{filter_};
+}
 
 bool topic_filter::has_wildcards(const string& filter)
 {
@@ -94,53 +133,43 @@ bool topic_filter::has_wildcards(const string& filter)
     return filter.find('+') != string::npos;
 }
 
-bool topic_filter::has_wildcards() const
-{
-    return std::any_of(fields_.cbegin(), fields_.cend(), [](const auto& f) {
-        return is_wildcard(f);
-    });
-}
+bool topic_filter::has_wildcards() const { return !fields_.empty(); }
 
 // See if the topic matches this filter.
-// OPTIMIZE: If the filter string doesn't contain any wildcards, then a
-// match is a simple string comparison. We wouldn't need to split the filter
-// or topic into fields.
-bool topic_filter::matches(const string& topic) const
-{
-    auto n = fields_.size();
-
-    auto topic_fields = topic::split(topic);
-    auto nt = topic_fields.size();
+// Without wildcards, a match is a simple string comparison. Otherwise the
+// topic is split into levels, without copying, and they're compared to the
+// fields of the filter. An empty topic has no levels.
 
-    // Filter can't match a topic that is shorter
-    if (n > nt) {
-        return false;
-    }
-
-    // Might match a longer topic, but only with '#' wildcard
-    if (n < nt && fields_[n - 1] != "#") {
-        return false;
-    }
+bool topic_filter::matches(std::string_view topic) const
+{
+    if (fields_.empty())
+        return topic == filter_;
 
     // Topics starting with '$' don't match wildcards in the first field
     // MQTT v5 Spec, Section 4.7.2:
     // https://docs.oasis-open.org/mqtt/mqtt/v5.0/os/mqtt-v5.0-os.html#_Toc3901246
 
-    if (n > 0 && is_wildcard(fields_[0]) && nt > 0 && topic_fields[0].size() > 0 &&
-        topic_fields[0][0] == '$') {
+    if (is_wildcard(field_view(0)) && !topic.empty() && topic[0] == '$')
         return false;
-    }
+
+    topic_levels levels{topic};
+    auto n = fields_.size(), nt = levels.size();
 
     for (size_t i = 0; i < n; ++i) {
-        if (fields_[i] == "#") {
-            break;
-        }
-        if (fields_[i] != "+" && fields_[i] != topic_fields[i]) {
+        // Every field of the filter needs a field in the topic
+        if (i == nt)
+            return false;
+
+        auto fld = field_view(i);
+        if (fld == "#")
+            return true;
+
+        if (fld != "+" && fld != levels.level(topic, i))
             return false;
-        }
     }
 
-    return true;
+    // The topic can't have more fields than the filter
+    return n == nt;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,68 @@
+// topic_alias_manager.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/topic_alias_manager.h"
+
+#include <iterator>
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+
+// A topic that takes over the alias of another one must set it up with the
+// server again, so it starts out not established.
+
+topic_alias_manager::entry& topic_alias_manager::lookup(const string& topic)
+{
+    if (auto it = index_.find(std::string_view{topic}); it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return lru_.front();
+    }
+
+    if (lru_.size() < max_) {
+        lru_.push_front({topic, uint16_t(lru_.size() + 1), false});
+    }
+    else {
+        auto it = std::prev(lru_.end());
+        index_.erase(std::string_view{it->topic});
+        it->topic = topic;
+        it->established = false;
+        lru_.splice(lru_.begin(), lru_, it);
+    }
+
+    index_.emplace(std::string_view{lru_.front().topic}, lru_.begin());
+    return lru_.front();
+}
+
+uint16_t topic_alias_manager::get_alias(const string& topic) const
+{
+    guard g{lock_};
+    auto it = index_.find(std::string_view{topic});
+    return (it != index_.end()) ? it->second->alias : uint16_t(0);
+}
+
+void topic_alias_manager::reset(uint16_t serverMax)
+{
+    guard g{lock_};
+    index_.clear();
+    lru_.clear();
+    max_ = std::min(limit_, serverMax);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
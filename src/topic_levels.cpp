@@ -0,0 +1,99 @@
+// topic_levels.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/topic_levels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MQTT_TOPIC_LEVELS_SSE2
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define MQTT_TOPIC_LEVELS_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace mqtt {
+
+namespace {
+
+// Gets the index of the lowest set bit in a non-zero mask
+inline unsigned lowest_bit(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, mask);
+    return unsigned(idx);
+#else
+    return unsigned(__builtin_ctzll(mask));
+#endif
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//  							topic_levels
+/////////////////////////////////////////////////////////////////////////////
+
+// The vector loops check 16 bytes at a time, turning the comparison with
+// '/' into a bit mask, then pick out the set bits. The scalar loop handles
+// whatever is left over at the end.
+
+topic_levels::topic_levels(std::string_view topic) : len_{topic.size()}
+{
+    const char* p = topic.data();
+    const std::size_t n = topic.size();
+    std::size_t i = 0;
+
+#if defined(MQTT_TOPIC_LEVELS_SSE2)
+    const __m128i slash = _mm_set1_epi8('/');
+
+    for (; i + 16 <= n; i += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        auto mask = uint64_t(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, slash))));
+        while (mask) {
+            add_separator(i + lowest_bit(mask));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(MQTT_TOPIC_LEVELS_NEON)
+    const uint8x16_t slash = vdupq_n_u8(uint8_t('/'));
+
+    for (; i + 16 <= n; i += 16) {
+        auto eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p + i)), slash);
+        // Narrow each byte of the comparison to 4 bits of a 64-bit mask
+        auto nib = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+        auto mask = vget_lane_u64(vreinterpret_u64_u8(nib), 0);
+        while (mask) {
+            auto bit = lowest_bit(mask);
+            add_separator(i + bit / 4);
+            mask &= ~(uint64_t(0xF) << (bit & ~3u));
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        if (p[i] == '/')
+            add_separator(i);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
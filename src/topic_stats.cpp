@@ -0,0 +1,178 @@
+// topic_stats.cpp
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include "mqtt/topic_stats.h"
+
+namespace mqtt {
+
+/////////////////////////////////////////////////////////////////////////////
+//  						topic_stats::direction
+/////////////////////////////////////////////////////////////////////////////
+
+void topic_stats::direction::add(size_t idx, size_t n, time_point now)
+{
+    auto& sh = shards[idx];
+    sh.msgs.fetch_add(1, std::memory_order_relaxed);
+    sh.bytes.fetch_add(n, std::memory_order_relaxed);
+    lastSeen.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+topic_stats::counts topic_stats::direction::get() const
+{
+    counts c;
+    for (const auto& sh : shards) {
+        c.msgs += sh.msgs.load(std::memory_order_relaxed);
+        c.bytes += sh.bytes.load(std::memory_order_relaxed);
+    }
+    c.lastSeen = time_point{clock::duration{lastSeen.load(std::memory_order_relaxed)}};
+    return c;
+}
+
+void topic_stats::direction::reset()
+{
+    for (auto& sh : shards) {
+        sh.msgs.store(0, std::memory_order_relaxed);
+        sh.bytes.store(0, std::memory_order_relaxed);
+    }
+    lastSeen.store(0, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//  							topic_stats
+/////////////////////////////////////////////////////////////////////////////
+
+// Each thread gets the next shard the first time it counts a message, so
+// a handful of busy threads are spread over the shards.
+
+size_t topic_stats::shard_index()
+{
+    static std::atomic<size_t> next{0};
+    thread_local size_t idx = next.fetch_add(1, std::memory_order_relaxed) % N_SHARDS;
+    return idx;
+}
+
+void topic_stats::add_filter(const string& filter)
+{
+    unique_lock g{lock_};
+    auto it = trie_.find(filter);
+    if (it != trie_.end()) {
+        // A prefix that was found becomes a filter
+        if ((*it).second->prefix) {
+            (*it).second->prefix = false;
+            --nPrefixes_;
+            ++nFilters_;
+        }
+        return;
+    }
+    trie_.insert({filter, std::make_shared<counters>()});
+    ++nFilters_;
+}
+
+// The prefix of a topic is only looked for among its matches, since it
+// would be one of them, and a new one is inserted under the exclusive
+// lock, unless another thread beat us to it, in which case it counts there.
+
+void topic_stats::count(bool sent, const string& topic, size_t n, time_point now)
+{
+    const auto idx = shard_index();
+
+    string prefix;
+    if (prefixDepth_ > 0) {
+        size_t pos = string::npos, start = 0;
+        for (unsigned i = 0; i < prefixDepth_; ++i) {
+            if ((pos = topic.find('/', start)) == string::npos)
+                break;
+            start = pos + 1;
+        }
+        prefix = topic.substr(0, pos) + "/#";
+    }
+
+    bool found = prefix.empty();
+    {
+        shared_lock g{lock_};
+        for (auto it = trie_.matches(topic); it != trie_.matches_cend(); ++it) {
+            auto& ctrs = *it->second;
+            (sent ? ctrs.sent : ctrs.received).add(idx, n, now);
+            if (!found && it->first == prefix)
+                found = true;
+        }
+    }
+    if (found)
+        return;
+
+    unique_lock g{lock_};
+    auto it = trie_.find(prefix);
+    if (it != trie_.end()) {
+        auto& ctrs = *(*it).second;
+        (sent ? ctrs.sent : ctrs.received).add(idx, n, now);
+        return;
+    }
+
+    if (nPrefixes_ >= maxPrefixes_) {
+        nOverflow_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto ctrs = std::make_shared<counters>();
+    ctrs->prefix = true;
+    (sent ? ctrs->sent : ctrs->received).add(idx, n, now);
+    trie_.insert({std::move(prefix), std::move(ctrs)});
+    ++nPrefixes_;
+}
+
+topic_stats::entry topic_stats::make_entry(const string& filter, const counters& ctrs)
+{
+    entry e;
+    e.filter = filter;
+    e.prefix = ctrs.prefix;
+    e.sent = ctrs.sent.get();
+    e.received = ctrs.received.get();
+    return e;
+}
+
+std::vector<topic_stats::entry> topic_stats::snapshot() const
+{
+    std::vector<entry> entries;
+    shared_lock g{lock_};
+    entries.reserve(nFilters_ + nPrefixes_);
+    for (auto it = trie_.cbegin(); it != trie_.cend(); ++it)
+        entries.push_back(make_entry((*it).first, *(*it).second));
+    return entries;
+}
+
+std::optional<topic_stats::entry> topic_stats::get(const string& filter) const
+{
+    shared_lock g{lock_};
+    auto it = trie_.find(filter);
+    if (it != trie_.end())
+        return make_entry((*it).first, *(*it).second);
+    return std::nullopt;
+}
+
+void topic_stats::reset()
+{
+    shared_lock g{lock_};
+    for (auto it = trie_.cbegin(); it != trie_.cend(); ++it) {
+        (*it).second->sent.reset();
+        (*it).second->received.reset();
+    }
+    nOverflow_.store(0, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace mqtt
@@ -0,0 +1,209 @@
+// alloc_tests.cpp
+//
+// Allocation-count regression tests for the Paho MQTT C++ library.
+//
+// This hooks the global operator new, and checks that the hot paths stay
+// within a fixed budget of heap allocations per message. The budgets are
+// the counts of the current code, so any new allocation on one of these
+// paths fails the test. When an optimization removes one, lower the
+// budget to match.
+//
+// Only the allocations made by the test thread, while a counter is armed,
+// are counted. Memory from the C library, which uses malloc(), is not.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+// This seems to be required, at least for MSVS 2015 on Win7,
+// using Catch2 v2.9.2
+#if defined(_WIN32)
+    #define CATCH_CONFIG_DISABLE_EXCEPTIONS
+#endif
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#define CATCH_CONFIG_RUNNER
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/topic.h"
+#include "mqtt/topic_matcher.h"
+
+using namespace mqtt;
+
+/////////////////////////////////////////////////////////////////////////////
+// The allocation hooks
+
+namespace {
+
+// The number of allocations made by this thread while armed
+thread_local size_t nAllocs = 0;
+// Whether the allocations of this thread are being counted
+thread_local bool armed = false;
+
+void* counted_alloc(std::size_t n) {
+    if (armed)
+        ++nAllocs;
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+// Counts the allocations of the test thread in a scope
+class alloc_counter
+{
+    size_t start_;
+
+public:
+    alloc_counter() : start_{nAllocs} { armed = true; }
+    ~alloc_counter() { armed = false; }
+
+    size_t count() const { return nAllocs - start_; }
+};
+
+}  // namespace
+
+void* operator new(std::size_t n) { return counted_alloc(n); }
+void* operator new[](std::size_t n) { return counted_alloc(n); }
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    try {
+        return counted_alloc(n);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t& nt) noexcept {
+    return operator new(n, nt);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+/////////////////////////////////////////////////////////////////////////////
+// The budgets
+
+// While disconnected, a publish goes into the offline buffer, which is the
+// same client-side work as a connected one, up to the send: the delivery
+// token, its entry in the token table, and the held send task.
+static constexpr size_t PUBLISH_BUDGET = 4;
+
+// A message that arrives is wrapped, without copying the C message, and
+// queued for the consumer. That's just the message object.
+static constexpr size_t RECEIVE_BUDGET = 1;
+
+// Matching a topic against a filter works on views of the strings.
+static constexpr size_t FILTER_MATCH_BUDGET = 0;
+
+// Finding the filters that match a topic walks the trie of filters, with
+// a stack of the nodes still to search.
+static constexpr size_t MATCHER_BUDGET = 3;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("publish allocations", "[alloc]")
+{
+    async_client cli{"tcp://localhost:1883", "test_alloc_publish"};
+    cli.start_offline_buffering();
+
+    const std::string PAYLOAD(256, 'x');
+    auto msg = message::create("alloc/publish", PAYLOAD, 1, false);
+
+    // Warm up, for anything that's allocated once
+    cli.publish(msg);
+
+    size_t n;
+    {
+        alloc_counter cnt;
+        cli.publish(msg);
+        n = cnt.count();
+    }
+    INFO("publish allocations: " << n);
+    REQUIRE(n <= PUBLISH_BUDGET);
+}
+
+TEST_CASE("receive allocations", "[alloc]")
+{
+    async_client cli{"tcp://localhost:1883", "test_alloc_receive"};
+    cli.start_consuming();
+
+    const std::string TOPIC{"alloc/receive"};
+    const std::string PAYLOAD(256, 'x');
+
+    cli.test_message_arrived(TOPIC, PAYLOAD.data(), PAYLOAD.size());
+    cli.consume_message();
+
+    size_t n;
+    {
+        alloc_counter cnt;
+        cli.test_message_arrived(TOPIC, PAYLOAD.data(), PAYLOAD.size());
+        auto msg = cli.consume_message();
+        n = cnt.count();
+        REQUIRE(msg);
+    }
+    INFO("receive allocations: " << n);
+    REQUIRE(n <= RECEIVE_BUDGET);
+}
+
+TEST_CASE("topic_filter allocations", "[alloc]")
+{
+    topic_filter filt{"sensors/+/temp/#"};
+    const std::string TOPIC{"sensors/kitchen/temp/celsius"};
+
+    size_t n;
+    bool matched;
+    {
+        alloc_counter cnt;
+        matched = filt.matches(TOPIC);
+        n = cnt.count();
+    }
+    REQUIRE(matched);
+    INFO("topic_filter::matches allocations: " << n);
+    REQUIRE(n <= FILTER_MATCH_BUDGET);
+}
+
+TEST_CASE("topic_matcher allocations", "[alloc]")
+{
+    topic_matcher<int> tm{
+        {"sensors/+/temp/#", 1},
+        {"sensors/#", 2},
+        {"sensors/kitchen/temp/celsius", 3},
+        {"status/+", 4},
+    };
+    const std::string TOPIC{"sensors/kitchen/temp/celsius"};
+
+    size_t n, nMatches = 0;
+    {
+        alloc_counter cnt;
+        for (auto it = tm.matches(TOPIC); it != tm.matches_cend(); ++it) ++nMatches;
+        n = cnt.count();
+    }
+    REQUIRE(3 == nMatches);
+    INFO("topic_matcher::matches allocations: " << n);
+    REQUIRE(n <= MATCHER_BUDGET);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[]) { return Catch::Session().run(argc, argv); }
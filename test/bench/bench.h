@@ -0,0 +1,253 @@
+// bench.h
+//
+// A small timing harness for the Paho C++ benchmarks.
+//
+// Each benchmark runs a batch of operations a number of times, and the
+// per-operation time of each batch is kept as a sample. The results are
+// reported as percentiles of those samples, which are far more useful for
+// spotting regressions between releases than a single run's average.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#ifndef __mqtt_bench_h
+#define __mqtt_bench_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The summary statistics for a set of timing samples.
+ */
+struct stats
+{
+    /** The number of samples */
+    size_t n{0};
+    /** The minimum value */
+    double min{0.0};
+    /** The median */
+    double p50{0.0};
+    /** The 90th percentile */
+    double p90{0.0};
+    /** The 99th percentile */
+    double p99{0.0};
+    /** The maximum value */
+    double max{0.0};
+    /** The mean value */
+    double mean{0.0};
+};
+
+/**
+ * Gets the percentile of a sorted set of samples, using the nearest rank.
+ */
+inline double percentile(const std::vector<double>& sorted, double pct) {
+    if (sorted.empty())
+        return 0.0;
+    auto i = size_t(pct / 100.0 * double(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+/**
+ * Computes the summary statistics for a set of samples.
+ */
+inline stats summarize(std::vector<double> samples) {
+    stats st;
+    if (samples.empty())
+        return st;
+
+    std::sort(samples.begin(), samples.end());
+    st.n = samples.size();
+    st.min = samples.front();
+    st.p50 = percentile(samples, 50.0);
+    st.p90 = percentile(samples, 90.0);
+    st.p99 = percentile(samples, 99.0);
+    st.max = samples.back();
+    st.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / double(st.n);
+    return st;
+}
+
+/**
+ * Prints the header for a table of results.
+ */
+inline void print_header(const char* unit = "ns/op") {
+    std::printf(
+        "%-40s %8s %10s %10s %10s %10s %10s  (%s)\n", "benchmark", "samples", "min", "p50",
+        "p90", "p99", "max", unit
+    );
+}
+
+/**
+ * Prints a line of results.
+ */
+inline void print(const std::string& name, const stats& st) {
+    std::printf(
+        "%-40s %8zu %10.1f %10.1f %10.1f %10.1f %10.1f\n", name.c_str(), st.n, st.min, st.p50,
+        st.p90, st.p99, st.max
+    );
+    std::fflush(stdout);
+}
+
+/**
+ * Runs a benchmark and gets the per-operation time, in nanoseconds, for
+ * each sample.
+ *
+ * @param nSamples The number of samples to take.
+ * @param nOps The number of operations in each sample.
+ * @param f The function to run a batch. It is called as `f(nOps)`.
+ */
+template <typename Func>
+stats run(size_t nSamples, size_t nOps, Func&& f) {
+    using clock = std::chrono::steady_clock;
+
+    // A warm-up batch, which is not timed.
+    f(nOps);
+
+    std::vector<double> samples;
+    samples.reserve(nSamples);
+
+    for (size_t i = 0; i < nSamples; ++i) {
+        auto start = clock::now();
+        f(nOps);
+        auto dur = std::chrono::duration<double, std::nano>(clock::now() - start);
+        samples.push_back(dur.count() / double(nOps));
+    }
+    return summarize(std::move(samples));
+}
+
+/**
+ * A high dynamic range histogram of latencies, in nanoseconds.
+ *
+ * This is laid out like an HdrHistogram: the values are split into ranges
+ * that double in size, and each range is split into the same number of
+ * linear sub-buckets. With 128 sub-buckets, every value is kept to within
+ * 1% of its real value, from a nanosecond to over a minute, in a fixed
+ * 16kB. Recording is lock-free, so any number of threads can record into
+ * one histogram.
+ */
+class hdr_histogram
+{
+    /** The number of sub-buckets in each range, as a power of two */
+    static constexpr unsigned SUB_BITS = 7;
+    /** Half the number of sub-buckets */
+    static constexpr size_t HALF = size_t(1) << (SUB_BITS - 1);
+    /** The number of ranges, which covers up to 2^36 ns */
+    static constexpr size_t N_RANGES = 36 - SUB_BITS + 1;
+    /** The total number of counts */
+    static constexpr size_t N_COUNTS = (N_RANGES + 1) * HALF;
+
+    /** The count of values in each bucket */
+    std::atomic<uint64_t> counts_[N_COUNTS];
+    /** The total number of values */
+    std::atomic<uint64_t> total_{0};
+
+    /** Gets the position of the highest bit that is set */
+    static unsigned log2(uint64_t v) {
+        unsigned n = 0;
+        while (v >>= 1) ++n;
+        return n;
+    }
+    /** Gets the index of the bucket for a value */
+    static size_t index(uint64_t v) {
+        auto range = log2(v | ((uint64_t(1) << SUB_BITS) - 1)) - (SUB_BITS - 1);
+        auto idx = size_t(range) * HALF + size_t(v >> range);
+        return std::min(idx, N_COUNTS - 1);
+    }
+    /** Gets the highest value that is counted by a bucket */
+    static uint64_t highest_value(size_t idx) {
+        if (idx < 2 * HALF)
+            return uint64_t(idx);
+        auto range = unsigned(idx / HALF - 1);
+        auto sub = uint64_t(idx - range * HALF);
+        return ((sub + 1) << range) - 1;
+    }
+
+public:
+    /**
+     * Creates an empty histogram.
+     */
+    hdr_histogram() { reset(); }
+    /**
+     * Clears all the values.
+     */
+    void reset() {
+        for (auto& n : counts_) n.store(0, std::memory_order_relaxed);
+        total_.store(0);
+    }
+    /**
+     * Records a value, in nanoseconds.
+     */
+    void record(int64_t ns) {
+        auto v = (ns > 0) ? uint64_t(ns) : uint64_t(0);
+        counts_[index(v)].fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(1, std::memory_order_relaxed);
+    }
+    /**
+     * Gets the number of values that were recorded.
+     */
+    uint64_t count() const { return total_.load(std::memory_order_relaxed); }
+    /**
+     * Gets a percentile of the values, in nanoseconds.
+     * @param pct The percentile, from 0.0 to 100.0.
+     */
+    uint64_t percentile(double pct) const {
+        uint64_t total = 0;
+        for (const auto& n : counts_) total += n.load(std::memory_order_relaxed);
+        if (total == 0)
+            return 0;
+
+        auto target = std::max<uint64_t>(1, uint64_t(pct / 100.0 * double(total) + 0.5));
+        uint64_t n = 0;
+        for (size_t i = 0; i < N_COUNTS; ++i) {
+            n += counts_[i].load(std::memory_order_relaxed);
+            if (n >= target)
+                return highest_value(i);
+        }
+        return highest_value(N_COUNTS - 1);
+    }
+    /**
+     * Gets the largest value that was recorded, in nanoseconds.
+     */
+    uint64_t max() const { return percentile(100.0); }
+};
+
+/**
+ * Keeps the compiler from optimizing away a value.
+ */
+template <typename T>
+inline void keep(T&& val) {
+#if defined(_MSC_VER)
+    static const void* volatile sink;
+    sink = &val;
+#else
+    asm volatile("" : : "g"(&val) : "memory");
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+}  // namespace bench
+
+#endif  // __mqtt_bench_h
@@ -0,0 +1,414 @@
+// load_bench.cpp
+//
+// A load generator for an MQTT broker, with a number of publishers and
+// subscribers in one process. This needs a running broker.
+//
+// The publishers each send at a fixed rate, for a set time, to a number of
+// topics under a common root, with a mix of QoS levels and payload sizes.
+// The subscribers each subscribe to all of the topics. Every payload
+// starts with the time it was published, so each subscriber can record
+// the end-to-end latency of every message it receives. The latencies are
+// kept in a high dynamic range histogram, and reported as percentiles.
+//
+// This makes it a capacity planning tool for a broker, and, against a
+// fixed broker, a regression benchmark for the library.
+//
+// USAGE:
+//     load_bench [options]
+//
+//     --uri <uri>          The server URI [mqtt://localhost:1883]
+//     --pubs <n>           The number of publishers [1]
+//     --subs <n>           The number of subscribers [1]
+//     --rate <n>           Messages per second, per publisher, 0=max [1000]
+//     --time <secs>        How long to publish [10]
+//     --qos <list>         QoS levels to pick from, like 0,1,1 [1]
+//     --size <n>           The (mean) payload size, in bytes [64]
+//     --size-max <n>       The largest payload size [4*size]
+//     --size-dist <dist>   The payload sizes: fixed, uniform, or exp [fixed]
+//     --topics <n>         The number of topics [1]
+//     --root <topic>       The topic root [bench/load]
+//     --format <fmt>       The results as: text, csv, or json [text]
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "mqtt/async_client.h"
+
+using namespace std;
+using namespace std::chrono;
+
+using clock_type = steady_clock;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// The settings for a run
+
+struct config
+{
+    string uri{"mqtt://localhost:1883"};
+    size_t nPub{1};
+    size_t nSub{1};
+    double rate{1000.0};
+    double secs{10.0};
+    vector<int> qos{1};
+    size_t size{64};
+    size_t sizeMax{0};
+    string sizeDist{"fixed"};
+    size_t nTopics{1};
+    string root{"bench/load"};
+    string format{"text"};
+};
+
+// The results of a run, updated by all the clients
+
+struct results
+{
+    atomic<uint64_t> nSent{0};
+    atomic<uint64_t> nBytesSent{0};
+    atomic<uint64_t> nPubErrors{0};
+    atomic<uint64_t> nRecv{0};
+    atomic<uint64_t> nBytesRecv{0};
+    bench::hdr_histogram latency;
+};
+
+// Each payload starts with the time it was published, in nanoseconds of
+// the steady clock, which all the clients in the process share.
+const size_t HDR_SIZE = sizeof(int64_t);
+
+int64_t now_ns()
+{
+    return duration_cast<nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+// --------------------------------------------------------------------------
+
+void usage()
+{
+    cerr << "USAGE: load_bench [--uri <uri>] [--pubs <n>] [--subs <n>] [--rate <n>]\n"
+            "                  [--time <secs>] [--qos <list>] [--size <n>] [--size-max <n>]\n"
+            "                  [--size-dist fixed|uniform|exp] [--topics <n>]\n"
+            "                  [--root <topic>] [--format text|csv|json]"
+         << endl;
+}
+
+// Parses a list of QoS levels, like "0,1,1"
+
+vector<int> parse_qos(const string& s)
+{
+    vector<int> v;
+    istringstream is{s};
+    string tok;
+    while (getline(is, tok, ',')) {
+        int qos = atoi(tok.c_str());
+        if (qos < 0 || qos > 2)
+            throw invalid_argument("bad QoS: " + tok);
+        v.push_back(qos);
+    }
+    if (v.empty())
+        throw invalid_argument("no QoS given");
+    return v;
+}
+
+config parse_args(int argc, char* argv[])
+{
+    config cfg;
+
+    for (int i = 1; i < argc; ++i) {
+        string opt{argv[i]};
+        if (opt == "-h" || opt == "--help") {
+            usage();
+            exit(0);
+        }
+        if (i + 1 >= argc)
+            throw invalid_argument("missing value for " + opt);
+        string val{argv[++i]};
+
+        if (opt == "--uri")
+            cfg.uri = val;
+        else if (opt == "--pubs")
+            cfg.nPub = size_t(atol(val.c_str()));
+        else if (opt == "--subs")
+            cfg.nSub = size_t(atol(val.c_str()));
+        else if (opt == "--rate")
+            cfg.rate = atof(val.c_str());
+        else if (opt == "--time")
+            cfg.secs = atof(val.c_str());
+        else if (opt == "--qos")
+            cfg.qos = parse_qos(val);
+        else if (opt == "--size")
+            cfg.size = size_t(atol(val.c_str()));
+        else if (opt == "--size-max")
+            cfg.sizeMax = size_t(atol(val.c_str()));
+        else if (opt == "--size-dist")
+            cfg.sizeDist = val;
+        else if (opt == "--topics")
+            cfg.nTopics = size_t(atol(val.c_str()));
+        else if (opt == "--root")
+            cfg.root = val;
+        else if (opt == "--format")
+            cfg.format = val;
+        else
+            throw invalid_argument("unknown option: " + opt);
+    }
+
+    if (cfg.sizeDist != "fixed" && cfg.sizeDist != "uniform" && cfg.sizeDist != "exp")
+        throw invalid_argument("bad size distribution: " + cfg.sizeDist);
+    if (cfg.format != "text" && cfg.format != "csv" && cfg.format != "json")
+        throw invalid_argument("bad format: " + cfg.format);
+
+    cfg.size = max(cfg.size, HDR_SIZE);
+    if (cfg.sizeMax == 0)
+        cfg.sizeMax = 4 * cfg.size;
+    cfg.sizeMax = max(cfg.sizeMax, cfg.size);
+    cfg.nTopics = max<size_t>(cfg.nTopics, 1);
+
+    return cfg;
+}
+
+// --------------------------------------------------------------------------
+
+// Picks the payload size of each message from the configured distribution.
+
+class size_picker
+{
+    const config& cfg_;
+    uniform_int_distribution<size_t> uniform_;
+    exponential_distribution<double> exp_;
+
+public:
+    explicit size_picker(const config& cfg)
+        : cfg_{cfg}, uniform_{HDR_SIZE, 2 * cfg.size - HDR_SIZE}, exp_{1.0 / double(cfg.size)} {}
+
+    template <typename Gen>
+    size_t operator()(Gen& gen) {
+        size_t sz = cfg_.size;
+        if (cfg_.sizeDist == "uniform")
+            sz = uniform_(gen);
+        else if (cfg_.sizeDist == "exp")
+            sz = size_t(exp_(gen));
+        return min(max(sz, HDR_SIZE), cfg_.sizeMax);
+    }
+};
+
+// Publishes from one client at a fixed rate, until the end time.
+
+void publish_func(
+    mqtt::async_client& cli, const config& cfg, results& res, size_t id,
+    clock_type::time_point endTime
+)
+{
+    mt19937_64 gen{id};
+    uniform_int_distribution<size_t> topicDist{0, cfg.nTopics - 1};
+    uniform_int_distribution<size_t> qosDist{0, cfg.qos.size() - 1};
+    size_picker pickSize{cfg};
+
+    vector<string> topics;
+    for (size_t i = 0; i < cfg.nTopics; ++i) topics.push_back(cfg.root + "/" + to_string(i));
+
+    string payload(cfg.sizeMax, 'x');
+
+    auto period = (cfg.rate > 0.0) ? duration_cast<clock_type::duration>(
+                                         duration<double>(1.0 / cfg.rate)
+                                     )
+                                   : clock_type::duration::zero();
+    auto next = clock_type::now();
+
+    while (clock_type::now() < endTime) {
+        if (period > clock_type::duration::zero()) {
+            this_thread::sleep_until(next);
+            next += period;
+        }
+
+        auto sz = pickSize(gen);
+        auto ts = now_ns();
+        memcpy(&payload[0], &ts, HDR_SIZE);
+
+        try {
+            cli.publish(topics[topicDist(gen)], payload.data(), sz, cfg.qos[qosDist(gen)], false);
+            ++res.nSent;
+            res.nBytesSent += sz;
+        }
+        catch (const mqtt::exception&) {
+            ++res.nPubErrors;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+template <typename T>
+double rate(T n, double secs)
+{
+    return (secs > 0.0) ? double(n) / secs : 0.0;
+}
+
+// Latency in microseconds
+double usec(uint64_t ns) { return double(ns) / 1000.0; }
+
+const double PCTS[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+
+void print_results(const config& cfg, const results& res, double secs)
+{
+    const auto& lat = res.latency;
+    uint64_t nSent = res.nSent, nRecv = res.nRecv;
+    uint64_t nExpected = nSent * cfg.nSub;
+    double lossPct = (nExpected > 0 && nRecv < nExpected)
+                         ? 100.0 * double(nExpected - nRecv) / double(nExpected)
+                         : 0.0;
+
+    if (cfg.format == "csv") {
+        printf(
+            "pubs,subs,topics,size,secs,sent,pub_errors,recv,loss_pct,"
+            "send_rate,recv_rate,recv_mbps,p50_us,p90_us,p99_us,p999_us,p9999_us,max_us\n"
+        );
+        printf(
+            "%zu,%zu,%zu,%zu,%.3f,%llu,%llu,%llu,%.3f,%.1f,%.1f,%.3f", cfg.nPub, cfg.nSub,
+            cfg.nTopics, cfg.size, secs, (unsigned long long)nSent,
+            (unsigned long long)res.nPubErrors.load(), (unsigned long long)nRecv, lossPct,
+            rate(nSent, secs), rate(nRecv, secs), rate(res.nBytesRecv.load(), secs) / 1.0e6
+        );
+        for (auto pct : PCTS) printf(",%.1f", usec(lat.percentile(pct)));
+        printf(",%.1f\n", usec(lat.max()));
+    }
+    else if (cfg.format == "json") {
+        printf(
+            "{\n  \"pubs\": %zu,\n  \"subs\": %zu,\n  \"topics\": %zu,\n  \"size\": %zu,\n"
+            "  \"secs\": %.3f,\n  \"sent\": %llu,\n  \"pub_errors\": %llu,\n"
+            "  \"recv\": %llu,\n  \"loss_pct\": %.3f,\n  \"send_rate\": %.1f,\n"
+            "  \"recv_rate\": %.1f,\n  \"recv_mbps\": %.3f,\n  \"latency_us\": {",
+            cfg.nPub, cfg.nSub, cfg.nTopics, cfg.size, secs, (unsigned long long)nSent,
+            (unsigned long long)res.nPubErrors.load(), (unsigned long long)nRecv, lossPct,
+            rate(nSent, secs), rate(nRecv, secs), rate(res.nBytesRecv.load(), secs) / 1.0e6
+        );
+        for (auto pct : PCTS) printf("\"p%g\": %.1f, ", pct, usec(lat.percentile(pct)));
+        printf("\"max\": %.1f}\n}\n", usec(lat.max()));
+    }
+    else {
+        printf("Publishers:   %zu\n", cfg.nPub);
+        printf("Subscribers:  %zu\n", cfg.nSub);
+        printf("Topics:       %zu\n", cfg.nTopics);
+        printf("Time:         %.3f s\n", secs);
+        printf(
+            "Sent:         %llu (%.1f msg/s), %llu errors\n", (unsigned long long)nSent,
+            rate(nSent, secs), (unsigned long long)res.nPubErrors.load()
+        );
+        printf(
+            "Received:     %llu (%.1f msg/s, %.3f MB/s), %.3f%% lost\n",
+            (unsigned long long)nRecv, rate(nRecv, secs),
+            rate(res.nBytesRecv.load(), secs) / 1.0e6, lossPct
+        );
+        printf("Latency (us):");
+        for (auto pct : PCTS) printf("  p%g=%.1f", pct, usec(lat.percentile(pct)));
+        printf("  max=%.1f\n", usec(lat.max()));
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    config cfg;
+    try {
+        cfg = parse_args(argc, argv);
+    }
+    catch (const exception& exc) {
+        cerr << exc.what() << endl;
+        usage();
+        return 2;
+    }
+
+    results res;
+
+    auto connOpts = mqtt::connect_options_builder()
+                        .clean_session()
+                        .max_inflight(65535)
+                        .finalize();
+
+    vector<unique_ptr<mqtt::async_client>> subs, pubs;
+
+    try {
+        int maxQos = 0;
+        for (auto qos : cfg.qos) maxQos = max(maxQos, qos);
+
+        for (size_t i = 0; i < cfg.nSub; ++i) {
+            auto cli = make_unique<mqtt::async_client>(cfg.uri, "");
+            cli->set_message_callback([&res](mqtt::const_message_ptr msg) {
+                const auto& payload = msg->get_payload_ref();
+                if (payload.size() >= HDR_SIZE) {
+                    int64_t ts;
+                    memcpy(&ts, payload.data(), HDR_SIZE);
+                    res.latency.record(now_ns() - ts);
+                }
+                ++res.nRecv;
+                res.nBytesRecv += payload.size();
+            });
+            cli->connect(connOpts)->wait();
+            cli->subscribe(cfg.root + "/#", maxQos)->wait();
+            subs.push_back(std::move(cli));
+        }
+
+        for (size_t i = 0; i < cfg.nPub; ++i) {
+            auto cli = make_unique<mqtt::async_client>(cfg.uri, "");
+            cli->connect(connOpts)->wait();
+            pubs.push_back(std::move(cli));
+        }
+
+        auto start = clock_type::now();
+        auto endTime = start + duration_cast<clock_type::duration>(duration<double>(cfg.secs));
+
+        vector<thread> thrs;
+        for (size_t i = 0; i < cfg.nPub; ++i)
+            thrs.emplace_back(publish_func, ref(*pubs[i]), cref(cfg), ref(res), i, endTime);
+        for (auto& thr : thrs) thr.join();
+
+        auto secs = duration<double>(clock_type::now() - start).count();
+
+        // Give the messages in flight a chance to arrive, until nothing
+        // more comes in for a while.
+        uint64_t nExpected = res.nSent * cfg.nSub, nLast;
+        do {
+            nLast = res.nRecv;
+            this_thread::sleep_for(milliseconds(250));
+        } while (res.nRecv < nExpected && res.nRecv != nLast);
+
+        for (auto& cli : pubs) cli->disconnect()->wait();
+        for (auto& cli : subs) cli->disconnect()->wait();
+
+        print_results(cfg, res, secs);
+    }
+    catch (const mqtt::exception& exc) {
+        cerr << exc.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+// loopback_bench.cpp
+//
+// Benchmark of the client data path without a network, using the
+// in-process loopback broker, by QoS, payload size, and the number of
+// subscribers. No broker is needed.
+//
+// Each sample publishes a batch of messages and waits until every
+// subscriber has received all of them. The results are the time per
+// message, which is the CPU cost of the publish, the routing, the token
+// completions, and the delivery to the consumer queues.
+//
+// USAGE:
+//     loopback_bench [msgs_per_sample] [samples]
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "mqtt/loopback_client.h"
+
+using namespace std;
+
+const size_t DFLT_N_MSG = 10000, DFLT_N_SAMPLES = 20;
+
+const string TOPIC{"bench/loopback"};
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    size_t nMsg = (argc > 1) ? size_t(atol(argv[1])) : DFLT_N_MSG;
+    size_t nSamples = (argc > 2) ? size_t(atol(argv[2])) : DFLT_N_SAMPLES;
+
+    if (nMsg == 0)
+        nMsg = 1;
+
+    try {
+        auto broker = mqtt::loopback_broker::create();
+
+        mqtt::loopback_client pub{broker, "pub"};
+        pub.connect()->wait();
+
+        bench::print_header("ns/msg");
+
+        vector<mqtt::delivery_token_ptr> toks;
+        toks.reserve(nMsg);
+
+        for (size_t nSub : {1, 4}) {
+            vector<unique_ptr<mqtt::loopback_client>> subs;
+            for (size_t i = 0; i < nSub; ++i) {
+                auto sub = make_unique<mqtt::loopback_client>(broker, "sub" + to_string(i));
+                sub->start_consuming();
+                sub->connect()->wait();
+                sub->subscribe(TOPIC, 2)->wait();
+                subs.push_back(std::move(sub));
+            }
+
+            for (int qos : {0, 1, 2}) {
+                for (size_t sz : {16, 256, 4096}) {
+                    auto msg = mqtt::message::create(TOPIC, string(sz, 'x'), qos, false);
+
+                    auto st = bench::run(nSamples, nMsg, [&](size_t n) {
+                        for (size_t i = 0; i < n; ++i) toks.push_back(pub.publish(msg));
+                        for (auto& tok : toks) tok->wait();
+                        toks.clear();
+
+                        for (auto& sub : subs) {
+                            for (size_t i = 0; i < n; ++i) bench::keep(sub->consume_message());
+                        }
+                    });
+                    bench::print(
+                        "loopback QoS " + to_string(qos) + " " + to_string(sz) + "B x" +
+                            to_string(nSub),
+                        st
+                    );
+                }
+            }
+
+            for (auto& sub : subs) sub->disconnect()->wait();
+        }
+
+        pub.disconnect()->wait();
+    }
+    catch (const mqtt::exception& exc) {
+        cerr << exc.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+// micro_bench.cpp
+//
+// Micro-benchmarks for the core, in-process parts of the Paho C++ library:
+// message creation, the thread queue, the topic matcher, and properties.
+//
+// USAGE:
+//     micro_bench [filter]
+//
+// If a filter is given, only the benchmarks with names containing it are
+// run.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "mqtt/compiled_topic_matcher.h"
+#include "mqtt/message.h"
+#include "mqtt/properties.h"
+#include "mqtt/thread_queue.h"
+#include "mqtt/topic.h"
+#include "mqtt/topic_levels.h"
+#include "mqtt/topic_matcher.h"
+
+using namespace std;
+
+const size_t N_SAMPLES = 50;
+
+string filter;
+
+// Whether the named benchmark was selected to run
+bool selected(const string& name) { return filter.empty() || name.find(filter) != string::npos; }
+
+// --------------------------------------------------------------------------
+
+void bench_message_create()
+{
+    const string TOPIC{"bench/message/create"};
+
+    for (size_t sz : {0, 64, 1024, 16384}) {
+        auto name = "message::create " + to_string(sz) + "B";
+        if (!selected(name))
+            continue;
+
+        string payload(sz, 'x');
+
+        auto st = bench::run(N_SAMPLES, 10000, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                auto msg = mqtt::message::create(TOPIC, payload, 1, false);
+                bench::keep(msg);
+            }
+        });
+        bench::print(name, st);
+    }
+
+    // The messages come from a shared pool, so this is its contention
+    for (size_t nThr : {2, 4, 8}) {
+        auto name = "message::create 64B " + to_string(nThr) + " threads";
+        if (!selected(name))
+            continue;
+
+        string payload(64, 'x');
+
+        auto st = bench::run(N_SAMPLES, 10000, [&](size_t n) {
+            vector<thread> thrs;
+            for (size_t i = 0; i < nThr; ++i) {
+                thrs.emplace_back([&] {
+                    for (size_t j = 0; j < n / nThr; ++j) {
+                        auto msg = mqtt::message::create(TOPIC, payload, 1, false);
+                        bench::keep(msg);
+                    }
+                });
+            }
+            for (auto& thr : thrs) thr.join();
+        });
+        bench::print(name, st);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+// Moves 'n' items through the queue with the given number of producer and
+// consumer threads. Each consumer gets an equal share of the items.
+void queue_transfer(size_t nProd, size_t nCons, size_t n)
+{
+    mqtt::thread_queue<int> que{1024};
+    vector<thread> thrs;
+
+    const size_t nPer = n / nProd, nGet = n / nCons;
+
+    for (size_t i = 0; i < nCons; ++i) {
+        thrs.emplace_back([&] {
+            for (size_t j = 0; j < nGet; ++j) bench::keep(que.get());
+        });
+    }
+    for (size_t i = 0; i < nProd; ++i) {
+        thrs.emplace_back([&] {
+            for (size_t j = 0; j < nPer; ++j) que.put(int(j));
+        });
+    }
+    for (auto& thr : thrs) thr.join();
+}
+
+void bench_thread_queue()
+{
+    string name{"thread_queue put/get 1 thread"};
+    if (selected(name)) {
+        mqtt::thread_queue<int> que;
+        auto st = bench::run(N_SAMPLES, 100000, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                que.put(int(i));
+                bench::keep(que.get());
+            }
+        });
+        bench::print(name, st);
+    }
+
+    for (size_t nThr : {1, 2, 4}) {
+        name = "thread_queue contention " + to_string(nThr) + "x" + to_string(nThr);
+        if (!selected(name))
+            continue;
+
+        auto st = bench::run(N_SAMPLES, 100000, [&](size_t n) { queue_transfer(nThr, nThr, n); });
+        bench::print(name, st);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void bench_topic_matcher()
+{
+    for (size_t nFilt : {10, 100, 1000}) {
+        auto name = "topic_matcher match " + to_string(nFilt) + " filters";
+        auto cname = "compiled_topic_matcher match " + to_string(nFilt) + " filters";
+        if (!selected(name) && !selected(cname))
+            continue;
+
+        mqtt::topic_matcher<int> tm;
+        vector<string> topics;
+
+        for (size_t i = 0; i < nFilt; ++i) {
+            auto dev = "site/" + to_string(i % 10) + "/dev" + to_string(i);
+            switch (i % 4) {
+                case 0:
+                    tm.insert({dev + "/temp", int(i)});
+                    break;
+                case 1:
+                    tm.insert({dev + "/+", int(i)});
+                    break;
+                case 2:
+                    tm.insert({dev + "/#", int(i)});
+                    break;
+                default:
+                    tm.insert({"site/+/dev" + to_string(i) + "/temp", int(i)});
+                    break;
+            }
+            topics.push_back(dev + "/temp");
+        }
+
+        if (selected(name)) {
+            auto st = bench::run(N_SAMPLES, 10000, [&](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    int nMatch = 0;
+                    for (auto it = tm.matches(topics[i % topics.size()]);
+                         it != tm.matches_cend(); ++it)
+                        ++nMatch;
+                    bench::keep(nMatch);
+                }
+            });
+            bench::print(name, st);
+        }
+
+        if (selected(cname)) {
+            auto ctm = tm.freeze();
+            auto st = bench::run(N_SAMPLES, 10000, [&](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    int nMatch = 0;
+                    for (auto it = ctm.matches(topics[i % topics.size()]);
+                         it != ctm.matches_cend(); ++it)
+                        ++nMatch;
+                    bench::keep(nMatch);
+                }
+            });
+            bench::print(cname, st);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void bench_topic_filter()
+{
+    const string TOPIC{"site/3/dev42/temp"};
+
+    for (const char* filt : {"site/3/dev42/temp", "site/+/dev42/temp", "site/3/#"}) {
+        auto name = string{"topic_filter matches "} + filt;
+        if (!selected(name))
+            continue;
+
+        mqtt::topic_filter tf{filt};
+
+        auto st = bench::run(N_SAMPLES, 100000, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) bench::keep(tf.matches(TOPIC));
+        });
+        bench::print(name, st);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void bench_topic_levels()
+{
+    for (const char* topic : {"site/3/dev42/temp", "building/7/floor/3/room/12/sensor/co2/level"}) {
+        string tstr{topic};
+
+        auto name = string{"topic_levels split "} + topic;
+        if (selected(name)) {
+            auto st = bench::run(N_SAMPLES, 100000, [&](size_t n) {
+                for (size_t i = 0; i < n; ++i) bench::keep(mqtt::topic_levels{tstr}.size());
+            });
+            bench::print(name, st);
+        }
+
+        name = string{"topic::split "} + topic;
+        if (selected(name)) {
+            auto st = bench::run(N_SAMPLES, 100000, [&](size_t n) {
+                for (size_t i = 0; i < n; ++i) bench::keep(mqtt::topic::split(tstr).size());
+            });
+            bench::print(name, st);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void bench_properties_copy()
+{
+    for (size_t nProp : {0, 4, 16}) {
+        auto name = "properties copy " + to_string(nProp) + " props";
+        if (!selected(name))
+            continue;
+
+        mqtt::properties props;
+        for (size_t i = 0; i < nProp; ++i) {
+            props.add(
+                {mqtt::property::USER_PROPERTY, "key" + to_string(i), "value" + to_string(i)}
+            );
+        }
+
+        auto st = bench::run(N_SAMPLES, 10000, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                mqtt::properties cp{props};
+                bench::keep(cp);
+            }
+        });
+        bench::print(name, st);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+        filter = argv[1];
+
+    bench::print_header();
+
+    bench_message_create();
+    bench_thread_queue();
+    bench_topic_matcher();
+    bench_topic_filter();
+    bench_topic_levels();
+    bench_properties_copy();
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+// publish_bench.cpp
+//
+// Benchmark of the publish throughput of the async_client, by QoS and
+// payload size. This needs a running broker.
+//
+// Each sample publishes a batch of messages and waits for all of them to
+// be acknowledged. The results are the time per message, from the start
+// of the batch until the last acknowledgment.
+//
+// USAGE:
+//     publish_bench [server_uri] [msgs_per_sample] [samples]
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "mqtt/async_client.h"
+
+using namespace std;
+
+const string DFLT_SERVER_URI{"mqtt://localhost:1883"};
+const size_t DFLT_N_MSG = 1000, DFLT_N_SAMPLES = 20;
+
+const string TOPIC{"bench/publish"};
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    string serverURI = (argc > 1) ? string{argv[1]} : DFLT_SERVER_URI;
+    size_t nMsg = (argc > 2) ? size_t(atol(argv[2])) : DFLT_N_MSG;
+    size_t nSamples = (argc > 3) ? size_t(atol(argv[3])) : DFLT_N_SAMPLES;
+
+    if (nMsg == 0)
+        nMsg = 1;
+
+    mqtt::async_client cli{serverURI, ""};
+
+    auto connOpts = mqtt::connect_options_builder()
+                        .clean_session()
+                        .max_inflight(int(nMsg))
+                        .finalize();
+
+    try {
+        cli.connect(connOpts)->wait();
+
+        bench::print_header("ns/msg");
+
+        vector<mqtt::delivery_token_ptr> toks;
+        toks.reserve(nMsg);
+
+        for (int qos : {0, 1, 2}) {
+            for (size_t sz : {16, 256, 4096}) {
+                auto msg = mqtt::message::create(TOPIC, string(sz, 'x'), qos, false);
+
+                auto st = bench::run(nSamples, nMsg, [&](size_t n) {
+                    for (size_t i = 0; i < n; ++i) toks.push_back(cli.publish(msg));
+                    for (auto& tok : toks) tok->wait();
+                    toks.clear();
+                });
+
+                bench::print("publish QoS " + to_string(qos) + " " + to_string(sz) + "B", st);
+            }
+        }
+
+        cli.disconnect()->wait();
+    }
+    catch (const mqtt::exception& exc) {
+        cerr << exc.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,459 @@
+// subscribe_bench.cpp
+//
+// Benchmark of the inbound throughput and latency of a subscriber, for
+// each of the ways an app can receive messages: a callback object, the
+// consumer queue, a message handler, and a pool of handler threads. It
+// varies the payload size, the number of topics published to (fan-in),
+// and the number of filters the subscriber has.
+//
+// Each sample publishes a batch of messages and waits for the subscriber
+// to receive all of them. The first table is the time per message over
+// the batch. The second is the latency of each message, from just before
+// it was published until the subscriber got it, in microseconds. Since
+// a whole batch is published at once, that's the latency under load.
+//
+// With --soak, the benchmark runs for a length of time, printing the
+// message rate, the resident memory (RSS), and the number of allocations
+// per message each second, to show leaks and the effect of the pooling
+// and zero-copy options. The allocation count covers the whole process,
+// so it includes the publisher's share.
+//
+// A server URI of "loopback" uses the in-process loopback broker, which
+// needs no server, though the dispatcher mode isn't available with it.
+//
+// USAGE:
+//     subscribe_bench [server_uri] [msgs_per_sample] [samples]
+//     subscribe_bench --soak [server_uri] [seconds]
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__)
+    #include <unistd.h>
+#endif
+
+#include "bench.h"
+#include "mqtt/async_client.h"
+#include "mqtt/loopback_client.h"
+
+using namespace std;
+using namespace std::chrono;
+
+const string DFLT_SERVER_URI{"mqtt://localhost:1883"};
+const size_t DFLT_N_MSG = 1000, DFLT_N_SAMPLES = 20, DFLT_SOAK_SECS = 60;
+
+const string TOPIC_PREFIX{"bench/subscribe/"};
+const int QOS = 1;
+
+// How long to wait for a batch before giving up on lost messages
+const auto BATCH_TIMEOUT = seconds(10);
+
+/////////////////////////////////////////////////////////////////////////////
+// Allocation counting
+
+static atomic<uint64_t> nAllocs{0};
+
+void* operator new(size_t n)
+{
+    nAllocs.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc{};
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// Gets the resident memory of the process, in kB, or zero if unknown
+size_t rss_kb()
+{
+#if defined(__unix__)
+    ifstream is{"/proc/self/statm"};
+    size_t size = 0, resident = 0;
+    if (is >> size >> resident)
+        return resident * size_t(sysconf(_SC_PAGESIZE)) / 1024;
+#endif
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// The ways the subscriber can get its messages
+enum class mode { CALLBACK, CONSUMER, HANDLER, DISPATCHER };
+
+const char* mode_name(mode m)
+{
+    switch (m) {
+        case mode::CALLBACK:
+            return "callback";
+        case mode::CONSUMER:
+            return "consumer";
+        case mode::HANDLER:
+            return "handler";
+        case mode::DISPATCHER:
+            return "dispatcher";
+    }
+    return "";
+}
+
+// The time now, as nanoseconds, for timestamps in the payloads
+int64_t now_ns()
+{
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Counts the incoming messages and records their latency.
+ */
+class receiver : public mqtt::callback
+{
+    mutex lock_;
+    condition_variable cond_;
+    size_t n_{0};
+    vector<double> latencies_;
+
+public:
+    void reserve(size_t n) { latencies_.reserve(n); }
+
+    void on_message(const mqtt::const_message_ptr& msg) {
+        int64_t t = 0;
+        const auto& payload = msg->get_payload_ref();
+        if (payload.size() >= sizeof(t))
+            memcpy(&t, payload.data(), sizeof(t));
+        double us = double(now_ns() - t) / 1000.0;
+
+        lock_guard<mutex> g{lock_};
+        if (latencies_.size() < latencies_.capacity())
+            latencies_.push_back(us);
+        ++n_;
+        cond_.notify_all();
+    }
+
+    void message_arrived(mqtt::const_message_ptr msg) override { on_message(msg); }
+
+    // Waits for a count of messages, and resets
+    bool wait_for(size_t n) {
+        unique_lock<mutex> g{lock_};
+        bool ok = cond_.wait_for(g, BATCH_TIMEOUT, [&] { return n_ >= n; });
+        n_ = 0;
+        return ok;
+    }
+
+    vector<double> take_latencies() {
+        lock_guard<mutex> g{lock_};
+        auto v = std::move(latencies_);
+        latencies_.clear();
+        return v;
+    }
+};
+
+/**
+ * A publisher and subscriber pair, on a server or the loopback broker.
+ */
+struct clients
+{
+    shared_ptr<mqtt::iasync_client> pub, sub;
+    mqtt::async_client* asyncSub{nullptr};
+    mqtt::loopback_client* loopSub{nullptr};
+
+    clients(const string& serverURI) {
+        if (serverURI == "loopback") {
+            auto broker = mqtt::loopback_broker::create();
+            pub = make_shared<mqtt::loopback_client>(broker, "pub");
+            auto sub = make_shared<mqtt::loopback_client>(broker, "sub");
+            loopSub = sub.get();
+            this->sub = sub;
+        }
+        else {
+            pub = make_shared<mqtt::async_client>(serverURI, "");
+            auto sub = make_shared<mqtt::async_client>(serverURI, "");
+            asyncSub = sub.get();
+            this->sub = sub;
+        }
+    }
+
+    void connect(size_t nMsg) {
+        auto connOpts = mqtt::connect_options_builder()
+                            .clean_session()
+                            .max_inflight(int(nMsg))
+                            .finalize();
+        pub->connect(connOpts)->wait();
+        sub->connect(connOpts)->wait();
+    }
+
+    bool has_dispatcher() const { return asyncSub != nullptr; }
+
+    // Sets up the subscriber to deliver to the receiver. Each client is
+    // only attached once, since the async_client sends an incoming message
+    // to all of the callback, handler, and consumer that it has.
+    void attach(mode m, receiver& rcv) {
+        auto handler = [&rcv](mqtt::const_message_ptr msg) { rcv.on_message(msg); };
+
+        switch (m) {
+            case mode::CALLBACK:
+                sub->set_callback(rcv);
+                break;
+            case mode::CONSUMER:
+                sub->start_consuming();
+                break;
+            case mode::HANDLER:
+                if (asyncSub)
+                    asyncSub->set_message_callback(handler);
+                else
+                    loopSub->set_message_callback(handler);
+                break;
+            case mode::DISPATCHER:
+                asyncSub->start_dispatching(4, handler);
+                break;
+        }
+    }
+
+    void detach(mode m) {
+        if (m == mode::CONSUMER)
+            sub->stop_consuming();
+        else if (m == mode::DISPATCHER)
+            asyncSub->stop_dispatching();
+        sub->disable_callbacks();
+    }
+
+    // Subscribes to one filter that matches, and more that don't
+    void subscribe(size_t nFilters) {
+        sub->subscribe(TOPIC_PREFIX + "#", QOS)->wait();
+        for (size_t i = 1; i < nFilters; ++i)
+            sub->subscribe("bench/other/" + to_string(i) + "/+", QOS)->wait();
+    }
+
+    void unsubscribe(size_t nFilters) {
+        sub->unsubscribe(TOPIC_PREFIX + "#")->wait();
+        for (size_t i = 1; i < nFilters; ++i)
+            sub->unsubscribe("bench/other/" + to_string(i) + "/+")->wait();
+    }
+
+    void disconnect() {
+        pub->disconnect()->wait();
+        sub->disconnect()->wait();
+    }
+};
+
+// Publishes a batch, round-robin over the topics, with a timestamp at the
+// front of each payload.
+void publish_batch(
+    mqtt::iasync_client& pub, const vector<string>& topics, size_t sz, size_t n,
+    vector<mqtt::delivery_token_ptr>& toks
+)
+{
+    string payload(max(sz, sizeof(int64_t)), 'x');
+    for (size_t i = 0; i < n; ++i) {
+        auto t = now_ns();
+        memcpy(&payload[0], &t, sizeof(t));
+        const auto& topic = topics[i % topics.size()];
+        toks.push_back(pub.publish(topic, payload.data(), payload.size(), QOS, false));
+    }
+    for (auto& tok : toks) tok->wait();
+    toks.clear();
+}
+
+// Receives a batch, either by waiting on the receiver or by reading the
+// consumer queue.
+bool receive_batch(mode m, clients& cli, receiver& rcv, size_t n)
+{
+    if (m != mode::CONSUMER)
+        return rcv.wait_for(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        auto msg = cli.sub->consume_message();
+        if (!msg)
+            return false;
+        rcv.on_message(msg);
+    }
+    rcv.wait_for(n);
+    return true;
+}
+
+vector<string> make_topics(size_t n)
+{
+    vector<string> topics;
+    for (size_t i = 0; i < n; ++i) topics.push_back(TOPIC_PREFIX + to_string(i));
+    return topics;
+}
+
+// --------------------------------------------------------------------------
+
+int run_bench(const string& serverURI, size_t nMsg, size_t nSamples)
+{
+    vector<mqtt::delivery_token_ptr> toks;
+    toks.reserve(nMsg);
+
+    struct result
+    {
+        string name;
+        bench::stats latency;
+    };
+    vector<result> latencies;
+
+    bench::print_header("ns/msg");
+
+    for (auto m : {mode::CALLBACK, mode::CONSUMER, mode::HANDLER, mode::DISPATCHER}) {
+        // A new pair of clients for each mode
+        receiver rcv;
+        clients cli{serverURI};
+
+        if (m == mode::DISPATCHER && !cli.has_dispatcher())
+            continue;
+
+        cli.connect(nMsg);
+        cli.attach(m, rcv);
+
+        for (size_t nFilters : {1, 64}) {
+            cli.subscribe(nFilters);
+
+            for (size_t nTopics : {1, 64}) {
+                auto topics = make_topics(nTopics);
+
+                for (size_t sz : {16, 256, 4096}) {
+                    rcv.reserve(nMsg * (nSamples + 1));
+
+                    bool ok = true;
+                    auto st = bench::run(nSamples, nMsg, [&](size_t n) {
+                        publish_batch(*cli.pub, topics, sz, n, toks);
+                        ok = receive_batch(m, cli, rcv, n) && ok;
+                    });
+
+                    auto name = string{mode_name(m)} + " " + to_string(sz) + "B " +
+                                to_string(nTopics) + "t " + to_string(nFilters) + "f";
+                    if (!ok)
+                        name += " (lost)";
+
+                    bench::print(name, st);
+                    latencies.push_back({name, bench::summarize(rcv.take_latencies())});
+                }
+            }
+            cli.unsubscribe(nFilters);
+        }
+
+        cli.detach(m);
+        cli.disconnect();
+    }
+
+    cout << endl;
+    bench::print_header("us latency");
+    for (const auto& res : latencies) bench::print(res.name, res.latency);
+
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+
+int run_soak(const string& serverURI, size_t nSecs)
+{
+    const size_t N_BATCH = 1000, PAYLOAD_SZ = 256;
+
+    receiver rcv;
+    clients cli{serverURI};
+    cli.connect(N_BATCH);
+    cli.subscribe(1);
+
+    cli.attach(mode::CALLBACK, rcv);
+
+    auto topics = make_topics(16);
+    vector<mqtt::delivery_token_ptr> toks;
+    toks.reserve(N_BATCH);
+
+    printf("%8s %12s %12s %10s %12s\n", "secs", "msgs", "msgs/s", "rss kB", "allocs/msg");
+
+    auto start = steady_clock::now(), end = start + seconds(nSecs);
+    auto last = start;
+    uint64_t nTotal = 0, nLast = 0, allocsLast = nAllocs;
+    size_t nLost = 0;
+
+    while (steady_clock::now() < end) {
+        publish_batch(*cli.pub, topics, PAYLOAD_SZ, N_BATCH, toks);
+        if (!rcv.wait_for(N_BATCH))
+            ++nLost;
+        nTotal += N_BATCH;
+
+        auto now = steady_clock::now();
+        if (now - last >= seconds(1)) {
+            uint64_t allocs = nAllocs;
+            auto n = nTotal - nLast;
+            printf(
+                "%8.0f %12llu %12.0f %10zu %12.2f\n",
+                duration<double>(now - start).count(), (unsigned long long)nTotal,
+                double(n) / duration<double>(now - last).count(), rss_kb(),
+                double(allocs - allocsLast) / double(n)
+            );
+            fflush(stdout);
+
+            nLast = nTotal;
+            allocsLast = allocs;
+            last = now;
+        }
+    }
+
+    if (nLost)
+        cerr << nLost << " batch(es) had lost messages" << endl;
+
+    cli.detach(mode::CALLBACK);
+    cli.disconnect();
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    try {
+        if (argc > 1 && string{argv[1]} == "--soak") {
+            string serverURI = (argc > 2) ? string{argv[2]} : DFLT_SERVER_URI;
+            size_t nSecs = (argc > 3) ? size_t(atol(argv[3])) : DFLT_SOAK_SECS;
+            return run_soak(serverURI, nSecs);
+        }
+
+        string serverURI = (argc > 1) ? string{argv[1]} : DFLT_SERVER_URI;
+        size_t nMsg = (argc > 2) ? size_t(atol(argv[2])) : DFLT_N_MSG;
+        size_t nSamples = (argc > 3) ? size_t(atol(argv[3])) : DFLT_N_SAMPLES;
+
+        if (nMsg == 0)
+            nMsg = 1;
+
+        return run_bench(serverURI, nMsg, nSamples);
+    }
+    catch (const mqtt::exception& exc) {
+        cerr << exc.what() << endl;
+        return 1;
+    }
+}
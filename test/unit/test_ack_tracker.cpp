@@ -0,0 +1,203 @@
+// test_ack_tracker.cpp
+//
+// Unit tests for the ack_tracker class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/ack_tracker.h"
+#include "mqtt/async_client.h"
+
+using namespace mqtt;
+
+namespace {
+
+message_ptr qos1_message(const string& payload) {
+    return message::create("a/b", payload, 1, false);
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("ack_tracker in order release", "[ack_tracker]")
+{
+    std::vector<string> released;
+    auto tracker = ack_tracker::create(0, [&released](const const_message_ptr& msg) {
+        released.push_back(msg->get_payload_str());
+    });
+
+    auto m1 = qos1_message("1"), m2 = qos1_message("2"), m3 = qos1_message("3");
+    REQUIRE(!m1->has_ack());
+
+    REQUIRE(tracker->track(m1));
+    REQUIRE(tracker->track(m2));
+    REQUIRE(tracker->track(m3));
+    REQUIRE(m1->has_ack());
+    REQUIRE(3 == tracker->num_in_flight());
+    REQUIRE(3 == tracker->num_tracked());
+
+    // Out of order acks wait for the first one
+    REQUIRE(0 == m3->ack());
+    REQUIRE(0 == m2->ack());
+    REQUIRE(released.empty());
+    REQUIRE(3 == tracker->num_in_flight());
+
+    REQUIRE(3 == m1->ack());
+    REQUIRE(released == std::vector<string>{"1", "2", "3"});
+    REQUIRE(0 == tracker->num_in_flight());
+    REQUIRE(3 == tracker->num_released());
+
+    // Acking again does nothing
+    REQUIRE(0 == m2->ack());
+    REQUIRE(3 == released.size());
+}
+
+TEST_CASE("ack_tracker qos 0", "[ack_tracker]")
+{
+    auto tracker = ack_tracker::create();
+    auto msg = message::create("a/b", "0");
+
+    REQUIRE(!tracker->track(msg));
+    REQUIRE(!msg->has_ack());
+    REQUIRE(0 == msg->ack());
+    REQUIRE(0 == tracker->num_tracked());
+}
+
+TEST_CASE("ack_tracker max in flight", "[ack_tracker]")
+{
+    auto tracker = ack_tracker::create(2);
+    REQUIRE(2 == tracker->get_max_in_flight());
+
+    auto m1 = qos1_message("1"), m2 = qos1_message("2");
+    tracker->track(m1);
+    REQUIRE(!tracker->full());
+    tracker->track(m2);
+    REQUIRE(tracker->full());
+
+    // An ack that's waiting on an earlier one doesn't make room
+    m2->ack();
+    REQUIRE(tracker->full());
+    m1->ack();
+    REQUIRE(!tracker->full());
+}
+
+TEST_CASE("ack_tracker concurrent acks", "[ack_tracker]")
+{
+    const size_t N = 1000;
+    std::vector<string> released;
+    auto tracker = ack_tracker::create(0, [&released](const const_message_ptr& msg) {
+        released.push_back(msg->get_payload_str());
+    });
+
+    std::vector<message_ptr> msgs;
+    for (size_t i = 0; i < N; ++i) {
+        msgs.push_back(qos1_message(std::to_string(i)));
+        tracker->track(msgs.back());
+    }
+
+    // Ack the odd and even ones from different threads
+    std::thread thr{[&msgs] {
+        for (size_t i = 1; i < N; i += 2) msgs[i]->ack();
+    }};
+    for (size_t i = 0; i < N; i += 2) msgs[i]->ack();
+    thr.join();
+
+    REQUIRE(N == released.size());
+    for (size_t i = 0; i < N; ++i) REQUIRE(std::to_string(i) == released[i]);
+    REQUIRE(0 == tracker->num_in_flight());
+}
+
+TEST_CASE("async_client manual ack", "[ack_tracker]")
+{
+    async_client cli{"tcp://localhost:1883", "test_ack_tracker"};
+    REQUIRE(!cli.get_ack_tracker());
+
+    auto tracker = cli.start_manual_ack(10);
+    REQUIRE(tracker == cli.get_ack_tracker());
+    REQUIRE(10 == tracker->get_max_in_flight());
+
+    cli.stop_manual_ack();
+    REQUIRE(!cli.get_ack_tracker());
+}
+
+TEST_CASE("async_client manual ack with a lossy queue", "[ack_tracker]")
+{
+    async_client cli{"tcp://localhost:1883", "test_ack_tracker"};
+    auto tracker = cli.start_manual_ack(2);
+
+    // Messages the consumer never sees must not hold up the acks, or fill
+    // the window for good.
+    auto arrive = [&cli](const string& topic) {
+        return cli.test_message_arrived(*message::create(topic, "x", 1, false));
+    };
+
+    SECTION("drop oldest")
+    {
+        cli.start_consuming<thread_queue<event>>(1, thread_queue<event>::MAX_CAPACITY,
+                                                 thread_queue<event>::DROP_OLDEST);
+        for (int i = 0; i < 5; ++i) REQUIRE(arrive("a/b") != 0);
+        REQUIRE(4 == tracker->num_released());
+        REQUIRE(1 == tracker->num_in_flight());
+    }
+
+    SECTION("drop newest")
+    {
+        cli.start_consuming<thread_queue<event>>(1, thread_queue<event>::MAX_CAPACITY,
+                                                 thread_queue<event>::DROP_NEWEST);
+        REQUIRE(arrive("a/0") != 0);
+        REQUIRE(arrive("a/1") != 0);
+
+        // The dropped one is acked, but waits for the one ahead of it
+        REQUIRE(0 == tracker->num_released());
+        REQUIRE(2 == tracker->num_in_flight());
+
+        auto msg = cli.consume_message();
+        REQUIRE("a/0" == msg->get_topic());
+        msg->ack();
+        REQUIRE(2 == tracker->num_released());
+        REQUIRE(0 == tracker->num_in_flight());
+    }
+
+    SECTION("conflate")
+    {
+        cli.start_consuming<thread_queue<event>>(1, thread_queue<event>::MAX_CAPACITY,
+                                                 thread_queue<event>::CONFLATE);
+        for (int i = 0; i < 5; ++i) REQUIRE(arrive("a/b") != 0);
+        REQUIRE(4 == tracker->num_released());
+        REQUIRE(1 == tracker->num_in_flight());
+    }
+
+    SECTION("conflating queue")
+    {
+        cli.start_consuming_conflated();
+        for (int i = 0; i < 5; ++i) REQUIRE(arrive("a/b") != 0);
+        REQUIRE(4 == tracker->num_released());
+
+        // The pending message is acked when the queue is cleared
+        cli.clear_consumer();
+        REQUIRE(5 == tracker->num_released());
+        REQUIRE(0 == tracker->num_in_flight());
+    }
+}
@@ -0,0 +1,156 @@
+// test_asio.cpp
+//
+// Unit tests for the Asio adapters in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mock_async_client.h"
+#include "mqtt/asio.h"
+
+using namespace mqtt;
+namespace net = boost::asio;
+
+static mock_async_client mock_cli;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("asio async_wait callback", "[asio]")
+{
+    net::io_context ioc;
+    auto tok = token::create(token::Type::PUBLISH, mock_cli);
+
+    bool called = false;
+    std::thread::id callThread;
+    async_wait(tok, [&](std::exception_ptr eptr, token_ptr t) {
+        called = true;
+        callThread = std::this_thread::get_id();
+        REQUIRE(!eptr);
+        REQUIRE(tok == t);
+    });
+
+    // A handler without an executor runs on the completing thread
+    MQTTAsync_successData data{};
+    mock_async_client::succeed(tok.get(), &data);
+    REQUIRE(called);
+    REQUIRE(std::this_thread::get_id() == callThread);
+
+    // A handler bound to an executor runs there
+    called = false;
+    tok = token::create(token::Type::PUBLISH, mock_cli);
+    async_wait(tok, net::bind_executor(ioc, [&](std::exception_ptr eptr, token_ptr) {
+                   called = true;
+                   REQUIRE(!eptr);
+               }));
+    mock_async_client::succeed(tok.get(), &data);
+    REQUIRE(!called);
+    ioc.run();
+    REQUIRE(called);
+}
+
+TEST_CASE("asio async_wait already complete", "[asio]")
+{
+    auto tok = token::create(token::Type::PUBLISH, mock_cli);
+    MQTTAsync_successData data{};
+    mock_async_client::succeed(tok.get(), &data);
+
+    bool called = false;
+    async_wait(tok, [&](std::exception_ptr eptr, token_ptr) {
+        called = true;
+        REQUIRE(!eptr);
+    });
+    REQUIRE(called);
+}
+
+TEST_CASE("asio async_wait future", "[asio]")
+{
+    auto tok = token::create(token::Type::PUBLISH, mock_cli);
+    std::future<token_ptr> fut = async_wait(tok, net::use_future);
+    REQUIRE(std::future_status::timeout == fut.wait_for(std::chrono::milliseconds(0)));
+
+    MQTTAsync_failureData data{};
+    data.code = MQTTASYNC_FAILURE;
+    mock_async_client::fail(tok.get(), &data);
+
+    REQUIRE_THROWS_AS(fut.get(), exception);
+}
+
+TEST_CASE("asio async_publish error", "[asio]")
+{
+    // Not connected, and no buffering, so the publish throws, which
+    // completes the handler rather than escaping from the call.
+    async_client cli{"tcp://localhost:1883", "test_asio"};
+
+    bool called = false;
+    async_publish(cli, make_message("a/b", "x"), [&](std::exception_ptr eptr, delivery_token_ptr) {
+        called = true;
+        REQUIRE(eptr);
+    });
+    REQUIRE(called);
+}
+
+TEST_CASE("asio executor", "[asio]")
+{
+    net::io_context ioc;
+    auto exec = make_asio_executor(ioc.get_executor());
+
+    int n = 0;
+    REQUIRE(exec->execute([&n] { ++n; }));
+    REQUIRE(0 == n);
+    ioc.run();
+    REQUIRE(1 == n);
+}
+
+TEST_CASE("asio message poster", "[asio]")
+{
+    net::io_context ioc;
+    auto strand = net::make_strand(ioc);
+
+    std::vector<std::vector<string>> batches;
+    auto poster = make_asio_message_poster(
+        strand,
+        [&batches](const std::vector<const_message_ptr>& msgs) {
+            std::vector<string> batch;
+            for (const auto& msg : msgs) batch.push_back(msg->get_payload_str());
+            batches.push_back(std::move(batch));
+        },
+        3
+    );
+
+    // A burst is one post, cut into batches of three
+    for (int i = 0; i < 5; ++i) poster->post(make_message("a/b", std::to_string(i)));
+    REQUIRE(1 == poster->num_posts());
+
+    ioc.run();
+    REQUIRE(2 == batches.size());
+    REQUIRE(std::vector<string>{"0", "1", "2"} == batches[0]);
+    REQUIRE(std::vector<string>{"3", "4"} == batches[1]);
+    REQUIRE(2 == poster->num_posts());
+
+    // Attached to a client, it's the message callback
+    async_client cli{"tcp://localhost:1883", "test_asio"};
+    poster->attach(cli);
+    cli.set_message_callback(nullptr);
+}
@@ -22,8 +22,16 @@
  *******************************************************************************/
 #define UNIT_TESTS
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 #include "catch2_version.h"
 #include "mock_action_listener.h"
+#include "mock_async_client.h"
 #include "mock_callback.h"
 #include "mock_persistence.h"
 #include "mqtt/async_client.h"
@@ -588,6 +596,205 @@ TEST_CASE("async_client publish 5 args", "[client]")
     REQUIRE(!cli.is_connected());
 }
 
+TEST_CASE("async_client publish gathered", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    token_ptr conn_tok{cli.connect()};
+    REQUIRE(conn_tok);
+    conn_tok->wait();
+    REQUIRE(cli.is_connected());
+
+    const std::string hdr{"header:"};
+    delivery_token_ptr token_pub{cli.publish(TOPIC, {hdr, PAYLOAD}, GOOD_QOS, RETAINED)};
+    REQUIRE(token_pub);
+    REQUIRE(token_pub->get_message()->get_payload() == hdr + PAYLOAD);
+    token_pub->wait_for(TIMEOUT);
+
+    token_ptr disconn_tok{cli.disconnect()};
+    REQUIRE(disconn_tok);
+    disconn_tok->wait();
+    REQUIRE(!cli.is_connected());
+}
+
+TEST_CASE("async_client publish gathered failure", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    int return_code = MQTTASYNC_SUCCESS;
+    try {
+        const std::string hdr{"header:"};
+        delivery_token_ptr token_pub{cli.publish(TOPIC, {hdr, PAYLOAD})};
+        REQUIRE(token_pub);
+        token_pub->wait_for(TIMEOUT);
+    }
+    catch (mqtt::exception& ex) {
+        return_code = ex.get_return_code();
+    }
+    REQUIRE(MQTTASYNC_DISCONNECTED == return_code);
+}
+
+TEST_CASE("async_client publish qos0", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    token_ptr conn_tok{cli.connect()};
+    REQUIRE(conn_tok);
+    conn_tok->wait();
+    REQUIRE(cli.is_connected());
+
+    cli.publish_qos0(TOPIC, PAYLOAD.data(), PAYLOAD.size());
+    cli.publish_qos0(TOPIC, PAYLOAD, RETAINED);
+
+    token_ptr disconn_tok{cli.disconnect()};
+    REQUIRE(disconn_tok);
+    disconn_tok->wait();
+    REQUIRE(!cli.is_connected());
+}
+
+TEST_CASE("async_client publish qos0 failure", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    int return_code = MQTTASYNC_SUCCESS;
+    try {
+        cli.publish_qos0(TOPIC, PAYLOAD);
+    }
+    catch (mqtt::exception& ex) {
+        return_code = ex.get_return_code();
+    }
+    REQUIRE(MQTTASYNC_DISCONNECTED == return_code);
+}
+
+TEST_CASE("async_client completion executor", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.get_completion_executor());
+
+    auto exec = std::make_shared<thread_executor>();
+    cli.set_completion_executor(exec);
+    REQUIRE(exec == cli.get_completion_executor());
+
+    cli.set_completion_executor(nullptr);
+    REQUIRE(!cli.get_completion_executor());
+}
+
+TEST_CASE("async_client publish batch", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    token_ptr conn_tok{cli.connect()};
+    REQUIRE(conn_tok);
+    conn_tok->wait();
+    REQUIRE(cli.is_connected());
+
+    std::vector<const_message_ptr> msgs;
+    for (int i = 0; i < 8; ++i) msgs.push_back(message::create(TOPIC, PAYLOAD, GOOD_QOS, RETAINED));
+
+    batch_token_ptr tok = cli.publish_batch(msgs);
+    REQUIRE(tok);
+    REQUIRE(8 == tok->size());
+    REQUIRE(tok->wait_for(TIMEOUT));
+    REQUIRE(0 == tok->num_failed());
+
+    token_ptr disconn_tok{cli.disconnect()};
+    REQUIRE(disconn_tok);
+    disconn_tok->wait_for(TIMEOUT);
+    REQUIRE(!cli.is_connected());
+}
+
+TEST_CASE("async_client publish batch failure", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    std::vector<const_message_ptr> msgs{
+        message::create(TOPIC, PAYLOAD, GOOD_QOS, RETAINED),
+        message::create(TOPIC, PAYLOAD, GOOD_QOS, RETAINED)
+    };
+
+    int return_code = MQTTASYNC_SUCCESS;
+    try {
+        cli.publish_batch(msgs);
+    }
+    catch (mqtt::exception& ex) {
+        return_code = ex.get_return_code();
+    }
+    REQUIRE(MQTTASYNC_DISCONNECTED == return_code);
+
+    // An empty batch is complete right away
+    auto tok = cli.publish_batch({});
+    REQUIRE(tok->is_complete());
+}
+
+TEST_CASE("async_client subscribe batch", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    token_ptr conn_tok{cli.connect()};
+    REQUIRE(conn_tok);
+    conn_tok->wait();
+    REQUIRE(cli.is_connected());
+
+    cli.set_subscribe_chunk_size(10);
+    REQUIRE(10 == cli.get_subscribe_chunk_size());
+
+    auto topics = std::make_shared<string_collection>();
+    iasync_client::qos_collection qos;
+    for (int i = 0; i < 25; ++i) {
+        topics->push_back("batch/topic/" + std::to_string(i));
+        qos.push_back(GOOD_QOS);
+    }
+
+    batch_token_ptr tok = cli.subscribe_batch(topics, qos);
+    REQUIRE(tok);
+    REQUIRE(25 == tok->size());
+    REQUIRE(3 == tok->num_requests());
+    REQUIRE(tok->wait_for(TIMEOUT));
+    REQUIRE(0 == tok->num_failed());
+
+    tok = cli.unsubscribe_batch(topics);
+    REQUIRE(tok->wait_for(TIMEOUT));
+    REQUIRE(0 == tok->num_failed());
+
+    token_ptr disconn_tok{cli.disconnect()};
+    REQUIRE(disconn_tok);
+    disconn_tok->wait_for(TIMEOUT);
+    REQUIRE(!cli.is_connected());
+}
+
+TEST_CASE("async_client subscribe batch failure", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    REQUIRE_THROWS_AS(cli.set_subscribe_chunk_size(0), std::invalid_argument);
+    REQUIRE(async_client::DFLT_SUBSCRIBE_CHUNK_SIZE == cli.get_subscribe_chunk_size());
+
+    auto topics = string_collection::create({"a", "b"});
+
+    REQUIRE_THROWS_AS(cli.subscribe_batch(topics, iasync_client::qos_collection{0}), std::invalid_argument);
+
+    int return_code = MQTTASYNC_SUCCESS;
+    try {
+        cli.subscribe_batch(topics, iasync_client::qos_collection{0, 1});
+    }
+    catch (mqtt::exception& ex) {
+        return_code = ex.get_return_code();
+    }
+    REQUIRE(MQTTASYNC_DISCONNECTED == return_code);
+
+    // An empty batch is complete right away
+    auto tok = cli.subscribe_batch(std::make_shared<string_collection>(), iasync_client::qos_collection{});
+    REQUIRE(tok->is_complete());
+}
+
 TEST_CASE("async_client publish 7 args", "[client]")
 {
     async_client cli{GOOD_SERVER_URI, CLIENT_ID};
@@ -1000,6 +1207,126 @@ TEST_CASE("async_client unsubscribe many topics 3 args failure", "[client]")
     REQUIRE(MQTTASYNC_DISCONNECTED == return_code);
 }
 
+TEST_CASE("async_client subscribe single topic handler failure", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.is_connected());
+
+    int return_code = MQTTASYNC_SUCCESS;
+    try {
+        token_ptr sub_tok{
+            cli.subscribe(TOPIC, GOOD_QOS, [](const_message_ptr) {})
+        };
+        REQUIRE(sub_tok);
+        sub_tok->wait_for(TIMEOUT);
+    }
+    catch (mqtt::exception& ex) {
+        return_code = ex.get_return_code();
+    }
+    REQUIRE(MQTTASYNC_DISCONNECTED == return_code);
+
+    // Unsubscribing a filter with no handler is harmless
+    REQUIRE_THROWS_AS(cli.unsubscribe(TOPIC), mqtt::exception);
+}
+
+TEST_CASE("async_client subscription identifiers", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+
+    int nAll = 0, nOne = 0;
+    auto idAll = cli.test_add_sub_handler("a/#", [&](const_message_ptr) { ++nAll; }, true);
+    auto idOne = cli.test_add_sub_handler("a/b", [&](const_message_ptr) { ++nOne; }, true);
+
+    REQUIRE(0 != idAll);
+    REQUIRE(0 != idOne);
+    REQUIRE(idAll != idOne);
+
+    // The identifier goes straight to its handler, without matching
+    properties props{{property::SUBSCRIPTION_IDENTIFIER, int32_t(idOne)}};
+    auto msg = message::create("a/b", "x", 1, false, props);
+    REQUIRE(cli.test_dispatch(msg));
+    REQUIRE(0 == nAll);
+    REQUIRE(1 == nOne);
+
+    // Without one, the topic is matched against the filters
+    REQUIRE(cli.test_dispatch(message::create("a/b", "x")));
+    REQUIRE(1 == nAll);
+    REQUIRE(2 == nOne);
+
+    // So with an unknown one
+    props = properties{{property::SUBSCRIPTION_IDENTIFIER, int32_t(idOne + 100)}};
+    REQUIRE(cli.test_dispatch(message::create("a/b", "x", 1, false, props)));
+    REQUIRE(2 == nAll);
+    REQUIRE(3 == nOne);
+
+    REQUIRE(!cli.test_dispatch(message::create("c", "x")));
+
+    // Replacing a handler gives it a new identifier, and the old one is
+    // no longer known.
+    auto idNew = cli.test_add_sub_handler("a/b", [&](const_message_ptr) { nOne += 10; }, true);
+    REQUIRE(idNew != idOne);
+
+    props = properties{{property::SUBSCRIPTION_IDENTIFIER, int32_t(idNew)}};
+    auto newMsg = message::create("a/b", "x", 1, false, props);
+    REQUIRE(cli.test_dispatch(newMsg));
+    REQUIRE(2 == nAll);
+    REQUIRE(13 == nOne);
+
+    REQUIRE(cli.test_dispatch(msg));
+    REQUIRE(3 == nAll);
+    REQUIRE(23 == nOne);
+
+    // A handler without an identifier means they can't all be found by one
+    cli.test_add_sub_handler("a/+", [](const_message_ptr) {}, false);
+    REQUIRE(cli.test_dispatch(newMsg));
+    REQUIRE(4 == nAll);
+    REQUIRE(33 == nOne);
+}
+
+TEST_CASE("async_client throwing sub handler", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+
+    int nBad = 0, nGood = 0;
+    cli.test_add_sub_handler(
+        "bad",
+        [&](const_message_ptr) {
+            ++nBad;
+            throw std::runtime_error("handler failed");
+        },
+        false
+    );
+    cli.test_add_sub_handler("good", [&](const_message_ptr) { ++nGood; }, false);
+
+    REQUIRE_THROWS_AS(cli.test_dispatch(message::create("bad", "x")), std::runtime_error);
+    REQUIRE(1 == nBad);
+
+    // The next message on the thread only goes to its own handler
+    REQUIRE(cli.test_dispatch(message::create("good", "x")));
+    REQUIRE(1 == nBad);
+    REQUIRE(1 == nGood);
+}
+
+TEST_CASE("async_client dispatching", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.get_dispatcher());
+
+    cli.start_dispatching(3, [](const_message_ptr) {});
+    auto disp = cli.get_dispatcher();
+    REQUIRE(disp);
+    REQUIRE(3 == disp->num_threads());
+
+    // Restarting replaces and stops the previous dispatcher
+    cli.start_dispatching(2, [](const_message_ptr) {});
+    REQUIRE(disp->stopped());
+    REQUIRE(2 == cli.get_dispatcher()->num_threads());
+
+    cli.stop_dispatching();
+    REQUIRE(!cli.get_dispatcher());
+    cli.stop_dispatching();
+}
+
 TEST_CASE("async_client consumer timeout", "[client]")
 {
     // This just compiling shows #343 fixed.
@@ -1008,6 +1335,284 @@ TEST_CASE("async_client consumer timeout", "[client]")
     cli.try_consume_message_until(std::chrono::steady_clock::now());
 }
 
+TEST_CASE("async_client lock-free consumer", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.start_consuming<lock_free_queue<event>>(16);
+    REQUIRE(0 == cli.consumer_queue_size());
+    REQUIRE(!cli.consumer_closed());
+
+    event evt;
+    REQUIRE(!cli.try_consume_event_for(&evt, std::chrono::milliseconds(5)));
+
+    std::vector<event> evts;
+    REQUIRE(0 == cli.try_consume_events(evts, 8));
+    REQUIRE(0 == cli.consume_events(evts, 8, std::chrono::milliseconds(5)));
+
+    cli.stop_consuming();
+    REQUIRE(cli.consumer_closed());
+    REQUIRE(cli.consumer_done());
+
+    // A closed queue gives a shutdown event
+    REQUIRE(1 == cli.consume_events(evts, 8, std::chrono::milliseconds(5)));
+    REQUIRE(evts.size() == 1);
+    REQUIRE(evts[0].is_any_disconnect());
+}
+
+TEST_CASE("async_client bounded consumer", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(0 == cli.get_flow_control_capacity());
+
+    REQUIRE_THROWS_AS(cli.start_consuming_bounded(0), std::invalid_argument);
+
+    cli.start_consuming_bounded(8);
+    REQUIRE(8 == cli.get_flow_control_capacity());
+    REQUIRE(0 == cli.consumer_queue_size());
+    REQUIRE(!cli.consumer_closed());
+
+    // The Receive Maximum is only added for MQTT v5
+    auto connOpts = connect_options_builder::v5().finalize();
+    try {
+        cli.connect(connOpts);
+    }
+    catch (const exception&) {
+    }
+    auto props = cli.get_connect_options().get_properties();
+    REQUIRE(props.contains(property::RECEIVE_MAXIMUM));
+    REQUIRE(8 == get<uint16_t>(props, property::RECEIVE_MAXIMUM));
+
+    // An unbounded queue turns off flow control
+    cli.stop_consuming();
+    cli.start_consuming();
+    REQUIRE(0 == cli.get_flow_control_capacity());
+}
+
+TEST_CASE("async_client byte-bounded consumer", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(0 == cli.consumer_queue_dropped());
+
+    // Never blocks the callback thread; the oldest messages give way
+    const std::string BIG(100000, 'x');
+    cli.start_consuming<thread_queue<event>>(1000, 250000, thread_queue<event>::DROP_OLDEST);
+
+    for (int i = 0; i < 5; ++i) cli.test_message_arrived(TOPIC, BIG.data(), BIG.size());
+
+    REQUIRE(2 == cli.consumer_queue_size());
+    REQUIRE(3 == cli.consumer_queue_dropped());
+}
+
+TEST_CASE("async_client bounded consumer keeps receive maximum", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.start_consuming_bounded(100000);
+
+    auto connOpts =
+        connect_options_builder::v5().properties({{property::RECEIVE_MAXIMUM, 10}}).finalize();
+    try {
+        cli.connect(connOpts);
+    }
+    catch (const exception&) {
+    }
+    REQUIRE(
+        10 == get<uint16_t>(cli.get_connect_options().get_properties(), property::RECEIVE_MAXIMUM)
+    );
+}
+
+TEST_CASE("async_client bounded consumer large capacity", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.start_consuming_bounded(100000);
+
+    try {
+        cli.connect(connect_options_builder::v5().finalize());
+    }
+    catch (const exception&) {
+    }
+    REQUIRE(
+        65535 ==
+        get<uint16_t>(cli.get_connect_options().get_properties(), property::RECEIVE_MAXIMUM)
+    );
+}
+
+TEST_CASE("async_client rate limiting", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.get_rate_limiter());
+
+    cli.start_rate_limiting(50.0, 1000.0, rate_limiter::QUEUE);
+    auto lim = cli.get_rate_limiter();
+    REQUIRE(lim);
+    REQUIRE(rate_limiter::QUEUE == lim->get_policy());
+    REQUIRE(50.0 == lim->get_message_rate());
+    REQUIRE(1000.0 == lim->get_byte_rate());
+
+    cli.stop_rate_limiting();
+    REQUIRE(!cli.get_rate_limiter());
+    REQUIRE(lim->stopped());
+}
+
+TEST_CASE("async_client rate limiting fail", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.start_rate_limiting(1.0, 0.0, rate_limiter::FAIL);
+
+    // The first message gets past the limiter, but the client isn't connected
+    try {
+        cli.publish(TOPIC, "hello", 5, 1, false);
+        FAIL("publish should fail when not connected");
+    }
+    catch (const exception& exc) {
+        REQUIRE(MQTTASYNC_DISCONNECTED == exc.get_return_code());
+    }
+
+    try {
+        cli.publish(TOPIC, "hello", 5, 1, false);
+        FAIL("publish should exceed the rate");
+    }
+    catch (const exception& exc) {
+        REQUIRE(ReasonCode::QUOTA_EXCEEDED == exc.get_reason_code());
+    }
+
+    REQUIRE(cli.get_pending_delivery_tokens().empty());
+}
+
+TEST_CASE("async_client rate limiting queue", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.start_rate_limiting(0.5, 0.0, rate_limiter::QUEUE);
+
+    // The publish returns right away, and the send fails through the token
+    auto tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(tok);
+    REQUIRE_THROWS_AS(tok->wait(), exception);
+    REQUIRE(MQTTASYNC_DISCONNECTED == tok->get_return_code());
+
+    // The next one is still queued when the limiter stops
+    tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(1 == cli.get_rate_limiter()->queue_size());
+    cli.stop_rate_limiting();
+    REQUIRE_THROWS_AS(tok->wait(), exception);
+    REQUIRE(MQTTASYNC_OPERATION_INCOMPLETE == tok->get_return_code());
+    REQUIRE(cli.get_pending_delivery_tokens().empty());
+}
+
+TEST_CASE("async_client offline buffering", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.get_offline_buffer());
+
+    cli.start_offline_buffering(2);
+    auto buf = cli.get_offline_buffer();
+    REQUIRE(buf);
+
+    // Not connected, so the messages are held
+    auto tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    auto tok2 = cli.publish("other/topic", "hi", 2, 1, false);
+    REQUIRE(2 == buf->size());
+    REQUIRE(7 == buf->num_bytes());
+    REQUIRE(2 == cli.get_metrics().num_pending_delivery_tokens());
+
+    try {
+        cli.publish(TOPIC, "full", 4, 1, false);
+        FAIL("publish to a full buffer should throw");
+    }
+    catch (const exception& exc) {
+        REQUIRE(MQTTASYNC_MAX_BUFFERED_MESSAGES == exc.get_return_code());
+    }
+    REQUIRE(2 == cli.get_metrics().num_pending_delivery_tokens());
+
+    // A dropped message fails its token
+    REQUIRE(1 == buf->remove_if([](const message& msg) {
+                return msg.get_topic() == "other/topic";
+            }));
+    REQUIRE_THROWS_AS(tok2->wait(), exception);
+    REQUIRE(MQTTASYNC_OPERATION_INCOMPLETE == tok2->get_return_code());
+    REQUIRE(1 == buf->size());
+
+    // As do the rest, when buffering stops
+    cli.stop_offline_buffering();
+    REQUIRE(!cli.get_offline_buffer());
+    REQUIRE_THROWS_AS(tok->wait(), exception);
+    REQUIRE(MQTTASYNC_OPERATION_INCOMPLETE == tok->get_return_code());
+    REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+}
+
+TEST_CASE("async_client publish coalescing", "[client]")
+{
+    {
+        async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+        REQUIRE(!cli.get_publish_coalescer());
+    }
+
+    auto opts = create_options_builder()
+                    .server_uri(GOOD_SERVER_URI)
+                    .client_id(CLIENT_ID)
+                    .publish_coalescing(std::chrono::seconds(60))
+                    .finalize();
+    async_client cli{opts};
+
+    auto pc = cli.get_publish_coalescer();
+    REQUIRE(pc);
+    REQUIRE(publish_coalescer::DFLT_MAX_BYTES == pc->get_max_bytes());
+
+    // QoS 0 messages are held until flushed
+    cli.publish_qos0(TOPIC, "hello", 5);
+    auto tok = cli.publish(TOPIC, "hello", 5, 0, false);
+    REQUIRE(tok);
+    REQUIRE(2 == pc->num_pending());
+
+    // Others go right away
+    REQUIRE_THROWS_AS(cli.publish(TOPIC, "hello", 5, 1, false), exception);
+    REQUIRE(2 == pc->num_pending());
+
+    // The client isn't connected, so the held publish fails on its token
+    cli.flush_publishes();
+    REQUIRE(0 == pc->num_pending());
+    REQUIRE_THROWS_AS(tok->wait(), exception);
+    REQUIRE(MQTTASYNC_DISCONNECTED == tok->get_return_code());
+    REQUIRE(cli.get_pending_delivery_tokens().empty());
+}
+
+TEST_CASE("async_client topic aliases", "[client]")
+{
+    {
+        async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+        REQUIRE(!cli.get_topic_alias_manager());
+    }
+
+    auto opts = create_options_builder()
+                    .server_uri(GOOD_SERVER_URI)
+                    .client_id(CLIENT_ID)
+                    .max_topic_aliases(16)
+                    .finalize();
+    async_client cli{opts};
+
+    auto mgr = cli.get_topic_alias_manager();
+    REQUIRE(mgr);
+    REQUIRE(16 == mgr->get_limit());
+
+    // No aliases until connected to a server that allows them
+    REQUIRE(0 == mgr->get_maximum());
+    REQUIRE_THROWS_AS(cli.publish_qos0(TOPIC, "hello", 5), exception);
+    REQUIRE(0 == mgr->size());
+}
+
+TEST_CASE("async_client interned topics", "[client]")
+{
+    auto opts = create_options_builder()
+                    .server_uri(GOOD_SERVER_URI)
+                    .client_id(CLIENT_ID)
+                    .max_interned_topics(16)
+                    .finalize();
+
+    async_client cli{opts};
+    REQUIRE(0 == cli.num_interned_topics());
+    cli.clear_interned_topics();
+    REQUIRE(0 == cli.num_interned_topics());
+}
+
 TEST_CASE("async_client consumer queue size", "[client]")
 {
     async_client cli{GOOD_SERVER_URI, CLIENT_ID};
@@ -1027,3 +1632,410 @@ TEST_CASE("async_client consumer queue size", "[client]")
     cli.stop_consuming();
     cli.disconnect()->wait();
 }
+
+TEST_CASE("async_client metrics", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+
+    auto m = cli.get_metrics();
+    REQUIRE(0 == m.messages_sent());
+    REQUIRE(0 == m.messages_received());
+    REQUIRE(0 == m.num_connects());
+    REQUIRE(0 == m.num_pending_tokens());
+    REQUIRE(0 == m.num_pending_delivery_tokens());
+
+    // A publish that the library refuses isn't counted, and doesn't leave
+    // a token behind.
+    if (!cli.is_connected()) {
+        REQUIRE_THROWS_AS(cli.publish(TOPIC, "hello", 5, 1, false), exception);
+
+        m = cli.get_metrics();
+        REQUIRE(0 == m.messages_sent(1));
+        REQUIRE(0 == m.bytes_sent(1));
+        REQUIRE(0 == m.num_publish_failures());
+        REQUIRE(0 == m.num_pending_tokens());
+        REQUIRE(0 == m.num_pending_delivery_tokens());
+    }
+}
+
+TEST_CASE("async_client drops expired messages", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.start_consuming();
+
+    auto expired_msg = [](const string& payload) {
+        auto msg = message::create(
+            TOPIC, payload, 1, false, properties{{property::MESSAGE_EXPIRY_INTERVAL, 10}}
+        );
+        msg->set_timestamp(message::clock::now() - std::chrono::seconds(11));
+        return msg;
+    };
+
+    cli.test_put_event(event{const_message_ptr{expired_msg("old")}});
+    cli.test_put_event(event{make_message(TOPIC, "new")});
+
+    auto msg = cli.consume_message();
+    REQUIRE(msg);
+    REQUIRE("new" == msg->get_payload_str());
+    REQUIRE(1 == cli.get_metrics().num_expired_received());
+
+    cli.test_put_event(event{const_message_ptr{expired_msg("old")}});
+    event evt;
+    REQUIRE(!cli.try_consume_event(&evt));
+    REQUIRE(2 == cli.get_metrics().num_expired_received());
+
+    cli.test_put_event(event{const_message_ptr{expired_msg("old")}});
+    cli.test_put_event(event{make_message(TOPIC, "new")});
+    cli.test_put_event(event{const_message_ptr{expired_msg("old")}});
+
+    std::vector<event> evts;
+    REQUIRE(1 == cli.try_consume_events(evts, 10));
+    REQUIRE(1 == evts.size());
+    REQUIRE("new" == evts[0].get_message()->get_payload_str());
+    REQUIRE(4 == cli.get_metrics().num_expired_received());
+
+    cli.stop_consuming();
+}
+
+TEST_CASE("async_client await message", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    const_message_ptr msg;
+
+    REQUIRE_THROWS_AS(cli.await_message(&msg, [](const_message_ptr) {}), mqtt::exception);
+
+    cli.start_consuming();
+
+    SECTION("ready") {
+        cli.test_put_event(event{connected_event{}});
+        cli.test_put_event(event{make_message(TOPIC, "hello")});
+
+        bool called = false;
+        REQUIRE(!cli.await_message(&msg, [&](const_message_ptr) { called = true; }));
+        REQUIRE(msg);
+        REQUIRE("hello" == msg->get_payload_str());
+        REQUIRE(!called);
+    }
+
+    SECTION("in order") {
+        std::vector<string> got;
+        auto waiter = [&](const_message_ptr m) { got.push_back(m->get_payload_str()); };
+
+        REQUIRE(cli.await_message(&msg, [&](const_message_ptr m) {
+            got.push_back("1:" + m->get_payload_str());
+        }));
+        REQUIRE(cli.await_message(&msg, [&](const_message_ptr m) {
+            got.push_back("2:" + m->get_payload_str());
+        }));
+        REQUIRE(got.empty());
+
+        cli.test_put_event(event{make_message(TOPIC, "a")});
+        cli.test_put_event(event{make_message(TOPIC, "b")});
+
+        REQUIRE(2 == got.size());
+        REQUIRE("1:a" == got[0]);
+        REQUIRE("2:b" == got[1]);
+
+        // Nothing is left in the queue for anyone else
+        REQUIRE(cli.await_message(&msg, waiter));
+        cli.test_put_event(event{make_message(TOPIC, "c")});
+        REQUIRE(3 == got.size());
+        REQUIRE("c" == got[2]);
+    }
+
+    SECTION("disconnect") {
+        bool called = false;
+        const_message_ptr got = make_message(TOPIC, "x");
+
+        REQUIRE(cli.await_message(&msg, [&](const_message_ptr m) {
+            called = true;
+            got = std::move(m);
+        }));
+        cli.test_put_event(event{connection_lost_event{}});
+        REQUIRE(called);
+        REQUIRE(!got);
+    }
+
+    SECTION("stop consuming") {
+        int nNull = 0;
+        auto waiter = [&](const_message_ptr m) {
+            if (!m)
+                ++nNull;
+        };
+
+        REQUIRE(cli.await_message(&msg, waiter));
+        REQUIRE(cli.await_message(&msg, waiter));
+        cli.stop_consuming();
+        REQUIRE(2 == nNull);
+    }
+
+    cli.stop_consuming();
+}
+
+// ----------------------------------------------------------------------
+// Test the batched delivery handler
+// ----------------------------------------------------------------------
+
+TEST_CASE("async_client delivery batch", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+
+    std::vector<std::vector<delivery_token_ptr>> batches;
+    cli.set_delivery_batch_handler(
+        [&](const std::vector<delivery_token_ptr>& toks) { batches.push_back(toks); }, 3,
+        std::chrono::hours(1)
+    );
+
+    auto msg = make_message(TOPIC, PAYLOAD, 1, false);
+    std::vector<delivery_token_ptr> toks;
+    for (int i = 0; i < 5; ++i) {
+        toks.push_back(delivery_token::create(cli, msg));
+        cli.test_add_token(toks.back());
+    }
+
+    // A QoS 0 delivery isn't batched
+    auto tok0 = delivery_token::create(cli, make_message(TOPIC, PAYLOAD, 0, false));
+    cli.test_add_token(tok0);
+    mock_async_client::succeed(tok0.get(), nullptr);
+    REQUIRE(5 == cli.get_metrics().num_pending_delivery_tokens());
+
+    for (int i = 0; i < 4; ++i) mock_async_client::succeed(toks[i].get(), nullptr);
+
+    // The first batch is handed off when it's full. The held deliveries are
+    // complete, but are still in the table.
+    REQUIRE(1 == batches.size());
+    REQUIRE(3 == batches[0].size());
+    REQUIRE(toks[0] == batches[0][0]);
+    REQUIRE(toks[2] == batches[0][2]);
+    REQUIRE(toks[3]->is_complete());
+    REQUIRE(2 == cli.get_metrics().num_pending_delivery_tokens());
+    REQUIRE(cli.get_pending_delivery_tokens().empty());
+
+    // The last one pending flushes the rest
+    mock_async_client::succeed(toks[4].get(), nullptr);
+    REQUIRE(2 == batches.size());
+    REQUIRE(2 == batches[1].size());
+    REQUIRE(toks[4] == batches[1][1]);
+    REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+
+    // Flushing the rest by hand, or by clearing the handler
+    auto tok = delivery_token::create(cli, msg), tok2 = delivery_token::create(cli, msg);
+    cli.test_add_token(tok);
+    cli.test_add_token(tok2);
+    mock_async_client::succeed(tok.get(), nullptr);
+    REQUIRE(2 == batches.size());
+
+    cli.flush_delivery_batch();
+    REQUIRE(3 == batches.size());
+    REQUIRE(tok == batches[2][0]);
+
+    mock_async_client::succeed(tok2.get(), nullptr);
+    REQUIRE(4 == batches.size());
+
+    cli.set_delivery_batch_handler(async_client::delivery_batch_handler{});
+    auto tok3 = delivery_token::create(cli, msg);
+    cli.test_add_token(tok3);
+    mock_async_client::succeed(tok3.get(), nullptr);
+    REQUIRE(4 == batches.size());
+    REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+}
+
+TEST_CASE("async_client delivery batch delay", "[client]")
+{
+    using namespace std::chrono;
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+
+    std::mutex mtx;
+    std::vector<std::vector<delivery_token_ptr>> batches;
+    auto nBatches = [&] {
+        std::lock_guard<std::mutex> g{mtx};
+        return batches.size();
+    };
+
+    cli.set_delivery_batch_handler(
+        [&](const std::vector<delivery_token_ptr>& toks) {
+            std::lock_guard<std::mutex> g{mtx};
+            batches.push_back(toks);
+        },
+        10, milliseconds(20)
+    );
+    auto wheel = cli.get_timer_wheel();
+
+    auto msg = make_message(TOPIC, PAYLOAD, 1, false);
+    auto tok = delivery_token::create(cli, msg), tok2 = delivery_token::create(cli, msg);
+    cli.test_add_token(tok);
+    cli.test_add_token(tok2);
+
+    // With another delivery pending, only the timer hands off the first
+    mock_async_client::succeed(tok.get(), nullptr);
+    REQUIRE(1 == wheel->size());
+    for (int i = 0; i < 200 && nBatches() == 0; ++i) std::this_thread::sleep_for(10ms);
+
+    REQUIRE(1 == nBatches());
+    REQUIRE(tok == batches[0][0]);
+    REQUIRE(1 == cli.get_metrics().num_pending_delivery_tokens());
+
+    // A batch that's handed off otherwise cancels its timer
+    cli.set_delivery_batch_handler(
+        [&](const std::vector<delivery_token_ptr>& toks) {
+            std::lock_guard<std::mutex> g{mtx};
+            batches.push_back(toks);
+        },
+        10, hours(1)
+    );
+    auto tok3 = delivery_token::create(cli, msg);
+    cli.test_add_token(tok3);
+
+    mock_async_client::succeed(tok2.get(), nullptr);
+    REQUIRE(1 == wheel->size());
+    cli.flush_delivery_batch();
+    REQUIRE(2 == nBatches());
+    REQUIRE(wheel->empty());
+
+    // With no limit, there's no timer
+    cli.set_delivery_batch_handler(
+        [&](const std::vector<delivery_token_ptr>& toks) {
+            std::lock_guard<std::mutex> g{mtx};
+            batches.push_back(toks);
+        },
+        10, steady_clock::duration::zero()
+    );
+    auto tok4 = delivery_token::create(cli, msg);
+    cli.test_add_token(tok4);
+    mock_async_client::succeed(tok3.get(), nullptr);
+    REQUIRE(wheel->empty());
+    REQUIRE(2 == nBatches());
+}
+
+// ----------------------------------------------------------------------
+// Test the sharded token table from many threads at once
+// ----------------------------------------------------------------------
+
+TEST_CASE("async_client token table threads", "[client]")
+{
+    auto opts = create_options_builder()
+                    .server_uri(GOOD_SERVER_URI)
+                    .client_id(CLIENT_ID)
+                    .token_table_shards(4)
+                    .finalize();
+    async_client cli{opts};
+
+    const int N_THREADS = 8, N = 2000;
+    auto msg = make_message(TOPIC, PAYLOAD, 1, false);
+    std::atomic<int> nBad{0};
+
+    // The message IDs land in every shard, whatever the token addresses,
+    // so the threads index across each other's shards both ways round.
+    auto work = [&](int t) {
+        std::vector<delivery_token_ptr> toks;
+        for (int i = 0; i < N; ++i) {
+            toks.push_back(delivery_token::create(cli, msg));
+            cli.test_add_token(toks.back());
+            cli.test_index_token(toks.back(), t * N + i + 1);
+
+            if (i % 4 == 3) {
+                for (auto& tok : toks) {
+                    auto id = tok->get_message_id();
+                    if (cli.test_get_delivery_token(id) != tok)
+                        ++nBad;
+                    if (cli.test_remove_token(tok) != tok)
+                        ++nBad;
+                    if (cli.test_get_delivery_token(id))
+                        ++nBad;
+                }
+                toks.clear();
+            }
+        }
+    };
+
+    std::vector<std::thread> thrs;
+    for (int t = 0; t < N_THREADS; ++t) thrs.emplace_back(work, t);
+    for (auto& thr : thrs) thr.join();
+
+    REQUIRE(0 == nBad);
+    REQUIRE(0 == cli.get_metrics().num_pending_tokens());
+    REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+    REQUIRE(cli.get_pending_delivery_tokens().empty());
+}
+
+// ----------------------------------------------------------------------
+// Test flushing the pending deliveries up to a deadline
+// ----------------------------------------------------------------------
+
+TEST_CASE("async_client flush", "[client]")
+{
+    using namespace std::chrono;
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+
+    // Nothing pending
+    REQUIRE(cli.flush(milliseconds(0)).empty());
+
+    auto msg = make_message(TOPIC, PAYLOAD, 1, false);
+    auto tok1 = delivery_token::create(cli, msg), tok2 = delivery_token::create(cli, msg);
+    cli.test_add_token(tok1);
+    cli.test_add_token(tok2);
+
+    SECTION("timeout")
+    {
+        mock_async_client::succeed(tok1.get(), nullptr);
+
+        auto start = steady_clock::now();
+        auto undelivered = cli.flush(milliseconds(20));
+        REQUIRE(steady_clock::now() - start >= milliseconds(20));
+
+        REQUIRE(1 == undelivered.size());
+        REQUIRE(tok2 == undelivered[0]);
+    }
+
+    SECTION("drained")
+    {
+        std::thread thr([&] {
+            std::this_thread::sleep_for(milliseconds(10));
+            mock_async_client::succeed(tok1.get(), nullptr);
+            std::this_thread::sleep_for(milliseconds(10));
+            mock_async_client::succeed(tok2.get(), nullptr);
+        });
+
+        auto undelivered = cli.flush(seconds(10));
+        thr.join();
+
+        REQUIRE(undelivered.empty());
+        REQUIRE(tok2->is_complete());
+        REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+    }
+}
+
+// ----------------------------------------------------------------------
+// Test the consumer queue timestamps of incoming messages
+// ----------------------------------------------------------------------
+
+TEST_CASE("async_client consume timestamps", "[client]")
+{
+    async_client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.start_consuming();
+
+    auto before = message::clock::now();
+    cli.test_message_arrived(TOPIC, PAYLOAD.data(), PAYLOAD.size());
+    cli.test_message_arrived(TOPIC, PAYLOAD.data(), PAYLOAD.size());
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    auto msg = cli.consume_message();
+    REQUIRE(msg);
+    REQUIRE(before <= msg->get_timestamp());
+    REQUIRE(msg->get_timestamp() <= msg->get_queue_time());
+    REQUIRE(msg->get_queue_time() < msg->get_dequeue_time());
+    REQUIRE(msg->get_queue_latency() >= std::chrono::milliseconds(5));
+    REQUIRE(msg->get_consume_latency() >= msg->get_queue_latency());
+
+    std::vector<event> evts;
+    REQUIRE(1 == cli.try_consume_events(evts, 8));
+    auto msg2 = evts[0].get_message();
+    REQUIRE(msg2->get_dequeue_time() >= msg->get_dequeue_time());
+
+    // A message that was never queued has no latency
+    message m{TOPIC, PAYLOAD};
+    REQUIRE(message::time_point{} == m.get_queue_time());
+    REQUIRE(message::clock::duration::zero() == m.get_queue_latency());
+
+    cli.stop_consuming();
+}
@@ -0,0 +1,81 @@
+// test_async_client_pool.cpp
+//
+// Unit tests for the async_client_pool class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/async_client_pool.h"
+
+using namespace mqtt;
+
+static const std::string SERVER_URI{"mqtt://localhost:1883"};
+static const std::string CLIENT_ID{"async_client_pool_test"};
+
+static create_options pool_create_options()
+{
+    return create_options_builder().server_uri(SERVER_URI).client_id(CLIENT_ID).finalize();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("async_client_pool clients", "[async_client_pool]")
+{
+    async_client_pool pool{pool_create_options(), 3};
+
+    REQUIRE(pool.size() == 3);
+    REQUIRE(pool.get_client(0).get_client_id() == CLIENT_ID + "-0");
+    REQUIRE(pool.get_client(2).get_client_id() == CLIENT_ID + "-2");
+    REQUIRE(pool.get_client(1).get_server_uri() == SERVER_URI);
+    REQUIRE_THROWS(pool.get_client(3));
+
+    REQUIRE(!pool.is_connected());
+    REQUIRE(pool.get_pending_delivery_tokens().empty());
+    REQUIRE(pool.flush());
+
+    async_client_pool pool0{pool_create_options(), 0};
+    REQUIRE(pool0.size() >= 1);
+}
+
+TEST_CASE("async_client_pool shard", "[async_client_pool]")
+{
+    async_client_pool pool{pool_create_options(), 4};
+
+    // A topic always maps to the same client
+    for (int i = 0; i < 32; ++i) {
+        auto topic = "data/" + std::to_string(i);
+        auto n = pool.shard(topic);
+        REQUIRE(n < pool.size());
+        REQUIRE(pool.shard(topic) == n);
+        REQUIRE(&pool.client_for(topic) == &pool.get_client(n));
+    }
+}
+
+TEST_CASE("async_client_pool metrics", "[async_client_pool]")
+{
+    async_client_pool pool{pool_create_options(), 2};
+
+    auto metrics = pool.get_metrics();
+    REQUIRE(metrics.messages_sent() == 0);
+    REQUIRE(metrics.num_connects() == 0);
+    REQUIRE(metrics.num_pending_tokens() == 0);
+}
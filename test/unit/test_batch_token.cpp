@@ -0,0 +1,199 @@
+// test_batch_token.cpp
+//
+// Unit tests for the batch_token class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include "catch2_version.h"
+#include "mock_async_client.h"
+#include "mqtt/batch_token.h"
+
+using namespace mqtt;
+
+static mock_async_client cli;
+
+static std::vector<const_message_ptr> make_msgs(size_t n)
+{
+    std::vector<const_message_ptr> msgs;
+    for (size_t i = 0; i < n; ++i)
+        msgs.push_back(message::create("batch/topic", "payload " + std::to_string(i), 1, false));
+    return msgs;
+}
+
+// ----------------------------------------------------------------------
+
+TEST_CASE("batch_token constructor", "[batch_token]")
+{
+    auto tok = batch_token::create(cli, make_msgs(3));
+
+    REQUIRE(token::Type::PUBLISH == tok->get_type());
+    REQUIRE(3 == tok->size());
+    REQUIRE("payload 1" == tok->get_message(1)->to_string());
+    REQUIRE(!tok->is_complete());
+    REQUIRE(0 == tok->num_failed());
+}
+
+TEST_CASE("batch_token empty", "[batch_token]")
+{
+    auto tok = batch_token::create(cli, {});
+
+    REQUIRE(0 == tok->size());
+    REQUIRE(tok->is_complete());
+    REQUIRE(tok->wait_for(0));
+}
+
+TEST_CASE("batch_token all succeed", "[batch_token]")
+{
+    auto tok = batch_token::create(cli, make_msgs(3));
+
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(!tok->is_complete());
+        auto opts = tok->c_struct(i, MQTTVERSION_3_1_1);
+        REQUIRE(opts.onSuccess);
+        REQUIRE(!opts.onSuccess5);
+
+        MQTTAsync_successData data{};
+        opts.onSuccess(opts.context, &data);
+    }
+
+    REQUIRE(tok->is_complete());
+    REQUIRE(MQTTASYNC_SUCCESS == tok->get_return_code());
+    REQUIRE(0 == tok->num_failed());
+    REQUIRE(tok->failed_items().empty());
+    REQUIRE_NOTHROW(tok->wait());
+}
+
+TEST_CASE("batch_token item failure", "[batch_token]")
+{
+    auto tok = batch_token::create(cli, make_msgs(4));
+
+    for (size_t i = 0; i < 4; ++i) {
+        auto opts = tok->c_struct(i, MQTTVERSION_5);
+        REQUIRE(opts.onSuccess5);
+        REQUIRE(opts.onFailure5);
+
+        if (i == 1 || i == 3) {
+            MQTTAsync_failureData5 data = MQTTAsync_failureData5_initializer;
+            data.code = MQTTASYNC_FAILURE;
+            data.reasonCode = MQTTREASONCODE_QUOTA_EXCEEDED;
+            opts.onFailure5(opts.context, &data);
+        }
+        else {
+            MQTTAsync_successData5 data{};
+            opts.onSuccess5(opts.context, &data);
+        }
+    }
+
+    REQUIRE(tok->is_complete());
+    REQUIRE(2 == tok->num_failed());
+    REQUIRE(std::vector<size_t>{1, 3} == tok->failed_items());
+
+    REQUIRE(MQTTASYNC_SUCCESS == tok->get_return_code(0));
+    REQUIRE(MQTTASYNC_FAILURE == tok->get_return_code(1));
+    REQUIRE(ReasonCode::QUOTA_EXCEEDED == tok->get_reason_code(3));
+
+    REQUIRE(MQTTASYNC_FAILURE == tok->get_return_code());
+    REQUIRE(ReasonCode::QUOTA_EXCEEDED == tok->get_reason_code());
+    REQUIRE_THROWS_AS(tok->wait(), mqtt::exception);
+}
+
+TEST_CASE("batch_token subscribe chunks", "[batch_token]")
+{
+    auto topics = string_collection::create({"a", "b", "c", "d", "e"});
+    auto tok = batch_token::create(cli, token::Type::SUBSCRIBE, topics, 2);
+
+    REQUIRE(token::Type::SUBSCRIBE == tok->get_type());
+    REQUIRE(5 == tok->size());
+    REQUIRE(3 == tok->num_requests());
+    REQUIRE(topics == tok->get_topic_filters());
+    REQUIRE(!tok->is_complete());
+
+    // The first chunk is granted, the second has a filter refused
+    MQTTReasonCodes codes0[] = {MQTTREASONCODE_GRANTED_QOS_1, MQTTREASONCODE_GRANTED_QOS_2};
+    MQTTReasonCodes codes1[] = {MQTTREASONCODE_GRANTED_QOS_0, MQTTREASONCODE_NOT_AUTHORIZED};
+
+    auto opts = tok->c_struct(0, MQTTVERSION_5);
+    MQTTAsync_successData5 data{};
+    data.alt.sub.reasonCodeCount = 2;
+    data.alt.sub.reasonCodes = codes0;
+    opts.onSuccess5(opts.context, &data);
+
+    opts = tok->c_struct(1, MQTTVERSION_5);
+    data.alt.sub.reasonCodes = codes1;
+    opts.onSuccess5(opts.context, &data);
+
+    // The last chunk has a single filter, in the main part of the struct
+    REQUIRE(!tok->is_complete());
+    opts = tok->c_struct(2, MQTTVERSION_5);
+    data = MQTTAsync_successData5{};
+    data.reasonCode = MQTTREASONCODE_GRANTED_QOS_1;
+    opts.onSuccess5(opts.context, &data);
+
+    REQUIRE(tok->is_complete());
+    REQUIRE(1 == tok->num_failed());
+    REQUIRE(std::vector<size_t>{3} == tok->failed_items());
+    REQUIRE(ReasonCode::GRANTED_QOS_2 == tok->get_reason_code(1));
+    REQUIRE(ReasonCode::NOT_AUTHORIZED == tok->get_reason_code(3));
+    REQUIRE(ReasonCode::GRANTED_QOS_1 == tok->get_reason_code(4));
+    REQUIRE(ReasonCode::NOT_AUTHORIZED == tok->get_reason_code());
+}
+
+TEST_CASE("batch_token subscribe chunk failure", "[batch_token]")
+{
+    auto topics = string_collection::create({"a", "b", "c"});
+    auto tok = batch_token::create(cli, token::Type::SUBSCRIBE, topics, 2);
+
+    // The v3 SUBACK has the granted QoS for each filter
+    int qosList[] = {1, 0};
+    auto opts = tok->c_struct(0, MQTTVERSION_3_1_1);
+    MQTTAsync_successData data{};
+    data.alt.qosList = qosList;
+    opts.onSuccess(opts.context, &data);
+
+    opts = tok->c_struct(1, MQTTVERSION_3_1_1);
+    MQTTAsync_failureData fdata{};
+    fdata.code = MQTTASYNC_FAILURE;
+    opts.onFailure(opts.context, &fdata);
+
+    REQUIRE(tok->is_complete());
+    REQUIRE(ReasonCode::GRANTED_QOS_1 == tok->get_reason_code(0));
+    REQUIRE(MQTTASYNC_SUCCESS == tok->get_return_code(1));
+    REQUIRE(MQTTASYNC_FAILURE == tok->get_return_code(2));
+    REQUIRE(std::vector<size_t>{2} == tok->failed_items());
+    REQUIRE_THROWS_AS(tok->wait(), mqtt::exception);
+}
+
+TEST_CASE("batch_token subscribe bad args", "[batch_token]")
+{
+    auto topics = string_collection::create({"a"});
+
+    REQUIRE_THROWS_AS(
+        batch_token::create(cli, token::Type::PUBLISH, topics, 1), std::invalid_argument
+    );
+    REQUIRE_THROWS_AS(
+        batch_token::create(cli, token::Type::SUBSCRIBE, topics, 0), std::invalid_argument
+    );
+
+    auto tok = batch_token::create(
+        cli, token::Type::UNSUBSCRIBE, std::make_shared<string_collection>(), 10
+    );
+    REQUIRE(0 == tok->num_requests());
+    REQUIRE(tok->is_complete());
+}
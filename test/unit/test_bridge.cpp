@@ -0,0 +1,186 @@
+// test_bridge.cpp
+//
+// Unit tests for the bridge class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "catch2_version.h"
+#include "mock_async_client.h"
+#include "mqtt/async_client.h"
+#include "mqtt/bridge.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("bridge rules", "[bridge]")
+{
+    async_client src{"mqtt://localhost:1883", "bridge_src"};
+    async_client dst{"mqtt://localhost:1884", "bridge_dst"};
+    bridge br{src, dst};
+
+    // The bridge does the acks for the source
+    REQUIRE(src.get_ack_tracker());
+    REQUIRE(bridge::DFLT_MAX_IN_FLIGHT == src.get_ack_tracker()->get_max_in_flight());
+
+    br.add_rule("site/a/#", 1, "site/a/", "plant/a/");
+    br.add_rule("site/#", 0);
+    br.add_rule("site/+/raw", 0, "site/", "raw/");
+    REQUIRE(3 == br.get_rules().size());
+    REQUIRE_THROWS_AS(br.add_rule("site/#"), std::invalid_argument);
+
+    REQUIRE("plant/a/temp" == br.map_topic("site/a/temp"));
+    REQUIRE("site/b/temp" == br.map_topic("site/b/temp"));
+
+    // The first rule that was added wins
+    REQUIRE("site/b/raw" == br.map_topic("site/b/raw"));
+    REQUIRE(br.map_topic("other/topic").empty());
+
+    br.stop();
+    REQUIRE(!src.get_ack_tracker());
+}
+
+TEST_CASE("bridge forward", "[bridge]")
+{
+    async_client src{"mqtt://localhost:1883", "bridge_src"};
+    async_client dst{"mqtt://localhost:1884", "bridge_dst"};
+
+    // Holds the forwarded messages, since there's no destination server
+    dst.start_offline_buffering();
+
+    bridge br{src, dst, 10};
+    br.add_rule("in/#", 1, "in/", "out/");
+    br.add_rule("pass/#");
+
+    int failures = 0;
+    br.set_failure_handler([&failures](const const_message_ptr&, int) { ++failures; });
+
+    // Long enough not to be kept inline, so it's shared by the copies
+    const std::string PAYLOAD(256, 'x');
+
+    auto tracker = src.get_ack_tracker();
+    auto msg = make_message("in/a", PAYLOAD, 1, false);
+    tracker->track(msg);
+    REQUIRE(msg->has_ack());
+
+    SECTION("delivered")
+    {
+        REQUIRE(br.forward(msg));
+        REQUIRE(1 == br.num_forwarded());
+        REQUIRE(1 == br.num_in_flight());
+        REQUIRE(1 == br.num_copied());
+
+        auto toks = dst.flush(milliseconds(0));
+        REQUIRE(1 == toks.size());
+
+        // The forwarded copy has the new topic, but shares the payload
+        auto out = toks[0]->get_message();
+        REQUIRE("out/a" == out->get_topic());
+        REQUIRE(msg->get_payload_ref().data() == out->get_payload_ref().data());
+
+        // The source isn't acked until the delivery completes
+        REQUIRE(0 == tracker->num_released());
+        mock_async_client::succeed(toks[0].get(), nullptr);
+
+        REQUIRE(1 == br.num_delivered());
+        REQUIRE(0 == br.num_in_flight());
+        REQUIRE(1 == tracker->num_released());
+        REQUIRE(0 == failures);
+    }
+
+    SECTION("unchanged")
+    {
+        auto pass = make_message("pass/a", "payload", 1, false);
+        tracker->track(pass);
+
+        REQUIRE(br.forward(pass));
+        REQUIRE(0 == br.num_copied());
+
+        auto toks = dst.flush(milliseconds(0));
+        REQUIRE(1 == toks.size());
+        REQUIRE(pass == toks[0]->get_message());
+    }
+
+    SECTION("failed")
+    {
+        REQUIRE(br.forward(msg));
+        auto toks = dst.flush(milliseconds(0));
+        REQUIRE(1 == toks.size());
+
+        MQTTAsync_failureData rsp{};
+        rsp.code = MQTTASYNC_FAILURE;
+        mock_async_client::fail(toks[0].get(), &rsp);
+
+        // A failed message is still acked, so the flow doesn't stop
+        REQUIRE(1 == br.num_failed());
+        REQUIRE(1 == failures);
+        REQUIRE(1 == tracker->num_released());
+    }
+
+    SECTION("unmatched")
+    {
+        auto other = make_message("other/a", "payload", 1, false);
+        tracker->track(other);
+
+        REQUIRE(!br.forward(other));
+        REQUIRE(1 == br.num_unmatched());
+        REQUIRE(0 == br.num_forwarded());
+
+        // It's acked, but behind the first message, which isn't
+        REQUIRE(0 == tracker->num_released());
+        msg->ack();
+        REQUIRE(2 == tracker->num_released());
+    }
+}
+
+TEST_CASE("bridge connection properties", "[bridge]")
+{
+    async_client src{"mqtt://localhost:1883", "bridge_src"};
+    async_client dst{"mqtt://localhost:1884", "bridge_dst"};
+    dst.start_offline_buffering();
+
+    bridge br{src, dst};
+    br.add_rule("#");
+
+    properties props{
+        {property::TOPIC_ALIAS, 3},
+        {property::SUBSCRIPTION_IDENTIFIER, 5},
+        {property::USER_PROPERTY, "name", "value"},
+    };
+    auto msg = make_message("a/b", "payload", 1, false, props);
+
+    REQUIRE(br.forward(msg));
+    REQUIRE(1 == br.num_copied());
+
+    auto toks = dst.flush(milliseconds(0));
+    REQUIRE(1 == toks.size());
+
+    // The properties of the source connection are dropped
+    auto out = toks[0]->get_message();
+    REQUIRE("a/b" == out->get_topic());
+    const auto& outProps = out->get_properties();
+    REQUIRE(1 == outProps.size());
+    REQUIRE(outProps.contains(property::USER_PROPERTY));
+}
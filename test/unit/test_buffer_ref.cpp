@@ -30,7 +30,8 @@ using namespace mqtt;
 
 static const string EMPTY_STR;
 
-static const string STR{"Some random string"};
+// Long enough to be kept in a shared buffer, rather than inline
+static const string STR{"Some random string, which is too long to be kept inline"};
 static const binary BIN{"\x0\x1\x2\x3\x4\x5\x6\x7"};
 
 static const char* CSTR = "Another random string";
@@ -258,3 +259,199 @@ TEST_CASE("reset", "[collections]")
     REQUIRE_FALSE(sr);
     REQUIRE(sr.empty());
 }
+
+// ----------------------------------------------------------------------
+// Test adopting an external buffer
+// ----------------------------------------------------------------------
+
+TEST_CASE("external_ctor", "[collections]")
+{
+    bool freed = false;
+    char* buf = new char[CSTR_LEN];
+    memcpy(buf, CSTR, CSTR_LEN);
+
+    {
+        string_ref sr(
+            string_ref::external_pointer_type{
+                buf,
+                [&freed](const char* p) {
+                    delete[] p;
+                    freed = true;
+                }
+            },
+            CSTR_LEN
+        );
+
+        REQUIRE(sr);
+        REQUIRE(sr.is_external());
+        REQUIRE(CSTR_LEN == sr.size());
+
+        // The data is not copied
+        REQUIRE(buf == sr.data());
+
+        // Copies refer to the same buffer
+        string_ref sr2(sr);
+        REQUIRE(buf == sr2.data());
+
+        // But a string is made on demand
+        REQUIRE(string(CSTR) == sr.str());
+        REQUIRE(0 == strcmp(CSTR, sr.c_str()));
+
+        sr.reset();
+        REQUIRE_FALSE(sr);
+        REQUIRE(sr.empty());
+        REQUIRE_FALSE(freed);
+    }
+    REQUIRE(freed);
+}
+
+TEST_CASE("external_assignment", "[collections]")
+{
+    string_ref sr(string_ref::external_pointer_type{CSTR, [](const char*) {}}, CSTR_LEN);
+    REQUIRE(sr.is_external());
+
+    sr = STR;
+    REQUIRE_FALSE(sr.is_external());
+    REQUIRE(STR == sr.str());
+}
+
+TEST_CASE("deleter_ctor", "[collections]")
+{
+    int nFreed = 0;
+    char* buf = new char[CSTR_LEN];
+    memcpy(buf, CSTR, CSTR_LEN);
+
+    {
+        binary_ref br{buf, CSTR_LEN, [&nFreed](const char* p) {
+                          delete[] p;
+                          ++nFreed;
+                      }};
+
+        REQUIRE(br.is_external());
+        REQUIRE(buf == br.data());
+        REQUIRE(CSTR_LEN == br.size());
+
+        binary_ref br2{br};
+        br.reset();
+        REQUIRE(0 == nFreed);
+        REQUIRE(buf == br2.data());
+    }
+    REQUIRE(1 == nFreed);
+}
+
+TEST_CASE("aliasing_ctor", "[collections]")
+{
+    struct frame
+    {
+        uint32_t hdr;
+        char data[32];
+    };
+
+    auto fr = std::make_shared<frame>();
+    memcpy(fr->data, CSTR, CSTR_LEN);
+
+    std::weak_ptr<frame> wfr{fr};
+    binary_ref br{fr, fr->data, CSTR_LEN};
+    fr.reset();
+
+    // The buffer keeps the whole frame alive
+    REQUIRE_FALSE(wfr.expired());
+    REQUIRE(br.is_external());
+    REQUIRE(CSTR_LEN == br.size());
+    REQUIRE(0 == memcmp(CSTR, br.data(), CSTR_LEN));
+
+    br.reset();
+    REQUIRE(wfr.expired());
+}
+
+// ----------------------------------------------------------------------
+// Test short, inline data
+// ----------------------------------------------------------------------
+
+TEST_CASE("inline_ctor", "[collections]")
+{
+    string_ref sr{CSTR};
+
+    REQUIRE(sr);
+    REQUIRE(sr.is_inline());
+    REQUIRE_FALSE(sr.is_external());
+    REQUIRE(CSTR_LEN == sr.size());
+    REQUIRE(0 == strcmp(CSTR, sr.c_str()));
+    REQUIRE(0 == memcmp(CSTR, sr.data(), CSTR_LEN));
+
+    // The longest inline data, and one past it
+    string_ref sr2{string(string_ref::INLINE_SIZE, 'x')};
+    REQUIRE(sr2.is_inline());
+
+    string_ref sr3{string(string_ref::INLINE_SIZE + 1, 'x')};
+    REQUIRE_FALSE(sr3.is_inline());
+
+    REQUIRE_FALSE(string_ref{STR}.is_inline());
+
+    // An empty string is inline, but not null
+    string_ref sr4{EMPTY_STR};
+    REQUIRE(sr4);
+    REQUIRE(sr4.empty());
+    REQUIRE(sr4.is_inline());
+}
+
+TEST_CASE("inline_copy", "[collections]")
+{
+    string_ref org{CSTR};
+    string_ref sr{org};
+
+    // Each copy has its own bytes
+    REQUIRE(sr.is_inline());
+    REQUIRE(org.data() != sr.data());
+    REQUIRE(0 == strcmp(CSTR, sr.c_str()));
+
+    // A string is made on demand
+    REQUIRE(string(CSTR) == sr.str());
+    REQUIRE(1 == sr.ptr().use_count());
+
+    string_ref sr2;
+    sr2 = sr;
+    REQUIRE(string(CSTR) == sr2.str());
+
+    sr = STR;
+    REQUIRE_FALSE(sr.is_inline());
+    REQUIRE(STR == sr.str());
+    REQUIRE(string(CSTR) == sr2.str());
+
+    sr = org;
+    REQUIRE(sr.is_inline());
+    REQUIRE(string(CSTR) == sr.str());
+}
+
+TEST_CASE("inline_move", "[collections]")
+{
+    string_ref org{CSTR};
+    string_ref sr{std::move(org)};
+
+    REQUIRE_FALSE(org);
+    REQUIRE(sr.is_inline());
+    REQUIRE(0 == strcmp(CSTR, sr.c_str()));
+
+    string str{CSTR};
+    string_ref sr2{std::move(str)};
+    REQUIRE(sr2.is_inline());
+    REQUIRE(str.empty());
+
+    org = std::move(sr2);
+    REQUIRE_FALSE(sr2);
+    REQUIRE(0 == strcmp(CSTR, org.c_str()));
+
+    // The bytes are copied, so the data moves with them
+    const char* p = org.data();
+    sr = std::move(org);
+    REQUIRE(sr.data() != p);
+    REQUIRE(0 == strcmp(CSTR, sr.c_str()));
+}
+
+TEST_CASE("inline_size", "[collections]")
+{
+    // The inline bytes fit in a cache line with the rest of the reference
+    if (sizeof(void*) == 8)
+        REQUIRE(64 == sizeof(string_ref));
+    REQUIRE(string_ref::INLINE_SIZE >= 16);
+}
@@ -0,0 +1,163 @@
+// test_chunk_reassembler.cpp
+//
+// Unit tests for the chunk_reassembler class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/chunk_reassembler.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string TOPIC{"firmware/image"};
+
+const_message_ptr make_chunk(
+    const string& id, unsigned seq, const string& data, size_t size = string::npos
+) {
+    properties props{
+        {property::USER_PROPERTY, chunked_publisher::STREAM_PROPERTY, id},
+        {property::USER_PROPERTY, chunked_publisher::SEQ_PROPERTY, std::to_string(seq)}
+    };
+    if (size != string::npos)
+        props.add({property::USER_PROPERTY, chunked_publisher::SIZE_PROPERTY, std::to_string(size)}
+        );
+    return message::create(TOPIC, data, 1, false, props);
+}
+
+// Collects the output of the reassembler
+struct collector
+{
+    std::map<string, string> data;
+    std::map<string, std::pair<size_t, bool>> done;
+    std::vector<size_t> progress;
+
+    chunk_reassembler::sink_type sink() {
+        return [this](const string& id, size_t off, const binary_ref& buf) {
+            REQUIRE(off == data[id].size());
+            data[id] += buf.str();
+        };
+    }
+
+    void attach(chunk_reassembler& ra) {
+        ra.set_progress_handler([this](const string&, size_t n) { progress.push_back(n); });
+        ra.set_complete_handler([this](const string& id, size_t n, bool ok) {
+            done[id] = {n, ok};
+        });
+    }
+};
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("chunk_reassembler is chunk", "[chunked]")
+{
+    REQUIRE(chunk_reassembler::is_chunk(*make_chunk("s1", 0, "abc")));
+    REQUIRE(!chunk_reassembler::is_chunk(*make_message(TOPIC, "abc")));
+
+    properties props{{property::USER_PROPERTY, chunked_publisher::SEQ_PROPERTY, "x1"}};
+    REQUIRE(!chunk_reassembler::is_chunk(message(TOPIC, "abc", 1, false, props)));
+
+    chunk_reassembler ra{nullptr};
+    REQUIRE(!ra.handle(make_message(TOPIC, "abc")));
+}
+
+TEST_CASE("chunk_reassembler in order", "[chunked]")
+{
+    collector col;
+    chunk_reassembler ra{col.sink()};
+    col.attach(ra);
+
+    REQUIRE(ra.handle(make_chunk("s1", 0, "abc")));
+    REQUIRE(ra.handle(make_chunk("s1", 1, "def")));
+    REQUIRE(1 == ra.num_streams());
+    REQUIRE(ra.handle(make_chunk("s1", 2, "gh", 8)));
+
+    REQUIRE("abcdefgh" == col.data["s1"]);
+    REQUIRE((std::vector<size_t>{3, 6, 8}) == col.progress);
+    REQUIRE(8 == col.done["s1"].first);
+    REQUIRE(col.done["s1"].second);
+    REQUIRE(0 == ra.num_streams());
+
+    // A redelivery after the end is dropped
+    REQUIRE(ra.handle(make_chunk("s1", 0, "abc")));
+    REQUIRE(0 == ra.num_streams());
+    REQUIRE("abcdefgh" == col.data["s1"]);
+}
+
+TEST_CASE("chunk_reassembler out of order", "[chunked]")
+{
+    collector col;
+    chunk_reassembler ra{col.sink()};
+    col.attach(ra);
+
+    ra.handle(make_chunk("s1", 2, "gh", 8));
+    ra.handle(make_chunk("s2", 0, "xyz", 3));
+    ra.handle(make_chunk("s1", 1, "def"));
+    ra.handle(make_chunk("s1", 1, "def"));
+    REQUIRE(col.data["s1"].empty());
+
+    ra.handle(make_chunk("s1", 0, "abc"));
+    REQUIRE("abcdefgh" == col.data["s1"]);
+    REQUIRE("xyz" == col.data["s2"]);
+    REQUIRE(col.done["s1"].second);
+    REQUIRE(col.done["s2"].second);
+}
+
+TEST_CASE("chunk_reassembler failures", "[chunked]")
+{
+    collector col;
+    chunk_reassembler ra{col.sink(), 2};
+    col.attach(ra);
+
+    SECTION("too many early chunks")
+    {
+        ra.handle(make_chunk("s1", 0, "abc"));
+        ra.handle(make_chunk("s1", 2, "ghi"));
+        ra.handle(make_chunk("s1", 3, "jkl"));
+        ra.handle(make_chunk("s1", 4, "mno"));
+
+        REQUIRE(0 == ra.num_streams());
+        REQUIRE(3 == col.done["s1"].first);
+        REQUIRE(!col.done["s1"].second);
+    }
+
+    SECTION("the wrong size")
+    {
+        ra.handle(make_chunk("s1", 0, "abc"));
+        ra.handle(make_chunk("s1", 1, "de", 6));
+        REQUIRE(5 == col.done["s1"].first);
+        REQUIRE(!col.done["s1"].second);
+    }
+
+    SECTION("abandoned")
+    {
+        ra.handle(make_chunk("s1", 0, "abc"));
+        REQUIRE(ra.abandon("s1"));
+        REQUIRE(!ra.abandon("s1"));
+        REQUIRE(!col.done["s1"].second);
+    }
+}
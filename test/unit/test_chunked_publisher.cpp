@@ -0,0 +1,175 @@
+// test_chunked_publisher.cpp
+//
+// Unit tests for the chunked_publisher class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mock_async_client.h"
+#include "mqtt/chunked_publisher.h"
+#include "mqtt/thread_queue.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string TOPIC{"firmware/image"};
+
+// A client that acks each publish a little later, from its own thread
+class acking_client : public mock_async_client
+{
+    thread_queue<delivery_token_ptr> que_;
+    std::thread thr_;
+
+public:
+    std::vector<const_message_ptr> msgs;
+    std::atomic<size_t> nOutstanding{0};
+    size_t maxOutstanding{0};
+
+    acking_client() {
+        thr_ = std::thread([this] {
+            delivery_token_ptr tok;
+            while ((tok = que_.get())) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                --nOutstanding;
+                succeed(tok.get(), nullptr);
+            }
+        });
+    }
+
+    ~acking_client() {
+        que_.put(delivery_token_ptr{});
+        thr_.join();
+    }
+
+    using mock_async_client::publish;
+
+    delivery_token_ptr publish(const_message_ptr msg) override {
+        msgs.push_back(msg);
+        maxOutstanding = std::max(maxOutstanding, size_t(++nOutstanding));
+        auto tok = delivery_token::create(*this, msg);
+        que_.put(tok);
+        return tok;
+    }
+};
+
+string user_prop(const message& msg, const string& name) {
+    for (const auto& prop : msg.get_properties()) {
+        auto kv = get<string_pair>(prop);
+        if (std::get<0>(kv) == name)
+            return std::get<1>(kv);
+    }
+    return string();
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("chunked_publisher ctor", "[chunked]")
+{
+    acking_client cli;
+    chunked_publisher pub{cli, TOPIC};
+
+    REQUIRE(TOPIC == pub.get_topic());
+    REQUIRE(chunked_publisher::DFLT_CHUNK_SIZE == pub.get_chunk_size());
+    REQUIRE(chunked_publisher::DFLT_MAX_IN_FLIGHT == pub.get_max_in_flight());
+
+    REQUIRE_THROWS_AS(chunked_publisher(cli, TOPIC, 0), std::invalid_argument);
+}
+
+TEST_CASE("chunked_publisher splits a stream", "[chunked]")
+{
+    acking_client cli;
+    chunked_publisher pub{cli, TOPIC, 10, 2};
+
+    std::vector<size_t> progress;
+    pub.set_progress_handler([&progress](size_t n) { progress.push_back(n); });
+
+    std::string data;
+    for (int i = 0; i < 35; ++i) data.push_back(char('a' + i % 26));
+    std::istringstream is{data};
+
+    REQUIRE(35 == pub.publish(is, "s1"));
+
+    // Three full chunks, and the rest
+    REQUIRE(4 == cli.msgs.size());
+    std::string out;
+    for (size_t i = 0; i < cli.msgs.size(); ++i) {
+        const auto& msg = *cli.msgs[i];
+        REQUIRE(TOPIC == msg.get_topic());
+        REQUIRE("s1" == user_prop(msg, chunked_publisher::STREAM_PROPERTY));
+        REQUIRE(std::to_string(i) == user_prop(msg, chunked_publisher::SEQ_PROPERTY));
+        out += msg.get_payload_str();
+    }
+    REQUIRE(data == out);
+
+    // Only the last one has the size
+    REQUIRE(user_prop(*cli.msgs[2], chunked_publisher::SIZE_PROPERTY).empty());
+    REQUIRE("35" == user_prop(*cli.msgs[3], chunked_publisher::SIZE_PROPERTY));
+
+    // The window was kept, and everything was acked
+    REQUIRE(cli.maxOutstanding <= 2);
+    REQUIRE(0 == cli.nOutstanding);
+    REQUIRE((std::vector<size_t>{10, 20, 30, 35}) == progress);
+}
+
+TEST_CASE("chunked_publisher exact and empty sources", "[chunked]")
+{
+    acking_client cli;
+    chunked_publisher pub{cli, TOPIC, 4};
+
+    SECTION("an exact multiple of the chunk size")
+    {
+        size_t left = 8;
+        auto src = [&left](char* buf, size_t n) {
+            n = std::min(n, std::min(left, size_t(3)));
+            std::fill(buf, buf + n, 'x');
+            left -= n;
+            return n;
+        };
+        REQUIRE(8 == pub.publish(src));
+        REQUIRE(2 == cli.msgs.size());
+        REQUIRE(4 == cli.msgs[1]->get_payload().size());
+        REQUIRE("8" == user_prop(*cli.msgs[1], chunked_publisher::SIZE_PROPERTY));
+
+        // A stream ID was made up
+        auto id = user_prop(*cli.msgs[0], chunked_publisher::STREAM_PROPERTY);
+        REQUIRE(!id.empty());
+        REQUIRE(id == user_prop(*cli.msgs[1], chunked_publisher::STREAM_PROPERTY));
+    }
+
+    SECTION("an empty source")
+    {
+        std::istringstream is;
+        REQUIRE(0 == pub.publish(is));
+        REQUIRE(1 == cli.msgs.size());
+        REQUIRE(cli.msgs[0]->get_payload().empty());
+        REQUIRE("0" == user_prop(*cli.msgs[0], chunked_publisher::SIZE_PROPERTY));
+    }
+}
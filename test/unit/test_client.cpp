@@ -310,6 +310,56 @@ TEST_CASE("client publish 5 args", "[client]")
     REQUIRE(!cli.is_connected());
 }
 
+//----------------------------------------------------------------------
+// Test client::set_publish_window()
+//----------------------------------------------------------------------
+
+TEST_CASE("client publish window", "[client]")
+{
+    mqtt::client cli{GOOD_SERVER_URI, CLIENT_ID};
+    REQUIRE(0 == cli.get_publish_window());
+    REQUIRE(0 == cli.num_in_flight());
+
+    cli.set_publish_window(16);
+    REQUIRE(16 == cli.get_publish_window());
+    REQUIRE_NOTHROW(cli.flush());
+
+    // A publish that the library refuses fails right away, and doesn't
+    // take a place in the window.
+    REQUIRE(!cli.is_connected());
+    REQUIRE_THROWS_AS(cli.publish(TOPIC, PAYLOAD.data(), PAYLOAD.size(), 1, false), exception);
+    REQUIRE(0 == cli.num_in_flight());
+
+    cli.set_publish_window(0);
+    REQUIRE(0 == cli.get_publish_window());
+}
+
+TEST_CASE("client publish window timeout", "[client]")
+{
+    mqtt::client cli{GOOD_SERVER_URI, CLIENT_ID};
+    cli.set_timeout(std::chrono::milliseconds(10));
+    cli.set_publish_window(1);
+
+    // A buffered message stays in flight until the buffer is dropped
+    cli.test_async_client().start_offline_buffering();
+    cli.publish(TOPIC, PAYLOAD.data(), PAYLOAD.size(), 1, false);
+    REQUIRE(1 == cli.num_in_flight());
+
+    // A timeout doesn't retire it
+    REQUIRE_THROWS_AS(cli.flush(), mqtt::timeout_error);
+    REQUIRE(1 == cli.num_in_flight());
+    REQUIRE_THROWS_AS(
+        cli.publish(TOPIC, PAYLOAD.data(), PAYLOAD.size(), 1, false), mqtt::timeout_error
+    );
+    REQUIRE(1 == cli.num_in_flight());
+
+    // Its failure does
+    cli.test_async_client().stop_offline_buffering();
+    REQUIRE_THROWS_AS(cli.flush(), exception);
+    REQUIRE(0 == cli.num_in_flight());
+    REQUIRE_NOTHROW(cli.flush());
+}
+
 //----------------------------------------------------------------------
 // Test client::set_callback()
 //----------------------------------------------------------------------
@@ -0,0 +1,116 @@
+// test_client_fleet.cpp
+//
+// Unit tests for the client_fleet class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <thread>
+
+#include "catch2_version.h"
+#include "mqtt/client_fleet.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+static const string SERVER_URI{"mqtt://localhost:1883"};
+static const string TOPIC{"fleet/topic"};
+static const string PAYLOAD{"hello"};
+
+static create_options make_create_options()
+{
+    return create_options_builder().server_uri(SERVER_URI).finalize();
+}
+
+// ----------------------------------------------------------------------
+
+TEST_CASE("client_fleet add", "[fleet]")
+{
+    client_fleet fleet{make_create_options(), connect_options{}};
+    REQUIRE(0 == fleet.size());
+
+    REQUIRE(0 == fleet.add("sim-0"));
+    REQUIRE(1 == fleet.add("sim-1"));
+    REQUIRE(2 == fleet.size());
+
+    REQUIRE("sim-1" == fleet.get_client(1).get_client_id());
+    REQUIRE(SERVER_URI == fleet.get_client(1).get_server_uri());
+    REQUIRE(0 == fleet.num_connected());
+    REQUIRE_THROWS_AS(fleet.get_client(2), std::out_of_range);
+    REQUIRE_THROWS_AS(fleet.connect(2), std::out_of_range);
+}
+
+TEST_CASE("client_fleet shared dispatch", "[fleet]")
+{
+    client_fleet fleet{make_create_options(), connect_options{}};
+
+    std::vector<size_t> got;
+    fleet.set_message_handler([&](size_t idx, const_message_ptr msg) {
+        REQUIRE(PAYLOAD == msg->get_payload_str());
+        got.push_back(idx);
+    });
+    fleet.start_consuming();
+
+    fleet.add("sim-0");
+    fleet.add("sim-1");
+
+    fleet.get_client(1).test_message_arrived(TOPIC, PAYLOAD.data(), PAYLOAD.size());
+    fleet.get_client(0).test_message_arrived(TOPIC, PAYLOAD.data(), PAYLOAD.size());
+
+    REQUIRE(2 == got.size());
+    REQUIRE(1 == got[0]);
+    REQUIRE(0 == got[1]);
+
+    // The events of all the clients are in the one queue
+    REQUIRE(2 == fleet.consumer_queue_size());
+
+    auto evt = fleet.consume_event();
+    REQUIRE(1 == evt.client);
+    REQUIRE(TOPIC == evt.evt.get_message()->get_topic());
+
+    std::vector<client_fleet::client_event> evts;
+    REQUIRE(1 == fleet.try_consume_events(evts, 8));
+    REQUIRE(0 == evts[0].client);
+
+    fleet.stop_consuming();
+    evt = fleet.consume_event();
+    REQUIRE(client_fleet::npos == evt.client);
+    REQUIRE(evt.evt.is_shutdown());
+}
+
+TEST_CASE("client_fleet connect all", "[fleet]")
+{
+    client_fleet fleet{make_create_options(), connect_options{}, 1000.0};
+
+    constexpr size_t N = 5;
+    for (size_t i = 0; i < N; ++i) fleet.add("sim-" + std::to_string(i));
+
+    // The connects are paced by the limiter, on its own thread. With no
+    // server, they all fail.
+    fleet.connect_all();
+
+    auto until = steady_clock::now() + seconds(5);
+    while (fleet.num_connect_failures() < N && steady_clock::now() < until)
+        std::this_thread::sleep_for(milliseconds(5));
+
+    REQUIRE(N == fleet.num_connect_failures());
+    REQUIRE(0 == fleet.num_pending_connects());
+    REQUIRE(0 == fleet.num_connected());
+    REQUIRE(fleet.disconnect_all(milliseconds(10)));
+}
@@ -0,0 +1,119 @@
+// test_client_metrics.cpp
+//
+// Unit tests for the client_metrics class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+
+#include "catch2_version.h"
+#include "mqtt/client_metrics.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+TEST_CASE("latency_histogram buckets", "[metrics]")
+{
+    REQUIRE(microseconds(1) == latency_histogram::upper_bound(0));
+    REQUIRE(microseconds(2) == latency_histogram::upper_bound(1));
+    REQUIRE(microseconds(1024) == latency_histogram::upper_bound(10));
+    REQUIRE(
+        latency_histogram::duration::max() ==
+        latency_histogram::upper_bound(latency_histogram::N_BUCKETS - 1)
+    );
+
+    latency_histogram h;
+    REQUIRE(0 == h.count());
+    REQUIRE(latency_histogram::duration::zero() == h.quantile(0.5));
+
+    h.record(nanoseconds(500));
+    h.record(microseconds(1));
+    h.record(microseconds(3));
+    h.record(microseconds(1000));
+    h.record(hours(1));
+
+    REQUIRE(5 == h.count());
+    REQUIRE(2 == h.bucket_count(0));
+    REQUIRE(1 == h.bucket_count(2));
+    REQUIRE(1 == h.bucket_count(10));
+    REQUIRE(1 == h.bucket_count(latency_histogram::N_BUCKETS - 1));
+    REQUIRE(nanoseconds(500) + microseconds(1004) + hours(1) == h.sum());
+}
+
+TEST_CASE("latency_histogram quantile", "[metrics]")
+{
+    latency_histogram h;
+
+    for (int i = 0; i < 99; ++i) h.record(microseconds(10));
+    h.record(milliseconds(100));
+
+    REQUIRE(microseconds(16) == h.quantile(0.5));
+    REQUIRE(microseconds(16) == h.quantile(0.98));
+    REQUIRE(microseconds(131072) == h.quantile(1.0));
+}
+
+TEST_CASE("latency_histogram copy", "[metrics]")
+{
+    latency_histogram h;
+    h.record(microseconds(5));
+
+    latency_histogram snap{h};
+    h.record(microseconds(5));
+
+    REQUIRE(1 == snap.count());
+    REQUIRE(2 == h.count());
+}
+
+TEST_CASE("latency_histogram add", "[metrics]")
+{
+    latency_histogram h, h2;
+    h.record(microseconds(1));
+    h2.record(microseconds(1));
+    h2.record(microseconds(1000));
+
+    h += h2;
+    REQUIRE(3 == h.count());
+    REQUIRE(2 == h.bucket_count(0));
+    REQUIRE(1 == h.bucket_count(10));
+    REQUIRE(microseconds(1002) == h.sum());
+    REQUIRE(2 == h2.count());
+}
+
+TEST_CASE("client_metrics default", "[metrics]")
+{
+    client_metrics m;
+
+    for (int qos = 0; qos < client_metrics::N_QOS; ++qos) {
+        REQUIRE(0 == m.messages_sent(qos));
+        REQUIRE(0 == m.bytes_sent(qos));
+        REQUIRE(0 == m.messages_received(qos));
+        REQUIRE(0 == m.bytes_received(qos));
+    }
+    REQUIRE(0 == m.messages_sent());
+    REQUIRE(0 == m.num_connects());
+    REQUIRE(0 == m.num_reconnects());
+    REQUIRE(0 == m.num_connections_lost());
+    REQUIRE(0 == m.num_publish_failures());
+    REQUIRE(0 == m.num_duplicates_dropped());
+    REQUIRE(0 == m.num_pending_tokens());
+    REQUIRE(0 == m.num_pending_delivery_tokens());
+    REQUIRE(0 == m.consumer_queue_size());
+    REQUIRE(0 == m.ack_latency().count());
+}
@@ -0,0 +1,183 @@
+// test_columnar_batch.cpp
+//
+// Unit tests for the columnar_batch and columnar_consumer classes in the
+// Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/columnar_batch.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+// --------------------------------------------------------------------------
+
+namespace {
+
+message_ptr make_msg(const string& topic, const string& payload, const string& dev = "") {
+    auto msg = make_message(topic, payload, 1, false);
+    if (!dev.empty())
+        msg->set_properties(properties{{property::USER_PROPERTY, "device", dev}});
+    return msg;
+}
+
+}  // namespace
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("columnar_batch append", "[columnar]")
+{
+    columnar_batch batch{{"device", "site"}};
+    REQUIRE(batch.empty());
+    REQUIRE(2 == batch.property_names().size());
+
+    const auto t0 = system_clock::now();
+    batch.append(*make_msg("a/temp", "21", "d1"));
+    batch.append(*make_msg("a/humidity", "40"));
+    batch.append(*make_msg("a/temp", "22", "d2"));
+
+    REQUIRE(3 == batch.size());
+    REQUIRE(6 == batch.payload_bytes());
+
+    // The topics are interned
+    REQUIRE(2 == batch.num_topics());
+    REQUIRE(batch.topic_index(0) == batch.topic_index(2));
+    REQUIRE("a/temp" == batch.topic(2));
+    REQUIRE("a/humidity" == batch.topic(1));
+
+    REQUIRE("21" == batch.payload(0));
+    REQUIRE("22" == batch.payload(2));
+    REQUIRE(1 == batch.qos(1));
+    REQUIRE(batch.timestamp(0) >= t0 - seconds(1));
+    REQUIRE(batch.timestamp(0) <= system_clock::now() + seconds(1));
+
+    REQUIRE("d1" == *batch.property(0, 0));
+    REQUIRE(!batch.property(0, 1));
+    REQUIRE("d2" == *batch.property(0, 2));
+    REQUIRE(!batch.property(1, 0));
+
+    batch.clear();
+    REQUIRE(batch.empty());
+    REQUIRE(0 == batch.num_topics());
+    batch.append(*make_msg("b", "x"));
+    REQUIRE("b" == batch.topic(0));
+}
+
+TEST_CASE("columnar_batch export", "[columnar]")
+{
+    columnar_batch batch{{"device"}};
+    batch.append(*make_msg("a/temp", "21", "d1"));
+    batch.append(*make_msg("a/humidity", "40"));
+    batch.append(*make_msg("a/temp", "22", "d2"));
+
+    ArrowArray arr;
+    ArrowSchema sch;
+    batch.export_to_c(&arr, &sch);
+    REQUIRE(batch.empty());
+
+    REQUIRE(std::string{"+s"} == sch.format);
+    REQUIRE(5 == sch.n_children);
+    REQUIRE(std::string{"topic"} == sch.children[0]->name);
+    REQUIRE(std::string{"i"} == sch.children[0]->format);
+    REQUIRE(std::string{"u"} == sch.children[0]->dictionary->format);
+    REQUIRE(std::string{"z"} == sch.children[1]->format);
+    REQUIRE(std::string{"C"} == sch.children[2]->format);
+    REQUIRE(std::string{"tsn:UTC"} == sch.children[3]->format);
+    REQUIRE(std::string{"device"} == sch.children[4]->name);
+    REQUIRE(ARROW_FLAG_NULLABLE == sch.children[4]->flags);
+
+    REQUIRE(3 == arr.length);
+    REQUIRE(5 == arr.n_children);
+
+    auto topic = arr.children[0];
+    auto idx = static_cast<const int32_t*>(topic->buffers[1]);
+    REQUIRE(idx[0] == idx[2]);
+    auto dict = topic->dictionary;
+    REQUIRE(2 == dict->length);
+    auto dictOff = static_cast<const int32_t*>(dict->buffers[1]);
+    auto dictData = static_cast<const char*>(dict->buffers[2]);
+    auto i1 = idx[1];
+    REQUIRE("a/humidity" == std::string(dictData + dictOff[i1], dictOff[i1 + 1] - dictOff[i1]));
+
+    auto payload = arr.children[1];
+    auto payOff = static_cast<const int32_t*>(payload->buffers[1]);
+    REQUIRE(6 == payOff[3]);
+    REQUIRE(0 == std::memcmp("214022", payload->buffers[2], 6));
+
+    auto dev = arr.children[4];
+    REQUIRE(1 == dev->null_count);
+    auto valid = static_cast<const uint8_t*>(dev->buffers[0]);
+    REQUIRE(0x05 == valid[0]);
+
+    // A consumer can move a child out and release it on its own
+    ArrowArray moved = *arr.children[1];
+    arr.children[1]->release = nullptr;
+
+    arr.release(&arr);
+    REQUIRE(!arr.release);
+    REQUIRE(0 == std::memcmp("214022", moved.buffers[2], 6));
+    moved.release(&moved);
+
+    sch.release(&sch);
+    REQUIRE(!sch.release);
+}
+
+TEST_CASE("columnar_consumer fill", "[columnar]")
+{
+    async_client cli{"tcp://localhost:1883", "test_columnar"};
+    cli.start_consuming();
+
+    const std::string PAYLOAD{"payload"};
+    for (int i = 0; i < 5; ++i) cli.test_message_arrived("a/b", PAYLOAD.data(), PAYLOAD.size());
+
+    columnar_batch batch;
+
+    SECTION("by rows")
+    {
+        columnar_consumer cons{cli, 3};
+        REQUIRE(cons.fill(batch));
+        REQUIRE(3 == batch.size());
+
+        // The rest, once the batch age is up
+        columnar_consumer cons2{cli, 100, 1024, milliseconds(20)};
+        REQUIRE(cons2.fill(batch));
+        REQUIRE(2 == batch.size());
+    }
+
+    SECTION("by bytes")
+    {
+        columnar_consumer cons{cli, 100, 2 * PAYLOAD.size(), milliseconds(20)};
+        REQUIRE(cons.fill(batch));
+        REQUIRE(2 <= batch.size());
+    }
+
+    SECTION("shutdown")
+    {
+        columnar_consumer cons{cli, 100, 1024, milliseconds(20)};
+        REQUIRE(cons.fill(batch));
+        cli.stop_consuming();
+        REQUIRE(!cons.fill(batch));
+    }
+}
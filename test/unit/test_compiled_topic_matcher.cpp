@@ -0,0 +1,162 @@
+// test_compiled_topic_matcher.cpp
+//
+// Unit tests for the compiled_topic_matcher class in the Paho MQTT C++
+// library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <set>
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/compiled_topic_matcher.h"
+
+using namespace mqtt;
+
+using cmatcher = compiled_topic_matcher<int>;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("compiled matcher empty", "[compiled_topic_matcher]")
+{
+    cmatcher tm;
+    REQUIRE(tm.empty());
+    REQUIRE(tm.size() == 0);
+    REQUIRE(!tm.has_match("some/topic"));
+    REQUIRE(!tm.has_match(""));
+    REQUIRE(!(tm.find("some/topic") != tm.end()));
+}
+
+TEST_CASE("compiled matcher freeze", "[compiled_topic_matcher]")
+{
+    topic_matcher<int> tm;
+    tm.insert({"some/random/topic", 42});
+    tm.insert({"some/#", 99});
+    tm.insert({"some/other/topic", 55});
+    tm.insert({"some/+/topic", 33});
+
+    auto ctm = tm.freeze();
+    REQUIRE(ctm.size() == 4);
+
+    auto it = ctm.find("some/random/topic");
+    REQUIRE(it != ctm.end());
+    REQUIRE(it->second == 42);
+
+    it = ctm.find("some/+/topic");
+    REQUIRE(it != ctm.end());
+    REQUIRE(it->second == 33);
+
+    REQUIRE(!(ctm.find("some/random") != ctm.end()));
+    REQUIRE(!(ctm.find("some/thing/topic") != ctm.end()));
+
+    std::set<int> found;
+    for (auto mit = ctm.matches("some/random/topic"); mit != ctm.matches_end(); ++mit) {
+        found.insert(mit->second);
+    }
+    REQUIRE(found == std::set<int>{42, 99, 33});
+}
+
+// The same corner cases as for the other matchers
+TEST_CASE("compiled matcher matches", "[compiled_topic_matcher]")
+{
+    // Should match
+
+    REQUIRE((cmatcher{{"foo/bar", 42}}.has_match("foo/bar")));
+    REQUIRE((cmatcher{{"foo/+", 42}}.has_match("foo/bar")));
+    REQUIRE((cmatcher{{"foo/+/baz", 42}}.has_match("foo/bar/baz")));
+    REQUIRE((cmatcher{{"foo/+/#", 42}}.has_match("foo/bar/baz")));
+    REQUIRE((cmatcher{{"A/B/+/#", 42}}.has_match("A/B/B/C")));
+    REQUIRE((cmatcher{{"#", 42}}.has_match("foo/bar/baz")));
+    REQUIRE((cmatcher{{"#", 42}}.has_match("/foo/bar")));
+    REQUIRE((cmatcher{{"/#", 42}}.has_match("/foo/bar")));
+    REQUIRE((cmatcher{{"$SYS/bar", 42}}.has_match("$SYS/bar")));
+    REQUIRE((cmatcher{{"foo/#", 42}}.has_match("foo/$bar")));
+    REQUIRE((cmatcher{{"foo/+/baz", 42}}.has_match("foo/$bar/baz")));
+
+    // Should not match
+
+    REQUIRE(!(cmatcher{{"test/6/#", 42}}.has_match("test/3")));
+    REQUIRE(!(cmatcher{{"foo/bar", 42}}.has_match("foo")));
+    REQUIRE(!(cmatcher{{"foo/+", 42}}.has_match("foo/bar/baz")));
+    REQUIRE(!(cmatcher{{"foo/+/baz", 42}}.has_match("foo/bar/bar")));
+    REQUIRE(!(cmatcher{{"foo/+/#", 42}}.has_match("fo2/bar/baz")));
+    REQUIRE(!(cmatcher{{"/#", 42}}.has_match("foo/bar")));
+    REQUIRE(!(cmatcher{{"#", 42}}.has_match("$SYS/bar")));
+    REQUIRE(!(cmatcher{{"$BOB/bar", 42}}.has_match("$SYS/bar")));
+    REQUIRE(!(cmatcher{{"+/bar", 42}}.has_match("$SYS/bar")));
+}
+
+TEST_CASE("compiled matcher large", "[compiled_topic_matcher]")
+{
+    // Enough filters to exercise the perfect hash, checked against the
+    // trie that it was built from.
+    topic_matcher<int> tm;
+    int n = 0;
+    for (int site = 0; site < 20; ++site) {
+        for (int dev = 0; dev < 50; ++dev) {
+            auto base = "site/" + std::to_string(site) + "/dev" + std::to_string(dev);
+            tm.insert({base + "/temp", n++});
+            if (dev % 10 == 0)
+                tm.insert({base + "/#", n++});
+        }
+        tm.insert({"site/" + std::to_string(site) + "/+/temp", n++});
+    }
+    tm.insert({"site/+/dev7/temp", n++});
+
+    auto ctm = tm.freeze();
+    REQUIRE(ctm.size() == size_t(n));
+
+    for (const char* topic : {"site/3/dev7/temp", "site/19/dev40/temp", "site/4/dev20/humid",
+                              "site/20/dev1/temp", "site/7/dev51/temp", "other"}) {
+        std::string t{topic};
+        std::set<int> expected, found;
+        for (auto it = tm.matches(t); it != tm.matches_cend(); ++it)
+            expected.insert(it->second);
+        for (auto it = ctm.matches(t); it != ctm.matches_cend(); ++it)
+            found.insert(it->second);
+        REQUIRE(found == expected);
+    }
+
+    for (const auto& val : ctm) {
+        auto it = ctm.find(val.first);
+        REQUIRE(it != ctm.end());
+        REQUIRE(it->second == val.second);
+    }
+}
+
+TEST_CASE("compiled matcher deep", "[compiled_topic_matcher]")
+{
+    // Deeper than the iterator can search without allocating
+    std::string filter, topic;
+    for (int i = 0; i < 40; ++i) {
+        if (i) {
+            filter += '/';
+            topic += '/';
+        }
+        filter += (i % 2) ? "+" : "x";
+        topic += "x";
+    }
+
+    cmatcher tm{{filter, 1}, {"x/#", 2}, {topic, 3}};
+
+    std::set<int> found;
+    for (auto it = tm.matches(topic); it != tm.matches_end(); ++it) found.insert(it->second);
+    REQUIRE(found == std::set<int>{1, 2, 3});
+}
@@ -0,0 +1,156 @@
+// test_concurrent_topic_matcher.cpp
+//
+// Unit tests for the concurrent_topic_matcher class in the Paho MQTT C++
+// library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/concurrent_topic_matcher.h"
+
+using namespace mqtt;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("concurrent matcher insert/find", "[concurrent_topic_matcher]")
+{
+    concurrent_topic_matcher<int> tm;
+
+    REQUIRE(!tm.find("some/random/topic"));
+
+    tm.insert({"some/random/topic", 42});
+
+    auto val = tm.find("some/random/topic");
+    REQUIRE(val);
+    REQUIRE(*val == 42);
+
+    // Inserting the same filter replaces the value
+    tm.insert({"some/random/topic", 43});
+    REQUIRE(*tm.find("some/random/topic") == 43);
+}
+
+TEST_CASE("concurrent matcher matches", "[concurrent_topic_matcher]")
+{
+    concurrent_topic_matcher<int> tm{
+        {"some/random/topic", 42},
+        {"some/#", 99},
+        {"some/other/topic", 55},
+        {"some/+/topic", 33}
+    };
+
+    auto v = tm.matches("some/random/topic");
+    REQUIRE(v.size() == 3);
+
+    for (const auto& val : v) {
+        bool ok =
+            ((val.first == "some/random/topic" && val.second == 42) ||
+             (val.first == "some/#" && val.second == 99) ||
+             (val.first == "some/+/topic" && val.second == 33));
+        REQUIRE(ok);
+    }
+
+    int sum = 0;
+    auto n = tm.for_each_match("some/other/topic", [&sum](const auto& val) {
+        sum += val.second;
+    });
+    REQUIRE(n == 3);
+    REQUIRE(sum == 55 + 99 + 33);
+
+    REQUIRE(tm.has_match("some/thing"));
+    REQUIRE(!tm.has_match("other/thing"));
+    REQUIRE(!tm.has_match("$SYS/thing"));
+}
+
+TEST_CASE("concurrent matcher remove", "[concurrent_topic_matcher]")
+{
+    concurrent_topic_matcher<int> tm{{"some/random/topic", 42}, {"some/#", 99}};
+
+    auto val = tm.remove("some/#");
+    REQUIRE(val);
+    REQUIRE(*val == 99);
+
+    REQUIRE(!tm.remove("some/#"));
+    REQUIRE(!tm.remove("not/there"));
+
+    REQUIRE(!tm.has_match("some/thing"));
+    REQUIRE(tm.has_match("some/random/topic"));
+}
+
+TEST_CASE("concurrent matcher update", "[concurrent_topic_matcher]")
+{
+    concurrent_topic_matcher<int> tm;
+
+    tm.update([](topic_matcher<int>& m) {
+        m.insert({"a/b", 1});
+        m.insert({"a/+", 2});
+        m.remove("a/b");
+    });
+
+    REQUIRE(!tm.find("a/b"));
+    REQUIRE(tm.matches("a/b").size() == 1);
+}
+
+TEST_CASE("concurrent matcher threads", "[concurrent_topic_matcher]")
+{
+    const int N_READERS = 4;
+    const int N_UPDATES = 500;
+
+    concurrent_topic_matcher<int> tm{{"data/#", 1}};
+
+    std::atomic<bool> done{false};
+    std::atomic<int> nBad{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < N_READERS; ++i) {
+        readers.emplace_back([&] {
+            while (!done) {
+                // The fixed filter is always there, and the other entries
+                // come and go as a unit.
+                auto v = tm.matches("data/temp/1");
+                if (v.size() != 1 && v.size() != 3)
+                    ++nBad;
+                if (!tm.has_match("data/x"))
+                    ++nBad;
+            }
+        });
+    }
+
+    for (int i = 0; i < N_UPDATES; ++i) {
+        tm.update([i](topic_matcher<int>& m) {
+            m.insert({"data/temp/1", i});
+            m.insert({"data/+/1", i});
+        });
+        tm.update([](topic_matcher<int>& m) {
+            m.remove("data/temp/1");
+            m.remove("data/+/1");
+        });
+    }
+
+    done = true;
+    for (auto& thr : readers) thr.join();
+
+    REQUIRE(nBad == 0);
+    REQUIRE(tm.matches("data/temp/1").size() == 1);
+}
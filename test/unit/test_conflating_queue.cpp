@@ -0,0 +1,175 @@
+// test_conflating_queue.cpp
+//
+// Unit tests for the conflating_queue class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/conflating_queue.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+static event msg_event(const string& topic, const string& payload)
+{
+    return event{make_message(topic, payload)};
+}
+
+static string payload_of(event evt)
+{
+    return evt.get_message()->get_payload_str();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("conflating_queue default", "[conflating_queue]")
+{
+    conflating_queue que;
+    REQUIRE(que.empty());
+    REQUIRE(0 == que.size());
+    REQUIRE(conflating_queue::MAX_CAPACITY == que.capacity());
+    REQUIRE(!que.closed());
+}
+
+TEST_CASE("conflating_queue latest per topic", "[conflating_queue]")
+{
+    conflating_queue que;
+
+    que.put(msg_event("a", "a1"));
+    que.put(msg_event("b", "b1"));
+    que.put(msg_event("a", "a2"));
+    que.put(msg_event("c", "c1"));
+    que.put(msg_event("a", "a3"));
+    que.put(msg_event("b", "b2"));
+
+    // One entry per topic, in the order of their first update
+    REQUIRE(3 == que.size());
+    REQUIRE(3 == que.num_conflated());
+
+    REQUIRE("a3" == payload_of(que.get()));
+    REQUIRE("b2" == payload_of(que.get()));
+
+    // Once read, a topic starts a new entry at the back
+    que.put(msg_event("a", "a4"));
+    REQUIRE("c1" == payload_of(que.get()));
+    REQUIRE("a4" == payload_of(que.get()));
+    REQUIRE(que.empty());
+}
+
+TEST_CASE("conflating_queue other events", "[conflating_queue]")
+{
+    conflating_queue que;
+
+    que.put(msg_event("a", "a1"));
+    que.put(event{connection_lost_event{}});
+    que.put(event{connection_lost_event{}});
+    que.put(msg_event("a", "a2"));
+
+    REQUIRE(3 == que.size());
+
+    event evt;
+    REQUIRE(que.try_get(&evt));
+    REQUIRE("a2" == payload_of(evt));
+    REQUIRE(que.try_get(&evt));
+    REQUIRE(evt.is_connection_lost());
+    REQUIRE(que.try_get(&evt));
+    REQUIRE(evt.is_connection_lost());
+    REQUIRE(!que.try_get(&evt));
+}
+
+TEST_CASE("conflating_queue capacity", "[conflating_queue]")
+{
+    conflating_queue que{2};
+    REQUIRE(2 == que.capacity());
+
+    REQUIRE(que.try_put(msg_event("a", "a1")));
+    REQUIRE(que.try_put(msg_event("b", "b1")));
+    REQUIRE(!que.try_put(msg_event("c", "c1")));
+
+    // A pending topic can still be updated when full
+    REQUIRE(que.try_put(msg_event("a", "a2")));
+    que.put(msg_event("b", "b2"));
+    REQUIRE(2 == que.size());
+
+    std::thread thr{[&que] {
+        std::this_thread::sleep_for(milliseconds(10));
+        que.get();
+    }};
+    que.put(msg_event("c", "c1"));
+    thr.join();
+
+    std::vector<event> evts;
+    REQUIRE(2 == que.try_get_n(&evts, 5));
+    REQUIRE("b2" == payload_of(evts[0]));
+    REQUIRE("c1" == payload_of(evts[1]));
+}
+
+TEST_CASE("conflating_queue close", "[conflating_queue]")
+{
+    conflating_queue que;
+    que.put(msg_event("a", "a1"));
+    que.close();
+
+    REQUIRE(que.closed());
+    REQUIRE(!que.done());
+    REQUIRE_THROWS_AS(que.put(msg_event("a", "a2")), queue_closed);
+    REQUIRE(!que.try_put(msg_event("b", "b1")));
+
+    REQUIRE("a1" == payload_of(que.get()));
+    REQUIRE(que.done());
+    REQUIRE_THROWS_AS(que.get(), queue_closed);
+
+    event evt;
+    REQUIRE(!que.try_get_for(&evt, milliseconds(1)));
+}
+
+TEST_CASE("conflating_queue clear", "[conflating_queue]")
+{
+    conflating_queue que;
+    que.put(msg_event("a", "a1"));
+    que.put(msg_event("b", "b1"));
+    que.clear();
+    REQUIRE(que.empty());
+
+    que.put(msg_event("b", "b2"));
+    que.put(msg_event("a", "a2"));
+    REQUIRE("b2" == payload_of(que.get()));
+    REQUIRE("a2" == payload_of(que.get()));
+
+    event evt;
+    REQUIRE(!que.try_get_until(&evt, steady_clock::now() + milliseconds(1)));
+}
+
+TEST_CASE("async_client consuming conflated", "[conflating_queue]")
+{
+    async_client cli{"tcp://localhost:1883", "test_conflating_queue"};
+    cli.start_consuming_conflated();
+
+    const_message_ptr msg;
+    REQUIRE(!cli.try_consume_message(&msg));
+
+    cli.stop_consuming();
+    REQUIRE(cli.consumer_closed());
+}
@@ -194,8 +194,9 @@ TEST_CASE("connect_options copy ctor", "[options]")
         const auto& copts = opts.c_struct();
         const auto& orgCopts = orgOpts.c_struct();
 
-        // Make sure it's an actual copy
-        REQUIRE(copts.connectProperties->array != orgCopts.connectProperties->array);
+        // The copy shares the properties, but outlives changes to the original
+        REQUIRE(copts.connectProperties != orgCopts.connectProperties);
+        REQUIRE(copts.connectProperties->array == orgCopts.connectProperties->array);
         orgOpts.get_properties().clear();
 
         REQUIRE(1 == opts.get_properties().size());
@@ -312,8 +313,9 @@ TEST_CASE("connect_options copy_assignment", "[options]")
         const auto& copts = opts.c_struct();
         const auto& orgCopts = orgOpts.c_struct();
 
-        // Make sure it's an actual copy
-        REQUIRE(copts.connectProperties->array != orgCopts.connectProperties->array);
+        // The copy shares the properties, but outlives changes to the original
+        REQUIRE(copts.connectProperties != orgCopts.connectProperties);
+        REQUIRE(copts.connectProperties->array == orgCopts.connectProperties->array);
         orgOpts.get_properties().clear();
 
         // Check that we got the correct properties
@@ -752,3 +754,60 @@ TEST_CASE("connect_options_builder move_assignment", "[options]")
         );
     }
 }
+
+// ----------------------------------------------------------------------
+// Test the managed reconnect policy
+// ----------------------------------------------------------------------
+
+TEST_CASE("set_reconnect_policy", "[options]")
+{
+    connect_options opts;
+    REQUIRE(!opts.get_reconnect_policy());
+
+    opts.set_automatic_reconnect(true);
+
+    reconnect_policy policy{milliseconds(250), seconds(30)};
+    opts.set_reconnect_policy(policy);
+
+    // The C library's reconnects are turned off
+    REQUIRE(!opts.get_automatic_reconnect());
+
+    auto p = opts.get_reconnect_policy();
+    REQUIRE(p);
+    REQUIRE(milliseconds(250) == p->get_min_delay());
+    REQUIRE(seconds(30) == p->get_max_delay());
+
+    SECTION("copy")
+    {
+        connect_options optsCopy{opts};
+        REQUIRE(p == optsCopy.get_reconnect_policy());
+
+        connect_options optsAsgn;
+        optsAsgn = opts;
+        REQUIRE(p == optsAsgn.get_reconnect_policy());
+    }
+
+    SECTION("move")
+    {
+        connect_options optsMove{std::move(opts)};
+        REQUIRE(p == optsMove.get_reconnect_policy());
+    }
+
+    SECTION("clear")
+    {
+        opts.clear_reconnect_policy();
+        REQUIRE(!opts.get_reconnect_policy());
+    }
+}
+
+TEST_CASE("connect_options_builder reconnect_policy", "[options]")
+{
+    reconnect_policy policy;
+    policy.set_max_attempts(5);
+
+    auto opts = connect_options_builder().reconnect_policy(policy).finalize();
+
+    auto p = opts.get_reconnect_policy();
+    REQUIRE(p);
+    REQUIRE(5 == p->get_max_attempts());
+}
@@ -0,0 +1,85 @@
+// test_consumer_group.cpp
+//
+// Unit tests for the consumer_group class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/consumer_group.h"
+
+using namespace mqtt;
+
+static const std::string SERVER_URI{"mqtt://localhost:1883"};
+static const std::string CLIENT_ID{"consumer_group_test"};
+
+static create_options group_create_options()
+{
+    return create_options_builder()
+        .server_uri(SERVER_URI)
+        .client_id(CLIENT_ID)
+        .mqtt_version(MQTTVERSION_5)
+        .finalize();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("consumer group shared filter", "[consumer_group]")
+{
+    REQUIRE(consumer_group::shared_filter("grp", "data/#") == "$share/grp/data/#");
+}
+
+TEST_CASE("consumer group clients", "[consumer_group]")
+{
+    consumer_group grp{group_create_options(), "grp", 3, [](const_message_ptr) {}, 2};
+
+    REQUIRE(grp.size() == 3);
+    REQUIRE(grp.get_group_name() == "grp");
+    REQUIRE(grp.get_dispatcher().num_threads() == 2);
+
+    REQUIRE(grp.get_client(0).get_client_id() == CLIENT_ID + "-0");
+    REQUIRE(grp.get_client(2).get_client_id() == CLIENT_ID + "-2");
+    REQUIRE(grp.get_client(1).get_server_uri() == SERVER_URI);
+    REQUIRE_THROWS(grp.get_client(3));
+
+    consumer_group grp0{group_create_options(), "grp0", 0, [](const_message_ptr) {}, 1};
+    REQUIRE(grp0.size() == 1);
+}
+
+TEST_CASE("consumer group subscriptions", "[consumer_group]")
+{
+    consumer_group grp{group_create_options(), "grp", 2, [](const_message_ptr) {}, 1};
+
+    // Not connected, so these are just recorded for when we connect
+    grp.subscribe("data/#", 1);
+    grp.subscribe("cmd/+", 0);
+    grp.subscribe("data/#", 2);
+
+    auto subs = grp.get_subscriptions();
+    REQUIRE(subs.size() == 2);
+    REQUIRE(subs[0] == "data/#");
+    REQUIRE(subs[1] == "cmd/+");
+
+    grp.unsubscribe("data/#");
+    subs = grp.get_subscriptions();
+    REQUIRE(subs.size() == 1);
+    REQUIRE(subs[0] == "cmd/+");
+}
@@ -0,0 +1,108 @@
+// test_consumer_mux.cpp
+//
+// Unit tests for the consumer_mux class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/consumer_mux.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+static const std::string PAYLOAD{"payload"};
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("consumer_mux merge", "[mux]")
+{
+    async_client cli0{"tcp://localhost:1883", "test_mux_0"};
+    async_client cli1{"tcp://localhost:1883", "test_mux_1"};
+
+    consumer_mux mux;
+    REQUIRE(0 == mux.add(cli0));
+    REQUIRE(1 == mux.add(cli1));
+    REQUIRE(2 == mux.size());
+    REQUIRE(&cli1 == &mux.get_client(1));
+    REQUIRE_THROWS_AS(mux.get_client(2), std::out_of_range);
+
+    cli0.test_message_arrived("a/0", PAYLOAD.data(), PAYLOAD.size());
+    cli1.test_message_arrived("b/0", PAYLOAD.data(), PAYLOAD.size());
+    cli0.test_message_arrived("a/1", PAYLOAD.data(), PAYLOAD.size());
+    REQUIRE(3 == mux.queue_size());
+
+    // The events are tagged with the client, in the order they arrived
+    auto evt = mux.consume_event();
+    REQUIRE(0 == evt.client);
+    REQUIRE("a/0" == evt.evt.get_message()->get_topic());
+
+    std::vector<consumer_mux::client_event> evts;
+    REQUIRE(2 == mux.try_consume_events(evts, 10));
+    REQUIRE(1 == evts[0].client);
+    REQUIRE("b/0" == evts[0].evt.get_message()->get_topic());
+    REQUIRE(0 == evts[1].client);
+    REQUIRE("a/1" == evts[1].evt.get_message()->get_topic());
+
+    consumer_mux::client_event none;
+    REQUIRE(!mux.try_consume_event(&none));
+    REQUIRE(!mux.try_consume_event_for(&none, milliseconds(5)));
+
+    // The events only go to the mux
+    cli1.test_message_arrived("b/1", PAYLOAD.data(), PAYLOAD.size());
+    const_message_ptr msg;
+    REQUIRE(!cli1.try_consume_message(&msg));
+    REQUIRE(1 == mux.queue_size());
+
+    SECTION("client stopped")
+    {
+        cli1.stop_consuming();
+        cli1.test_message_arrived("b/2", PAYLOAD.data(), PAYLOAD.size());
+        REQUIRE(1 == mux.queue_size());
+
+        cli0.test_message_arrived("a/2", PAYLOAD.data(), PAYLOAD.size());
+        REQUIRE(2 == mux.queue_size());
+    }
+
+    SECTION("stopped")
+    {
+        std::thread thr([&] {
+            std::this_thread::sleep_for(milliseconds(10));
+            mux.stop();
+        });
+
+        REQUIRE(1 == mux.consume_event().client);
+        evt = mux.consume_event();
+        thr.join();
+
+        REQUIRE(consumer_mux::npos == evt.client);
+        REQUIRE(evt.evt.is_shutdown());
+
+        // Events after the stop are dropped
+        cli0.test_message_arrived("a/2", PAYLOAD.data(), PAYLOAD.size());
+        REQUIRE(0 == mux.queue_size());
+    }
+}
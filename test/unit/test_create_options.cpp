@@ -42,6 +42,7 @@ TEST_CASE("create_options default ctor", "[options]")
 
     REQUIRE(opts.get_restore_messages());
     REQUIRE(opts.get_persist_qos0());
+    REQUIRE(!opts.get_zero_copy_messages());
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -61,6 +62,7 @@ TEST_CASE("create_options_builder default ctor", "[options]")
 
     REQUIRE(opts.get_restore_messages());
     REQUIRE(opts.get_persist_qos0());
+    REQUIRE(!opts.get_zero_copy_messages());
 }
 
 TEST_CASE("create_options_builder sets", "[options]")
@@ -75,3 +77,90 @@ TEST_CASE("create_options_builder sets", "[options]")
     REQUIRE(opts.get_restore_messages());
     REQUIRE(opts.get_persist_qos0());
 }
+
+TEST_CASE("create_options_builder zero copy", "[options]")
+{
+    const auto opts = create_options_builder().zero_copy_messages().finalize();
+    REQUIRE(opts.get_zero_copy_messages());
+
+    // Survives a copy
+    create_options opts2{opts};
+    REQUIRE(opts2.get_zero_copy_messages());
+
+    opts2.set_zero_copy_messages(false);
+    REQUIRE(!opts2.get_zero_copy_messages());
+}
+
+TEST_CASE("create_options_builder interned topics", "[options]")
+{
+    REQUIRE(0 == create_options_builder().finalize().get_max_interned_topics());
+
+    const auto opts = create_options_builder().max_interned_topics(4096).finalize();
+    REQUIRE(4096 == opts.get_max_interned_topics());
+
+    create_options opts2;
+    opts2 = opts;
+    REQUIRE(4096 == opts2.get_max_interned_topics());
+}
+
+TEST_CASE("create_options_builder persistence group commit", "[options]")
+{
+    using namespace std::chrono;
+
+    const auto dflt = create_options_builder().finalize();
+    REQUIRE(0 == dflt.get_persistence_commit_interval().count());
+    REQUIRE(0 == dflt.get_persistence_commit_bytes());
+
+    const auto opts =
+        create_options_builder().persistence_group_commit(milliseconds(5), 65536).finalize();
+    REQUIRE(milliseconds(5) == opts.get_persistence_commit_interval());
+    REQUIRE(65536 == opts.get_persistence_commit_bytes());
+
+    create_options opts2;
+    opts2 = opts;
+    REQUIRE(milliseconds(5) == opts2.get_persistence_commit_interval());
+    REQUIRE(65536 == opts2.get_persistence_commit_bytes());
+
+    opts2.set_persistence_group_commit(seconds(1));
+    REQUIRE(milliseconds(1000) == opts2.get_persistence_commit_interval());
+    REQUIRE(0 == opts2.get_persistence_commit_bytes());
+}
+
+TEST_CASE("create_options_builder publish coalescing", "[options]")
+{
+    using namespace std::chrono;
+
+    const auto dflt = create_options_builder().finalize();
+    REQUIRE(0 == dflt.get_publish_coalescing_delay().count());
+    REQUIRE(0 == dflt.get_publish_coalescing_bytes());
+
+    const auto opts =
+        create_options_builder().publish_coalescing(microseconds(200), 8192).finalize();
+    REQUIRE(microseconds(200) == opts.get_publish_coalescing_delay());
+    REQUIRE(8192 == opts.get_publish_coalescing_bytes());
+
+    create_options opts2;
+    opts2 = opts;
+    REQUIRE(microseconds(200) == opts2.get_publish_coalescing_delay());
+    REQUIRE(8192 == opts2.get_publish_coalescing_bytes());
+
+    opts2.set_publish_coalescing(milliseconds(1));
+    REQUIRE(microseconds(1000) == opts2.get_publish_coalescing_delay());
+    REQUIRE(0 == opts2.get_publish_coalescing_bytes());
+}
+
+TEST_CASE("create_options_builder max topic aliases", "[options]")
+{
+    const auto dflt = create_options_builder().finalize();
+    REQUIRE(0 == dflt.get_max_topic_aliases());
+
+    const auto opts = create_options_builder().max_topic_aliases(100).finalize();
+    REQUIRE(100 == opts.get_max_topic_aliases());
+
+    create_options opts2;
+    opts2 = opts;
+    REQUIRE(100 == opts2.get_max_topic_aliases());
+
+    opts2.set_max_topic_aliases(0);
+    REQUIRE(0 == opts2.get_max_topic_aliases());
+}
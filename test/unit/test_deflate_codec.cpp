@@ -0,0 +1,85 @@
+// test_deflate_codec.cpp
+//
+// Unit tests for the deflate_codec class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/deflate_codec.h"
+
+using namespace mqtt;
+
+namespace {
+
+binary make_payload() {
+    binary payload;
+    for (int i = 0; i < 100; ++i)
+        payload += "{\"sensor\":\"temp-" + std::to_string(i % 7) + "\",\"value\":21.5}";
+    return payload;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("deflate_codec round trip", "[codec]")
+{
+    deflate_codec codec;
+    REQUIRE(deflate_codec::NAME == codec.name());
+
+    auto payload = make_payload();
+    auto enc = codec.encode(payload);
+    REQUIRE(enc.size() < payload.size());
+    REQUIRE(payload == codec.decode(enc));
+
+    // An empty payload makes it through, too
+    REQUIRE(codec.decode(codec.encode(binary())).empty());
+}
+
+TEST_CASE("deflate_codec dictionary", "[codec]")
+{
+    const binary DICT{"{\"sensor\":\"temp-\",\"value\":"};
+    deflate_codec codec{deflate_codec::DFLT_LEVEL, DICT};
+
+    // The name tells dictionaries apart
+    REQUIRE(codec.name() != deflate_codec::NAME);
+    REQUIRE(0 == codec.name().find(deflate_codec::NAME));
+    REQUIRE(codec.name() != deflate_codec(deflate_codec::DFLT_LEVEL, "other").name());
+
+    const binary MSG{"{\"sensor\":\"temp-3\",\"value\":19.25}"};
+    auto enc = codec.encode(MSG);
+    REQUIRE(enc.size() < deflate_codec().encode(MSG).size());
+    REQUIRE(MSG == codec.decode(enc));
+
+    // It can't be decoded without the dictionary
+    REQUIRE_THROWS_AS(deflate_codec().decode(enc), exception);
+}
+
+TEST_CASE("deflate_codec bad data", "[codec]")
+{
+    deflate_codec codec;
+    REQUIRE_THROWS_AS(codec.decode("not deflated"), exception);
+
+    auto enc = codec.encode(make_payload());
+    enc.resize(enc.size() / 2);
+    REQUIRE_THROWS_AS(codec.decode(enc), exception);
+}
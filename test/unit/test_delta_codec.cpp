@@ -0,0 +1,226 @@
+// test_delta_codec.cpp
+//
+// Unit tests for the delta_codec class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/delta_codec.h"
+#include "mqtt/message_tracer.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string SERVER_URI{"tcp://localhost:1883"};
+const std::string CLIENT_ID{"test_delta_codec"};
+const std::string TOPIC{"test/delta"};
+
+// A state document, with one field changed
+binary make_doc(int temp) {
+    binary doc(1000, '.');
+    auto val = std::to_string(temp);
+    doc.replace(500, val.size(), val);
+    return doc;
+}
+
+// A tracer that keeps the messages handed to the library
+class send_tracer : public message_tracer
+{
+public:
+    std::vector<const_message_ptr> sent;
+
+    void message_sent(const delivery_token& tok, int, time_point) override {
+        sent.push_back(tok.get_message());
+    }
+};
+
+string frame_of(const const_message_ptr& msg) {
+    auto val = get_user_property(msg->get_properties(), delta_codec::DELTA_PROPERTY);
+    return val ? string{*val} : string();
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("delta_codec make and apply", "[delta]")
+{
+    const binary PREV = make_doc(21), CUR = make_doc(22);
+
+    auto delta = delta_codec::make_delta(PREV, CUR);
+    REQUIRE(delta.size() < 8);
+
+    binary out;
+    REQUIRE(delta_codec::apply_delta(PREV, delta, out));
+    REQUIRE(CUR == out);
+
+    // No change is an empty delta
+    REQUIRE(delta_codec::make_delta(PREV, PREV).empty());
+    REQUIRE(delta_codec::apply_delta(PREV, binary{}, out));
+    REQUIRE(PREV == out);
+
+    // Changes all through the payload
+    binary a(300, 'a'), b = a;
+    b[0] = 'b';
+    b[2] = 'b';
+    b[150] = 'b';
+    b[299] = 'b';
+    REQUIRE(delta_codec::apply_delta(a, delta_codec::make_delta(a, b), out));
+    REQUIRE(b == out);
+
+    // A delta that runs past the payload is rejected
+    REQUIRE(!delta_codec::apply_delta(binary(4, 'x'), delta, out));
+}
+
+TEST_CASE("delta_codec encode and decode", "[delta]")
+{
+    delta_codec tx{4}, rx;
+
+    SECTION("keyframes and deltas")
+    {
+        for (int i = 0; i < 9; ++i) {
+            auto msg = make_message(TOPIC, make_doc(i));
+            auto enc = tx.encode(msg);
+            REQUIRE(enc != msg);
+
+            auto frame = frame_of(enc);
+            REQUIRE((i % 4 == 0 ? 'k' : 'd') == frame[0]);
+            if (frame[0] == 'd')
+                REQUIRE(enc->get_payload().size() < 8);
+
+            auto dec = rx.decode(enc);
+            REQUIRE(dec);
+            REQUIRE(make_doc(i) == dec->get_payload());
+            REQUIRE(frame_of(dec).empty());
+        }
+        REQUIRE(3 == tx.num_keyframes());
+        REQUIRE(6 == tx.num_deltas());
+        REQUIRE(0 == rx.num_unresolved());
+
+        // The original message is untouched
+        auto msg = make_message(TOPIC, make_doc(9));
+        tx.encode(msg);
+        REQUIRE(frame_of(msg).empty());
+        REQUIRE(make_doc(9) == msg->get_payload());
+    }
+
+    SECTION("a lost delta waits for the next keyframe")
+    {
+        rx.decode(tx.encode(make_message(TOPIC, make_doc(0))));
+        tx.encode(make_message(TOPIC, make_doc(1)));
+
+        REQUIRE(!rx.decode(tx.encode(make_message(TOPIC, make_doc(2)))));
+        REQUIRE(!rx.decode(tx.encode(make_message(TOPIC, make_doc(3)))));
+        REQUIRE(2 == rx.num_unresolved());
+
+        auto dec = rx.decode(tx.encode(make_message(TOPIC, make_doc(4))));
+        REQUIRE(dec);
+        REQUIRE(make_doc(4) == dec->get_payload());
+    }
+
+    SECTION("a message that isn't sent doesn't break the chain")
+    {
+        auto accept = [](const const_message_ptr&) { return true; };
+        auto refuse = [](const const_message_ptr&) { return false; };
+
+        rx.decode(tx.encode(make_message(TOPIC, make_doc(0)), accept));
+        auto enc1 = tx.encode(make_message(TOPIC, make_doc(1)), accept);
+
+        // The refused one is framed as the next delta, but isn't counted
+        auto lost = tx.encode(make_message(TOPIC, make_doc(2)), refuse);
+        REQUIRE("d3" == frame_of(lost));
+        REQUIRE(1 == tx.num_deltas());
+
+        // So the next one follows on from the last one that was sent
+        auto enc3 = tx.encode(make_message(TOPIC, make_doc(3)), accept);
+        REQUIRE("d3" == frame_of(enc3));
+        REQUIRE(2 == tx.num_deltas());
+
+        REQUIRE(make_doc(1) == rx.decode(enc1)->get_payload());
+        auto dec = rx.decode(enc3);
+        REQUIRE(dec);
+        REQUIRE(make_doc(3) == dec->get_payload());
+        REQUIRE(0 == rx.num_unresolved());
+    }
+
+    SECTION("keyframes for new sizes and retained messages")
+    {
+        tx.encode(make_message(TOPIC, make_doc(0)));
+        REQUIRE('k' == frame_of(tx.encode(make_message(TOPIC, binary(10, 'x'))))[0]);
+        REQUIRE('k' == frame_of(tx.encode(make_message(TOPIC, binary(10, 'y'), 1, true)))[0]);
+        REQUIRE('k' == frame_of(tx.encode(make_message("other", binary(10, 'y'))))[0]);
+        REQUIRE('d' == frame_of(tx.encode(make_message("other", binary(10, 'y'))))[0]);
+    }
+
+    SECTION("unmarked messages pass through")
+    {
+        auto msg = make_message(TOPIC, "hello");
+        REQUIRE(msg == rx.decode(msg));
+    }
+}
+
+TEST_CASE("async_client delta codec", "[delta]")
+{
+    auto opts = create_options_builder()
+                    .server_uri(SERVER_URI)
+                    .client_id(CLIENT_ID)
+                    .mqtt_version(MQTTVERSION_5)
+                    .finalize();
+    async_client cli{opts};
+    REQUIRE(!cli.get_delta_codec());
+
+    auto codec = std::make_shared<delta_codec>();
+    cli.set_delta_codec(codec);
+    REQUIRE(codec == cli.get_delta_codec());
+
+    // The library refuses each message, since the client isn't connected,
+    // so each one goes out as the first keyframe again.
+    send_tracer tr;
+    cli.set_message_tracer(tr);
+
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(!cli.try_publish(TOPIC, make_doc(i), 1, false));
+        REQUIRE(i + 1 == int(tr.sent.size()));
+        REQUIRE("k1" == frame_of(tr.sent.back()));
+        REQUIRE(make_doc(i) == tr.sent.back()->get_payload());
+    }
+    REQUIRE(0 == codec->num_keyframes());
+
+    // A message held in the offline buffer isn't encoded until it's sent,
+    // and one dropped from the buffer never is.
+    cli.start_offline_buffering();
+    auto tok = cli.publish(TOPIC, make_doc(3), 1, false);
+    REQUIRE(frame_of(tok->get_message()).empty());
+    cli.stop_offline_buffering();
+
+    REQUIRE(3 == tr.sent.size());
+    REQUIRE(0 == codec->num_keyframes());
+    REQUIRE(0 == codec->num_deltas());
+    cli.clear_message_tracer();
+
+    cli.set_delta_codec(delta_codec_ptr{});
+    REQUIRE(!cli.get_delta_codec());
+}
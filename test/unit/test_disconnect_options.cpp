@@ -109,8 +109,8 @@ TEST_CASE("disconnect_options copy ctor", "[options]")
         const auto& copts = opts.c_struct();
         const auto& orgCopts = orgOpts.c_struct();
 
-        // Make sure we copied the properties
-        REQUIRE(orgCopts.properties.array != copts.properties.array);
+        // The copy shares the properties, but outlives changes to the original
+        REQUIRE(orgCopts.properties.array == copts.properties.array);
         orgOpts.get_properties().clear();
 
         // Check that the properties transferred over
@@ -0,0 +1,192 @@
+// test_dispatcher.cpp
+//
+// Unit tests for the dispatcher class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/dispatcher.h"
+
+using namespace mqtt;
+
+static const std::vector<std::string> TOPICS{"a", "b/c", "d/e/f", "g", "h/i"};
+
+TEST_CASE("dispatcher threads", "[dispatcher]")
+{
+    dispatcher disp0{0, [](const_message_ptr) {}};
+    REQUIRE(1 == disp0.num_threads());
+    REQUIRE(!disp0.stopped());
+
+    dispatcher disp{4, [](const_message_ptr) {}};
+    REQUIRE(4 == disp.num_threads());
+
+    disp.stop();
+    REQUIRE(disp.stopped());
+    disp.stop();
+    REQUIRE(!disp.dispatch(message::create("a", "x")));
+    REQUIRE(!disp.dispatch(const_message_ptr{}));
+}
+
+TEST_CASE("dispatcher per-topic order", "[dispatcher]")
+{
+    constexpr int N = 500;
+
+    std::mutex lock;
+    std::map<std::string, std::vector<int>> recv;
+    std::set<std::thread::id> thrIds;
+
+    {
+        dispatcher disp{4, [&](const_message_ptr msg) {
+                            std::lock_guard<std::mutex> g{lock};
+                            recv[msg->get_topic()].push_back(std::stoi(msg->to_string()));
+                            thrIds.insert(std::this_thread::get_id());
+                        }};
+
+        for (int i = 0; i < N; ++i) {
+            for (const auto& topic : TOPICS)
+                REQUIRE(disp.dispatch(message::create(topic, std::to_string(i))));
+        }
+        // The destructor waits for the queues to drain
+    }
+
+    REQUIRE(recv.size() == TOPICS.size());
+    for (const auto& topic : TOPICS) {
+        const auto& v = recv[topic];
+        REQUIRE(v.size() == size_t(N));
+        for (int i = 0; i < N; ++i) REQUIRE(v[i] == i);
+    }
+    REQUIRE(!thrIds.empty());
+    REQUIRE(thrIds.size() <= 4);
+}
+
+TEST_CASE("dispatcher key function", "[dispatcher]")
+{
+    std::mutex lock;
+    std::set<std::thread::id> thrIds;
+
+    dispatcher disp{
+        4,
+        [&](const_message_ptr) {
+            std::lock_guard<std::mutex> g{lock};
+            thrIds.insert(std::this_thread::get_id());
+        },
+        [](const message&) { return std::size_t(3); }
+    };
+
+    for (const auto& topic : TOPICS) {
+        auto msg = message::create(topic, "x");
+        REQUIRE(3 == disp.worker_index(*msg));
+        disp.dispatch(msg);
+    }
+    disp.stop();
+
+    // Everything went to the same worker
+    REQUIRE(1 == thrIds.size());
+}
+
+TEST_CASE("dispatcher handler exception", "[dispatcher]")
+{
+    std::atomic<int> n{0};
+
+    dispatcher disp{1, [&](const_message_ptr) {
+                        if (n++ == 0)
+                            throw std::runtime_error("bad handler");
+                    }};
+
+    disp.dispatch(message::create("a", "x"));
+    disp.dispatch(message::create("a", "y"));
+    disp.stop();
+
+    REQUIRE(2 == n);
+    REQUIRE(0 == disp.size());
+}
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("work stealing dispatcher threads", "[dispatcher]")
+{
+    work_stealing_dispatcher disp0{0, [](const_message_ptr) {}};
+    REQUIRE(disp0.num_threads() >= 1);
+    REQUIRE(!disp0.stopped());
+
+    work_stealing_dispatcher disp{4, [](const_message_ptr) {}};
+    REQUIRE(4 == disp.num_threads());
+
+    disp.stop();
+    REQUIRE(disp.stopped());
+    disp.stop();
+    REQUIRE(!disp.dispatch(message::create("a", "x")));
+    REQUIRE(!disp.dispatch(const_message_ptr{}));
+}
+
+TEST_CASE("work stealing dispatcher stealing", "[dispatcher]")
+{
+    constexpr int N = 200;
+
+    std::mutex lock;
+    std::set<int> recv;
+    std::set<std::thread::id> thrIds;
+
+    {
+        work_stealing_dispatcher disp{4, [&](const_message_ptr msg) {
+                                          std::this_thread::sleep_for(std::chrono::microseconds(50));
+                                          std::lock_guard<std::mutex> g{lock};
+                                          recv.insert(std::stoi(msg->to_string()));
+                                          thrIds.insert(std::this_thread::get_id());
+                                      }};
+
+        // Everything goes on one queue, so the other workers must steal
+        for (int i = 0; i < N; ++i)
+            REQUIRE(disp.dispatch(message::create("a", std::to_string(i)), 0));
+
+        disp.stop();
+        REQUIRE(0 == disp.size());
+        REQUIRE(disp.num_stolen() > 0);
+    }
+
+    REQUIRE(recv.size() == size_t(N));
+    REQUIRE(thrIds.size() > 1);
+}
+
+TEST_CASE("work stealing dispatcher handler exception", "[dispatcher]")
+{
+    std::atomic<int> n{0};
+
+    work_stealing_dispatcher disp{1, [&](const_message_ptr) {
+                                      if (n++ == 0)
+                                          throw std::runtime_error("bad handler");
+                                  }};
+
+    disp.dispatch(message::create("a", "x"));
+    disp.dispatch(message::create("a", "y"), 5);
+    disp.stop();
+
+    REQUIRE(2 == n);
+    REQUIRE(0 == disp.size());
+}
@@ -0,0 +1,143 @@
+// test_duplicate_filter.cpp
+//
+// Unit tests for the duplicate_filter class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <memory>
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/duplicate_filter.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string TOPIC{"data/temp"};
+const std::string MSG_ID_PROP{"msg-id"};
+
+MQTTAsync_message c_msg(int qos, int msgid, bool dup) {
+    MQTTAsync_message msg = MQTTAsync_message_initializer;
+    msg.qos = qos;
+    msg.msgid = msgid;
+    msg.dup = dup ? 1 : 0;
+    return msg;
+}
+
+message prop_msg(const string& id) {
+    properties props{{property::USER_PROPERTY, MSG_ID_PROP, id}};
+    return message(TOPIC, "data", 1, false, props);
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("duplicate_filter ctor", "[dedup]")
+{
+    duplicate_filter filt;
+    REQUIRE(filt.get_property_name().empty());
+    REQUIRE(duplicate_filter::DFLT_WINDOW == filt.get_window());
+    REQUIRE(duplicate_filter::DFLT_FALSE_POSITIVE_RATE == filt.get_false_positive_rate());
+    REQUIRE(filt.memory_size() > 0);
+
+    duplicate_filter filt2{MSG_ID_PROP, 100, 0.01};
+    REQUIRE(MSG_ID_PROP == filt2.get_property_name());
+    REQUIRE(100 == filt2.get_window());
+    REQUIRE(filt2.memory_size() < filt.memory_size());
+}
+
+TEST_CASE("duplicate_filter by packet id", "[dedup]")
+{
+    duplicate_filter filt;
+
+    REQUIRE(!filt.check(TOPIC, c_msg(1, 42, false)));
+
+    // The redelivery is dropped
+    REQUIRE(filt.check(TOPIC, c_msg(1, 42, true)));
+    REQUIRE(1 == filt.num_dropped());
+
+    // A reused packet ID without the dup flag is a new message
+    REQUIRE(!filt.check(TOPIC, c_msg(1, 42, false)));
+
+    // As is the same ID on another topic
+    REQUIRE(!filt.check("other/topic", c_msg(1, 42, true)));
+
+    // QoS 0 has no packet ID, so it's not checked
+    REQUIRE(!filt.check(TOPIC, c_msg(0, 0, true)));
+    REQUIRE(4 == filt.num_checked());
+
+    filt.clear();
+    REQUIRE(!filt.check(TOPIC, c_msg(1, 42, true)));
+}
+
+TEST_CASE("duplicate_filter by property", "[dedup]")
+{
+    duplicate_filter filt{MSG_ID_PROP};
+
+    REQUIRE(!filt.check(prop_msg("a1")));
+    REQUIRE(!filt.check(prop_msg("a2")));
+
+    // With a key, the dup flag doesn't matter
+    REQUIRE(filt.check(prop_msg("a1")));
+    REQUIRE(1 == filt.num_dropped());
+
+    // Messages without the property are let through
+    message msg(TOPIC, "data", 1, false);
+    REQUIRE(!filt.check(msg));
+    REQUIRE(!filt.check(msg));
+    REQUIRE(3 == filt.num_checked());
+}
+
+TEST_CASE("duplicate_filter window", "[dedup]")
+{
+    const size_t WINDOW = 100;
+    duplicate_filter filt{MSG_ID_PROP, WINDOW};
+
+    for (size_t i = 0; i < 2 * WINDOW; ++i) REQUIRE(!filt.check(prop_msg(std::to_string(i))));
+
+    // The last window is remembered...
+    size_t nFound = 0;
+    for (size_t i = WINDOW; i < 2 * WINDOW; ++i)
+        nFound += filt.check(prop_msg(std::to_string(i))) ? 1 : 0;
+    REQUIRE(WINDOW == nFound);
+
+    // ...but the keys don't pile up forever
+    for (size_t i = 2 * WINDOW; i < 4 * WINDOW; ++i) filt.check(prop_msg(std::to_string(i)));
+    size_t nOld = 0;
+    for (size_t i = 0; i < WINDOW; ++i) nOld += filt.check(prop_msg(std::to_string(i))) ? 1 : 0;
+    REQUIRE(nOld < WINDOW / 10);
+}
+
+TEST_CASE("async_client duplicate filter", "[dedup]")
+{
+    async_client cli{"tcp://localhost:1883", "test_duplicate_filter"};
+    REQUIRE(!cli.get_duplicate_filter());
+
+    auto filt = std::make_shared<duplicate_filter>();
+    cli.set_duplicate_filter(filt);
+    REQUIRE(filt == cli.get_duplicate_filter());
+
+    cli.set_duplicate_filter(duplicate_filter_ptr{});
+    REQUIRE(!cli.get_duplicate_filter());
+    REQUIRE(0 == cli.get_metrics().num_duplicates_dropped());
+}
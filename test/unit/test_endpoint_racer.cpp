@@ -0,0 +1,177 @@
+// test_endpoint_racer.cpp
+//
+// Unit tests for the endpoint_racer class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/endpoint_racer.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+// --------------------------------------------------------------------------
+
+namespace {
+
+// A socket bound to an ephemeral port on the loopback interface.
+// If it's listening, connects to it complete from the backlog.
+// If not, they are refused.
+class local_port
+{
+    int fd_;
+    int port_{0};
+
+public:
+    explicit local_port(bool listening) : fd_{::socket(AF_INET, SOCK_STREAM, 0)} {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd_, (sockaddr*)&addr, sizeof(addr));
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, (sockaddr*)&addr, &len);
+        port_ = ntohs(addr.sin_port);
+
+        if (listening)
+            ::listen(fd_, 8);
+    }
+    ~local_port() { ::close(fd_); }
+
+    std::string uri() const { return "tcp://127.0.0.1:" + std::to_string(port_); }
+};
+
+}  // namespace
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("endpoint_racer host_port", "[racer]")
+{
+    string host, port;
+
+    REQUIRE(endpoint_racer::host_port("tcp://broker.example.com:1884", host, port));
+    REQUIRE("broker.example.com" == host);
+    REQUIRE("1884" == port);
+
+    REQUIRE(endpoint_racer::host_port("ssl://broker", host, port));
+    REQUIRE("broker" == host);
+    REQUIRE("8883" == port);
+
+    REQUIRE(endpoint_racer::host_port("ws://broker/mqtt", host, port));
+    REQUIRE("80" == port);
+
+    REQUIRE(endpoint_racer::host_port("mqtt://[::1]:1999", host, port));
+    REQUIRE("::1" == host);
+    REQUIRE("1999" == port);
+
+    REQUIRE(endpoint_racer::host_port("localhost", host, port));
+    REQUIRE("localhost" == host);
+    REQUIRE("1883" == port);
+
+    REQUIRE(!endpoint_racer::host_port("unix:///tmp/mqtt.sock", host, port));
+}
+
+TEST_CASE("endpoint_racer order", "[racer]")
+{
+    endpoint_racer racer;
+    string_collection uris{"tcp://a", "tcp://b", "tcp://c", "tcp://d"};
+
+    // Nothing known keeps the listed order
+    auto ordered = racer.order(uris);
+    REQUIRE("tcp://a" == ordered[0]);
+    REQUIRE("tcp://d" == ordered[3]);
+
+    racer.record("tcp://c", milliseconds(20));
+    racer.record("tcp://d", milliseconds(5));
+    racer.record_failure("tcp://a");
+
+    ordered = racer.order(uris);
+    REQUIRE("tcp://d" == ordered[0]);
+    REQUIRE("tcp://c" == ordered[1]);
+    REQUIRE("tcp://b" == ordered[2]);
+    REQUIRE("tcp://a" == ordered[3]);
+
+    // The connect times are averaged
+    racer.set_smoothing(0.5);
+    racer.record("tcp://d", milliseconds(45));
+    REQUIRE(milliseconds(25) == racer.latency("tcp://d"));
+
+    // A success clears the failures
+    REQUIRE(1 == racer.num_failures("tcp://a"));
+    racer.record("tcp://a", milliseconds(1));
+    REQUIRE(0 == racer.num_failures("tcp://a"));
+    REQUIRE("tcp://a" == racer.order(uris)[0]);
+
+    racer.clear();
+    REQUIRE(!racer.latency("tcp://a"));
+}
+
+TEST_CASE("endpoint_racer race", "[racer]")
+{
+    local_port refused{false}, listening{true};
+
+    endpoint_racer racer{milliseconds(50), milliseconds(2000)};
+    string_collection uris{refused.uri(), "unix:///tmp/none.sock", listening.uri()};
+
+    // The failed servers don't hold up the race
+    REQUIRE(listening.uri() == racer.race(uris));
+    REQUIRE(racer.latency(listening.uri()));
+    REQUIRE(1 == racer.num_failures(refused.uri()));
+    REQUIRE(1 == racer.num_failures("unix:///tmp/none.sock"));
+
+    SECTION("apply")
+    {
+        connect_options opts;
+        opts.set_servers(std::make_shared<string_collection>(uris));
+
+        REQUIRE(racer.apply(opts));
+        auto servers = opts.get_servers();
+        REQUIRE(3 == servers->size());
+        REQUIRE(listening.uri() == (*servers)[0]);
+    }
+
+    SECTION("none")
+    {
+        string_collection bad{refused.uri()};
+        REQUIRE(racer.race(bad).empty());
+        REQUIRE(2 == racer.num_failures(refused.uri()));
+
+        connect_options opts;
+        REQUIRE(!racer.apply(opts));
+    }
+}
+
+TEST_CASE("reconnect_policy endpoint racer", "[racer]")
+{
+    reconnect_policy policy;
+    REQUIRE(!policy.get_endpoint_racer());
+
+    auto racer = std::make_shared<endpoint_racer>();
+    policy.set_endpoint_racer(racer);
+    REQUIRE(racer == policy.get_endpoint_racer());
+}
@@ -0,0 +1,118 @@
+// test_event.cpp
+//
+// Unit tests for the event class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <utility>
+
+#include "catch2_version.h"
+#include "mqtt/event.h"
+#include "mqtt/thread_queue.h"
+
+using namespace mqtt;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("event size", "[event]")
+{
+    // The connection events are boxed, so an event is about the size of
+    // the message pointer.
+    REQUIRE(sizeof(event) <= sizeof(const_message_ptr) + sizeof(void*));
+}
+
+TEST_CASE("event types", "[event]")
+{
+    event evt;
+    REQUIRE(evt.is_message());
+    REQUIRE(!evt.get_message());
+
+    auto msg = make_message("a/b", "hello");
+    evt = event{msg};
+    REQUIRE(evt.is_message());
+    REQUIRE(msg == evt.get_message());
+    REQUIRE(!evt.is_any_disconnect());
+
+    evt = event{connected_event{"cause"}};
+    REQUIRE(evt.is_connected());
+    REQUIRE(!evt.is_message());
+    REQUIRE(!evt.get_message_if());
+    REQUIRE(!evt.is_any_disconnect());
+
+    evt = event{connection_lost_event{}};
+    REQUIRE(evt.is_connection_lost());
+    REQUIRE(evt.is_any_disconnect());
+
+    evt = event{shutdown_event{}};
+    REQUIRE(evt.is_shutdown());
+    REQUIRE(!evt.is_disconnected());
+    REQUIRE(evt.is_any_disconnect());
+
+    // From the variant
+    evt = event::event_type{connected_event{}};
+    REQUIRE(evt.is_connected());
+}
+
+TEST_CASE("event disconnected", "[event]")
+{
+    properties props{{property::REASON_STRING, "bye"}};
+    event evt{disconnected_event{props, ReasonCode::SERVER_SHUTTING_DOWN}};
+    REQUIRE(evt.is_disconnected());
+    REQUIRE(!evt.is_shutdown());
+
+    auto p = evt.get_disconnected_if();
+    REQUIRE(p);
+    REQUIRE(ReasonCode::SERVER_SHUTTING_DOWN == p->reasonCode);
+
+    // Copies are deep
+    event copy{evt};
+    REQUIRE(copy.is_disconnected());
+    REQUIRE(copy.get_disconnected_if() != p);
+    REQUIRE(ReasonCode::SERVER_SHUTTING_DOWN == copy.get_disconnected().reasonCode);
+    REQUIRE(
+        "bye" == get<string>(copy.get_disconnected().props.get(property::REASON_STRING))
+    );
+
+    event assigned;
+    assigned = evt;
+    REQUIRE(assigned.is_disconnected());
+
+    REQUIRE(!event{}.get_disconnected_if());
+}
+
+TEST_CASE("event moves messages", "[event]")
+{
+    auto msg = make_message("a/b", "hello");
+    REQUIRE(1 == msg.use_count());
+
+    thread_queue<event> que;
+    que.put(event{const_message_ptr{msg}});
+    REQUIRE(2 == msg.use_count());
+
+    // Getting from the queue and taking the message moves it
+    auto evt = que.get();
+    REQUIRE(2 == msg.use_count());
+
+    auto pval = evt.get_message_if();
+    REQUIRE(pval);
+    auto rcv = std::move(*pval);
+    REQUIRE(2 == msg.use_count());
+    REQUIRE(msg == rcv);
+}
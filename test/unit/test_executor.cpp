@@ -0,0 +1,121 @@
+// test_executor.cpp
+//
+// Unit tests for the executor classes in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mock_action_listener.h"
+#include "mock_async_client.h"
+#include "mqtt/executor.h"
+#include "mqtt/token.h"
+
+using namespace mqtt;
+
+// A mock client that runs the completion callbacks on an executor
+class exec_async_client : public mock_async_client
+{
+    executor_ptr exec_;
+
+public:
+    explicit exec_async_client(executor_ptr exec) : exec_{std::move(exec)} {}
+    executor_ptr get_completion_executor() const override { return exec_; }
+};
+
+// ----------------------------------------------------------------------
+
+TEST_CASE("inline executor", "[executor]")
+{
+    inline_executor exec;
+    auto thisId = std::this_thread::get_id();
+    std::thread::id id;
+
+    REQUIRE(exec.execute([&id] { id = std::this_thread::get_id(); }));
+    REQUIRE(thisId == id);
+}
+
+TEST_CASE("thread executor", "[executor]")
+{
+    thread_executor exec;
+    REQUIRE(!exec.stopped());
+
+    std::mutex mtx;
+    std::vector<int> order;
+    std::thread::id id;
+
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(exec.execute([&, i] {
+            std::lock_guard<std::mutex> g{mtx};
+            order.push_back(i);
+            id = std::this_thread::get_id();
+        }));
+    }
+
+    // A task that throws doesn't stop the executor
+    REQUIRE(exec.execute([] { throw std::runtime_error("oops"); }));
+
+    std::atomic<bool> ran{false};
+    REQUIRE(exec.execute([&ran] { ran = true; }));
+
+    exec.stop();
+    REQUIRE(exec.stopped());
+    REQUIRE(ran);
+    REQUIRE(0 == exec.size());
+    REQUIRE(std::this_thread::get_id() != id);
+
+    REQUIRE(100 == order.size());
+    for (int i = 0; i < 100; ++i) REQUIRE(i == order[i]);
+
+    // Once stopped, tasks are refused
+    REQUIRE(!exec.execute([] {}));
+    exec.stop();
+}
+
+TEST_CASE("token completion on executor", "[executor]")
+{
+    auto exec = std::make_shared<thread_executor>();
+    exec_async_client cli{exec};
+
+    mock_action_listener listener;
+    token tok{token::Type::PUBLISH, cli, nullptr, listener};
+
+    std::thread::id handlerId;
+    REQUIRE(tok.set_complete_handler([&handlerId] {
+        handlerId = std::this_thread::get_id();
+    }));
+
+    MQTTAsync_successData data{};
+    mock_async_client::succeed(&tok, &data);
+
+    // The token is complete right away, while the callbacks are run by
+    // the executor's thread.
+    REQUIRE(tok.is_complete());
+    exec->stop();
+
+    REQUIRE(listener.succeeded());
+    REQUIRE(std::thread::id{} != handlerId);
+    REQUIRE(std::this_thread::get_id() != handlerId);
+}
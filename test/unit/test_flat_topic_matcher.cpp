@@ -0,0 +1,133 @@
+// test_flat_topic_matcher.cpp
+//
+// Unit tests for the flat_topic_matcher class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <set>
+
+#include "catch2_version.h"
+#include "mqtt/flat_topic_matcher.h"
+
+using namespace mqtt;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("flat insert/get", "[flat_topic_matcher]")
+{
+    flat_topic_matcher<int> tm;
+
+    tm.insert({"some/random/topic", 42});
+
+    auto it = tm.find("some/random/topic");
+
+    REQUIRE(it != tm.end());
+    REQUIRE(it->first == "some/random/topic");
+    REQUIRE(it->second == 42);
+
+    REQUIRE(!(tm.find("some/random") != tm.end()));
+    REQUIRE(!(tm.find("some/other/topic") != tm.end()));
+
+    // Inserting again replaces the value
+    tm.insert({"some/random/topic", 99});
+    REQUIRE(tm.size() == 1);
+    REQUIRE(tm.find("some/random/topic")->second == 99);
+}
+
+TEST_CASE("flat matcher initialize", "[flat_topic_matcher]")
+{
+    flat_topic_matcher<int> tm{
+        {"some/random/topic", 42},
+        {"some/#", 99},
+        {"some/other/topic", 55},
+        {"some/+/topic", 33}
+    };
+
+    std::set<int> found;
+    for (auto it = tm.matches("some/random/topic"); it != tm.matches_end(); ++it) {
+        found.insert(it->second);
+    }
+
+    REQUIRE(found == std::set<int>{42, 99, 33});
+}
+
+TEST_CASE("flat matcher remove", "[flat_topic_matcher]")
+{
+    flat_topic_matcher<int> tm{
+        {"some/random/topic", 42},
+        {"some/#", 99},
+        {"some/+/topic", 33}
+    };
+
+    auto val = tm.remove("some/#");
+    REQUIRE(val);
+    REQUIRE(*val == 99);
+    REQUIRE(tm.size() == 2);
+    REQUIRE(!tm.remove("some/#"));
+    REQUIRE(!tm.remove("not/there"));
+
+    std::set<int> found;
+    for (auto it = tm.matches("some/random/topic"); it != tm.matches_end(); ++it) {
+        found.insert(it->second);
+    }
+    REQUIRE(found == std::set<int>{42, 33});
+
+    // The remaining values are intact after pruning
+    tm.prune();
+    REQUIRE(tm.size() == 2);
+    REQUIRE(tm.find("some/random/topic")->second == 42);
+    REQUIRE(tm.find("some/+/topic")->second == 33);
+    REQUIRE(!tm.has_match("some/thing"));
+
+    size_t n = 0;
+    for (auto it = tm.begin(); it != tm.end(); ++it) ++n;
+    REQUIRE(n == 2);
+}
+
+// This one is mostly borrowed from the Paho Python tests.
+// It has a number of good corner cases that shoud and should not match.
+TEST_CASE("flat matcher matches", "[flat_topic_matcher]")
+{
+    // Should match
+
+    REQUIRE((flat_topic_matcher<int>{{"foo/bar", 42}}.has_match("foo/bar")));
+    REQUIRE((flat_topic_matcher<int>{{"foo/+", 42}}.has_match("foo/bar")));
+    REQUIRE((flat_topic_matcher<int>{{"foo/+/baz", 42}}.has_match("foo/bar/baz")));
+    REQUIRE((flat_topic_matcher<int>{{"foo/+/#", 42}}.has_match("foo/bar/baz")));
+    REQUIRE((flat_topic_matcher<int>{{"A/B/+/#", 42}}.has_match("A/B/B/C")));
+    REQUIRE((flat_topic_matcher<int>{{"#", 42}}.has_match("foo/bar/baz")));
+    REQUIRE((flat_topic_matcher<int>{{"#", 42}}.has_match("/foo/bar")));
+    REQUIRE((flat_topic_matcher<int>{{"/#", 42}}.has_match("/foo/bar")));
+    REQUIRE((flat_topic_matcher<int>{{"$SYS/bar", 42}}.has_match("$SYS/bar")));
+    REQUIRE((flat_topic_matcher<int>{{"foo/#", 42}}.has_match("foo/$bar")));
+    REQUIRE((flat_topic_matcher<int>{{"foo/+/baz", 42}}.has_match("foo/$bar/baz")));
+
+    // Should not match
+
+    REQUIRE(!(flat_topic_matcher<int>{{"test/6/#", 42}}.has_match("test/3")));
+    REQUIRE(!(flat_topic_matcher<int>{{"foo/bar", 42}}.has_match("foo")));
+    REQUIRE(!(flat_topic_matcher<int>{{"foo/+", 42}}.has_match("foo/bar/baz")));
+    REQUIRE(!(flat_topic_matcher<int>{{"foo/+/baz", 42}}.has_match("foo/bar/bar")));
+    REQUIRE(!(flat_topic_matcher<int>{{"foo/+/#", 42}}.has_match("fo2/bar/baz")));
+    REQUIRE(!(flat_topic_matcher<int>{{"/#", 42}}.has_match("foo/bar")));
+    REQUIRE(!(flat_topic_matcher<int>{{"#", 42}}.has_match("$SYS/bar")));
+    REQUIRE(!(flat_topic_matcher<int>{{"$BOB/bar", 42}}.has_match("$SYS/bar")));
+    REQUIRE(!(flat_topic_matcher<int>{{"+/bar", 42}}.has_match("$SYS/bar")));
+}
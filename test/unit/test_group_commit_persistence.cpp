@@ -0,0 +1,164 @@
+// test_group_commit_persistence.cpp
+//
+// Unit tests for the group_commit_persistence class in the Paho MQTT C++
+// library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "catch2_version.h"
+#include "mock_persistence.h"
+#include "mqtt/group_commit_persistence.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+static const std::string CLIENT_ID{"clientid"};
+static const std::string SERVER_URI{"serveruri"};
+
+// An in-memory store that counts the calls to sync()
+class sync_counting_persistence : public mock_persistence
+{
+public:
+    std::atomic<int> nSync{0};
+    void sync() override { ++nSync; }
+};
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("group_commit_persistence buffers changes", "[persistence]")
+{
+    sync_counting_persistence store;
+    std::string a{"aaa"}, b{"bbb"}, c{"ccc"};
+
+    store.open(CLIENT_ID, SERVER_URI);
+    store.put("old", {c});
+
+    // A long interval, so nothing commits on its own
+    group_commit_persistence per{store, hours(1)};
+    per.open(CLIENT_ID, SERVER_URI);
+
+    per.put("a", {a});
+    per.put("b", {b, b});
+    per.remove("old");
+
+    REQUIRE(3 == per.num_pending());
+    REQUIRE(!store.contains_key("a"));
+    REQUIRE(store.contains_key("old"));
+
+    // Reads see the pending changes
+    REQUIRE(per.contains_key("a"));
+    REQUIRE(!per.contains_key("old"));
+    REQUIRE(per.get("b") == "bbbbbb");
+    REQUIRE_THROWS_AS(per.get("old"), persistence_exception);
+    REQUIRE_THROWS_AS(per.remove("old"), persistence_exception);
+    REQUIRE_THROWS_AS(per.remove("none"), persistence_exception);
+    REQUIRE(per.keys().size() == 2);
+
+    per.commit();
+
+    REQUIRE(0 == per.num_pending());
+    REQUIRE(1 == store.nSync);
+    REQUIRE(store.get("a") == "aaa");
+    REQUIRE(store.get("b") == "bbbbbb");
+    REQUIRE(!store.contains_key("old"));
+
+    // Nothing more to commit, so no sync
+    per.commit();
+    REQUIRE(1 == store.nSync);
+
+    per.close();
+}
+
+TEST_CASE("group_commit_persistence commit triggers", "[persistence]")
+{
+    sync_counting_persistence store;
+    std::string data(100, 'x');
+
+    SECTION("interval")
+    {
+        group_commit_persistence per{store, milliseconds(10)};
+        per.open(CLIENT_ID, SERVER_URI);
+
+        per.put("a", {data});
+        per.put("b", {data});
+
+        for (int i = 0; i < 500 && per.num_pending() != 0; ++i)
+            std::this_thread::sleep_for(milliseconds(5));
+
+        REQUIRE(0 == per.num_pending());
+        REQUIRE(store.contains_key("a"));
+        REQUIRE(store.contains_key("b"));
+        per.close();
+    }
+
+    SECTION("size")
+    {
+        group_commit_persistence per{store, hours(1), 250};
+        per.open(CLIENT_ID, SERVER_URI);
+
+        per.put("a", {data});
+        per.put("b", {data});
+        per.put("c", {data});
+
+        for (int i = 0; i < 500 && per.num_pending() != 0; ++i)
+            std::this_thread::sleep_for(milliseconds(5));
+
+        REQUIRE(0 == per.num_pending());
+        REQUIRE(1 == store.nSync);
+        per.close();
+    }
+
+    SECTION("close")
+    {
+        group_commit_persistence per{store, hours(1)};
+        per.open(CLIENT_ID, SERVER_URI);
+
+        per.put("a", {data});
+        per.close();
+
+        REQUIRE(store.get("a") == data);
+    }
+}
+
+TEST_CASE("group_commit_persistence clear", "[persistence]")
+{
+    sync_counting_persistence store;
+    std::string data{"data"};
+
+    group_commit_persistence per{store, hours(1)};
+    per.open(CLIENT_ID, SERVER_URI);
+
+    per.put("a", {data});
+    per.commit();
+    per.put("b", {data});
+
+    per.clear();
+    REQUIRE(0 == per.num_pending());
+    REQUIRE(per.keys().empty());
+    REQUIRE(store.keys().empty());
+
+    per.close();
+}
@@ -0,0 +1,326 @@
+// test_inflight_window.cpp
+//
+// Unit tests for the inflight_window class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/inflight_window.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+namespace {
+
+const std::string SERVER_URI{"tcp://localhost:1883"};
+const std::string CLIENT_ID{"test_inflight_window"};
+const std::string TOPIC{"topic"};
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("inflight_window ctor", "[inflight]")
+{
+    SECTION("defaults")
+    {
+        inflight_window win{100};
+        REQUIRE(100 == win.get_max_window());
+        REQUIRE(1 == win.get_min_window());
+        REQUIRE(inflight_window::DFLT_INIT_WINDOW == win.get_window());
+        REQUIRE(inflight_window::DFLT_DELAY_FACTOR == win.get_delay_factor());
+        REQUIRE(0 == win.in_flight());
+        REQUIRE(0 == win.queue_size());
+        REQUIRE(win.get_smoothed_rtt() == inflight_window::duration::zero());
+        REQUIRE(win.get_min_rtt() == inflight_window::duration::zero());
+        REQUIRE(!win.stopped());
+    }
+
+    SECTION("clamped")
+    {
+        inflight_window win{4, 0, 50};
+        REQUIRE(1 == win.get_min_window());
+        REQUIRE(4 == win.get_window());
+
+        inflight_window win2{2, 5, 1};
+        REQUIRE(5 == win2.get_max_window());
+        REQUIRE(5 == win2.get_window());
+    }
+}
+
+TEST_CASE("inflight_window holds what doesn't fit", "[inflight]")
+{
+    inflight_window win{100, 1, 2};
+    std::vector<int> sent;
+
+    auto task = [&sent](int n) {
+        return [&sent, n](bool ok) {
+            if (ok)
+                sent.push_back(n);
+        };
+    };
+
+    REQUIRE(win.submit(task(1)));
+    REQUIRE(win.submit(task(2)));
+    REQUIRE(win.submit(task(3)));
+    REQUIRE(win.submit(task(4)));
+
+    // The first two go right away
+    REQUIRE((std::vector<int>{1, 2}) == sent);
+    REQUIRE(2 == win.in_flight());
+    REQUIRE(2 == win.queue_size());
+
+    // An ack frees a slot, and grows the window by another
+    win.on_acked(1ms);
+    REQUIRE(3 == win.get_window());
+    REQUIRE((std::vector<int>{1, 2, 3, 4}) == sent);
+    REQUIRE(3 == win.in_flight());
+    REQUIRE(0 == win.queue_size());
+    REQUIRE(1 == win.num_acked());
+}
+
+TEST_CASE("inflight_window grows to the max", "[inflight]")
+{
+    inflight_window win{16, 1, 1};
+
+    for (int i = 0; i < 100; ++i) win.on_acked(1ms);
+    REQUIRE(16 == win.get_window());
+    REQUIRE(win.get_min_rtt() == 1ms);
+    REQUIRE(win.get_smoothed_rtt() == 1ms);
+    REQUIRE(0 == win.num_decreases());
+}
+
+TEST_CASE("inflight_window cuts on loss", "[inflight]")
+{
+    inflight_window win{100, 2, 20};
+
+    // With a long round trip, the second loss is in the same one
+    win.on_acked(1h);
+    REQUIRE(21 == win.get_window());
+
+    win.on_lost();
+    REQUIRE(10 == win.get_window());
+    REQUIRE(1 == win.num_lost());
+    REQUIRE(1 == win.num_decreases());
+
+    win.on_lost();
+    REQUIRE(10 == win.get_window());
+    REQUIRE(1 == win.num_decreases());
+
+    // Never below the min
+    inflight_window win2{100, 2, 3};
+    win2.on_lost();
+    std::this_thread::sleep_for(1ms);
+    win2.on_lost();
+    REQUIRE(2 == win2.get_window());
+}
+
+TEST_CASE("inflight_window cuts on delay", "[inflight]")
+{
+    inflight_window win{100, 1, 20};
+
+    for (int i = 0; i < 4; ++i) win.on_acked(1ms);
+    REQUIRE(24 == win.get_window());
+
+    // The smoothed round trip climbs past twice the shortest
+    while (win.num_decreases() == 0 && win.num_acked() < 100) win.on_acked(10ms);
+
+    REQUIRE(1 == win.num_decreases());
+    REQUIRE(win.get_window() < 24);
+    REQUIRE(win.get_min_rtt() == 1ms);
+    REQUIRE(win.get_smoothed_rtt() > 2ms);
+
+    // After the cut, it grows by a slot per window's worth of acks
+    std::this_thread::sleep_for(20ms);
+    auto n = win.get_window();
+    for (size_t i = 0; i < 4 * n; ++i) win.on_acked(1ms);
+    REQUIRE(win.get_window() > n);
+    REQUIRE(win.get_window() < 2 * n);
+}
+
+TEST_CASE("inflight_window stop", "[inflight]")
+{
+    inflight_window win{1, 1, 1};
+    int nSent = 0, nFailed = 0;
+
+    auto task = [&](bool ok) { ++(ok ? nSent : nFailed); };
+
+    REQUIRE(win.submit(task));
+    REQUIRE(win.submit(task));
+    REQUIRE(1 == nSent);
+
+    win.stop();
+    REQUIRE(win.stopped());
+    REQUIRE(1 == nFailed);
+    REQUIRE(0 == win.queue_size());
+    REQUIRE(!win.submit(task));
+
+    // The message in flight can still give back its slot
+    win.on_acked(1ms);
+    REQUIRE(0 == win.in_flight());
+    REQUIRE(1 == nSent);
+}
+
+TEST_CASE("inflight_window caps the queue", "[inflight]")
+{
+    inflight_window win{1, 1, 1, inflight_window::DFLT_DELAY_FACTOR, 2};
+    REQUIRE(2 == win.get_max_queue());
+
+    int nSent = 0;
+    auto task = [&nSent](bool ok) {
+        if (ok)
+            ++nSent;
+    };
+
+    REQUIRE(win.submit(task));
+    REQUIRE(win.submit(task));
+    REQUIRE(win.submit(task));
+    REQUIRE(!win.submit(task));
+    REQUIRE(1 == nSent);
+    REQUIRE(2 == win.queue_size());
+    REQUIRE(1 == win.num_rejected());
+    REQUIRE(!win.stopped());
+
+    // There's room again once one gets a slot
+    win.on_acked(1ms);
+    REQUIRE(2 == nSent);
+    REQUIRE(win.submit(task));
+    REQUIRE(2 == win.queue_size());
+}
+
+TEST_CASE("inflight_window task that throws", "[inflight]")
+{
+    inflight_window win{1, 1, 1};
+    int nSent = 0;
+
+    REQUIRE(win.submit([](bool) { throw std::runtime_error("send"); }));
+    REQUIRE(0 == win.in_flight());
+
+    // The slot it had isn't lost
+    REQUIRE(win.submit([&nSent](bool ok) { nSent += ok ? 1 : 0; }));
+    REQUIRE(1 == nSent);
+    REQUIRE(1 == win.in_flight());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("async_client adaptive inflight", "[inflight]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.get_inflight_window());
+
+    cli.start_adaptive_inflight(32, 2, 4);
+    auto win = cli.get_inflight_window();
+    REQUIRE(win);
+    REQUIRE(32 == win->get_max_window());
+    REQUIRE(2 == win->get_min_window());
+    REQUIRE(4 == win->get_window());
+
+    // QoS 0 isn't held, so the publish fails as usual while disconnected
+    REQUIRE_THROWS_AS(cli.publish(TOPIC, "hello", 5, 0, false), exception);
+    REQUIRE(0 == win->num_lost());
+
+    // A held QoS 1 message fails through its token, and gives back its slot
+    auto tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(tok->is_complete());
+    REQUIRE(MQTTASYNC_DISCONNECTED == tok->get_return_code());
+    REQUIRE(0 == win->in_flight());
+    REQUIRE(1 == win->num_lost());
+    REQUIRE(2 == win->get_window());
+    REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+
+    // A new window replaces the old one, which is stopped
+    cli.start_adaptive_inflight(8, 1, 1, 100);
+    REQUIRE(win->stopped());
+    REQUIRE(8 == cli.get_inflight_window()->get_max_window());
+    REQUIRE(100 == cli.get_inflight_window()->get_max_queue());
+
+    cli.stop_adaptive_inflight();
+    REQUIRE(!cli.get_inflight_window());
+    REQUIRE_THROWS_AS(cli.publish(TOPIC, "hello", 5, 1, false), exception);
+}
+
+// A windowed message gets the same fallbacks as one sent right away.
+
+TEST_CASE("async_client adaptive inflight retry", "[inflight]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    cli.start_adaptive_inflight(8, 1, 1);
+    auto win = cli.get_inflight_window();
+
+    cli.start_publish_retry(retry_policy{1ms, 5ms, 2});
+    auto rt = cli.get_publish_retrier();
+
+    // Each try takes a slot, and gives it back when the library refuses it
+    auto tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    for (int i = 0; i < 200 && !tok->is_complete(); ++i) std::this_thread::sleep_for(10ms);
+
+    REQUIRE(tok->is_complete());
+    REQUIRE(MQTTASYNC_DISCONNECTED == tok->get_return_code());
+    REQUIRE(2 == tok->get_retries());
+    REQUIRE(1 == rt->num_dead_lettered());
+    REQUIRE(3 == win->num_lost());
+    REQUIRE(0 == win->in_flight());
+
+    // A retry that waits doesn't hold a slot
+    cli.start_publish_retry(retry_policy{60s, 60s});
+    tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(!tok->is_complete());
+    REQUIRE(0 == win->in_flight());
+
+    cli.stop_publish_retry();
+    REQUIRE(tok->is_complete());
+}
+
+TEST_CASE("async_client adaptive inflight offline buffer", "[inflight]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    cli.start_adaptive_inflight(8, 1, 1);
+    auto win = cli.get_inflight_window();
+
+    // The limiter holds the second message until after buffering starts
+    cli.start_rate_limiting(10.0, 0.0, rate_limiter::QUEUE, 0.1);
+    auto lim = cli.get_rate_limiter();
+
+    auto tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    auto tok2 = cli.publish(TOPIC, "hello", 5, 1, false);
+    cli.start_offline_buffering();
+    auto buf = cli.get_offline_buffer();
+
+    for (int i = 0; i < 200 && (lim->queue_size() > 0 || buf->size() == 0); ++i)
+        std::this_thread::sleep_for(10ms);
+
+    // The library says it's disconnected, so the message is buffered
+    REQUIRE(!tok2->is_complete());
+    REQUIRE(buf->size() >= 1);
+    REQUIRE(0 == win->in_flight());
+
+    cli.stop_offline_buffering();
+    REQUIRE(tok2->is_complete());
+    REQUIRE(MQTTASYNC_OPERATION_INCOMPLETE == tok2->get_return_code());
+    (void)tok;
+}
@@ -0,0 +1,103 @@
+// test_json_payload.cpp
+//
+// Unit tests for the json_payload class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/json_payload.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string DOC{R"({"sensor":"temp-1","value":21.5,"tags":["a","b"]})"};
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("json_payload parse", "[json]")
+{
+    SECTION("copied")
+    {
+        json_payload json{binary_ref{DOC}};
+        REQUIRE(json.ok());
+        REQUIRE(std::string_view{"temp-1"} == std::string_view(json.root()["sensor"]));
+        REQUIRE(21.5 == double(json.root()["value"]));
+        REQUIRE(2 == simdjson::dom::array(json.root()["tags"]).size());
+    }
+
+    SECTION("in place")
+    {
+        binary buf;
+        buf.reserve(DOC.size() + simdjson::SIMDJSON_PADDING);
+        buf = DOC;
+        binary_ref payload{std::move(buf)};
+        REQUIRE(json_payload::has_padding(payload));
+
+        json_payload json{payload};
+        REQUIRE(json.parsed_in_place());
+        REQUIRE(21.5 == double(json.root()["value"]));
+    }
+
+    SECTION("invalid")
+    {
+        json_payload json{binary_ref{"{\"value\":"}};
+        REQUIRE(!json.ok());
+        REQUIRE(simdjson::SUCCESS != json.error());
+        REQUIRE_THROWS_AS(json.root(), simdjson::simdjson_error);
+
+        REQUIRE(!json_payload{binary_ref{}}.ok());
+    }
+}
+
+TEST_CASE("json_payload get_json", "[json]")
+{
+    auto msg = make_message("sensors/1", DOC);
+
+    auto json = get_json(*msg);
+    REQUIRE(json->ok());
+
+    // The handlers of the message share the parse
+    REQUIRE(json == get_json(*msg));
+
+    std::vector<json_payload_ptr> seen(4);
+    std::vector<std::thread> thrs;
+    for (size_t i = 0; i < seen.size(); ++i)
+        thrs.emplace_back([&seen, &msg, i] { seen[i] = get_json(*msg); });
+    for (auto& thr : thrs) thr.join();
+    for (const auto& p : seen) REQUIRE(json == p);
+
+    // Copies of the message share it too
+    message copy{*msg};
+    REQUIRE(json == get_json(copy));
+
+    // A new payload is parsed again
+    copy.set_payload(R"({"value":22})");
+    auto json2 = get_json(copy);
+    REQUIRE(json2 != json);
+    REQUIRE(22 == int64_t(json2->root()["value"]));
+    REQUIRE(21.5 == double(json->root()["value"]));
+}
@@ -0,0 +1,152 @@
+// test_last_value_cache.cpp
+//
+// Unit tests for the last_value_cache class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/last_value_cache.h"
+
+using namespace mqtt;
+
+namespace {
+
+const_message_ptr msg(const string& topic, const string& payload, bool retained = false) {
+    return make_message(topic, payload, 1, retained);
+}
+
+std::vector<string> topics(std::vector<const_message_ptr> msgs) {
+    std::vector<string> v;
+    for (const auto& m : msgs) v.push_back(m->get_topic());
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("last_value_cache get last", "[cache]")
+{
+    last_value_cache cache;
+    REQUIRE(cache.empty());
+    REQUIRE(!cache.get_last("a/b"));
+
+    auto m1 = msg("a/b", "one");
+    REQUIRE(cache.update(m1));
+    REQUIRE(m1 == cache.get_last("a/b"));
+
+    // The latest wins, and the message is shared, not copied
+    auto m2 = msg("a/b", "two");
+    REQUIRE(cache.update(m2));
+    REQUIRE(m2 == cache.get_last("a/b"));
+    REQUIRE(1 == cache.size());
+
+    REQUIRE(!cache.get_last("a"));
+    REQUIRE(!cache.update(const_message_ptr{}));
+}
+
+TEST_CASE("last_value_cache snapshot", "[cache]")
+{
+    last_value_cache cache;
+    for (auto t : {"a", "a/b", "a/c", "a/b/c", "x/b", "$SYS/b", "/b"})
+        cache.update(msg(t, "data"));
+
+    REQUIRE((std::vector<string>{"a/b"}) == topics(cache.snapshot("a/b")));
+    REQUIRE(topics(cache.snapshot("a/x")).empty());
+    REQUIRE((std::vector<string>{"a/b", "a/c"}) == topics(cache.snapshot("a/+")));
+    REQUIRE((std::vector<string>{"a", "a/b", "a/b/c", "a/c"}) == topics(cache.snapshot("a/#")));
+    REQUIRE((std::vector<string>{"/b", "a/b", "x/b"}) == topics(cache.snapshot("+/b")));
+    REQUIRE((std::vector<string>{"$SYS/b"}) == topics(cache.snapshot("$SYS/#")));
+
+    // Top-level wildcards skip the '$' topics
+    REQUIRE(6 == cache.snapshot("#").size());
+}
+
+TEST_CASE("last_value_cache clear retained", "[cache]")
+{
+    last_value_cache cache;
+    cache.update(msg("a/b", "data", true));
+    cache.update(msg("a/b/c", "data"));
+    REQUIRE(2 == cache.size());
+
+    // An empty retained message clears the topic
+    REQUIRE(cache.update(msg("a/b", "", true)));
+    REQUIRE(!cache.get_last("a/b"));
+    REQUIRE(1 == cache.size());
+    REQUIRE((std::vector<string>{"a/b/c"}) == topics(cache.snapshot("a/#")));
+
+    REQUIRE(cache.erase("a/b/c"));
+    REQUIRE(!cache.erase("a/b/c"));
+    REQUIRE(cache.empty());
+    REQUIRE(cache.snapshot("#").empty());
+
+    cache.update(msg("x", "data"));
+    cache.clear();
+    REQUIRE(cache.empty());
+    REQUIRE(cache.snapshot("#").empty());
+}
+
+TEST_CASE("last_value_cache limits", "[cache]")
+{
+    SECTION("max topics")
+    {
+        last_value_cache cache{2};
+        REQUIRE(2 == cache.get_max_topics());
+
+        REQUIRE(cache.update(msg("a", "1")));
+        REQUIRE(cache.update(msg("b", "1")));
+        REQUIRE(!cache.update(msg("c", "1")));
+        REQUIRE(!cache.get_last("c"));
+
+        // The topics that are held are still updated
+        auto m = msg("a", "2");
+        REQUIRE(cache.update(m));
+        REQUIRE(m == cache.get_last("a"));
+    }
+
+    SECTION("retained only")
+    {
+        last_value_cache cache{0, true};
+        REQUIRE(cache.is_retained_only());
+        REQUIRE(!cache.update(msg("a", "1")));
+        REQUIRE(cache.update(msg("a", "1", true)));
+        REQUIRE(1 == cache.size());
+    }
+}
+
+TEST_CASE("async_client last value cache", "[cache]")
+{
+    async_client cli{"tcp://localhost:1883", "test_last_value_cache"};
+    REQUIRE(!cli.get_last_value_cache());
+
+    auto cache = std::make_shared<last_value_cache>();
+    cli.set_last_value_cache(cache);
+    REQUIRE(cache == cli.get_last_value_cache());
+
+    cli.set_last_value_cache(last_value_cache_ptr{});
+    REQUIRE(!cli.get_last_value_cache());
+}
@@ -0,0 +1,219 @@
+// test_log_persistence.cpp
+//
+// Unit tests for the log_persistence class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/exception.h"
+#include "mqtt/log_persistence.h"
+
+using namespace mqtt;
+
+namespace fs = std::filesystem;
+
+static const std::string CLIENT_ID{"log_persist_test"};
+static const std::string SERVER_URI{"mqtt://localhost:1883"};
+
+// Creates a fresh, empty base directory for a test
+static std::string test_dir(const std::string& name)
+{
+    auto dir = (fs::temp_directory_path() / ("paho-log-persist-" + name)).string();
+    fs::remove_all(dir);
+    return dir;
+}
+
+// Puts a value made of one or more strings
+static void put(log_persistence& per, const std::string& key, const std::vector<std::string>& vals)
+{
+    std::vector<mqtt::string_view> bufs(vals.begin(), vals.end());
+    per.put(key, bufs);
+}
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("log_persistence put get remove", "[persistence]")
+{
+    auto dir = test_dir("basic");
+    log_persistence per{dir};
+
+    REQUIRE(per.get_directory().empty());
+    REQUIRE_THROWS_AS(put(per, "k", {"v"}), persistence_exception);
+
+    per.open(CLIENT_ID, SERVER_URI);
+    REQUIRE(!per.get_directory().empty());
+    REQUIRE(fs::is_directory(per.get_directory()));
+    REQUIRE(per.keys().empty());
+    REQUIRE(!per.contains_key("k1"));
+
+    put(per, "k1", {"hello ", "world"});
+    put(per, "k2", {"abc"});
+
+    REQUIRE(per.contains_key("k1"));
+    REQUIRE(per.get("k1") == "hello world");
+    REQUIRE(per.get("k2") == "abc");
+    REQUIRE(per.keys().size() == 2);
+
+    // Replace a value
+    put(per, "k2", {"xyz"});
+    REQUIRE(per.get("k2") == "xyz");
+    REQUIRE(per.keys().size() == 2);
+
+    per.remove("k1");
+    REQUIRE(!per.contains_key("k1"));
+    REQUIRE_THROWS_AS(per.get("k1"), persistence_exception);
+    REQUIRE_THROWS_AS(per.remove("k1"), persistence_exception);
+
+    per.clear();
+    REQUIRE(per.keys().empty());
+    REQUIRE(0 == per.live_bytes());
+
+    per.close();
+    fs::remove_all(dir);
+}
+
+TEST_CASE("log_persistence get_into", "[persistence]")
+{
+    auto dir = test_dir("get_into");
+    log_persistence per{dir};
+    per.open(CLIENT_ID, SERVER_URI);
+
+    put(per, "k", {"some ", "data"});
+
+    size_t len = 0;
+    char* buf = per.get_into("k", &len);
+    REQUIRE(buf != nullptr);
+    REQUIRE(std::string{buf, len} == "some data");
+    persistence_free(buf);
+
+    REQUIRE_THROWS_AS(per.get_into("none", &len), persistence_exception);
+
+    per.close();
+    fs::remove_all(dir);
+}
+
+TEST_CASE("log_persistence bulk restore", "[persistence]")
+{
+    auto dir = test_dir("bulk");
+    log_persistence per{dir};
+    per.open(CLIENT_ID, SERVER_URI);
+
+    // Enough data to be copied by more than one thread
+    constexpr size_t N = 40;
+    const std::string big(1024 * 1024, 'x');
+    for (size_t i = 0; i < N; ++i) put(per, "k" + std::to_string(i), {big, std::to_string(i)});
+    put(per, "empty", {""});
+
+    std::vector<std::string> keys;
+    per.for_each_key([&keys](const std::string& key) { keys.push_back(key); });
+    REQUIRE(N + 1 == keys.size());
+
+    keys.push_back("none");
+    auto vals = per.get_all(keys);
+    REQUIRE(keys.size() == vals.size());
+
+    for (size_t i = 0; i < N + 1; ++i) {
+        REQUIRE(vals[i].buf != nullptr);
+        REQUIRE(per.get(keys[i]) == std::string(vals[i].buf, vals[i].len));
+        persistence_free(vals[i].buf);
+    }
+    REQUIRE(vals[N + 1].buf == nullptr);
+
+    per.close();
+    fs::remove_all(dir);
+}
+
+TEST_CASE("log_persistence recover", "[persistence]")
+{
+    auto dir = test_dir("recover");
+
+    {
+        log_persistence per{dir};
+        per.open(CLIENT_ID, SERVER_URI);
+        put(per, "a", {"1"});
+        put(per, "b", {"2"});
+        put(per, "c", {"3"});
+        put(per, "b", {"22"});
+        per.remove("a");
+        per.close();
+    }
+
+    log_persistence per{dir};
+    per.open(CLIENT_ID, SERVER_URI);
+
+    REQUIRE(per.keys().size() == 2);
+    REQUIRE(!per.contains_key("a"));
+    REQUIRE(per.get("b") == "22");
+    REQUIRE(per.get("c") == "3");
+
+    per.close();
+    fs::remove_all(dir);
+}
+
+TEST_CASE("log_persistence segments", "[persistence]")
+{
+    auto dir = test_dir("segments");
+
+    // Use the smallest segments to roll over quickly
+    log_persistence per{dir, 1};
+    per.open(CLIENT_ID, SERVER_URI);
+
+    const std::string val(1000, 'x');
+
+    // Short-lived data lets old segments go away
+    for (int i = 0; i < 100; ++i) {
+        auto key = "k" + std::to_string(i);
+        put(per, key, {val});
+        per.remove(key);
+    }
+    REQUIRE(1 == per.num_segments());
+    REQUIRE(0 == per.live_bytes());
+
+    // A long-lived key keeps its segment until compacted
+    put(per, "keep", {"data"});
+    for (int i = 0; i < 20; ++i) {
+        auto key = "k" + std::to_string(i);
+        put(per, key, {val});
+        per.remove(key);
+    }
+    REQUIRE(per.num_segments() > 1);
+
+    per.compact();
+    REQUIRE(1 == per.num_segments());
+    REQUIRE(per.get("keep") == "data");
+
+    // A value bigger than a segment gets a segment of its own
+    const std::string big(20000, 'y');
+    put(per, "big", {big});
+    REQUIRE(per.get("big") == big);
+    per.close();
+
+    per.open(CLIENT_ID, SERVER_URI);
+    REQUIRE(per.keys().size() == 2);
+    REQUIRE(per.get("keep") == "data");
+    REQUIRE(per.get("big") == big);
+
+    per.close();
+    fs::remove_all(dir);
+}
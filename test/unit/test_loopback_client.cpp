@@ -0,0 +1,298 @@
+// test_loopback_client.cpp
+//
+// Unit tests for the loopback_broker and loopback_client classes in the
+// Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/loopback_client.h"
+
+using namespace mqtt;
+
+namespace {
+
+// A connected client with its consumer started
+loopback_client_ptr make_client(loopback_broker_ptr broker, const string& id) {
+    auto cli = std::make_shared<loopback_client>(broker, id);
+    cli->start_consuming();
+    cli->connect()->wait();
+    return cli;
+}
+
+class test_callback : public callback
+{
+public:
+    std::atomic<int> nConnected{0};
+    std::atomic<int> nArrived{0};
+    std::atomic<int> nDelivered{0};
+
+    void connected(const string&) override { ++nConnected; }
+    void message_arrived(const_message_ptr) override { ++nArrived; }
+    void delivery_complete(delivery_token_ptr) override { ++nDelivered; }
+};
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("loopback_client connect", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    loopback_client cli{broker, "cli"};
+
+    REQUIRE(!cli.is_connected());
+    REQUIRE("cli" == cli.get_client_id());
+    REQUIRE(string{loopback_broker::SERVER_URI} == cli.get_server_uri());
+    REQUIRE(broker == cli.get_broker());
+
+    // Requests need a connection
+    REQUIRE_THROWS_AS(cli.publish("a", "x", 1), exception);
+    REQUIRE_THROWS_AS(cli.subscribe("a", 1), exception);
+
+    auto tok = cli.connect();
+    tok->wait();
+    REQUIRE(cli.is_connected());
+    REQUIRE(token::Type::CONNECT == tok->get_type());
+    REQUIRE(MQTTVERSION_5 == tok->get_connect_response().get_mqtt_version());
+
+    cli.disconnect()->wait();
+    REQUIRE(!cli.is_connected());
+    REQUIRE_THROWS_AS(cli.disconnect(), exception);
+
+    REQUIRE_THROWS_AS(loopback_client(loopback_broker_ptr{}, "x"), std::invalid_argument);
+}
+
+TEST_CASE("loopback_client publish subscribe", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    auto sub = make_client(broker, "sub");
+    auto pub = make_client(broker, "pub");
+
+    // The connected event is skipped by consume_message()
+    auto subTok = sub->subscribe("a/#", 1);
+    subTok->wait();
+    auto codes = subTok->get_subscribe_response().get_reason_codes();
+    REQUIRE(1 == codes.size());
+    REQUIRE(ReasonCode::GRANTED_QOS_1 == codes[0]);
+
+    auto msg = make_message("a/b", "hello", 1, false);
+    auto tok = pub->publish(msg);
+    tok->wait();
+    REQUIRE(tok->get_message_id() > 0);
+    REQUIRE(msg == tok->get_message());
+
+    // The message is shared, not copied
+    auto rcv = sub->consume_message();
+    REQUIRE(msg == rcv);
+
+    // QoS 0 messages don't get an ID
+    tok = pub->publish("a/c", "x", 1);
+    tok->wait();
+    REQUIRE(0 == tok->get_message_id());
+    REQUIRE("a/c" == sub->consume_message()->get_topic());
+
+    // No match, no message
+    pub->publish("b/c", "x", 1)->wait();
+    const_message_ptr none;
+    REQUIRE(!sub->try_consume_message(&none));
+
+    sub->unsubscribe("a/#")->wait();
+    pub->publish("a/b", "x", 1)->wait();
+    REQUIRE(!sub->try_consume_message(&none));
+
+    auto unsubTok = sub->unsubscribe("a/#");
+    unsubTok->wait();
+    REQUIRE(
+        ReasonCode::NO_SUBSCRIPTION_FOUND ==
+        unsubTok->get_unsubscribe_response().get_reason_codes()[0]
+    );
+}
+
+TEST_CASE("loopback_client qos", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    auto sub = make_client(broker, "sub");
+    auto pub = make_client(broker, "pub");
+
+    SECTION("downgrade")
+    {
+        sub->subscribe("a", 0)->wait();
+
+        auto msg = make_message("a", "x", 2, false);
+        auto tok = pub->publish(msg);
+        tok->wait();
+
+        auto rcv = sub->consume_message();
+        REQUIRE(0 == rcv->get_qos());
+        REQUIRE(msg != rcv);
+        REQUIRE(2 == msg->get_qos());
+    }
+
+    SECTION("overlapping")
+    {
+        // One copy, at the highest QoS of the matches
+        sub->subscribe("a/+", 0)->wait();
+        sub->subscribe("a/#", 1)->wait();
+        sub->subscribe("a/b", 0)->wait();
+        sub->subscribe("z", 0)->wait();
+
+        // The last message marks the end, since they arrive in order
+        pub->publish(make_message("a/b", "x", 2, false))->wait();
+        pub->publish("z", "end", 3)->wait();
+
+        REQUIRE(1 == sub->consume_message()->get_qos());
+        REQUIRE("z" == sub->consume_message()->get_topic());
+    }
+}
+
+TEST_CASE("loopback_client many topics", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    auto cli = make_client(broker, "cli");
+
+    auto topics = std::make_shared<string_collection>(std::vector<string>{"a", "b", "c"});
+    auto tok = cli->subscribe(topics, {0, 1, 2});
+    tok->wait();
+
+    auto codes = tok->get_subscribe_response().get_reason_codes();
+    REQUIRE(3 == codes.size());
+    REQUIRE(ReasonCode::GRANTED_QOS_0 == codes[0]);
+    REQUIRE(ReasonCode::GRANTED_QOS_2 == codes[2]);
+
+    REQUIRE_THROWS_AS(cli->subscribe(topics, {0, 1}), std::invalid_argument);
+
+    // A client gets its own messages by default
+    cli->publish("b", "x", 1)->wait();
+    REQUIRE("b" == cli->consume_message()->get_topic());
+}
+
+TEST_CASE("loopback_client retained", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    auto pub = make_client(broker, "pub");
+
+    pub->publish(make_message("a/b", "one", 1, true))->wait();
+    pub->publish(make_message("a/c", "two", 1, true))->wait();
+    pub->publish(make_message("a/d", "three", 1, false))->wait();
+    REQUIRE(2 == broker->num_retained());
+
+    auto sub = make_client(broker, "sub");
+    sub->subscribe("a/b", 1)->wait();
+
+    auto rcv = sub->consume_message();
+    REQUIRE("a/b" == rcv->get_topic());
+    REQUIRE(rcv->is_retained());
+
+    // Live messages don't keep the flag, unless asked
+    pub->publish(make_message("a/b", "new", 1, true))->wait();
+    rcv = sub->consume_message();
+    REQUIRE("new" == rcv->get_payload_str());
+    REQUIRE(!rcv->is_retained());
+
+    // An empty retained message clears the topic
+    pub->publish(make_message("a/c", "", 1, true))->wait();
+    REQUIRE(1 == broker->num_retained());
+
+    sub->subscribe("a/c", 1)->wait();
+    pub->publish("a/c", "live", 4)->wait();
+    REQUIRE("live" == sub->consume_message()->get_payload_str());
+
+    // No retained messages on request
+    auto sub2 = make_client(broker, "sub2");
+    sub2->subscribe(
+            "a/#", 1, subscribe_options{false, true, subscribe_options::DONT_SEND_RETAINED}
+    )->wait();
+    pub->publish(make_message("a/b", "last", 1, true))->wait();
+
+    rcv = sub2->consume_message();
+    REQUIRE("last" == rcv->get_payload_str());
+    REQUIRE(rcv->is_retained());
+}
+
+TEST_CASE("loopback_client no local", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    auto cli = make_client(broker, "cli");
+    auto other = make_client(broker, "other");
+
+    cli->subscribe("a", 1, subscribe_options{true})->wait();
+
+    cli->publish("a", "mine", 4)->wait();
+    other->publish("a", "theirs", 6)->wait();
+    REQUIRE("theirs" == cli->consume_message()->get_payload_str());
+}
+
+TEST_CASE("loopback_client callbacks", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    test_callback cb;
+
+    loopback_client cli{broker, "cli"};
+    cli.set_callback(cb);
+    cli.connect()->wait();
+    cli.subscribe("a", 1)->wait();
+
+    for (int i = 0; i < 10; ++i) cli.publish(make_message("a", "x", 1, false));
+
+    // The jobs run in order on the client thread
+    cli.disconnect()->wait();
+    REQUIRE(1 == cb.nConnected);
+    REQUIRE(10 == cb.nArrived);
+    REQUIRE(10 == cb.nDelivered);
+    REQUIRE(cli.get_pending_delivery_tokens().empty());
+
+    // A message handler takes the place of message_arrived()
+    std::atomic<int> nHandled{0};
+    cli.set_message_callback([&nHandled](const_message_ptr) { ++nHandled; });
+    cli.connect()->wait();
+    cli.subscribe("a", 1)->wait();
+    cli.publish("a", "x", 1)->wait();
+    cli.disconnect()->wait();
+
+    REQUIRE(1 == nHandled);
+    REQUIRE(10 == cb.nArrived);
+}
+
+TEST_CASE("loopback_client disconnect drops subscriptions", "[loopback]")
+{
+    auto broker = loopback_broker::create();
+    auto pub = make_client(broker, "pub");
+
+    {
+        auto sub = make_client(broker, "sub");
+        sub->subscribe("a", 1)->wait();
+        sub->disconnect()->wait();
+        sub->connect()->wait();
+
+        pub->publish("a", "x", 1)->wait();
+        const_message_ptr msg;
+        REQUIRE(!sub->try_consume_message(&msg));
+
+        // Destroyed while subscribed
+        sub->subscribe("a", 1)->wait();
+    }
+
+    pub->publish("a", "x", 1)->wait();
+}
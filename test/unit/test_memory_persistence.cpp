@@ -0,0 +1,130 @@
+// test_memory_persistence.cpp
+//
+// Unit tests for the memory_persistence class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/exception.h"
+#include "mqtt/memory_persistence.h"
+
+using namespace mqtt;
+
+using mp = memory_persistence;
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("memory_persistence put get remove", "[persistence]")
+{
+    mp per;
+    REQUIRE(mp::DFLT_MAX_BYTES == per.get_max_bytes());
+    REQUIRE(mp::REJECT == per.get_policy());
+
+    per.open("clientid", "serveruri");
+    REQUIRE(0 == per.size());
+    REQUIRE(0 == per.memory_used());
+
+    std::string a{"hello "}, b{"world"};
+    per.put("k1", {a, b});
+    REQUIRE(per.contains_key("k1"));
+    REQUIRE(per.get("k1") == "hello world");
+    REQUIRE(1 == per.size());
+    REQUIRE(11 == per.data_bytes());
+    REQUIRE(mp::SLAB_SIZE + 2 + mp::ENTRY_OVERHEAD == per.memory_used());
+
+    size_t len = 0;
+    char* buf = per.get_into("k1", &len);
+    REQUIRE(std::string{buf, len} == "hello world");
+    persistence_free(buf);
+
+    // Replace
+    per.put("k1", {b});
+    REQUIRE(per.get("k1") == "world");
+    REQUIRE(1 == per.size());
+    REQUIRE(5 == per.data_bytes());
+
+    // A value bigger than the largest slot
+    std::string big(100000, 'x');
+    per.put("big", {big});
+    REQUIRE(per.get("big") == big);
+    REQUIRE(per.keys().size() == 2);
+
+    per.remove("k1");
+    REQUIRE(!per.contains_key("k1"));
+    REQUIRE_THROWS_AS(per.get("k1"), persistence_exception);
+    REQUIRE_THROWS_AS(per.remove("k1"), persistence_exception);
+
+    // The emptied slab is released
+    per.remove("big");
+    REQUIRE(0 == per.size());
+    REQUIRE(0 == per.memory_used());
+    REQUIRE(0 == per.data_bytes());
+}
+
+TEST_CASE("memory_persistence reject", "[persistence]")
+{
+    mp per{2 * mp::SLAB_SIZE};
+    std::string val(1000, 'x');
+
+    int i = 0;
+    try {
+        for (; i < 1000; ++i) per.put("k" + std::to_string(i), {val});
+    }
+    catch (const persistence_exception&) {
+    }
+
+    REQUIRE(i > 0);
+    REQUIRE(i < 1000);
+    REQUIRE(size_t(i) == per.size());
+    REQUIRE(1 == per.num_rejected());
+    REQUIRE(0 == per.num_evicted());
+    REQUIRE(per.memory_used() <= per.get_max_bytes());
+    REQUIRE(per.contains_key("k0"));
+}
+
+TEST_CASE("memory_persistence evict oldest", "[persistence]")
+{
+    mp per{2 * mp::SLAB_SIZE, mp::EVICT_OLDEST};
+    std::string val(1000, 'x');
+
+    for (int i = 0; i < 1000; ++i) {
+        per.put("k" + std::to_string(i), {val});
+        REQUIRE(per.memory_used() <= per.get_max_bytes());
+    }
+
+    REQUIRE(0 == per.num_rejected());
+    REQUIRE(per.num_evicted() > 0);
+    REQUIRE(per.size() + per.num_evicted() == 1000);
+    REQUIRE(!per.contains_key("k0"));
+    REQUIRE(per.contains_key("k999"));
+
+    // Something that can never fit is still rejected
+    std::string huge(4 * mp::SLAB_SIZE, 'y');
+    auto n = per.size();
+    REQUIRE_THROWS_AS(per.put("huge", {huge}), persistence_exception);
+    REQUIRE(1 == per.num_rejected());
+    REQUIRE(n == per.size());
+
+    per.clear();
+    REQUIRE(0 == per.size());
+    REQUIRE(0 == per.memory_used());
+}
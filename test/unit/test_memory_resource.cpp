@@ -0,0 +1,165 @@
+// test_memory_resource.cpp
+//
+// Unit tests for creating buffers and messages from a polymorphic memory
+// resource in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <cstring>
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+
+#if defined(PAHO_MQTTPP_HAS_PMR)
+
+using namespace mqtt;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// A resource that counts what it hands out, and gets it from the heap.
+
+class counting_resource : public std::pmr::memory_resource
+{
+    void* do_allocate(std::size_t n, std::size_t align) override {
+        ++nAlloc;
+        nOut += n;
+        return std::pmr::new_delete_resource()->allocate(n, align);
+    }
+    void do_deallocate(void* p, std::size_t n, std::size_t align) override {
+        ++nFree;
+        nOut -= n;
+        std::pmr::new_delete_resource()->deallocate(p, n, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    std::size_t nAlloc{0}, nFree{0}, nOut{0};
+};
+
+static const string LONG_TOPIC{"plant/building-one/line/seven/station/twelve/temperature"};
+static const string LONG_PAYLOAD(200, 'x');
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("buffer_ref from memory resource", "[pmr]")
+{
+    counting_resource res;
+    {
+        binary_ref br{&res, LONG_PAYLOAD.data(), LONG_PAYLOAD.size()};
+
+        REQUIRE(br.is_external());
+        REQUIRE(LONG_PAYLOAD.size() == br.size());
+        REQUIRE(0 == std::memcmp(LONG_PAYLOAD.data(), br.data(), br.size()));
+
+        // The buffer and its control block
+        REQUIRE(2 == res.nAlloc);
+
+        binary_ref br2{br};
+        REQUIRE(br2.data() == br.data());
+        REQUIRE(2 == res.nAlloc);
+    }
+    REQUIRE(2 == res.nFree);
+    REQUIRE(0 == res.nOut);
+
+    // Short data stays inline, and a null resource uses the heap
+    binary_ref br3{&res, "hello", 5};
+    REQUIRE(br3.is_inline());
+
+    binary_ref br4{nullptr, LONG_PAYLOAD.data(), LONG_PAYLOAD.size()};
+    REQUIRE_FALSE(br4.is_external());
+    REQUIRE(LONG_PAYLOAD == br4.str());
+
+    REQUIRE(2 == res.nAlloc);
+}
+
+TEST_CASE("message from memory resource", "[pmr]")
+{
+    counting_resource res;
+    {
+        auto msg = message::create(
+            &res, LONG_TOPIC, LONG_PAYLOAD.data(), LONG_PAYLOAD.size(), 1, false
+        );
+
+        REQUIRE(LONG_TOPIC == msg->get_topic());
+        REQUIRE(LONG_PAYLOAD == msg->get_payload_str());
+        REQUIRE(1 == msg->get_qos());
+
+        // The message block, and the payload with its control block
+        REQUIRE(3 == res.nAlloc);
+    }
+    REQUIRE(0 == res.nOut);
+
+    MQTTAsync_message cmsg = MQTTAsync_message_initializer;
+    cmsg.payload = const_cast<char*>(LONG_PAYLOAD.data());
+    cmsg.payloadlen = int(LONG_PAYLOAD.size());
+    cmsg.qos = 2;
+
+    {
+        string_ref topic{&res, LONG_TOPIC.data(), LONG_TOPIC.size()};
+        auto msg = message::create(&res, std::move(topic), cmsg);
+        REQUIRE(2 == msg->get_qos());
+        REQUIRE(LONG_PAYLOAD == msg->get_payload_str());
+
+        // Now the topic, too
+        REQUIRE(8 == res.nAlloc);
+    }
+    REQUIRE(0 == res.nOut);
+
+    // A null resource is the same as the regular create()
+    auto msg = message::create(nullptr, LONG_TOPIC, binary_ref{LONG_PAYLOAD}, 0, false);
+    REQUIRE(LONG_PAYLOAD == msg->get_payload_str());
+    REQUIRE(8 == res.nAlloc);
+}
+
+TEST_CASE("async_client incoming messages from memory resource", "[pmr]")
+{
+    counting_resource res;
+    async_client cli{"mqtt://localhost:1883", "pmr_test"};
+
+    REQUIRE(nullptr == cli.get_message_resource());
+    cli.set_message_resource(&res);
+    REQUIRE(&res == cli.get_message_resource());
+
+    cli.start_consuming();
+    cli.test_message_arrived(LONG_TOPIC, LONG_PAYLOAD.data(), LONG_PAYLOAD.size());
+
+    {
+        auto msg = cli.consume_message();
+        REQUIRE(msg);
+        REQUIRE(LONG_TOPIC == msg->get_topic());
+        REQUIRE(LONG_PAYLOAD == msg->get_payload_str());
+
+        // The message, and the topic and payload with their control blocks
+        REQUIRE(5 == res.nAlloc);
+    }
+    REQUIRE(0 == res.nOut);
+
+    cli.set_message_resource(nullptr);
+    cli.test_message_arrived(LONG_TOPIC, LONG_PAYLOAD.data(), LONG_PAYLOAD.size());
+    REQUIRE(cli.consume_message());
+    REQUIRE(5 == res.nAlloc);
+
+    cli.stop_consuming();
+}
+
+#endif  // PAHO_MQTTPP_HAS_PMR
@@ -0,0 +1,208 @@
+// test_memory_usage.cpp
+//
+// Unit tests for the memory accounting of the async_client in the Paho
+// MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/memory_usage.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string SERVER_URI{"tcp://localhost:1883"};
+const std::string BIG(1000, 'x');
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("memory_gauge", "[memory]")
+{
+    memory_gauge g;
+    REQUIRE(0 == g.bytes());
+    REQUIRE(0 == g.peak());
+
+    g.add(100);
+    g.add(50);
+    g.sub(120);
+    REQUIRE(30 == g.bytes());
+    REQUIRE(150 == g.peak());
+
+    g.add(10);
+    REQUIRE(150 == g.peak());
+}
+
+TEST_CASE("message memory_size", "[memory]")
+{
+    auto msg = make_message("a/b", BIG);
+    REQUIRE(msg->memory_size() >= sizeof(message) + 3 + BIG.size());
+
+    auto small = make_message("a/b", "x");
+    REQUIRE(msg->memory_size() - small->memory_size() == BIG.size() - 1);
+
+    properties props{{property::USER_PROPERTY, "key", "value"}};
+    auto withProps = make_message("a/b", "x");
+    withProps->set_properties(props);
+    REQUIRE(withProps->memory_size() > small->memory_size());
+}
+
+TEST_CASE("memory_usage default", "[memory]")
+{
+    memory_usage mu;
+    REQUIRE(0 == mu.total());
+    REQUIRE(0 == mu.bytes(memory_usage::CONSUMER_QUEUE));
+    REQUIRE(0 == mu.peak(memory_usage::DELIVERY_TOKENS));
+    REQUIRE(std::string{"offline_buffer"} == memory_usage::name(memory_usage::OFFLINE_BUFFER));
+
+    async_client cli{SERVER_URI, "test_memory_usage"};
+    REQUIRE(0 == cli.get_memory_usage().total());
+    REQUIRE(0 == cli.get_memory_limit());
+    REQUIRE(!cli.over_memory_limit());
+}
+
+TEST_CASE("memory_usage of delivery tokens", "[memory]")
+{
+    async_client cli{SERVER_URI, "test_memory_usage"};
+    cli.start_offline_buffering();
+
+    auto tok = cli.publish("a/b", BIG.data(), BIG.size(), 1, false);
+    auto tok2 = cli.publish("a/c", BIG.data(), BIG.size(), 1, false);
+
+    auto mu = cli.get_memory_usage();
+    auto n = mu.bytes(memory_usage::DELIVERY_TOKENS);
+    REQUIRE(n >= 2 * (sizeof(delivery_token) + BIG.size()));
+    REQUIRE(n == mu.peak(memory_usage::DELIVERY_TOKENS));
+
+    // The buffered messages are counted by the buffer too
+    REQUIRE(mu.bytes(memory_usage::OFFLINE_BUFFER) >= 2 * BIG.size());
+    REQUIRE(0 == mu.bytes(memory_usage::PENDING_TOKENS));
+
+    // Dropping them gives the memory back, but leaves the peaks
+    cli.stop_offline_buffering();
+    mu = cli.get_memory_usage();
+    REQUIRE(0 == mu.bytes(memory_usage::DELIVERY_TOKENS));
+    REQUIRE(n == mu.peak(memory_usage::DELIVERY_TOKENS));
+    REQUIRE(0 == mu.total());
+}
+
+TEST_CASE("memory_usage of the consumer queue", "[memory]")
+{
+    async_client cli{SERVER_URI, "test_memory_usage"};
+    cli.start_consuming();
+
+    cli.test_message_arrived("a/b", BIG.data(), BIG.size());
+    cli.test_message_arrived("a/c", BIG.data(), BIG.size());
+
+    auto mu = cli.get_memory_usage();
+    auto n = mu.bytes(memory_usage::CONSUMER_QUEUE);
+    REQUIRE(n >= 2 * BIG.size());
+
+    cli.consume_message();
+    cli.consume_message();
+
+    mu = cli.get_memory_usage();
+    REQUIRE(0 == mu.bytes(memory_usage::CONSUMER_QUEUE));
+    REQUIRE(n == mu.peak(memory_usage::CONSUMER_QUEUE));
+    cli.stop_consuming();
+}
+
+TEST_CASE("memory_usage of the last value cache", "[memory]")
+{
+    async_client cli{SERVER_URI, "test_memory_usage"};
+    cli.set_last_value_cache(std::make_shared<last_value_cache>());
+
+    cli.test_message_arrived("a/b", BIG.data(), BIG.size());
+    auto n = cli.get_memory_usage().bytes(memory_usage::LAST_VALUE_CACHE);
+    REQUIRE(n >= BIG.size());
+
+    // A new value on the topic replaces the old one
+    cli.test_message_arrived("a/b", "x", 1);
+    auto mu = cli.get_memory_usage();
+    REQUIRE(n - (BIG.size() - 1) == mu.bytes(memory_usage::LAST_VALUE_CACHE));
+    REQUIRE(n == mu.peak(memory_usage::LAST_VALUE_CACHE));
+
+    cli.get_last_value_cache()->clear();
+    REQUIRE(0 == cli.get_memory_usage().bytes(memory_usage::LAST_VALUE_CACHE));
+}
+
+TEST_CASE("memory limit", "[memory]")
+{
+    async_client cli{SERVER_URI, "test_memory_usage"};
+    cli.start_offline_buffering();
+
+    // Each publish counts for its token and its place in the buffer
+    cli.publish("a/b", BIG.data(), BIG.size(), 1, false);
+    auto lim = 2 * cli.get_memory_usage().total();
+
+    std::vector<size_t> calls;
+    cli.set_memory_limit(lim, [&calls](const memory_usage& mu) {
+        calls.push_back(mu.total());
+    });
+    REQUIRE(lim == cli.get_memory_limit());
+
+    cli.publish("a/c", BIG.data(), BIG.size(), 1, false);
+    REQUIRE(!cli.over_memory_limit());
+    REQUIRE(calls.empty());
+
+    // Going over calls the handler once
+    cli.publish("a/d", BIG.data(), BIG.size(), 1, false);
+    cli.publish("a/e", BIG.data(), BIG.size(), 1, false);
+    REQUIRE(cli.over_memory_limit());
+    REQUIRE(1 == calls.size());
+    REQUIRE(calls[0] > lim);
+
+    // Coming back under, then going over again, calls it again
+    cli.stop_offline_buffering();
+    cli.start_offline_buffering();
+    cli.publish("a/b", "x", 1, 1, false);
+    REQUIRE(!cli.over_memory_limit());
+
+    for (int i = 0; i < 3; ++i) cli.publish("a/b", BIG.data(), BIG.size(), 1, false);
+    REQUIRE(2 == calls.size());
+
+    cli.set_memory_limit(0);
+    REQUIRE(!cli.over_memory_limit());
+    cli.stop_offline_buffering();
+}
+
+TEST_CASE("memory limit holds incoming messages", "[memory]")
+{
+    async_client cli{SERVER_URI, "test_memory_usage"};
+    cli.start_consuming();
+    cli.set_memory_limit(BIG.size(), memory_limit_handler{}, true);
+
+    // The first message is taken, but puts the client over the limit
+    REQUIRE(cli.test_message_arrived("a/b", BIG.data(), BIG.size()));
+    REQUIRE(!cli.test_message_arrived("a/b", BIG.data(), BIG.size()));
+    REQUIRE(cli.over_memory_limit());
+
+    // Once the consumer catches up, messages are taken again
+    cli.consume_message();
+    REQUIRE(cli.test_message_arrived("a/b", "x", 1));
+    REQUIRE(!cli.over_memory_limit());
+    cli.stop_consuming();
+}
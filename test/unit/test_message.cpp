@@ -22,6 +22,7 @@
 #define UNIT_TESTS
 
 #include <cstring>
+#include <memory>
 
 #include "catch2_version.h"
 #include "mqtt/message.h"
@@ -200,6 +201,99 @@ TEST_CASE("c struct constructor", "[message]")
     REQUIRE(c_struct.dup != 0);
 }
 
+TEST_CASE("c struct external payload constructor", "[message]")
+{
+    MQTTAsync_message c_msg = MQTTAsync_message_initializer;
+
+    c_msg.payload = const_cast<char*>(BUF);
+    c_msg.payloadlen = int(N);
+    c_msg.qos = QOS;
+    c_msg.retained = 1;
+
+    mqtt::binary_ref payload{mqtt::binary_ref::external_pointer_type{BUF, [](const char*) {}}, N};
+    mqtt::message msg(TOPIC, payload, c_msg);
+
+    REQUIRE(TOPIC == msg.get_topic());
+    REQUIRE(QOS == msg.get_qos());
+    REQUIRE(msg.is_retained());
+
+    // The payload refers to the original buffer
+    REQUIRE(msg.get_payload_ref().is_external());
+    REQUIRE(BUF == msg.get_payload_ref().data());
+    REQUIRE(BUF == msg.c_struct().payload);
+    REQUIRE(PAYLOAD == msg.get_payload_str());
+
+    // As do copies
+    mqtt::message msg2(msg);
+    REQUIRE(BUF == msg2.get_payload_ref().data());
+}
+
+TEST_CASE("external payload publish message", "[message]")
+{
+    bool freed = false;
+    {
+        auto msg = mqtt::message::create(
+            TOPIC, mqtt::binary_ref{BUF, N, [&freed](const char*) { freed = true; }}, QOS, false
+        );
+
+        // The C message is sent straight from the caller's buffer
+        REQUIRE(BUF == msg->c_struct().payload);
+        REQUIRE(int(N) == msg->c_struct().payloadlen);
+        REQUIRE_FALSE(freed);
+    }
+    REQUIRE(freed);
+}
+
+TEST_CASE("adopted c struct constructor", "[message]")
+{
+    bool freed = false;
+    {
+        std::shared_ptr<MQTTAsync_message> c_msg{
+            new MQTTAsync_message(MQTTAsync_message_initializer),
+            [&freed](MQTTAsync_message* p) {
+                freed = true;
+                delete p;
+            }
+        };
+
+        c_msg->payload = const_cast<char*>(BUF);
+        c_msg->payloadlen = int(N);
+        c_msg->qos = QOS;
+        c_msg->properties = PROPS.c_struct();
+
+        auto msg = mqtt::message::create(TOPIC, c_msg);
+        c_msg.reset();
+
+        REQUIRE(TOPIC == msg->get_topic());
+        REQUIRE(QOS == msg->get_qos());
+
+        // Nothing is copied, so it can be sent on as-is
+        REQUIRE(msg->get_payload_ref().is_external());
+        REQUIRE(BUF == msg->get_payload_ref().data());
+        REQUIRE(BUF == msg->c_struct().payload);
+        REQUIRE(PROPS.c_struct().array == msg->c_struct().properties.array);
+
+        // Copies share the C message, too
+        mqtt::message msg2(*msg);
+        REQUIRE(BUF == msg2.c_struct().payload);
+        REQUIRE(PROPS.c_struct().array == msg2.c_struct().properties.array);
+
+        // The properties are converted when read
+        REQUIRE(1 == msg->get_properties().size());
+        REQUIRE(RESPONSE_TOPIC == get<string>(msg->get_properties(), property::RESPONSE_TOPIC));
+        REQUIRE(&msg->get_properties() == &msg2.get_properties());
+
+        // Replacing them leaves the C list behind
+        msg2.set_properties(properties{});
+        REQUIRE(msg2.get_properties().empty());
+        REQUIRE(0 == msg2.c_struct().properties.count);
+        REQUIRE(1 == msg->get_properties().size());
+
+        REQUIRE(!freed);
+    }
+    REQUIRE(freed);
+}
+
 // --------------------------------------------------------------------------
 // Test the copy constructor
 // --------------------------------------------------------------------------
@@ -421,3 +515,120 @@ TEST_CASE("builder", "[message]")
     REQUIRE(c_struct.retained != 0);
     REQUIRE(DFLT_DUP == (c_struct.dup != 0));
 }
+
+TEST_CASE("priority", "[message]")
+{
+    mqtt::message msg;
+    REQUIRE(mqtt::message::DFLT_PRIORITY == msg.get_priority());
+    REQUIRE(mqtt::message::PRIORITY_NORMAL == msg.get_priority());
+
+    msg.set_priority(mqtt::message::PRIORITY_HIGH);
+    REQUIRE(mqtt::message::PRIORITY_HIGH == msg.get_priority());
+
+    msg.set_priority(-3);
+    REQUIRE(0 == msg.get_priority());
+
+    msg.set_priority(mqtt::message::PRIORITY_LOW);
+    mqtt::message copy{msg};
+    REQUIRE(mqtt::message::PRIORITY_LOW == copy.get_priority());
+
+    mqtt::message moved{std::move(copy)};
+    REQUIRE(mqtt::message::PRIORITY_LOW == moved.get_priority());
+
+    auto pmsg = mqtt::message_ptr_builder()
+                    .topic(TOPIC)
+                    .priority(mqtt::message::PRIORITY_HIGH)
+                    .finalize();
+    REQUIRE(mqtt::message::PRIORITY_HIGH == pmsg->get_priority());
+}
+
+TEST_CASE("conflate", "[message]")
+{
+    mqtt::message msg;
+    REQUIRE(!msg.get_conflate());
+
+    msg.set_conflate(true);
+    REQUIRE(msg.get_conflate());
+
+    mqtt::message copy{msg};
+    REQUIRE(copy.get_conflate());
+
+    mqtt::message moved{std::move(copy)};
+    REQUIRE(moved.get_conflate());
+
+    auto pmsg = mqtt::message_ptr_builder().topic(TOPIC).conflate().finalize();
+    REQUIRE(pmsg->get_conflate());
+}
+
+TEST_CASE("expiry", "[message]")
+{
+    using mqtt::message;
+    auto now = message::clock::now();
+
+    // No interval, no expiry
+    message msg{TOPIC, PAYLOAD};
+    REQUIRE(0 == msg.get_expiry_interval());
+    msg.set_timestamp(now);
+    REQUIRE(now == msg.get_timestamp());
+    REQUIRE(message::time_point::max() == msg.get_expiry_time());
+    REQUIRE(!msg.is_expired());
+
+    // The interval doesn't start until there's a timestamp
+    msg.set_properties(mqtt::properties{{mqtt::property::MESSAGE_EXPIRY_INTERVAL, 10}});
+    REQUIRE(10 == msg.get_expiry_interval());
+    REQUIRE(now + std::chrono::seconds(10) == msg.get_expiry_time());
+    REQUIRE(!msg.is_expired(now + std::chrono::seconds(9)));
+    REQUIRE(msg.is_expired(now + std::chrono::seconds(10)));
+
+    message noStamp{TOPIC, PAYLOAD};
+    noStamp.set_properties(mqtt::properties{{mqtt::property::MESSAGE_EXPIRY_INTERVAL, 10}});
+    REQUIRE(message::time_point::max() == noStamp.get_expiry_time());
+
+    msg.set_timestamp(now - std::chrono::seconds(11));
+    REQUIRE(msg.is_expired());
+
+    // Copies keep the expiry
+    message copy{msg};
+    REQUIRE(copy.is_expired());
+    REQUIRE(msg.get_timestamp() == copy.get_timestamp());
+
+    // Read straight from an incoming C message
+    MQTTAsync_message cmsg = MQTTAsync_message_initializer;
+    mqtt::properties props{{mqtt::property::MESSAGE_EXPIRY_INTERVAL, 5}};
+    cmsg.properties = props.c_struct();
+    auto pmsg = message::create(TOPIC, cmsg);
+    REQUIRE(5 == pmsg->get_expiry_interval());
+}
+
+TEST_CASE("parsed payload", "[message]")
+{
+    message msg{TOPIC, PAYLOAD};
+    int nParse = 0;
+    auto parse_len = [&nParse](const binary_ref& payload) {
+        ++nParse;
+        return std::make_shared<const size_t>(payload.size());
+    };
+
+    auto len = msg.get_parsed_payload<size_t>(parse_len);
+    REQUIRE(PAYLOAD.size() == *len);
+    REQUIRE(len == msg.get_parsed_payload<size_t>(parse_len));
+    REQUIRE(1 == nParse);
+
+    // Copies share it
+    message copy{msg};
+    REQUIRE(len == copy.get_parsed_payload<size_t>(parse_len));
+    REQUIRE(1 == nParse);
+
+    // Another type replaces it
+    auto str = msg.get_parsed_payload<std::string>([](const binary_ref& payload) {
+        return std::make_shared<const std::string>(payload.to_string());
+    });
+    REQUIRE(PAYLOAD == *str);
+    msg.get_parsed_payload<size_t>(parse_len);
+    REQUIRE(2 == nParse);
+
+    // A new payload is parsed again
+    copy.set_payload("x");
+    REQUIRE(1 == *copy.get_parsed_payload<size_t>(parse_len));
+    REQUIRE(3 == nParse);
+}
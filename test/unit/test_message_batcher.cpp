@@ -0,0 +1,243 @@
+// test_message_batcher.cpp
+//
+// Unit tests for the message_batcher class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/message_batcher.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+namespace {
+
+const std::string SERVER_URI{"tcp://localhost:1883"};
+const std::string CLIENT_ID{"test_message_batcher"};
+const std::string TOPIC{"sensors/batch"};
+
+const std::string REC(20, 'r');
+
+message_ptr make_batch(const std::vector<binary_view>& recs, size_t count)
+{
+    properties props{
+        {property::USER_PROPERTY, message_batcher::BATCH_PROPERTY, std::to_string(count)}
+    };
+    return message::create(TOPIC, binary_ref(message_batcher::pack(recs)), 1, false, props);
+}
+
+// Waits for a count to reach a value, for up to a couple of seconds.
+template <class Func>
+bool wait_for(Func f, size_t n)
+{
+    for (int i = 0; i < 200 && f() < n; ++i) std::this_thread::sleep_for(10ms);
+    return f() >= n;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("message_batcher pack and unpack", "[batcher]")
+{
+    std::string big(300, 'b');
+    std::vector<std::string> strs{"one", "", big, "four"};
+    std::vector<binary_view> recs{strs.begin(), strs.end()};
+
+    auto batch = make_batch(recs, recs.size());
+    REQUIRE(message_batcher::is_batch(*batch));
+    REQUIRE(4 == message_batcher::batch_count(batch->get_properties()));
+
+    // One byte for each short length, and two for the long one
+    REQUIRE(3 + 0 + 300 + 4 + 5 == batch->get_payload().size());
+
+    auto msgs = message_batcher::unpack(batch);
+    REQUIRE(4 == msgs.size());
+    REQUIRE("one" == msgs[0]->get_payload_str());
+    REQUIRE(msgs[1]->get_payload().empty());
+    REQUIRE(big == msgs[2]->get_payload_str());
+    REQUIRE("four" == msgs[3]->get_payload_str());
+
+    for (const auto& msg : msgs) {
+        REQUIRE(TOPIC == msg->get_topic());
+        REQUIRE(1 == msg->get_qos());
+        REQUIRE(msg->get_properties().empty());
+    }
+
+    // The records point into the batch, and keep it alive
+    const auto& payload = batch->get_payload_ref();
+    auto p = msgs[2]->get_payload_ref().data();
+    REQUIRE(p >= payload.data());
+    REQUIRE(p + big.size() <= payload.data() + payload.size());
+
+    batch.reset();
+    REQUIRE(big == msgs[2]->get_payload_str());
+}
+
+TEST_CASE("message_batcher unpack rejects", "[batcher]")
+{
+    std::vector<std::string> strs{"one", "two"};
+    std::vector<binary_view> recs{strs.begin(), strs.end()};
+
+    SECTION("not a batch")
+    {
+        auto msg = make_message(TOPIC, message_batcher::pack(recs));
+        REQUIRE(!message_batcher::is_batch(*msg));
+        REQUIRE(message_batcher::unpack(msg).empty());
+        REQUIRE(message_batcher::unpack(const_message_ptr{}).empty());
+    }
+
+    SECTION("wrong count")
+    {
+        REQUIRE(message_batcher::unpack(make_batch(recs, 3)).empty());
+        REQUIRE(message_batcher::unpack(make_batch(recs, 1)).empty());
+    }
+
+    SECTION("truncated")
+    {
+        auto buf = message_batcher::pack(recs);
+        buf.pop_back();
+        properties props{{property::USER_PROPERTY, message_batcher::BATCH_PROPERTY, "2"}};
+        auto msg = message::create(TOPIC, binary_ref(std::move(buf)), 0, false, props);
+        REQUIRE(message_batcher::is_batch(*msg));
+        REQUIRE(message_batcher::unpack(msg).empty());
+    }
+}
+
+TEST_CASE("message_batcher flush by size", "[batcher]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    cli.start_offline_buffering();
+
+    // Each record is 21 bytes with its length, so three fit in 64
+    message_batcher batcher{cli, TOPIC, 10s, 64};
+    REQUIRE(TOPIC == batcher.get_topic());
+    REQUIRE(64 == batcher.get_max_bytes());
+    REQUIRE(0 == batcher.num_pending());
+
+    for (int i = 0; i < 3; ++i) batcher.add(REC);
+    REQUIRE(3 == batcher.num_pending());
+    REQUIRE(63 == batcher.pending_bytes());
+    REQUIRE(0 == batcher.num_batches());
+
+    // The next record doesn't fit, so the batch goes first
+    batcher.add(REC.data(), REC.size());
+    REQUIRE(1 == batcher.num_batches());
+    REQUIRE(1 == batcher.num_pending());
+    REQUIRE(1 == cli.get_metrics().num_pending_delivery_tokens());
+
+    auto tok = batcher.flush();
+    REQUIRE(tok);
+    REQUIRE(2 == batcher.num_batches());
+    REQUIRE(0 == batcher.num_pending());
+    REQUIRE(!batcher.flush());
+
+    auto msg = tok->get_message();
+    REQUIRE(TOPIC == msg->get_topic());
+    REQUIRE(0 == msg->get_qos());
+    auto msgs = message_batcher::unpack(msg);
+    REQUIRE(1 == msgs.size());
+    REQUIRE(REC == msgs[0]->get_payload_str());
+
+    cli.stop_offline_buffering();
+}
+
+TEST_CASE("message_batcher flush by time", "[batcher]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    cli.start_offline_buffering();
+
+    message_batcher batcher{cli, TOPIC, 20ms};
+    batcher.add(REC);
+    batcher.add(REC);
+
+    REQUIRE(wait_for([&batcher] { return batcher.num_batches(); }, 1));
+    REQUIRE(0 == batcher.num_pending());
+    REQUIRE(0 == batcher.num_failed());
+    REQUIRE(1 == cli.get_metrics().num_pending_delivery_tokens());
+
+    cli.stop_offline_buffering();
+
+    // While disconnected, without a buffer, the client refuses the batch
+    batcher.add(REC);
+    REQUIRE(wait_for([&batcher] { return batcher.num_failed(); }, 1));
+    REQUIRE(0 == batcher.num_pending());
+}
+
+TEST_CASE("async_client batch unpacking", "[batcher]")
+{
+    auto opts = create_options_builder()
+                    .server_uri(SERVER_URI)
+                    .client_id(CLIENT_ID)
+                    .mqtt_version(MQTTVERSION_5)
+                    .finalize();
+    async_client cli{opts};
+    cli.start_consuming();
+
+    std::vector<std::string> strs{"one", "two", "three"};
+    std::vector<binary_view> recs{strs.begin(), strs.end()};
+    auto batch = make_batch(recs, recs.size());
+
+    SECTION("off")
+    {
+        REQUIRE(!cli.get_batch_unpacking());
+        REQUIRE(cli.test_message_arrived(*batch));
+
+        const_message_ptr msg;
+        REQUIRE(cli.try_consume_message(&msg));
+        REQUIRE(message_batcher::is_batch(*msg));
+        REQUIRE(!cli.try_consume_message(&msg));
+    }
+
+    SECTION("on")
+    {
+        cli.set_batch_unpacking(true);
+        REQUIRE(cli.get_batch_unpacking());
+        REQUIRE(cli.test_message_arrived(*batch));
+
+        const_message_ptr msg;
+        for (const auto& rec : strs) {
+            REQUIRE(cli.try_consume_message(&msg));
+            REQUIRE(rec == msg->get_payload_str());
+            REQUIRE(TOPIC == msg->get_topic());
+            REQUIRE(1 == msg->get_qos());
+        }
+        REQUIRE(!cli.try_consume_message(&msg));
+    }
+
+    SECTION("damaged")
+    {
+        cli.set_batch_unpacking(true);
+        REQUIRE(cli.test_message_arrived(*make_batch(recs, 2)));
+
+        const_message_ptr msg;
+        REQUIRE(cli.try_consume_message(&msg));
+        REQUIRE(message_batcher::is_batch(*msg));
+        REQUIRE(!cli.try_consume_message(&msg));
+    }
+
+    cli.stop_consuming();
+}
@@ -0,0 +1,242 @@
+// test_message_capture.cpp
+//
+// Unit tests for the message_recorder and message_capture classes in the
+// Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/exception.h"
+#include "mqtt/message_capture.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+namespace fs = std::filesystem;
+
+// Gets the path for a fresh capture file for a test
+static std::string test_path(const std::string& name)
+{
+    auto path = (fs::temp_directory_path() / ("paho-capture-" + name + ".cap")).string();
+    fs::remove(path);
+    fs::remove(path + ".idx");
+    return path;
+}
+
+// A time some number of milliseconds after a fixed start
+static message_recorder::time_point at(int ms)
+{
+    return message_recorder::time_point{} + hours(24 * 365 * 50) + milliseconds(ms);
+}
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("message_capture round trip", "[capture]")
+{
+    auto path = test_path("basic");
+
+    properties props{
+        {property::CONTENT_TYPE, "text/plain"},
+        {property::MESSAGE_EXPIRY_INTERVAL, 42},
+        {property::USER_PROPERTY, "name", "value"},
+    };
+
+    {
+        message_recorder rec{path};
+        rec.record(message{"a/b", "hello", 5, 1, false, props}, at(0));
+        rec.record(message{"a/c", "", 0, 0, true}, at(10));
+        rec.record(message{"a/d", "world", 5, 2, false}, at(20));
+        REQUIRE(3 == rec.size());
+        REQUIRE(rec.bytes() > 0);
+    }
+
+    message_capture cap{path};
+    REQUIRE(3 == cap.size());
+
+    auto msg = cap.get(0);
+    REQUIRE("a/b" == msg->get_topic());
+    REQUIRE("hello" == msg->get_payload_str());
+    REQUIRE(1 == msg->get_qos());
+    REQUIRE(!msg->is_retained());
+
+    const auto& p = msg->get_properties();
+    REQUIRE(3 == p.size());
+    REQUIRE("text/plain" == get<string>(p, property::CONTENT_TYPE));
+    REQUIRE(42 == get<uint32_t>(p, property::MESSAGE_EXPIRY_INTERVAL));
+    auto kv = get<string_pair>(p, property::USER_PROPERTY);
+    REQUIRE("name" == std::get<0>(kv));
+    REQUIRE("value" == std::get<1>(kv));
+
+    msg = cap.get(1);
+    REQUIRE("a/c" == msg->get_topic());
+    REQUIRE(msg->get_payload().empty());
+    REQUIRE(msg->is_retained());
+    REQUIRE(msg->get_properties().empty());
+
+    REQUIRE(2 == cap.get(2)->get_qos());
+    REQUIRE_THROWS_AS(cap.get(3), std::out_of_range);
+
+    REQUIRE(at(10) == cap.get_time(1));
+    REQUIRE(0 == cap.find(at(0)));
+    REQUIRE(1 == cap.find(at(5)));
+    REQUIRE(2 == cap.find(at(20)));
+    REQUIRE(3 == cap.find(at(30)));
+}
+
+TEST_CASE("message_capture views", "[capture]")
+{
+    auto path = test_path("views");
+    {
+        message_recorder rec{path};
+        rec.record(message{"a/b", "payload", 7, 0, false});
+    }
+
+    const_message_ptr msg;
+    {
+        message_capture cap{path};
+        msg = cap.get(0);
+    }
+
+    // The message keeps the file mapped after the capture is gone
+    REQUIRE("a/b" == msg->get_topic());
+    REQUIRE("payload" == msg->get_payload_str());
+}
+
+TEST_CASE("message_capture windows", "[capture]")
+{
+    auto path = test_path("windows");
+
+    constexpr size_t N = 500;
+    const std::string big(10000, 'x');
+
+    {
+        // A window smaller than some of the records
+        message_recorder rec{path, 4096};
+        for (size_t i = 0; i < N; ++i) {
+            auto payload = (i % 50 == 0) ? big : std::to_string(i);
+            rec.record(message{"t/" + std::to_string(i), payload, 0, false}, at(int(i)));
+        }
+    }
+
+    message_capture cap{path};
+    REQUIRE(N == cap.size());
+    for (size_t i = 0; i < N; ++i) {
+        auto msg = cap.get(i);
+        REQUIRE("t/" + std::to_string(i) == msg->get_topic());
+        REQUIRE(((i % 50 == 0) ? big : std::to_string(i)) == msg->get_payload_str());
+    }
+}
+
+TEST_CASE("message_capture recover", "[capture]")
+{
+    auto path = test_path("recover");
+    {
+        message_recorder rec{path};
+        for (int i = 0; i < 10; ++i) rec.record(message{"t", std::to_string(i), 0, false});
+    }
+
+    SECTION("lost index")
+    {
+        fs::remove(path + ".idx");
+        message_capture cap{path};
+        REQUIRE(10 == cap.size());
+        REQUIRE("9" == cap.get(9)->get_payload_str());
+    }
+
+    SECTION("partial record")
+    {
+        // Cut the last record short, as if the app died writing it.
+        fs::resize_file(path, fs::file_size(path) - 4);
+        message_capture cap{path};
+        REQUIRE(9 == cap.size());
+        REQUIRE("8" == cap.get(8)->get_payload_str());
+    }
+
+    SECTION("not a capture")
+    {
+        fs::resize_file(path, 0);
+        REQUIRE_THROWS_AS(message_capture{path}, mqtt::exception);
+        REQUIRE_THROWS_AS(message_capture{path + ".none"}, mqtt::exception);
+    }
+}
+
+TEST_CASE("message_capture replay", "[capture]")
+{
+    auto path = test_path("replay");
+    {
+        message_recorder rec{path};
+        for (int i = 0; i < 5; ++i)
+            rec.record(message{"t", std::to_string(i), 0, false}, at(10 * i));
+    }
+
+    message_capture cap{path};
+    std::vector<std::string> got;
+    auto cb = [&got](const_message_ptr msg) { got.push_back(msg->get_payload_str()); };
+
+    SECTION("max speed")
+    {
+        REQUIRE(5 == cap.replay(cb, 0.0));
+        REQUIRE(5 == got.size());
+        REQUIRE("4" == got[4]);
+    }
+
+    SECTION("timed")
+    {
+        auto start = steady_clock::now();
+        REQUIRE(3 == cap.replay(cb, 2.0, 1, 4));
+        auto dt = steady_clock::now() - start;
+
+        REQUIRE(3 == got.size());
+        REQUIRE("1" == got[0]);
+        REQUIRE("3" == got[2]);
+
+        // Messages 1 to 3 arrived 20ms apart, replayed at double speed
+        REQUIRE(dt >= milliseconds(10));
+    }
+
+    SECTION("empty range") { REQUIRE(0 == cap.replay(cb, 1.0, 5)); }
+}
+
+TEST_CASE("message_capture as tracer", "[capture]")
+{
+    auto path = test_path("tracer");
+    const std::string PAYLOAD{"arrived"};
+
+    {
+        message_recorder rec{path};
+        async_client cli{"mqtt://localhost:1883", "capture_test"};
+        cli.start_consuming();
+        cli.set_message_tracer(rec);
+
+        cli.test_message_arrived("in/topic", PAYLOAD.data(), PAYLOAD.size());
+        cli.clear_message_tracer();
+        REQUIRE(1 == rec.size());
+    }
+
+    message_capture cap{path};
+    REQUIRE(1 == cap.size());
+    REQUIRE("in/topic" == cap.get(0)->get_topic());
+    REQUIRE(PAYLOAD == cap.get(0)->get_payload_str());
+}
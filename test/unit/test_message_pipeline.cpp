@@ -0,0 +1,158 @@
+// test_message_pipeline.cpp
+//
+// Unit tests for the message_pipeline class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/message_pipeline.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("message_pipeline in order", "[pipeline]")
+{
+    const int N = 500;
+    std::vector<int> out;
+
+    // The first stage stalls some of the messages, so they finish out of
+    // order.
+    auto pipe = message_pipeline_builder()
+                    .stage(
+                        "decode", 4,
+                        [](const_message_ptr msg) {
+                            auto n = std::stoi(msg->get_payload_str());
+                            if (n % 7 == 0)
+                                std::this_thread::sleep_for(microseconds(200));
+                            return make_message(msg->get_topic(), std::to_string(n * 2));
+                        }
+                    )
+                    .stage("enrich", 3, [](const_message_ptr msg) { return msg; })
+                    .sink([&out](const_message_ptr msg) {
+                        out.push_back(std::stoi(msg->get_payload_str()));
+                    })
+                    .buffer_size(16)
+                    .max_in_flight(64)
+                    .finalize();
+
+    REQUIRE(2 == pipe->num_stages());
+    REQUIRE(64 == pipe->get_max_in_flight());
+
+    for (int i = 0; i < N; ++i) REQUIRE(pipe->submit(make_message("a/b", std::to_string(i))));
+
+    pipe->stop();
+    REQUIRE(pipe->stopped());
+    REQUIRE(!pipe->submit(make_message("a/b", "x")));
+
+    REQUIRE(N == int(out.size()));
+    for (int i = 0; i < N; ++i) REQUIRE(2 * i == out[i]);
+
+    REQUIRE(uint64_t(N) == pipe->num_submitted());
+    REQUIRE(uint64_t(N) == pipe->num_delivered());
+    REQUIRE(0 == pipe->num_in_flight());
+    REQUIRE(0 == pipe->reorder_size());
+
+    auto metrics = pipe->get_metrics();
+    REQUIRE(2 == metrics.size());
+    REQUIRE("decode" == metrics[0].name);
+    REQUIRE(4 == metrics[0].nThreads);
+    REQUIRE(uint64_t(N) == metrics[0].processed);
+    REQUIRE(0 == metrics[0].dropped);
+    REQUIRE(metrics[0].busyTime > nanoseconds{0});
+    REQUIRE("enrich" == metrics[1].name);
+    REQUIRE(uint64_t(N) == metrics[1].processed);
+}
+
+TEST_CASE("message_pipeline drops", "[pipeline]")
+{
+    const int N = 100;
+    std::vector<int> out;
+
+    auto pipe = message_pipeline_builder()
+                    .stage(
+                        "filter", 2,
+                        [](const_message_ptr msg) -> const_message_ptr {
+                            auto n = std::stoi(msg->get_payload_str());
+                            if (n % 3 == 0)
+                                return {};
+                            if (n % 5 == 0)
+                                throw std::runtime_error("bad");
+                            return msg;
+                        }
+                    )
+                    .sink([&out](const_message_ptr msg) {
+                        out.push_back(std::stoi(msg->get_payload_str()));
+                    })
+                    .finalize();
+
+    for (int i = 0; i < N; ++i) pipe->submit(make_message("a/b", std::to_string(i)));
+    pipe->stop();
+
+    // The gaps are skipped, and the rest are still in order
+    std::vector<int> expected;
+    uint64_t nErrors = 0;
+    for (int i = 0; i < N; ++i) {
+        if (i % 3 != 0 && i % 5 != 0)
+            expected.push_back(i);
+        else if (i % 3 != 0)
+            ++nErrors;
+    }
+    REQUIRE(expected == out);
+
+    auto metrics = pipe->get_metrics();
+    REQUIRE(uint64_t(N) == metrics[0].processed);
+    REQUIRE(uint64_t(N - expected.size()) == metrics[0].dropped);
+    REQUIRE(nErrors == metrics[0].errors);
+    REQUIRE(expected.size() == pipe->num_delivered());
+}
+
+TEST_CASE("message_pipeline bounded", "[pipeline]")
+{
+    std::mutex lock;
+    lock.lock();
+
+    // The sink is held up, so the pipeline fills
+    auto pipe = message_pipeline_builder()
+                    .sink([&lock](const_message_ptr) { std::lock_guard<std::mutex> g{lock}; })
+                    .max_in_flight(4)
+                    .finalize();
+
+    REQUIRE(0 == pipe->num_stages());
+    for (int i = 0; i < 4; ++i) pipe->submit(make_message("a/b", "x"));
+    REQUIRE(4 == pipe->num_in_flight());
+
+    std::thread thr{[&pipe] { pipe->submit(make_message("a/b", "y")); }};
+    std::this_thread::sleep_for(milliseconds(20));
+    REQUIRE(4 == pipe->num_submitted());
+
+    lock.unlock();
+    thr.join();
+    pipe->stop();
+    REQUIRE(5 == pipe->num_delivered());
+}
@@ -0,0 +1,94 @@
+// test_message_tracer.cpp
+//
+// Unit tests for the message_tracer class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/message_tracer.h"
+
+using namespace mqtt;
+
+static const std::string SERVER_URI{"tcp://localhost:1883"};
+static const std::string CLIENT_ID{"test_message_tracer"};
+static const std::string TRACE_CTX{"00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"};
+
+// A tracer that records the calls made to it.
+class test_tracer : public message_tracer
+{
+public:
+    std::vector<string> calls;
+    int rc = 0;
+
+    string publish_begin(const message&, time_point) override {
+        calls.push_back("publish_begin");
+        return TRACE_CTX;
+    }
+    void message_sent(const delivery_token& tok, int rc, time_point) override {
+        calls.push_back("message_sent");
+        this->rc = rc;
+        REQUIRE(TRACE_CTX == tok.get_trace_context());
+        REQUIRE(TRACE_CTX == get_trace_context(tok.get_message()->get_properties()));
+    }
+};
+
+TEST_CASE("message_tracer get_trace_context", "[tracer]")
+{
+    properties props;
+    REQUIRE(message_tracer::get_trace_context(props).empty());
+
+    props.add({property::USER_PROPERTY, "other", "value"});
+    REQUIRE(message_tracer::get_trace_context(props).empty());
+
+    props.add({property::USER_PROPERTY, message_tracer::TRACE_PROPERTY, TRACE_CTX});
+    REQUIRE(TRACE_CTX == message_tracer::get_trace_context(props));
+}
+
+TEST_CASE("async_client message tracer", "[tracer]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID, create_options{MQTTVERSION_5}, nullptr};
+    REQUIRE(nullptr == cli.get_message_tracer());
+
+    test_tracer tr;
+    cli.set_message_tracer(tr);
+    REQUIRE(&tr == cli.get_message_tracer());
+
+    auto msg = message::create("trace/topic", "hello", 1, false);
+
+    // Not connected, so the library refuses the message
+    REQUIRE_THROWS_AS(cli.publish(msg), exception);
+
+    REQUIRE(2 == tr.calls.size());
+    REQUIRE("publish_begin" == tr.calls[0]);
+    REQUIRE("message_sent" == tr.calls[1]);
+    REQUIRE(MQTTASYNC_SUCCESS != tr.rc);
+
+    // The app's message is left alone
+    REQUIRE(message_tracer::get_trace_context(msg->get_properties()).empty());
+
+    cli.clear_message_tracer();
+    REQUIRE(nullptr == cli.get_message_tracer());
+
+    REQUIRE_THROWS_AS(cli.publish(msg), exception);
+    REQUIRE(2 == tr.calls.size());
+}
@@ -0,0 +1,307 @@
+// test_offline_buffer.cpp
+//
+// Unit tests for the offline_buffer class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/offline_buffer.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+namespace {
+
+// Records what happens to the operations of the buffered messages
+struct recorder
+{
+    std::mutex lock;
+    std::condition_variable cond;
+    std::vector<string> sent;
+    std::vector<string> dropped;
+    bool connected{true};
+    bool drained{false};
+
+    offline_buffer::task_type task(const string& name) {
+        return [this, name](bool send) {
+            std::lock_guard<std::mutex> g{lock};
+            if (send && !connected)
+                return false;
+            (send ? sent : dropped).push_back(name);
+            cond.notify_all();
+            return true;
+        };
+    }
+
+    void on_drained() {
+        std::lock_guard<std::mutex> g{lock};
+        drained = true;
+        cond.notify_all();
+    }
+
+    bool wait_drained() {
+        std::unique_lock<std::mutex> g{lock};
+        return cond.wait_for(g, seconds(5), [this] { return drained; });
+    }
+};
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("offline_buffer ctor", "[offline_buffer]")
+{
+    offline_buffer buf{100, 4096, 50.0};
+
+    REQUIRE(100 == buf.get_max_messages());
+    REQUIRE(4096 == buf.get_max_bytes());
+    REQUIRE(50.0 == buf.get_drain_rate());
+    REQUIRE(buf.empty());
+    REQUIRE(0 == buf.size());
+    REQUIRE(0 == buf.num_bytes());
+    REQUIRE(!buf.is_draining());
+    REQUIRE(!buf.stopped());
+
+    buf.set_drain_rate(-1.0);
+    REQUIRE(0.0 == buf.get_drain_rate());
+}
+
+TEST_CASE("offline_buffer limits", "[offline_buffer]")
+{
+    recorder rec;
+
+    offline_buffer buf{2, 0};
+    REQUIRE(buf.add(message::create("a", "12345"), rec.task("a")));
+    REQUIRE(buf.add(message::create("b", "123"), rec.task("b")));
+    REQUIRE(!buf.add(message::create("c", "1"), rec.task("c")));
+    REQUIRE(2 == buf.size());
+    REQUIRE(8 == buf.num_bytes());
+
+    offline_buffer bbuf{0, 8};
+    REQUIRE(bbuf.add(message::create("a", "12345"), rec.task("a")));
+    REQUIRE(!bbuf.add(message::create("b", "1234"), rec.task("b")));
+    REQUIRE(bbuf.add(message::create("c", "123"), rec.task("c")));
+    REQUIRE(8 == bbuf.num_bytes());
+}
+
+TEST_CASE("offline_buffer remove_if", "[offline_buffer]")
+{
+    recorder rec;
+    offline_buffer buf;
+
+    buf.add(message::create("keep/1", "abc"), rec.task("keep/1"));
+    buf.add(message::create("drop/1", "abcd"), rec.task("drop/1"));
+    buf.add(message::create("keep/2", "ab"), rec.task("keep/2"));
+
+    auto n = buf.remove_if([](const message& msg) { return msg.get_topic() == "drop/1"; });
+
+    REQUIRE(1 == n);
+    REQUIRE(2 == buf.size());
+    REQUIRE(5 == buf.num_bytes());
+    REQUIRE(rec.dropped == std::vector<string>{"drop/1"});
+    REQUIRE(rec.sent.empty());
+}
+
+TEST_CASE("offline_buffer drain", "[offline_buffer]")
+{
+    recorder rec;
+    offline_buffer buf;
+    buf.set_drained_handler([&rec] { rec.on_drained(); });
+
+    // Nothing to drain
+    buf.start_drain();
+    REQUIRE(!buf.is_draining());
+
+    buf.add(message::create("a", "1"), rec.task("a"));
+    buf.add(message::create("b", "2"), rec.task("b"));
+    buf.add(message::create("c", "3"), rec.task("c"));
+
+    buf.start_drain();
+    REQUIRE(rec.wait_drained());
+
+    REQUIRE(buf.empty());
+    REQUIRE(0 == buf.num_bytes());
+    REQUIRE(!buf.is_draining());
+    REQUIRE(rec.sent == std::vector<string>{"a", "b", "c"});
+}
+
+TEST_CASE("offline_buffer expired", "[offline_buffer]")
+{
+    recorder rec;
+    offline_buffer buf;
+    buf.set_drained_handler([&rec] { rec.on_drained(); });
+
+    std::vector<string> expired;
+    buf.set_expired_handler([&expired](const message& msg) {
+        expired.push_back(msg.get_topic());
+    });
+
+    properties props{{property::MESSAGE_EXPIRY_INTERVAL, 1}};
+    buf.add(message::create("a", "1", 1, false, props), rec.task("a"));
+    buf.add(message::create("b", "2"), rec.task("b"));
+
+    // The interval runs out while the messages wait
+    std::this_thread::sleep_for(milliseconds(1100));
+
+    buf.start_drain();
+    REQUIRE(rec.wait_drained());
+
+    REQUIRE(buf.empty());
+    REQUIRE(0 == buf.num_bytes());
+    REQUIRE(1 == buf.num_expired());
+    REQUIRE(expired == std::vector<string>{"a"});
+    REQUIRE(rec.dropped == std::vector<string>{"a"});
+    REQUIRE(rec.sent == std::vector<string>{"b"});
+}
+
+TEST_CASE("offline_buffer drain disconnected", "[offline_buffer]")
+{
+    recorder rec;
+    rec.connected = false;
+
+    offline_buffer buf;
+    buf.add(message::create("a", "1"), rec.task("a"));
+    buf.add(message::create("b", "2"), rec.task("b"));
+
+    // The message that couldn't go is put back, and the drain stops
+    buf.start_drain();
+    auto start = steady_clock::now();
+    while (buf.is_draining() && steady_clock::now() - start < seconds(5))
+        std::this_thread::sleep_for(milliseconds(1));
+
+    REQUIRE(!buf.is_draining());
+    REQUIRE(2 == buf.size());
+    REQUIRE(2 == buf.num_bytes());
+    REQUIRE(rec.sent.empty());
+
+    buf.set_drained_handler([&rec] { rec.on_drained(); });
+    {
+        std::lock_guard<std::mutex> g{rec.lock};
+        rec.connected = true;
+    }
+    buf.start_drain();
+    REQUIRE(rec.wait_drained());
+    REQUIRE(rec.sent == std::vector<string>{"a", "b"});
+}
+
+TEST_CASE("offline_buffer drain by priority", "[offline_buffer]")
+{
+    recorder rec;
+    offline_buffer buf;
+    buf.set_drained_handler([&rec] { rec.on_drained(); });
+
+    auto bulk = [](const string& topic) {
+        return message_ptr_builder().topic(topic).priority(message::PRIORITY_LOW).finalize();
+    };
+    auto alarm = message_ptr_builder().topic("alarm").priority(message::PRIORITY_HIGH).finalize();
+
+    buf.add(bulk("bulk1"), rec.task("bulk1"));
+    buf.add(bulk("bulk2"), rec.task("bulk2"));
+    buf.add(alarm, rec.task("alarm"));
+
+    buf.start_drain();
+    REQUIRE(rec.wait_drained());
+    REQUIRE(rec.sent == std::vector<string>{"alarm", "bulk1", "bulk2"});
+}
+
+TEST_CASE("offline_buffer conflate", "[offline_buffer]")
+{
+    recorder rec;
+    offline_buffer buf{3, 0};
+    buf.set_drained_handler([&rec] { rec.on_drained(); });
+
+    auto state = [](const string& topic, const string& val) {
+        return message_ptr_builder().topic(topic).payload(val).conflate().finalize();
+    };
+
+    REQUIRE(buf.add(state("state/1", "a"), rec.task("s1a")));
+    REQUIRE(buf.add(message::create("event", "x"), rec.task("ev1")));
+    REQUIRE(buf.add(state("state/2", "b"), rec.task("s2b")));
+
+    // Newer values replace the held ones, even when the buffer is full
+    REQUIRE(buf.add(state("state/1", "ccc"), rec.task("s1c")));
+    REQUIRE(buf.add(state("state/1", "dd"), rec.task("s1d")));
+    REQUIRE(!buf.add(message::create("event", "y"), rec.task("ev2")));
+
+    REQUIRE(3 == buf.size());
+    REQUIRE(4 == buf.num_bytes());
+    REQUIRE(2 == buf.num_conflated());
+    REQUIRE(rec.dropped == std::vector<string>{"s1a", "s1c"});
+
+    // The latest value goes out in the place of the first
+    buf.start_drain();
+    REQUIRE(rec.wait_drained());
+    REQUIRE(rec.sent == std::vector<string>{"s1d", "ev1", "s2b"});
+    REQUIRE(0 == buf.num_bytes());
+
+    // Once sent, the topic starts over
+    REQUIRE(buf.add(state("state/1", "e"), rec.task("s1e")));
+    REQUIRE(1 == buf.size());
+
+    SECTION("remove_if")
+    {
+        auto n = buf.remove_if([](const message& msg) { return msg.get_topic() == "state/1"; });
+        REQUIRE(1 == n);
+        REQUIRE(buf.empty());
+        REQUIRE(buf.add(state("state/1", "f"), rec.task("s1f")));
+        REQUIRE(2 == buf.num_conflated());
+    }
+}
+
+TEST_CASE("offline_buffer paced drain", "[offline_buffer]")
+{
+    recorder rec;
+    offline_buffer buf{0, 0, 100.0};
+    buf.set_drained_handler([&rec] { rec.on_drained(); });
+
+    for (int i = 0; i < 6; ++i) {
+        auto name = std::to_string(i);
+        buf.add(message::create(name, name), rec.task(name));
+    }
+
+    // Six messages at 100/sec need at least 50ms
+    auto start = steady_clock::now();
+    buf.start_drain();
+    REQUIRE(rec.wait_drained());
+    REQUIRE(steady_clock::now() - start >= milliseconds(45));
+    REQUIRE(6 == rec.sent.size());
+}
+
+TEST_CASE("offline_buffer stop", "[offline_buffer]")
+{
+    recorder rec;
+    offline_buffer buf;
+
+    buf.add(message::create("a", "1"), rec.task("a"));
+    buf.add(message::create("b", "2"), rec.task("b"));
+
+    buf.stop();
+    REQUIRE(buf.stopped());
+    REQUIRE(buf.empty());
+    REQUIRE(rec.dropped == std::vector<string>{"a", "b"});
+    REQUIRE(!buf.add(message::create("c", "3"), rec.task("c")));
+}
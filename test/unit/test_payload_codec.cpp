@@ -0,0 +1,200 @@
+// test_payload_codec.cpp
+//
+// Unit tests for the payload_codec interface in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <memory>
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/message_tracer.h"
+#include "mqtt/payload_codec.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string SERVER_URI{"tcp://localhost:1883"};
+const std::string CLIENT_ID{"test_payload_codec"};
+const std::string TOPIC{"test/codec"};
+
+// A simple run-length codec, as (count, byte) pairs
+class rle_codec : public payload_codec
+{
+public:
+    string name() const override { return "rle"; }
+
+    binary encode(const binary& data) const override {
+        binary enc;
+        for (size_t i = 0; i < data.size();) {
+            size_t n = 1;
+            while (i + n < data.size() && data[i + n] == data[i] && n < 255) ++n;
+            enc.push_back(char(n));
+            enc.push_back(data[i]);
+            i += n;
+        }
+        return enc;
+    }
+
+    binary decode(const binary& data) const override {
+        if (data.size() % 2 != 0)
+            throw exception(MQTTASYNC_FAILURE, "Bad run-length data");
+        binary dec;
+        for (size_t i = 0; i < data.size(); i += 2)
+            dec.append(size_t((unsigned char)data[i]), data[i + 1]);
+        return dec;
+    }
+};
+
+// A tracer that keeps the last message handed to the library
+class send_tracer : public message_tracer
+{
+public:
+    const_message_ptr sent;
+
+    void message_sent(const delivery_token& tok, int, time_point) override {
+        sent = tok.get_message();
+    }
+};
+
+async_client_ptr make_client(int mqttVersion) {
+    auto opts = create_options_builder()
+                    .server_uri(SERVER_URI)
+                    .client_id(CLIENT_ID)
+                    .mqtt_version(mqttVersion)
+                    .finalize();
+    return std::make_shared<async_client>(opts);
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("payload_codec get encoding", "[codec]")
+{
+    properties props;
+    REQUIRE(payload_codec::get_encoding(props).empty());
+
+    props.add({property::USER_PROPERTY, "other", "value"});
+    REQUIRE(payload_codec::get_encoding(props).empty());
+
+    props.add({property::USER_PROPERTY, payload_codec::ENCODING_PROPERTY, "rle"});
+    REQUIRE("rle" == payload_codec::get_encoding(props));
+}
+
+TEST_CASE("async_client set payload codec", "[codec]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    REQUIRE(!cli.get_payload_codec());
+
+    auto codec = std::make_shared<rle_codec>();
+    cli.set_payload_codec(codec, 16);
+    REQUIRE(codec == cli.get_payload_codec());
+
+    cli.clear_payload_codec();
+    REQUIRE(!cli.get_payload_codec());
+}
+
+// The payloads are encoded as they're handed to the library, which is
+// what the tracer sees, even though the library then refuses them, since
+// the client isn't connected.
+
+TEST_CASE("async_client encodes payloads", "[codec]")
+{
+    auto cli = make_client(MQTTVERSION_5);
+    send_tracer tr;
+    cli->set_message_tracer(tr);
+    cli->set_payload_codec(std::make_shared<rle_codec>(), 8);
+
+    const binary LONG(64, 'x');
+
+    SECTION("a payload that shrinks is encoded")
+    {
+        auto msg = make_message(TOPIC, LONG, 1, false);
+        REQUIRE(!cli->try_publish(msg));
+
+        auto sent = tr.sent;
+        REQUIRE(sent);
+        REQUIRE(2 == sent->get_payload().size());
+        REQUIRE("rle" == payload_codec::get_encoding(sent->get_properties()));
+        REQUIRE(LONG == rle_codec().decode(sent->get_payload()));
+
+        // The app's message is untouched
+        REQUIRE(LONG == msg->get_payload());
+        REQUIRE(msg->get_properties().empty());
+    }
+
+    SECTION("a small payload is not encoded")
+    {
+        REQUIRE(!cli->try_publish(TOPIC, "xxxx", 4, 1, false));
+        auto sent = tr.sent;
+        REQUIRE("xxxx" == sent->get_payload_str());
+        REQUIRE(sent->get_properties().empty());
+    }
+
+    SECTION("a payload that doesn't shrink is not encoded")
+    {
+        const binary MIXED{"abcdefghijklmnop"};
+        REQUIRE(!cli->try_publish(TOPIC, MIXED, 1, false));
+        auto sent = tr.sent;
+        REQUIRE(MIXED == sent->get_payload());
+        REQUIRE(sent->get_properties().empty());
+    }
+
+    SECTION("an encoded payload is not encoded again")
+    {
+        properties props{{property::USER_PROPERTY, payload_codec::ENCODING_PROPERTY, "other"}};
+        auto msg = message_ptr_builder()
+                       .topic(TOPIC)
+                       .payload(LONG)
+                       .qos(1)
+                       .properties(props)
+                       .finalize();
+        REQUIRE(!cli->try_publish(msg));
+        REQUIRE(LONG == tr.sent->get_payload());
+    }
+
+    SECTION("a held message is encoded when it's sent")
+    {
+        cli->start_offline_buffering();
+        auto tok = cli->publish(TOPIC, LONG, 1, false);
+        REQUIRE(!tr.sent);
+        REQUIRE(LONG == tok->get_message()->get_payload());
+        cli->stop_offline_buffering();
+    }
+
+    cli->clear_message_tracer();
+}
+
+TEST_CASE("async_client doesn't encode v3 payloads", "[codec]")
+{
+    auto cli = make_client(MQTTVERSION_3_1_1);
+    send_tracer tr;
+    cli->set_message_tracer(tr);
+    cli->set_payload_codec(std::make_shared<rle_codec>());
+
+    const binary LONG(64, 'x');
+    REQUIRE(!cli->try_publish(TOPIC, LONG, 1, false));
+    REQUIRE(LONG == tr.sent->get_payload());
+
+    cli->clear_message_tracer();
+}
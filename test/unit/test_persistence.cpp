@@ -306,3 +306,65 @@ TEST_CASE("persistence", "[persistence]")
     dcp::persistence_clear(handle_);
     dcp::persistence_close(handle_);
 }
+
+// ----------------------------------------------------------------------
+// Test that listing the keys reads the values in bulk, to be handed out
+// as the library restores them.
+// ----------------------------------------------------------------------
+
+TEST_CASE("persistence restore", "[persistence]")
+{
+    dcp per;
+    void* handle = nullptr;
+    dcp::persistence_open(&handle, CLIENT_ID, SERVER_URI, static_cast<iclient_persistence*>(&per));
+
+    char* bufs[] = {const_cast<char*>(PAYLOAD)};
+    int buflens[] = {int(PAYLOAD_LEN)};
+    dcp::persistence_put(handle, const_cast<char*>("k1"), 1, bufs, buflens);
+    dcp::persistence_put(handle, const_cast<char*>("k2"), 1, bufs, buflens);
+    dcp::persistence_put(handle, const_cast<char*>("k3"), 1, bufs, buflens);
+
+    char** keys = nullptr;
+    int nkeys = 0;
+    REQUIRE(MQTTASYNC_SUCCESS == dcp::persistence_keys(handle, &keys, &nkeys));
+    REQUIRE(3 == nkeys);
+    for (int i = 0; i < nkeys; ++i) persistence_free(keys[i]);
+    persistence_free(keys);
+
+    // The value comes from the cache, even though the store lost it.
+    per.remove("k1");
+
+    char* buf = nullptr;
+    int buflen = 0;
+    REQUIRE(
+        MQTTASYNC_SUCCESS == dcp::persistence_get(handle, const_cast<char*>("k1"), &buf, &buflen)
+    );
+    REQUIRE(std::string(PAYLOAD) == std::string(buf, buflen));
+    persistence_free(buf);
+
+    // Once it's taken, it's read from the store
+    REQUIRE(
+        MQTTCLIENT_PERSISTENCE_ERROR ==
+        dcp::persistence_get(handle, const_cast<char*>("k1"), &buf, &buflen)
+    );
+
+    // A put replaces the cached value
+    char* bufs2[] = {const_cast<char*>(PAYLOAD2)};
+    int buflens2[] = {int(PAYLOAD2_LEN)};
+    dcp::persistence_put(handle, const_cast<char*>("k2"), 1, bufs2, buflens2);
+
+    REQUIRE(
+        MQTTASYNC_SUCCESS == dcp::persistence_get(handle, const_cast<char*>("k2"), &buf, &buflen)
+    );
+    REQUIRE(std::string(PAYLOAD2) == std::string(buf, buflen));
+    persistence_free(buf);
+
+    // A removed key is gone from the cache
+    REQUIRE(MQTTASYNC_SUCCESS == dcp::persistence_remove(handle, const_cast<char*>("k3")));
+    REQUIRE(
+        MQTTCLIENT_PERSISTENCE_ERROR ==
+        dcp::persistence_get(handle, const_cast<char*>("k3"), &buf, &buflen)
+    );
+
+    REQUIRE(MQTTASYNC_SUCCESS == dcp::persistence_close(handle));
+}
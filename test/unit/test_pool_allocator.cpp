@@ -0,0 +1,188 @@
+// test_pool_allocator.cpp
+//
+// Unit tests for the block_pool and pool_allocator classes in the Paho
+// MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/message.h"
+#include "mqtt/pool_allocator.h"
+
+using namespace mqtt;
+
+TEST_CASE("block_pool recycles", "[pool]")
+{
+    block_pool pool{64, 2};
+    REQUIRE(pool.block_size() == 64);
+    REQUIRE(pool.num_free() == 0);
+
+    void* p1 = pool.allocate();
+    void* p2 = pool.allocate();
+    void* p3 = pool.allocate();
+
+    pool.deallocate(p1);
+    pool.deallocate(p2);
+    REQUIRE(pool.num_free() == 2);
+
+    // Past the maximum, blocks go back to the heap
+    pool.deallocate(p3);
+    REQUIRE(pool.num_free() == 2);
+
+    // The most recently freed block is reused first
+    void* p = pool.allocate();
+    REQUIRE(p == p2);
+    REQUIRE(pool.num_free() == 1);
+    pool.deallocate(p);
+
+    pool.max_free(1);
+    REQUIRE(pool.num_free() == 1);
+
+    pool.clear();
+    REQUIRE(pool.num_free() == 0);
+}
+
+TEST_CASE("block_pool cache", "[pool]")
+{
+    block_pool pool{64, 100};
+    std::vector<void*> blks;
+
+    {
+        block_pool::cache cache{pool, 4};
+
+        // An empty pool can't refill the cache, so these come from the heap
+        for (int i = 0; i < 5; ++i) blks.push_back(cache.allocate());
+        REQUIRE(cache.num_free() == 0);
+
+        // A full cache gives half of its blocks back to the pool at once
+        for (auto p : blks) cache.deallocate(p);
+        REQUIRE(cache.num_free() == 3);
+        REQUIRE(pool.num_free() == 2);
+
+        // The most recently freed block is reused first
+        REQUIRE(cache.allocate() == blks[4]);
+        cache.allocate();
+        cache.allocate();
+        REQUIRE(cache.num_free() == 0);
+
+        // An empty cache takes a batch from the pool
+        cache.allocate();
+        REQUIRE(cache.num_free() == 1);
+        REQUIRE(pool.num_free() == 0);
+    }
+
+    // The cache gives what it has back when it goes away
+    REQUIRE(pool.num_free() == 1);
+}
+
+TEST_CASE("block_pool min block size", "[pool]")
+{
+    block_pool pool{1};
+    REQUIRE(pool.block_size() >= sizeof(void*));
+}
+
+TEST_CASE("pool_allocator shared", "[pool]")
+{
+    struct thing
+    {
+        int a, b;
+    };
+
+    auto p1 = std::allocate_shared<thing>(pool_allocator<thing>{}, thing{1, 2});
+    REQUIRE(p1->a == 1);
+    REQUIRE(p1->b == 2);
+
+    const void* addr = p1.get();
+    p1.reset();
+
+    // The memory should be recycled for the next object
+    auto p2 = std::allocate_shared<thing>(pool_allocator<thing>{}, thing{3, 4});
+    REQUIRE(p2.get() == addr);
+    REQUIRE(p2->a == 3);
+}
+
+TEST_CASE("pool_allocator array", "[pool]")
+{
+    pool_allocator<int> alloc;
+    std::vector<int, pool_allocator<int>> v(alloc);
+
+    for (int i = 0; i < 100; ++i) v.push_back(i);
+    REQUIRE(v.size() == 100);
+    REQUIRE(v[99] == 99);
+}
+
+TEST_CASE("pool_allocator mt", "[pool]")
+{
+    const size_t N = 10000;
+    const size_t N_THR = 4;
+
+    auto fn = [N]() {
+        for (size_t i = 0; i < N; ++i) {
+            auto msg = message::create("some/topic", "payload");
+            if (msg->get_payload_str() != "payload")
+                return false;
+        }
+        return true;
+    };
+
+    std::vector<std::thread> thrs;
+    std::vector<int> res(N_THR, 0);
+
+    for (size_t i = 0; i < N_THR; ++i)
+        thrs.emplace_back([&res, &fn, i] { res[i] = fn() ? 1 : 0; });
+
+    for (auto& thr : thrs) thr.join();
+
+    for (auto r : res) REQUIRE(r == 1);
+}
+
+TEST_CASE("pool_allocator thread cache", "[pool]")
+{
+    struct widget
+    {
+        long a, b, c;
+    };
+    auto& pool = pool_allocator<widget>::pool();
+    auto n = pool.num_free();
+
+    // The blocks freed by a thread are cached, then go to the shared pool
+    // when it exits, to be used by the others.
+    std::thread thr{[] {
+        pool_allocator<widget> alloc;
+        std::vector<widget*> v;
+        for (int i = 0; i < 10; ++i) v.push_back(alloc.allocate(1));
+        for (auto p : v) alloc.deallocate(p, 1);
+    }};
+    thr.join();
+    REQUIRE(pool.num_free() == n + 10);
+
+    // Objects made on one thread and destroyed on another are fine, too
+    std::vector<std::shared_ptr<widget>> v;
+    for (int i = 0; i < 1000; ++i)
+        v.push_back(std::allocate_shared<widget>(pool_allocator<widget>{}, widget{i, i, i}));
+
+    std::thread thr2{[&v] { v.clear(); }};
+    thr2.join();
+    REQUIRE(v.empty());
+}
@@ -0,0 +1,138 @@
+// test_priority_lanes.cpp
+//
+// Unit tests for the priority_lanes class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/priority_lanes.h"
+
+using namespace mqtt;
+
+// Takes all the items from the lanes, in the order they're served
+static std::vector<int> drain(priority_lanes<int>& q)
+{
+    std::vector<int> v;
+    while (!q.empty()) v.push_back(q.pop_front());
+    return v;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("priority_lanes ctor", "[priority_lanes]")
+{
+    priority_lanes<int> q;
+    REQUIRE(3 == q.num_lanes());
+    REQUIRE(q.get_weights() == lane_weights{8, 2, 1});
+    REQUIRE(q.empty());
+    REQUIRE(0 == q.size());
+
+    priority_lanes<int> q1{{}};
+    REQUIRE(1 == q1.num_lanes());
+
+    priority_lanes<int> q2{{4, 0}};
+    REQUIRE(q2.get_weights() == lane_weights{4, 1});
+}
+
+TEST_CASE("priority_lanes lane", "[priority_lanes]")
+{
+    priority_lanes<int> q;
+    REQUIRE(0 == q.lane(-1));
+    REQUIRE(0 == q.lane(0));
+    REQUIRE(2 == q.lane(2));
+    REQUIRE(2 == q.lane(7));
+
+    q.push_back(9, 1);
+    REQUIRE(1 == q.lane_size(2));
+    REQUIRE(1 == q.size());
+}
+
+TEST_CASE("priority_lanes fifo in a lane", "[priority_lanes]")
+{
+    priority_lanes<int> q;
+    for (int i = 0; i < 5; ++i) q.push_back(1, i);
+
+    REQUIRE(0 == q.front());
+    REQUIRE(drain(q) == std::vector<int>{0, 1, 2, 3, 4});
+}
+
+TEST_CASE("priority_lanes weighted", "[priority_lanes]")
+{
+    priority_lanes<int> q{{2, 1}};
+
+    // 1xx in the high lane, 2xx in the low one
+    for (int i = 0; i < 3; ++i) q.push_back(1, 200 + i);
+    for (int i = 0; i < 5; ++i) q.push_back(0, 100 + i);
+
+    REQUIRE(8 == q.size());
+    REQUIRE(drain(q) == std::vector<int>{100, 101, 200, 102, 103, 201, 104, 202});
+}
+
+TEST_CASE("priority_lanes urgent item", "[priority_lanes]")
+{
+    priority_lanes<int> q;
+    for (int i = 0; i < 100; ++i) q.push_back(2, i);
+
+    // Start serving the backlog, then an urgent item arrives
+    REQUIRE(0 == q.pop_front());
+    q.push_back(0, -1);
+    REQUIRE(-1 == q.pop_front());
+}
+
+TEST_CASE("priority_lanes push_front", "[priority_lanes]")
+{
+    priority_lanes<int> q;
+    q.push_back(1, 1);
+    q.push_back(1, 2);
+
+    auto n = q.pop_front();
+    q.push_front(1, n);
+    REQUIRE(drain(q) == std::vector<int>{1, 2});
+}
+
+TEST_CASE("priority_lanes extract_if", "[priority_lanes]")
+{
+    priority_lanes<int> q;
+    for (int i = 0; i < 6; ++i) q.push_back(i % 3, i);
+
+    auto odd = q.extract_if([](int n) { return n % 2 != 0; });
+    REQUIRE(odd == std::vector<int>{3, 1, 5});
+    REQUIRE(3 == q.size());
+
+    auto rest = q.take_all();
+    REQUIRE(rest == std::vector<int>{0, 4, 2});
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("priority_lanes set_weights", "[priority_lanes]")
+{
+    priority_lanes<int> q;
+    q.push_back(0, 0);
+    q.push_back(2, 2);
+
+    // The items of a lane that goes away move to the new last lane
+    q.set_weights({1, 1});
+    REQUIRE(2 == q.num_lanes());
+    REQUIRE(2 == q.size());
+    REQUIRE(1 == q.lane_size(1));
+    REQUIRE(drain(q) == std::vector<int>{0, 2});
+}
@@ -22,6 +22,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 #include "catch2_version.h"
 #include "mqtt/properties.h"
@@ -603,10 +604,10 @@ TEST_CASE("properties copy and move", "[properties]")
     {
         properties props{orgProps};
 
-        // Make sure it's a real copy, not a reference to org
+        // The copy shares the list, but outlives changes to the original
         const auto& cprops = props.c_struct();
         const auto& orgCprops = orgProps.c_struct();
-        REQUIRE(orgCprops.array != cprops.array);
+        REQUIRE(orgCprops.array == cprops.array);
 
         orgProps.clear();
 
@@ -659,10 +660,10 @@ TEST_CASE("properties copy and move", "[properties]")
         properties props;
         props = orgProps;
 
-        // Make sure it's a real copy, not a reference to org
+        // The copy shares the list, but outlives changes to the original
         const auto& cprops = props.c_struct();
         const auto& orgCprops = orgProps.c_struct();
-        REQUIRE(orgCprops.array != cprops.array);
+        REQUIRE(orgCprops.array == cprops.array);
 
         orgProps.clear();
 
@@ -708,3 +709,192 @@ TEST_CASE("properties copy and move", "[properties]")
         REQUIRE(0 == orgProps.size());
     }
 }
+
+TEST_CASE("properties copy on write", "[properties]")
+{
+    properties orgProps{
+        {property::RESPONSE_TOPIC, TOPIC},
+        {property::CORRELATION_DATA, CORR_ID},
+    };
+
+    // A copy shares the list
+    properties props{orgProps};
+    REQUIRE(props.c_struct().array == orgProps.c_struct().array);
+    REQUIRE(2 == props.size());
+
+    // ...until it's changed
+    props.add({property::TOPIC_ALIAS, TOP_ALIAS});
+    REQUIRE(props.c_struct().array != orgProps.c_struct().array);
+    REQUIRE(3 == props.size());
+    REQUIRE(2 == orgProps.size());
+    REQUIRE(!orgProps.contains(property::TOPIC_ALIAS));
+    REQUIRE(get<string>(props, property::RESPONSE_TOPIC) == TOPIC);
+
+    props.clear();
+    REQUIRE(props.empty());
+    REQUIRE(get<binary>(orgProps, property::CORRELATION_DATA) == CORR_ID);
+
+    // Clearing a copy leaves the original alone
+    properties props2{orgProps};
+    props2.clear();
+    REQUIRE(props2.empty());
+    REQUIRE(2 == orgProps.size());
+}
+
+TEST_CASE("properties empty copy", "[properties]")
+{
+    properties props;
+    properties props2{props};
+
+    REQUIRE(props2.empty());
+    REQUIRE(nullptr == props2.c_struct().array);
+
+    MQTTProperties cprops = MQTTProperties_initializer;
+    properties props3{cprops};
+    REQUIRE(props3.empty());
+    REQUIRE(nullptr == props3.c_struct().array);
+}
+
+TEST_CASE("properties iterator view", "[properties]")
+{
+    properties props{
+        {property::RESPONSE_TOPIC, TOPIC},
+        {property::CORRELATION_DATA, CORR_ID},
+    };
+
+    // Dereferencing refers to the data in the list, without copying it
+    size_t i = 0;
+    for (auto it = props.begin(); it != props.end(); ++it, ++i) {
+        const auto& prop = *it;
+        REQUIRE(prop.c_struct().value.data.data == props.c_struct().array[i].value.data.data);
+    }
+    REQUIRE(2 == i);
+
+    // But a copy of the property is its own
+    auto it = props.begin();
+    property prop{*it};
+    REQUIRE(prop.c_struct().value.data.data != props.c_struct().array[0].value.data.data);
+    REQUIRE(get<string>(prop) == TOPIC);
+
+    auto it2 = it;
+    it2++;
+    REQUIRE(get<binary>(*it2) == CORR_ID);
+}
+
+TEST_CASE("properties try_get", "[properties]")
+{
+    properties props{
+        {property::PAYLOAD_FORMAT_INDICATOR, FMT_IND},
+        {property::TOPIC_ALIAS, TOP_ALIAS},
+        {property::MAXIMUM_PACKET_SIZE, MAX_PKT_SZ},
+        {property::RESPONSE_TOPIC, TOPIC},
+        {property::CORRELATION_DATA, CORR_ID},
+        {property::USER_PROPERTY, NAME1, VALUE1},
+        {property::USER_PROPERTY, NAME2, VALUE2},
+    };
+
+    REQUIRE(FMT_IND == try_get<uint8_t>(props, property::PAYLOAD_FORMAT_INDICATOR));
+    REQUIRE(TOP_ALIAS == try_get<uint16_t>(props, property::TOPIC_ALIAS));
+    REQUIRE(MAX_PKT_SZ == try_get<uint32_t>(props, property::MAXIMUM_PACKET_SIZE));
+    REQUIRE(TOPIC == try_get<string>(props, property::RESPONSE_TOPIC));
+
+    // The views refer to the data in the list
+    auto sv = try_get<std::string_view>(props, property::CORRELATION_DATA);
+    REQUIRE(sv);
+    REQUIRE(CORR_ID == *sv);
+    REQUIRE(sv->data() == props.c_struct().array[4].value.data.data);
+
+    auto kv = try_get<string_view_pair>(props, property::USER_PROPERTY, 1);
+    REQUIRE(kv);
+    REQUIRE(NAME2 == kv->first);
+    REQUIRE(VALUE2 == kv->second);
+    REQUIRE(
+        string_pair{NAME1, VALUE1} ==
+        try_get<string_pair>(props, property::USER_PROPERTY).value()
+    );
+
+    // Missing properties, indexes, and the wrong types give nothing
+    REQUIRE(!try_get<uint32_t>(props, property::MESSAGE_EXPIRY_INTERVAL));
+    REQUIRE(!try_get<string_view_pair>(props, property::USER_PROPERTY, 2));
+    REQUIRE(!try_get<uint32_t>(props, property::TOPIC_ALIAS));
+    REQUIRE(!try_get<std::string_view>(props, property::TOPIC_ALIAS));
+    REQUIRE(!try_get<uint8_t>(props, property::RESPONSE_TOPIC));
+
+    // User properties by name
+    REQUIRE(VALUE2 == get_user_property(props, NAME2));
+    REQUIRE(!get_user_property(props, "usr"));
+    REQUIRE(!get_user_property(properties{}, NAME1));
+}
+
+TEST_CASE("property type_of", "[property]")
+{
+    REQUIRE(MQTTPROPERTY_TYPE_BYTE == property::type_of(property::MAXIMUM_QOS));
+    REQUIRE(MQTTPROPERTY_TYPE_TWO_BYTE_INTEGER == property::type_of(property::RECEIVE_MAXIMUM));
+    REQUIRE(
+        MQTTPROPERTY_TYPE_FOUR_BYTE_INTEGER ==
+        property::type_of(property::SESSION_EXPIRY_INTERVAL)
+    );
+    REQUIRE(
+        MQTTPROPERTY_TYPE_VARIABLE_BYTE_INTEGER ==
+        property::type_of(property::SUBSCRIPTION_IDENTIFIER)
+    );
+    REQUIRE(MQTTPROPERTY_TYPE_BINARY_DATA == property::type_of(property::AUTHENTICATION_DATA));
+    REQUIRE(MQTTPROPERTY_TYPE_UTF_8_ENCODED_STRING == property::type_of(property::REASON_STRING));
+    REQUIRE(MQTTPROPERTY_TYPE_UTF_8_STRING_PAIR == property::type_of(property::USER_PROPERTY));
+    REQUIRE(-1 == property::type_of(property::code(99)));
+}
+
+TEST_CASE("property_index", "[properties]")
+{
+    properties props{
+        {property::RESPONSE_TOPIC, TOPIC},
+        {property::USER_PROPERTY, NAME1, VALUE1},
+        {property::MAXIMUM_PACKET_SIZE, MAX_PKT_SZ},
+        {property::USER_PROPERTY, NAME2, VALUE2},
+    };
+
+    property_index idx{props};
+
+    REQUIRE(idx.contains(property::RESPONSE_TOPIC));
+    REQUIRE(!idx.contains(property::CONTENT_TYPE));
+    REQUIRE(!idx.contains(property::code(99)));
+
+    REQUIRE(TOPIC == idx.try_get<std::string_view>(property::RESPONSE_TOPIC));
+    REQUIRE(MAX_PKT_SZ == idx.try_get<uint32_t>(property::MAXIMUM_PACKET_SIZE));
+    REQUIRE(NAME2 == idx.try_get<string_view_pair>(property::USER_PROPERTY, 1)->first);
+    REQUIRE(!idx.try_get<std::string_view>(property::CONTENT_TYPE));
+
+    REQUIRE(VALUE1 == idx.get_user_property(NAME1));
+    REQUIRE(VALUE2 == idx.get_user_property(NAME2));
+    REQUIRE(!idx.get_user_property("none"));
+
+    properties empty;
+    property_index idx2{empty};
+    REQUIRE(!idx2.contains(property::USER_PROPERTY));
+    REQUIRE(!idx2.get_user_property(NAME1));
+}
+
+TEST_CASE("properties pack", "[properties]")
+{
+    properties props{
+        {property::PAYLOAD_FORMAT_INDICATOR, 1},
+        {property::MESSAGE_EXPIRY_INTERVAL, 70000},
+        {property::RESPONSE_TOPIC, "replies/here"},
+        {property::CORRELATION_DATA, binary{"\x01\x00\x02", 3}},
+        {property::USER_PROPERTY, "name", "value"},
+    };
+
+    std::vector<char> buf(props.packed_size());
+    REQUIRE(buf.data() + buf.size() == props.pack(buf.data()));
+
+    auto props2 = properties::unpack(buf.data(), buf.size());
+    REQUIRE(props.size() == props2.size());
+    REQUIRE(70000 == get<uint32_t>(props2, property::MESSAGE_EXPIRY_INTERVAL));
+    REQUIRE("replies/here" == get<string>(props2, property::RESPONSE_TOPIC));
+    REQUIRE(3 == get<binary>(props2, property::CORRELATION_DATA).size());
+    REQUIRE("value" == std::get<1>(get<string_pair>(props2, property::USER_PROPERTY)));
+
+    // A truncated buffer gives the properties before the cut
+    auto props3 = properties::unpack(buf.data(), buf.size() - 1);
+    REQUIRE(props.size() - 1 == props3.size());
+}
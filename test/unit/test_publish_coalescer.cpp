@@ -0,0 +1,107 @@
+// test_publish_coalescer.cpp
+//
+// Unit tests for the publish_coalescer class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/publish_coalescer.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+TEST_CASE("publish_coalescer ctor", "[coalescer]")
+{
+    publish_coalescer pc{microseconds(500), 1024};
+
+    REQUIRE(microseconds(500) == pc.get_delay());
+    REQUIRE(1024 == pc.get_max_bytes());
+    REQUIRE(0 == pc.num_pending());
+    REQUIRE(0 == pc.pending_bytes());
+    REQUIRE(0 == pc.num_flushes());
+}
+
+TEST_CASE("publish_coalescer flush", "[coalescer]")
+{
+    publish_coalescer pc{seconds(60)};
+    std::vector<int> order;
+
+    for (int i = 0; i < 5; ++i) pc.add(10, [&order, i] { order.push_back(i); });
+
+    REQUIRE(5 == pc.num_pending());
+    REQUIRE(50 == pc.pending_bytes());
+    REQUIRE(order.empty());
+
+    pc.flush();
+
+    REQUIRE(0 == pc.num_pending());
+    REQUIRE(0 == pc.pending_bytes());
+    REQUIRE(1 == pc.num_flushes());
+    REQUIRE(std::vector<int>{0, 1, 2, 3, 4} == order);
+
+    // Nothing pending is not a flush
+    pc.flush();
+    REQUIRE(1 == pc.num_flushes());
+}
+
+TEST_CASE("publish_coalescer delay", "[coalescer]")
+{
+    publish_coalescer pc{milliseconds(10)};
+    std::atomic<int> n{0};
+
+    for (int i = 0; i < 3; ++i) pc.add(1, [&n] { ++n; });
+
+    for (int i = 0; n < 3 && i < 500; ++i) std::this_thread::sleep_for(milliseconds(2));
+
+    REQUIRE(3 == n);
+    REQUIRE(1 == pc.num_flushes());
+}
+
+TEST_CASE("publish_coalescer max bytes", "[coalescer]")
+{
+    publish_coalescer pc{seconds(60), 100};
+    std::atomic<int> n{0};
+
+    pc.add(60, [&n] { ++n; });
+    std::this_thread::sleep_for(milliseconds(10));
+    REQUIRE(0 == n);
+
+    pc.add(60, [&n] { ++n; });
+    for (int i = 0; n < 2 && i < 500; ++i) std::this_thread::sleep_for(milliseconds(2));
+
+    REQUIRE(2 == n);
+    REQUIRE(0 == pc.pending_bytes());
+}
+
+TEST_CASE("publish_coalescer dtor flushes", "[coalescer]")
+{
+    int n = 0;
+    {
+        publish_coalescer pc{seconds(60)};
+        pc.add(1, [&n] { ++n; });
+        pc.add(1, [&n] { ++n; });
+    }
+    REQUIRE(2 == n);
+}
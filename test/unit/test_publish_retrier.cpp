@@ -0,0 +1,241 @@
+// test_publish_retrier.cpp
+//
+// Unit tests for the retry_policy and publish_retrier classes in the Paho
+// MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mock_async_client.h"
+#include "mqtt/async_client.h"
+#include "mqtt/publish_retrier.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+namespace {
+
+// Records the retries that are run, or dropped
+struct recorder
+{
+    std::mutex lock;
+    std::condition_variable cond;
+    std::vector<int> run;
+    std::vector<int> dropped;
+
+    publish_retrier::task_type task(int n) {
+        return [this, n](bool due) {
+            std::lock_guard<std::mutex> g{lock};
+            (due ? run : dropped).push_back(n);
+            cond.notify_all();
+        };
+    }
+
+    bool wait_run(size_t n) {
+        std::unique_lock<std::mutex> g{lock};
+        return cond.wait_for(g, seconds(5), [&] { return run.size() >= n; });
+    }
+};
+
+// Waits for a token to complete, with a limit
+bool wait_complete(const token_ptr& tok)
+{
+    auto until = steady_clock::now() + seconds(5);
+    while (!tok->is_complete() && steady_clock::now() < until)
+        std::this_thread::sleep_for(milliseconds(1));
+    return tok->is_complete();
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------
+
+TEST_CASE("retry_policy backoff", "[retry]")
+{
+    retry_policy policy{milliseconds(100), seconds(1), 3};
+    REQUIRE(milliseconds(100) == policy.get_min_delay());
+    REQUIRE(seconds(1) == policy.get_max_delay());
+    REQUIRE(3 == policy.get_max_retries());
+
+    REQUIRE(milliseconds(100) == policy.get_delay(0, 0.0));
+    REQUIRE(milliseconds(200) == policy.get_delay(1, 0.0));
+    REQUIRE(milliseconds(800) == policy.get_delay(3, 0.0));
+    REQUIRE(seconds(1) == policy.get_delay(10, 0.0));
+
+    // Half the wait, at most, is taken off at random
+    REQUIRE(milliseconds(50) == policy.get_delay(0, 1.0));
+
+    policy.set_jitter(0.0);
+    policy.set_multiplier(0.5);
+    REQUIRE(milliseconds(100) == policy.get_delay(5, 0.9));
+}
+
+TEST_CASE("retry_policy retryable", "[retry]")
+{
+    retry_policy policy;
+
+    REQUIRE(policy.is_retryable(MQTTASYNC_DISCONNECTED, ReasonCode::SUCCESS));
+    REQUIRE(policy.is_retryable(MQTTASYNC_MAX_BUFFERED_MESSAGES, ReasonCode::SUCCESS));
+    REQUIRE(policy.is_retryable(MQTTASYNC_FAILURE, ReasonCode::QUOTA_EXCEEDED));
+    REQUIRE(policy.is_retryable(MQTTASYNC_FAILURE, ReasonCode::SERVER_BUSY));
+    REQUIRE(!policy.is_retryable(MQTTASYNC_BAD_QOS, ReasonCode::SUCCESS));
+    REQUIRE(!policy.is_retryable(MQTTASYNC_FAILURE, ReasonCode::TOPIC_NAME_INVALID));
+
+    policy.set_filter([](int rc, ReasonCode) { return rc == MQTTASYNC_BAD_QOS; });
+    REQUIRE(policy.is_retryable(MQTTASYNC_BAD_QOS, ReasonCode::SUCCESS));
+    REQUIRE(!policy.is_retryable(MQTTASYNC_DISCONNECTED, ReasonCode::SUCCESS));
+}
+
+TEST_CASE("publish_retrier schedule", "[retry]")
+{
+    publish_retrier rt;
+    recorder rec;
+
+    auto now = publish_retrier::clock::now();
+    REQUIRE(rt.schedule_at(now + milliseconds(30), rec.task(3)));
+    REQUIRE(rt.schedule_at(now + milliseconds(10), rec.task(1)));
+    REQUIRE(rt.schedule_at(now + milliseconds(20), rec.task(2)));
+    REQUIRE(3 == rt.num_retries());
+
+    // The one timer runs them in the order they're due
+    REQUIRE(rec.wait_run(3));
+    REQUIRE(std::vector<int>{1, 2, 3} == rec.run);
+    REQUIRE(publish_retrier::clock::now() - now >= milliseconds(30));
+    REQUIRE(0 == rt.num_scheduled());
+
+    SECTION("stop")
+    {
+        REQUIRE(rt.schedule_at(now + seconds(60), rec.task(4)));
+        REQUIRE(1 == rt.num_scheduled());
+
+        rt.stop();
+        REQUIRE(std::vector<int>{4} == rec.dropped);
+        REQUIRE(!rt.schedule(0, rec.task(5)));
+        REQUIRE(1 == rec.dropped.size());
+    }
+}
+
+TEST_CASE("publish_retrier dead letters", "[retry]")
+{
+    publish_retrier rt{retry_policy{}, 2};
+    REQUIRE(2 == rt.get_max_dead_letters());
+
+    std::vector<string> seen;
+    rt.set_dead_letter_handler([&](const dead_letter& dl) {
+        seen.push_back(dl.msg->get_payload_str());
+    });
+
+    for (int i = 0; i < 3; ++i) {
+        auto msg = make_message("topic", std::to_string(i), 1, false);
+        rt.add_dead_letter(dead_letter{msg, MQTTASYNC_DISCONNECTED, ReasonCode::SUCCESS, 5, {}});
+    }
+
+    REQUIRE(3 == seen.size());
+    REQUIRE(3 == rt.num_dead_lettered());
+    REQUIRE(1 == rt.num_dead_letters_dropped());
+    REQUIRE(2 == rt.num_dead_letters());
+
+    // The oldest was dropped to make room
+    auto dls = rt.take_dead_letters();
+    REQUIRE(2 == dls.size());
+    REQUIRE("1" == dls[0].msg->get_payload_str());
+    REQUIRE("2" == dls[1].msg->get_payload_str());
+    REQUIRE(5 == dls[1].retries);
+    REQUIRE(dls[1].time != std::chrono::system_clock::time_point{});
+    REQUIRE(0 == rt.num_dead_letters());
+}
+
+// ----------------------------------------------------------------------
+// The retries of an async_client. With no server, each retry fails to
+// send, and is retried again until it runs out.
+// ----------------------------------------------------------------------
+
+TEST_CASE("async_client publish retry", "[retry]")
+{
+    async_client cli{"mqtt://localhost:1883", "retry_test"};
+
+    retry_policy policy{milliseconds(1), milliseconds(5), 2};
+    cli.start_publish_retry(policy, 10);
+    auto rt = cli.get_publish_retrier();
+    REQUIRE(rt);
+
+    auto msg = make_message("topic", "payload", 1, false);
+
+    SECTION("exhausted")
+    {
+        auto tok = delivery_token::create(cli, msg);
+        cli.test_add_token(tok);
+
+        MQTTAsync_failureData rsp{};
+        rsp.code = MQTTASYNC_DISCONNECTED;
+        mock_async_client::fail(tok.get(), &rsp);
+
+        REQUIRE(wait_complete(tok));
+        REQUIRE(2 == tok->get_retries());
+        REQUIRE(2 == rt->num_retries());
+        REQUIRE(1 == rt->num_dead_lettered());
+
+        auto dls = rt->take_dead_letters();
+        REQUIRE(1 == dls.size());
+        REQUIRE(msg == dls[0].msg);
+        REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+    }
+
+    SECTION("not retryable")
+    {
+        auto tok = delivery_token::create(cli, msg);
+        cli.test_add_token(tok);
+
+        MQTTAsync_failureData rsp{};
+        rsp.code = MQTTASYNC_BAD_QOS;
+        mock_async_client::fail(tok.get(), &rsp);
+
+        REQUIRE(tok->is_complete());
+        REQUIRE(0 == tok->get_retries());
+        REQUIRE(0 == rt->num_dead_lettered());
+    }
+
+    SECTION("stopped")
+    {
+        cli.start_publish_retry(retry_policy{seconds(60), seconds(60)});
+        rt = cli.get_publish_retrier();
+
+        auto tok = delivery_token::create(cli, msg);
+        cli.test_add_token(tok);
+
+        MQTTAsync_failureData rsp{};
+        rsp.code = MQTTASYNC_DISCONNECTED;
+        mock_async_client::fail(tok.get(), &rsp);
+
+        REQUIRE(!tok->is_complete());
+        REQUIRE(1 == rt->num_scheduled());
+
+        cli.stop_publish_retry();
+        REQUIRE(tok->is_complete());
+        REQUIRE(!cli.get_publish_retrier());
+    }
+}
@@ -0,0 +1,215 @@
+// test_rate_limiter.cpp
+//
+// Unit tests for the rate_limiter class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/rate_limiter.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+TEST_CASE("rate_limiter ctor", "[rate_limiter]")
+{
+    rate_limiter lim{100.0, 2000.0, rate_limiter::FAIL};
+
+    REQUIRE(rate_limiter::FAIL == lim.get_policy());
+    REQUIRE(100.0 == lim.get_message_rate());
+    REQUIRE(2000.0 == lim.get_byte_rate());
+    REQUIRE(0 == lim.queue_size());
+    REQUIRE(!lim.stopped());
+    REQUIRE(0.0 == lim.current_message_rate());
+}
+
+TEST_CASE("rate_limiter message burst", "[rate_limiter]")
+{
+    // A one second burst at 10 msg/s lets 10 messages go right away
+    rate_limiter lim{10.0, 0.0, rate_limiter::FAIL};
+
+    for (int i = 0; i < 10; ++i) REQUIRE(lim.try_acquire(100));
+    REQUIRE(!lim.try_acquire(100));
+
+    REQUIRE(lim.current_message_rate() > 9.0);
+    REQUIRE(lim.current_byte_rate() > 900.0);
+}
+
+TEST_CASE("rate_limiter byte burst", "[rate_limiter]")
+{
+    rate_limiter lim{0.0, 1000.0, rate_limiter::FAIL};
+
+    REQUIRE(lim.try_acquire(600));
+    REQUIRE(lim.try_acquire(400));
+    REQUIRE(!lim.try_acquire(1));
+}
+
+TEST_CASE("rate_limiter oversized message", "[rate_limiter]")
+{
+    // A message bigger than the bucket can go when it's full, leaving debt
+    rate_limiter lim{0.0, 100.0, rate_limiter::FAIL, 0.1};
+
+    REQUIRE(lim.try_acquire(1000));
+    REQUIRE(!lim.try_acquire(1));
+}
+
+TEST_CASE("rate_limiter no limit", "[rate_limiter]")
+{
+    rate_limiter lim{0.0};
+
+    for (int i = 0; i < 1000; ++i) REQUIRE(lim.try_acquire(1000000));
+}
+
+TEST_CASE("rate_limiter acquire waits", "[rate_limiter]")
+{
+    // After the burst of 5, each message must wait about 10ms
+    rate_limiter lim{100.0, 0.0, rate_limiter::BLOCK, 0.05};
+
+    for (int i = 0; i < 5; ++i) REQUIRE(lim.acquire(0));
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < 5; ++i) REQUIRE(lim.acquire(0));
+    auto dt = steady_clock::now() - start;
+
+    REQUIRE(dt >= milliseconds(40));
+}
+
+TEST_CASE("rate_limiter stop releases acquire", "[rate_limiter]")
+{
+    rate_limiter lim{0.1};
+    REQUIRE(lim.acquire(0));
+
+    std::atomic<int> res{-1};
+    std::thread thr([&] { res = lim.acquire(0) ? 1 : 0; });
+
+    std::this_thread::sleep_for(milliseconds(20));
+    lim.stop();
+    thr.join();
+
+    REQUIRE(0 == res);
+    REQUIRE(lim.stopped());
+    REQUIRE(!lim.try_acquire(0));
+}
+
+TEST_CASE("rate_limiter submit in order", "[rate_limiter]")
+{
+    rate_limiter lim{200.0, 0.0, rate_limiter::QUEUE, 0.01};
+
+    constexpr int N = 10;
+    std::mutex mtx;
+    std::vector<int> order;
+    std::atomic<int> nDone{0};
+
+    for (int i = 0; i < N; ++i) {
+        REQUIRE(lim.submit(0, [&, i](bool ok) {
+            REQUIRE(ok);
+            {
+                std::lock_guard<std::mutex> g{mtx};
+                order.push_back(i);
+            }
+            ++nDone;
+        }));
+    }
+
+    for (int i = 0; nDone < N && i < 500; ++i) std::this_thread::sleep_for(milliseconds(2));
+
+    REQUIRE(N == nDone);
+    REQUIRE(0 == lim.queue_size());
+    for (int i = 0; i < N; ++i) REQUIRE(i == order[i]);
+}
+
+TEST_CASE("rate_limiter submit by priority", "[rate_limiter]")
+{
+    rate_limiter lim{1000.0, 0.0, rate_limiter::QUEUE};
+    REQUIRE(lim.get_lane_weights() == lane_weights{8, 2, 1});
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool release = false;
+    std::vector<std::string> order;
+    std::atomic<int> nDone{0};
+
+    auto task = [&](const std::string& name) {
+        return [&, name](bool) {
+            {
+                std::lock_guard<std::mutex> g{mtx};
+                order.push_back(name);
+            }
+            ++nDone;
+        };
+    };
+
+    // Hold up the queue thread until the rest are queued
+    REQUIRE(lim.submit(
+        0,
+        [&](bool) {
+            std::unique_lock<std::mutex> g{mtx};
+            cv.wait(g, [&] { return release; });
+            ++nDone;
+        },
+        2
+    ));
+
+    for (int i = 0; lim.queue_size() != 0 && i < 500; ++i)
+        std::this_thread::sleep_for(milliseconds(1));
+
+    lim.submit(0, task("bulk1"), 2);
+    lim.submit(0, task("bulk2"), 2);
+    lim.submit(0, task("alarm"), 0);
+    REQUIRE(3 == lim.queue_size());
+
+    {
+        std::lock_guard<std::mutex> g{mtx};
+        release = true;
+    }
+    cv.notify_all();
+
+    for (int i = 0; nDone < 4 && i < 500; ++i) std::this_thread::sleep_for(milliseconds(2));
+
+    REQUIRE(4 == nDone);
+    REQUIRE(order == std::vector<std::string>{"alarm", "bulk1", "bulk2"});
+}
+
+TEST_CASE("rate_limiter stop cancels queue", "[rate_limiter]")
+{
+    rate_limiter lim{0.5, 0.0, rate_limiter::QUEUE};
+
+    std::atomic<int> nOk{0}, nCanceled{0};
+    auto task = [&](bool ok) { ++(ok ? nOk : nCanceled); };
+
+    for (int i = 0; i < 3; ++i) REQUIRE(lim.submit(0, task));
+
+    for (int i = 0; nOk < 1 && i < 500; ++i) std::this_thread::sleep_for(milliseconds(2));
+
+    REQUIRE(1 == nOk);
+    REQUIRE(2 == lim.queue_size());
+
+    lim.stop();
+    REQUIRE(2 == nCanceled);
+    REQUIRE(0 == lim.queue_size());
+    REQUIRE(!lim.submit(0, task));
+}
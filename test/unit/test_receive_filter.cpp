@@ -0,0 +1,142 @@
+// test_receive_filter.cpp
+//
+// Unit tests for the receive_filter class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/receive_filter.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("receive_filter sample", "[recv_filter]")
+{
+    receive_filter filt;
+    filt.add_sample("data/#", 3);
+    REQUIRE(1 == filt.num_stages());
+    REQUIRE_THROWS_AS(filt.add_sample("data/#", 0), std::invalid_argument);
+
+    const auto now = receive_filter::clock::now();
+
+    // The first of every three is kept, across all the matching topics
+    REQUIRE(!filt.check("data/a", 1, now));
+    REQUIRE(filt.check("data/b", 1, now));
+    REQUIRE(filt.check("data/a", 1, now));
+    REQUIRE(!filt.check("data/b", 1, now));
+
+    // Other topics aren't sampled
+    for (int i = 0; i < 5; ++i) REQUIRE(!filt.check("ctrl/a", 1, now));
+
+    REQUIRE(9 == filt.num_checked());
+    REQUIRE(2 == filt.num_dropped());
+    REQUIRE(2 == filt.num_dropped(0));
+    REQUIRE_THROWS_AS(filt.num_dropped(1), std::out_of_range);
+}
+
+TEST_CASE("receive_filter min interval", "[recv_filter]")
+{
+    receive_filter filt;
+    filt.add_min_interval("sensor/+/temp", seconds(1));
+
+    const auto t0 = receive_filter::clock::now();
+
+    // Each topic is timed on its own
+    REQUIRE(!filt.check("sensor/1/temp", 0, t0));
+    REQUIRE(!filt.check("sensor/2/temp", 0, t0));
+    REQUIRE(filt.check("sensor/1/temp", 0, t0 + milliseconds(500)));
+    REQUIRE(!filt.check("sensor/1/temp", 0, t0 + seconds(1)));
+    REQUIRE(filt.check("sensor/1/temp", 0, t0 + milliseconds(1500)));
+    REQUIRE(!filt.check("sensor/2/temp", 0, t0 + milliseconds(1500)));
+
+    // Non-matching topics are let through
+    REQUIRE(!filt.check("sensor/1/humidity", 0, t0));
+    REQUIRE(!filt.check("sensor/1/humidity", 0, t0));
+
+    SECTION("full")
+    {
+        receive_filter small;
+        small.add_min_interval("#", seconds(1), 2);
+
+        REQUIRE(!small.check("a", 0, t0));
+        REQUIRE(!small.check("b", 0, t0));
+
+        // A third topic makes room by forgetting the others
+        REQUIRE(!small.check("c", 0, t0));
+        REQUIRE(!small.check("a", 0, t0));
+        REQUIRE(small.check("a", 0, t0));
+    }
+}
+
+TEST_CASE("receive_filter predicate", "[recv_filter]")
+{
+    receive_filter filt;
+    filt.add_predicate([](std::string_view, int qos) { return qos > 0; }, "alerts/#");
+    filt.add_sample("#", 2);
+
+    const auto now = receive_filter::clock::now();
+
+    REQUIRE(filt.check("alerts/a", 0, now));
+    REQUIRE(!filt.check("alerts/a", 1, now));
+
+    // The sample only counts what got past the predicate
+    REQUIRE(filt.check("alerts/a", 1, now));
+    REQUIRE(!filt.check("status", 0, now));
+
+    REQUIRE(1 == filt.num_dropped(0));
+    REQUIRE(1 == filt.num_dropped(1));
+}
+
+TEST_CASE("async_client receive filter", "[recv_filter]")
+{
+    async_client cli{"tcp://localhost:1883", "test_receive_filter"};
+    REQUIRE(!cli.get_receive_filter());
+
+    auto filt = std::make_shared<receive_filter>();
+    filt->add_sample("#", 2);
+    cli.set_receive_filter(filt);
+    REQUIRE(filt == cli.get_receive_filter());
+
+    cli.start_consuming();
+
+    const std::string PAYLOAD{"payload"};
+    for (int i = 0; i < 4; ++i)
+        cli.test_message_arrived("a/b", PAYLOAD.data(), PAYLOAD.size());
+
+    // Half of them were dropped before they were queued
+    REQUIRE(2 == cli.get_metrics().num_filtered_dropped());
+    REQUIRE(4 == cli.get_metrics().messages_received());
+    REQUIRE(2 == filt->num_dropped());
+
+    const_message_ptr msg;
+    REQUIRE(cli.try_consume_message(&msg));
+    REQUIRE(cli.try_consume_message(&msg));
+    REQUIRE(!cli.try_consume_message(&msg));
+
+    cli.set_receive_filter(receive_filter_ptr{});
+    REQUIRE(!cli.get_receive_filter());
+}
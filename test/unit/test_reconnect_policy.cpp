@@ -0,0 +1,97 @@
+// test_reconnect_policy.cpp
+//
+// Unit tests for the reconnect_policy class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+
+#include "catch2_version.h"
+#include "mqtt/reconnect_policy.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+TEST_CASE("reconnect_policy default ctor", "[reconnect]")
+{
+    reconnect_policy policy;
+
+    REQUIRE(reconnect_policy::DFLT_MIN_DELAY == policy.get_min_delay());
+    REQUIRE(reconnect_policy::DFLT_MAX_DELAY == policy.get_max_delay());
+    REQUIRE(2.0 == policy.get_multiplier());
+    REQUIRE(0.5 == policy.get_jitter());
+    REQUIRE(0 == policy.get_max_attempts());
+    REQUIRE(policy.get_rotate_servers());
+    REQUIRE(policy.get_resubscribe());
+}
+
+TEST_CASE("reconnect_policy setters", "[reconnect]")
+{
+    reconnect_policy policy{seconds(2), seconds(1)};
+
+    // The maximum is raised to the minimum
+    REQUIRE(seconds(2) == policy.get_min_delay());
+    REQUIRE(seconds(2) == policy.get_max_delay());
+
+    policy.set_multiplier(0.5);
+    REQUIRE(1.0 == policy.get_multiplier());
+
+    policy.set_jitter(-1.0);
+    REQUIRE(0.0 == policy.get_jitter());
+    policy.set_jitter(2.0);
+    REQUIRE(1.0 == policy.get_jitter());
+
+    policy.set_max_attempts(3);
+    REQUIRE(3 == policy.get_max_attempts());
+
+    policy.set_rotate_servers(false);
+    REQUIRE(!policy.get_rotate_servers());
+
+    policy.set_resubscribe(false);
+    REQUIRE(!policy.get_resubscribe());
+}
+
+TEST_CASE("reconnect_policy backoff", "[reconnect]")
+{
+    reconnect_policy policy{milliseconds(100), seconds(1)};
+    policy.set_jitter(0.0);
+
+    REQUIRE(milliseconds(100) == policy.get_delay(0, 0.9));
+    REQUIRE(milliseconds(200) == policy.get_delay(1, 0.9));
+    REQUIRE(milliseconds(400) == policy.get_delay(2, 0.9));
+    REQUIRE(milliseconds(800) == policy.get_delay(3, 0.9));
+    REQUIRE(seconds(1) == policy.get_delay(4, 0.9));
+    REQUIRE(seconds(1) == policy.get_delay(100, 0.9));
+}
+
+TEST_CASE("reconnect_policy jitter", "[reconnect]")
+{
+    reconnect_policy policy{milliseconds(1000), seconds(10)};
+
+    policy.set_jitter(0.5);
+    REQUIRE(milliseconds(1000) == policy.get_delay(0, 0.0));
+    REQUIRE(milliseconds(750) == policy.get_delay(0, 0.5));
+    REQUIRE(milliseconds(2000) == policy.get_delay(1, 0.0));
+    REQUIRE(milliseconds(1000) == policy.get_delay(1, 1.0));
+
+    policy.set_jitter(1.0);
+    REQUIRE(milliseconds(0) == policy.get_delay(0, 1.0));
+    REQUIRE(milliseconds(100) == policy.get_delay(0, 0.9));
+}
@@ -0,0 +1,101 @@
+// test_rpc_client.cpp
+//
+// Unit tests for the rpc_client class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <stdexcept>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/create_options.h"
+#include "mqtt/rpc_client.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+static const std::string SERVER_URI{"tcp://localhost:1883"};
+static const std::string CLIENT_ID{"test_rpc_client"};
+
+TEST_CASE("rpc_client ctor", "[rpc]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID, create_options{MQTTVERSION_5}, nullptr};
+
+    SECTION("default response topic")
+    {
+        rpc_client rpc{cli};
+        REQUIRE(("replies/" + CLIENT_ID + "/rpc") == rpc.get_response_topic());
+        REQUIRE(rpc_client::DFLT_QOS == rpc.get_qos());
+        REQUIRE(0 == rpc.num_pending());
+        REQUIRE(0 == rpc.num_timeouts());
+        REQUIRE(0 == rpc.num_unmatched());
+    }
+
+    SECTION("explicit response topic")
+    {
+        rpc_client rpc{cli, "my/replies", 2};
+        REQUIRE("my/replies" == rpc.get_response_topic());
+        REQUIRE(2 == rpc.get_qos());
+    }
+}
+
+TEST_CASE("rpc_client ctor without client id", "[rpc]")
+{
+    async_client cli{SERVER_URI, "", create_options{MQTTVERSION_5}, nullptr};
+
+    REQUIRE_THROWS_AS(rpc_client(cli), std::invalid_argument);
+    REQUIRE_NOTHROW(rpc_client(cli, "my/replies"));
+}
+
+TEST_CASE("rpc_client call failure", "[rpc]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID, create_options{MQTTVERSION_5}, nullptr};
+    rpc_client rpc{cli};
+
+    SECTION("handler")
+    {
+        bool called = false;
+        REQUIRE_THROWS_AS(
+            rpc.call(
+                "requests/add", "[1,2]", seconds(5),
+                [&called](const_message_ptr, std::exception_ptr) { called = true; }
+            ),
+            exception
+        );
+        REQUIRE(!called);
+    }
+
+    SECTION("future")
+    {
+        REQUIRE_THROWS_AS(rpc.call("requests/add", "[1,2]", seconds(5)), exception);
+    }
+
+    REQUIRE(0 == rpc.num_pending());
+}
+
+TEST_CASE("rpc_client stop", "[rpc]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID, create_options{MQTTVERSION_5}, nullptr};
+    rpc_client rpc{cli};
+
+    REQUIRE_NOTHROW(rpc.stop());
+    REQUIRE_NOTHROW(rpc.stop());
+}
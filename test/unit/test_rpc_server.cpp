@@ -0,0 +1,65 @@
+// test_rpc_server.cpp
+//
+// Unit tests for the rpc_server class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/create_options.h"
+#include "mqtt/rpc_server.h"
+
+using namespace mqtt;
+
+static const std::string SERVER_URI{"tcp://localhost:1883"};
+static const std::string CLIENT_ID{"test_rpc_server"};
+
+static binary echo(const_message_ptr req) { return req->get_payload(); }
+
+TEST_CASE("rpc_server ctor", "[rpc]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID, create_options{MQTTVERSION_5}, nullptr};
+
+    SECTION("defaults")
+    {
+        rpc_server srvr{cli, "requests/#", echo};
+        REQUIRE("requests/#" == srvr.get_request_filter());
+        REQUIRE(srvr.num_workers() > 0);
+        REQUIRE(0 == srvr.num_pending());
+        REQUIRE(0 == srvr.num_replies());
+        REQUIRE(0 == srvr.num_errors());
+    }
+
+    SECTION("workers")
+    {
+        rpc_server srvr{cli, "$share/math/requests/#", echo, 3};
+        REQUIRE("$share/math/requests/#" == srvr.get_request_filter());
+        REQUIRE(3 == srvr.num_workers());
+    }
+}
+
+TEST_CASE("rpc_server stop", "[rpc]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID, create_options{MQTTVERSION_5}, nullptr};
+    rpc_server srvr{cli, "requests/#", echo, 2};
+
+    REQUIRE_NOTHROW(srvr.stop());
+    REQUIRE_NOTHROW(srvr.stop());
+}
@@ -0,0 +1,167 @@
+// test_shm_fanout.cpp
+//
+// Unit tests for the shm_fanout_writer and shm_fanout_reader classes in the
+// Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/shm_fanout.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+// --------------------------------------------------------------------------
+
+static std::string ring_name(const std::string& tag) {
+    return "/paho-test-" + tag + "-" + std::to_string(::getpid());
+}
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("shm_fanout read", "[shm_fanout]")
+{
+    const auto NAME = ring_name("read");
+    shm_fanout_writer fan{NAME, 64 * 1024};
+    REQUIRE(NAME == fan.name());
+    REQUIRE(64 * 1024 <= fan.capacity());
+
+    shm_fanout_reader all{NAME}, temps{NAME};
+    temps.add_filter("sensors/+/temp");
+
+    properties props{{property::USER_PROPERTY, "unit", "C"}};
+    auto msg = message::create("sensors/1/temp", "21.5", 1, true, props);
+    fan.write(*msg);
+    fan.write(*message::create("sensors/1/humidity", "40", 0, false));
+    REQUIRE(2 == fan.num_written());
+
+    std::vector<const_message_ptr> msgs;
+    REQUIRE(2 == all.poll([&msgs](const_message_ptr m) { msgs.push_back(m); }));
+    REQUIRE(0 == all.lag());
+
+    REQUIRE("sensors/1/temp" == msgs[0]->get_topic());
+    REQUIRE("21.5" == msgs[0]->to_string());
+    REQUIRE(1 == msgs[0]->get_qos());
+    REQUIRE(msgs[0]->is_retained());
+    auto up = get<string_pair>(msgs[0]->get_properties(), property::USER_PROPERTY);
+    REQUIRE("C" == std::get<1>(up));
+    REQUIRE("sensors/1/humidity" == msgs[1]->get_topic());
+
+    // The payload is a view into the ring, not a copy
+    REQUIRE(msg->get_payload_ref().data() != msgs[0]->get_payload_ref().data());
+
+    std::string topic;
+    REQUIRE(1 == temps.poll([&topic](const_message_ptr m) { topic = m->get_topic(); }));
+    REQUIRE("sensors/1/temp" == topic);
+    REQUIRE(1 == temps.num_read());
+    REQUIRE(1 == temps.num_filtered());
+
+    // Nothing more to read
+    REQUIRE(0 == all.poll([](const_message_ptr) {}));
+    REQUIRE(!all.try_consume_for(milliseconds(5)));
+}
+
+TEST_CASE("shm_fanout wrap", "[shm_fanout]")
+{
+    const auto NAME = ring_name("wrap");
+    shm_fanout_writer fan{NAME, 4096};
+    const size_t CAP = fan.capacity();
+
+    shm_fanout_reader rdr{NAME};
+    const std::string PAYLOAD(100, 'x');
+
+    // Keeping up with the writer, across many wraps of the ring
+    size_t n = 0;
+    for (int i = 0; i < 1000; ++i) {
+        fan.write(*message::create("t/" + std::to_string(i), PAYLOAD));
+        rdr.poll([&n, i](const_message_ptr m) {
+            if (m->get_topic() == "t/" + std::to_string(i))
+                ++n;
+        });
+    }
+    REQUIRE(1000 == n);
+    REQUIRE(0 == rdr.num_lost());
+
+    // Falling behind by more than the ring loses what was overwritten
+    const size_t N = 4 * CAP / 128;
+    for (size_t i = 0; i < N; ++i) fan.write(*message::create("t/lost", PAYLOAD));
+    REQUIRE(0 == rdr.poll([](const_message_ptr) {}));
+    REQUIRE(0 == rdr.lag());
+
+    std::string topic;
+    fan.write(*message::create("t/last", PAYLOAD));
+    REQUIRE(1 == rdr.poll([&topic](const_message_ptr m) { topic = m->get_topic(); }));
+    REQUIRE("t/last" == topic);
+    REQUIRE(N == rdr.num_lost());
+
+    // A message that can't fit is dropped
+    REQUIRE(!fan.write(*message::create("t/big", std::string(CAP, 'x'))));
+    REQUIRE(1 == fan.num_dropped());
+}
+
+TEST_CASE("shm_fanout consume", "[shm_fanout]")
+{
+    const auto NAME = ring_name("consume");
+    shm_fanout_reader::ptr_t rdr;
+    {
+        shm_fanout_writer fan{NAME, 4096};
+        rdr = std::make_shared<shm_fanout_reader>(NAME);
+        fan.write(*message::create("a/b", "hello"));
+    }
+
+    // The copy outlives the ring
+    REQUIRE_THROWS_AS(shm_fanout_reader{NAME}, mqtt::exception);
+    auto msg = rdr->try_consume_for(milliseconds(5));
+    rdr.reset();
+
+    REQUIRE(msg);
+    REQUIRE("a/b" == msg->get_topic());
+    REQUIRE("hello" == msg->to_string());
+}
+
+TEST_CASE("async_client shm fan-out", "[shm_fanout]")
+{
+    const auto NAME = ring_name("client");
+    shm_fanout_writer fan{NAME, 64 * 1024};
+    shm_fanout_reader rdr{NAME};
+
+    async_client cli{"tcp://localhost:1883", "test_shm_fanout"};
+    cli.set_message_tracer(fan);
+    cli.start_consuming();
+
+    const std::string PAYLOAD{"payload"};
+    cli.test_message_arrived("a/b", PAYLOAD.data(), PAYLOAD.size());
+    cli.test_message_arrived("a/c", PAYLOAD.data(), PAYLOAD.size());
+
+    std::vector<std::string> topics;
+    rdr.poll_for(
+        [&topics](const_message_ptr m) { topics.push_back(m->get_topic()); }, seconds(1)
+    );
+    REQUIRE(2 == topics.size());
+    REQUIRE("a/b" == topics[0]);
+    REQUIRE("a/c" == topics[1]);
+}
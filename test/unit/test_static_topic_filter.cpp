@@ -0,0 +1,155 @@
+// test_static_topic_filter.cpp
+//
+// Unit tests for the static_topic_filter and static_topic_matcher classes
+// in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/static_topic_filter.h"
+#include "mqtt/topic.h"
+
+using namespace mqtt;
+using namespace mqtt::literals;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// These are checked by the compiler
+
+constexpr static_topic_filter TEMP{"plant/+/line/+/temp"};
+
+static_assert(TEMP.has_wildcards());
+static_assert(TEMP.num_levels() == 5);
+static_assert(TEMP.matches("plant/a/line/2/temp"));
+static_assert(!TEMP.matches("plant/a/line/2/pressure"));
+static_assert(!TEMP.matches("plant/a/line/temp"));
+static_assert(!TEMP.matches("plant/a/line/2/temp/x"));
+
+constexpr auto ALARMS = "plant/+/alarm/#"_filter;
+static_assert(ALARMS.matches("plant/a/alarm/fire"));
+static_assert(ALARMS.matches("plant/a/alarm/fire/zone/3"));
+static_assert(!ALARMS.matches("plant/a/status"));
+
+constexpr auto ROUTES = make_static_topic_matcher<int>({
+    {"plant/+/line/+/temp", 1},
+    {"plant/+/alarm/#", 2},
+    {"plant/a/alarm/fire", 3},
+});
+
+static_assert(ROUTES.size() == 3);
+static_assert(*ROUTES.find_first("plant/a/line/1/temp") == 1);
+static_assert(*ROUTES.find_first("plant/a/alarm/fire") == 2);
+static_assert(*ROUTES.find("plant/a/alarm/fire") == 3);
+static_assert(ROUTES.find_first("plant/a/status") == nullptr);
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("static_topic_filter validation", "[topic]")
+{
+    REQUIRE_NOTHROW(static_topic_filter{"a/b/c"});
+    REQUIRE_NOTHROW(static_topic_filter{"+"});
+    REQUIRE_NOTHROW(static_topic_filter{"#"});
+    REQUIRE_NOTHROW(static_topic_filter{"+/+/#"});
+    REQUIRE_NOTHROW(static_topic_filter{"a//b"});
+
+    REQUIRE_THROWS_AS(static_topic_filter{""}, std::invalid_argument);
+    REQUIRE_THROWS_AS(static_topic_filter{"a/#/c"}, std::invalid_argument);
+    REQUIRE_THROWS_AS(static_topic_filter{"a/b#"}, std::invalid_argument);
+    REQUIRE_THROWS_AS(static_topic_filter{"a/b+/c"}, std::invalid_argument);
+    REQUIRE_THROWS_AS(static_topic_filter{"a/+b"}, std::invalid_argument);
+}
+
+TEST_CASE("static_topic_filter basics", "[topic]")
+{
+    static_topic_filter empty;
+    REQUIRE(empty.empty());
+    REQUIRE(0 == empty.num_levels());
+    REQUIRE(!empty.matches(""));
+    REQUIRE(!empty.matches("a"));
+
+    static_topic_filter plain{"a/b/c"};
+    REQUIRE(!plain.has_wildcards());
+    REQUIRE("a/b/c" == plain.to_string());
+    REQUIRE(plain.matches("a/b/c"));
+    REQUIRE(!plain.matches("a/b"));
+
+    REQUIRE(plain == static_topic_filter{"a/b/c"});
+    REQUIRE(plain != static_topic_filter{"a/+/c"});
+}
+
+// The static filters have to agree with the regular ones.
+
+TEST_CASE("static_topic_filter matches like topic_filter", "[topic]")
+{
+    const std::vector<string> filters{
+        "a/b/c", "+", "#", "a/+", "a/#", "a/+/c", "+/b/#", "+/+/+", "$SYS/#", "$SYS/+",
+        "a//c", "a/+/", "/+", "+/#",
+    };
+    const std::vector<string> topics{
+        "a", "a/b", "a/b/c", "a/b/c/d", "a/", "a//c", "/a", "/", "x/b/c", "$SYS/info",
+        "$SYS", "a/x/c", "",
+    };
+
+    for (const auto& f : filters) {
+        topic_filter rtf{f};
+        static_topic_filter stf{f};
+
+        for (const auto& t : topics) {
+            INFO("filter: " << f << ", topic: " << t);
+            REQUIRE(rtf.matches(t) == stf.matches(t));
+        }
+    }
+}
+
+TEST_CASE("static_topic_matcher", "[topic]")
+{
+    const auto routes = make_static_topic_matcher<string>({
+        {"plant/+/temp", "temp"},
+        {"plant/#", "all"},
+        {"office/+", "office"},
+    });
+
+    std::vector<string> got;
+    auto n = routes.for_each_match("plant/a/temp", [&](const auto& e) {
+        got.push_back(e.second);
+    });
+
+    REQUIRE(2 == n);
+    REQUIRE(2 == got.size());
+    REQUIRE("temp" == got[0]);
+    REQUIRE("all" == got[1]);
+
+    REQUIRE(routes.has_match("office/3"));
+    REQUIRE(!routes.has_match("office/3/x"));
+    REQUIRE(nullptr == routes.find("office/#"));
+
+    std::size_t count = 0;
+    for (const auto& e : routes) {
+        REQUIRE(!e.first.empty());
+        ++count;
+    }
+    REQUIRE(3 == count);
+
+    REQUIRE_THROWS_AS(make_static_topic_matcher<int>({{"a/#/c", 1}}), std::invalid_argument);
+}
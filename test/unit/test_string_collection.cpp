@@ -307,6 +307,31 @@ TEST_CASE("string_collection push cstr", "[collections]")
     REQUIRE(0 == strcmp(VEC[2].c_str(), c_arr[2]));
 }
 
+// ----------------------------------------------------------------------
+// Test that the C array stays valid as a large collection grows
+// ----------------------------------------------------------------------
+
+TEST_CASE("string_collection push many", "[collections]")
+{
+    const size_t N = 1000;
+    string_collection sc;
+
+    // Short strings, which move their data when the vector grows
+    for (size_t i = 0; i < N; ++i) sc.push_back(std::to_string(i));
+
+    REQUIRE(N == sc.size());
+
+    auto c_arr = sc.c_arr();
+    for (size_t i = 0; i < N; ++i) REQUIRE(sc[i].c_str() == c_arr[i]);
+
+    string_collection rsc;
+    rsc.reserve(N);
+    for (size_t i = 0; i < N; ++i) rsc.push_back(std::to_string(i));
+
+    c_arr = rsc.c_arr();
+    for (size_t i = 0; i < N; ++i) REQUIRE(rsc[i].c_str() == c_arr[i]);
+}
+
 // ----------------------------------------------------------------------
 // Test the clear method
 // ----------------------------------------------------------------------
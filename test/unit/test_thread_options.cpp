@@ -0,0 +1,115 @@
+// test_thread_options.cpp
+//
+// Unit tests for the thread_options class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <pthread.h>
+#endif
+
+#include "catch2_version.h"
+#include "mqtt/create_options.h"
+#include "mqtt/thread_options.h"
+
+using namespace mqtt;
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("thread_options default", "[thread_options]")
+{
+    thread_options opts;
+    REQUIRE(opts.empty());
+    REQUIRE(!opts.get_name_threads());
+    REQUIRE(opts.get_affinity().empty());
+    REQUIRE(0 == opts.get_priority());
+    REQUIRE(!opts.get_start_handler());
+
+    opts.set_name_threads(true);
+    REQUIRE(!opts.empty());
+
+    REQUIRE("mqtt-callback" == thread_role_name(thread_role::CLIENT_CALLBACK));
+    REQUIRE("mqtt-reconnect" == thread_role_name(thread_role::RECONNECT));
+    REQUIRE(thread_role_name(thread_role::RECONNECT).size() <= 15);
+}
+
+TEST_CASE("thread_options apply", "[thread_options]")
+{
+    thread_role role = thread_role::CLIENT_CALLBACK;
+    string name;
+
+    thread_options opts;
+    opts.set_name_threads(true);
+    opts.set_start_handler([&](thread_role r, const string& nm) {
+        role = r;
+        name = nm;
+        throw std::runtime_error("ignored");
+    });
+
+    string threadName;
+    std::thread thr{[&] {
+        opts.apply(thread_role::RECONNECT);
+#if defined(__linux__)
+        char buf[16];
+        if (pthread_getname_np(pthread_self(), buf, sizeof(buf)) == 0)
+            threadName = buf;
+#endif
+    }};
+    thr.join();
+
+    REQUIRE(thread_role::RECONNECT == role);
+    REQUIRE("mqtt-reconnect" == name);
+#if defined(__linux__)
+    REQUIRE("mqtt-reconnect" == threadName);
+#endif
+}
+
+#if defined(__linux__)
+TEST_CASE("thread_options affinity", "[thread_options]")
+{
+    bool ok = false;
+    std::thread thr{[&ok] { ok = set_current_thread_affinity({0}); }};
+    thr.join();
+    REQUIRE(ok);
+
+    REQUIRE(!set_current_thread_affinity({-1}));
+}
+#endif
+
+TEST_CASE("create_options thread options", "[thread_options]")
+{
+    thread_options topts;
+    topts.set_affinity({0, 1});
+
+    auto opts = create_options_builder().thread_options(topts).finalize();
+    REQUIRE(std::vector<int>{0, 1} == opts.get_thread_options().get_affinity());
+
+    create_options copy{opts};
+    REQUIRE(std::vector<int>{0, 1} == copy.get_thread_options().get_affinity());
+
+    create_options assigned;
+    assigned = opts;
+    REQUIRE(!assigned.get_thread_options().empty());
+}
@@ -23,16 +23,36 @@
 
 #include <chrono>
 #include <future>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include "catch2_version.h"
+#include "mqtt/event.h"
 #include "mqtt/thread_queue.h"
 #include "mqtt/types.h"
 
 using namespace mqtt;
 using namespace std::chrono;
 
+namespace {
+
+// An item with a key and a size, for the byte capacity and conflation
+struct blob
+{
+    char key;
+    size_t n;
+};
+
+}  // namespace
+
+template <>
+struct mqtt::thread_queue_traits<blob>
+{
+    static std::size_t size_of(const blob& b) noexcept { return b.n; }
+    static bool conflates(const blob& a, const blob& b) noexcept { return a.key == b.key; }
+};
+
 TEST_CASE("thread_queue put/get", "[thread_queue]")
 {
     thread_queue<int> que;
@@ -89,6 +109,40 @@ TEST_CASE("thread_queue tryput", "[thread_queue]")
     REQUIRE(!que.try_put_until(3, timeout));
 }
 
+TEST_CASE("thread_queue batch get", "[thread_queue]")
+{
+    thread_queue<int> que{8};
+    std::vector<int> v;
+
+    // Nothing to get from an empty queue
+    REQUIRE(que.try_get_n(&v, 4) == 0);
+    REQUIRE(que.try_get_n_for(&v, 4, 5ms) == 0);
+    REQUIRE(que.try_get_n_until(&v, 4, steady_clock::now() + 5ms) == 0);
+    REQUIRE(v.empty());
+
+    for (int i = 1; i <= 6; ++i) que.put(i);
+
+    REQUIRE(que.try_get_n(&v, 4) == 4);
+    REQUIRE(v == std::vector<int>{1, 2, 3, 4});
+
+    // Values are appended to the vector
+    REQUIRE(que.try_get_n_for(&v, 4, 5ms) == 2);
+    REQUIRE(v == std::vector<int>{1, 2, 3, 4, 5, 6});
+    REQUIRE(que.empty());
+
+    v.clear();
+    que.put(7);
+    que.put(8);
+    REQUIRE(que.get_all(&v) == 2);
+    REQUIRE(v == std::vector<int>{7, 8});
+
+    // Closed and empty, get_all() returns without blocking
+    v.clear();
+    que.close();
+    REQUIRE(que.get_all(&v) == 0);
+    REQUIRE(v.empty());
+}
+
 TEST_CASE("thread_queue mt put/get", "[thread_queue]")
 {
     thread_queue<string> que;
@@ -185,3 +239,123 @@ TEST_CASE("thread_queue close_signals", "[thread_queue]")
 
     thr.join();
 }
+
+TEST_CASE("thread_queue byte capacity", "[thread_queue]")
+{
+    thread_queue<blob> que{100, 1000};
+    REQUIRE(1000 == que.byte_capacity());
+    REQUIRE(thread_queue<blob>::BLOCK == que.policy());
+
+    REQUIRE(que.try_put(blob{'a', 600}));
+    REQUIRE(que.try_put(blob{'b', 400}));
+    REQUIRE(1000 == que.bytes());
+
+    // Full by bytes, not by count
+    REQUIRE(!que.try_put(blob{'c', 1}));
+    REQUIRE(!que.try_put_for(blob{'c', 1}, 5ms));
+    REQUIRE(0 == que.num_dropped());
+
+    blob b;
+    REQUIRE(que.try_get(&b));
+    REQUIRE(400 == que.bytes());
+    REQUIRE(que.try_put(blob{'c', 600}));
+
+    // A single item bigger than the capacity fits in an empty queue
+    que.clear();
+    REQUIRE(0 == que.bytes());
+    REQUIRE(que.try_put(blob{'d', 5000}));
+    REQUIRE(!que.try_put(blob{'e', 1}));
+
+    // Raising the capacity releases a blocked producer
+    auto fut = std::async(std::launch::async, [&que] { que.put(blob{'f', 100}); });
+    std::this_thread::sleep_for(10ms);
+    que.byte_capacity(10000);
+    fut.get();
+    REQUIRE(2 == que.size());
+}
+
+TEST_CASE("thread_queue overflow policies", "[thread_queue]")
+{
+    blob b;
+
+    SECTION("drop newest")
+    {
+        thread_queue<blob> que{2, 1000, thread_queue<blob>::DROP_NEWEST};
+        que.put(blob{'a', 1});
+        que.put(blob{'b', 1});
+        que.put(blob{'c', 1});
+        REQUIRE(!que.try_put(blob{'d', 1}));
+
+        REQUIRE(2 == que.size());
+        REQUIRE(2 == que.num_dropped());
+        REQUIRE(que.try_get(&b));
+        REQUIRE('a' == b.key);
+    }
+
+    SECTION("drop oldest")
+    {
+        thread_queue<blob> que{10, 1000, thread_queue<blob>::DROP_OLDEST};
+        que.put(blob{'a', 400});
+        que.put(blob{'b', 400});
+        que.put(blob{'c', 100});
+
+        // Makes room for a big one, without blocking
+        que.put(blob{'d', 800});
+        REQUIRE(2 == que.size());
+        REQUIRE(900 == que.bytes());
+        REQUIRE(2 == que.num_dropped());
+        REQUIRE(que.try_get(&b));
+        REQUIRE('c' == b.key);
+    }
+
+    SECTION("conflate")
+    {
+        thread_queue<blob> que{3};
+        que.policy(thread_queue<blob>::CONFLATE);
+
+        que.put(blob{'a', 1});
+        que.put(blob{'b', 1});
+        que.put(blob{'a', 1});
+
+        // Replaces the newest 'a' in place
+        que.put(blob{'a', 2});
+        REQUIRE(3 == que.size());
+        REQUIRE(1 == que.num_conflated());
+        REQUIRE(0 == que.num_dropped());
+
+        // Nothing to replace, so the oldest goes
+        que.put(blob{'c', 1});
+        REQUIRE(1 == que.num_dropped());
+
+        std::vector<blob> v;
+        REQUIRE(3 == que.try_get_n(&v, 10));
+        REQUIRE('b' == v[0].key);
+        REQUIRE('a' == v[1].key);
+        REQUIRE(2 == v[1].n);
+        REQUIRE('c' == v[2].key);
+    }
+}
+
+TEST_CASE("thread_queue of events", "[thread_queue]")
+{
+    const std::string BIG(1000, 'x');
+
+    thread_queue<event> que{2, 1000000, thread_queue<event>::CONFLATE};
+    que.put(event{make_message("a", BIG)});
+    que.put(event{make_message("b", BIG)});
+    auto n = que.bytes();
+    REQUIRE(n > 2000);
+
+    // A message on a pending topic takes its place
+    que.put(event{make_message("a", "new")});
+    REQUIRE(2 == que.size());
+    REQUIRE(1 == que.num_conflated());
+    REQUIRE(n - 997 == que.bytes());
+
+    // Other events are never conflated, so the oldest is dropped
+    que.put(event{connected_event{}});
+    REQUIRE(1 == que.num_dropped());
+
+    REQUIRE("b" == que.get().get_message()->get_topic());
+    REQUIRE(que.get().is_connected());
+}
@@ -0,0 +1,223 @@
+// test_timer_wheel.cpp
+//
+// Unit tests for the timer_wheel class, and the operation deadlines of the
+// async_client, in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/timer_wheel.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+namespace {
+
+const std::string SERVER_URI{"tcp://localhost:1883"};
+const std::string CLIENT_ID{"test_timer_wheel"};
+const std::string TOPIC{"topic"};
+
+using clock_type = timer_wheel::clock;
+
+// Waits for a count to reach a value, for up to a couple of seconds.
+template <class Func>
+bool wait_for(Func f, size_t n)
+{
+    for (int i = 0; i < 200 && f() < n; ++i) std::this_thread::sleep_for(10ms);
+    return f() >= n;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("timer_wheel fires in order", "[timer_wheel]")
+{
+    timer_wheel wheel{100us};
+    REQUIRE(duration_cast<microseconds>(wheel.get_tick()).count() == 100);
+    REQUIRE(wheel.empty());
+
+    std::mutex mtx;
+    std::vector<int> order;
+    auto add = [&](int n) {
+        return [&, n] {
+            std::lock_guard<std::mutex> g{mtx};
+            order.push_back(n);
+        };
+    };
+
+    auto now = clock_type::now();
+    wheel.schedule_at(now + 30ms, add(3));
+    wheel.schedule_at(now + 10ms, add(1));
+    wheel.schedule_at(now + 20ms, add(2));
+    wheel.schedule_at(now + 20ms, add(22));
+    REQUIRE(4 == wheel.size());
+
+    REQUIRE(wait_for([&wheel] { return wheel.num_fired(); }, 4));
+    REQUIRE(wheel.empty());
+    std::lock_guard<std::mutex> g{mtx};
+    REQUIRE((std::vector<int>{1, 2, 22, 3}) == order);
+}
+
+TEST_CASE("timer_wheel never fires early", "[timer_wheel]")
+{
+    // With a short tick, these reach up through the upper wheels
+    timer_wheel wheel{20us};
+
+    const int N = 2000;
+    std::atomic<int> nEarly{0};
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> dist{0, 60'000};
+
+    for (int i = 0; i < N; ++i) {
+        auto deadline = clock_type::now() + microseconds(dist(rng));
+        wheel.schedule_at(deadline, [&nEarly, deadline] {
+            if (clock_type::now() < deadline)
+                ++nEarly;
+        });
+    }
+
+    REQUIRE(wait_for([&wheel] { return wheel.num_fired(); }, N));
+    REQUIRE(0 == nEarly);
+    REQUIRE(wheel.empty());
+}
+
+TEST_CASE("timer_wheel past deadline", "[timer_wheel]")
+{
+    timer_wheel wheel;
+    std::atomic<bool> fired{false};
+
+    auto id = wheel.schedule_at(clock_type::now() - 1s, [&fired] { fired = true; });
+    REQUIRE(id != 0);
+    REQUIRE(wait_for([&fired] { return size_t(fired.load()); }, 1));
+}
+
+TEST_CASE("timer_wheel cancel", "[timer_wheel]")
+{
+    timer_wheel wheel;
+    std::atomic<int> n{0};
+
+    auto id = wheel.schedule_after(50ms, [&n] { ++n; });
+    auto id2 = wheel.schedule_after(1ms, [&n] { ++n; });
+    REQUIRE(id != id2);
+    REQUIRE(wheel.cancel(id));
+    REQUIRE(!wheel.cancel(id));
+    REQUIRE(!wheel.cancel(0));
+
+    REQUIRE(wait_for([&wheel] { return wheel.num_fired(); }, 1));
+    REQUIRE(!wheel.cancel(id2));
+
+    std::this_thread::sleep_for(80ms);
+    REQUIRE(1 == n);
+    REQUIRE(1 == wheel.num_fired());
+}
+
+TEST_CASE("timer_wheel cancel waits for a running timer", "[timer_wheel]")
+{
+    timer_wheel wheel;
+    std::atomic<bool> started{false}, done{false};
+
+    auto id = wheel.schedule_after(1ms, [&] {
+        started = true;
+        std::this_thread::sleep_for(50ms);
+        done = true;
+    });
+
+    REQUIRE(wait_for([&started] { return size_t(started.load()); }, 1));
+    REQUIRE(!wheel.cancel(id));
+    REQUIRE(done);
+}
+
+TEST_CASE("timer_wheel stop", "[timer_wheel]")
+{
+    timer_wheel wheel;
+    std::atomic<int> n{0};
+
+    wheel.schedule_after(1h, [&n] { ++n; });
+    REQUIRE(1 == wheel.size());
+
+    wheel.stop();
+    REQUIRE(wheel.empty());
+    REQUIRE(0 == wheel.schedule_after(1ms, [&n] { ++n; }));
+    wheel.stop();
+    REQUIRE(0 == n);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("async_client operation timeout", "[timer_wheel]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    REQUIRE(cli.get_operation_timeout() == steady_clock::duration::zero());
+    REQUIRE(cli.get_timer_wheel());
+    REQUIRE(cli.get_timer_wheel() == cli.get_timer_wheel());
+
+    cli.set_operation_timeout(20ms);
+    REQUIRE(cli.get_operation_timeout() == 20ms);
+
+    // The buffered message waits for a connection that never comes
+    cli.start_offline_buffering();
+    auto tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(!tok->is_complete());
+
+    REQUIRE_THROWS_AS(tok->wait_for(2s), exception);
+    REQUIRE(tok->is_timed_out());
+    REQUIRE(MQTTASYNC_FAILURE == tok->get_return_code());
+    REQUIRE("Timeout" == tok->get_error_message());
+
+    // It stays with the client until the library is done with it
+    REQUIRE(1 == cli.get_metrics().num_pending_delivery_tokens());
+    cli.stop_offline_buffering();
+    REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+    REQUIRE(MQTTASYNC_FAILURE == tok->get_return_code());
+}
+
+TEST_CASE("async_client deadline cancelled on completion", "[timer_wheel]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    auto wheel = cli.get_timer_wheel();
+
+    cli.start_offline_buffering();
+    auto tok = cli.publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(wheel->empty());
+
+    REQUIRE(cli.set_deadline(tok, steady_clock::now() + 1h));
+    REQUIRE(1 == wheel->size());
+
+    // The new deadline replaces the old one
+    REQUIRE(cli.set_deadline(tok, steady_clock::now() + 2h));
+    REQUIRE(1 == wheel->size());
+
+    // Dropping the buffer fails the token, which cancels its timer
+    cli.stop_offline_buffering();
+    REQUIRE(tok->is_complete());
+    REQUIRE(!tok->is_timed_out());
+    REQUIRE(wheel->empty());
+    REQUIRE(!cli.set_deadline(tok, steady_clock::now() + 1h));
+}
@@ -28,10 +28,12 @@
 #define UNIT_TESTS
 
 #include <cstring>
+#include <thread>
 
 #include "catch2_version.h"
 #include "mock_action_listener.h"
 #include "mock_async_client.h"
+#include "mqtt/delivery_token.h"
 #include "mqtt/token.h"
 
 using namespace mqtt;
@@ -358,3 +360,95 @@ TEST_CASE("token wait for timeout", "[token]")
         FAIL("token::wait_until() should not throw on timeout");
     }
 }
+
+// ----------------------------------------------------------------------
+// Test that a thread waiting on a token is woken by the completion
+// ----------------------------------------------------------------------
+
+TEST_CASE("token wait from another thread", "[token]")
+{
+    auto tok = token::create(token::Type::PUBLISH, cli);
+
+    std::thread thr([tok] {
+        std::this_thread::sleep_for(milliseconds(10));
+        MQTTAsync_successData data{};
+        mock_async_client::succeed(tok.get(), &data);
+    });
+
+    REQUIRE(tok->wait_for(milliseconds(5000)));
+    REQUIRE(tok->is_complete());
+    thr.join();
+}
+
+// ----------------------------------------------------------------------
+// Test the delivery token, which is recycled through a pool
+// ----------------------------------------------------------------------
+
+TEST_CASE("delivery token pooled", "[token]")
+{
+    auto msg = message::create("some/topic", "payload", 1, false);
+
+    const void* prev;
+    {
+        auto tok = delivery_token::create(cli, msg);
+        prev = tok.get();
+
+        REQUIRE(msg == tok->get_message());
+        REQUIRE(tok->get_topics());
+        REQUIRE(1 == tok->get_topics()->size());
+        REQUIRE("some/topic" == (*tok->get_topics())[0]);
+
+        MQTTAsync_successData data{};
+        mock_async_client::succeed(tok.get(), &data);
+        REQUIRE(tok->is_complete());
+    }
+
+    // The memory for a released token is handed out for the next one
+    auto tok = delivery_token::create(cli, msg);
+    REQUIRE(prev == tok.get());
+    REQUIRE(!tok->is_complete());
+
+    REQUIRE(!delivery_token::create(cli)->get_topics());
+}
+
+// ----------------------------------------------------------------------
+// Test the completion handler, used to resume coroutines
+// ----------------------------------------------------------------------
+
+TEST_CASE("token complete handler", "[token]")
+{
+    SECTION("called on success")
+    {
+        mqtt::token tok{token::Type::PUBLISH, cli};
+        int nCalls = 0;
+        REQUIRE(tok.set_complete_handler([&nCalls] { ++nCalls; }));
+        REQUIRE(0 == nCalls);
+
+        MQTTAsync_successData data{};
+        mock_async_client::succeed(&tok, &data);
+        REQUIRE(1 == nCalls);
+    }
+
+    SECTION("called on failure")
+    {
+        mqtt::token tok{token::Type::PUBLISH, cli};
+        bool complete = false;
+        REQUIRE(tok.set_complete_handler([&tok, &complete] { complete = tok.is_complete(); }));
+
+        MQTTAsync_failureData data{};
+        data.code = MQTTASYNC_FAILURE;
+        mock_async_client::fail(&tok, &data);
+        REQUIRE(complete);
+    }
+
+    SECTION("not set once complete")
+    {
+        mqtt::token tok{token::Type::PUBLISH, cli};
+        MQTTAsync_successData data{};
+        mock_async_client::succeed(&tok, &data);
+
+        bool called = false;
+        REQUIRE(!tok.set_complete_handler([&called] { called = true; }));
+        REQUIRE(!called);
+    }
+}
@@ -0,0 +1,146 @@
+// test_token_group.cpp
+//
+// Unit tests for the token_group class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mock_async_client.h"
+#include "mqtt/token_group.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+static mock_async_client cli;
+
+static std::vector<token_ptr> make_toks(size_t n)
+{
+    std::vector<token_ptr> toks;
+    for (size_t i = 0; i < n; ++i)
+        toks.push_back(token::create(token::Type::PUBLISH, cli));
+    return toks;
+}
+
+static void fail(token_ptr tok, int rc)
+{
+    MQTTAsync_failureData data{};
+    data.code = rc;
+    mock_async_client::fail(tok.get(), &data);
+}
+
+// ----------------------------------------------------------------------
+
+TEST_CASE("token_group empty", "[token_group]")
+{
+    token_group grp;
+
+    REQUIRE(grp.empty());
+    REQUIRE(0 == grp.size());
+    REQUIRE(0 == grp.num_pending());
+
+    // Nothing to wait for
+    grp.wait_all();
+    REQUIRE(grp.wait_all_for(milliseconds(0)));
+    REQUIRE(0 == grp.wait_any());
+}
+
+TEST_CASE("token_group counts", "[token_group]")
+{
+    token_group grp;
+    auto toks = make_toks(4);
+
+    for (auto& tok : toks)
+        grp.add(tok);
+    grp.add(token_ptr{});
+
+    REQUIRE(4 == grp.size());
+    REQUIRE(4 == grp.num_pending());
+    REQUIRE(0 == grp.num_complete());
+    REQUIRE(!grp.wait_all_for(milliseconds(10)));
+    REQUIRE(!grp.wait_any_for(milliseconds(10)));
+
+    mock_async_client::succeed(toks[0].get(), nullptr);
+    REQUIRE(1 == grp.num_complete());
+    REQUIRE(1 == grp.wait_any());
+    REQUIRE(grp.wait_any_for(milliseconds(0)));
+    REQUIRE(!grp.wait_all_for(milliseconds(0)));
+
+    fail(toks[1], MQTTASYNC_DISCONNECTED);
+    fail(toks[2], MQTTASYNC_BAD_QOS);
+    mock_async_client::succeed(toks[3].get(), nullptr);
+
+    REQUIRE(grp.wait_all_until(steady_clock::now()));
+    REQUIRE(4 == grp.num_complete());
+    REQUIRE(0 == grp.num_pending());
+    REQUIRE(2 == grp.num_failed());
+    REQUIRE(MQTTASYNC_DISCONNECTED == grp.get_first_return_code());
+}
+
+TEST_CASE("token_group complete token", "[token_group]")
+{
+    token_group grp;
+    auto tok = token::create(token::Type::PUBLISH, cli);
+    mock_async_client::succeed(tok.get(), nullptr);
+
+    grp.add(tok);
+    REQUIRE(1 == grp.num_complete());
+    REQUIRE(0 == grp.num_failed());
+    REQUIRE(MQTTASYNC_SUCCESS == grp.get_first_return_code());
+}
+
+TEST_CASE("token_group wait", "[token_group]")
+{
+    constexpr size_t N = 100;
+
+    token_group grp;
+    auto toks = make_toks(N);
+    for (auto& tok : toks)
+        grp.add(tok);
+
+    std::thread thr{[&toks] {
+        for (auto& tok : toks)
+            mock_async_client::succeed(tok.get(), nullptr);
+    }};
+
+    REQUIRE(grp.wait_any() >= 1);
+    grp.wait_all();
+    thr.join();
+
+    REQUIRE(N == grp.num_complete());
+    REQUIRE(0 == grp.num_failed());
+}
+
+TEST_CASE("token_group outlived", "[token_group]")
+{
+    auto toks = make_toks(2);
+    {
+        token_group grp;
+        grp.add(toks[0]);
+        grp.add(toks[1]);
+        mock_async_client::succeed(toks[0].get(), nullptr);
+    }
+
+    // The last pending token frees the state
+    mock_async_client::succeed(toks[1].get(), nullptr);
+    REQUIRE(toks[1]->is_complete());
+}
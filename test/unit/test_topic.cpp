@@ -191,6 +191,47 @@ TEST_CASE("publish full binary", "[topic]")
     REQUIRE(RETAINED == msg->is_retained());
 }
 
+// ----------------------------------------------------------------------
+// prepared_publisher
+// ----------------------------------------------------------------------
+
+TEST_CASE("prepared publisher", "[topic]")
+{
+    mqtt::topic topic{cli, TOPIC, QOS, RETAINED};
+    properties props{{property::CONTENT_TYPE, "text/plain"}};
+
+    auto pub = topic.prepare(props);
+
+    REQUIRE(static_cast<iasync_client*>(&cli) == &pub.get_client());
+    REQUIRE(TOPIC == pub.get_topic());
+    REQUIRE(QOS == pub.get_qos());
+    REQUIRE(RETAINED == pub.get_retained());
+    REQUIRE(pub.get_properties().contains(property::CONTENT_TYPE));
+
+    auto tok = pub.publish(PAYLOAD);
+    REQUIRE(tok);
+
+    auto msg = tok->get_message();
+    REQUIRE(msg);
+    REQUIRE(TOPIC == msg->get_topic());
+    REQUIRE(PAYLOAD == msg->get_payload());
+    REQUIRE(QOS == msg->get_qos());
+    REQUIRE(RETAINED == msg->is_retained());
+    REQUIRE(msg->get_properties().contains(property::CONTENT_TYPE));
+
+    tok = pub.publish(BUF, N);
+    msg = tok->get_message();
+    REQUIRE(0 == memcmp(BUF, msg->get_payload().data(), N));
+
+    // The messages share a long topic name. Short ones are kept inline.
+    prepared_publisher longPub{cli, string(64, 'x')};
+    auto msg1 = longPub.make_message(PAYLOAD), msg2 = longPub.make_message(PAYLOAD);
+    REQUIRE(msg1->get_topic_ref().data() == msg2->get_topic_ref().data());
+
+    REQUIRE_NOTHROW(pub.send(BUF, N));
+    REQUIRE_THROWS(prepared_publisher(cli, TOPIC, BAD_HIGH_QOS));
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //						topic_filter
 /////////////////////////////////////////////////////////////////////////////
@@ -275,3 +316,44 @@ TEST_CASE("topic matches", "[topic_filter]")
         REQUIRE(!topic_filter{"+/bar"}.matches("$SYS/bar"));
     }
 }
+
+TEST_CASE("topic filter fields", "[topic_filter]")
+{
+    SECTION("literal")
+    {
+        topic_filter filt{"my/topic"};
+        REQUIRE(!filt.has_wildcards());
+        REQUIRE("my/topic" == filt.to_string());
+        REQUIRE(filt.matches(std::string{"my/topic"}));
+        REQUIRE(!filt.matches("my/topic/"));
+        REQUIRE(!filt.matches(""));
+    }
+
+    SECTION("empty_levels")
+    {
+        topic_filter filt{"a/+/+"};
+        REQUIRE(filt.has_wildcards());
+        REQUIRE(filt.matches("a//"));
+        REQUIRE(filt.matches("a/b/"));
+        REQUIRE(!filt.matches("a/b"));
+        REQUIRE(!filt.matches("a/b/c/"));
+
+        REQUIRE(!topic_filter{"+"}.matches(""));
+        REQUIRE(topic_filter{"+/"}.matches("x/"));
+        REQUIRE(topic_filter{"a/#"}.matches("a/"));
+        REQUIRE(!topic_filter{"a/#"}.matches("a"));
+    }
+
+    SECTION("copy")
+    {
+        topic_filter filt{"some/+/topic/#"};
+        topic_filter copy{filt};
+        {
+            topic_filter tmp{"tmp/+"};
+            tmp = filt;
+            REQUIRE(tmp.matches("some/a/topic/b/c"));
+        }
+        REQUIRE(copy.matches("some/a/topic/b/c"));
+        REQUIRE(!copy.matches("some/a/other/b"));
+    }
+}
@@ -0,0 +1,129 @@
+// test_topic_alias_manager.cpp
+//
+// Unit tests for the topic_alias_manager class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+#include <utility>
+
+#include "catch2_version.h"
+#include "mqtt/topic_alias_manager.h"
+
+using namespace mqtt;
+
+namespace {
+
+// Sends a message through the manager, returning the alias and whether it
+// was established, and fakes the library's return code.
+std::pair<uint16_t, bool> send(
+    topic_alias_manager& mgr, const std::string& topic, int rc = MQTTASYNC_SUCCESS
+)
+{
+    std::pair<uint16_t, bool> res;
+    mgr.send(topic, [&](uint16_t alias, bool established) {
+        res = {alias, established};
+        return rc;
+    });
+    return res;
+}
+
+}  // namespace
+
+TEST_CASE("topic_alias_manager ctor", "[aliases]")
+{
+    topic_alias_manager mgr{10};
+
+    REQUIRE(10 == mgr.get_limit());
+    REQUIRE(0 == mgr.get_maximum());
+    REQUIRE(0 == mgr.size());
+
+    // Off until reset with the server's maximum
+    REQUIRE(std::make_pair(uint16_t(0), false) == send(mgr, "a/b"));
+    REQUIRE(0 == mgr.size());
+}
+
+TEST_CASE("topic_alias_manager reset", "[aliases]")
+{
+    topic_alias_manager mgr{10};
+
+    mgr.reset(5);
+    REQUIRE(5 == mgr.get_maximum());
+
+    mgr.reset(100);
+    REQUIRE(10 == mgr.get_maximum());
+
+    send(mgr, "a/b");
+    REQUIRE(1 == mgr.size());
+
+    mgr.reset(0);
+    REQUIRE(0 == mgr.get_maximum());
+    REQUIRE(0 == mgr.size());
+    REQUIRE(0 == mgr.get_alias("a/b"));
+}
+
+TEST_CASE("topic_alias_manager establish", "[aliases]")
+{
+    topic_alias_manager mgr{10};
+    mgr.reset(10);
+
+    REQUIRE(std::make_pair(uint16_t(1), false) == send(mgr, "a/b"));
+    REQUIRE(std::make_pair(uint16_t(1), true) == send(mgr, "a/b"));
+    REQUIRE(std::make_pair(uint16_t(2), false) == send(mgr, "c/d"));
+    REQUIRE(std::make_pair(uint16_t(1), true) == send(mgr, "a/b"));
+
+    REQUIRE(1 == mgr.get_alias("a/b"));
+    REQUIRE(2 == mgr.get_alias("c/d"));
+    REQUIRE(0 == mgr.get_alias("e/f"));
+
+    // An empty topic is never aliased
+    REQUIRE(std::make_pair(uint16_t(0), false) == send(mgr, ""));
+}
+
+TEST_CASE("topic_alias_manager failed send", "[aliases]")
+{
+    topic_alias_manager mgr{10};
+    mgr.reset(10);
+
+    // If the library doesn't take the message, the alias isn't set up
+    REQUIRE(std::make_pair(uint16_t(1), false) == send(mgr, "a/b", MQTTASYNC_FAILURE));
+    REQUIRE(std::make_pair(uint16_t(1), false) == send(mgr, "a/b"));
+    REQUIRE(std::make_pair(uint16_t(1), true) == send(mgr, "a/b"));
+}
+
+TEST_CASE("topic_alias_manager lru", "[aliases]")
+{
+    topic_alias_manager mgr{2};
+    mgr.reset(2);
+
+    send(mgr, "a");
+    send(mgr, "b");
+    send(mgr, "a");
+
+    // "b" is the least recently used, so "c" takes its alias
+    REQUIRE(std::make_pair(uint16_t(2), false) == send(mgr, "c"));
+    REQUIRE(2 == mgr.size());
+    REQUIRE(0 == mgr.get_alias("b"));
+    REQUIRE(1 == mgr.get_alias("a"));
+    REQUIRE(2 == mgr.get_alias("c"));
+
+    REQUIRE(std::make_pair(uint16_t(2), true) == send(mgr, "c"));
+    REQUIRE(std::make_pair(uint16_t(1), false) == send(mgr, "b"));
+}
@@ -0,0 +1,134 @@
+// test_topic_levels.cpp
+//
+// Unit tests for the topic_levels class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - Initial implementation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/topic.h"
+#include "mqtt/topic_levels.h"
+
+using namespace mqtt;
+
+// Splits the string the slow way, for comparison
+static std::vector<std::string> naive_split(const std::string& s)
+{
+    std::vector<std::string> v;
+    if (s.empty())
+        return v;
+
+    std::string fld;
+    for (auto c : s) {
+        if (c == '/') {
+            v.push_back(fld);
+            fld.clear();
+        }
+        else
+            fld.push_back(c);
+    }
+    v.push_back(fld);
+    return v;
+}
+
+static std::vector<std::string> levels_of(const std::string& s)
+{
+    topic_levels levels{s};
+    std::vector<std::string> v;
+    for (size_t i = 0; i < levels.size(); ++i) v.emplace_back(levels.level(s, i));
+    return v;
+}
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("topic levels empty", "[topic_levels]")
+{
+    topic_levels levels;
+    REQUIRE(levels.empty());
+    REQUIRE(levels.size() == 0);
+
+    topic_levels emptyLevels{""};
+    REQUIRE(emptyLevels.empty());
+    REQUIRE(emptyLevels.size() == 0);
+}
+
+TEST_CASE("topic levels simple", "[topic_levels]")
+{
+    const std::string TOPIC{"some/topic/name"};
+    topic_levels levels{TOPIC};
+
+    REQUIRE(!levels.empty());
+    REQUIRE(levels.size() == 3);
+    REQUIRE(levels.level(TOPIC, 0) == "some");
+    REQUIRE(levels.level(TOPIC, 1) == "topic");
+    REQUIRE(levels.level(TOPIC, 2) == "name");
+    REQUIRE(levels.level_begin(1) == 5);
+    REQUIRE(levels.level_end(1) == 10);
+}
+
+TEST_CASE("topic levels empty fields", "[topic_levels]")
+{
+    REQUIRE(levels_of("/") == std::vector<std::string>{"", ""});
+    REQUIRE(levels_of("a//b/") == std::vector<std::string>{"a", "", "b", ""});
+    REQUIRE(levels_of("/a") == std::vector<std::string>{"", "a"});
+}
+
+TEST_CASE("topic levels vector boundaries", "[topic_levels]")
+{
+    // Separators on each side of the 16 and 32 byte blocks
+    for (size_t n = 1; n < 40; ++n) {
+        for (size_t pos = 0; pos < n; ++pos) {
+            std::string s(n, 'x');
+            s[pos] = '/';
+            REQUIRE(levels_of(s) == naive_split(s));
+        }
+    }
+
+    std::string allSlashes(33, '/');
+    REQUIRE(levels_of(allSlashes) == naive_split(allSlashes));
+}
+
+TEST_CASE("topic levels many", "[topic_levels]")
+{
+    // More levels than are stored inline
+    std::string s;
+    for (int i = 0; i < 40; ++i) {
+        if (i)
+            s += '/';
+        s += "lvl" + std::to_string(i);
+    }
+
+    topic_levels levels{s};
+    REQUIRE(levels.size() == 40);
+    REQUIRE(levels_of(s) == naive_split(s));
+    REQUIRE(levels.level(s, 39) == "lvl39");
+
+    // A copy refers to the same offsets
+    auto levelsCopy = levels;
+    REQUIRE(levelsCopy.level(s, 20) == "lvl20");
+}
+
+TEST_CASE("topic levels split", "[topic_levels]")
+{
+    const std::string TOPIC{"a/bb//ccc/dddd/eeeee/ffffff/ggggggg/hhhhhhhh/"};
+    REQUIRE(topic::split(TOPIC) == naive_split(TOPIC));
+}
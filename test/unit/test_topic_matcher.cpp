@@ -19,6 +19,10 @@
 
 #define UNIT_TESTS
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "catch2_version.h"
 #include "mqtt/topic_matcher.h"
 
@@ -89,3 +93,79 @@ TEST_CASE("matcher matches", "[topic_matcher]")
     REQUIRE(!(topic_matcher<int>{{"$BOB/bar", 42}}.has_match("$SYS/bar")));
     REQUIRE(!(topic_matcher<int>{{"+/bar", 42}}.has_match("$SYS/bar")));
 }
+
+TEST_CASE("matcher copy", "[topic_matcher]")
+{
+    topic_matcher<int> tm{{"some/random/topic", 42}, {"some/#", 99}};
+
+    topic_matcher<int> tmCopy{tm};
+    tmCopy.insert({"other/topic", 55});
+    tm.remove("some/#");
+
+    // The copy is independent of the original
+    REQUIRE(tmCopy.find("some/#") != tmCopy.end());
+    REQUIRE(tmCopy.find("some/#")->second == 99);
+    REQUIRE(tmCopy.find("other/topic") != tmCopy.end());
+    REQUIRE(!(tm.find("other/topic") != tm.end()));
+    REQUIRE(!(tm.find("some/#") != tm.end()));
+
+    tm = tmCopy;
+    REQUIRE(tm.has_match("other/topic"));
+    REQUIRE(tm.find("some/random/topic")->second == 42);
+}
+
+TEST_CASE("matcher match_batch", "[topic_matcher]")
+{
+    topic_matcher<int> tm{
+        {"#", 1},           {"foo/#", 2},     {"foo/+", 3},   {"foo/bar", 4},
+        {"foo/+/baz", 5},   {"foo/bar/#", 6}, {"+/bar", 7},   {"$SYS/bar", 8},
+        {"/#", 9},          {"A/B/+/#", 10}
+    };
+
+    const std::vector<std::string> TOPICS{
+        "foo/bar",   "foo/bar/baz", "foo",   "foo/bar", "$SYS/bar", "/foo/bar", "A/B/B/C",
+        "foo/$bar",  "foo/bar/bar", "other", "foo/qux", "",         "foo/bar/baz"
+    };
+
+    // The values for a topic, one at a time
+    auto one_by_one = [&tm](const std::string& topic) {
+        std::vector<int> vals;
+        for (auto it = tm.matches(topic); it != tm.matches_cend(); ++it)
+            vals.push_back(it->second);
+        std::sort(vals.begin(), vals.end());
+        return vals;
+    };
+
+    topic_matcher<int>::batch_matches out;
+
+    // Match twice, to reuse the results
+    for (int pass = 0; pass < 2; ++pass) {
+        tm.match_batch(TOPICS, out);
+        REQUIRE(TOPICS.size() == out.size());
+
+        size_t total = 0;
+        for (size_t i = 0; i < TOPICS.size(); ++i) {
+            std::vector<int> vals;
+            for (auto pval : out[i]) vals.push_back(pval->second);
+            std::sort(vals.begin(), vals.end());
+
+            REQUIRE(one_by_one(TOPICS[i]) == vals);
+            REQUIRE(out.has_match(i) == !vals.empty());
+            total += out[i].size();
+        }
+        REQUIRE(total == out.num_matches());
+    }
+
+    REQUIRE((std::vector<int>{1, 2, 3, 4, 7}) == [&out] {
+        std::vector<int> vals;
+        for (auto pval : out[0]) vals.push_back(pval->second);
+        std::sort(vals.begin(), vals.end());
+        return vals;
+    }());
+    REQUIRE(out[4].size() == 1);
+
+    // An empty batch
+    tm.match_batch(std::vector<std::string>{}, out);
+    REQUIRE(0 == out.size());
+    REQUIRE(0 == out.num_matches());
+}
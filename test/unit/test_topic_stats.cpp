@@ -0,0 +1,158 @@
+// test_topic_stats.cpp
+//
+// Unit tests for the topic_stats class in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/topic_stats.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+// --------------------------------------------------------------------------
+
+TEST_CASE("topic_stats filters", "[topic_stats]")
+{
+    topic_stats stats;
+    stats.add_filter("sensors/#");
+    stats.add_filter("sensors/+/temp");
+    stats.add_filter("sensors/#");
+    REQUIRE(2 == stats.num_filters());
+    REQUIRE(0 == stats.num_prefixes());
+
+    const auto t0 = topic_stats::clock::now();
+    const auto t1 = t0 + seconds(1);
+
+    stats.on_received("sensors/1/temp", 10, t0);
+    stats.on_received("sensors/1/humidity", 5, t1);
+    stats.on_sent("sensors/2/temp", 3, t1);
+    stats.on_received("other", 100, t1);
+
+    auto all = stats.get("sensors/#");
+    REQUIRE(all);
+    REQUIRE(!all->prefix);
+    REQUIRE(2 == all->received.msgs);
+    REQUIRE(15 == all->received.bytes);
+    REQUIRE(t1 == all->received.lastSeen);
+    REQUIRE(1 == all->sent.msgs);
+    REQUIRE(3 == all->sent.bytes);
+
+    auto temp = stats.get("sensors/+/temp");
+    REQUIRE(temp);
+    REQUIRE(1 == temp->received.msgs);
+    REQUIRE(t0 == temp->received.lastSeen);
+    REQUIRE(1 == temp->sent.msgs);
+
+    REQUIRE(!stats.get("other"));
+
+    // The snapshot is in the order of the topic tree
+    auto snap = stats.snapshot();
+    REQUIRE(2 == snap.size());
+
+    stats.reset();
+    all = stats.get("sensors/#");
+    REQUIRE(0 == all->received.msgs);
+    REQUIRE(0 == all->sent.bytes);
+    REQUIRE(topic_stats::time_point{} == all->received.lastSeen);
+}
+
+TEST_CASE("topic_stats prefixes", "[topic_stats]")
+{
+    topic_stats stats{2, 3};
+    REQUIRE(2 == stats.get_prefix_depth());
+
+    stats.on_received("plant/line1/temp", 1);
+    stats.on_received("plant/line1/pressure", 2);
+    stats.on_received("plant/line2/temp", 4);
+    stats.on_received("status", 8);
+    REQUIRE(3 == stats.num_prefixes());
+
+    auto line1 = stats.get("plant/line1/#");
+    REQUIRE(line1);
+    REQUIRE(line1->prefix);
+    REQUIRE(2 == line1->received.msgs);
+    REQUIRE(3 == line1->received.bytes);
+    REQUIRE(1 == stats.get("status/#")->received.msgs);
+
+    // Past the limit, new prefixes aren't counted
+    stats.on_received("plant/line3/temp", 1);
+    REQUIRE(3 == stats.num_prefixes());
+    REQUIRE(1 == stats.num_overflow());
+    REQUIRE(!stats.get("plant/line3/#"));
+
+    // A prefix that's added as a filter becomes one
+    stats.add_filter("plant/line2/#");
+    REQUIRE(1 == stats.num_filters());
+    REQUIRE(2 == stats.num_prefixes());
+    REQUIRE(!stats.get("plant/line2/#")->prefix);
+}
+
+TEST_CASE("topic_stats threads", "[topic_stats]")
+{
+    topic_stats stats{1};
+    stats.add_filter("#");
+
+    const int N_THREADS = 4, N = 1000;
+    std::vector<std::thread> thrs;
+    for (int i = 0; i < N_THREADS; ++i) {
+        thrs.emplace_back([&stats, i] {
+            auto topic = "t" + std::to_string(i % 2) + "/x";
+            for (int j = 0; j < N; ++j) stats.on_sent(topic, 2);
+        });
+    }
+    for (auto& thr : thrs) thr.join();
+
+    REQUIRE(N_THREADS * N == stats.get("#")->sent.msgs);
+    REQUIRE(2 * N_THREADS * N == stats.get("#")->sent.bytes);
+    REQUIRE(2 * N == stats.get("t0/#")->sent.msgs);
+    REQUIRE(2 * N == stats.get("t1/#")->sent.msgs);
+}
+
+TEST_CASE("async_client topic stats", "[topic_stats]")
+{
+    async_client cli{"tcp://localhost:1883", "test_topic_stats"};
+    REQUIRE(!cli.get_topic_stats());
+
+    auto stats = std::make_shared<topic_stats>();
+    stats->add_filter("a/#");
+    cli.set_topic_stats(stats);
+    REQUIRE(stats == cli.get_topic_stats());
+
+    cli.start_consuming();
+
+    const std::string PAYLOAD{"payload"};
+    cli.test_message_arrived("a/b", PAYLOAD.data(), PAYLOAD.size());
+    cli.test_message_arrived("a/c", PAYLOAD.data(), PAYLOAD.size());
+    cli.test_message_arrived("b/c", PAYLOAD.data(), PAYLOAD.size());
+
+    auto e = stats->get("a/#");
+    REQUIRE(2 == e->received.msgs);
+    REQUIRE(2 * PAYLOAD.size() == e->received.bytes);
+
+    cli.set_topic_stats(topic_stats_ptr{});
+    REQUIRE(!cli.get_topic_stats());
+}
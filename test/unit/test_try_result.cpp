@@ -0,0 +1,142 @@
+// test_try_result.cpp
+//
+// Unit tests for the try_result class, and the client calls that return
+// it, in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <string>
+
+#include "catch2_version.h"
+#include "mqtt/async_client.h"
+#include "mqtt/try_result.h"
+
+using namespace mqtt;
+
+namespace {
+
+const std::string SERVER_URI{"tcp://localhost:1883"};
+const std::string CLIENT_ID{"test_try_result"};
+const std::string TOPIC{"topic"};
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("try_result values", "[try_result]")
+{
+    try_result<int> res{42};
+    REQUIRE(res.ok());
+    REQUIRE(res);
+    REQUIRE(MQTTASYNC_SUCCESS == res.get_return_code());
+    REQUIRE(42 == res.get());
+    REQUIRE(42 == res.value());
+}
+
+TEST_CASE("try_result errors", "[try_result]")
+{
+    auto res = try_result<int>::error(MQTTASYNC_MAX_BUFFERED_MESSAGES);
+    REQUIRE(!res.ok());
+    REQUIRE(!res);
+    REQUIRE(MQTTASYNC_MAX_BUFFERED_MESSAGES == res.get_return_code());
+    REQUIRE(ReasonCode::SUCCESS == res.get_reason_code());
+    REQUIRE(exception::error_str(MQTTASYNC_MAX_BUFFERED_MESSAGES) == res.get_message());
+    REQUIRE(0 == res.get());
+
+    // The exception is the one the throwing call would have made
+    auto exc = res.to_exception();
+    REQUIRE(
+        std::string{exception(MQTTASYNC_MAX_BUFFERED_MESSAGES).what()} == std::string{exc.what()}
+    );
+
+    try {
+        res.value();
+        FAIL("value() of an error should throw");
+    }
+    catch (const exception& e) {
+        REQUIRE(MQTTASYNC_MAX_BUFFERED_MESSAGES == e.get_return_code());
+    }
+
+    auto res2 = try_result<int>::error(
+        MQTTASYNC_FAILURE, ReasonCode::QUOTA_EXCEEDED, "Publish rate limit exceeded"
+    );
+    REQUIRE(ReasonCode::QUOTA_EXCEEDED == res2.get_reason_code());
+    REQUIRE("Publish rate limit exceeded" == res2.get_message());
+    REQUIRE(ReasonCode::QUOTA_EXCEEDED == res2.to_exception().get_reason_code());
+}
+
+TEST_CASE("async_client try_publish", "[try_result]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+
+    // Not connected
+    auto res = cli.try_publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(!res);
+    REQUIRE(MQTTASYNC_DISCONNECTED == res.get_return_code());
+    REQUIRE(!res.get());
+    REQUIRE(0 == cli.get_metrics().num_pending_delivery_tokens());
+
+    auto msg = make_message(TOPIC, "hi");
+    REQUIRE(MQTTASYNC_DISCONNECTED == cli.try_publish(msg).get_return_code());
+    REQUIRE(
+        MQTTASYNC_DISCONNECTED == cli.try_publish(TOPIC, binary_ref{"hi"}).get_return_code()
+    );
+    REQUIRE(MQTTASYNC_DISCONNECTED == cli.try_publish_qos0(TOPIC, "hi", 2));
+
+    // Held while offline, until the buffer is full
+    cli.start_offline_buffering(1);
+    res = cli.try_publish(TOPIC, "hello", 5, 1, false);
+    REQUIRE(res);
+    REQUIRE(res.get());
+    REQUIRE(1 == cli.get_metrics().num_pending_delivery_tokens());
+
+    auto full = cli.try_publish(TOPIC, "full", 4, 1, false);
+    REQUIRE(MQTTASYNC_MAX_BUFFERED_MESSAGES == full.get_return_code());
+    REQUIRE(1 == cli.get_metrics().num_pending_delivery_tokens());
+    cli.stop_offline_buffering();
+}
+
+TEST_CASE("async_client try_publish rate limited", "[try_result]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+    cli.start_rate_limiting(1.0, 0.0, rate_limiter::FAIL);
+
+    REQUIRE(MQTTASYNC_DISCONNECTED == cli.try_publish(TOPIC, "hello", 5).get_return_code());
+
+    auto res = cli.try_publish(TOPIC, "hello", 5);
+    REQUIRE(MQTTASYNC_FAILURE == res.get_return_code());
+    REQUIRE(ReasonCode::QUOTA_EXCEEDED == res.get_reason_code());
+    cli.stop_rate_limiting();
+}
+
+TEST_CASE("async_client try_subscribe", "[try_result]")
+{
+    async_client cli{SERVER_URI, CLIENT_ID};
+
+    auto res = cli.try_subscribe(TOPIC, 1);
+    REQUIRE(!res);
+    REQUIRE(MQTTASYNC_DISCONNECTED == res.get_return_code());
+    REQUIRE(0 == cli.get_metrics().num_pending_tokens());
+
+    auto ures = cli.try_unsubscribe(TOPIC);
+    REQUIRE(!ures);
+    REQUIRE(MQTTASYNC_DISCONNECTED == ures.get_return_code());
+    REQUIRE(0 == cli.get_metrics().num_pending_tokens());
+}
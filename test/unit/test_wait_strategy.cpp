@@ -0,0 +1,229 @@
+// test_wait_strategy.cpp
+//
+// Unit tests for the wait_strategy class, and the queue and token waits
+// that use it, in the Paho MQTT C++ library.
+//
+
+/*******************************************************************************
+ * Copyright (c) 2026 Frank Pagliughi <fpagliughi@mindspring.com>
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v2.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *    http://www.eclipse.org/legal/epl-v20.html
+ * and the Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php.
+ *
+ * Contributors:
+ *    Frank Pagliughi - initial implementation and documentation
+ *******************************************************************************/
+
+#define UNIT_TESTS
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "catch2_version.h"
+#include "mock_async_client.h"
+#include "mqtt/async_client.h"
+#include "mqtt/thread_queue.h"
+#include "mqtt/wait_strategy.h"
+
+using namespace mqtt;
+using namespace std::chrono;
+
+namespace {
+
+// A client that hands out a wait strategy for its tokens
+class strategy_client : public mock_async_client
+{
+public:
+    wait_strategy ws;
+    wait_strategy get_wait_strategy() const override { return ws; }
+};
+
+const wait_strategy SPINNING[] = {
+    wait_strategy::spin(), wait_strategy::spin_yield(microseconds(10)),
+    wait_strategy::spin_park(microseconds(10))
+};
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("wait_strategy modes", "[wait_strategy]")
+{
+    constexpr wait_strategy dflt;
+    REQUIRE(wait_strategy::PARK == dflt.get_mode());
+    REQUIRE(!dflt.spins());
+    REQUIRE(dflt.parks());
+
+    REQUIRE(wait_strategy::spin().spins());
+    REQUIRE(!wait_strategy::spin().parks());
+    REQUIRE(!wait_strategy::spin_yield().parks());
+    REQUIRE(wait_strategy::spin_park().parks());
+    REQUIRE(microseconds(5) == wait_strategy::spin_park(microseconds(5)).get_budget());
+
+    // Very long times stop at the end of the clock
+    REQUIRE(steady_clock::time_point::max() == wait_strategy::deadline_after(hours::max()));
+    REQUIRE(steady_clock::now() < wait_strategy::deadline_after(milliseconds(10)));
+}
+
+TEST_CASE("wait_strategy spin_until", "[wait_strategy]")
+{
+    std::atomic<bool> flag{false};
+    auto pred = [&flag] { return flag.load(); };
+    const auto FOREVER = steady_clock::time_point::max();
+
+    SECTION("met")
+    {
+        std::thread thr([&flag] {
+            std::this_thread::sleep_for(milliseconds(5));
+            flag = true;
+        });
+        for (const auto& ws : SPINNING) {
+            if (ws.get_mode() != wait_strategy::SPIN_PARK)
+                REQUIRE(ws.spin_until(pred, FOREVER));
+        }
+        thr.join();
+        REQUIRE(wait_strategy::spin_park().spin_until(pred, FOREVER));
+    }
+
+    SECTION("times out")
+    {
+        for (const auto& ws : SPINNING) {
+            auto until = steady_clock::now() + milliseconds(2);
+            REQUIRE(!ws.spin_until(pred, until));
+        }
+        // Spinning and yielding run to the deadline
+        auto until = steady_clock::now() + milliseconds(2);
+        REQUIRE(!wait_strategy::spin_yield(microseconds(1)).spin_until(pred, until));
+        REQUIRE(steady_clock::now() >= until);
+    }
+
+    SECTION("budget runs out")
+    {
+        auto start = steady_clock::now();
+        REQUIRE(!wait_strategy::spin_park(microseconds(100)).spin_until(pred, FOREVER));
+        REQUIRE(steady_clock::now() - start < seconds(1));
+    }
+}
+
+TEST_CASE("thread_queue wait strategies", "[wait_strategy]")
+{
+    thread_queue<int> que;
+    REQUIRE(wait_strategy::PARK == que.get_wait_strategy().get_mode());
+
+    for (const auto& ws : SPINNING) {
+        que.set_wait_strategy(ws);
+        REQUIRE(ws.get_mode() == que.get_wait_strategy().get_mode());
+
+        std::thread thr([&que] {
+            std::this_thread::sleep_for(milliseconds(5));
+            que.put(1);
+            std::this_thread::sleep_for(milliseconds(5));
+            que.put(2);
+            que.put(3);
+        });
+
+        REQUIRE(1 == que.get());
+
+        int val = 0;
+        REQUIRE(que.try_get_for(&val, seconds(5)));
+        REQUIRE(2 == val);
+        REQUIRE(que.try_get_until(&val, steady_clock::now() + seconds(5)));
+        REQUIRE(3 == val);
+        thr.join();
+
+        // Timeouts
+        auto start = steady_clock::now();
+        REQUIRE(!que.try_get_for(&val, milliseconds(5)));
+        REQUIRE(steady_clock::now() - start >= milliseconds(5));
+
+        std::vector<int> vec;
+        REQUIRE(0 == que.try_get_n_until(&vec, 4, steady_clock::now() + milliseconds(5)));
+    }
+
+    // Closing the queue stops a spinning receiver
+    que.set_wait_strategy(wait_strategy::spin());
+    std::thread thr([&que] {
+        std::this_thread::sleep_for(milliseconds(5));
+        que.close();
+    });
+    int val = 0;
+    REQUIRE(!que.get(&val));
+    thr.join();
+}
+
+TEST_CASE("token wait strategies", "[wait_strategy]")
+{
+    strategy_client cli;
+
+    for (const auto& ws : SPINNING) {
+        cli.ws = ws;
+
+        {
+            token tok{token::Type::CONNECT, cli};
+            std::thread thr([&tok] {
+                std::this_thread::sleep_for(milliseconds(5));
+                mock_async_client::succeed(&tok, nullptr);
+            });
+            tok.wait();
+            REQUIRE(tok.is_complete());
+            thr.join();
+        }
+
+        {
+            token tok{token::Type::CONNECT, cli};
+            std::thread thr([&tok] {
+                std::this_thread::sleep_for(milliseconds(5));
+                mock_async_client::succeed(&tok, nullptr);
+            });
+            REQUIRE(tok.wait_for(seconds(5)));
+            thr.join();
+        }
+
+        token tok{token::Type::CONNECT, cli};
+        auto start = steady_clock::now();
+        REQUIRE(!tok.wait_for(milliseconds(5)));
+        REQUIRE(steady_clock::now() - start >= milliseconds(5));
+        REQUIRE(!tok.wait_until(steady_clock::now() + milliseconds(2)));
+
+        mock_async_client::succeed(&tok, nullptr);
+        REQUIRE(tok.wait_for(milliseconds(5)));
+    }
+}
+
+TEST_CASE("async_client wait strategy", "[wait_strategy]")
+{
+    async_client cli{"tcp://localhost:1883", "test_wait_strategy"};
+    REQUIRE(wait_strategy::PARK == cli.get_wait_strategy().get_mode());
+
+    // Set before and after the queue is started
+    cli.set_wait_strategy(wait_strategy::spin());
+    cli.start_consuming();
+    REQUIRE(wait_strategy::SPIN == cli.get_wait_strategy().get_mode());
+
+    const std::string PAYLOAD{"hello"};
+
+    for (const auto& ws : SPINNING) {
+        cli.set_wait_strategy(ws);
+
+        std::thread thr([&cli, &PAYLOAD] {
+            std::this_thread::sleep_for(milliseconds(5));
+            cli.test_message_arrived("a/b", PAYLOAD.data(), PAYLOAD.size());
+        });
+        auto msg = cli.consume_message();
+        REQUIRE(msg);
+        REQUIRE(PAYLOAD == msg->to_string());
+        thr.join();
+
+        const_message_ptr none;
+        REQUIRE(!cli.try_consume_message_for(&none, milliseconds(5)));
+    }
+    cli.stop_consuming();
+}